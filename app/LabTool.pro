@@ -5,6 +5,14 @@ SOURCES += \
     device/capturedevice.cpp \
     analyzer/uianalyzer.cpp \
     analyzer/analyzermanager.cpp \
+    analyzer/decodeditemexporter.cpp \
+    analyzer/decoder/decodermanager.cpp \
+    analyzer/decoder/uartdecoder.cpp \
+    analyzer/decoder/i2cdecoder.cpp \
+    analyzer/decoder/spidecoder.cpp \
+    analyzer/decoder/decodersession.cpp \
+    analyzer/decoder/uidecoderanalyzer.cpp \
+    analyzer/decoder/uidecoderanalyzerconfig.cpp \
     device/labtool/labtooldevicetransfer.cpp \
     device/labtool/labtooldevicecommthread.cpp \
     device/labtool/labtooldevicecomm.cpp \
@@ -12,11 +20,14 @@ SOURCES += \
     device/labtool/uilabtooltriggerconfig.cpp \
     analyzer/uart/uiuartanalyzer.cpp \
     generator/uartgenerator.cpp \
+    generator/uartstream.cpp \
     analyzer/uianalyzerconfig.cpp \
     analyzer/uart/uiuartanalyzerconfig.cpp \
+    analyzer/uart/uartautodetect.cpp \
     common/inputhelper.cpp \
     common/types.cpp \
     generator/spigenerator.cpp \
+    generator/packedpattern.cpp \
     analyzer/i2c/uii2canalyzerconfig.cpp \
     analyzer/i2c/uii2canalyzer.cpp \
     analyzer/spi/uispianalyzer.cpp \
@@ -31,6 +42,10 @@ SOURCES += \
     generator/uianaloggenerator.cpp \
     device/simulator/simulatorgeneratordevice.cpp \
     device/labtool/labtoolgeneratordevice.cpp \
+    device/labtool/labtoolgeneratorstream.cpp \
+    device/labtool/labtooli2cmonitor.cpp \
+    device/labtool/uilabtooldiagnostics.cpp \
+    device/labtool/labtoolsampleunpacker.cpp \
     generator/uigeneratorarea.cpp \
     generator/generatorapp.cpp \
     generator/digitaldelegate.cpp \
@@ -40,6 +55,7 @@ SOURCES += \
     generator/uianalogshape.cpp \
     generator/uigeneratorsignaldialog.cpp \
     common/stringutil.cpp \
+    common/sampleindex.cpp \
     uimainwindow.cpp \
     capture/uitimeaxis.cpp \
     capture/uisimpleabstractsignal.cpp \
@@ -48,6 +64,11 @@ SOURCES += \
     capture/uimeasurmentarea.cpp \
     capture/uilistspinbox.cpp \
     capture/uigrid.cpp \
+    capture/uioverview.cpp \
+    capture/decodestopcondition.cpp \
+    capture/uistopconditiondialog.cpp \
+    capture/analogmasktest.cpp \
+    capture/uianalogmaskdialog.cpp \
     capture/uidigitaltrigger.cpp \
     capture/uidigitalsignal.cpp \
     capture/uidigitalgroup.cpp \
@@ -72,7 +93,11 @@ SOURCES += \
     device/labtool/labtoolcalibrationwizardanalogin.cpp \
     device/labtool/labtoolcalibrationdata.cpp \
     device/digitalsignal.cpp \
-    device/reconfigurelistener.cpp
+    device/reconfigurelistener.cpp \
+    device/digitaledgeindex.cpp \
+    device/digitaltransitions.cpp \
+    ../fw/program/source/gen_pattern.c \
+    ../fw/program/source/capture_pattern.c
 
 HEADERS += \
     generator/i2cgenerator.h \
@@ -87,12 +112,16 @@ HEADERS += \
     device/labtool/uilabtooltriggerconfig.h \
     analyzer/uart/uiuartanalyzer.h \
     generator/uartgenerator.h \
+    generator/uartstream.h \
     analyzer/uianalyzerconfig.h \
     analyzer/uart/uiuartanalyzerconfig.h \
+    analyzer/uart/uartautodetect.h \
     common/types.h \
     generator/spigenerator.h \
+    generator/packedpattern.h \
     analyzer/i2c/uii2canalyzerconfig.h \
     analyzer/i2c/uii2canalyzer.h \
+    analyzer/i2c/i2citem.h \
     analyzer/spi/uispianalyzer.h \
     analyzer/spi/uispianalyzerconfig.h \
     device/device.h \
@@ -105,6 +134,10 @@ HEADERS += \
     generator/uianaloggenerator.h \
     device/simulator/simulatorgeneratordevice.h \
     device/labtool/labtoolgeneratordevice.h \
+    device/labtool/labtoolgeneratorstream.h \
+    device/labtool/labtooli2cmonitor.h \
+    device/labtool/uilabtooldiagnostics.h \
+    device/labtool/labtoolsampleunpacker.h \
     generator/uigeneratorarea.h \
     generator/generatorapp.h \
     generator/digitaldelegate.h \
@@ -114,6 +147,7 @@ HEADERS += \
     generator/uianalogshape.h \
     generator/uigeneratorsignaldialog.h \
     common/stringutil.h \
+    common/sampleindex.h \
     uimainwindow.h \
     capture/uitimeaxis.h \
     capture/uisimpleabstractsignal.h \
@@ -122,6 +156,11 @@ HEADERS += \
     capture/uimeasurmentarea.h \
     capture/uilistspinbox.h \
     capture/uigrid.h \
+    capture/uioverview.h \
+    capture/decodestopcondition.h \
+    capture/uistopconditiondialog.h \
+    capture/analogmasktest.h \
+    capture/uianalogmaskdialog.h \
     capture/uidigitaltrigger.h \
     capture/uidigitalsignal.h \
     capture/uidigitalgroup.h \
@@ -136,6 +175,15 @@ HEADERS += \
     capture/signalmanager.h \
     capture/captureapp.h \
     analyzer/analyzermanager.h \
+    analyzer/decodeditemexporter.h \
+    analyzer/decoder/decoderinterface.h \
+    analyzer/decoder/decodermanager.h \
+    analyzer/decoder/uartdecoder.h \
+    analyzer/decoder/i2cdecoder.h \
+    analyzer/decoder/spidecoder.h \
+    analyzer/decoder/decodersession.h \
+    analyzer/decoder/uidecoderanalyzer.h \
+    analyzer/decoder/uidecoderanalyzerconfig.h \
     common/configuration.h \
     capture/cursormanager.h \
     common/inputhelper.h \
@@ -148,7 +196,14 @@ HEADERS += \
     device/labtool/labtoolcalibrationwizardanalogin.h \
     device/labtool/labtoolcalibrationdata.h \
     device/digitalsignal.h \
-    device/reconfigurelistener.h
+    device/reconfigurelistener.h \
+    device/digitaledgeindex.h \
+    device/digitaltransitions.h \
+    ../fw/program/include/gen_pattern.h \
+    ../fw/program/include/capture_telemetry.h \
+    ../fw/program/include/capture_peek.h \
+    ../fw/program/include/capture_buffers.h \
+    ../fw/program/include/capture_pattern.h
 
 RESOURCES += \
     icons.qrc
@@ -156,6 +211,7 @@ RESOURCES += \
 RC_FILE = icon.rc
 
 INCLUDEPATH += .
+INCLUDEPATH += ../fw/program/include
 win32:CONFIG(release, debug|release): LIBS += -L$$PWD/libusbx/MinGW32/dll/ -lusb-1.0
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$PWD/libusbx/MinGW32/dll/ -lusb-1.0
 else:mac: LIBS += `/usr/local/bin/pkg-config libusb-1.0 --static --libs`
@@ -164,7 +220,7 @@ else:unix:!symbian: LIBS += -L$$PWD/libusbx/Linux/ -lusb-1.0 -ludev
 INCLUDEPATH += $$PWD/libusbx/MS32/dll
 DEPENDPATH += $$PWD/libusbx/MS32/dll
 
-QT += widgets
+QT += widgets concurrent
 
 mac {
     ICON = resources/oscilloscope.icns
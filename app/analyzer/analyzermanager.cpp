@@ -17,6 +17,8 @@
 #include "i2c/uii2canalyzer.h"
 #include "uart/uiuartanalyzer.h"
 #include "spi/uispianalyzer.h"
+#include "decoder/decodermanager.h"
+#include "decoder/uidecoderanalyzer.h"
 
 /*!
     \class AnalyzerManager
@@ -24,6 +26,11 @@
 
     \ingroup Analyzer
 
+    Besides the built-in analyzers there is one analyzer for each decoder
+    found in the decoder plugins, see DecoderManager. The built-in decoders
+    aren't listed as they decode the same protocols as the built-in
+    analyzers.
+
 */
 
 
@@ -37,7 +44,8 @@ QList<QString> AnalyzerManager::analyzers()
     return QList<QString>()
             << UiI2CAnalyzer::signalName
             << UiUartAnalyzer::name
-            << UiSpiAnalyzer::signalName;
+            << UiSpiAnalyzer::signalName
+            << DecoderManager::instance().pluginDecoders();
 }
 
 /*!
@@ -61,6 +69,14 @@ UiAnalyzer* AnalyzerManager::createAnalyzer(const QString name)
         analyzer = new UiSpiAnalyzer();
     }
 
+    else if (DecoderManager::instance().pluginDecoders().contains(name)) {
+        DecoderInterface* decoder = DecoderManager::instance().createDecoder(name);
+        if (decoder != NULL) {
+            // Deallocation: caller is responsible for deallocation
+            analyzer = new UiDecoderAnalyzer(decoder);
+        }
+    }
+
     return analyzer;
 }
 
@@ -98,6 +114,9 @@ UiAnalyzer* AnalyzerManager::analyzerFromString(const QString &s)
     else if (type == UiSpiAnalyzer::signalName) {
         analyzer = UiSpiAnalyzer::fromSettingsString(s);
     }
+    else if (type == UiDecoderAnalyzer::name) {
+        analyzer = UiDecoderAnalyzer::fromSettingsString(s);
+    }
 
     return analyzer;
 
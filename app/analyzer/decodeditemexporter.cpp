@@ -0,0 +1,436 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "decodeditemexporter.h"
+
+#include <QFile>
+
+/*!
+    \class DecodedItemExporter
+    \brief Writes the items decoded by an analyzer to a file.
+
+    \ingroup Analyzer
+
+    The items of a UART, SPI or I2C analyzer are written, one at a time,
+    either as comma separated values or as fixed size binary records. The
+    items are read as they are stored by the analyzer, without formatting
+    them the way the analyzer presents them, so that also very long
+    captures can be exported quickly.
+
+    The exporter is meant to be moved to a separate thread and started by
+    calling run() from that thread. The items are given to the exporter
+    before that; QVector is implicitly shared so the analyzer's items are
+    not copied unless the analyzer changes them during the export.
+
+    Times are written in seconds relative to the first sample and are
+    calculated from the sample indexes as in the rest of the application.
+
+    The binary format is little endian and starts with a header:
+
+    \table
+    \header
+        \li Type
+        \li Description
+    \row
+        \li 4 bytes
+        \li "LTDI"
+    \row
+        \li quint16
+        \li Format version (1)
+    \row
+        \li quint8
+        \li Protocol: 0 = UART, 1 = SPI, 2 = I2C
+    \row
+        \li quint8
+        \li Reserved (0)
+    \row
+        \li quint32
+        \li Sample rate
+    \endtable
+
+    followed by one record for each item until the end of the file:
+
+    \table
+    \header
+        \li Type
+        \li Description
+    \row
+        \li qint64
+        \li Start sample index
+    \row
+        \li qint64
+        \li Stop sample index, -1 if unknown
+    \row
+        \li quint8
+        \li Item type as in UartItem, SpiItem or I2CItem
+    \row
+        \li quint8
+        \li Flags, see DecodedItemExporter::Flags
+    \row
+        \li quint16
+        \li I2C address of the transfer, 0 for UART and SPI
+    \row
+        \li qint32
+        \li Value (UART and I2C) or MOSI value (SPI)
+    \row
+        \li qint32
+        \li MISO value (SPI), 0 otherwise
+    \endtable
+*/
+
+/*!
+    Constructs an exporter that writes to \a filePath in the given
+    \a format. The sample indexes of the items are converted to time
+    using \a sampleRate.
+*/
+DecodedItemExporter::DecodedItemExporter(const QString &filePath, Format format,
+                                         int sampleRate) :
+    QObject()
+{
+    mFilePath = filePath;
+    mFormat = format;
+    mSampleRate = sampleRate;
+    mProtocol = ProtocolUart;
+    mOk = false;
+}
+
+/*!
+    Sets the UART \a items to export.
+*/
+void DecodedItemExporter::setItems(const QVector<UartItem> &items)
+{
+    mProtocol = ProtocolUart;
+    mUartItems = items;
+}
+
+/*!
+    Sets the SPI \a items to export.
+*/
+void DecodedItemExporter::setItems(const QVector<SpiItem> &items)
+{
+    mProtocol = ProtocolSpi;
+    mSpiItems = items;
+}
+
+/*!
+    Sets the I2C \a items to export.
+*/
+void DecodedItemExporter::setItems(const QVector<I2CItem> &items)
+{
+    mProtocol = ProtocolI2C;
+    mI2cItems = items;
+}
+
+/*!
+    \fn bool DecodedItemExporter::succeeded() const
+
+    Returns true if the export has completed and all items were written.
+*/
+
+/*!
+    \fn void DecodedItemExporter::progress(int percent)
+
+    This signal is emitted regularly during the export with the
+    \a percent of the items that have been written.
+*/
+
+/*!
+    \fn void DecodedItemExporter::finished(bool ok)
+
+    This signal is emitted when the export is done. \a ok is false if
+    the file couldn't be written or the export was cancelled.
+*/
+
+/*!
+    Writes all items as records to the stream \a out. Returns false if the
+    export was cancelled.
+*/
+template <class Stream>
+bool DecodedItemExporter::writeItems(Stream &out)
+{
+    int num = numItems();
+    int address = 0;
+
+    for (int i = 0; i < num; i++) {
+
+        if ((i % ProgressInterval) == 0) {
+            if (mCancel.load() != 0) return false;
+            emit progress((int)((qint64)i*100/num));
+        }
+
+        writeRecord(out, record(i, &address));
+    }
+
+    emit progress(100);
+
+    return true;
+}
+
+/*!
+    Writes all items to the file.
+*/
+void DecodedItemExporter::run()
+{
+    bool ok = false;
+
+    do {
+        QFile file(mFilePath);
+
+        if (mFormat == FormatCsv) {
+            if (!file.open(QIODevice::Truncate | QIODevice::WriteOnly
+                           | QIODevice::Text)) {
+                break;
+            }
+
+            QTextStream out(&file);
+            writeHeader(out);
+            ok = writeItems(out);
+            out.flush();
+        }
+        else {
+            if (!file.open(QIODevice::Truncate | QIODevice::WriteOnly)) {
+                break;
+            }
+
+            QDataStream out(&file);
+            out.setByteOrder(QDataStream::LittleEndian);
+            writeHeader(out);
+            ok = writeItems(out);
+        }
+
+        if (file.error() != QFile::NoError) {
+            ok = false;
+        }
+
+    } while(false);
+
+    mOk = ok;
+    emit finished(ok);
+}
+
+/*!
+    Requests the export to stop. May be called from any thread.
+*/
+void DecodedItemExporter::cancel()
+{
+    mCancel.fetchAndStoreOrdered(1);
+}
+
+/*!
+    Returns the number of items to export.
+*/
+int DecodedItemExporter::numItems() const
+{
+    switch (mProtocol) {
+    case ProtocolUart:
+        return mUartItems.size();
+    case ProtocolSpi:
+        return mSpiItems.size();
+    case ProtocolI2C:
+        return mI2cItems.size();
+    }
+
+    return 0;
+}
+
+/*!
+    Returns the record for item \a i. For I2C the address of the ongoing
+    transfer is kept in \a address as the items are visited in order.
+*/
+DecodedItemExporter::Record DecodedItemExporter::record(int i, int* address) const
+{
+    Record r;
+    r.flags = 0;
+    r.address = 0;
+    r.value2 = 0;
+
+    switch (mProtocol) {
+    case ProtocolUart:
+    {
+        const UartItem &item = mUartItems.at(i);
+        r.startIdx = item.startIdx;
+        r.stopIdx = item.stopIdx;
+        r.type = item.type;
+        r.value = item.value;
+        if (item.type == UartItem::TYPE_FRAME_ERROR) {
+            r.flags |= FlagFrameError;
+        }
+        else if (item.type == UartItem::TYPE_PARITY_ERROR) {
+            r.flags |= FlagParityError;
+        }
+        break;
+    }
+    case ProtocolSpi:
+    {
+        const SpiItem &item = mSpiItems.at(i);
+        r.startIdx = item.startIdx;
+        r.stopIdx = item.stopIdx;
+        r.type = item.type;
+        r.value = item.mosiValue;
+        r.value2 = item.misoValue;
+        if (item.type == SpiItem::TYPE_FRAME_ERROR) {
+            r.flags |= FlagFrameError;
+        }
+        break;
+    }
+    case ProtocolI2C:
+    {
+        const I2CItem &item = mI2cItems.at(i);
+        r.startIdx = item.startIdx;
+        r.stopIdx = item.stopIdx;
+        r.type = item.type;
+        r.value = item.value;
+
+        switch (item.type) {
+        case I2CItem::I2C_7_ADDRESS_WRITE:
+        case I2CItem::I2C_7_ADDRESS_READ:
+        case I2CItem::I2C_10_ADDRESS_WRITE:
+        case I2CItem::I2C_10_ADDRESS_READ:
+            *address = item.value;
+            break;
+        case I2CItem::I2C_ERROR:
+            r.flags |= FlagError;
+            break;
+        default:
+            break;
+        }
+
+        r.address = *address;
+        break;
+    }
+    }
+
+    return r;
+}
+
+/*!
+    Returns the name of item \a type written in CSV files.
+*/
+const char* DecodedItemExporter::typeName(int type) const
+{
+    switch (mProtocol) {
+    case ProtocolUart:
+        switch (type) {
+        case UartItem::TYPE_DATA:          return "data";
+        case UartItem::TYPE_FRAME_ERROR:   return "frame_error";
+        case UartItem::TYPE_PARITY_ERROR:  return "parity_error";
+        }
+        break;
+    case ProtocolSpi:
+        switch (type) {
+        case SpiItem::TYPE_DATA:           return "data";
+        case SpiItem::TYPE_FRAME_ERROR:    return "frame_error";
+        }
+        break;
+    case ProtocolI2C:
+        switch (type) {
+        case I2CItem::I2C_START:           return "start";
+        case I2CItem::I2C_STOP:            return "stop";
+        case I2CItem::I2C_ACK:             return "ack";
+        case I2CItem::I2C_NACK:            return "nack";
+        case I2CItem::I2C_DATA:            return "data";
+        case I2CItem::I2C_7_ADDRESS_WRITE: return "address_write";
+        case I2CItem::I2C_7_ADDRESS_READ:  return "address_read";
+        case I2CItem::I2C_10_ADDRESS_WRITE:return "address10_write";
+        case I2CItem::I2C_10_ADDRESS_READ: return "address10_read";
+        case I2CItem::I2C_ERROR:           return "error";
+        }
+        break;
+    }
+
+    return "unknown";
+}
+
+/*!
+    Writes the CSV column names to \a out.
+*/
+void DecodedItemExporter::writeHeader(QTextStream &out)
+{
+    out << "start_time,stop_time,start_sample,stop_sample,type,";
+
+    switch (mProtocol) {
+    case ProtocolUart:
+        out << "value,frame_error,parity_error\n";
+        break;
+    case ProtocolSpi:
+        out << "mosi,miso,frame_error\n";
+        break;
+    case ProtocolI2C:
+        out << "address,value,error\n";
+        break;
+    }
+}
+
+/*!
+    Writes the record \a r as a CSV row to \a out. An unknown stop index
+    is written as empty columns.
+*/
+void DecodedItemExporter::writeRecord(QTextStream &out, const Record &r)
+{
+    // enough digits to tell samples apart far into a long capture
+    out << QString::number(SampleTime::time(r.startIdx, mSampleRate), 'g', 15)
+        << ',';
+    if (r.stopIdx >= 0) {
+        out << QString::number(SampleTime::time(r.stopIdx, mSampleRate), 'g', 15);
+    }
+    out << ',' << r.startIdx << ',';
+    if (r.stopIdx >= 0) {
+        out << r.stopIdx;
+    }
+    out << ',' << typeName(r.type) << ',';
+
+    switch (mProtocol) {
+    case ProtocolUart:
+        out << r.value << ',' << ((r.flags & FlagFrameError) ? 1 : 0)
+            << ',' << ((r.flags & FlagParityError) ? 1 : 0);
+        break;
+    case ProtocolSpi:
+        out << r.value << ',' << r.value2
+            << ',' << ((r.flags & FlagFrameError) ? 1 : 0);
+        break;
+    case ProtocolI2C:
+        out << r.address << ',' << r.value
+            << ',' << ((r.flags & FlagError) ? 1 : 0);
+        break;
+    }
+
+    out << '\n';
+}
+
+/*!
+    Writes the binary file header to \a out.
+*/
+void DecodedItemExporter::writeHeader(QDataStream &out)
+{
+    out.writeRawData("LTDI", 4);
+    out << (quint16)BinaryVersion;
+    out << (quint8)mProtocol;
+    out << (quint8)0;
+    out << (quint32)mSampleRate;
+}
+
+/*!
+    Writes the record \a r as a binary record to \a out.
+*/
+void DecodedItemExporter::writeRecord(QDataStream &out, const Record &r)
+{
+    out << (qint64)r.startIdx;
+    out << (qint64)r.stopIdx;
+    out << (quint8)r.type;
+    out << (quint8)r.flags;
+    out << (quint16)r.address;
+    out << (qint32)r.value;
+    out << (qint32)r.value2;
+}
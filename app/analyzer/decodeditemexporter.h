@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DECODEDITEMEXPORTER_H
+#define DECODEDITEMEXPORTER_H
+
+#include <QObject>
+#include <QVector>
+#include <QAtomicInt>
+#include <QTextStream>
+#include <QDataStream>
+
+#include "common/sampleindex.h"
+#include "analyzer/uart/uiuartanalyzer.h"
+#include "analyzer/spi/uispianalyzer.h"
+#include "analyzer/i2c/i2citem.h"
+
+class DecodedItemExporter : public QObject
+{
+    Q_OBJECT
+public:
+
+    enum Format {
+        FormatCsv,
+        FormatBinary
+    };
+
+    enum Protocol {
+        ProtocolUart,
+        ProtocolSpi,
+        ProtocolI2C
+    };
+
+    enum Flags {
+        FlagFrameError = 0x01,
+        FlagParityError = 0x02,
+        FlagError = 0x04
+    };
+
+    enum Constants {
+        // version of the binary format
+        BinaryVersion = 1,
+        // number of items between progress signals
+        ProgressInterval = 10000
+    };
+
+    DecodedItemExporter(const QString &filePath, Format format, int sampleRate);
+
+    void setItems(const QVector<UartItem> &items);
+    void setItems(const QVector<SpiItem> &items);
+    void setItems(const QVector<I2CItem> &items);
+
+    bool succeeded() const {return mOk;}
+
+signals:
+    void progress(int percent);
+    void finished(bool ok);
+
+public slots:
+    void run();
+    void cancel();
+
+private:
+
+    /*!
+        An item in the protocol independent form that is written.
+    */
+    struct Record {
+        SampleIndex startIdx;
+        SampleIndex stopIdx;
+        int type;
+        int flags;
+        int address;
+        int value;
+        int value2;
+    };
+
+    QString mFilePath;
+    Format mFormat;
+    int mSampleRate;
+    Protocol mProtocol;
+
+    QVector<UartItem> mUartItems;
+    QVector<SpiItem> mSpiItems;
+    QVector<I2CItem> mI2cItems;
+
+    QAtomicInt mCancel;
+    bool mOk;
+
+    int numItems() const;
+    Record record(int i, int* address) const;
+    const char* typeName(int type) const;
+
+    template <class Stream> bool writeItems(Stream &out);
+    void writeHeader(QTextStream &out);
+    void writeRecord(QTextStream &out, const Record &r);
+    void writeHeader(QDataStream &out);
+    void writeRecord(QDataStream &out, const Record &r);
+};
+
+#endif // DECODEDITEMEXPORTER_H
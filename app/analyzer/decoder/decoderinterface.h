@@ -0,0 +1,173 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DECODERINTERFACE_H
+#define DECODERINTERFACE_H
+
+#include <QtPlugin>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+#include "common/sampleindex.h"
+
+/*!
+    \class DecoderEdge
+    \brief A change of the logic level on one of a decoder's channels.
+
+    \ingroup Analyzer
+
+    \internal
+
+*/
+class DecoderEdge {
+public:
+    /*! index of the decoder channel, see DecoderInterface::channels() */
+    int channel;
+    /*! sample index of the first sample with the new level */
+    SampleIndex sampleIdx;
+    /*! the new logic level, 0 or 1 */
+    int level;
+};
+
+/*!
+    \class DecoderItem
+    \brief An item decoded by a decoder, e.g., a byte or a start condition.
+
+    \ingroup Analyzer
+
+    \internal
+
+*/
+class DecoderItem {
+public:
+
+    /*!
+        Item flags
+    */
+    enum Flags {
+        FlagError = 0x01
+    };
+
+    // default constructor needed in order to add this to QVector
+    /*! Default constructor */
+    DecoderItem() {
+    }
+
+    /*! Constructs a new item */
+    DecoderItem(int type, int value, SampleIndex startIdx, SampleIndex stopIdx,
+                int flags = 0) {
+        this->type = type;
+        this->value = value;
+        this->startIdx = startIdx;
+        this->stopIdx = stopIdx;
+        this->flags = flags;
+    }
+
+    /*! index of the item type, see DecoderInterface::itemTypes() */
+    int type;
+    /*! value */
+    int value;
+    /*! item start index */
+    SampleIndex startIdx;
+    /*! item stop index, -1 if unknown */
+    SampleIndex stopIdx;
+    /*! flags */
+    int flags;
+};
+
+/*!
+    \class DecoderInterface
+    \brief Interface of a protocol decoder that doesn't depend on the UI.
+
+    \ingroup Analyzer
+
+    A decoder is given the edges of its channels in sample order, one chunk
+    at a time, and appends the items it has decoded. It must keep the state
+    it needs between chunks so that it can be used both on a complete
+    capture and on one that is still arriving. Decoders are created by a
+    DecoderPlugin and run by a DecoderSession.
+*/
+class DecoderInterface
+{
+public:
+    virtual ~DecoderInterface() {}
+
+    /*! Returns the name of the decoder, e.g., "CAN". */
+    virtual QString name() const = 0;
+
+    /*! Returns the names of the input channels, e.g., "SCL" and "SDA". */
+    virtual QStringList channels() const = 0;
+
+    /*! Returns the names of the item types, indexed by DecoderItem::type. */
+    virtual QStringList itemTypes() const = 0;
+
+    /*! Returns the settings, e.g., a bit rate, with their current values. */
+    virtual QVariantMap settings() const = 0;
+
+    /*! Changes the \a settings. Unknown settings are ignored. */
+    virtual void setSettings(const QVariantMap &settings) = 0;
+
+    /*!
+        Starts a new decode at \a sampleRate where \a levels are the levels
+        of the channels at sample 0.
+    */
+    virtual void reset(int sampleRate, const QVector<int> &levels) = 0;
+
+    /*!
+        Decodes the \a count edges starting at \a edges and appends the
+        decoded items to \a items.
+    */
+    virtual void decode(const DecoderEdge* edges, int count,
+                        QVector<DecoderItem> &items) = 0;
+
+    /*!
+        Called when there are no more edges up to and including
+        \a lastSampleIdx. Items that can be completed are appended to
+        \a items.
+    */
+    virtual void finish(SampleIndex lastSampleIdx, QVector<DecoderItem> &items) = 0;
+};
+
+/*!
+    \class DecoderPlugin
+    \brief Interface of a plugin with one or more decoders.
+
+    \ingroup Analyzer
+
+    A plugin is a Qt plugin (see QPluginLoader) that implements this
+    interface and is put in the decoders folder next to the application.
+*/
+class DecoderPlugin
+{
+public:
+    virtual ~DecoderPlugin() {}
+
+    /*! Returns the names of the decoders in the plugin. */
+    virtual QStringList decoders() const = 0;
+
+    /*!
+        Creates the decoder with the given \a name. The caller is
+        responsible for deallocation.
+    */
+    virtual DecoderInterface* createDecoder(const QString &name) = 0;
+};
+
+#define DecoderPlugin_iid "com.embeddedartists.LabTool.DecoderPlugin/1.0"
+
+Q_DECLARE_INTERFACE(DecoderPlugin, DecoderPlugin_iid)
+
+#endif // DECODERINTERFACE_H
@@ -0,0 +1,143 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "decodermanager.h"
+
+#include <QDebug>
+#include <QCoreApplication>
+#include <QDir>
+#include <QPluginLoader>
+
+#include "uartdecoder.h"
+#include "i2cdecoder.h"
+#include "spidecoder.h"
+
+/*!
+    \class DecoderManager
+    \brief This class is responsible for creating decoders.
+
+    \ingroup Analyzer
+
+    There are built-in decoders for UART, I2C and SPI which work on signal
+    transitions, see UartDecoder, I2CDecoder and SpiDecoder. Other decoders
+    are found in plugins.
+
+    The plugins are loaded from the \c decoders folder in the application's
+    folder, or in the current folder, the first time the decoders are
+    requested. A plugin that can't be loaded or that doesn't implement
+    DecoderPlugin is ignored. If two plugins have a decoder with the same
+    name, or a built-in decoder has that name, the first one found is
+    used.
+*/
+
+/*!
+    Constructs the DecoderManager.
+*/
+DecoderManager::DecoderManager()
+{
+    mLoaded = false;
+}
+
+/*!
+    Returns the names of all decoders, built-in decoders first.
+*/
+QStringList DecoderManager::decoders()
+{
+    return builtInDecoders() + pluginDecoders();
+}
+
+/*!
+    Returns the names of the built-in decoders.
+*/
+QStringList DecoderManager::builtInDecoders() const
+{
+    return QStringList()
+            << UartDecoder::decoderName
+            << I2CDecoder::decoderName
+            << SpiDecoder::decoderName;
+}
+
+/*!
+    Returns the names of all decoders found in the plugins.
+*/
+QStringList DecoderManager::pluginDecoders()
+{
+    loadPlugins();
+
+    QStringList names = mDecoders.keys();
+    foreach(QString name, builtInDecoders()) {
+        names.removeAll(name);
+    }
+
+    return names;
+}
+
+/*!
+    Creates the decoder with the given \a name. NULL is returned if there
+    isn't a decoder with that name. The caller is responsible for
+    deallocation.
+*/
+DecoderInterface* DecoderManager::createDecoder(const QString &name)
+{
+    // Deallocation: caller is responsible for deallocation
+    if (name == UartDecoder::decoderName) return new UartDecoder();
+    if (name == I2CDecoder::decoderName) return new I2CDecoder();
+    if (name == SpiDecoder::decoderName) return new SpiDecoder();
+
+    loadPlugins();
+
+    DecoderPlugin* plugin = mDecoders.value(name, NULL);
+    if (plugin == NULL) return NULL;
+
+    return plugin->createDecoder(name);
+}
+
+/*!
+    Loads the plugins if not already done.
+*/
+void DecoderManager::loadPlugins()
+{
+    if (mLoaded) return;
+    mLoaded = true;
+
+    QStringList paths;
+    paths << QCoreApplication::applicationDirPath() + "/decoders"
+          << QDir::currentPath() + "/decoders";
+
+    foreach(QString path, paths) {
+        QDir dir(path);
+        if (!dir.exists()) continue;
+
+        foreach(QString fileName, dir.entryList(QDir::Files)) {
+            // Deallocation: The loaded plugin instance is kept until
+            //               the application exits
+            QPluginLoader loader(dir.absoluteFilePath(fileName));
+            DecoderPlugin* plugin = qobject_cast<DecoderPlugin*>(loader.instance());
+            if (plugin == NULL) {
+                qDebug() << "Not a decoder plugin:" << fileName << loader.errorString();
+                continue;
+            }
+
+            foreach(QString name, plugin->decoders()) {
+                if (!mDecoders.contains(name)) {
+                    mDecoders.insert(name, plugin);
+                }
+            }
+        }
+
+        // the current folder is often the application's folder
+        if (QDir(paths.at(0)) == QDir(paths.at(1))) break;
+    }
+}
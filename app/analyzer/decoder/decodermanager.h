@@ -0,0 +1,53 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DECODERMANAGER_H
+#define DECODERMANAGER_H
+
+#include <QList>
+#include <QMap>
+#include <QStringList>
+
+#include "decoderinterface.h"
+
+class DecoderManager
+{
+public:
+
+    static DecoderManager& instance()
+    {
+        static DecoderManager singleton;
+        return singleton;
+    }
+
+    QStringList decoders();
+    QStringList builtInDecoders() const;
+    QStringList pluginDecoders();
+    DecoderInterface* createDecoder(const QString &name);
+
+private:
+    explicit DecoderManager();
+    // hide copy constructor
+    DecoderManager(const DecoderManager&);
+    // hide assign operator
+    DecoderManager& operator=(const DecoderManager &);
+
+    bool mLoaded;
+    QMap<QString, DecoderPlugin*> mDecoders;
+
+    void loadPlugins();
+};
+
+#endif // DECODERMANAGER_H
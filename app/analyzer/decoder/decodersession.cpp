@@ -0,0 +1,218 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "decodersession.h"
+
+/*!
+    \class DecoderSession
+    \brief Runs a decoder and collects its items and statistics.
+
+    \ingroup Analyzer
+
+    The session doesn't depend on the UI. Edges can either be pushed to the
+    decoder with feed() as they become available, e.g., from a capture that
+    is still arriving, or be taken from the transition storage of a complete
+    capture with decodeTransitions(). In both cases the decoder is given
+    the edges in chunks of at most ChunkSize edges.
+
+    The time spent in the decoder as well as the number of edges and items
+    are counted, both for the current decode and in total for the session,
+    to give the decoder's throughput.
+*/
+
+/*!
+    \fn double DecoderSession::Statistics::edgesPerSecond() const
+
+    Returns the number of edges decoded per second of decoder time.
+*/
+double DecoderSession::Statistics::edgesPerSecond() const
+{
+    if (elapsedNs <= 0) return 0;
+    return edges*1e9/elapsedNs;
+}
+
+/*!
+    Constructs a session running \a decoder. The session takes ownership
+    of the decoder.
+*/
+DecoderSession::DecoderSession(DecoderInterface *decoder)
+{
+    // Deallocation: Destructor is responsible
+    mDecoder = decoder;
+
+    mStatistics.edges = 0;
+    mStatistics.items = 0;
+    mStatistics.chunks = 0;
+    mStatistics.elapsedNs = 0;
+    mTotal = mStatistics;
+
+    mTimer.start();
+}
+
+/*!
+    Deletes the session and its decoder.
+*/
+DecoderSession::~DecoderSession()
+{
+    delete mDecoder;
+}
+
+/*!
+    Starts a new decode at \a sampleRate where \a levels are the levels of
+    the decoder's channels at sample 0. Previously decoded items are
+    removed.
+*/
+void DecoderSession::start(int sampleRate, const QVector<int> &levels)
+{
+    mItems.clear();
+    mStatistics.edges = 0;
+    mStatistics.items = 0;
+    mStatistics.chunks = 0;
+    mStatistics.elapsedNs = 0;
+
+    mDecoder->reset(sampleRate, levels);
+}
+
+/*!
+    Gives the \a count edges starting at \a edges to the decoder. The
+    edges must come after all edges given before since start().
+*/
+void DecoderSession::feed(const DecoderEdge *edges, int count)
+{
+    for (int i = 0; i < count; i += ChunkSize) {
+        int n = qMin((int)ChunkSize, count - i);
+        int before = mItems.size();
+
+        qint64 t = mTimer.nsecsElapsed();
+        mDecoder->decode(edges + i, n, mItems);
+        this->count(n, mItems.size() - before, mTimer.nsecsElapsed() - t);
+    }
+}
+
+/*!
+    Tells the decoder that there are no more edges up to and including
+    \a lastSampleIdx.
+*/
+void DecoderSession::finish(SampleIndex lastSampleIdx)
+{
+    int before = mItems.size();
+
+    qint64 t = mTimer.nsecsElapsed();
+    mDecoder->finish(lastSampleIdx, mItems);
+    count(0, mItems.size() - before, mTimer.nsecsElapsed() - t);
+}
+
+/*!
+    Decodes a complete capture where \a channels are the transitions of
+    the decoder's channels, in the order of DecoderInterface::channels(),
+    captured at \a sampleRate. A channel without transitions (NULL) is
+    always low. The transitions of the channels are merged in sample order.
+*/
+void DecoderSession::decodeTransitions(const QVector<const DigitalTransitions*> &channels,
+                                       int sampleRate)
+{
+    int n = channels.size();
+    QVector<int> levels(n);
+    QVector<DigitalTransitions::const_iterator> heads;
+    SampleIndex last = 0;
+
+    for (int i = 0; i < n; i++) {
+        const DigitalTransitions* t = channels.at(i);
+        if (t == NULL) {
+            levels[i] = 0;
+            heads.append(DigitalTransitions::const_iterator());
+            continue;
+        }
+
+        levels[i] = t->initialLevel();
+        heads.append(t->begin());
+        last = qMax(last, t->lastSampleIndex());
+    }
+
+    start(sampleRate, levels);
+
+    QVector<DecoderEdge> chunk;
+    chunk.reserve(ChunkSize);
+
+    while (true) {
+        // the channel with the earliest next transition
+        int next = -1;
+        for (int i = 0; i < n; i++) {
+            if (channels.at(i) == NULL || heads.at(i) == channels.at(i)->end()) {
+                continue;
+            }
+            if (next == -1 || *heads.at(i) < *heads.at(next)) {
+                next = i;
+            }
+        }
+        if (next == -1) break;
+
+        DecoderEdge e;
+        e.channel = next;
+        e.sampleIdx = *heads.at(next);
+        levels[next] = (levels.at(next) + 1) % 2;
+        e.level = levels.at(next);
+        chunk.append(e);
+        ++heads[next];
+
+        if (chunk.size() == ChunkSize) {
+            feed(chunk.constData(), chunk.size());
+            chunk.clear();
+        }
+    }
+
+    feed(chunk.constData(), chunk.size());
+    finish(last);
+}
+
+/*!
+    \fn DecoderInterface* DecoderSession::decoder() const
+
+    Returns the decoder run by this session.
+*/
+
+/*!
+    \fn const QVector<DecoderItem> &DecoderSession::items() const
+
+    Returns the items decoded since start().
+*/
+
+/*!
+    \fn const DecoderSession::Statistics &DecoderSession::statistics() const
+
+    Returns the statistics since start().
+*/
+
+/*!
+    \fn const DecoderSession::Statistics &DecoderSession::totalStatistics() const
+
+    Returns the statistics for all decodes in this session.
+*/
+
+/*!
+    Adds \a edges, \a items and \a elapsedNs to the statistics.
+*/
+void DecoderSession::count(int edges, int items, qint64 elapsedNs)
+{
+    mStatistics.edges += edges;
+    mStatistics.items += items;
+    mStatistics.chunks += (edges > 0) ? 1 : 0;
+    mStatistics.elapsedNs += elapsedNs;
+
+    mTotal.edges += edges;
+    mTotal.items += items;
+    mTotal.chunks += (edges > 0) ? 1 : 0;
+    mTotal.elapsedNs += elapsedNs;
+}
@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DECODERSESSION_H
+#define DECODERSESSION_H
+
+#include <QVector>
+#include <QElapsedTimer>
+
+#include "decoderinterface.h"
+#include "device/digitaltransitions.h"
+
+class DecoderSession
+{
+public:
+
+    /*!
+        Counters for the work done by the decoder.
+    */
+    struct Statistics {
+        qint64 edges;
+        qint64 items;
+        qint64 chunks;
+        qint64 elapsedNs;
+
+        double edgesPerSecond() const;
+    };
+
+    enum Constants {
+        // number of edges given to the decoder at a time
+        ChunkSize = 4096
+    };
+
+    explicit DecoderSession(DecoderInterface* decoder);
+    ~DecoderSession();
+
+    DecoderInterface* decoder() const {return mDecoder;}
+
+    void start(int sampleRate, const QVector<int> &levels);
+    void feed(const DecoderEdge* edges, int count);
+    void finish(SampleIndex lastSampleIdx);
+
+    void decodeTransitions(const QVector<const DigitalTransitions*> &channels,
+                           int sampleRate);
+
+    const QVector<DecoderItem> &items() const {return mItems;}
+    const Statistics &statistics() const {return mStatistics;}
+    const Statistics &totalStatistics() const {return mTotal;}
+
+private:
+    DecoderInterface* mDecoder;
+    QVector<DecoderItem> mItems;
+    Statistics mStatistics;
+    Statistics mTotal;
+    QElapsedTimer mTimer;
+
+    void count(int edges, int items, qint64 elapsedNs);
+};
+
+#endif // DECODERSESSION_H
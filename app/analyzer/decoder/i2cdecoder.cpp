@@ -0,0 +1,163 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "i2cdecoder.h"
+
+/*!
+    Name of this decoder.
+*/
+const QString I2CDecoder::decoderName = "I2C";
+
+/*!
+    \class I2CDecoder
+    \brief An I2C decoder working on signal transitions.
+
+    \ingroup Analyzer
+
+    A start (or repeated start) is SDA going low while SCL is high and a
+    stop is SDA going high while SCL is high. In between, SDA is sampled
+    when SCL goes high: eight bits MSB first followed by the acknowledge
+    bit. The first byte after a start is the 7-bit address.
+
+    The value of an ACK or NACK item is the address of the transfer it
+    belongs to, so that, e.g., a NACK from a specific device can be found
+    without looking at the items before it.
+*/
+
+/*!
+    Constructs the decoder.
+*/
+I2CDecoder::I2CDecoder()
+{
+    mScl = 1;
+    mSda = 1;
+    mInTransfer = false;
+    mAddressPhase = false;
+    mAddress = 0;
+    mBit = 0;
+    mValue = 0;
+    mByteStart = 0;
+    mLastClock = 0;
+}
+
+/*!
+    Returns the channels, "SCL" and "SDA".
+*/
+QStringList I2CDecoder::channels() const
+{
+    return QStringList() << "SCL" << "SDA";
+}
+
+/*!
+    Returns the item types, indexed by ItemType.
+*/
+QStringList I2CDecoder::itemTypes() const
+{
+    return QStringList() << "Start" << "Repeated Start" << "Stop"
+                         << "Write Address" << "Read Address" << "Data"
+                         << "ACK" << "NACK";
+}
+
+/*!
+    Starts a new decode with the initial \a levels. The \a sampleRate
+    isn't needed by this decoder.
+*/
+void I2CDecoder::reset(int sampleRate, const QVector<int> &levels)
+{
+    (void)sampleRate;
+
+    mScl = levels.value(SCL, 1);
+    mSda = levels.value(SDA, 1);
+    mInTransfer = false;
+}
+
+/*!
+    Decodes the \a count \a edges and appends the items to \a items.
+*/
+void I2CDecoder::decode(const DecoderEdge *edges, int count, QVector<DecoderItem> &items)
+{
+    for (int i = 0; i < count; i++) {
+        const DecoderEdge &e = edges[i];
+
+        if (e.channel == SDA) {
+            mSda = e.level;
+            if (mScl == 0) continue;
+
+            if (mSda == 0) {
+                items.append(DecoderItem(mInTransfer ? TYPE_REPEATED_START : TYPE_START,
+                                         0, e.sampleIdx, -1));
+                mInTransfer = true;
+                mAddressPhase = true;
+                mBit = 0;
+                mValue = 0;
+            }
+            else if (mInTransfer) {
+                items.append(DecoderItem(TYPE_STOP, 0, e.sampleIdx, -1));
+                mInTransfer = false;
+            }
+        }
+        else if (e.channel == SCL) {
+            mScl = e.level;
+            if (mScl == 1 && mInTransfer) {
+                clockBit(e.sampleIdx, items);
+            }
+        }
+    }
+}
+
+/*!
+    Nothing to complete since an incomplete byte is ignored.
+*/
+void I2CDecoder::finish(SampleIndex lastSampleIdx, QVector<DecoderItem> &items)
+{
+    (void)lastSampleIdx;
+    (void)items;
+
+    mInTransfer = false;
+}
+
+/*!
+    Samples SDA on the rising SCL edge at \a sampleIdx.
+*/
+void I2CDecoder::clockBit(SampleIndex sampleIdx, QVector<DecoderItem> &items)
+{
+    int bit = mBit++;
+
+    if (bit == 0) {
+        mByteStart = sampleIdx;
+    }
+
+    if (bit < 8) {
+        mValue = (mValue << 1) | mSda;
+        mLastClock = sampleIdx;
+        return;
+    }
+
+    // the acknowledge bit ends the byte
+    if (mAddressPhase) {
+        mAddress = (mValue >> 1);
+        items.append(DecoderItem((mValue & 1) ? TYPE_ADDRESS_READ : TYPE_ADDRESS_WRITE,
+                                 mAddress, mByteStart, mLastClock));
+        mAddressPhase = false;
+    }
+    else {
+        items.append(DecoderItem(TYPE_DATA, mValue, mByteStart, mLastClock));
+    }
+
+    items.append(DecoderItem(mSda ? TYPE_NACK : TYPE_ACK, mAddress, sampleIdx, -1));
+
+    mBit = 0;
+    mValue = 0;
+}
@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef I2CDECODER_H
+#define I2CDECODER_H
+
+#include "decoderinterface.h"
+
+class I2CDecoder : public DecoderInterface
+{
+public:
+    static const QString decoderName;
+
+    /*!
+        Item types
+    */
+    enum ItemType {
+        TYPE_START,
+        TYPE_REPEATED_START,
+        TYPE_STOP,
+        TYPE_ADDRESS_WRITE,
+        TYPE_ADDRESS_READ,
+        TYPE_DATA,
+        TYPE_ACK,
+        TYPE_NACK
+    };
+
+    I2CDecoder();
+
+    QString name() const {return decoderName;}
+    QStringList channels() const;
+    QStringList itemTypes() const;
+    QVariantMap settings() const {return QVariantMap();}
+    void setSettings(const QVariantMap &settings) {(void)settings;}
+
+    void reset(int sampleRate, const QVector<int> &levels);
+    void decode(const DecoderEdge* edges, int count, QVector<DecoderItem> &items);
+    void finish(SampleIndex lastSampleIdx, QVector<DecoderItem> &items);
+
+private:
+
+    enum Channel {
+        SCL,
+        SDA
+    };
+
+    int mScl;
+    int mSda;
+    bool mInTransfer;
+    bool mAddressPhase;
+    int mAddress;
+    int mBit;
+    int mValue;
+    SampleIndex mByteStart;
+    SampleIndex mLastClock;
+
+    void clockBit(SampleIndex sampleIdx, QVector<DecoderItem> &items);
+};
+
+#endif // I2CDECODER_H
@@ -0,0 +1,189 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "spidecoder.h"
+
+/*!
+    Name of this decoder.
+*/
+const QString SpiDecoder::decoderName = "SPI";
+
+/*!
+    \class SpiDecoder
+    \brief An SPI decoder working on signal transitions.
+
+    \ingroup Analyzer
+
+    While the enable signal (CS) is active MOSI and MISO are sampled on
+    the rising SCK edge in mode 0 and 3 and on the falling edge in mode 1
+    and 2, MSB first. One MOSI and one MISO item are added for each
+    complete word. A frame error item is added if the enable signal
+    becomes inactive in the middle of a word.
+
+    An edge on MOSI or MISO at the same sample as the SCK edge is taken as
+    happening after the SCK edge.
+*/
+
+/*!
+    Constructs the decoder in mode 0 with an active low enable signal and
+    8 data bits.
+*/
+SpiDecoder::SpiDecoder()
+{
+    mMode = Types::SpiMode_0;
+    mEnableMode = Types::SpiEnableLow;
+    mDataBits = 8;
+
+    for (int i = 0; i < 4; i++) {
+        mLevels[i] = 0;
+    }
+    mEnabled = false;
+    mBit = 0;
+    mMosiValue = 0;
+    mMisoValue = 0;
+    mWordStart = 0;
+}
+
+/*!
+    Returns the channels, "SCK", "MOSI", "MISO" and "CS".
+*/
+QStringList SpiDecoder::channels() const
+{
+    return QStringList() << "SCK" << "MOSI" << "MISO" << "CS";
+}
+
+/*!
+    Returns the item types, indexed by ItemType.
+*/
+QStringList SpiDecoder::itemTypes() const
+{
+    return QStringList() << "MOSI" << "MISO" << "Frame Error";
+}
+
+/*!
+    Returns the settings.
+*/
+QVariantMap SpiDecoder::settings() const
+{
+    QVariantMap map;
+    map.insert("Mode", (int)mMode);
+    map.insert("Enable", (mEnableMode == Types::SpiEnableLow) ? "Low" : "High");
+    map.insert("Data bits", mDataBits);
+
+    return map;
+}
+
+/*!
+    Changes the \a settings. Invalid values are ignored.
+*/
+void SpiDecoder::setSettings(const QVariantMap &settings)
+{
+    int v = settings.value("Mode", (int)mMode).toInt();
+    if (v >= 0 && v < Types::SpiMode_Num) mMode = (Types::SpiMode)v;
+
+    QString enable = settings.value("Enable").toString();
+    if (enable == "Low") mEnableMode = Types::SpiEnableLow;
+    else if (enable == "High") mEnableMode = Types::SpiEnableHigh;
+
+    v = settings.value("Data bits", mDataBits).toInt();
+    if (v > 0 && v <= 16) mDataBits = v;
+}
+
+/*!
+    Starts a new decode with the initial \a levels. The \a sampleRate
+    isn't needed by this decoder.
+*/
+void SpiDecoder::reset(int sampleRate, const QVector<int> &levels)
+{
+    (void)sampleRate;
+
+    for (int i = 0; i < 4; i++) {
+        mLevels[i] = levels.value(i, 0);
+    }
+
+    mEnabled = isEnabled();
+    startWord();
+}
+
+/*!
+    Decodes the \a count \a edges and appends the items to \a items.
+*/
+void SpiDecoder::decode(const DecoderEdge *edges, int count, QVector<DecoderItem> &items)
+{
+    // CPOL == CPHA -> sample on the rising edge
+    int sampleLevel = (mMode == Types::SpiMode_0 || mMode == Types::SpiMode_3) ? 1 : 0;
+
+    for (int i = 0; i < count; i++) {
+        const DecoderEdge &e = edges[i];
+        if (e.channel < 0 || e.channel > CS) continue;
+
+        mLevels[e.channel] = e.level;
+
+        if (e.channel == CS) {
+            bool enabled = isEnabled();
+
+            if (mEnabled && !enabled && mBit > 0) {
+                items.append(DecoderItem(TYPE_FRAME_ERROR, 0, mWordStart, e.sampleIdx,
+                                         DecoderItem::FlagError));
+            }
+
+            mEnabled = enabled;
+            startWord();
+        }
+        else if (e.channel == SCK && mEnabled && e.level == sampleLevel) {
+            if (mBit == 0) {
+                mWordStart = e.sampleIdx;
+            }
+
+            mMosiValue = (mMosiValue << 1) | mLevels[MOSI];
+            mMisoValue = (mMisoValue << 1) | mLevels[MISO];
+
+            if (++mBit == mDataBits) {
+                items.append(DecoderItem(TYPE_MOSI, mMosiValue, mWordStart, e.sampleIdx));
+                items.append(DecoderItem(TYPE_MISO, mMisoValue, mWordStart, e.sampleIdx));
+                startWord();
+            }
+        }
+    }
+}
+
+/*!
+    Nothing to complete since an incomplete word is ignored.
+*/
+void SpiDecoder::finish(SampleIndex lastSampleIdx, QVector<DecoderItem> &items)
+{
+    (void)lastSampleIdx;
+    (void)items;
+
+    startWord();
+}
+
+/*!
+    Returns true if the enable signal is active.
+*/
+bool SpiDecoder::isEnabled() const
+{
+    return mLevels[CS] == ((mEnableMode == Types::SpiEnableLow) ? 0 : 1);
+}
+
+/*!
+    Starts on a new word.
+*/
+void SpiDecoder::startWord()
+{
+    mBit = 0;
+    mMosiValue = 0;
+    mMisoValue = 0;
+}
@@ -0,0 +1,72 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SPIDECODER_H
+#define SPIDECODER_H
+
+#include "decoderinterface.h"
+#include "common/types.h"
+
+class SpiDecoder : public DecoderInterface
+{
+public:
+    static const QString decoderName;
+
+    /*!
+        Item types
+    */
+    enum ItemType {
+        TYPE_MOSI,
+        TYPE_MISO,
+        TYPE_FRAME_ERROR
+    };
+
+    SpiDecoder();
+
+    QString name() const {return decoderName;}
+    QStringList channels() const;
+    QStringList itemTypes() const;
+    QVariantMap settings() const;
+    void setSettings(const QVariantMap &settings);
+
+    void reset(int sampleRate, const QVector<int> &levels);
+    void decode(const DecoderEdge* edges, int count, QVector<DecoderItem> &items);
+    void finish(SampleIndex lastSampleIdx, QVector<DecoderItem> &items);
+
+private:
+
+    enum Channel {
+        SCK,
+        MOSI,
+        MISO,
+        CS
+    };
+
+    Types::SpiMode mMode;
+    Types::SpiEnable mEnableMode;
+    int mDataBits;
+
+    int mLevels[4];
+    bool mEnabled;
+    int mBit;
+    int mMosiValue;
+    int mMisoValue;
+    SampleIndex mWordStart;
+
+    bool isEnabled() const;
+    void startWord();
+};
+
+#endif // SPIDECODER_H
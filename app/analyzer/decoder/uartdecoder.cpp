@@ -0,0 +1,235 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uartdecoder.h"
+
+/*!
+    Name of this decoder.
+*/
+const QString UartDecoder::decoderName = "UART";
+
+/*!
+    \class UartDecoder
+    \brief A UART decoder working on signal transitions.
+
+    \ingroup Analyzer
+
+    The decoder waits for a falling edge, which is the start bit, and then
+    takes the level in the middle of each bit of the frame. Since the level
+    only changes at an edge the bits between two edges are given by the
+    level before the second edge, which means that the decoder never looks
+    at individual samples.
+
+    A data item is added for each complete frame, a parity error item if
+    the parity bit is wrong and a frame error item if a stop bit is low.
+*/
+
+/*!
+    Constructs the decoder with 115200 baud, 8 data bits, no parity and
+    1 stop bit.
+*/
+UartDecoder::UartDecoder()
+{
+    mBaudRate = 115200;
+    mDataBits = 8;
+    mStopBits = 1;
+    mParity = Types::ParityNone;
+
+    mBitTime = 0;
+    mLevel = 1;
+    mInFrame = false;
+    mFrameStart = 0;
+    mBit = 0;
+    mValue = 0;
+    mOnes = 0;
+    mParityError = false;
+}
+
+/*!
+    Returns the channels, only "RX".
+*/
+QStringList UartDecoder::channels() const
+{
+    return QStringList() << "RX";
+}
+
+/*!
+    Returns the item types, indexed by ItemType.
+*/
+QStringList UartDecoder::itemTypes() const
+{
+    return QStringList() << "Data" << "Frame Error" << "Parity Error";
+}
+
+/*!
+    Returns the settings.
+*/
+QVariantMap UartDecoder::settings() const
+{
+    QStringList parity;
+    parity << "None" << "Odd" << "Even" << "Mark" << "Space";
+
+    QVariantMap map;
+    map.insert("Baud rate", mBaudRate);
+    map.insert("Data bits", mDataBits);
+    map.insert("Parity", parity.at(mParity));
+    map.insert("Stop bits", mStopBits);
+
+    return map;
+}
+
+/*!
+    Changes the \a settings. Invalid values are ignored.
+*/
+void UartDecoder::setSettings(const QVariantMap &settings)
+{
+    QStringList parity;
+    parity << "None" << "Odd" << "Even" << "Mark" << "Space";
+
+    int v = settings.value("Baud rate", mBaudRate).toInt();
+    if (v > 0) mBaudRate = v;
+
+    v = settings.value("Data bits", mDataBits).toInt();
+    if (v > 0 && v <= 16) mDataBits = v;
+
+    v = parity.indexOf(settings.value("Parity", parity.at(mParity)).toString());
+    if (v != -1) mParity = (Types::UartParity)v;
+
+    v = settings.value("Stop bits", mStopBits).toInt();
+    if (v > 0 && v <= 2) mStopBits = v;
+}
+
+/*!
+    Starts a new decode at \a sampleRate with the initial \a levels.
+*/
+void UartDecoder::reset(int sampleRate, const QVector<int> &levels)
+{
+    mBitTime = (double)sampleRate/mBaudRate;
+    mLevel = levels.value(0, 1);
+    mInFrame = false;
+}
+
+/*!
+    Decodes the \a count \a edges and appends the items to \a items.
+*/
+void UartDecoder::decode(const DecoderEdge *edges, int count, QVector<DecoderItem> &items)
+{
+    // if there aren't enough samples per bit the decoding isn't reliable
+    if (mBitTime < 3) return;
+
+    for (int i = 0; i < count; i++) {
+        const DecoderEdge &e = edges[i];
+
+        // all bits sampled before this edge have the current level
+        sampleUntil(e.sampleIdx, items);
+
+        mLevel = e.level;
+
+        if (!mInFrame && mLevel == 0) {
+            mInFrame = true;
+            mFrameStart = e.sampleIdx;
+            mBit = 0;
+            mValue = 0;
+            mOnes = 0;
+            mParityError = false;
+        }
+    }
+}
+
+/*!
+    Samples the remaining bits up to \a lastSampleIdx. An incomplete frame
+    is ignored.
+*/
+void UartDecoder::finish(SampleIndex lastSampleIdx, QVector<DecoderItem> &items)
+{
+    if (mBitTime < 3) return;
+
+    sampleUntil(lastSampleIdx+1, items);
+    mInFrame = false;
+}
+
+/*!
+    Samples all bits of the current frame with a center before
+    \a sampleIdx.
+*/
+void UartDecoder::sampleUntil(SampleIndex sampleIdx, QVector<DecoderItem> &items)
+{
+    while (mInFrame) {
+        // center of the bit after the start bit
+        SampleIndex center = mFrameStart + (SampleIndex)((mBit + 1.5)*mBitTime);
+        if (center >= sampleIdx) break;
+
+        sampleBit(center, items);
+    }
+}
+
+/*!
+    Takes the current level as the value of the next bit in the frame,
+    which has its center at \a sampleIdx.
+*/
+void UartDecoder::sampleBit(SampleIndex sampleIdx, QVector<DecoderItem> &items)
+{
+    int parityBits = (mParity != Types::ParityNone) ? 1 : 0;
+    int bit = mBit++;
+
+    // --- data
+    if (bit < mDataBits) {
+        mValue |= (mLevel << bit);
+        mOnes += mLevel;
+        return;
+    }
+
+    // --- parity
+    if (bit < mDataBits + parityBits) {
+        switch(mParity) {
+        case Types::ParityOdd:
+            mParityError = (((mOnes + mLevel) % 2) == 0);
+            break;
+        case Types::ParityEven:
+            mParityError = (((mOnes + mLevel) % 2) != 0);
+            break;
+        case Types::ParityMark:
+            mParityError = (mLevel == 0);
+            break;
+        case Types::ParitySpace:
+            mParityError = (mLevel == 1);
+            break;
+        default:
+            break;
+        }
+        return;
+    }
+
+    // --- stop
+    SampleIndex stopIdx = sampleIdx + (SampleIndex)(mBitTime/2);
+
+    if (mLevel == 0) {
+        items.append(DecoderItem(TYPE_FRAME_ERROR, mValue, mFrameStart, stopIdx,
+                                 DecoderItem::FlagError));
+        mInFrame = false;
+        return;
+    }
+
+    if (bit == mDataBits + parityBits + mStopBits - 1) {
+        if (mParityError) {
+            items.append(DecoderItem(TYPE_PARITY_ERROR, mValue, mFrameStart, stopIdx,
+                                     DecoderItem::FlagError));
+        }
+        else {
+            items.append(DecoderItem(TYPE_DATA, mValue, mFrameStart, stopIdx));
+        }
+        mInFrame = false;
+    }
+}
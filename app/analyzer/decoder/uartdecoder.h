@@ -0,0 +1,67 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UARTDECODER_H
+#define UARTDECODER_H
+
+#include "decoderinterface.h"
+#include "common/types.h"
+
+class UartDecoder : public DecoderInterface
+{
+public:
+    static const QString decoderName;
+
+    /*!
+        Item types
+    */
+    enum ItemType {
+        TYPE_DATA,
+        TYPE_FRAME_ERROR,
+        TYPE_PARITY_ERROR
+    };
+
+    UartDecoder();
+
+    QString name() const {return decoderName;}
+    QStringList channels() const;
+    QStringList itemTypes() const;
+    QVariantMap settings() const;
+    void setSettings(const QVariantMap &settings);
+
+    void reset(int sampleRate, const QVector<int> &levels);
+    void decode(const DecoderEdge* edges, int count, QVector<DecoderItem> &items);
+    void finish(SampleIndex lastSampleIdx, QVector<DecoderItem> &items);
+
+private:
+    int mBaudRate;
+    int mDataBits;
+    int mStopBits;
+    Types::UartParity mParity;
+
+    double mBitTime;
+    int mLevel;
+    bool mInFrame;
+    SampleIndex mFrameStart;
+    int mBit;
+    int mValue;
+    int mOnes;
+    bool mParityError;
+
+    void sampleUntil(SampleIndex sampleIdx, QVector<DecoderItem> &items);
+    void sampleBit(SampleIndex sampleIdx, QVector<DecoderItem> &items);
+};
+
+#endif // UARTDECODER_H
@@ -0,0 +1,487 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uidecoderanalyzer.h"
+
+#include <QDebug>
+#include <QUrl>
+
+#include "decodermanager.h"
+#include "uidecoderanalyzerconfig.h"
+#include "device/devicemanager.h"
+#include "common/configuration.h"
+
+/*!
+    Counter used when creating the editable name.
+*/
+int UiDecoderAnalyzer::decoderAnalyzerCounter = 0;
+
+/*!
+    Name of this analyzer. The analyzer itself is listed with the names of
+    the decoders, see DecoderManager.
+*/
+const QString UiDecoderAnalyzer::name = "Decoder Plugin";
+
+/*!
+    \class UiDecoderAnalyzer
+    \brief This class visualizes the items decoded by a decoder plugin.
+
+    \ingroup Analyzer
+
+    The class maps each channel of a DecoderInterface to a digital signal,
+    runs the decoder on the transitions of the signals with a
+    DecoderSession and paints the decoded items. The decoder's throughput
+    is shown as a tool tip.
+
+*/
+
+
+/*!
+    Constructs the UiDecoderAnalyzer running \a decoder with the given
+    \a parent. The analyzer takes ownership of the decoder.
+*/
+UiDecoderAnalyzer::UiDecoderAnalyzer(DecoderInterface *decoder, QWidget *parent) :
+    UiAnalyzer(parent)
+{
+    // Deallocation: Destructor is responsible
+    mSession = new DecoderSession(decoder);
+    mSignalIds.fill(-1, decoder->channels().size());
+    mFormat = Types::DataFormatHex;
+    mItemTypes = decoder->itemTypes();
+
+    mIdLbl->setText(decoder->name());
+    mNameLbl->setText(QString("%1 %2").arg(decoder->name())
+                      .arg(decoderAnalyzerCounter++));
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSignalLbl = new QLabel(this);
+
+    QPalette palette= mSignalLbl->palette();
+    palette.setColor(QPalette::Text, Qt::gray);
+    mSignalLbl->setPalette(palette);
+
+    setFixedHeight(50);
+}
+
+/*!
+    Deletes the analyzer and its decoder.
+*/
+UiDecoderAnalyzer::~UiDecoderAnalyzer()
+{
+    delete mSession;
+}
+
+/*!
+    \fn DecoderInterface* UiDecoderAnalyzer::decoder() const
+
+    Returns the decoder.
+*/
+
+/*!
+    Set the signal IDs to \a ids, one for each channel of the decoder.
+    A channel without a signal has ID -1.
+*/
+void UiDecoderAnalyzer::setSignalIds(const QVector<int> &ids)
+{
+    QStringList channels = decoder()->channels();
+
+    mSignalIds.fill(-1, channels.size());
+    for (int i = 0; i < ids.size() && i < mSignalIds.size(); i++) {
+        mSignalIds[i] = ids.at(i);
+    }
+
+    QStringList txt;
+    for (int i = 0; i < channels.size(); i++) {
+        if (mSignalIds.at(i) == -1) continue;
+        txt << QString("%1: D%2").arg(channels.at(i)).arg(mSignalIds.at(i));
+    }
+    mSignalLbl->setText(txt.join(", "));
+    mSignalLbl->adjustSize();
+}
+
+/*!
+    \fn QVector<int> UiDecoderAnalyzer::signalIds() const
+
+    Returns the signal IDs.
+*/
+
+/*!
+    \fn void UiDecoderAnalyzer::setDataFormat(Types::DataFormat format)
+
+    Set data format to \a format.
+*/
+
+/*!
+    \fn Types::DataFormat UiDecoderAnalyzer::dataFormat() const
+
+    Returns the data format.
+*/
+
+/*!
+    \fn const QVector<DecoderItem> &UiDecoderAnalyzer::decodedItems() const
+
+    Returns the items decoded by the latest call to analyze().
+*/
+
+/*!
+    Start to analyze the signal data.
+*/
+void UiDecoderAnalyzer::analyze()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+
+    QVector<const DigitalTransitions*> channels;
+    bool hasData = false;
+    foreach(int id, mSignalIds) {
+        const DigitalTransitions* t = NULL;
+        if (id != -1) {
+            t = device->digitalTransitions(id);
+        }
+        hasData = hasData || (t != NULL);
+        channels.append(t);
+    }
+
+    if (hasData) {
+        mSession->decodeTransitions(channels, device->usedSampleRate());
+    }
+    else {
+        mSession->start(device->usedSampleRate(), QVector<int>(channels.size(), 0));
+    }
+
+    updateStatistics();
+}
+
+/*!
+    Configure the analyzer.
+*/
+void UiDecoderAnalyzer::configure(QWidget *parent)
+{
+    UiDecoderAnalyzerConfig dialog(decoder(), parent);
+    dialog.setSignalIds(mSignalIds);
+    dialog.setDataFormat(mFormat);
+    dialog.exec();
+
+    setSignalIds(dialog.signalIds());
+    setDataFormat(dialog.dataFormat());
+    decoder()->setSettings(dialog.settings());
+
+    analyze();
+    update();
+}
+
+/*!
+    Returns a string representation of this analyzer.
+*/
+QString UiDecoderAnalyzer::toSettingsString() const
+{
+    // type;decoder;name;Signals;Format;Settings
+
+    QStringList ids;
+    foreach(int id, mSignalIds) {
+        ids << QString::number(id);
+    }
+
+    // the values are percent encoded since they may contain separators
+    QStringList settings;
+    QVariantMap map = decoder()->settings();
+    QVariantMap::const_iterator it;
+    for (it = map.constBegin(); it != map.constEnd(); ++it) {
+        settings << QString("%1=%2")
+                    .arg(QString(QUrl::toPercentEncoding(it.key())))
+                    .arg(QString(QUrl::toPercentEncoding(it.value().toString())));
+    }
+
+    QString str;
+    str.append(UiDecoderAnalyzer::name);str.append(";");
+    str.append(QUrl::toPercentEncoding(decoder()->name()));str.append(";");
+    str.append(getName());str.append(";");
+    str.append(ids.join(","));str.append(";");
+    str.append(QString("%1;").arg(dataFormat()));
+    str.append(settings.join(","));
+
+    return str;
+}
+
+/*!
+    Create a decoder analyzer from the string representation \a s. NULL is
+    returned if the decoder's plugin isn't available.
+
+    \sa toSettingsString
+*/
+UiDecoderAnalyzer* UiDecoderAnalyzer::fromSettingsString(const QString &s)
+{
+    UiDecoderAnalyzer* analyzer = NULL;
+    QString name;
+
+    bool ok = false;
+
+    do {
+        // type;decoder;name;Signals;Format;Settings
+        QStringList list = s.split(';');
+        if (list.size() != 6) break;
+
+        // --- type
+        if (list.at(0) != UiDecoderAnalyzer::name) break;
+
+        // --- decoder
+        QString decoderName = QUrl::fromPercentEncoding(list.at(1).toLatin1());
+
+        // --- name
+        name = list.at(2);
+        if (name.isNull()) break;
+
+        // --- signal IDs
+        QVector<int> ids;
+        foreach(QString id, list.at(3).split(',', QString::SkipEmptyParts)) {
+            ids.append(id.toInt(&ok));
+            if (!ok) break;
+        }
+        if (!ok) break;
+
+        // --- data format
+        Types::DataFormat format;
+        int f = list.at(4).toInt(&ok);
+        if (!ok) break;
+        if (f < 0 || f >= Types::DataFormatNum) break;
+        format = (Types::DataFormat)f;
+
+        // --- settings
+        QVariantMap settings;
+        foreach(QString setting, list.at(5).split(',', QString::SkipEmptyParts)) {
+            int sep = setting.indexOf('=');
+            if (sep == -1) continue;
+
+            settings.insert(QUrl::fromPercentEncoding(setting.left(sep).toLatin1()),
+                            QUrl::fromPercentEncoding(setting.mid(sep+1).toLatin1()));
+        }
+
+        DecoderInterface* decoder = DecoderManager::instance().createDecoder(decoderName);
+        if (decoder == NULL) {
+            qDebug() << "Decoder not available:" << decoderName;
+            break;
+        }
+
+        // Deallocation: The caller of this function is responsible for
+        //               deallocation
+        analyzer = new UiDecoderAnalyzer(decoder);
+
+        analyzer->setSignalName(name);
+        analyzer->setSignalIds(ids);
+        analyzer->setDataFormat(format);
+        decoder->setSettings(settings);
+
+    } while (false);
+
+    return analyzer;
+}
+
+/*!
+    Paint event handler responsible for painting this widget.
+*/
+void UiDecoderAnalyzer::paintEvent(QPaintEvent *event)
+{
+    (void)event;
+    QPainter painter(this);
+
+    int textMargin = 3;
+
+    // -----------------
+    // draw background
+    // -----------------
+    paintBackground(&painter);
+
+
+    painter.setClipRect(plotX(), 0, width()-infoWidth(), height());
+    painter.translate(0, height()/2);
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+    int sampleRate = device->usedSampleRate();
+
+    const QVector<DecoderItem> &items = mSession->items();
+
+    double from = 0;
+    double to = 0;
+
+    int h = height()/4;
+
+    QString shortTxt;
+    QString longTxt;
+
+    QPen pen = painter.pen();
+    pen.setColor(Configuration::instance().analyzerColor());
+    painter.setPen(pen);
+
+    for (int i = 0; i < items.size(); i++) {
+        const DecoderItem &item = items.at(i);
+
+        typeAndValueAsString(item, shortTxt, longTxt);
+
+        int shortTextWidth = painter.fontMetrics().width(shortTxt);
+        int longTextWidth = painter.fontMetrics().width(longTxt);
+
+        from = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(item.startIdx, sampleRate));
+
+        // no need to draw when signal is out of plot area
+        if (from > width()) break;
+
+        if (item.stopIdx != -1) {
+            to = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(item.stopIdx, sampleRate));
+        }
+        else {
+
+            // see if the long text version fits
+            to = from + longTextWidth+textMargin*2;
+
+            if (i+1 < items.size()) {
+
+                // get position for the start of the next item
+                double tmp = mTimeAxis->timeToPixelRelativeRef(
+                            SampleTime::time(items.at(i+1).startIdx, sampleRate));
+
+                // if 'to' overlaps check if short text fits
+                if (to > tmp) {
+
+                    to = from + shortTextWidth+textMargin*2;
+
+                    // 'to' overlaps next item -> limit to start of next item
+                    if (to > tmp) {
+                        to = tmp;
+                    }
+                }
+            }
+        }
+
+        // no need to draw items that end before the plot area
+        if (to < plotX()) continue;
+
+        if (to-from > 4) {
+            painter.drawLine(from, 0, from+2, -h);
+            painter.drawLine(from, 0, from+2, h);
+
+            painter.drawLine(from+2, -h, to-2, -h);
+            painter.drawLine(from+2, h, to-2, h);
+
+            painter.drawLine(to, 0, to-2, -h);
+            painter.drawLine(to, 0, to-2, h);
+        }
+
+        // drawing a vertical line when the allowed width is too small
+        else {
+            painter.drawLine(from, -h, from, h);
+        }
+
+        // only draw the text if it fits between 'from' and 'to'
+        QRectF textRect(from+1, -h, (to-from), 2*h);
+        if (longTextWidth < (to-from)) {
+            painter.drawText(textRect, Qt::AlignCenter, longTxt);
+        }
+        else if (shortTextWidth < (to-from)) {
+            painter.drawText(textRect, Qt::AlignCenter, shortTxt);
+        }
+
+    }
+
+}
+
+/*!
+    Event handler called when this widget is being shown
+*/
+void UiDecoderAnalyzer::showEvent(QShowEvent* event)
+{
+    (void) event;
+    doLayout();
+    setMinimumInfoWidth(calcMinimumWidth());
+}
+
+/*!
+    Called when the info width has changed for this widget.
+*/
+void UiDecoderAnalyzer::infoWidthChanged()
+{
+    doLayout();
+}
+
+/*!
+    Position the child widgets.
+*/
+void UiDecoderAnalyzer::doLayout()
+{
+    UiSimpleAbstractSignal::doLayout();
+
+    QRect r = infoContentRect();
+    int y = r.top();
+
+    mIdLbl->move(r.left(), y);
+
+    int x = mIdLbl->pos().x()+mIdLbl->width() + SignalIdMarginRight;
+    mNameLbl->move(x, y);
+    mEditName->move(x, y);
+
+    mSignalLbl->move(r.left(), r.bottom()-mSignalLbl->height());
+
+}
+
+/*!
+    Calculate and return the minimum width for this widget.
+*/
+int UiDecoderAnalyzer::calcMinimumWidth()
+{
+    int w = mNameLbl->pos().x() + mNameLbl->minimumSizeHint().width();
+    if (mEditName->isVisible()) {
+        w = mEditName->pos().x() + mEditName->width();
+    }
+
+    int w2 = mSignalLbl->pos().x()+mSignalLbl->width();
+    if (w2 > w) w = w2;
+
+    return w+infoContentMargin().right();
+}
+
+/*!
+    Show the decoder's throughput for the latest decode as a tool tip.
+*/
+void UiDecoderAnalyzer::updateStatistics()
+{
+    const DecoderSession::Statistics &stats = mSession->statistics();
+
+    setToolTip(tr("%1 edges in %2 chunks, %3 items\n%4 ms, %5 edges/s")
+               .arg(stats.edges)
+               .arg(stats.chunks)
+               .arg(stats.items)
+               .arg(stats.elapsedNs/1e6, 0, 'f', 2)
+               .arg(stats.edgesPerSecond(), 0, 'g', 3));
+}
+
+/*!
+    Convert the type and value of \a item to string representation. A short
+    and long representation is returned in \a shortTxt and \a longTxt.
+*/
+void UiDecoderAnalyzer::typeAndValueAsString(const DecoderItem &item,
+                                             QString &shortTxt,
+                                             QString &longTxt)
+{
+    QString type;
+    if (item.type >= 0 && item.type < mItemTypes.size()) {
+        type = mItemTypes.at(item.type);
+    }
+
+    shortTxt = formatValue(mFormat, item.value);
+    longTxt = QString("%1 %2").arg(type).arg(shortTxt);
+
+    if ((item.flags & DecoderItem::FlagError) != 0) {
+        shortTxt = "E";
+        longTxt = QString("%1 Error").arg(type);
+    }
+}
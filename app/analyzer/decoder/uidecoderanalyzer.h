@@ -0,0 +1,81 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIDECODERANALYZER_H
+#define UIDECODERANALYZER_H
+
+#include <QWidget>
+
+#include "analyzer/uianalyzer.h"
+#include "decodersession.h"
+
+class UiDecoderAnalyzer : public UiAnalyzer
+{
+    Q_OBJECT
+public:
+    static const QString name;
+
+    explicit UiDecoderAnalyzer(DecoderInterface* decoder, QWidget *parent = 0);
+    ~UiDecoderAnalyzer();
+
+    DecoderInterface* decoder() const {return mSession->decoder();}
+
+    void setSignalIds(const QVector<int> &ids);
+    QVector<int> signalIds() const {return mSignalIds;}
+
+    void setDataFormat(Types::DataFormat format) {mFormat = format;}
+    Types::DataFormat dataFormat() const {return mFormat;}
+
+    void analyze();
+    const QVector<DecoderItem> &decodedItems() const {return mSession->items();}
+    void configure(QWidget* parent);
+
+    QString toSettingsString() const;
+    static UiDecoderAnalyzer* fromSettingsString(const QString &settings);
+
+signals:
+
+public slots:
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void showEvent(QShowEvent* event);
+
+private:
+
+    enum {
+        SignalIdMarginRight = 10
+    };
+
+    static int decoderAnalyzerCounter;
+    DecoderSession* mSession;
+    QVector<int> mSignalIds;
+    Types::DataFormat mFormat;
+    QStringList mItemTypes;
+
+    QLabel* mSignalLbl;
+
+    void infoWidthChanged();
+    void doLayout();
+    int calcMinimumWidth();
+    void updateStatistics();
+
+    void typeAndValueAsString(const DecoderItem &item,
+                              QString &shortTxt,
+                              QString &longTxt);
+
+};
+
+#endif // UIDECODERANALYZER_H
@@ -0,0 +1,149 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uidecoderanalyzerconfig.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+
+#include "common/inputhelper.h"
+
+/*!
+    \class UiDecoderAnalyzerConfig
+    \brief Dialog window used to configure a decoder plugin analyzer.
+
+    \ingroup Analyzer
+
+    There is one signal selection for each channel of the decoder and one
+    text field for each of its settings.
+*/
+
+
+/*!
+    Constructs the UiDecoderAnalyzerConfig for \a decoder with the given
+    \a parent.
+*/
+UiDecoderAnalyzerConfig::UiDecoderAnalyzerConfig(const DecoderInterface *decoder,
+                                                 QWidget *parent) :
+    UiAnalyzerConfig(parent)
+{
+    setWindowTitle(decoder->name());
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    mSettings = decoder->settings();
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* formLayout = new QFormLayout;
+
+    QStringList channels = decoder->channels();
+    for (int i = 0; i < channels.size(); i++) {
+        QComboBox* box = InputHelper::createSignalBox(this, i);
+        mSignalBoxes.append(box);
+        formLayout->addRow(tr("%1 Signal: ").arg(channels.at(i)), box);
+    }
+
+    mFormatBox = InputHelper::createFormatBox(this, Types::DataFormatHex);
+    formLayout->addRow(tr("Data format: "), mFormatBox);
+
+    QVariantMap::const_iterator it;
+    for (it = mSettings.constBegin(); it != mSettings.constEnd(); ++it) {
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        QLineEdit* edit = new QLineEdit(it.value().toString(), this);
+        mSettingEdits.insert(it.key(), edit);
+        formLayout->addRow(QString("%1: ").arg(it.key()), edit);
+    }
+
+
+    // Deallocation: Ownership changed when calling setLayout
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Ok,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(accepted()), this, SLOT(accept()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(bottonBox);
+
+
+    setLayout(verticalLayout);
+}
+
+/*!
+    Returns the selected signal IDs, one for each channel of the decoder.
+*/
+QVector<int> UiDecoderAnalyzerConfig::signalIds()
+{
+    QVector<int> ids;
+    foreach(QComboBox* box, mSignalBoxes) {
+        ids.append(InputHelper::intValue(box));
+    }
+
+    return ids;
+}
+
+/*!
+    Set the signal IDs to \a ids. Channels with ID -1 keep the default
+    selection.
+*/
+void UiDecoderAnalyzerConfig::setSignalIds(const QVector<int> &ids)
+{
+    for (int i = 0; i < ids.size() && i < mSignalBoxes.size(); i++) {
+        if (ids.at(i) == -1) continue;
+        InputHelper::setInt(mSignalBoxes.at(i), ids.at(i));
+    }
+}
+
+/*!
+    Set the data format to \a format.
+*/
+void UiDecoderAnalyzerConfig::setDataFormat(Types::DataFormat format)
+{
+    InputHelper::setInt(mFormatBox, (int)format);
+}
+
+/*!
+    Returns the data format.
+*/
+Types::DataFormat UiDecoderAnalyzerConfig::dataFormat()
+{
+    int f = InputHelper::intValue(mFormatBox);
+    return (Types::DataFormat)f;
+}
+
+/*!
+    Returns the settings of the decoder. Each value is converted to the
+    type of the decoder's current value and is left unchanged if the
+    entered text can't be converted.
+*/
+QVariantMap UiDecoderAnalyzerConfig::settings()
+{
+    QVariantMap map = mSettings;
+
+    QMap<QString, QLineEdit*>::const_iterator it;
+    for (it = mSettingEdits.constBegin(); it != mSettingEdits.constEnd(); ++it) {
+        QVariant value(it.value()->text());
+        if (value.convert(mSettings.value(it.key()).type())) {
+            map.insert(it.key(), value);
+        }
+    }
+
+    return map;
+}
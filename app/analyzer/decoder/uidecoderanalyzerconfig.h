@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIDECODERANALYZERCONFIG_H
+#define UIDECODERANALYZERCONFIG_H
+
+#include <QWidget>
+#include <QLineEdit>
+
+#include "decoderinterface.h"
+#include "analyzer/uianalyzerconfig.h"
+
+
+class UiDecoderAnalyzerConfig : public UiAnalyzerConfig
+{
+    Q_OBJECT
+public:
+    explicit UiDecoderAnalyzerConfig(const DecoderInterface* decoder,
+                                     QWidget *parent = 0);
+
+    QVector<int> signalIds();
+    void setSignalIds(const QVector<int> &ids);
+
+    Types::DataFormat dataFormat();
+    void setDataFormat(Types::DataFormat format);
+
+    QVariantMap settings();
+
+signals:
+
+public slots:
+
+private:
+
+    QVariantMap mSettings;
+    QList<QComboBox*> mSignalBoxes;
+    QComboBox* mFormatBox;
+    QMap<QString, QLineEdit*> mSettingEdits;
+
+};
+
+#endif // UIDECODERANALYZERCONFIG_H
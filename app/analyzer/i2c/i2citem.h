@@ -0,0 +1,76 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef I2CITEM_H
+#define I2CITEM_H
+
+#include "common/sampleindex.h"
+
+/*!
+    \class I2CItem
+    \brief Container class for I2C items.
+
+    \ingroup Analyzer
+
+    \internal
+
+*/
+class I2CItem {
+public:
+
+    /*!
+        I2C protocol types
+    */
+    enum I2CType {
+        I2C_START,
+        I2C_STOP,
+        I2C_ACK,
+        I2C_NACK,
+        I2C_DATA,
+        I2C_7_ADDRESS_WRITE,
+        I2C_7_ADDRESS_READ,
+        I2C_10_ADDRESS_WRITE,
+        I2C_10_ADDRESS_READ,
+        I2C_ERROR
+    };
+
+    // default constructor needed in order to add this to QVector
+    /*!
+        Default constructor
+    */
+    I2CItem() {
+    }
+
+    /*!
+        Creates an I2C container item
+    */
+    I2CItem(I2CType type, int value, SampleIndex startIdx, SampleIndex stopIdx) {
+        this->type = type;
+        this->value = value;
+        this->startIdx = startIdx;
+        this->stopIdx = stopIdx;
+    }
+
+    /*! type */
+    I2CType type;
+    /*! value */
+    int value;
+    /*! sample index where item starts */
+    SampleIndex startIdx;
+    /*! sample index where item stop */
+    SampleIndex stopIdx;
+};
+
+#endif // I2CITEM_H
@@ -45,6 +45,10 @@ const QString UiI2CAnalyzer::signalName = "I2C Analyzer";
     The class will analyze specified digital signals and visualize the
     interpretation as I2C protocol data.
 
+    If the capture device has monitored the I2C bus in hardware, see
+    CaptureDevice::monitoredI2CItems(), the monitored communication is
+    shown instead and the digital signals are not needed.
+
 */
 
 
@@ -168,11 +172,18 @@ void UiI2CAnalyzer::analyze()
 
     mI2cItems.clear();
 
-    if (mSclSignalId == -1 || mSdaSignalId == -1) return;
-
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
 
+    // A hardware I2C monitor has already decoded the communication
+    QVector<I2CItem>* monitored = device->monitoredI2CItems();
+    if (monitored != NULL) {
+        mI2cItems = *monitored;
+        return;
+    }
+
+    if (mSclSignalId == -1 || mSdaSignalId == -1) return;
+
     QVector<int>* sclData = device->digitalData(mSclSignalId);
     QVector<int>* sdaData = device->digitalData(mSdaSignalId);
 
@@ -206,7 +217,9 @@ void UiI2CAnalyzer::analyze()
     if (mSyncCursor != UiCursor::NoCursor) {
         double t = CursorManager::instance().cursorPosition(mSyncCursor);
         if (t > 0 && CursorManager::instance().isCursorOn(mSyncCursor)) {
-            pos = device->usedSampleRate()*t;
+            // clamp in 64-bit before narrowing to a sample buffer position
+            SampleIndex idx = SampleTime::floorIndex(t, device->usedSampleRate());
+            pos = (idx < sclData->size()) ? (int)idx : sclData->size();
         }
         if (pos >= sclData->size()) {
             pos = 0;
@@ -560,8 +573,8 @@ void UiI2CAnalyzer::paintEvent(QPaintEvent *event)
 
     double from = 0;
     double to = 0;
-    int fromIdx = 0;
-    int toIdx = 0;
+    SampleIndex fromIdx = 0;
+    SampleIndex toIdx = 0;
 
     int h = height()/4;
 
@@ -585,13 +598,13 @@ void UiI2CAnalyzer::paintEvent(QPaintEvent *event)
         int longTextWidth = painter.fontMetrics().width(longTxt);
 
 
-        from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
+        from = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(fromIdx, sampleRate));
 
         // no need to draw when signal is out of plot area
         if (from > width()) break;
 
         if (toIdx != -1) {
-            to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
+            to = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(toIdx, sampleRate));
         }
         else  {
 
@@ -602,7 +615,7 @@ void UiI2CAnalyzer::paintEvent(QPaintEvent *event)
 
                 // get position for the start of the next item
                 double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mI2cItems.at(i+1).startIdx/sampleRate);
+                            SampleTime::time(mI2cItems.at(i+1).startIdx, sampleRate));
 
 
                 // if 'to' overlaps check if short text fits
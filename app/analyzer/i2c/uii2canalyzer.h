@@ -25,62 +25,7 @@
 #include <QVector>
 
 #include "capture/uicursor.h"
-
-/*!
-    \class I2CItem
-    \brief Container class for I2C items.
-
-    \ingroup Analyzer
-
-    \internal
-
-*/
-class I2CItem {
-public:
-
-    /*!
-        I2C protocol types
-    */
-    enum I2CType {
-        I2C_START,
-        I2C_STOP,
-        I2C_ACK,
-        I2C_NACK,
-        I2C_DATA,
-        I2C_7_ADDRESS_WRITE,
-        I2C_7_ADDRESS_READ,
-        I2C_10_ADDRESS_WRITE,
-        I2C_10_ADDRESS_READ,
-        I2C_ERROR
-    };
-
-    // default constructor needed in order to add this to QVector
-    /*!
-        Default constructor
-    */
-    I2CItem() {
-    }
-
-    /*!
-        Creates an I2C container item
-    */
-    I2CItem(I2CType type, int value, int startIdx, int stopIdx) {
-        this->type = type;
-        this->value = value;
-        this->startIdx = startIdx;
-        this->stopIdx = stopIdx;
-    }
-
-    /*! type */
-    I2CType type;
-    /*! value */
-    int value;
-    /*! sample index where item starts */
-    int startIdx;
-    /*! sample index where item stop */
-    int stopIdx;
-};
-
+#include "i2citem.h"
 
 
 class UiI2CAnalyzer : public UiAnalyzer
@@ -103,6 +48,7 @@ public:
     UiCursor::CursorId syncCursor() {return mSyncCursor;}
 
     void analyze();
+    const QVector<I2CItem> &i2cItems() const {return mI2cItems;}
     void configure(QWidget* parent);
 
     QString toSettingsString() const;
@@ -256,7 +256,9 @@ void UiSpiAnalyzer::analyze()
     if (mSyncCursor != UiCursor::NoCursor) {
         double t = CursorManager::instance().cursorPosition(mSyncCursor);
         if (t > 0 && CursorManager::instance().isCursorOn(mSyncCursor)) {
-            pos = device->usedSampleRate()*t;
+            // clamp in 64-bit before narrowing to a sample buffer position
+            SampleIndex idx = SampleTime::floorIndex(t, device->usedSampleRate());
+            pos = (idx < sckData->size()) ? (int)idx : sckData->size();
         }
 
         if (pos >= sckData->size()) {
@@ -561,8 +563,8 @@ void UiSpiAnalyzer::paintEvent(QPaintEvent *event)
 
     double from = 0;
     double to = 0;
-    int fromIdx = 0;
-    int toIdx = 0;
+    SampleIndex fromIdx = 0;
+    SampleIndex toIdx = 0;
 
     int h = height() / 6;
 
@@ -602,13 +604,13 @@ void UiSpiAnalyzer::paintEvent(QPaintEvent *event)
         int longTextWidth = painter.fontMetrics().width(mosiLongTxt);
 
 
-        from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
+        from = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(fromIdx, sampleRate));
 
         // no need to draw when signal is out of plot area
         if (from > width()) break;
 
         if (toIdx != -1) {
-            to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
+            to = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(toIdx, sampleRate));
         }
         else  {
 
@@ -619,7 +621,7 @@ void UiSpiAnalyzer::paintEvent(QPaintEvent *event)
 
                 // get position for the start of the next item
                 double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mSpiItems.at(i+1).startIdx/sampleRate);
+                            SampleTime::time(mSpiItems.at(i+1).startIdx, sampleRate));
 
 
                 // if 'to' overlaps check if short text fits
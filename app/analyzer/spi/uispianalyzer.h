@@ -19,6 +19,7 @@
 #include <QWidget>
 
 #include "analyzer/uianalyzer.h"
+#include "common/sampleindex.h"
 #include "capture/uicursor.h"
 
 /*!
@@ -47,7 +48,7 @@ public:
     }
 
     /*! Constructs a new container */
-    SpiItem(ItemType type, int mosiValue, int misoValue, int startIdx, int stopIdx) {
+    SpiItem(ItemType type, int mosiValue, int misoValue, SampleIndex startIdx, SampleIndex stopIdx) {
         this->type = type;
         this->mosiValue = mosiValue;
         this->misoValue = misoValue;
@@ -62,9 +63,9 @@ public:
     /*! miso value */
     int misoValue;
     /*! item start index */
-    int startIdx;
+    SampleIndex startIdx;
     /*! item stop index */
-    int stopIdx;
+    SampleIndex stopIdx;
 };
 
 class UiSpiAnalyzer : public UiAnalyzer
@@ -107,6 +108,7 @@ public:
     UiCursor::CursorId syncCursor() const {return mSyncCursor;}
 
     void analyze();
+    const QVector<SpiItem> &spiItems() const {return mSpiItems;}
     void configure(QWidget* parent);
 
     QString toSettingsString() const;
@@ -0,0 +1,340 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uartautodetect.h"
+
+#include <QHash>
+#include <QList>
+#include <QtAlgorithms>
+#include <QtConcurrent/QtConcurrentMap>
+#include <qmath.h>
+
+/*!
+    \class UartAutoDetect
+    \brief Finds the baud rate and frame format of a UART signal.
+
+    \ingroup Analyzer
+
+    The bit time is found from a histogram of the pulse widths, i.e., the
+    distances between the signal's transitions, which is built in one pass
+    over the transition storage. The narrowest common pulse is a first
+    estimate of the bit time. It is then refined by treating every pulse as
+    a whole number of bits and dividing the total width by the total number
+    of bits, which is the least squares estimate of the common divisor.
+
+    All supported frame formats are then decoded, in parallel, from the
+    start of the signal and the format with the fewest errors is selected.
+    Only transitions are visited, never the samples, so the detection time
+    doesn't depend on the length of the capture.
+*/
+
+/*!
+    Baud rates that a found rate is rounded to if it is close enough.
+*/
+static const int StandardBaudRates[] = {
+    300, 600, 1200, 2400, 4800, 9600, 14400, 19200, 28800, 38400, 57600,
+    76800, 115200, 230400, 250000, 460800, 500000, 921600, 1000000,
+    1500000, 2000000, 3000000
+};
+
+/*!
+    Runs a decode of one candidate, called in parallel for all candidates.
+*/
+struct DecodeCandidate
+{
+    DecodeCandidate(const UartAutoDetect* detector,
+                    void (UartAutoDetect::*decode)(UartAutoDetect::Candidate&) const)
+        : mDetector(detector), mDecode(decode) {}
+
+    typedef void result_type;
+
+    void operator()(UartAutoDetect::Candidate &candidate) const
+    {
+        (mDetector->*mDecode)(candidate);
+    }
+
+    const UartAutoDetect* mDetector;
+    void (UartAutoDetect::*mDecode)(UartAutoDetect::Candidate&) const;
+};
+
+/*!
+    Constructs a detector for the signal with the given \a transitions
+    captured at \a sampleRate.
+*/
+UartAutoDetect::UartAutoDetect(const DigitalTransitions *transitions, int sampleRate)
+{
+    mTransitions = transitions;
+    mSampleRate = sampleRate;
+    mBitTime = 0;
+    mBaudRate = 0;
+
+    mBest.dataBits = 8;
+    mBest.parity = Types::ParityNone;
+    mBest.stopBits = 1;
+    mBest.frames = 0;
+    mBest.frameErrors = 0;
+    mBest.parityErrors = 0;
+    mBest.lastBitAlwaysOne = false;
+}
+
+/*!
+    Finds the baud rate and frame format. Returns false if the signal
+    doesn't look like a UART signal, e.g., if it has too few transitions
+    or no format could decode it without errors.
+*/
+bool UartAutoDetect::detect()
+{
+    mCandidates.clear();
+
+    if (mTransitions == NULL || mSampleRate <= 0) return false;
+    if (!findBitTime()) return false;
+
+    findBaudRate();
+
+    for (int dataBits = 5; dataBits <= 9; dataBits++) {
+        for (int parity = 0; parity < Types::ParityNum; parity++) {
+            for (int stopBits = 1; stopBits <= 2; stopBits++) {
+                Candidate c;
+                c.dataBits = dataBits;
+                c.parity = (Types::UartParity)parity;
+                c.stopBits = stopBits;
+                c.frames = 0;
+                c.frameErrors = 0;
+                c.parityErrors = 0;
+                c.lastBitAlwaysOne = false;
+                mCandidates.append(c);
+            }
+        }
+    }
+
+    QtConcurrent::blockingMap(mCandidates,
+                              DecodeCandidate(this, &UartAutoDetect::decode));
+
+    int best = -1;
+    for (int i = 0; i < mCandidates.size(); i++) {
+        if (mCandidates.at(i).frames == 0) continue;
+        if (best == -1 || isBetter(mCandidates.at(i), mCandidates.at(best))) {
+            best = i;
+        }
+    }
+
+    if (best == -1) return false;
+
+    mBest = mCandidates.at(best);
+
+    // more errors than frames decoded correctly; not UART or not this rate
+    int errors = mBest.frameErrors + mBest.parityErrors;
+    return (errors*2 < mBest.frames);
+}
+
+/*!
+    Finds the bit time, in samples, from the histogram of pulse widths.
+*/
+bool UartAutoDetect::findBitTime()
+{
+    if (mTransitions->size() < MinPulses + 1) return false;
+
+    QHash<SampleIndex, int> histogram;
+    int numPulses = 0;
+
+    DigitalTransitions::const_iterator it = mTransitions->begin();
+    SampleIndex prev = *it;
+    for (++it; it != mTransitions->end(); ++it) {
+        histogram[*it - prev]++;
+        prev = *it;
+        numPulses++;
+    }
+
+    QList<SampleIndex> widths = histogram.keys();
+    qSort(widths);
+
+    // The narrowest pulse that is common enough is one bit wide. Pulses
+    // that are a lot shorter than that are glitches. A cluster is all
+    // widths up to 1.5 times the narrowest since a pulse of two bits is
+    // always wider than that.
+    int minCount = qMax(2, numPulses/50);
+    double estimate = 0;
+
+    for (int i = 0; i < widths.size() && estimate == 0; i++) {
+        SampleIndex w0 = widths.at(i);
+        int count = 0;
+        double sum = 0;
+
+        for (int j = i; j < widths.size() && widths.at(j)*2 < w0*3; j++) {
+            count += histogram.value(widths.at(j));
+            sum += (double)widths.at(j)*histogram.value(widths.at(j));
+        }
+
+        if (count >= minCount) {
+            estimate = sum/count;
+        }
+    }
+
+    if (estimate < MinSamplesPerBit) return false;
+
+    // refine the estimate using all pulses that are close to a whole
+    // number of bits
+    double sumWidth = 0;
+    double sumBits = 0;
+    foreach(SampleIndex w, widths) {
+        int bits = qRound(w/estimate);
+        if (bits < 1 || bits > MaxPulseBits) continue;
+        if (qAbs(w - bits*estimate) > estimate/4) continue;
+
+        int count = histogram.value(w);
+        sumWidth += (double)w*count;
+        sumBits += (double)bits*count;
+    }
+
+    if (sumBits == 0) return false;
+
+    mBitTime = sumWidth/sumBits;
+
+    return true;
+}
+
+/*!
+    Calculates the baud rate from the bit time and rounds it to a standard
+    baud rate if it is within 3 percent of one.
+*/
+void UartAutoDetect::findBaudRate()
+{
+    double rate = mSampleRate/mBitTime;
+    mBaudRate = qRound(rate);
+
+    int num = sizeof(StandardBaudRates)/sizeof(StandardBaudRates[0]);
+    for (int i = 0; i < num; i++) {
+        if (qAbs(rate - StandardBaudRates[i]) < StandardBaudRates[i]*0.03) {
+            mBaudRate = StandardBaudRates[i];
+            mBitTime = (double)mSampleRate/mBaudRate;
+            break;
+        }
+    }
+}
+
+/*!
+    Decodes up to MaxFrames frames with the format in \a candidate and
+    records the number of frames and errors in it. A frame starts at a
+    falling edge and each bit is sampled at its center.
+*/
+void UartAutoDetect::decode(Candidate &candidate) const
+{
+    int numBits = 1 + candidate.dataBits
+            + (candidate.parity != Types::ParityNone ? 1 : 0)
+            + candidate.stopBits;
+
+    candidate.lastBitAlwaysOne = true;
+
+    DigitalTransitions::const_iterator it = mTransitions->begin();
+    SampleIndex last = mTransitions->lastSampleIndex();
+
+    while (candidate.frames < MaxFrames) {
+
+        // find the next falling edge, the level after transition i is
+        // the initial level if i is odd
+        while (it != mTransitions->end()) {
+            int levelAfter = ((it.index() % 2) == 0)
+                    ? (mTransitions->initialLevel() + 1) % 2
+                    : mTransitions->initialLevel();
+            if (levelAfter == 0) break;
+            ++it;
+        }
+        if (it == mTransitions->end()) break;
+
+        SampleIndex start = *it;
+        if (start + (SampleIndex)(numBits*mBitTime) > last) break;
+
+        int ones = 0;
+        bool frameError = false;
+        bool parityError = false;
+
+        int lastBit = numBits - candidate.stopBits - 1;
+
+        for (int bit = 0; bit < numBits; bit++) {
+            SampleIndex center = start + (SampleIndex)((bit + 0.5)*mBitTime);
+            int level = mTransitions->levelAt(center);
+
+            if (bit == lastBit && level == 0) {
+                candidate.lastBitAlwaysOne = false;
+            }
+
+            if (bit == 0) {
+                // a glitch rather than a start bit
+                if (level != 0) frameError = true;
+            }
+            else if (bit <= candidate.dataBits) {
+                ones += level;
+            }
+            else if (bit == candidate.dataBits + 1
+                     && candidate.parity != Types::ParityNone) {
+                switch (candidate.parity) {
+                case Types::ParityOdd:
+                    parityError = (((ones + level) % 2) == 0);
+                    break;
+                case Types::ParityEven:
+                    parityError = (((ones + level) % 2) != 0);
+                    break;
+                case Types::ParityMark:
+                    parityError = (level == 0);
+                    break;
+                case Types::ParitySpace:
+                    parityError = (level == 1);
+                    break;
+                default:
+                    break;
+                }
+            }
+            else if (level == 0) {
+                frameError = true;
+            }
+        }
+
+        candidate.frames++;
+        if (frameError) {
+            candidate.frameErrors++;
+        }
+        else if (parityError) {
+            candidate.parityErrors++;
+        }
+        // continue after the middle of the last stop bit
+        SampleIndex next = start + (SampleIndex)((numBits - 0.5)*mBitTime);
+        it = mTransitions->iteratorAt(mTransitions->lowerBound(next));
+    }
+}
+
+/*!
+    Returns true if candidate \a a explains the signal better than \a b.
+    Fewer errors is better. A last data or parity bit that is always 1 is
+    probably a stop bit and then the shorter format is better. Otherwise a longer
+    frame is better as a shorter one decodes the same frames with part of
+    the data in the idle time, and a checked parity is better than an extra
+    data bit. At last one stop bit is better than two.
+*/
+bool UartAutoDetect::isBetter(const Candidate &a, const Candidate &b)
+{
+    double errorsA = (double)(a.frameErrors + a.parityErrors)/a.frames;
+    double errorsB = (double)(b.frameErrors + b.parityErrors)/b.frames;
+    if (errorsA != errorsB) return errorsA < errorsB;
+
+    if (a.lastBitAlwaysOne != b.lastBitAlwaysOne) return !a.lastBitAlwaysOne;
+
+    int bitsA = a.dataBits + (a.parity != Types::ParityNone ? 1 : 0);
+    int bitsB = b.dataBits + (b.parity != Types::ParityNone ? 1 : 0);
+    if (bitsA != bitsB) return bitsA > bitsB;
+
+    if (a.dataBits != b.dataBits) return a.dataBits < b.dataBits;
+
+    return a.stopBits < b.stopBits;
+}
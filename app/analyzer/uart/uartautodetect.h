@@ -0,0 +1,82 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UARTAUTODETECT_H
+#define UARTAUTODETECT_H
+
+#include <QVector>
+
+#include "common/types.h"
+#include "common/sampleindex.h"
+#include "device/digitaltransitions.h"
+
+class UartAutoDetect
+{
+public:
+
+    /*!
+        A frame format tested against the signal.
+    */
+    struct Candidate {
+        int dataBits;
+        Types::UartParity parity;
+        int stopBits;
+
+        int frames;
+        int frameErrors;
+        int parityErrors;
+        // the bit before the stop bits was 1 in all frames, i.e., it may
+        // be a stop bit
+        bool lastBitAlwaysOne;
+    };
+
+    UartAutoDetect(const DigitalTransitions* transitions, int sampleRate);
+
+    bool detect();
+
+    double bitTime() const {return mBitTime;}
+    int baudRate() const {return mBaudRate;}
+    int dataBits() const {return mBest.dataBits;}
+    Types::UartParity parity() const {return mBest.parity;}
+    int stopBits() const {return mBest.stopBits;}
+    const QVector<Candidate> &candidates() const {return mCandidates;}
+
+    enum Constants {
+        // minimum number of pulses needed to find the bit time
+        MinPulses = 8,
+        // minimum number of samples per bit, as for the UART analyzer
+        MinSamplesPerBit = 3,
+        // longest pulse, in bits, used when refining the bit time
+        MaxPulseBits = 12,
+        // number of frames decoded for each candidate format
+        MaxFrames = 256
+    };
+
+private:
+    const DigitalTransitions* mTransitions;
+    int mSampleRate;
+
+    double mBitTime;
+    int mBaudRate;
+    Candidate mBest;
+    QVector<Candidate> mCandidates;
+
+    bool findBitTime();
+    void findBaudRate();
+    void decode(Candidate &candidate) const;
+    static bool isBetter(const Candidate &a, const Candidate &b);
+};
+
+#endif // UARTAUTODETECT_H
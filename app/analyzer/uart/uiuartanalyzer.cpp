@@ -201,7 +201,9 @@ void UiUartAnalyzer::analyze()
     if (mSyncCursor != UiCursor::NoCursor) {
         double t = CursorManager::instance().cursorPosition(mSyncCursor);
         if (t > 0 && CursorManager::instance().isCursorOn(mSyncCursor)) {
-            pos = sampleRate*t;
+            // clamp in 64-bit before narrowing to a sample buffer position
+            SampleIndex idx = SampleTime::floorIndex(t, sampleRate);
+            pos = (idx < uartData->size()) ? (int)idx : uartData->size();
         }
         if (pos >= uartData->size()) {
             pos = 0;
@@ -528,8 +530,8 @@ void UiUartAnalyzer::paintEvent(QPaintEvent *event)
 
     double from = 0;
     double to = 0;
-    int fromIdx = 0;
-    int toIdx = 0;
+    SampleIndex fromIdx = 0;
+    SampleIndex toIdx = 0;
 
     int h = height()/4;
 
@@ -553,13 +555,13 @@ void UiUartAnalyzer::paintEvent(QPaintEvent *event)
         int longTextWidth = painter.fontMetrics().width(longTxt);
 
 
-        from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
+        from = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(fromIdx, sampleRate));
 
         // no need to draw when signal is out of plot area
         if (from > width()) break;
 
         if (toIdx != -1) {
-            to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
+            to = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(toIdx, sampleRate));
         }
         else  {
 
@@ -570,7 +572,7 @@ void UiUartAnalyzer::paintEvent(QPaintEvent *event)
 
                 // get position for the start of the next item
                 double tmp = mTimeAxis->timeToPixelRelativeRef(
-                            (double)mUartItems.at(i+1).startIdx/sampleRate);
+                            SampleTime::time(mUartItems.at(i+1).startIdx, sampleRate));
 
 
                 // if 'to' overlaps check if short text fits
@@ -19,6 +19,7 @@
 #include <QWidget>
 
 #include "analyzer/uianalyzer.h"
+#include "common/sampleindex.h"
 #include "capture/uicursor.h"
 
 /*!
@@ -48,7 +49,7 @@ public:
     }
 
     /*! Constructs a new container */
-    UartItem(ItemType type, int value, int startIdx, int stopIdx) {
+    UartItem(ItemType type, int value, SampleIndex startIdx, SampleIndex stopIdx) {
         this->type = type;
         this->value = value;
         this->startIdx = startIdx;
@@ -60,9 +61,9 @@ public:
     /*! value */
     int value;
     /*! item start index */
-    int startIdx;
+    SampleIndex startIdx;
     /*! item stop index */
-    int stopIdx;    
+    SampleIndex stopIdx;    
 
 };
 
@@ -97,6 +98,7 @@ public:
     UiCursor::CursorId syncCursor() const {return mSyncCursor;}
 
     void analyze();
+    const QVector<UartItem> &uartItems() const {return mUartItems;}
     void configure(QWidget* parent);
 
     QString toSettingsString() const;
@@ -18,8 +18,13 @@
 #include <QFormLayout>
 #include <QVBoxLayout>
 #include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QMessageBox>
 
+#include "uartautodetect.h"
 #include "common/inputhelper.h"
+#include "device/devicemanager.h"
 
 /*!
     \class UiUartAnalyzerConfig
@@ -49,7 +54,17 @@ UiUartAnalyzerConfig::UiUartAnalyzerConfig(QWidget *parent) :
     formLayout->addRow(tr("Data format: "), mFormatBox);
 
     mBaudRate = InputHelper::createUartBaudRateBox(this, 115200);
-    formLayout->addRow(tr("Baud Rate: "), mBaudRate);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QPushButton* detectBtn = new QPushButton(tr("Detect"), this);
+    detectBtn->setToolTip(tr("Detect baud rate and frame format from the signal"));
+    connect(detectBtn, SIGNAL(clicked()), this, SLOT(detectFormat()));
+
+    // Deallocation: Re-parented when calling formLayout->addRow
+    QHBoxLayout* baudLayout = new QHBoxLayout;
+    baudLayout->addWidget(mBaudRate);
+    baudLayout->addWidget(detectBtn);
+    formLayout->addRow(tr("Baud Rate: "), baudLayout);
 
     mDataBitsBox = InputHelper::createUartDataBitsBox(this, 8);
     formLayout->addRow(tr("Data bits: "), mDataBitsBox);
@@ -200,7 +215,31 @@ void UiUartAnalyzerConfig::setSyncCursor(UiCursor::CursorId id)
     InputHelper::setInt(mCursorBox, id);
 }
 
-
-
-
-
+/*!
+    Detects the baud rate and frame format from the captured data of the
+    selected signal and updates the dialog with the result.
+*/
+void UiUartAnalyzerConfig::detectFormat()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    UartAutoDetect detector(device->digitalTransitions(signalId()),
+                            device->usedSampleRate());
+
+    if (!detector.detect()) {
+        QMessageBox::warning(this,
+                             tr("UART Analyzer"),
+                             tr("Could not detect the baud rate and frame "
+                                "format. The signal must have captured UART "
+                                "data with at least %1 samples per bit.")
+                             .arg((int)UartAutoDetect::MinSamplesPerBit));
+        return;
+    }
+
+    setBaudRate(detector.baudRate());
+    setDataBits(detector.dataBits());
+    setParity(detector.parity());
+    setStopBits(detector.stopBits());
+}
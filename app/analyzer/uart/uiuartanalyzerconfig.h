@@ -55,6 +55,9 @@ signals:
     
 public slots:
 
+private slots:
+    void detectFormat();
+
 private:
 
     QComboBox* mSignalBox;
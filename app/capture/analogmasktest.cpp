@@ -0,0 +1,347 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "analogmasktest.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+/*!
+    \class AnalogMaskTest
+    \brief Pass/fail testing of analog signals against masks.
+
+    \ingroup Capture
+
+    Each analog signal can have a mask with an upper and a lower limit for
+    each of a number of equally long bins of the frame. A mask is either
+    created from a captured frame, with a tolerance added to the frame's
+    minimum and maximum in each bin, or set to fixed limits.
+
+    During continuous capture every frame is tested with evaluate(). The
+    minimum and maximum of each bin are calculated first, in loops the
+    compiler can vectorize, and compared with the bin's limits. Only the
+    samples of the bins that fail are looked at one by one to find the
+    positions of the violations. evaluate() doesn't change the test and can
+    be run on a worker thread while the masks are left unchanged.
+
+    The result is then given to record() which keeps running statistics
+    and a copy of the most recent failing frames.
+*/
+
+/*!
+    \struct AnalogMaskTest::Mask
+    \internal
+*/
+
+/*!
+    \struct AnalogMaskTest::Violation
+    \internal
+*/
+
+/*!
+    \struct AnalogMaskTest::Result
+    \internal
+*/
+
+/*!
+    \struct AnalogMaskTest::Frame
+    \internal
+*/
+
+/*!
+    Constructs the AnalogMaskTest without masks.
+*/
+AnalogMaskTest::AnalogMaskTest()
+{
+    mEnabled = false;
+    mStopOnFailure = false;
+    mFrames = 0;
+    mFailedFrames = 0;
+}
+
+/*!
+    Creates a mask for signal \a signalId from the frame \a data. The frame
+    is divided into \a resolution bins and the limits of a bin are the
+    minimum and maximum of the samples in the bin and its neighbours, to
+    allow for some jitter, with the \a tolerance in volts added.
+*/
+void AnalogMaskTest::createMask(int signalId, const QVector<double> &data,
+                                int resolution, double tolerance)
+{
+    if (data.isEmpty() || resolution <= 0) return;
+
+    Mask mask;
+    mask.samples = data.size();
+
+    int bins = qMin(resolution, data.size());
+    mask.upper.resize(bins);
+    mask.lower.resize(bins);
+
+    QVector<double> lo(bins);
+    QVector<double> hi(bins);
+
+    for (int b = 0; b < bins; b++) {
+        const double* p = data.constData() + binStart(mask, b);
+        int n = (int)(binStart(mask, b+1) - binStart(mask, b));
+
+        double min = p[0];
+        double max = p[0];
+        for (int i = 1; i < n; i++) {
+            min = (p[i] < min) ? p[i] : min;
+            max = (p[i] > max) ? p[i] : max;
+        }
+        lo[b] = min;
+        hi[b] = max;
+    }
+
+    for (int b = 0; b < bins; b++) {
+        double min = lo.at(b);
+        double max = hi.at(b);
+        if (b > 0) {
+            min = qMin(min, lo.at(b-1));
+            max = qMax(max, hi.at(b-1));
+        }
+        if (b+1 < bins) {
+            min = qMin(min, lo.at(b+1));
+            max = qMax(max, hi.at(b+1));
+        }
+
+        mask.lower[b] = min - tolerance;
+        mask.upper[b] = max + tolerance;
+    }
+
+    mMasks.insert(signalId, mask);
+}
+
+/*!
+    Sets a mask for signal \a signalId with the fixed limits \a lower and
+    \a upper for the first \a samples samples of the frames.
+*/
+void AnalogMaskTest::setLimits(int signalId, SampleIndex samples, double lower,
+                               double upper)
+{
+    if (samples <= 0) return;
+
+    Mask mask;
+    mask.samples = samples;
+    mask.lower.fill(lower, 1);
+    mask.upper.fill(upper, 1);
+
+    mMasks.insert(signalId, mask);
+}
+
+/*!
+    \fn void AnalogMaskTest::removeMask(int signalId)
+
+    Removes the mask for signal \a signalId.
+*/
+
+/*!
+    \fn bool AnalogMaskTest::hasMask(int signalId) const
+
+    Returns true if there is a mask for signal \a signalId.
+*/
+
+/*!
+    \fn Mask AnalogMaskTest::mask(int signalId) const
+
+    Returns the mask for signal \a signalId.
+*/
+
+/*!
+    Tests a frame where \a data are the samples of the signals, mapped on
+    signal ID. Signals without a mask are ignored as are samples after the
+    end of a mask.
+*/
+AnalogMaskTest::Result AnalogMaskTest::evaluate(const QMap<int, QVector<double> > &data) const
+{
+    Result result;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QMap<int, Mask>::const_iterator it;
+    for (it = mMasks.constBegin(); it != mMasks.constEnd(); ++it) {
+        if (!data.contains(it.key())) continue;
+
+        testSignal(it.key(), it.value(), data.value(it.key()), result);
+        result.tested = true;
+    }
+
+    result.passed = (result.failedSamples == 0);
+    result.elapsedNs = timer.nsecsElapsed();
+
+    return result;
+}
+
+/*!
+    Adds the \a result of testing the frame \a data to the statistics. A
+    failing frame is kept, and the oldest kept frame is removed if there
+    are more than MaxKeptFrames.
+*/
+void AnalogMaskTest::record(const Result &result, const QMap<int, QVector<double> > &data)
+{
+    if (!result.tested) return;
+
+    mLastResult = result;
+    mFrames++;
+
+    if (result.passed) return;
+
+    mFailedFrames++;
+
+    Frame frame;
+    frame.number = mFrames;
+    frame.result = result;
+    frame.data = data;
+    mKeptFrames.append(frame);
+
+    if (mKeptFrames.size() > MaxKeptFrames) {
+        mKeptFrames.removeFirst();
+    }
+}
+
+/*!
+    \fn const Result &AnalogMaskTest::lastResult() const
+
+    Returns the result of the most recently tested frame.
+*/
+
+/*!
+    \fn qint64 AnalogMaskTest::frames() const
+
+    Returns the number of tested frames.
+*/
+
+/*!
+    \fn qint64 AnalogMaskTest::failedFrames() const
+
+    Returns the number of frames that failed.
+*/
+
+/*!
+    \fn const QList<Frame> &AnalogMaskTest::keptFrames() const
+
+    Returns the most recent failing frames, oldest first.
+*/
+
+/*!
+    Resets the statistics and removes the kept frames.
+*/
+void AnalogMaskTest::resetStatistics()
+{
+    mLastResult = Result();
+    mFrames = 0;
+    mFailedFrames = 0;
+    mKeptFrames.clear();
+}
+
+/*!
+    Saves the kept frames as comma separated values to \a filePath. There
+    is one row per sample with the frame number, the sample index and the
+    value of each signal in the frame. Returns false if the file couldn't
+    be written.
+*/
+bool AnalogMaskTest::saveFailedFrames(const QString &filePath) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::Truncate | QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    foreach(const Frame &frame, mKeptFrames) {
+        QList<QVector<double> > columns;
+        int numSamples = -1;
+
+        out << "frame,sample";
+        QMap<int, QVector<double> >::const_iterator it;
+        for (it = frame.data.constBegin(); it != frame.data.constEnd(); ++it) {
+            out << QString(",A%1").arg(it.key());
+
+            columns.append(it.value());
+            if (numSamples == -1 || it.value().size() < numSamples) {
+                numSamples = it.value().size();
+            }
+        }
+        out << '\n';
+
+        for (int i = 0; i < numSamples; i++) {
+            out << frame.number << ',' << i;
+            for (int c = 0; c < columns.size(); c++) {
+                out << ',' << columns.at(c).at(i);
+            }
+            out << '\n';
+        }
+    }
+
+    return out.status() == QTextStream::Ok;
+}
+
+/*!
+    Returns the index of the first sample in \a bin of \a mask.
+*/
+SampleIndex AnalogMaskTest::binStart(const Mask &mask, int bin)
+{
+    return (mask.samples * bin) / mask.upper.size();
+}
+
+/*!
+    Tests the samples \a data of signal \a signalId against \a mask and
+    adds the violations to \a result.
+*/
+void AnalogMaskTest::testSignal(int signalId, const Mask &mask,
+                                const QVector<double> &data, Result &result)
+{
+    int bins = mask.upper.size();
+    SampleIndex size = qMin(mask.samples, (SampleIndex)data.size());
+
+    for (int b = 0; b < bins; b++) {
+        SampleIndex from = binStart(mask, b);
+        if (from >= size) break;
+
+        const double* p = data.constData() + from;
+        int n = (int)(qMin(binStart(mask, b+1), size) - from);
+        double upper = mask.upper.at(b);
+        double lower = mask.lower.at(b);
+
+        // no branches depending on the data so that the loop is vectorized
+        double min = p[0];
+        double max = p[0];
+        for (int i = 1; i < n; i++) {
+            min = (p[i] < min) ? p[i] : min;
+            max = (p[i] > max) ? p[i] : max;
+        }
+
+        if (min >= lower && max <= upper) continue;
+
+        // find the samples outside the limits
+        result.failedBins++;
+        for (int i = 0; i < n; i++) {
+            if (p[i] >= lower && p[i] <= upper) continue;
+
+            result.failedSamples++;
+            if (result.violations.size() < MaxViolations) {
+                Violation v;
+                v.signalId = signalId;
+                v.sampleIdx = from + i;
+                v.value = p[i];
+                result.violations.append(v);
+            }
+        }
+    }
+}
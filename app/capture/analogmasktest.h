@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef ANALOGMASKTEST_H
+#define ANALOGMASKTEST_H
+
+#include <QMap>
+#include <QList>
+#include <QVector>
+#include <QString>
+
+#include "common/sampleindex.h"
+
+class AnalogMaskTest
+{
+public:
+
+    /*!
+        Upper and lower limits for one analog signal. The frame is divided
+        into upper.size() equally long bins, each with its own limits.
+    */
+    struct Mask {
+        SampleIndex samples;
+        QVector<double> upper;
+        QVector<double> lower;
+    };
+
+    /*!
+        A sample outside the mask.
+    */
+    struct Violation {
+        int signalId;
+        SampleIndex sampleIdx;
+        double value;
+    };
+
+    /*!
+        The result of testing one frame.
+    */
+    struct Result {
+        bool tested;
+        bool passed;
+        int failedBins;
+        qint64 failedSamples;
+        qint64 elapsedNs;
+        QVector<Violation> violations;
+
+        Result() : tested(false), passed(true), failedBins(0),
+            failedSamples(0), elapsedNs(0) {}
+    };
+
+    /*!
+        A frame that failed the test.
+    */
+    struct Frame {
+        qint64 number;
+        Result result;
+        QMap<int, QVector<double> > data;
+    };
+
+    enum Constants {
+        DefaultResolution = 500,
+        MaxViolations = 1000,
+        MaxKeptFrames = 16
+    };
+
+    static AnalogMaskTest& instance()
+    {
+        static AnalogMaskTest singleton;
+        return singleton;
+    }
+
+    void setEnabled(bool enabled) {mEnabled = enabled;}
+    bool isEnabled() const {return mEnabled && !mMasks.isEmpty();}
+
+    void setStopOnFailure(bool stop) {mStopOnFailure = stop;}
+    bool stopOnFailure() const {return mStopOnFailure;}
+
+    void createMask(int signalId, const QVector<double> &data, int resolution,
+                    double tolerance);
+    void setLimits(int signalId, SampleIndex samples, double lower, double upper);
+    void removeMask(int signalId) {mMasks.remove(signalId);}
+    bool hasMask(int signalId) const {return mMasks.contains(signalId);}
+    Mask mask(int signalId) const {return mMasks.value(signalId);}
+
+    Result evaluate(const QMap<int, QVector<double> > &data) const;
+    void record(const Result &result, const QMap<int, QVector<double> > &data);
+
+    const Result &lastResult() const {return mLastResult;}
+    qint64 frames() const {return mFrames;}
+    qint64 failedFrames() const {return mFailedFrames;}
+    const QList<Frame> &keptFrames() const {return mKeptFrames;}
+    void resetStatistics();
+
+    bool saveFailedFrames(const QString &filePath) const;
+
+private:
+    bool mEnabled;
+    bool mStopOnFailure;
+    QMap<int, Mask> mMasks;
+
+    Result mLastResult;
+    qint64 mFrames;
+    qint64 mFailedFrames;
+    QList<Frame> mKeptFrames;
+
+    explicit AnalogMaskTest();
+    // hide copy constructor
+    AnalogMaskTest(const AnalogMaskTest&);
+    // hide assign operator
+    AnalogMaskTest& operator=(const AnalogMaskTest &);
+
+    static SampleIndex binStart(const Mask &mask, int bin);
+    static void testSignal(int signalId, const Mask &mask,
+                           const QVector<double> &data, Result &result);
+};
+
+#endif // ANALOGMASKTEST_H
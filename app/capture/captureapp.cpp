@@ -18,8 +18,11 @@
 #include <QComboBox>
 #include <QFile>
 #include <QDataStream>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include "uiselectsignaldialog.h"
+#include "uistopconditiondialog.h"
+#include "uianalogmaskdialog.h"
 #include "cursormanager.h"
 #include "uicaptureexporter.h"
 
@@ -56,6 +59,18 @@ CaptureApp::CaptureApp(QWidget* uiContext, QObject *parent) :
     mCaptureActive = false;
 
     mContinuous = false;
+
+    // Deallocation: Destructor
+    mStopCondition = new DecodeStopCondition();
+    mEvaluationPending = false;
+    mFrameWaiting = false;
+    mRestoreHeldFrame = false;
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mFrameWatcher = new QFutureWatcher<FrameEvaluation>(this);
+    connect(mFrameWatcher, SIGNAL(finished()),
+            this, SLOT(handleFrameEvaluated()));
+
     // Deallocation: uiContext is set as parent
     mArea = new UiCaptureArea(mSignalManager, uiContext);
 
@@ -72,19 +87,26 @@ CaptureApp::CaptureApp(QWidget* uiContext, QObject *parent) :
             connect(device->captureDevice(),
                     SIGNAL(captureFinished(bool,QString)),
                     this, SLOT(handleCaptureFinished(bool,QString)));
+            connect(device->captureDevice(),
+                    SIGNAL(captureUpdated()),
+                    this, SLOT(handleCaptureUpdated()));
         }
     }
 
 }
 
 /*!
-    Deletes menu.
+    Deletes menu and stop condition.
 */
 CaptureApp::~CaptureApp()
 {
     if (mMenu != NULL) {
         delete mMenu;
     }
+
+    // the condition may be in use by an evaluation
+    mFrameWatcher->waitForFinished();
+    delete mStopCondition;
 }
 
 /*!
@@ -151,7 +173,7 @@ void CaptureApp::openProject(QSettings &project)
         project.beginGroup("capture");
 
         int sampleRate = project.value("sampleRate", 1).toInt();
-        int digTrigger = project.value("digitalTrigger", 0).toInt();
+        SampleIndex digTrigger = project.value("digitalTrigger", 0).toLongLong();
 
         captureDevice->setUsedSampleRate(sampleRate);
         setSampleRate(sampleRate);
@@ -163,7 +185,7 @@ void CaptureApp::openProject(QSettings &project)
         // If the trigger position hasn't been set before there will
         // be an offset problem each time a project is loaded
         CursorManager::instance().setCursorPosition(UiCursor::Trigger,
-                                                    (double)digTrigger/sampleRate);
+                                                    SampleTime::time(digTrigger, sampleRate));
 
         mSignalManager->loadSignalsFromSettings(project, in);
 
@@ -257,9 +279,11 @@ void CaptureApp::saveProject(QSettings &project)
             if (i == UiCursor::Trigger) continue;
 
             project.setArrayIndex(idx++);
+            // all 17 significant digits so that the cursor is restored
+            // at exactly the same sample also far into a long capture
             project.setValue("meta", QString("%1;%2;%3")
                              .arg(i)
-                             .arg(CursorManager::instance().cursorPosition((UiCursor::CursorId)i))
+                             .arg(CursorManager::instance().cursorPosition((UiCursor::CursorId)i), 0, 'g', 17)
                              .arg(CursorManager::instance().isCursorOn((UiCursor::CursorId)i)));
 
         }
@@ -428,6 +452,32 @@ void CaptureApp::createMenu()
     connect(action, SIGNAL(triggered()), this, SLOT(triggerSettings()));
     mMenu->addAction(action);
 
+    //
+    //    Stop condition
+    //
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mMenuStopConditionAction = new QAction(tr("Stop condition"), this);
+    mMenuStopConditionAction->setData("Stop condition");
+    mMenuStopConditionAction->setToolTip(
+                tr("Stop continuous capture when a decoded item matches"));
+    connect(mMenuStopConditionAction, SIGNAL(triggered()),
+            this, SLOT(stopConditionSettings()));
+    mMenu->addAction(mMenuStopConditionAction);
+
+    //
+    //    Mask test
+    //
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mMenuMaskTestAction = new QAction(tr("Mask test"), this);
+    mMenuMaskTestAction->setData("Mask test");
+    mMenuMaskTestAction->setToolTip(
+                tr("Test analog signals against masks during continuous capture"));
+    connect(mMenuMaskTestAction, SIGNAL(triggered()),
+            this, SLOT(maskTestSettings()));
+    mMenu->addAction(mMenuMaskTestAction);
+
     mMenu->addSeparator();
 
     //
@@ -441,6 +491,17 @@ void CaptureApp::createMenu()
     connect(action, SIGNAL(triggered()), this, SLOT(calibrationSettings()));
     mMenu->addAction(action);
 
+    //
+    //    Diagnostics
+    //
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    action = new QAction(tr("Diagnostics"), this);
+    action->setData("Diagnostics");
+    action->setToolTip("Show information about the latest capture");
+    connect(action, SIGNAL(triggered()), this, SLOT(diagnostics()));
+    mMenu->addAction(action);
+
     //
     //    Export Data
     //
@@ -472,6 +533,10 @@ void CaptureApp::changeCaptureActions(bool captureActive) {
 
         mMenuStopAction->setEnabled(true);
         mTbStopAction->setEnabled(true);
+
+        // the condition and masks can't change while frames are evaluated
+        mMenuStopConditionAction->setEnabled(false);
+        mMenuMaskTestAction->setEnabled(false);
     } else {
         mMenuStartAction->setEnabled(true);
         mTbStartAction->setEnabled(true);
@@ -480,6 +545,9 @@ void CaptureApp::changeCaptureActions(bool captureActive) {
 
         mMenuStopAction->setEnabled(false);
         mTbStopAction->setEnabled(false);
+
+        mMenuStopConditionAction->setEnabled(true);
+        mMenuMaskTestAction->setEnabled(true);
     }
 
 }
@@ -541,12 +609,14 @@ void CaptureApp::start()
     if (device != NULL && device->isAvailable()
             && device->supportsCaptureDevice()) {
 
-        changeCaptureActions(true);
-
+        // stop continuous capture before changing the actions since an
+        // ongoing frame evaluation is cancelled by stop()
         if (mContinuous) {
             stop();
         }
 
+        changeCaptureActions(true);
+
         doStart();
     }
     else {
@@ -593,6 +663,15 @@ void CaptureApp::startContinuous()
 void CaptureApp::stop()
 {
     mContinuous = false;
+
+    // continuous capture waiting for a frame to be evaluated; the result of
+    // the evaluation is ignored
+    if (mEvaluationPending) {
+        mEvaluationPending = false;
+        changeCaptureActions(false);
+    }
+    mFrameWaiting = false;
+
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
     if (device != NULL) {
@@ -617,15 +696,42 @@ void CaptureApp::handleCaptureFinished(bool successful, QString  msg)
     if (device != NULL) {
 
         if (successful) {
+
+            // the capture was stopped since an earlier frame matched; show
+            // that frame instead of the one captured after it
+            if (mRestoreHeldFrame) {
+                mRestoreHeldFrame = false;
+                restoreHeldFrame(device);
+            }
+
             mArea->handleSignalDataChanged();
 
             if (mContinuous && device->supportsContinuousCapture()) {
-                doStart();
+                if (mStopCondition->isEnabled()
+                        || AnalogMaskTest::instance().isEnabled()) {
+
+                    // only one frame is evaluated at a time. This frame is
+                    // evaluated when the previous one is done, see
+                    // handleFrameEvaluated
+                    if (mEvaluationPending) {
+                        mFrameWaiting = true;
+                    }
+                    else {
+                        evaluateFrame(device);
+                        doStart();
+                    }
+                }
+                else {
+                    doStart();
+                }
             }
         }
         else {
             // always make sure continuous mode is reset if capture fails.
             mContinuous = false;
+            mEvaluationPending = false;
+            mFrameWaiting = false;
+            mRestoreHeldFrame = false;
 
             QMessageBox::warning(mUiContext,
                                  tr("Capture Failed"),
@@ -637,6 +743,193 @@ void CaptureApp::handleCaptureFinished(bool successful, QString  msg)
 
 }
 
+/*!
+    Starts to evaluate the frame just captured by \a device on a worker
+    thread, both for the stop condition and the mask test. The signal data
+    of the frame is held so that the next capture can be started while the
+    frame is evaluated, see handleFrameEvaluated.
+*/
+void CaptureApp::evaluateFrame(CaptureDevice *device)
+{
+    // an evaluation ignored by stop() may still be running
+    mFrameWatcher->waitForFinished();
+
+    // the transitions and samples are implicitly shared so copying them is
+    // cheap and the worker is unaffected if the device replaces them
+    QVector<DigitalTransitions> channels;
+    if (mStopCondition->isEnabled()) {
+        foreach(int id, mStopCondition->signalIds()) {
+            const DigitalTransitions* t = NULL;
+            if (id != -1) {
+                t = device->digitalTransitions(id);
+            }
+            channels.append((t != NULL) ? *t : DigitalTransitions());
+        }
+    }
+
+    QMap<int, QVector<double> > analogData;
+    if (AnalogMaskTest::instance().isEnabled()) {
+        foreach(AnalogSignal* s, device->analogSignals()) {
+            QVector<double>* data = device->analogData(s->id());
+            if (data != NULL) {
+                analogData.insert(s->id(), *data);
+            }
+        }
+    }
+
+    // the held copies share the data with the device until the next
+    // capture replaces it
+    mHeldFrame.digitalData.clear();
+    foreach(DigitalSignal* s, device->digitalSignals()) {
+        QVector<int>* data = device->digitalData(s->id());
+        if (data != NULL) {
+            mHeldFrame.digitalData.insert(s->id(), *data);
+        }
+    }
+    mHeldFrame.analogData.clear();
+    foreach(AnalogSignal* s, device->analogSignals()) {
+        QVector<double>* data = device->analogData(s->id());
+        if (data != NULL) {
+            mHeldFrame.analogData.insert(s->id(), *data);
+        }
+    }
+    mHeldFrame.triggerIndex = device->digitalTriggerIndex();
+    mHeldFrame.sampleRate = device->usedSampleRate();
+
+    mFrameWatcher->setFuture(QtConcurrent::run(&CaptureApp::runEvaluation,
+                                               mStopCondition,
+                                               channels,
+                                               device->usedSampleRate(),
+                                               analogData));
+    mEvaluationPending = true;
+}
+
+/*!
+    Replaces the signal data of \a device with the frame held while it was
+    evaluated.
+*/
+void CaptureApp::restoreHeldFrame(CaptureDevice *device)
+{
+    QMapIterator<int, QVector<int> > digital(mHeldFrame.digitalData);
+    while (digital.hasNext()) {
+        digital.next();
+        device->setDigitalData(digital.key(), digital.value());
+    }
+
+    QMapIterator<int, QVector<double> > analog(mHeldFrame.analogData);
+    while (analog.hasNext()) {
+        analog.next();
+        device->setAnalogData(analog.key(), analog.value());
+    }
+
+    device->setUsedSampleRate(mHeldFrame.sampleRate);
+    device->setDigitalTriggerIndex(mHeldFrame.triggerIndex);
+}
+
+/*!
+    Evaluates a frame on a worker thread. The stop \a condition is
+    evaluated for the transitions \a channels captured at \a sampleRate and
+    the analog samples \a analogData are tested against the masks.
+*/
+CaptureApp::FrameEvaluation CaptureApp::runEvaluation(DecodeStopCondition *condition,
+                                                      QVector<DigitalTransitions> channels,
+                                                      int sampleRate,
+                                                      QMap<int, QVector<double> > analogData)
+{
+    FrameEvaluation evaluation;
+
+    evaluation.stop = condition->isEnabled()
+            && condition->evaluate(channels, sampleRate);
+
+    if (!analogData.isEmpty()) {
+        evaluation.mask = AnalogMaskTest::instance().evaluate(analogData);
+        evaluation.analogData = analogData;
+    }
+
+    return evaluation;
+}
+
+/*!
+    Called when a frame has been evaluated during continuous capture. The
+    mask test result is added to the statistics. Continuous capture is
+    stopped and the evaluated frame is shown if the stop condition matched
+    or if the frame failed the mask test and the test should stop on
+    failure. Otherwise continuous capture goes on; a frame captured while
+    evaluating is evaluated next.
+*/
+void CaptureApp::handleFrameEvaluated()
+{
+    // stopped by the user while evaluating
+    if (!mEvaluationPending) return;
+    mEvaluationPending = false;
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    FrameEvaluation evaluation = mFrameWatcher->result();
+
+    AnalogMaskTest &maskTest = AnalogMaskTest::instance();
+    maskTest.record(evaluation.mask, evaluation.analogData);
+    if (evaluation.mask.tested) {
+        mArea->updateUi();
+    }
+
+    bool maskStop = evaluation.mask.tested && !evaluation.mask.passed
+            && maskTest.stopOnFailure();
+
+    if (!evaluation.stop && !maskStop) {
+        if (mFrameWaiting) {
+            mFrameWaiting = false;
+            evaluateFrame(device);
+            doStart();
+        }
+        return;
+    }
+
+    mContinuous = false;
+    changeCaptureActions(false);
+
+    if (mFrameWaiting) {
+        // no capture is running, the newer frame is simply replaced
+        mFrameWaiting = false;
+        restoreHeldFrame(device);
+        mArea->handleSignalDataChanged();
+    }
+    else {
+        // the frame is restored when the running capture has stopped
+        mRestoreHeldFrame = true;
+        device->stop();
+    }
+
+    QString msg;
+    if (evaluation.stop) {
+        double t = SampleTime::time(mStopCondition->matchIndex(),
+                                    mHeldFrame.sampleRate);
+
+        msg = tr("Continuous capture stopped: %1 at %2 (decoded in %3 ms).")
+                .arg(mStopCondition->description())
+                .arg(StringUtil::timeInSecToString(t))
+                .arg(mStopCondition->elapsedNs()/1e6, 0, 'f', 2);
+    }
+    else {
+        msg = tr("Continuous capture stopped: frame %1 failed the mask test "
+                 "with %2 samples outside the mask.")
+                .arg(maskTest.frames())
+                .arg(evaluation.mask.failedSamples);
+    }
+
+    QMessageBox::information(mUiContext, tr("Capture Stopped"), msg);
+}
+
+/*!
+    Handles that more data has been received during an ongoing capture.
+*/
+void CaptureApp::handleCaptureUpdated()
+{
+    mArea->handleSignalDataChanged();
+}
+
 /*!
     Called when the user selects to change trigger settings.
 */
@@ -650,6 +943,33 @@ void CaptureApp::triggerSettings()
     }
 }
 
+/*!
+    Called when the user selects to change the stop condition for continuous
+    capture.
+*/
+void CaptureApp::stopConditionSettings()
+{
+    // an evaluation ignored by stop() may still be running
+    mFrameWatcher->waitForFinished();
+
+    UiStopConditionDialog dialog(mStopCondition, mUiContext);
+    dialog.exec();
+}
+
+/*!
+    Called when the user selects to change the mask test of analog signals.
+*/
+void CaptureApp::maskTestSettings()
+{
+    // an evaluation ignored by stop() may still be running
+    mFrameWatcher->waitForFinished();
+
+    UiAnalogMaskDialog dialog(mUiContext);
+    dialog.exec();
+
+    mArea->updateUi();
+}
+
 /*!
     Called when the user selects to calibrate the hardware.
 */
@@ -663,6 +983,19 @@ void CaptureApp::calibrationSettings()
     }
 }
 
+/*!
+    Called when the user selects to show diagnostics for the captures.
+*/
+void CaptureApp::diagnostics()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+
+    if (device != NULL) {
+        device->showDiagnostics(mUiContext);
+    }
+}
+
 /*!
     Called when the user selects to enable more signals.
 */
@@ -742,7 +1075,7 @@ void CaptureApp::exportData()
 
     } while(false);
 
-    UiCaptureExporter exporter(device, mUiContext);
+    UiCaptureExporter exporter(device, mSignalManager, mUiContext);
     exporter.exec();
 
 }
@@ -22,8 +22,11 @@
 #include <QAction>
 #include <QComboBox>
 #include <QSettings>
+#include <QFutureWatcher>
 
 #include "uicapturearea.h"
+#include "decodestopcondition.h"
+#include "analogmasktest.h"
 #include "device/device.h"
 
 class CaptureApp : public QObject
@@ -52,12 +55,40 @@ signals:
 public slots:
 
 private:
+
+    /*!
+        The result of evaluating a frame during continuous capture.
+    */
+    struct FrameEvaluation {
+        bool stop;
+        AnalogMaskTest::Result mask;
+        QMap<int, QVector<double> > analogData;
+    };
+
+    /*!
+        A copy of the signal data of a frame captured during continuous
+        capture. It is kept while the frame is evaluated and the next frame
+        is captured, so that a matching frame can be shown.
+    */
+    struct HeldFrame {
+        QMap<int, QVector<int> > digitalData;
+        QMap<int, QVector<double> > analogData;
+        SampleIndex triggerIndex;
+        int sampleRate;
+    };
+
     SignalManager* mSignalManager;
     QWidget* mUiContext;
     QToolBar* mToolBar;
     QMenu* mMenu;
     UiCaptureArea* mArea;
     bool mContinuous;
+    DecodeStopCondition* mStopCondition;
+    QFutureWatcher<FrameEvaluation>* mFrameWatcher;
+    bool mEvaluationPending;
+    HeldFrame mHeldFrame;
+    bool mFrameWaiting;
+    bool mRestoreHeldFrame;
 
     QAction* mMenuStartAction;
     QAction* mMenuContinuousAction;
@@ -65,6 +96,8 @@ private:
     QAction* mTbStartAction;
     QAction* mTbContinuousAction;
     QAction* mTbStopAction;
+    QAction* mMenuStopConditionAction;
+    QAction* mMenuMaskTestAction;
 
     QComboBox* mRateBox;
 
@@ -76,6 +109,12 @@ private:
     void doStart();
     void setupRates(CaptureDevice* device);
     void setSampleRate(int rate);
+    void evaluateFrame(CaptureDevice* device);
+    void restoreHeldFrame(CaptureDevice* device);
+    static FrameEvaluation runEvaluation(DecodeStopCondition* condition,
+                                         QVector<DigitalTransitions> channels,
+                                         int sampleRate,
+                                         QMap<int, QVector<double> > analogData);
 
 
 private slots:
@@ -83,8 +122,13 @@ private slots:
     void startContinuous();
     void stop();
     void handleCaptureFinished(bool successful, QString msg);
+    void handleCaptureUpdated();
+    void handleFrameEvaluated();
     void triggerSettings();
+    void stopConditionSettings();
+    void maskTestSettings();
     void calibrationSettings();
+    void diagnostics();
     void selectSignalsToAdd();
     void exportData();
     void sampleRateChanged(int rateIndex);
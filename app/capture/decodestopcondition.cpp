@@ -0,0 +1,196 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "decodestopcondition.h"
+
+#include <QStringList>
+
+/*!
+    \class DecodeStopCondition
+    \brief A condition on decoded items used to stop continuous capture.
+
+    \ingroup Capture
+
+    The condition is an item type of a decoder, e.g., a UART frame error,
+    optionally together with the item's value, e.g., an SPI word 0xDEAD.
+    For each captured frame the decoder is run on the transitions of its
+    signals with a DecoderSession and the condition matches if any of the
+    decoded items does.
+
+    evaluate() doesn't use the UI or the capture device and is meant to be
+    run on a worker thread. The condition must not be changed while an
+    evaluation is running.
+*/
+
+/*!
+    Constructs a disabled condition without a decoder.
+*/
+DecodeStopCondition::DecodeStopCondition()
+{
+    mEnabled = false;
+    mSession = NULL;
+    mItemType = 0;
+    mValue = -1;
+    mMatchIdx = -1;
+    mElapsedNs = 0;
+}
+
+/*!
+    Deletes the condition and its decoder.
+*/
+DecodeStopCondition::~DecodeStopCondition()
+{
+    delete mSession;
+}
+
+/*!
+    \fn void DecodeStopCondition::setEnabled(bool enabled)
+
+    Enables the condition if \a enabled is true.
+*/
+
+/*!
+    \fn bool DecodeStopCondition::isEnabled() const
+
+    Returns true if the condition is enabled and has a decoder.
+*/
+
+/*!
+    Set the \a decoder to run. The condition takes ownership of the decoder
+    and deletes the previous one.
+*/
+void DecodeStopCondition::setDecoder(DecoderInterface *decoder)
+{
+    delete mSession;
+    mSession = NULL;
+
+    if (decoder != NULL) {
+        // Deallocation: Destructor or the next call to setDecoder
+        mSession = new DecoderSession(decoder);
+    }
+}
+
+/*!
+    Returns the decoder or NULL if there is no decoder.
+*/
+DecoderInterface* DecodeStopCondition::decoder() const
+{
+    if (mSession == NULL) return NULL;
+
+    return mSession->decoder();
+}
+
+/*!
+    \fn void DecodeStopCondition::setSignalIds(const QVector<int> &ids)
+
+    Set the signal IDs to \a ids, one for each channel of the decoder.
+*/
+
+/*!
+    \fn QVector<int> DecodeStopCondition::signalIds() const
+
+    Returns the signal IDs.
+*/
+
+/*!
+    \fn void DecodeStopCondition::setItemType(int type)
+
+    Set the item \a type to look for, see DecoderInterface::itemTypes().
+*/
+
+/*!
+    \fn int DecodeStopCondition::itemType() const
+
+    Returns the item type to look for.
+*/
+
+/*!
+    \fn void DecodeStopCondition::setValue(int value)
+
+    Set the item \a value to look for. -1 matches any value.
+*/
+
+/*!
+    \fn int DecodeStopCondition::value() const
+
+    Returns the item value to look for, -1 for any value.
+*/
+
+/*!
+    Returns a description of the condition, e.g., "I2C NACK 0x3C".
+*/
+QString DecodeStopCondition::description() const
+{
+    if (mSession == NULL) return QString();
+
+    QStringList types = decoder()->itemTypes();
+    QString str = QString("%1 %2").arg(decoder()->name())
+            .arg(types.value(mItemType));
+
+    if (mValue != -1) {
+        str.append(QString(" 0x%1").arg(mValue, 0, 16));
+    }
+
+    return str;
+}
+
+/*!
+    Decodes a frame where \a channels are the transitions of the decoder's
+    channels captured at \a sampleRate. Returns true if the condition
+    matches; the sample index of the first matching item is then given by
+    matchIndex().
+*/
+bool DecodeStopCondition::evaluate(const QVector<DigitalTransitions> &channels,
+                                   int sampleRate)
+{
+    mMatchIdx = -1;
+    mElapsedNs = 0;
+
+    if (mSession == NULL) return false;
+
+    QVector<const DigitalTransitions*> ptrs;
+    for (int i = 0; i < channels.size(); i++) {
+        ptrs.append(&channels.at(i));
+    }
+
+    mSession->decodeTransitions(ptrs, sampleRate);
+    mElapsedNs = mSession->statistics().elapsedNs;
+
+    const QVector<DecoderItem> &items = mSession->items();
+    for (int i = 0; i < items.size(); i++) {
+        const DecoderItem &item = items.at(i);
+
+        if (item.type == mItemType && (mValue == -1 || item.value == mValue)) {
+            mMatchIdx = item.startIdx;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    \fn SampleIndex DecodeStopCondition::matchIndex() const
+
+    Returns the sample index of the item that matched in the latest
+    evaluation, -1 if there was no match.
+*/
+
+/*!
+    \fn qint64 DecodeStopCondition::elapsedNs() const
+
+    Returns the time in nanoseconds the decoder used in the latest
+    evaluation.
+*/
@@ -0,0 +1,62 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DECODESTOPCONDITION_H
+#define DECODESTOPCONDITION_H
+
+#include <QVector>
+
+#include "analyzer/decoder/decodersession.h"
+
+class DecodeStopCondition
+{
+public:
+    DecodeStopCondition();
+    ~DecodeStopCondition();
+
+    void setEnabled(bool enabled) {mEnabled = enabled;}
+    bool isEnabled() const {return mEnabled && mSession != NULL;}
+
+    void setDecoder(DecoderInterface* decoder);
+    DecoderInterface* decoder() const;
+
+    void setSignalIds(const QVector<int> &ids) {mSignalIds = ids;}
+    QVector<int> signalIds() const {return mSignalIds;}
+
+    void setItemType(int type) {mItemType = type;}
+    int itemType() const {return mItemType;}
+
+    void setValue(int value) {mValue = value;}
+    int value() const {return mValue;}
+
+    QString description() const;
+
+    bool evaluate(const QVector<DigitalTransitions> &channels, int sampleRate);
+
+    SampleIndex matchIndex() const {return mMatchIdx;}
+    qint64 elapsedNs() const {return mElapsedNs;}
+
+private:
+    bool mEnabled;
+    DecoderSession* mSession;
+    QVector<int> mSignalIds;
+    int mItemType;
+    int mValue;
+
+    SampleIndex mMatchIdx;
+    qint64 mElapsedNs;
+};
+
+#endif // DECODESTOPCONDITION_H
@@ -331,8 +331,8 @@ void SignalManager::reloadSignalsFromDevice()
 /*!
     Find the closest digital signal transition to the given time \a startTime.
     If there is an active signal (user holds mouse pointer over it) this
-    signal will be used; otherwise the order of the signals in the signal
-    list will be used when searching for a transition.
+    signal will be used; otherwise the transitions of all signals are
+    searched. Returns -1 if there isn't any transition.
 */
 double SignalManager::closestDigitalTransition(double startTime)
 {
@@ -346,26 +346,54 @@ double SignalManager::closestDigitalTransition(double startTime)
         return getClosestDigitalTransitionForSignal(startTime, signalId);
     }
 
-    double closestTime = -1;
-    double lastDiff =    99999999;
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+    const DigitalEdgeIndex &edges = device->digitalEdgeIndex();
+    int rate = device->usedSampleRate();
 
+    SampleIndex idx = edges.closest(SampleTime::nearestIndex(startTime, rate));
+    if (idx == -1) {
+        return -1;
+    }
 
-    foreach(UiAbstractSignal* s, mSignalList) {
-        UiDigitalSignal* ds = qobject_cast<UiDigitalSignal*>(s);
-        if (ds != NULL) {
-            double t = getClosestDigitalTransitionForSignal(startTime,
-                                                            ds->signal()->id());
-            double diff = qAbs(startTime-t);
-            if (diff < lastDiff) {
-                lastDiff = diff;
-                closestTime = t;
-            }
+    return SampleTime::time(idx, rate);
+}
 
-        }
+/*!
+    Find the first digital signal transition after the given time
+    \a startTime, on the active signal if there is one and otherwise on any
+    signal. Returns -1 if there isn't any transition.
+*/
+double SignalManager::nextDigitalTransition(double startTime)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+    const DigitalEdgeIndex &edges = device->digitalEdgeIndex();
+    int rate = device->usedSampleRate();
 
+    SampleIndex idx = edges.next(SampleTime::floorIndex(startTime, rate), activeDigitalSignalId());
+    if (idx == -1) {
+        return -1;
     }
 
-    return closestTime;
+    return SampleTime::time(idx, rate);
+}
+
+/*!
+    Find the last digital signal transition before the given time
+    \a startTime, on the active signal if there is one and otherwise on any
+    signal. Returns -1 if there isn't any transition.
+*/
+double SignalManager::previousDigitalTransition(double startTime)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
+    const DigitalEdgeIndex &edges = device->digitalEdgeIndex();
+    int rate = device->usedSampleRate();
+
+    SampleIndex idx = edges.previous(SampleTime::ceilIndex(startTime, rate), activeDigitalSignalId());
+    if (idx == -1) {
+        return -1;
+    }
+
+    return SampleTime::time(idx, rate);
 }
 
 /*!
@@ -431,49 +459,41 @@ QVector<int> SignalManager::bitArrayToDigitalSignal(QBitArray data)
 
 /*!
     Find the transition closest to time \a t for the signal with given
-    \a signalId.
+    \a signalId. Returns -1 if the signal doesn't have any transition.
 */
 double SignalManager::getClosestDigitalTransitionForSignal(double t, int signalId)
 {
-    double time = -1;
-
-
     CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
 
-    QList<int> data;
-    device->digitalTransitions(signalId, data);
-
-
-    double period = (double)1/device->usedSampleRate();
-
-    if (data.size() > 0) {
-
-        int startIdx = (int)(t/period);
-        int beforeIdx = startIdx;
-        int afterIdx = startIdx;
-
-        for (int i = 1; i < data.size()-1; i++) {
-            if (startIdx > data.at(i)) {
-                beforeIdx = data.at(i);
-            }
-            if (startIdx < data.at(i)) {
+    // the signal's own transitions are searched rather than the index as
+    // the signal's transitions can be far apart in the index
+    const DigitalTransitions* data = device->digitalTransitions(signalId);
+    if (data == NULL || data->size() == 0) {
+        return -1;
+    }
 
-                afterIdx = data.at(i);
+    int rate = device->usedSampleRate();
+    SampleIndex startIdx = SampleTime::nearestIndex(t, rate);
 
-                break;
-            }
-        }
+    int after = data->lowerBound(startIdx);
 
-        if (startIdx - beforeIdx < afterIdx - startIdx) {
-            time = (beforeIdx+1)*period;
-        }
-        else {
-            time = afterIdx*period;
+    SampleIndex idx;
+    if (after == data->size()) {
+        idx = data->at(after - 1);
+    }
+    else if (after == 0) {
+        idx = data->at(after);
+    }
+    else {
+        DigitalTransitions::const_iterator it = data->iteratorAt(after - 1);
+        SampleIndex before = *it;
+        idx = *(++it);
+        if (startIdx - before < idx - startIdx) {
+            idx = before;
         }
-
     }
 
-    return time;
+    return SampleTime::time(idx, rate);
 }
 
 /*!
@@ -47,6 +47,8 @@ public:
     void reloadSignalsFromDevice();
 
     double closestDigitalTransition(double startTime);
+    double nextDigitalTransition(double startTime);
+    double previousDigitalTransition(double startTime);
     
 signals:
     void signalsAdded();
@@ -0,0 +1,363 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uianalogmaskdialog.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QMessageBox>
+#include <QFileDialog>
+#include <QDir>
+
+#include "analogmasktest.h"
+#include "device/devicemanager.h"
+
+/*!
+    \class UiAnalogMaskDialog
+    \brief Dialog window used to configure the mask test of analog signals.
+
+    \ingroup Capture
+
+    A mask is created for the selected signal either from the current
+    capture with a tolerance or from fixed limits. Masks are changed
+    immediately while enabling the test is applied when the dialog is
+    accepted. The dialog also shows the statistics of the test and can save
+    the frames that failed.
+*/
+
+
+/*!
+    Constructs the UiAnalogMaskDialog with the given \a parent.
+*/
+UiAnalogMaskDialog::UiAnalogMaskDialog(QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle(tr("Mask Test"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    AnalogMaskTest &maskTest = AnalogMaskTest::instance();
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* formLayout = new QFormLayout;
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mEnabledCheckBox = new QCheckBox(this);
+    mEnabledCheckBox->setChecked(maskTest.isEnabled());
+    mEnabledCheckBox->setToolTip(tr("Test each frame during continuous capture"));
+    formLayout->addRow(tr("Enabled: "), mEnabledCheckBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mStopCheckBox = new QCheckBox(this);
+    mStopCheckBox->setChecked(maskTest.stopOnFailure());
+    mStopCheckBox->setToolTip(tr("Stop continuous capture at the first "
+                                 "frame that fails"));
+    formLayout->addRow(tr("Stop on failure: "), mStopCheckBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mSignalBox = new QComboBox(this);
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device != NULL) {
+        foreach(AnalogSignal* s, device->analogSignals()) {
+            mSignalBox->addItem(QString("A%1").arg(s->id()), s->id());
+        }
+    }
+    connect(mSignalBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(updateStatus()));
+    formLayout->addRow(tr("Signal: "), mSignalBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mMaskLbl = new QLabel(this);
+    formLayout->addRow(tr("Mask: "), mMaskLbl);
+
+    // --- mask from capture
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mToleranceEdit = new QLineEdit("0.1", this);
+    mToleranceEdit->setToolTip(tr("Tolerance in volts added to the captured signal"));
+    formLayout->addRow(tr("Tolerance (V): "), mToleranceEdit);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mResolutionEdit = new QLineEdit(
+                QString::number(AnalogMaskTest::DefaultResolution), this);
+    mResolutionEdit->setToolTip(tr("Number of parts the mask is divided into"));
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QPushButton* createBtn = new QPushButton(tr("Create from capture"), this);
+    connect(createBtn, SIGNAL(clicked()), this, SLOT(createMask()));
+
+    // Deallocation: Re-parented when calling formLayout->addRow
+    QHBoxLayout* resolutionLayout = new QHBoxLayout;
+    resolutionLayout->addWidget(mResolutionEdit);
+    resolutionLayout->addWidget(createBtn);
+    formLayout->addRow(tr("Resolution: "), resolutionLayout);
+
+    // --- fixed limits
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mLowerEdit = new QLineEdit("0", this);
+    formLayout->addRow(tr("Lower limit (V): "), mLowerEdit);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mUpperEdit = new QLineEdit("1", this);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QPushButton* limitsBtn = new QPushButton(tr("Set limits"), this);
+    connect(limitsBtn, SIGNAL(clicked()), this, SLOT(setLimits()));
+
+    // Deallocation: Re-parented when calling formLayout->addRow
+    QHBoxLayout* upperLayout = new QHBoxLayout;
+    upperLayout->addWidget(mUpperEdit);
+    upperLayout->addWidget(limitsBtn);
+    formLayout->addRow(tr("Upper limit (V): "), upperLayout);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QPushButton* removeBtn = new QPushButton(tr("Remove mask"), this);
+    connect(removeBtn, SIGNAL(clicked()), this, SLOT(removeMask()));
+    formLayout->addRow("", removeBtn);
+
+    // --- statistics
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mStatisticsLbl = new QLabel(this);
+    formLayout->addRow(tr("Statistics: "), mStatisticsLbl);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QPushButton* resetBtn = new QPushButton(tr("Reset"), this);
+    connect(resetBtn, SIGNAL(clicked()), this, SLOT(resetStatistics()));
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QPushButton* saveBtn = new QPushButton(tr("Save failed frames"), this);
+    connect(saveBtn, SIGNAL(clicked()), this, SLOT(saveFailedFrames()));
+
+    // Deallocation: Re-parented when calling formLayout->addRow
+    QHBoxLayout* statisticsLayout = new QHBoxLayout;
+    statisticsLayout->addWidget(resetBtn);
+    statisticsLayout->addWidget(saveBtn);
+    formLayout->addRow("", statisticsLayout);
+
+
+    // Deallocation: Ownership changed when calling setLayout
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Ok,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(accepted()), this, SLOT(accept()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(bottonBox);
+
+    setLayout(verticalLayout);
+
+    updateStatus();
+}
+
+/*!
+    Applies the enabled state and closes the dialog.
+*/
+void UiAnalogMaskDialog::accept()
+{
+    AnalogMaskTest &maskTest = AnalogMaskTest::instance();
+    maskTest.setEnabled(mEnabledCheckBox->isChecked());
+    maskTest.setStopOnFailure(mStopCheckBox->isChecked());
+
+    QDialog::accept();
+}
+
+/*!
+    Creates a mask for the selected signal from the current capture.
+*/
+void UiAnalogMaskDialog::createMask()
+{
+    int id = selectedSignal();
+    if (id == -1) return;
+
+    double tolerance = 0;
+    if (!doubleValue(mToleranceEdit, tolerance)) return;
+
+    int resolution = mResolutionEdit->text().toInt();
+    if (resolution <= 0) {
+        QMessageBox::warning(this,
+                             tr("Invalid resolution"),
+                             tr("The resolution must be a positive number."));
+        return;
+    }
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    QVector<double>* data = device->analogData(id);
+    if (data == NULL || data->isEmpty()) {
+        QMessageBox::warning(this,
+                             tr("No data"),
+                             tr("There is no captured data for the signal."));
+        return;
+    }
+
+    AnalogMaskTest::instance().createMask(id, *data, resolution, tolerance);
+    updateStatus();
+}
+
+/*!
+    Sets fixed limits for the selected signal. The mask covers as many
+    samples as the current capture.
+*/
+void UiAnalogMaskDialog::setLimits()
+{
+    int id = selectedSignal();
+    if (id == -1) return;
+
+    double lower = 0;
+    double upper = 0;
+    if (!doubleValue(mLowerEdit, lower)) return;
+    if (!doubleValue(mUpperEdit, upper)) return;
+
+    if (lower >= upper) {
+        QMessageBox::warning(this,
+                             tr("Invalid limits"),
+                             tr("The lower limit must be less than the upper limit."));
+        return;
+    }
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    SampleIndex samples = device->lastSampleIndex()+1;
+    QVector<double>* data = device->analogData(id);
+    if (data != NULL && !data->isEmpty()) {
+        samples = data->size();
+    }
+
+    if (samples <= 0) {
+        QMessageBox::warning(this,
+                             tr("No data"),
+                             tr("Capture once to set the length of the mask."));
+        return;
+    }
+
+    AnalogMaskTest::instance().setLimits(id, samples, lower, upper);
+    updateStatus();
+}
+
+/*!
+    Removes the mask of the selected signal.
+*/
+void UiAnalogMaskDialog::removeMask()
+{
+    int id = selectedSignal();
+    if (id == -1) return;
+
+    AnalogMaskTest::instance().removeMask(id);
+    updateStatus();
+}
+
+/*!
+    Resets the statistics of the test.
+*/
+void UiAnalogMaskDialog::resetStatistics()
+{
+    AnalogMaskTest::instance().resetStatistics();
+    updateStatus();
+}
+
+/*!
+    Saves the kept failing frames to a file.
+*/
+void UiAnalogMaskDialog::saveFailedFrames()
+{
+    if (AnalogMaskTest::instance().keptFrames().isEmpty()) {
+        QMessageBox::warning(this,
+                             tr("No data to save"),
+                             tr("No frame has failed the test."));
+        return;
+    }
+
+    QString filePath = QFileDialog::getSaveFileName(
+                this,
+                tr("Save File"),
+                QDir::currentPath()+"/failed.csv",
+                "Comma Separated values (*.csv)");
+
+    if (filePath.isNull() || filePath.isEmpty()) return;
+
+    if (!AnalogMaskTest::instance().saveFailedFrames(filePath)) {
+        QMessageBox::warning(this,
+                             tr("Save failed"),
+                             tr("Failed to write %1").arg(filePath));
+    }
+}
+
+/*!
+    Updates the mask and statistics labels.
+*/
+void UiAnalogMaskDialog::updateStatus()
+{
+    AnalogMaskTest &maskTest = AnalogMaskTest::instance();
+
+    int id = selectedSignal();
+    if (id != -1 && maskTest.hasMask(id)) {
+        AnalogMaskTest::Mask mask = maskTest.mask(id);
+        mMaskLbl->setText(tr("%1 samples in %2 parts")
+                          .arg(mask.samples)
+                          .arg(mask.upper.size()));
+    }
+    else {
+        mMaskLbl->setText(tr("None"));
+    }
+
+    QString txt = tr("%1 frames, %2 failed, %3 kept")
+            .arg(maskTest.frames())
+            .arg(maskTest.failedFrames())
+            .arg(maskTest.keptFrames().size());
+    if (maskTest.frames() > 0) {
+        txt.append(tr("\nLatest frame tested in %1 ms")
+                   .arg(maskTest.lastResult().elapsedNs/1e6, 0, 'f', 2));
+    }
+    mStatisticsLbl->setText(txt);
+}
+
+/*!
+    Returns the ID of the selected signal or -1 if there isn't any.
+*/
+int UiAnalogMaskDialog::selectedSignal()
+{
+    if (mSignalBox->currentIndex() < 0) return -1;
+
+    return mSignalBox->itemData(mSignalBox->currentIndex()).toInt();
+}
+
+/*!
+    Converts the text of \a edit to \a value. Returns false and shows a
+    warning if it isn't a number.
+*/
+bool UiAnalogMaskDialog::doubleValue(QLineEdit *edit, double &value)
+{
+    bool ok = false;
+    value = edit->text().toDouble(&ok);
+
+    if (!ok) {
+        QMessageBox::warning(this,
+                             tr("Invalid value"),
+                             tr("%1 is not a number.").arg(edit->text()));
+    }
+
+    return ok;
+}
@@ -0,0 +1,62 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIANALOGMASKDIALOG_H
+#define UIANALOGMASKDIALOG_H
+
+#include <QWidget>
+#include <QDialog>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QLabel>
+
+class UiAnalogMaskDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiAnalogMaskDialog(QWidget *parent = 0);
+
+signals:
+
+public slots:
+    void accept();
+
+private slots:
+    void createMask();
+    void setLimits();
+    void removeMask();
+    void resetStatistics();
+    void saveFailedFrames();
+    void updateStatus();
+
+private:
+
+    QCheckBox* mEnabledCheckBox;
+    QCheckBox* mStopCheckBox;
+    QComboBox* mSignalBox;
+    QLineEdit* mToleranceEdit;
+    QLineEdit* mResolutionEdit;
+    QLineEdit* mLowerEdit;
+    QLineEdit* mUpperEdit;
+    QLabel* mMaskLbl;
+    QLabel* mStatisticsLbl;
+
+    int selectedSignal();
+    bool doubleValue(QLineEdit* edit, double &value);
+
+};
+
+#endif // UIANALOGMASKDIALOG_H
@@ -23,6 +23,7 @@
 
 #include "common/configuration.h"
 #include "uianalogtrigger.h"
+#include "analogmasktest.h"
 #include "device/devicemanager.h"
 
 #include "uilistspinbox.h"
@@ -559,6 +560,10 @@ void UiAnalogSignal::paintEvent(QPaintEvent *event)
         // -----------------
         paintTriggerLevel(&painter);
 
+        // -----------------
+        // paint mask test statistics
+        // -----------------
+        paintMaskStatistics(&painter);
 
     }
 }
@@ -883,7 +888,7 @@ void UiAnalogSignal::findIntersect(UiAnalogSignalPrivate* signal, double time,
     int rate = device->usedSampleRate();
 
     double t = time*rate;
-    int idx = (int)t;
+    SampleIndex idx = SampleTime::floorIndex(time, rate);
     QLineF sigPart;
 
 
@@ -898,8 +903,8 @@ void UiAnalogSignal::findIntersect(UiAnalogSignalPrivate* signal, double time,
     QVector<double>* data = device->analogData(signal->mSignal->id());
 
     if (data != NULL && idx>= 0 && idx+1 < data->size()) {
-        sigPart.setLine(idx, data->at(idx),
-                        idx+1, data->at(idx+1));
+        sigPart.setLine(idx, data->at((int)idx),
+                        idx+1, data->at((int)idx+1));
         sigPart.intersect(QLineF(t, 0, t, 5), intersect);
 
         // convert x back to absolute time
@@ -1073,10 +1078,11 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
         if (data == NULL) continue;
 
         int rate = device->usedSampleRate();
-        int fromIdx = (int)(mTimeAxis->rangeLower()*rate);
+        SampleIndex firstIdx = SampleTime::floorIndex(mTimeAxis->rangeLower(), rate);
 
-        if (fromIdx >= data->size()) continue;
-        if (fromIdx < 0) fromIdx = 0;
+        if (firstIdx >= data->size()) continue;
+        if (firstIdx < 0) firstIdx = 0;
+        int fromIdx = (int)firstIdx;
 
         painter->save();
 
@@ -1108,8 +1114,8 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
 
             if ((double)(j-fromIdx)/rate < tOnePixel) continue;
 
-            from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/rate);
-            to = mTimeAxis->timeToPixelRelativeRef((double)j/rate);
+            from = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(fromIdx, rate));
+            to = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(j, rate));
 
             // no need to draw when signal is out of plot area
             if (to < 0) continue;
@@ -1158,6 +1164,8 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
             fromIdx = j;
         }
 
+        paintMask(painter, p, rate);
+
         painter->restore();
 
     }
@@ -1165,6 +1173,88 @@ void UiAnalogSignal::paintSignals(QPainter* painter)
 
 }
 
+/*!
+    Paint the mask of \a signal, if it has one, and the positions of the
+    samples outside the mask in the latest tested frame. The painter must
+    be translated to the signal's ground level.
+*/
+void UiAnalogSignal::paintMask(QPainter* painter, UiAnalogSignalPrivate* signal,
+                               int rate)
+{
+    AnalogMaskTest &maskTest = AnalogMaskTest::instance();
+    int id = signal->mSignal->id();
+
+    if (!maskTest.hasMask(id)) return;
+
+    AnalogMaskTest::Mask mask = maskTest.mask(id);
+    int bins = mask.upper.size();
+    double pxPerV = mNumPxPerDiv/signal->mSignal->vPerDiv();
+
+    painter->save();
+
+    QColor color = Qt::red;
+    color.setAlpha(128);
+    painter->setPen(color);
+
+    // each bin is drawn as a horizontal line for each limit
+    for (int b = 0; b < bins; b++) {
+        double from = mTimeAxis->timeToPixelRelativeRef(
+                    SampleTime::time((mask.samples*b)/bins, rate));
+        double to = mTimeAxis->timeToPixelRelativeRef(
+                    SampleTime::time((mask.samples*(b+1))/bins, rate));
+
+        // no need to draw when the bin is out of plot area
+        if (to < plotX()) continue;
+        if (from > width()) break;
+
+        int upper = -pxPerV*mask.upper.at(b);
+        int lower = -pxPerV*mask.lower.at(b);
+        painter->drawLine(from, upper, to, upper);
+        painter->drawLine(from, lower, to, lower);
+
+        if (b+1 < bins) {
+            painter->drawLine(to, upper, to, -pxPerV*mask.upper.at(b+1));
+            painter->drawLine(to, lower, to, -pxPerV*mask.lower.at(b+1));
+        }
+    }
+
+    painter->setPen(Qt::red);
+    foreach(const AnalogMaskTest::Violation &v, maskTest.lastResult().violations) {
+        if (v.signalId != id) continue;
+
+        double x = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(v.sampleIdx, rate));
+        if (x < plotX() || x > width()) continue;
+
+        int y = -pxPerV*v.value;
+        painter->drawLine(x, y-3, x, y+3);
+        painter->drawLine(x-3, y, x+3, y);
+    }
+
+    painter->restore();
+}
+
+/*!
+    Paint the pass/fail statistics of the mask test in the upper right
+    corner of the plot.
+*/
+void UiAnalogSignal::paintMaskStatistics(QPainter* painter)
+{
+    AnalogMaskTest &maskTest = AnalogMaskTest::instance();
+    if (!maskTest.isEnabled() || maskTest.frames() == 0) return;
+
+    QString txt = tr("Mask test: %1 frames, %2 failed")
+            .arg(maskTest.frames())
+            .arg(maskTest.failedFrames());
+
+    painter->save();
+
+    painter->setPen(maskTest.lastResult().passed ? Qt::darkGreen : Qt::red);
+    QRect r(plotX(), 0, width()-plotX()-5, height());
+    painter->drawText(r, Qt::AlignRight | Qt::AlignTop, txt);
+
+    painter->restore();
+}
+
 /*!
     Paint the trigger level.
 */
@@ -107,6 +107,8 @@ private:
     void paintSignalValue(QPainter* painter, double time);
     void paintSignals(QPainter* painter);
     void paintTriggerLevel(QPainter* painter);
+    void paintMask(QPainter* painter, UiAnalogSignalPrivate* signal, int rate);
+    void paintMaskStatistics(QPainter* painter);
 
     void infoWidthChanged();
     void doLayout();
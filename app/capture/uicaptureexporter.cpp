@@ -19,6 +19,13 @@
 #include <QPushButton>
 #include <QFileDialog>
 #include <QProgressDialog>
+#include <QThread>
+#include <QEventLoop>
+#include <QMessageBox>
+#include <QLabel>
+
+#include "signalmanager.h"
+#include "analyzer/i2c/uii2canalyzer.h"
 
 #define FORMAT_WIDGET_INDEX (1)
 
@@ -34,9 +41,13 @@
 */
 
 /*!
-    Constructs the UiCaptureExporter with the given \a parent.
+    Constructs the UiCaptureExporter with the given \a parent. The decoded
+    items of the analyzers among the signals in \a signalManager can also
+    be exported.
 */
-UiCaptureExporter::UiCaptureExporter(CaptureDevice* device, QWidget *parent) :
+UiCaptureExporter::UiCaptureExporter(CaptureDevice* device,
+                                     SignalManager* signalManager,
+                                     QWidget *parent) :
     QDialog(parent)
 {
     setWindowTitle(tr("Export Data"));
@@ -45,6 +56,13 @@ UiCaptureExporter::UiCaptureExporter(CaptureDevice* device, QWidget *parent) :
     mFormatWidget = NULL;
     mCaptureDevice = device;
 
+    foreach(UiAbstractSignal* s, signalManager->signalList()) {
+        UiAnalyzer* analyzer = qobject_cast<UiAnalyzer*>(s);
+        if (analyzer != NULL) {
+            mAnalyzers.append(analyzer);
+        }
+    }
+
     // Deallocation: Ownership changed when calling setLayout.
     mMainLayout = new QVBoxLayout();
 
@@ -94,6 +112,8 @@ UiCaptureExporter::UiCaptureExporter(CaptureDevice* device, QWidget *parent) :
 
 
 #define FORMAT_CSV "CSV"
+#define FORMAT_DECODED_CSV "Decoded items (CSV)"
+#define FORMAT_DECODED_BINARY "Decoded items (binary)"
 
 /*!
     Returns the supported export formats.
@@ -101,7 +121,9 @@ UiCaptureExporter::UiCaptureExporter(CaptureDevice* device, QWidget *parent) :
 QStringList UiCaptureExporter::exportFormats()
 {
     return QList<QString>()
-            << FORMAT_CSV;
+            << FORMAT_CSV
+            << FORMAT_DECODED_CSV
+            << FORMAT_DECODED_BINARY;
 }
 
 /*!
@@ -113,6 +135,9 @@ QWidget* UiCaptureExporter::createFormat(QString format)
     if (FORMAT_CSV == format) {
         return createFormatCsv();
     }
+    else if (FORMAT_DECODED_CSV == format || FORMAT_DECODED_BINARY == format) {
+        return createFormatDecoded();
+    }
 
 
     return NULL;
@@ -127,6 +152,12 @@ void UiCaptureExporter::exportData(QString format, QWidget* w)
     if (FORMAT_CSV == format) {
         exportToCsv(w);
     }
+    else if (FORMAT_DECODED_CSV == format) {
+        exportDecoded(w, DecodedItemExporter::FormatCsv);
+    }
+    else if (FORMAT_DECODED_BINARY == format) {
+        exportDecoded(w, DecodedItemExporter::FormatBinary);
+    }
 }
 
 /*!
@@ -276,7 +307,9 @@ void UiCaptureExporter::exportToCsv(QWidget* w)
 
             QString sample = QString("%1").arg(i);
             if (sampleAsTime) {
-                sample = QString::number((double)i/sampleRate);
+                // enough digits to tell samples apart far into a long
+                // capture, the default of 6 isn't
+                sample = QString::number(SampleTime::time(i, sampleRate), 'g', 15);
             }
 
             QString sampleRow;
@@ -318,6 +351,119 @@ void UiCaptureExporter::exportToCsv(QWidget* w)
 
 }
 
+/*!
+    Create a widget for selecting the analyzer whose decoded items are
+    exported.
+*/
+QWidget* UiCaptureExporter::createFormatDecoded()
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QFrame* w = new QFrame(this);
+    w->setFrameShape(QFrame::StyledPanel);
+
+    // Deallocation: Ownership changed when calling setLayout
+    QFormLayout* l = new QFormLayout();
+
+    if (mAnalyzers.isEmpty()) {
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        l->addRow(new QLabel(tr("There are no analyzers to export."), w));
+    }
+    else {
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        QComboBox* analyzerBox = new QComboBox(w);
+        analyzerBox->setObjectName("decodedAnalyzer");
+        for (int i = 0; i < mAnalyzers.size(); i++) {
+            analyzerBox->addItem(mAnalyzers.at(i)->getName(), i);
+        }
+        l->addRow(tr("Analyzer:"), analyzerBox);
+    }
+
+    w->setLayout(l);
+
+
+    return w;
+}
+
+/*!
+    Export the items decoded by the analyzer selected in \a w in the given
+    \a format. The file is written in a separate thread while a progress
+    dialog is shown.
+*/
+void UiCaptureExporter::exportDecoded(QWidget *w, DecodedItemExporter::Format format)
+{
+    QComboBox* box = w->findChild<QComboBox*>("decodedAnalyzer");
+    if (box == NULL) return;
+
+    UiAnalyzer* analyzer = mAnalyzers.at(box->itemData(box->currentIndex()).toInt());
+
+    QString filePath;
+    if (format == DecodedItemExporter::FormatCsv) {
+        filePath = QFileDialog::getSaveFileName(
+                    this,
+                    tr("Save File"),
+                    QDir::currentPath()+"/decoded.csv",
+                    "Comma Separated values (*.csv)");
+    }
+    else {
+        filePath = QFileDialog::getSaveFileName(
+                    this,
+                    tr("Save File"),
+                    QDir::currentPath()+"/decoded.bin",
+                    "Binary records (*.bin)");
+    }
+
+    if (filePath.isNull() || filePath.isEmpty()) return;
+
+    // Deallocation: Deleted below when the export is done
+    DecodedItemExporter* exporter = new DecodedItemExporter(
+                filePath, format, mCaptureDevice->usedSampleRate());
+
+    UiUartAnalyzer* uart = qobject_cast<UiUartAnalyzer*>(analyzer);
+    UiSpiAnalyzer* spi = qobject_cast<UiSpiAnalyzer*>(analyzer);
+    UiI2CAnalyzer* i2c = qobject_cast<UiI2CAnalyzer*>(analyzer);
+    if (uart != NULL) {
+        exporter->setItems(uart->uartItems());
+    }
+    else if (spi != NULL) {
+        exporter->setItems(spi->spiItems());
+    }
+    else if (i2c != NULL) {
+        exporter->setItems(i2c->i2cItems());
+    }
+
+    QProgressDialog progress(tr("Exporting decoded items"), tr("Abort"),
+                             0, 100, this);
+    progress.setWindowModality(Qt::WindowModal);
+    progress.setAutoClose(false);
+    progress.setAutoReset(false);
+
+    QThread thread;
+    QEventLoop loop;
+    exporter->moveToThread(&thread);
+
+    connect(&thread, SIGNAL(started()), exporter, SLOT(run()));
+    connect(exporter, SIGNAL(progress(int)), &progress, SLOT(setValue(int)));
+    connect(exporter, SIGNAL(finished(bool)), &thread, SLOT(quit()));
+    connect(&thread, SIGNAL(finished()), &loop, SLOT(quit()));
+    // called directly since the exporter's thread is busy running the export
+    connect(&progress, SIGNAL(canceled()), exporter, SLOT(cancel()),
+            Qt::DirectConnection);
+
+    thread.start();
+    loop.exec();
+    thread.wait();
+
+    bool ok = exporter->succeeded();
+    bool cancelled = progress.wasCanceled();
+    delete exporter;
+
+    if (!ok && !cancelled) {
+        QMessageBox::warning(this,
+                             tr("Export failed"),
+                             tr("Failed to write %1").arg(filePath));
+    }
+}
+
 /*
     ---------------------------------------------------------------------------
     <<<< END -- Handle export formats <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -21,12 +21,17 @@
 #include <QComboBox>
 
 #include "device/capturedevice.h"
+#include "analyzer/uianalyzer.h"
+#include "analyzer/decodeditemexporter.h"
+
+class SignalManager;
 
 class UiCaptureExporter : public QDialog
 {
     Q_OBJECT
 public:
-    explicit UiCaptureExporter(CaptureDevice* device, QWidget *parent = 0);
+    explicit UiCaptureExporter(CaptureDevice* device, SignalManager* signalManager,
+                               QWidget *parent = 0);
     
 signals:
     
@@ -35,6 +40,7 @@ public slots:
 private:
 
     CaptureDevice* mCaptureDevice;
+    QList<UiAnalyzer*> mAnalyzers;
     QVBoxLayout* mMainLayout;
     QComboBox* mExportFormatBox;
     QWidget* mFormatWidget;
@@ -48,6 +54,9 @@ private:
     QWidget* createFormatCsv();
     void exportToCsv(QWidget* w);
 
+    QWidget* createFormatDecoded();
+    void exportDecoded(QWidget* w, DecodedItemExporter::Format format);
+
 private slots:
     void handleFormatChanged(QString format);
     void exportData();
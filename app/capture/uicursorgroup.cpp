@@ -83,8 +83,8 @@ void UiCursorGroup::setCursorData(UiCursor::CursorId cursor, bool enabled,
         // display time relative to trigger
         CaptureDevice* device = DeviceManager::instance().activeDevice()
                 ->captureDevice();
-        double triggerTime = (double)device->digitalTriggerIndex()
-                /device->usedSampleRate();
+        double triggerTime = SampleTime::time(device->digitalTriggerIndex(),
+                                              device->usedSampleRate());
 
 
         lbl->setText(StringUtil::timeInSecToString(time-triggerTime));
@@ -146,15 +146,13 @@ void UiDigitalSignal::paintEvent(QPaintEvent *event)
     // -----------------
     // draw signal
     // -----------------
-    QList<int> trans;
-
-    device->digitalTransitions(mSignal->id(), trans);
+    const DigitalTransitions* trans = device->digitalTransitions(mSignal->id());
 
     QPen pen = painter.pen();
     pen.setColor(Configuration::instance().digitalSignalColor(mSignal->id()));
     painter.setPen(pen);
 
-    paintSignal(&painter, &trans, device->usedSampleRate());
+    paintSignal(&painter, trans, device->usedSampleRate());
 
     if (mMouseOverValid) {
         paintArrows(&painter);
@@ -175,25 +173,23 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
     QVector<int>* data = device->digitalData(mSignal->id());
-    QList<int> trans;
-
-    device->digitalTransitions(mSignal->id(), trans);
+    const DigitalTransitions* trans = device->digitalTransitions(mSignal->id());
 
-    if (data != NULL && event->pos().x() >= plotX()) {
+    if (data != NULL && trans != NULL && event->pos().x() >= plotX()) {
         double xTime = mTimeAxis->pixelToTimeRelativeRef(
                     event->pos().x());
 
         // find first sample
-        int idx = (int)(xTime*device->usedSampleRate());
+        SampleIndex idx = SampleTime::floorIndex(xTime, device->usedSampleRate());
 
         do {
 
             // assuming that t=0 is start for all samples
             if (idx < 0) break;
             // outside of sample data
-            if (idx >= trans.at(trans.size()-1)) break;
+            if (idx >= trans->lastSampleIndex()) break;
 
-            int level = trans.at(0);
+            int level = trans->initialLevel();
 
             /*
                 Need to find one transition to the left of where the mouse
@@ -208,36 +204,27 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
                   ^   ^      ^
                   |   |      |
                 1:st  2:nd   3:rd
-            */
 
-            // find first transition left of index
-            int leftTransitionIdx = -1;
-            for (int i = 1; i < trans.size(); i++) {
-                if (trans.at(i) > idx && i > 1) {
-                    leftTransitionIdx = trans.at(i-1);
-                    idx = i-1;
-                    break;
-                }
-            }
-            // didn't find a transition left of point
-            if (leftTransitionIdx == -1) break;
+                The last sample index counts as a transition to the right.
+            */
 
+            // find first transition right of index, must have one to the left
+            int right = qMax(trans->lowerBound(idx+1), 1);
+            // no transition left of point or no second transition right of it
+            if (right + 1 > trans->size()) break;
 
-            idx++;
-            // no transition
-            if (idx > trans.size()-1) break;
+            DigitalTransitions::const_iterator it = trans->iteratorAt(right-1);
+            SampleIndex leftTransitionIdx = *it;
 
-            int right1TransitionIdx = trans.at(idx);
+            ++it;
+            SampleIndex right1TransitionIdx = (right < trans->size()) ? *it : trans->lastSampleIndex();
             // record logic level at first transition right of point
-            if ((idx % 2) != 0) {
+            if ((right % 2) == 0) {
                 level = ((level + 1) % 2);
             }
 
-            idx++;
-            // no transition
-            if (idx > trans.size()-1) break;
-
-            int right2TransitionIdx = trans.at(idx);
+            ++it;
+            SampleIndex right2TransitionIdx = (right + 1 < trans->size()) ? *it : trans->lastSampleIndex();
 
 
             bool highLow = true;
@@ -246,9 +233,9 @@ void UiDigitalSignal::mouseMoveEvent(QMouseEvent *event)
             }
 
             int rate = device->usedSampleRate();
-            double t1 = (double)(leftTransitionIdx)/rate;
-            double t2 = (double)(right1TransitionIdx)/rate;
-            double t3 = (double)(right2TransitionIdx)/rate;
+            double t1 = SampleTime::time(leftTransitionIdx, rate);
+            double t2 = SampleTime::time(right1TransitionIdx, rate);
+            double t3 = SampleTime::time(right2TransitionIdx, rate);
 
             // check if this is a new measurement
             if (t1 != mTransitionTimes[0] ||
@@ -305,18 +292,24 @@ void UiDigitalSignal::showEvent(QShowEvent* event)
 /*!
     Paint the signal data.
 */
-void UiDigitalSignal::paintSignal(QPainter* painter, QList<int> *data,
+void UiDigitalSignal::paintSignal(QPainter* painter, const DigitalTransitions *data,
                                   int sampleRate)
 {
+    if (data == NULL) return;
 
     int yFactor = height()/2;
 
-    int fromIdx = (int)(mTimeAxis->rangeLower()*sampleRate);
+    SampleIndex fromIdx = SampleTime::floorIndex(mTimeAxis->rangeLower(), sampleRate);
 
     if (fromIdx < 0) fromIdx = 0;
 
-    int toIdx = 0;
-    int level = data->at(0);
+    // first transition right of the plot's left edge, the data ends there
+    // if there is none
+    int start = data->lowerBound(fromIdx+1);
+    if (start == data->size() && data->lastSampleIndex() <= fromIdx) return;
+
+    SampleIndex toIdx = 0;
+    int level = data->initialLevel();
 
     double from = 0;
     double to = 0;
@@ -328,21 +321,20 @@ void UiDigitalSignal::paintSignal(QPainter* painter, QList<int> *data,
     // vertical: position signal at center
     painter->translate(0, height()-(height()-yFactor)/2);
 
-    int start = 1;
-    for (start = 1; start < data->size(); start++) {
-        if (data->at(start) > fromIdx) break;
-    }
-
-    if ((start % 2) == 0) {
+    if ((start % 2) != 0) {
         level = ((level + 1) % 2);
     }
 
-    for (int i = start; i < data->size(); i++) {
+    DigitalTransitions::const_iterator it = data->iteratorAt(start);
+    for (int i = start; i <= data->size(); i++, ++it) {
 
-        toIdx = data->at(i);
+        // after the last transition comes the last index of the signal
+        // data independent of any transition
+        bool transition = (i < data->size());
+        toIdx = transition ? *it : data->lastSampleIndex();
 
-        from = mTimeAxis->timeToPixelRelativeRef((double)fromIdx/sampleRate);
-        to = mTimeAxis->timeToPixelRelativeRef((double)toIdx/sampleRate);
+        from = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(fromIdx, sampleRate));
+        to = mTimeAxis->timeToPixelRelativeRef(SampleTime::time(toIdx, sampleRate));
 
         // no need to draw when signal is out of plot area
         if (from > width()) {
@@ -362,10 +354,7 @@ void UiDigitalSignal::paintSignal(QPainter* painter, QList<int> *data,
                           to, -level*yFactor);
 
 
-        // the last index of the transition list contains the
-        // last index of the signal data independent of any
-        // transition
-        if (i < data->size()-1) {
+        if (transition) {
             // transition: draw vertical line
             painter->drawLine(to, -level*yFactor,
                               to, -((level + 1)%2)*yFactor);
@@ -25,6 +25,7 @@
 #include "uidigitaltrigger.h"
 
 #include "device/digitalsignal.h"
+#include "device/digitaltransitions.h"
 
 class UiDigitalSignal : public UiSimpleAbstractSignal
 {
@@ -65,7 +66,7 @@ private:
         SignalIdMarginRight = 10
     };
 
-    void paintSignal(QPainter* painter, QList<int>* data, int sampleRate);
+    void paintSignal(QPainter* painter, const DigitalTransitions* data, int sampleRate);
     void paintArrows(QPainter* painter);
 
     void infoWidthChanged();
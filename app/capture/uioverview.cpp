@@ -0,0 +1,360 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uioverview.h"
+
+#include <QDebug>
+#include <QPainter>
+#include <qmath.h>
+
+#include "common/configuration.h"
+#include "device/devicemanager.h"
+
+/*!
+    \class UiOverview
+    \brief UI widget showing the whole capture in a thin strip below the plot.
+
+    \ingroup Capture
+
+    Each digital signal gets a row where the density of transitions is shown
+    and the analog signals are shown as min/max envelopes below them. The
+    part of the capture that is visible in the plot is marked and the user
+    can click or drag in the strip to move the plot.
+
+    The strip is painted into an image once, from the transition storage
+    and the analog samples, and the image is then only copied to the screen.
+    The image must be invalidated with invalidate() when the signal data
+    or the set of signals change; a resize invalidates it automatically.
+*/
+
+/*!
+    Constructs an UiOverview with the given time axis \a axis
+    and \a parent.
+*/
+UiOverview::UiOverview(UiTimeAxis *axis, QWidget *parent) :
+    UiAbstractPlotItem(parent)
+{
+    mTimeAxis = axis;
+    mImageValid = false;
+    mEndTime = 0;
+    mNavigating = false;
+
+    setFixedHeight(OverviewHeight);
+}
+
+/*!
+    Marks the cached image as out of date. It is recreated the next time
+    the overview is painted.
+*/
+void UiOverview::invalidate()
+{
+    mImageValid = false;
+    update();
+}
+
+/*!
+    \fn void UiOverview::navigate(double time)
+
+    This signal is emitted when the user has clicked or dragged in the
+    overview. The plot should be moved so that \a time is in the center.
+*/
+
+/*!
+    Paint event handler responsible for painting this widget.
+*/
+void UiOverview::paintEvent(QPaintEvent *event)
+{
+    (void)event;
+
+    if (!mImageValid) {
+        updateImage();
+    }
+
+    QPainter painter(this);
+
+    painter.fillRect(rect(), Configuration::instance().outsidePlotColor());
+    painter.drawImage(infoWidth(), 0, mImage);
+
+    if (mEndTime <= 0) return;
+
+    // mark the part that is visible in the plot
+    int from = qFloor(timeToX(mTimeAxis->rangeLower()));
+    int to = qCeil(timeToX(mTimeAxis->rangeUpper()));
+    from = qMax(from, infoWidth());
+    to = qMin(to, width()-1);
+    if (to < from) return;
+
+    QColor c = Configuration::instance().textColor();
+    painter.setPen(c);
+    c.setAlpha(40);
+    painter.setBrush(c);
+    painter.drawRect(from, 0, qMax(to-from, 1), height()-1);
+}
+
+/*!
+    The resize event handler. The image must be recreated for the new size.
+*/
+void UiOverview::resizeEvent(QResizeEvent *event)
+{
+    (void)event;
+    mImageValid = false;
+}
+
+/*!
+    The mouse press event handler. Navigates to the clicked position.
+*/
+void UiOverview::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton || event->pos().x() < infoWidth()
+            || mEndTime <= 0) {
+        return;
+    }
+
+    mNavigating = true;
+    emit navigate(xToTime(event->pos().x()));
+}
+
+/*!
+    The mouse release event handler. Ends a navigation by dragging.
+*/
+void UiOverview::mouseReleaseEvent(QMouseEvent *event)
+{
+    (void)event;
+    mNavigating = false;
+}
+
+/*!
+    The mouse move event handler. Follows the mouse while dragging.
+*/
+void UiOverview::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!mNavigating) return;
+
+    int x = qBound(infoWidth(), event->pos().x(), width()-1);
+    emit navigate(xToTime(x));
+}
+
+/*!
+    Called when the info width has been changed.
+*/
+void UiOverview::infoWidthChanged()
+{
+    mImageValid = false;
+}
+
+/*!
+    Paints the whole capture into the cached image.
+*/
+void UiOverview::updateImage()
+{
+    mImageValid = true;
+    mEndTime = 0;
+
+    int w = width() - infoWidth();
+    if (w <= 0 || height() <= 0) {
+        mImage = QImage();
+        return;
+    }
+
+    mImage = QImage(w, height(), QImage::Format_ARGB32_Premultiplied);
+    mImage.fill(Configuration::instance().plotBackgroundColor());
+
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    SampleIndex numSamples = device->lastSampleIndex() + 1;
+    if (device->usedSampleRate() <= 0 || numSamples <= 1) return;
+
+    mEndTime = SampleTime::time(device->lastSampleIndex(),
+                                device->usedSampleRate());
+
+    QList<int> digitalIds;
+    foreach(DigitalSignal* s, device->digitalSignals()) {
+        if (device->digitalTransitions(s->id()) != NULL) {
+            digitalIds.append(s->id());
+        }
+    }
+
+    QList<int> analogIds;
+    foreach(AnalogSignal* s, device->analogSignals()) {
+        QVector<double>* data = device->analogData(s->id());
+        if (data != NULL && data->size() > 0) {
+            analogIds.append(s->id());
+        }
+    }
+
+    if (digitalIds.isEmpty() && analogIds.isEmpty()) return;
+
+    // the analog envelopes share the lower half when there are also
+    // digital signals
+    int analogHeight = 0;
+    if (!analogIds.isEmpty()) {
+        analogHeight = digitalIds.isEmpty() ? height() : height()/2;
+    }
+
+    QPainter painter(&mImage);
+
+    if (!digitalIds.isEmpty()) {
+        int area = height() - analogHeight;
+        int rowHeight = qMax(area / digitalIds.size(), (int)MinRowHeight);
+
+        for (int i = 0; i < digitalIds.size(); i++) {
+            int y = i*rowHeight;
+            if (y + rowHeight > area) break;
+
+            paintDigital(&painter, digitalIds.at(i), y, rowHeight, numSamples);
+        }
+    }
+
+    foreach(int id, analogIds) {
+        paintAnalog(&painter, id, height()-analogHeight, analogHeight,
+                    numSamples);
+    }
+}
+
+/*!
+    Paints the transition density of the digital signal with ID \a signalId
+    into a row at \a y with the height \a h. A column without transitions
+    shows the signal's level and a column with transitions is filled with a
+    strength that grows with the number of transitions.
+*/
+void UiOverview::paintDigital(QPainter *painter, int signalId, int y, int h,
+                              SampleIndex numSamples)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    const DigitalTransitions* trans = device->digitalTransitions(signalId);
+    QColor color = Configuration::instance().digitalSignalColor(signalId);
+
+    int w = mImage.width();
+    QVector<int> counts(w);
+    int maxCount = 0;
+
+    // the transitions in a column are found with two binary searches so
+    // this doesn't depend on the number of samples
+    int prev = trans->lowerBound(0);
+    for (int x = 0; x < w; x++) {
+        int next = trans->lowerBound(columnStart(x+1, numSamples));
+        counts[x] = next - prev;
+        maxCount = qMax(maxCount, counts[x]);
+        prev = next;
+    }
+
+    double logMax = qLn(1.0 + maxCount);
+
+    for (int x = 0; x < w; x++) {
+        if (counts.at(x) == 0) {
+            int level = trans->levelAt(columnStart(x, numSamples));
+            int ly = (level == 1) ? y : y+h-1;
+            painter->fillRect(x, ly, 1, 1, color);
+            continue;
+        }
+
+        // logarithmic so that single transitions are visible next to bursts
+        QColor c = color;
+        c.setAlpha(64 + (int)(191*qLn(1.0 + counts.at(x))/logMax));
+        painter->fillRect(x, y, 1, h, c);
+    }
+}
+
+/*!
+    Paints the min/max envelope of the analog signal with ID \a signalId
+    into the area at \a y with the height \a h. The envelope is scaled to
+    the signal's own range.
+*/
+void UiOverview::paintAnalog(QPainter *painter, int signalId, int y, int h,
+                             SampleIndex numSamples)
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    QVector<double>* data = device->analogData(signalId);
+
+    int w = mImage.width();
+    QVector<double> minValues(w);
+    QVector<double> maxValues(w);
+    double lowest = 0;
+    double highest = 0;
+    bool found = false;
+
+    for (int x = 0; x < w; x++) {
+        SampleIndex from = columnStart(x, numSamples);
+        SampleIndex to = qMax(columnStart(x+1, numSamples), from+1);
+        to = qMin(to, (SampleIndex)data->size());
+
+        if (from >= to) {
+            // continue the previous column when there are fewer samples
+            // than columns
+            minValues[x] = (x > 0) ? minValues.at(x-1) : 0;
+            maxValues[x] = (x > 0) ? maxValues.at(x-1) : 0;
+            continue;
+        }
+
+        const double* d = data->constData();
+        double lo = d[from];
+        double hi = d[from];
+        for (int i = (int)from+1; i < (int)to; i++) {
+            if (d[i] < lo) lo = d[i];
+            if (d[i] > hi) hi = d[i];
+        }
+        minValues[x] = lo;
+        maxValues[x] = hi;
+
+        if (!found || lo < lowest) lowest = lo;
+        if (!found || hi > highest) highest = hi;
+        found = true;
+    }
+
+    if (!found) return;
+
+    double range = highest - lowest;
+    if (range <= 0) range = 1;
+
+    QColor color = Configuration::instance().analogSignalColor(signalId);
+    for (int x = 0; x < w; x++) {
+        int top = y + (int)((highest - maxValues.at(x))/range*(h-1));
+        int bottom = y + (int)((highest - minValues.at(x))/range*(h-1));
+        painter->fillRect(x, top, 1, bottom-top+1, color);
+    }
+}
+
+/*!
+    Returns the index of the first sample shown in image column \a column
+    when \a numSamples samples are spread over the image.
+*/
+SampleIndex UiOverview::columnStart(int column, SampleIndex numSamples)
+{
+    return numSamples*column/mImage.width();
+}
+
+/*!
+    Returns the capture time at x-coordinate \a x.
+*/
+double UiOverview::xToTime(int x)
+{
+    int w = width() - infoWidth();
+    if (w <= 0) return 0;
+
+    return mEndTime*(x - infoWidth())/w;
+}
+
+/*!
+    Returns the x-coordinate for the capture time \a time.
+*/
+double UiOverview::timeToX(double time)
+{
+    int w = width() - infoWidth();
+    if (mEndTime <= 0) return infoWidth();
+
+    return infoWidth() + time*w/mEndTime;
+}
@@ -0,0 +1,76 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UIOVERVIEW_H
+#define UIOVERVIEW_H
+
+#include <QWidget>
+#include <QImage>
+#include <QMouseEvent>
+
+#include "uiabstractplotitem.h"
+#include "uitimeaxis.h"
+#include "common/sampleindex.h"
+
+class UiOverview : public UiAbstractPlotItem
+{
+    Q_OBJECT
+public:
+    explicit UiOverview(UiTimeAxis* axis, QWidget *parent = 0);
+
+    void invalidate();
+
+    enum Constants {
+        // height of the overview strip
+        OverviewHeight = 40,
+        // minimum height of a digital signal's row
+        MinRowHeight = 2
+    };
+
+signals:
+    void navigate(double time);
+
+public slots:
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent* event);
+    void mousePressEvent(QMouseEvent* event);
+    void mouseReleaseEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+
+    void infoWidthChanged();
+
+private:
+    UiTimeAxis* mTimeAxis;
+
+    QImage mImage;
+    bool mImageValid;
+    double mEndTime;
+
+    bool mNavigating;
+
+    void updateImage();
+    void paintDigital(QPainter* painter, int signalId, int y, int h,
+                      SampleIndex numSamples);
+    void paintAnalog(QPainter* painter, int signalId, int y, int h,
+                     SampleIndex numSamples);
+    SampleIndex columnStart(int column, SampleIndex numSamples);
+    double xToTime(int x);
+    double timeToX(double time);
+
+};
+
+#endif // UIOVERVIEW_H
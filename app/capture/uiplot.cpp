@@ -56,6 +56,14 @@ UiPlot::UiPlot(SignalManager *signalManager, QWidget *parent) :
     mCursor = CursorManager::instance().createUiCursor(mSignalManager,
                                                        mTimeAxis, viewport());
 
+    // the overview is below the viewport so that it is always visible
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mOverview = new UiOverview(mTimeAxis, this);
+    setViewportMargins(0, 0, 0, UiOverview::OverviewHeight);
+
+    connect(mOverview, SIGNAL(navigate(double)),
+            this, SLOT(centerOn(double)));
+
     connect(mCursor, SIGNAL(cursorChanged(UiCursor::CursorId,bool,double)),
             this, SIGNAL(cursorChanged(UiCursor::CursorId,bool,double)));
 
@@ -135,14 +143,14 @@ void UiPlot::handleSignalDataChanged()
 
     CaptureDevice* device = DeviceManager::instance().activeDevice()
             ->captureDevice();
-    int idx = device->digitalTriggerIndex();
+    SampleIndex idx = device->digitalTriggerIndex();
 
     // We need the trigger position (pixel position) to remain the
     // same between captures. If not, the user experience will be bad since
     // the trigger will move along the x-axis...
     double currRef = mTimeAxis->reference();
     double currTrig = mCursor->cursorPosition(UiCursor::Trigger);
-    double newTrig = (double)idx/device->usedSampleRate();
+    double newTrig = SampleTime::time(idx, device->usedSampleRate());
     double newRef = currRef-currTrig+newTrig;
 
     // cursor times should be relative to the trigger
@@ -158,6 +166,8 @@ void UiPlot::handleSignalDataChanged()
     mTimeAxis->setReference(newRef);
     mCursor->setTrigger(newTrig);
 
+    mOverview->invalidate();
+
     viewport()->update();
 }
 
@@ -214,6 +224,10 @@ void UiPlot::resizeEvent(QResizeEvent* event)
         s->resize(viewport()->width(), s->height());
     }
 
+    QRect r = viewport()->geometry();
+    mOverview->setGeometry(r.x(), r.y()+r.height(), r.width(),
+                           UiOverview::OverviewHeight);
+
     updateHorizontalScrollBar();
 
     if (event->oldSize().height() != event->size().height()) {
@@ -383,6 +397,7 @@ void UiPlot::scrollContentsBy(int dx, int dy)
                 * UiTimeAxis::ReferenceMajorStep);
 
         mTimeAxis->setReference(t);
+        mOverview->update();
     }
 
     if (dy != 0) {
@@ -491,6 +506,7 @@ void UiPlot::updateLayout()
     mTimeAxis->setInfoWidth(w);
     mGrid->setInfoWidth(w);
     mCursor->setInfoWidth(w);
+    mOverview->setInfoWidth(w);
 
     foreach(UiAbstractSignal* signal, mSignalManager->signalList()) {
         signal->setInfoWidth(w);
@@ -500,6 +516,20 @@ void UiPlot::updateLayout()
     viewport()->update();
 }
 
+/*!
+    Moves the plot so that \a time is in the center of the plot area.
+*/
+void UiPlot::centerOn(double time)
+{
+    double center = mTimeAxis->pixelToTimeRelativeRef(
+                mTimeAxis->infoWidth() + mTimeAxis->plotWidth()/2);
+
+    mTimeAxis->moveAxis(qRound(mTimeAxis->timeToPixel(time - center)));
+    updateHorizontalScrollBar();
+
+    viewport()->update();
+}
+
 /*!
     Update the horizontal scrollbar
 */
@@ -528,6 +558,8 @@ void UiPlot::updateHorizontalScrollBar()
     horizontalScrollBar()->setRange(minX, maxX - plotWidth);
     horizontalScrollBar()->setPageStep(plotWidth);
     horizontalScrollBar()->setValue(curr);
+
+    mOverview->update();
 }
 
 /*!
@@ -576,7 +608,7 @@ QPoint UiPlot::mapToCursor(const QPoint &pos) const
 double UiPlot::getEndTime()
 {
     CaptureDevice* device = DeviceManager::instance().activeDevice()->captureDevice();
-    return (double)device->lastSampleIndex() / device->usedSampleRate();
+    return SampleTime::time(device->lastSampleIndex(), device->usedSampleRate());
 }
 
 /*!
@@ -607,6 +639,7 @@ void UiPlot::handleSignalsAdded()
         }
     }
 
+    mOverview->invalidate();
     updateVerticalScrollBar();
     updateLayout();
 }
@@ -616,6 +649,7 @@ void UiPlot::handleSignalsAdded()
 */
 void UiPlot::handleSignalsRemoved()
 {
+    mOverview->invalidate();
     updateVerticalScrollBar();
     updateLayout();
 }
@@ -25,6 +25,7 @@
 #include "uigrid.h"
 #include "uicursor.h"
 #include "uitimeaxis.h"
+#include "uioverview.h"
 #include "uiabstractsignal.h"
 
 
@@ -64,6 +65,7 @@ private:
     UiTimeAxis* mTimeAxis;
     UiGrid* mGrid;
     UiCursor* mCursor;
+    UiOverview* mOverview;
 
     QPushButton* mAddSignalBtn;
 
@@ -86,6 +88,7 @@ private:
 
 private slots:
     void updateLayout();
+    void centerOn(double time);
     void handleSignalsAdded();
     void handleSignalsRemoved();
 
@@ -0,0 +1,262 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uistopconditiondialog.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+
+#include "common/inputhelper.h"
+#include "analyzer/decoder/decodermanager.h"
+
+/*!
+    \class UiStopConditionDialog
+    \brief Dialog window used to configure the stop condition for
+    continuous capture.
+
+    \ingroup Capture
+
+    The dialog selects a decoder, the signals for its channels, its
+    settings and the item type and value to stop at. The changes are
+    applied to the DecodeStopCondition when the dialog is accepted.
+*/
+
+
+/*!
+    Constructs the UiStopConditionDialog for \a condition with the given
+    \a parent.
+*/
+UiStopConditionDialog::UiStopConditionDialog(DecodeStopCondition *condition,
+                                             QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle(tr("Stop Condition"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    mCondition = condition;
+    mDecoder = NULL;
+    mDecoderWidget = NULL;
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* formLayout = new QFormLayout;
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mEnabledCheckBox = new QCheckBox(this);
+    mEnabledCheckBox->setChecked(condition->isEnabled());
+    mEnabledCheckBox->setToolTip(
+                tr("Stop continuous capture when the condition matches"));
+    formLayout->addRow(tr("Enabled: "), mEnabledCheckBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mDecoderBox = new QComboBox(this);
+    mDecoderBox->addItems(DecoderManager::instance().decoders());
+    formLayout->addRow(tr("Decoder: "), mDecoderBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mItemBox = new QComboBox(this);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mValueEdit = new QLineEdit(this);
+    mValueEdit->setPlaceholderText(tr("Any"));
+    mValueEdit->setToolTip(tr("Decimal or hexadecimal (0x) value, "
+                              "empty for any value"));
+
+    // Deallocation: Ownership changed when calling setLayout
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+
+    // Deallocation: Re-parented when calling verticalLayout->addLayout
+    QFormLayout* itemLayout = new QFormLayout;
+    itemLayout->addRow(tr("Item: "), mItemBox);
+    itemLayout->addRow(tr("Value: "), mValueEdit);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QDialogButtonBox* bottonBox = new QDialogButtonBox(
+                QDialogButtonBox::Ok | QDialogButtonBox::Cancel,
+                Qt::Horizontal,
+                this);
+    bottonBox->setCenterButtons(true);
+
+    connect(bottonBox, SIGNAL(accepted()), this, SLOT(accept()));
+    connect(bottonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addLayout(itemLayout);
+    verticalLayout->addWidget(bottonBox);
+
+    setLayout(verticalLayout);
+
+    // select the current decoder with its settings
+    DecoderInterface* current = condition->decoder();
+    if (current != NULL) {
+        mDecoderBox->setCurrentIndex(mDecoderBox->findText(current->name()));
+    }
+    decoderChanged(mDecoderBox->currentIndex());
+
+    if (current != NULL && mDecoder != NULL
+            && current->name() == mDecoder->name()) {
+        mDecoder->setSettings(current->settings());
+        createDecoderWidget();
+
+        QVector<int> ids = condition->signalIds();
+        for (int i = 0; i < ids.size() && i < mSignalBoxes.size(); i++) {
+            InputHelper::setInt(mSignalBoxes.at(i), ids.at(i));
+        }
+
+        mItemBox->setCurrentIndex(condition->itemType());
+        if (condition->value() != -1) {
+            mValueEdit->setText(QString("0x%1").arg(condition->value(), 0, 16));
+        }
+    }
+
+    connect(mDecoderBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(decoderChanged(int)));
+}
+
+/*!
+    Deletes the decoder if it wasn't handed over to the condition.
+*/
+UiStopConditionDialog::~UiStopConditionDialog()
+{
+    delete mDecoder;
+}
+
+/*!
+    Applies the changes to the condition and closes the dialog. The dialog
+    isn't closed if the value is invalid.
+*/
+void UiStopConditionDialog::accept()
+{
+    int value = -1;
+    QString txt = mValueEdit->text().trimmed();
+    if (!txt.isEmpty()) {
+        bool ok = false;
+        value = txt.toInt(&ok, 0);
+        if (!ok || value < 0) {
+            QMessageBox::warning(this,
+                                 tr("Invalid value"),
+                                 tr("The value must be a positive number."));
+            return;
+        }
+    }
+
+    if (mDecoder != NULL) {
+        mDecoder->setSettings(settings());
+    }
+
+    QVector<int> ids;
+    foreach(QComboBox* box, mSignalBoxes) {
+        ids.append(InputHelper::intValue(box));
+    }
+
+    // Deallocation: The condition takes ownership of the decoder
+    mCondition->setDecoder(mDecoder);
+    mDecoder = NULL;
+
+    mCondition->setSignalIds(ids);
+    mCondition->setItemType(mItemBox->currentIndex());
+    mCondition->setValue(value);
+    mCondition->setEnabled(mEnabledCheckBox->isChecked());
+
+    QDialog::accept();
+}
+
+/*!
+    Called when the decoder at \a index has been selected.
+*/
+void UiStopConditionDialog::decoderChanged(int index)
+{
+    delete mDecoder;
+    mDecoder = NULL;
+
+    if (index >= 0) {
+        // Deallocation: Destructor or handed over to the condition in accept
+        mDecoder = DecoderManager::instance().createDecoder(
+                    mDecoderBox->itemText(index));
+    }
+
+    createDecoderWidget();
+
+    mItemBox->clear();
+    if (mDecoder != NULL) {
+        mItemBox->addItems(mDecoder->itemTypes());
+    }
+}
+
+/*!
+    Creates the widget with the signal selections and the settings of the
+    current decoder.
+*/
+void UiStopConditionDialog::createDecoderWidget()
+{
+    delete mDecoderWidget;
+    mDecoderWidget = NULL;
+    mSignalBoxes.clear();
+    mSettingEdits.clear();
+
+    if (mDecoder == NULL) return;
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mDecoderWidget = new QWidget(this);
+
+    // Deallocation: Ownership changed when calling setLayout
+    QFormLayout* formLayout = new QFormLayout;
+    formLayout->setContentsMargins(0, 0, 0, 0);
+
+    QStringList channels = mDecoder->channels();
+    for (int i = 0; i < channels.size(); i++) {
+        QComboBox* box = InputHelper::createSignalBox(mDecoderWidget, i);
+        mSignalBoxes.append(box);
+        formLayout->addRow(tr("%1 Signal: ").arg(channels.at(i)), box);
+    }
+
+    QVariantMap map = mDecoder->settings();
+    QVariantMap::const_iterator it;
+    for (it = map.constBegin(); it != map.constEnd(); ++it) {
+        // Deallocation: "Qt Object trees" (See UiMainWindow)
+        QLineEdit* edit = new QLineEdit(it.value().toString(), mDecoderWidget);
+        mSettingEdits.insert(it.key(), edit);
+        formLayout->addRow(QString("%1: ").arg(it.key()), edit);
+    }
+
+    mDecoderWidget->setLayout(formLayout);
+
+    // put the widget between the decoder and the item selections
+    QVBoxLayout* verticalLayout = qobject_cast<QVBoxLayout*>(layout());
+    if (verticalLayout != NULL) {
+        verticalLayout->insertWidget(1, mDecoderWidget);
+    }
+}
+
+/*!
+    Returns the settings entered for the decoder. Each value is converted
+    to the type of the decoder's current value and is left unchanged if
+    the entered text can't be converted.
+*/
+QVariantMap UiStopConditionDialog::settings()
+{
+    QVariantMap map = mDecoder->settings();
+
+    QMap<QString, QLineEdit*>::const_iterator it;
+    for (it = mSettingEdits.constBegin(); it != mSettingEdits.constEnd(); ++it) {
+        QVariant value(it.value()->text());
+        if (value.convert(map.value(it.key()).type())) {
+            map.insert(it.key(), value);
+        }
+    }
+
+    return map;
+}
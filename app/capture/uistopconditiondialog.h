@@ -0,0 +1,62 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UISTOPCONDITIONDIALOG_H
+#define UISTOPCONDITIONDIALOG_H
+
+#include <QWidget>
+#include <QDialog>
+#include <QComboBox>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QMap>
+
+#include "decodestopcondition.h"
+
+class UiStopConditionDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiStopConditionDialog(DecodeStopCondition* condition,
+                                   QWidget *parent = 0);
+    ~UiStopConditionDialog();
+
+signals:
+
+public slots:
+    void accept();
+
+private slots:
+    void decoderChanged(int index);
+
+private:
+
+    DecodeStopCondition* mCondition;
+    DecoderInterface* mDecoder;
+
+    QCheckBox* mEnabledCheckBox;
+    QComboBox* mDecoderBox;
+    QWidget* mDecoderWidget;
+    QList<QComboBox*> mSignalBoxes;
+    QMap<QString, QLineEdit*> mSettingEdits;
+    QComboBox* mItemBox;
+    QLineEdit* mValueEdit;
+
+    void createDecoderWidget();
+    QVariantMap settings();
+
+};
+
+#endif // UISTOPCONDITIONDIALOG_H
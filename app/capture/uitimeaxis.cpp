@@ -324,8 +324,8 @@ QString UiTimeAxis::getTimeLabelForStep(int majorStep)
     // get time relative to trigger
     CaptureDevice * device = DeviceManager::instance().activeDevice()
             ->captureDevice();
-    double triggerTime = (double)device->digitalTriggerIndex()
-            / device->usedSampleRate();
+    double triggerTime = SampleTime::time(device->digitalTriggerIndex(),
+                                          device->usedSampleRate());
     t -= (triggerTime-mRefTime);
 
     QString result = StringUtil::timeInSecToString(t);
@@ -0,0 +1,97 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "sampleindex.h"
+
+#include <cmath>
+
+/*!
+    \typedef SampleIndex
+    \brief Position of a sample in a capture, or a number of samples.
+
+    \ingroup Common
+
+    A 64-bit integer so that a capture isn't limited to 2^31 samples.
+*/
+
+/*!
+    \class SampleTime
+    \brief Conversions between sample indexes and time.
+
+    \ingroup Common
+
+    The time of a sample is always calculated as the sample index divided
+    by the sample rate, never as a sum or a multiple of the sample period,
+    so that it is as exact as a double allows (sample indexes up to 2^53)
+    also far into a long capture. The conversions from time back to a
+    sample index are exact inverses: floorIndex(time(i, rate), rate) is
+    always \c i.
+*/
+
+/*!
+    Returns the time in seconds of sample \a idx at \a sampleRate.
+*/
+double SampleTime::time(SampleIndex idx, int sampleRate)
+{
+    return (double)idx / sampleRate;
+}
+
+/*!
+    Returns the index of the last sample at or before \a time at
+    \a sampleRate.
+*/
+SampleIndex SampleTime::floorIndex(double time, int sampleRate)
+{
+    SampleIndex idx = (SampleIndex)std::floor(time * sampleRate);
+
+    // the multiplication may round across a sample boundary
+    if (SampleTime::time(idx + 1, sampleRate) <= time) {
+        idx++;
+    }
+    else if (SampleTime::time(idx, sampleRate) > time) {
+        idx--;
+    }
+
+    return idx;
+}
+
+/*!
+    Returns the index of the first sample at or after \a time at
+    \a sampleRate.
+*/
+SampleIndex SampleTime::ceilIndex(double time, int sampleRate)
+{
+    SampleIndex idx = floorIndex(time, sampleRate);
+
+    if (SampleTime::time(idx, sampleRate) < time) {
+        idx++;
+    }
+
+    return idx;
+}
+
+/*!
+    Returns the index of the sample closest to \a time at \a sampleRate.
+*/
+SampleIndex SampleTime::nearestIndex(double time, int sampleRate)
+{
+    SampleIndex idx = floorIndex(time, sampleRate);
+
+    if (SampleTime::time(idx + 1, sampleRate) - time < time - SampleTime::time(idx, sampleRate)) {
+        idx++;
+    }
+
+    return idx;
+}
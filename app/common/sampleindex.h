@@ -0,0 +1,35 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef SAMPLEINDEX_H
+#define SAMPLEINDEX_H
+
+#include <QtGlobal>
+
+/*!
+    Position of a sample in a capture, or a number of samples.
+*/
+typedef qint64 SampleIndex;
+
+class SampleTime
+{
+public:
+    static double time(SampleIndex idx, int sampleRate);
+    static SampleIndex floorIndex(double time, int sampleRate);
+    static SampleIndex ceilIndex(double time, int sampleRate);
+    static SampleIndex nearestIndex(double time, int sampleRate);
+};
+
+#endif // SAMPLEINDEX_H
@@ -89,6 +89,9 @@
 
     \var AnalogSignal::AnalogWaveform AnalogSignal::WaveformTriangle
     Generate a triangle waveform.
+
+    \var AnalogSignal::AnalogWaveform AnalogSignal::WaveformArbitrary
+    Generate the waveform described by arbitraryData().
 */
 
 
@@ -151,7 +154,8 @@ bool AnalogSignal::operator==(const AnalogSignal &other)
             mTriggerLevel == other.mTriggerLevel &&
             mFrequency == other.mFrequency &&
             mWaveform == other.mWaveform &&
-            mAmplitude == other.mAmplitude);
+            mAmplitude == other.mAmplitude &&
+            mArbitraryData == other.mArbitraryData);
 
 }
 
@@ -178,6 +182,7 @@ AnalogSignal& AnalogSignal::operator=(const AnalogSignal &other)
     mFrequency = other.mFrequency;
     mWaveform = other.mWaveform;
     mAmplitude = other.mAmplitude;
+    mArbitraryData = other.mArbitraryData;
     mUsage = other.mUsage;
     mReconfigureListener = other.mReconfigureListener;
 
@@ -332,6 +337,26 @@ void AnalogSignal::setTriggerLevel(double l)
    Sets the amplitude for this signal to \a amp.
 */
 
+/*!
+    \fn QVector<double> AnalogSignal::arbitraryData() const
+
+   Returns one period of the waveform to generate when the waveform is
+   WaveformArbitrary. The values are in the range -1 to 1 and are scaled
+   with the amplitude.
+*/
+
+/*!
+   Sets one period of the waveform to generate when the waveform is
+   WaveformArbitrary to \a data. The values are limited to the range -1 to 1.
+*/
+void AnalogSignal::setArbitraryData(const QVector<double> &data)
+{
+    mArbitraryData.resize(data.size());
+    for (int i = 0; i < data.size(); i++) {
+        mArbitraryData[i] = qBound(-1.0, data.at(i), 1.0);
+    }
+}
+
 
 /*!
     Returns a string representation of this analog signal. This is typically
@@ -348,7 +373,7 @@ QString AnalogSignal::toSettingsString()
     // vPerDiv;triggerState;triggerLevel;coupling
 
     // -- generate fields
-    // waveform;frequency;amplitude
+    // waveform;frequency;amplitude;arbitraryData
 
 
     QString str;
@@ -367,6 +392,14 @@ QString AnalogSignal::toSettingsString()
         str.append(QString("%1;").arg(mWaveform));
         str.append(QString("%1;").arg(mFrequency));
         str.append(QString("%1").arg(mAmplitude));
+
+        if (!mArbitraryData.isEmpty()) {
+            QStringList values;
+            foreach(double v, mArbitraryData) {
+                values.append(QString::number(v));
+            }
+            str.append(";").append(values.join(","));
+        }
     }
 
 
@@ -396,7 +429,7 @@ AnalogSignal AnalogSignal::fromSettingsString(QString& s)
         // vPerDiv;triggerState;triggerLevel;coupling
 
         // -- generate fields
-        // waveform;frequency;amplitude
+        // waveform;frequency;amplitude;arbitraryData (optional)
 
         QStringList list = s.split(';');
         if (list.size() < 7) break;
@@ -475,12 +508,23 @@ AnalogSignal AnalogSignal::fromSettingsString(QString& s)
             double amp = list.at(6).toDouble(&ok);
             if (!ok) break;
 
+            // --- arbitrary waveform data
+            QVector<double> data;
+            if (list.size() > 7 && !list.at(7).isEmpty()) {
+                foreach(QString v, list.at(7).split(',')) {
+                    data.append(v.toDouble(&ok));
+                    if (!ok) break;
+                }
+                if (!ok) break;
+            }
+
             tmp.mUsage = usage;
             tmp.mId = id;
             tmp.mName = name;
             tmp.mWaveform = waveform;
             tmp.mFrequency = freq;
             tmp.mAmplitude = amp;
+            tmp.setArbitraryData(data);
         }
 
 
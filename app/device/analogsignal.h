@@ -18,6 +18,7 @@
 
 #include <QString>
 #include <QMetaType>
+#include <QVector>
 
 #include "reconfigurelistener.h"
 
@@ -51,6 +52,7 @@ public:
         WaveformSine,
         WaveformSquare,
         WaveformTriangle,
+        WaveformArbitrary,
         WaveformNum // must be last
     };
 
@@ -89,6 +91,9 @@ public:
     double amplitude() const {return mAmplitude;}
     void setAmplitude(double amp) {mAmplitude = amp;}
 
+    QVector<double> arbitraryData() const {return mArbitraryData;}
+    void setArbitraryData(const QVector<double> &data);
+
     QString toSettingsString();
     static AnalogSignal fromSettingsString(QString& settings);
 
@@ -116,6 +121,7 @@ private:
     AnalogWaveform mWaveform;
     int mFrequency;
     double mAmplitude;
+    QVector<double> mArbitraryData;
 
     
 };
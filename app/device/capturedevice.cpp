@@ -38,6 +38,7 @@ CaptureDevice::CaptureDevice(QObject *parent) :
     QObject(parent)
 {
     mUsedSampleRate = 1;
+    mDigitalEdgeIndexValid = false;
 }
 
 /*!
@@ -147,6 +148,20 @@ QList<double> CaptureDevice::supportedVPerDiv()
 
 */
 
+/*!
+    \fn virtual void CaptureDevice::showDiagnostics(QWidget* parent)
+
+    If a capture device can report information about how the captures went,
+    e.g. lost samples, this virtual function must be overriden in a subclass.
+
+    A dialog window can be presented to the user by using \a parent as Ui
+    context.
+
+    Reimplement this function in a CaptureDevice subclass. By default a message
+    dialog is shown to indicate that there aren't any diagnostics for the device.
+
+*/
+
 /*!
     \fn virtual void CaptureDevice::start(int sampleRate) = 0
 
@@ -191,7 +206,7 @@ QList<double> CaptureDevice::supportedVPerDiv()
 */
 
 /*!
-    \fn virtual int CaptureDevice::lastSampleIndex() = 0
+    \fn virtual SampleIndex CaptureDevice::lastSampleIndex() = 0
 
     Returns the last valid index for the latest capture
     request. If a 1000 samples were performed this function should return 999.
@@ -227,6 +242,7 @@ DigitalSignal* CaptureDevice::addDigitalSignal(int id)
         mDigitalSignalList.append(signal);
         qSort(mDigitalSignalList.begin(), mDigitalSignalList.end(),
               digitalSignalLessThan);
+        invalidateDigitalEdgeIndex();
 
         // adding a signal might require a reconfiguration
         reconfigure();
@@ -246,6 +262,7 @@ void CaptureDevice::removeDigitalSignal(DigitalSignal* s)
     if (mDigitalSignalList.contains(s)) {
         mDigitalSignalList.removeOne(s);
         delete s;
+        invalidateDigitalEdgeIndex();
 
         // removing a signal might require a reconfiguration
         reconfigure();
@@ -445,57 +462,69 @@ QList<int> CaptureDevice::unusedAnalogIds()
 */
 
 /*!
-    \fn virtual int CaptureDevice::digitalTriggerIndex() = 0
+    \fn virtual SampleIndex CaptureDevice::digitalTriggerIndex() = 0
 
     Returns the sample index where the trigger occured.
 */
 
 /*!
-    \fn virtual void CaptureDevice::setDigitalTriggerIndex(int idx) = 0
+    \fn virtual void CaptureDevice::setDigitalTriggerIndex(SampleIndex idx) = 0
 
     Sets the sample index where the trigger occured to \a idx.
 */
 
 /*!
-    Get a list with digital transitions for the digital signal with ID
-    \a signalId. The first position in the list \a list will contain the
-    logical level of the signal at sample index 0. The remaining positions
-    (except the last) in the list will contain the sample indexes where
-    a transition (high-to-low or low-to-high) occured.
+    \fn virtual const DigitalTransitions* CaptureDevice::digitalTransitions(int signalId) = 0
 
-    The last position contains the last sample index of the data even if there
-    wasn't a transition at that index.
+    Returns the digital transitions for the digital signal with ID
+    \a signalId, or NULL if there is no data for the signal. The
+    transitions are created from the signal data the first time they are
+    needed and are owned by the capture device.
 */
-void CaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+
+/*!
+    Returns the transitions of all digital signals merged into one index,
+    see DigitalEdgeIndex. The index is built the first time it is needed
+    after the signals or their data have changed.
+*/
+const DigitalEdgeIndex &CaptureDevice::digitalEdgeIndex()
 {
+    if (!mDigitalEdgeIndexValid) {
+        QMap<int, const DigitalTransitions*> transitions;
+        foreach(DigitalSignal* signal, mDigitalSignalList) {
+            const DigitalTransitions* t = digitalTransitions(signal->id());
+            if (t != NULL) {
+                transitions.insert(signal->id(), t);
+            }
+        }
 
-    QVector<int>* data = digitalData(signalId);
-    if (data != NULL && data->size() > 0) {
+        // A device with more than 16 digital signals gets an index that
+        // searches each signal, see DigitalEdgeIndex
+        mDigitalEdgeIndex.build(transitions);
+        mDigitalEdgeIndexValid = true;
+    }
 
-        int val = data->at(0);
+    return mDigitalEdgeIndex;
+}
 
-        //
-        //  Index 0 always contains the logic level of the data at first
-        //  position. The remaining position contains transition index
-        //
-        list.append(val);
+/*!
+    \fn void CaptureDevice::invalidateDigitalEdgeIndex()
 
+    Marks the index returned by digitalEdgeIndex() as out-of-date. Must be
+    called by subclasses whenever the digital signal data changes.
+*/
 
-        for (int i = 1; i < data->size(); i++) {
-            if (data->at(i) != val) {
-                list.append(i);
-                val = data->at(i);
-            }
-        }
+/*!
+    \fn virtual QVector<I2CItem>* CaptureDevice::monitoredI2CItems()
 
-        //
-        //  The last index of the transition list always contains the "size",
-        //  i.e., the last sample time of the data list
-        //
-        list.append(data->size()-1);
+    Returns the I2C communication captured by a hardware I2C monitor or NULL
+    if the latest capture did not use one. The item indices are sample
+    indices at the usedSampleRate().
 
-    }
-}
+    Reimplement this function in a CaptureDevice subclass that can monitor
+    an I2C bus without sampling the SCL and SDA signals. By default NULL is
+    returned and the I2C analyzer decodes the digital signals instead.
+*/
 
 /*!
     \fn void CaptureDevice::captureFinished(bool successful, QString msg)
@@ -506,6 +535,14 @@ void CaptureDevice::digitalTransitions(int signalId, QList<int> &list)
     it wasn't successful.
 */
 
+/*!
+    \fn void CaptureDevice::captureUpdated()
+
+    This signal is emitted when more data has become available during an
+    ongoing capture, e.g. while monitoring an I2C bus. The capture continues
+    until captureFinished() is emitted.
+*/
+
 /*!
     \fn int CaptureDevice::mUsedSampleRate
 
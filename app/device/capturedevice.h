@@ -24,6 +24,10 @@
 #include "digitalsignal.h"
 #include "analogsignal.h"
 #include "reconfigurelistener.h"
+#include "common/sampleindex.h"
+#include "digitaltransitions.h"
+#include "digitaledgeindex.h"
+#include "analyzer/i2c/i2citem.h"
 
 class CaptureDevice : public QObject, public ReconfigureListener
 {
@@ -54,13 +58,20 @@ public:
                     tr("No settings"),
                     tr("No calibration settings for this device"));
     }
+    virtual void showDiagnostics(QWidget* parent)
+    {
+        QMessageBox::warning(
+                    parent,
+                    tr("No diagnostics"),
+                    tr("No diagnostics available for this device"));
+    }
 
     virtual void start(int sampleRate) = 0;
     virtual void stop() = 0;
 
     virtual int usedSampleRate() {return mUsedSampleRate;}
     virtual void setUsedSampleRate(int sampleRate) {mUsedSampleRate = sampleRate;}
-    virtual int lastSampleIndex() = 0;
+    virtual SampleIndex lastSampleIndex() = 0;
 
     DigitalSignal* addDigitalSignal(int id);
     void removeDigitalSignal(DigitalSignal* s);
@@ -81,14 +92,18 @@ public:
 
     virtual void clearSignalData() = 0;
 
-    virtual int digitalTriggerIndex() = 0;
-    virtual void setDigitalTriggerIndex(int idx) = 0;
+    virtual SampleIndex digitalTriggerIndex() = 0;
+    virtual void setDigitalTriggerIndex(SampleIndex idx) = 0;
+
+    virtual const DigitalTransitions* digitalTransitions(int signalId) = 0;
+    const DigitalEdgeIndex &digitalEdgeIndex();
 
-    virtual void digitalTransitions(int signalId, QList<int> &list);
+    virtual QVector<I2CItem>* monitoredI2CItems() {return NULL;}
 
 
 signals:
     void captureFinished(bool successful, QString msg);
+    void captureUpdated();
     
 public slots:
 
@@ -98,8 +113,11 @@ protected:
     QList<DigitalSignal*> mDigitalSignalList;
     QList<AnalogSignal*> mAnalogSignalList;
 
+    void invalidateDigitalEdgeIndex() {mDigitalEdgeIndexValid = false;}
 
-    
+private:
+    DigitalEdgeIndex mDigitalEdgeIndex;
+    bool mDigitalEdgeIndexValid;
 };
 
 #endif // CAPTUREDEVICE_H
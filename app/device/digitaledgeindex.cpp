@@ -0,0 +1,302 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "digitaledgeindex.h"
+
+#include <QtAlgorithms>
+
+/*!
+    \class DigitalEdgeIndex
+    \brief All transitions of all digital signals in one sorted list.
+
+    \ingroup Device
+
+    The DigitalEdgeIndex class merges the transitions of the digital
+    signals (see CaptureDevice::digitalTransitions) into one list sorted on
+    sample index where each transition is tagged with the signal it belongs
+    to. Finding the transition closest to a point in time, or the next one
+    on any signal, is then a binary search instead of a scan of each signal.
+
+    The list is stored in the same compact form as DigitalTransitions: each
+    transition is the distance to the previous one, shifted up to make
+    room for a 4-bit tag, using as few bytes as needed. The transitions are
+    divided into blocks and the sample index of the first transition in
+    each block is stored separately so that a search is a binary search
+    among the blocks followed by a search within one block.
+
+    At most 16 signals can be merged as that is what the tag holds. With
+    more signals nothing is merged, size() is 0 and searches on any signal
+    look at the transitions of each signal instead.
+
+    Searches on one signal use that signal's DigitalTransitions directly
+    as its transitions can be far apart in the merged list.
+*/
+
+/*!
+    Constructs an empty index.
+*/
+DigitalEdgeIndex::DigitalEdgeIndex()
+{
+    mSize = 0;
+    mMerged = true;
+}
+
+/*!
+    Removes all transitions.
+*/
+void DigitalEdgeIndex::clear()
+{
+    mSize = 0;
+    mMerged = true;
+    mIds.clear();
+    mTransitions.clear();
+    mBlockStart.clear();
+    mBlockOffset.clear();
+    mData.clear();
+}
+
+/*!
+    Builds the index from the \a transitions of each signal, mapped on
+    signal ID. The transitions are not copied and must be valid until the
+    index is cleared or built again.
+
+    The transitions of each signal are already sorted so they are merged by
+    repeatedly taking the earliest transition at the head of the signals.
+    Nothing is merged if more than 16 signals have transitions.
+*/
+void DigitalEdgeIndex::build(const QMap<int, const DigitalTransitions*> &transitions)
+{
+    clear();
+    mTransitions = transitions;
+
+    QVector<DigitalTransitions::const_iterator> heads;
+    QVector<DigitalTransitions::const_iterator> ends;
+    int total = 0;
+
+    QMap<int, const DigitalTransitions*>::const_iterator it;
+    for (it = transitions.constBegin(); it != transitions.constEnd(); ++it) {
+        if (it.value()->size() > 0) {
+            if (mIds.size() == MaxSignals) {
+                // no tag left, search each signal instead
+                mIds.clear();
+                mMerged = false;
+                return;
+            }
+            mIds.append(it.key());
+            heads.append(it.value()->begin());
+            ends.append(it.value()->end());
+            total += it.value()->size();
+        }
+    }
+
+    mData.reserve(total);
+    SampleIndex previous = 0;
+
+    while (mSize < total) {
+        int earliest = -1;
+        for (int i = 0; i < heads.size(); i++) {
+            if (heads.at(i) == ends.at(i)) continue;
+
+            if (earliest == -1 || *heads.at(i) < *heads.at(earliest)) {
+                earliest = i;
+            }
+        }
+
+        append(*heads.at(earliest), earliest, previous);
+        ++heads[earliest];
+    }
+
+    mBlockStart.squeeze();
+    mBlockOffset.squeeze();
+    mData.squeeze();
+}
+
+/*!
+    \fn int DigitalEdgeIndex::size() const
+
+    Returns the number of transitions in the index.
+*/
+
+/*!
+    Returns the sample index of transition \a i.
+*/
+SampleIndex DigitalEdgeIndex::sampleIndex(int i) const
+{
+    SampleIndex sampleIdx;
+    int tag;
+    decodeAt(i, sampleIdx, tag);
+    return sampleIdx;
+}
+
+/*!
+    Returns the ID of the signal that transition \a i belongs to.
+*/
+int DigitalEdgeIndex::signalId(int i) const
+{
+    SampleIndex sampleIdx;
+    int tag;
+    decodeAt(i, sampleIdx, tag);
+    return mIds.at(tag);
+}
+
+/*!
+    Returns the position of the first transition at or after \a sampleIdx,
+    or size() if there is none. The number of transitions in a range of
+    samples is the difference between the lower bounds of its ends.
+*/
+int DigitalEdgeIndex::lowerBound(SampleIndex sampleIdx) const
+{
+    // the last block starting before sampleIdx is the only one to search
+    int block = qLowerBound(mBlockStart.constBegin(), mBlockStart.constEnd(), sampleIdx)
+            - mBlockStart.constBegin() - 1;
+    if (block < 0) {
+        return 0;
+    }
+
+    int i = block*BlockSize;
+    int blockEnd = qMin(i + BlockSize, mSize);
+    int offset = mBlockOffset.at(block);
+    SampleIndex value = mBlockStart.at(block);
+
+    for (; i < blockEnd; i++) {
+        value += (SampleIndex)(DigitalTransitions::decodeVarint(mData.constData(), offset) >> TagBits);
+        if (value >= sampleIdx) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/*!
+    Returns the sample index of the transition closest to \a sampleIdx on
+    the signal with ID \a signalId, or on any signal if \a signalId is -1.
+    Returns -1 if there is no such transition.
+*/
+SampleIndex DigitalEdgeIndex::closest(SampleIndex sampleIdx, int signalId) const
+{
+    SampleIndex after = next(sampleIdx - 1, signalId);
+    SampleIndex before = previous(sampleIdx, signalId);
+
+    if (before == -1) return after;
+    if (after == -1) return before;
+
+    if (sampleIdx - before < after - sampleIdx) {
+        return before;
+    }
+    return after;
+}
+
+/*!
+    Returns the sample index of the first transition after \a sampleIdx on
+    the signal with ID \a signalId, or on any signal if \a signalId is -1.
+    Returns -1 if there is no such transition.
+*/
+SampleIndex DigitalEdgeIndex::next(SampleIndex sampleIdx, int signalId) const
+{
+    if (signalId != -1) {
+        const DigitalTransitions* t = mTransitions.value(signalId, NULL);
+        if (t == NULL) {
+            return -1;
+        }
+        int i = t->lowerBound(sampleIdx + 1);
+        return (i < t->size()) ? t->at(i) : -1;
+    }
+
+    if (!mMerged) {
+        SampleIndex first = -1;
+        foreach(int id, mTransitions.keys()) {
+            SampleIndex idx = next(sampleIdx, id);
+            if (idx != -1 && (first == -1 || idx < first)) {
+                first = idx;
+            }
+        }
+        return first;
+    }
+
+    int i = lowerBound(sampleIdx + 1);
+    return (i < mSize) ? sampleIndex(i) : -1;
+}
+
+/*!
+    Returns the sample index of the last transition before \a sampleIdx on
+    the signal with ID \a signalId, or on any signal if \a signalId is -1.
+    Returns -1 if there is no such transition.
+*/
+SampleIndex DigitalEdgeIndex::previous(SampleIndex sampleIdx, int signalId) const
+{
+    if (signalId != -1) {
+        const DigitalTransitions* t = mTransitions.value(signalId, NULL);
+        if (t == NULL) {
+            return -1;
+        }
+        int i = t->lowerBound(sampleIdx) - 1;
+        return (i >= 0) ? t->at(i) : -1;
+    }
+
+    if (!mMerged) {
+        SampleIndex last = -1;
+        foreach(int id, mTransitions.keys()) {
+            last = qMax(last, previous(sampleIdx, id));
+        }
+        return last;
+    }
+
+    int i = lowerBound(sampleIdx) - 1;
+    return (i >= 0) ? sampleIndex(i) : -1;
+}
+
+/*!
+    Returns the number of bytes used to store the merged transitions.
+*/
+int DigitalEdgeIndex::memoryUsage() const
+{
+    return mData.size() + mBlockStart.size()*sizeof(SampleIndex) + mBlockOffset.size()*sizeof(int);
+}
+
+/*!
+    Adds a transition at \a sampleIdx on the signal with \a tag. The
+    \a previous sample index is updated.
+*/
+void DigitalEdgeIndex::append(SampleIndex sampleIdx, int tag, SampleIndex &previous)
+{
+    if ((mSize % BlockSize) == 0) {
+        mBlockStart.append(sampleIdx);
+        mBlockOffset.append(mData.size());
+        previous = sampleIdx;
+    }
+
+    DigitalTransitions::appendVarint(mData, ((quint64)(sampleIdx - previous) << TagBits) | (tag & TagMask));
+
+    previous = sampleIdx;
+    mSize++;
+}
+
+/*!
+    Decodes transition \a i into \a sampleIdx and \a tag.
+*/
+void DigitalEdgeIndex::decodeAt(int i, SampleIndex &sampleIdx, int &tag) const
+{
+    int block = i / BlockSize;
+    int offset = mBlockOffset.at(block);
+    quint64 v = 0;
+
+    sampleIdx = mBlockStart.at(block);
+    for (int j = block*BlockSize; j <= i; j++) {
+        v = DigitalTransitions::decodeVarint(mData.constData(), offset);
+        sampleIdx += (SampleIndex)(v >> TagBits);
+    }
+    tag = (int)(v & TagMask);
+}
@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DIGITALEDGEINDEX_H
+#define DIGITALEDGEINDEX_H
+
+#include <QMap>
+#include <QVector>
+
+#include "digitaltransitions.h"
+
+class DigitalEdgeIndex
+{
+public:
+    DigitalEdgeIndex();
+
+    void clear();
+    void build(const QMap<int, const DigitalTransitions*> &transitions);
+
+    int size() const {return mSize;}
+    bool isEmpty() const {return mSize == 0;}
+    SampleIndex sampleIndex(int i) const;
+    int signalId(int i) const;
+
+    int lowerBound(SampleIndex sampleIdx) const;
+    SampleIndex closest(SampleIndex sampleIdx, int signalId = -1) const;
+    SampleIndex next(SampleIndex sampleIdx, int signalId = -1) const;
+    SampleIndex previous(SampleIndex sampleIdx, int signalId = -1) const;
+
+    int memoryUsage() const;
+
+private:
+
+    enum {
+        BlockSize = 64,
+        TagBits = 4,
+        TagMask = (1 << TagBits) - 1,
+        MaxSignals = (1 << TagBits)
+    };
+
+    int mSize;
+    // false if there were too many signals to merge
+    bool mMerged;
+
+    // signal ID for each tag
+    QVector<int> mIds;
+    // the transitions of each signal, searched when looking on one signal
+    QMap<int, const DigitalTransitions*> mTransitions;
+
+    // sample index of the first transition in each block
+    QVector<SampleIndex> mBlockStart;
+    // position in mData of the first transition in each block
+    QVector<int> mBlockOffset;
+    // the distance to the previous transition shifted up TagBits bits with
+    // the tag in the low bits, 7 bits per byte with the most significant
+    // bit set in all but the last byte
+    QVector<quint8> mData;
+
+    void append(SampleIndex sampleIdx, int tag, SampleIndex &previous);
+    void decodeAt(int i, SampleIndex &sampleIdx, int &tag) const;
+};
+
+#endif // DIGITALEDGEINDEX_H
@@ -107,7 +107,8 @@ bool DigitalSignal::operator==(const DigitalSignal &signal) const
             mName == signal.mName &&
             mTriggerState == signal.mTriggerState &&
             mData == signal.mData &&
-            mNumStates == signal.mNumStates);
+            mNumStates == signal.mNumStates &&
+            mUartStream == signal.mUartStream);
 
 }
 
@@ -131,6 +132,7 @@ DigitalSignal& DigitalSignal::operator=(const DigitalSignal &other)
     mTriggerState = other.mTriggerState;
     mData = other.mData;
     mNumStates = other.mNumStates;
+    mUartStream = other.mUartStream;
     mReconfigureListener = other.mReconfigureListener;
 
     return *this;
@@ -161,34 +163,78 @@ DigitalSignal& DigitalSignal::operator=(const DigitalSignal &other)
 */
 
 /*!
-    \fn QVector<bool> DigitalSignal::data() const
+    \fn const QVector<quint32> &DigitalSignal::packedData() const
 
-   Returns the signal data associated with this digital signal.
+   Returns the signal data associated with this digital signal. The states
+   are packed with 32 states per word and the first state in the least
+   significant bit. Use numStates() to find out how many of the states that
+   are valid.
 
    \note
    Currently the data is only valid for the Generator functionality. Data
    that has been Captured is retrieved by CaptureDevice::digitalData().
 */
 
+/*!
+   Returns the state at \a index; true for a logical 1 and false for a
+   logical 0.
+*/
+bool DigitalSignal::state(int index) const
+{
+    if (index < 0 || index >= mNumStates) return false;
+
+    return ((mData.at(index / 32) >> (index % 32)) & 1) != 0;
+}
 
 /*!
-   Sets the data, that is, vector of digital states that will be associated
-   with this digital signal.
+   Returns the 32 states starting at \a first packed into a word with the
+   state at \a first in the least significant bit. States after the last
+   valid state are 0.
+*/
+quint32 DigitalSignal::stateWord(int first) const
+{
+    if (first < 0 || first >= mNumStates) return 0;
 
-   \note
-   Currently the data is only valid for the Generator functionality. Data
-   that has been Captured is retrieved by CaptureDevice::digitalData().
+    quint32 w = readBits(first);
+    int valid = mNumStates - first;
+    if (valid < 32) {
+        w &= (1u << valid) - 1;
+    }
+
+    return w;
+}
+
+/*!
+   Returns the index of the first state after \a from that differs from
+   the state at \a from. If all states up to (but not including) \a to
+   are the same then \a to is returned. The states are compared 32 at a
+   time which makes it cheap to find the length of long runs.
 */
-void DigitalSignal::setData(QVector<bool> &data)
+int DigitalSignal::nextTransition(int from, int to) const
 {
+    if (to > mNumStates) {
+        to = mNumStates;
+    }
+    if (from < 0 || from + 1 >= to) return to;
 
-    mData = data;
+    quint32 fill = state(from) ? 0xffffffff : 0;
+    for (int pos = from + 1; pos < to; pos += 32) {
+        quint32 diff = readBits(pos) ^ fill;
+        if (to - pos < 32) {
+            diff &= (1u << (to - pos)) - 1;
+        }
 
-    if (mData.size() < mNumStates) {
-        mData.resize(mNumStates);
+        if (diff != 0) {
+            while ((diff & 1) == 0) {
+                diff >>= 1;
+                pos++;
+            }
+            return pos;
+        }
     }
-}
 
+    return to;
+}
 
 /*!
     \fn DigitalTriggerState DigitalSignal::triggerState()
@@ -232,8 +278,9 @@ void DigitalSignal::setNumStates(int numStates)
     if (numStates <= 0) return;
 
     // the vector with states is never decreased, only increased
-    if (mData.size() < numStates) {
-        mData.resize(numStates);
+    int numWords = (numStates + 31) / 32;
+    if (mData.size() < numWords) {
+        mData.resize(numWords);
     }
 
     mNumStates = numStates;
@@ -245,9 +292,14 @@ void DigitalSignal::setNumStates(int numStates)
 */
 void DigitalSignal::setState(int index, bool high)
 {
-    if (index < 0 || index >= mData.size()) return;
+    if (index < 0 || index >= mNumStates) return;
 
-    mData[index] = high;
+    if (high) {
+        mData[index / 32] |= (1u << (index % 32));
+    }
+    else {
+        mData[index / 32] &= ~(1u << (index % 32));
+    }
 }
 
 /*!
@@ -255,11 +307,138 @@ void DigitalSignal::setState(int index, bool high)
 */
 void DigitalSignal::toogleState(int index)
 {
-    if (index < 0 || index >= mData.size()) return;
+    if (index < 0 || index >= mNumStates) return;
+
+    mData[index / 32] ^= (1u << (index % 32));
+}
+
+/*!
+    Set all states from \a from up to (but not including) \a to to the
+    value given by \a high.
+*/
+void DigitalSignal::setStates(int from, int to, bool high)
+{
+    if (from < 0) from = 0;
+    if (to > mNumStates) to = mNumStates;
+
+    quint32 fill = high ? 0xffffffff : 0;
+    for (int pos = from; pos < to; pos += 32) {
+        writeBits(pos, fill, qMin(32, to - pos));
+    }
+}
+
+/*!
+    Invert all states from \a from up to (but not including) \a to.
+*/
+void DigitalSignal::invertStates(int from, int to)
+{
+    if (from < 0) from = 0;
+    if (to > mNumStates) to = mNumStates;
+
+    for (int pos = from; pos < to; pos += 32) {
+        writeBits(pos, ~readBits(pos), qMin(32, to - pos));
+    }
+}
+
+/*!
+    Repeat the \a length states starting at \a from until (but not
+    including) state \a to.
+
+    The repeated part is doubled for each copy which means that the number
+    of copy operations only depends on the number of words to fill.
+*/
+void DigitalSignal::repeatStates(int from, int length, int to)
+{
+    if (from < 0 || length <= 0) return;
+    if (to > mNumStates) to = mNumStates;
+
+    int done = length;
+    while (from + done < to) {
+        int count = qMin(done, to - (from + done));
+        copyStates(from, from + done, count);
+        done += count;
+    }
+}
+
+/*!
+    Generate a clock signal from \a from up to (but not including) \a to.
+    Each period has \a numHigh high states and \a numLow low states and
+    starts with the high states if \a startHigh is true.
+*/
+void DigitalSignal::generateClock(int from, int to, int numHigh, int numLow,
+                                  bool startHigh)
+{
+    if (numHigh < 0 || numLow < 0 || numHigh + numLow == 0) return;
+    if (to > mNumStates) to = mNumStates;
+
+    int first = (startHigh ? numHigh : numLow);
+    int period = numHigh + numLow;
+
+    setStates(from, qMin(from + first, to), startHigh);
+    setStates(from + first, qMin(from + period, to), !startHigh);
+    repeatStates(from, period, to);
+}
+
+/*!
+    Returns the 32 stored states starting at \a pos with the state at
+    \a pos in the least significant bit.
+*/
+quint32 DigitalSignal::readBits(int pos) const
+{
+    int idx = pos / 32;
+    int shift = pos % 32;
+
+    quint32 lo = (idx < mData.size() ? mData.at(idx) : 0);
+    if (shift == 0) return lo;
 
-    mData[index] = !mData[index];
+    quint32 hi = (idx + 1 < mData.size() ? mData.at(idx + 1) : 0);
+    return (lo >> shift) | (hi << (32 - shift));
 }
 
+/*!
+    Stores the \a count (1-32) least significant bits of \a bits as the
+    states starting at \a pos.
+*/
+void DigitalSignal::writeBits(int pos, quint32 bits, int count)
+{
+    int idx = pos / 32;
+    int shift = pos % 32;
+    quint32 mask = (count >= 32 ? 0xffffffff : ((1u << count) - 1));
+
+    bits &= mask;
+    mData[idx] = (mData.at(idx) & ~(mask << shift)) | (bits << shift);
+
+    if (shift + count > 32) {
+        quint32 hiMask = mask >> (32 - shift);
+        mData[idx + 1] = (mData.at(idx + 1) & ~hiMask) | (bits >> (32 - shift));
+    }
+}
+
+/*!
+    Copies \a count states from \a src to \a dst. The ranges must not
+    overlap.
+*/
+void DigitalSignal::copyStates(int src, int dst, int count)
+{
+    for (int i = 0; i < count; i += 32) {
+        writeBits(dst + i, readBits(src + i), qMin(32, count - i));
+    }
+}
+
+/*!
+    \fn const UartStream &DigitalSignal::uartStream() const
+
+    Returns the UART output of a generated signal. When the stream is
+    enabled and the generator device streams the digital signals the
+    UART output is generated instead of the states.
+*/
+
+/*!
+    \fn void DigitalSignal::setUartStream(const UartStream &stream)
+
+    Sets the UART output of a generated signal to \a stream.
+*/
+
 /*!
     Returns a string representation of this digital signal. This is typically
     used when saving settings to persistent storage.
@@ -275,7 +454,7 @@ QString DigitalSignal::toSettingsString()
     // trigger
 
     // -- generate fields
-    // states;data(base64 coded)
+    // states;data(base64 coded)[;uart stream]
 
     QString str;
     str.append("Digital;");
@@ -293,10 +472,15 @@ QString DigitalSignal::toSettingsString()
         QByteArray out;
         out.resize(mNumStates/8+1);
         out.fill(0);
-        for (int i = 0; i < mNumStates; i++) {
-            out[i/8] = ( out.at(i/8) | (mData[i]?1:0)<<(i%8)) ;
+        for (int i = 0; i < mNumStates; i += 8) {
+            out[i/8] = (char)(stateWord(i) & 0xff);
         }
         str.append(out.toBase64());
+
+        if (mUartStream.isEnabled()) {
+            str.append(";");
+            str.append(mUartStream.toSettingsString());
+        }
     }
 
     return str;
@@ -326,7 +510,7 @@ DigitalSignal DigitalSignal::fromSettingsString(QString &s)
         // trigger
 
         // -- generate fields
-        // states;data(base64 coded)
+        // states;data(base64 coded)[;uart stream]
 
 
         QStringList list = s.split(';');
@@ -368,7 +552,7 @@ DigitalSignal DigitalSignal::fromSettingsString(QString &s)
         }
         else {
 
-            if (list.size() != 6) break;
+            if (list.size() != 6 && list.size() != 7) break;
 
             // --- num states
             int numStates = list.at(4).toInt(&ok);
@@ -380,9 +564,12 @@ DigitalSignal DigitalSignal::fromSettingsString(QString &s)
 
             QByteArray arrData = QByteArray::fromBase64(dataBase64.toLatin1());
             if (arrData.size() * 8 < numStates) break;
-            QVector<bool> data(numStates);
-            for (int i = 0; i < numStates; i++) {
-                data[i] = ((arrData[i/8] & (1 << (i%8))) != 0);
+            QVector<quint32> data((numStates + 31) / 32);
+            for (int i = 0; i < (numStates + 7) / 8; i++) {
+                data[i/4] |= ((quint32)(quint8)arrData.at(i)) << (8*(i%4));
+            }
+            if ((numStates % 32) != 0) {
+                data[data.size()-1] &= (1u << (numStates % 32)) - 1;
             }
 
             tmp.mId = id;
@@ -390,6 +577,11 @@ DigitalSignal DigitalSignal::fromSettingsString(QString &s)
             tmp.mName = name;
             tmp.mNumStates = numStates;
             tmp.mData = data;
+
+            // --- uart stream (optional)
+            if (list.size() == 7) {
+                tmp.mUartStream = UartStream::fromSettingsString(list.at(6));
+            }
         }
 
     } while (false);
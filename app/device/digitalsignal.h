@@ -21,6 +21,7 @@
 #include <QString>
 
 #include "reconfigurelistener.h"
+#include "generator/uartstream.h"
 
 class DigitalSignal
 {
@@ -59,8 +60,12 @@ public:
     QString name() const {return mName;}
     void setName(QString name) {mName = name;}
 
-    QVector<bool> data() const {return mData;}
-    void setData(QVector<bool> &data);
+    // states are packed with 32 states per word, first state in the
+    // least significant bit
+    const QVector<quint32> &packedData() const {return mData;}
+    bool state(int index) const;
+    quint32 stateWord(int first) const;
+    int nextTransition(int from, int to) const;
 
     DigitalTriggerState triggerState() {return mTriggerState;}
     void setTriggerState(DigitalTriggerState triggerState);
@@ -73,6 +78,14 @@ public:
 
     void setState(int index, bool state);
     void toogleState(int index);
+    void setStates(int from, int to, bool high);
+    void invertStates(int from, int to);
+    void repeatStates(int from, int length, int to);
+    void generateClock(int from, int to, int numHigh, int numLow, bool startHigh);
+
+    // UART output that replaces the states when the signals are streamed
+    const UartStream &uartStream() const {return mUartStream;}
+    void setUartStream(const UartStream &stream) {mUartStream = stream;}
 
     QString toSettingsString();
     static DigitalSignal fromSettingsString(QString &settings);
@@ -88,7 +101,7 @@ private:
 
     int mId;
     QString mName;
-    QVector<bool> mData;
+    QVector<quint32> mData;
 
     // ##### Capture properties #######
 
@@ -97,6 +110,11 @@ private:
     // ##### Generator properties #####
 
     int mNumStates;
+    UartStream mUartStream;
+
+    quint32 readBits(int pos) const;
+    void writeBits(int pos, quint32 bits, int count);
+    void copyStates(int src, int dst, int count);
     
 };
 
@@ -0,0 +1,231 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "digitaltransitions.h"
+
+#include <QtAlgorithms>
+
+/*!
+    \class DigitalTransitions
+    \brief The transitions of one digital signal in compact form.
+
+    \ingroup Device
+
+    The DigitalTransitions class stores the sample indexes where a digital
+    signal changes level together with the signal's level at sample index 0
+    and the last sample index of the data.
+
+    A capture at a high sample rate can contain millions of transitions so
+    they are stored as the distance to the previous transition using as few
+    bytes as needed, normally only one. The transitions are divided into
+    blocks of a fixed number of transitions and the sample index of the
+    first transition in each block is stored separately. Reading transition
+    \c i only has to decode the transitions before it in the same block and
+    searching for a sample index is a binary search among the blocks
+    followed by a search within one block.
+
+    Iterate with const_iterator to read consecutive transitions as that only
+    decodes each transition once.
+*/
+
+/*!
+    Constructs an empty list of transitions.
+*/
+DigitalTransitions::DigitalTransitions()
+{
+    mInitialLevel = 0;
+    mLastSampleIndex = -1;
+    mSize = 0;
+}
+
+/*!
+    Constructs the list of transitions in the digital signal \a data.
+*/
+DigitalTransitions::DigitalTransitions(const QVector<int> &data)
+{
+    mInitialLevel = 0;
+    mLastSampleIndex = data.size()-1;
+    mSize = 0;
+
+    if (data.isEmpty()) {
+        return;
+    }
+
+    int val = data.at(0);
+    SampleIndex previous = 0;
+    mInitialLevel = val;
+
+    for (int i = 1; i < data.size(); i++) {
+        if (data.at(i) != val) {
+            append(i, previous);
+            val = data.at(i);
+        }
+    }
+
+    mBlockStart.squeeze();
+    mBlockOffset.squeeze();
+    mData.squeeze();
+}
+
+/*!
+    \fn int DigitalTransitions::initialLevel() const
+
+    Returns the logic level of the signal at sample index 0.
+*/
+
+/*!
+    \fn SampleIndex DigitalTransitions::lastSampleIndex() const
+
+    Returns the last sample index of the signal data even if there isn't a
+    transition at that index.
+*/
+
+/*!
+    \fn int DigitalTransitions::size() const
+
+    Returns the number of transitions.
+*/
+
+/*!
+    Returns the sample index of transition \a i which must be less than
+    size().
+*/
+SampleIndex DigitalTransitions::at(int i) const
+{
+    return *iteratorAt(i);
+}
+
+/*!
+    Returns the number of the first transition at or after \a sampleIdx, or
+    size() if there is none.
+*/
+int DigitalTransitions::lowerBound(SampleIndex sampleIdx) const
+{
+    // the last block starting before sampleIdx is the only one to search
+    int block = qLowerBound(mBlockStart.constBegin(), mBlockStart.constEnd(), sampleIdx)
+            - mBlockStart.constBegin() - 1;
+    if (block < 0) {
+        return 0;
+    }
+
+    const_iterator it = iteratorAt(block*BlockSize);
+    int blockEnd = qMin((block+1)*BlockSize, mSize);
+    while (it.index() < blockEnd && *it < sampleIdx) {
+        ++it;
+    }
+
+    return qMin(it.index(), blockEnd);
+}
+
+/*!
+    Returns the logic level of the signal at \a sampleIdx.
+*/
+int DigitalTransitions::levelAt(SampleIndex sampleIdx) const
+{
+    if ((lowerBound(sampleIdx+1) % 2) == 0) {
+        return mInitialLevel;
+    }
+    return ((mInitialLevel + 1) % 2);
+}
+
+/*!
+    Returns an iterator positioned at transition \a i, or end() if \a i
+    is size().
+*/
+DigitalTransitions::const_iterator DigitalTransitions::iteratorAt(int i) const
+{
+    const_iterator it;
+    it.t = this;
+    it.i = i;
+
+    if (i < mSize) {
+        int block = i / BlockSize;
+        it.value = mBlockStart.at(block);
+        it.offset = mBlockOffset.at(block);
+        for (int j = block*BlockSize; j < i; j++) {
+            it.value += (SampleIndex)decodeVarint(mData.constData(), it.offset);
+        }
+    }
+
+    return it;
+}
+
+/*!
+    Returns the number of bytes used to store the transitions.
+*/
+int DigitalTransitions::memoryUsage() const
+{
+    return mData.size() + mBlockStart.size()*sizeof(SampleIndex) + mBlockOffset.size()*sizeof(int);
+}
+
+/*!
+    Moves the iterator to the next transition.
+*/
+DigitalTransitions::const_iterator &DigitalTransitions::const_iterator::operator++()
+{
+    i++;
+    if (i < t->mSize) {
+        if ((i % BlockSize) == 0) {
+            value = t->mBlockStart.at(i / BlockSize);
+            offset = t->mBlockOffset.at(i / BlockSize);
+        }
+        else {
+            value += (SampleIndex)decodeVarint(t->mData.constData(), offset);
+        }
+    }
+    return *this;
+}
+
+/*!
+    Adds a transition at \a sampleIdx. The \a previous sample index is
+    updated.
+*/
+void DigitalTransitions::append(SampleIndex sampleIdx, SampleIndex &previous)
+{
+    if ((mSize % BlockSize) == 0) {
+        mBlockStart.append(sampleIdx);
+        mBlockOffset.append(mData.size());
+    }
+    else {
+        appendVarint(mData, sampleIdx - previous);
+    }
+
+    previous = sampleIdx;
+    mSize++;
+}
+
+/*!
+    \fn quint64 DigitalTransitions::decodeVarint(const quint8* data, int &offset)
+
+    Decodes one value from \a data at \a offset and moves \a offset to the
+    next one.
+
+    \sa appendVarint()
+*/
+
+/*!
+    Appends \a value to \a data using as few bytes as needed, 7 bits per
+    byte with the most significant bit set in all but the last byte.
+
+    \sa decodeVarint()
+*/
+void DigitalTransitions::appendVarint(QVector<quint8> &data, quint64 value)
+{
+    while (value >= 0x80) {
+        data.append((quint8)(0x80 | (value & 0x7f)));
+        value >>= 7;
+    }
+    data.append((quint8)value);
+}
@@ -0,0 +1,105 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef DIGITALTRANSITIONS_H
+#define DIGITALTRANSITIONS_H
+
+#include <QVector>
+
+#include "common/sampleindex.h"
+
+class DigitalTransitions
+{
+public:
+
+    class const_iterator
+    {
+    public:
+        const_iterator() : t(0), i(0), value(0), offset(0) {}
+
+        SampleIndex operator*() const {return value;}
+        int index() const {return i;}
+        const_iterator &operator++();
+        bool operator==(const const_iterator &other) const {return i == other.i;}
+        bool operator!=(const const_iterator &other) const {return i != other.i;}
+
+    private:
+        friend class DigitalTransitions;
+
+        const DigitalTransitions* t;
+        int i;
+        SampleIndex value;
+        int offset;
+    };
+
+    DigitalTransitions();
+    explicit DigitalTransitions(const QVector<int> &data);
+
+    int initialLevel() const {return mInitialLevel;}
+    SampleIndex lastSampleIndex() const {return mLastSampleIndex;}
+    int size() const {return mSize;}
+
+    SampleIndex at(int i) const;
+    int lowerBound(SampleIndex sampleIdx) const;
+    int levelAt(SampleIndex sampleIdx) const;
+
+    const_iterator begin() const {return iteratorAt(0);}
+    const_iterator end() const {return iteratorAt(mSize);}
+    const_iterator iteratorAt(int i) const;
+
+    int memoryUsage() const;
+
+    // the compact form of a value, also used by DigitalEdgeIndex
+    static void appendVarint(QVector<quint8> &data, quint64 value);
+    static quint64 decodeVarint(const quint8* data, int &offset);
+
+private:
+
+    enum {
+        BlockSize = 64
+    };
+
+    int mInitialLevel;
+    SampleIndex mLastSampleIndex;
+    int mSize;
+
+    // sample index of the first transition in each block
+    QVector<SampleIndex> mBlockStart;
+    // position in mData of the second transition in each block
+    QVector<int> mBlockOffset;
+    // the distance to the previous transition, 7 bits per byte with
+    // the most significant bit set in all but the last byte
+    QVector<quint8> mData;
+
+    void append(SampleIndex sampleIdx, SampleIndex &previous);
+};
+
+// inline as it is called for every transition that is read
+inline quint64 DigitalTransitions::decodeVarint(const quint8* data, int &offset)
+{
+    quint64 v = 0;
+    int shift = 0;
+    quint8 b;
+
+    do {
+        b = data[offset++];
+        v |= (quint64)(b & 0x7f) << shift;
+        shift += 7;
+    } while (b & 0x80);
+
+    return v;
+}
+
+#endif // DIGITALTRANSITIONS_H
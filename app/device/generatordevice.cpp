@@ -110,6 +110,13 @@ GeneratorDevice::~GeneratorDevice()
     be generated for an analog signal.
 */
 
+/*!
+    \fn virtual bool GeneratorDevice::supportsUartStreams() const
+
+    Returns true if the device can output the UART stream of a digital
+    signal (see DigitalSignal::uartStream) instead of its states.
+*/
+
 
 /*!
     Returns a list of supported analog waveforms that can be generated
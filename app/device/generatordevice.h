@@ -41,6 +41,8 @@ public:
     virtual int minAnalogRate() const {return 1;}
 
     virtual double maxAnalogAmplitude() const {return 5;}
+
+    virtual bool supportsUartStreams() const {return false;}
     virtual QList<AnalogSignal::AnalogWaveform> supportedAnalogWaveforms();
 
     void enableDigitalGenerator(bool enable);
@@ -76,6 +76,24 @@ LabToolCalibrationData::LabToolCalibrationData(const quint8 *data)
             }
         }
     }
+    // Calculate the factors for the analog outputs the same way as the
+    // LabTool Hardware does:
+    //
+    //   A = (Vout1 - Vout2*hex1/hex2)/(1 - hex1/hex2)
+    //   B = (Vout2 - A)/hex2
+    //
+    // A DAC value is then calculated as (Vout - A)/B
+    double hex1 = mRawResult.dacValOut[0];
+    double hex2 = mRawResult.dacValOut[2];
+    for (int ch = 0; ch < 2; ch++)
+    {
+        // convert mV to V
+        double vout1 = mRawResult.userOut[ch][0] / 1000.0;
+        double vout2 = mRawResult.userOut[ch][2] / 1000.0;
+
+        mDacCalibA[ch] = (vout1 - (vout2*hex1/hex2)) / (1 - (hex1/hex2));
+        mDacCalibB[ch] = (vout2 - mDacCalibA[ch]) / hex2;
+    }
 }
 
 /*!
@@ -168,6 +186,18 @@ bool LabToolCalibrationData::isInfiniteOrNan(double d)
     it's Volt/div setting \a voltsPerDivIndex
 */
 
+/*!
+    \fn double LabToolCalibrationData::analogOutFactorA()
+
+    Returns the A factor for analog output channel \a ch
+*/
+
+/*!
+    \fn double LabToolCalibrationData::analogOutFactorB()
+
+    Returns the B factor for analog output channel \a ch
+*/
+
 /*!
     \fn const quint8* LabToolCalibrationData::rawCalibrationData()
 
@@ -45,6 +45,8 @@ private:
 
     double mCalibA[2][8];
     double mCalibB[2][8];
+    double mDacCalibA[2];
+    double mDacCalibB[2];
     calib_result mRawResult;
     bool mReasonableData;
 
@@ -59,6 +61,9 @@ public:
     double analogFactorA(int ch, int voltsPerDivIndex) { return mCalibA[ch][voltsPerDivIndex]; }
     double analogFactorB(int ch, int voltsPerDivIndex) { return mCalibB[ch][voltsPerDivIndex]; }
 
+    double analogOutFactorA(int ch) { return mDacCalibA[ch]; }
+    double analogOutFactorB(int ch) { return mDacCalibB[ch]; }
+
     const quint8* rawCalibrationData() { return (const quint8*)&mRawResult; }
 
     bool isDefaultData() { return (mRawResult.checksum == 0x00dead00 || mRawResult.version == 0x00dead00); }
@@ -21,6 +21,12 @@
 
 #include "labtoolcalibrationwizard.h"
 
+/*!
+    Value of the trigger sample reported by the LabTool Hardware when it could
+    not locate the exact trigger position.
+*/
+#define TRIG_SAMPLE_UNKNOWN     0xffffffff
+
 
 /*! @brief Configuration for digital signal capture.
  * This is part of the \ref capture_cfg_t structure that the client software
@@ -93,6 +99,24 @@ typedef struct
    *  22-31 | Reserved
    */
   uint32_t triggerSetup;
+
+  /*! @brief Pattern and sequence trigger.
+   *
+   * One word per stage, each encoded with \ref CAPTURE_PATTERN_STAGE. With
+   * only the first stage enabled it is a pattern trigger and with both it
+   * is a sequence trigger. Cannot be combined with \a enabledTriggers.
+   *
+   * Bit assignment:
+   *
+   *  Bits  | Description
+   *  :---: | -----------
+   *   0-10 | Signals that must match (DIO_0 to DIO_CLK)
+   *  11-15 | Reserved
+   *  16-26 | Wanted level for each signal that must match
+   *  27-30 | Reserved
+   *   31   | 1 = stage is used
+   */
+  uint32_t triggerPattern[CAPTURE_PATTERN_MAX_STAGES];
 } cap_sgpio_cfg_t;
 
 /*! \brief Configuration for analog signal capture.
@@ -228,12 +252,39 @@ LabToolCaptureDevice::LabToolCaptureDevice(QObject *parent) :
     mTriggerConfig = new UiLabToolTriggerConfig();
     mConfigMustBeUpdated = true;
 
+    // Deallocation: Destructor is responsible
+    mDiagnostics = new UiLabToolDiagnostics();
+
+    // The samples are unpacked in a separate thread while they are received
+    qRegisterMetaType<LabToolUnpackedSamples>("LabToolUnpackedSamples");
+    // Deallocation: Destructor is responsible
+    mUnpacker = new LabToolSampleUnpacker();
+    // Deallocation: Destructor is responsible
+    mUnpackThread = new QThread();
+    mUnpacker->moveToThread(mUnpackThread);
+    connect(mUnpacker, SIGNAL(samplesUnpacked(LabToolUnpackedSamples)),
+            this, SLOT(handleReceivedSamples(LabToolUnpackedSamples)));
+    mUnpackThread->start();
+
+    // Deallocation: Destructor is responsible
+    mPreviewUnpacker = new LabToolSampleUnpacker();
+    connect(mPreviewUnpacker, SIGNAL(samplesUnpacked(LabToolUnpackedSamples)),
+            this, SLOT(handleUnpackedPreview(LabToolUnpackedSamples)));
+    mPreviewStep = 1;
+
     mDeviceComm = NULL;
     mEndSampleIdx = 0;
     mTriggerIndex = 0;
+    mDigitalDepth = 0;
+    mAnalogDepth = 0;
+    mDepthMustBeUpdated = false;
     mReconfigTimer = NULL;
+    mMonitoring = false;
+    mMonitorUpdateTimer = NULL;
     mRunningCapture = false;
     mReconfigurationRequested = false;
+    mAnalogUpdatesSent = 0;
+    mAnalogUpdatesApplied = 0;
     mWarnUncalibrated = true;
     mRequestedSampleRate = -1;
     mLastUsedSampleRate = -2;
@@ -262,6 +313,11 @@ LabToolCaptureDevice::~LabToolCaptureDevice()
         delete mReconfigTimer;
     }
 
+    if (mMonitorUpdateTimer != NULL) {
+        mMonitorUpdateTimer->stop();
+        delete mMonitorUpdateTimer;
+    }
+
     for (int i = 0; i < MaxAnalogSignals; i++) {
         if (mAnalogSignals[i] != NULL) {
             delete mAnalogSignals[i];
@@ -280,7 +336,14 @@ LabToolCaptureDevice::~LabToolCaptureDevice()
         }
     }
 
+    mUnpackThread->quit();
+    mUnpackThread->wait();
+    delete mUnpacker;
+    delete mUnpackThread;
+    delete mPreviewUnpacker;
+
     delete mTriggerConfig;
+    delete mDiagnostics;
 }
 
 QList<int> LabToolCaptureDevice::supportedSampleRates()
@@ -389,6 +452,19 @@ void LabToolCaptureDevice::calibrate(QWidget *parent)
     }
 }
 
+/*!
+    Shows the \ref UiLabToolDiagnostics dialog with the telemetry from the
+    latest capture. The dialog is updated after each capture while it is open.
+*/
+void LabToolCaptureDevice::showDiagnostics(QWidget *parent)
+{
+    (void)parent; // To avoid warning about unused parameter
+
+    mDiagnostics->show();
+    mDiagnostics->raise();
+    mDiagnostics->activateWindow();
+}
+
 /*!
     Removes \a numToRemove elements from the \a s list of signal samples.
     The parameter \a removeFromStart dictates if the samples should be
@@ -422,9 +498,21 @@ void LabToolCaptureDevice::trimSignalData(QVector<T> *s, int numToRemove, bool r
 template <typename T>
 void LabToolCaptureDevice::compensateForAnalogHardware(QVector<T> *s, bool isAnalogSignal) const
 {
-    if (!mAnalogSignalList.isEmpty() && !mDigitalSignalList.isEmpty()) {
-        int numToRemove = 0;
+    int numToRemove = analogHardwareDelay();
+    if (numToRemove > 0) {
+        trimSignalData(s, numToRemove, !isAnalogSignal);
+    }
+}
 
+/*!
+    Returns the number of samples that \ref compensateForAnalogHardware
+    removes from the signals with the current sample rate and signals.
+*/
+int LabToolCaptureDevice::analogHardwareDelay() const
+{
+    int numToRemove = 0;
+
+    if (!mAnalogSignalList.isEmpty() && !mDigitalSignalList.isEmpty()) {
         // The delay is roughly 200ns but was adjusted in detail using an
         // external oscilloscope. As there is a limit on maximum sample
         // rate when sampling both analog and digital signals of 20MHz
@@ -436,9 +524,8 @@ void LabToolCaptureDevice::compensateForAnalogHardware(QVector<T> *s, bool isAna
         case 10000000: numToRemove = 4; break;
         case 20000000: numToRemove = 5; break;
         }
-
-        trimSignalData(s, numToRemove, !isAnalogSignal);
     }
+    return numToRemove;
 }
 
 /*!
@@ -626,6 +713,22 @@ LocateAnalogLowHighTransition_restart_comp:
     return -1;
 }
 
+/*!
+    Returns true if the two consecutive analog samples \a prev and \a cur
+    cross \a trigLevel in the direction given by \a trigState. The
+    \a tolerance allows for the rounding in converting the 12-bit trigger
+    level used by the LabTool Hardware into volts.
+*/
+bool LabToolCaptureDevice::isAnalogTrigger(double prev, double cur, AnalogSignal::AnalogTriggerState trigState, double trigLevel, double tolerance)
+{
+    if (trigState == AnalogSignal::AnalogTriggerHighLow) {
+        return (prev >= trigLevel - tolerance && cur <= trigLevel + tolerance && cur < prev);
+    } else if (trigState == AnalogSignal::AnalogTriggerLowHigh) {
+        return (prev <= trigLevel + tolerance && cur >= trigLevel - tolerance && cur > prev);
+    }
+    return false;
+}
+
 /*!
     Scans the list of calibrated (double format) analog samples specified
     by the \a s parameter from start to end looking for the specified
@@ -684,43 +787,273 @@ int LabToolCaptureDevice::locateTransition(QVector<double> *s, AnalogSignal::Ana
 }
 
 /*!
-    Converts the signal data received for digital signals from the LabTool Hardware
-    into the format used by this application.
+    Returns true if there is a digital edge of type \a trigger in the
+    samples \a s at index \a pos, i.e. if sample \a pos is the first one
+    with the new level.
+*/
+bool LabToolCaptureDevice::isDigitalTrigger(QVector<int> *s, DigitalSignal::DigitalTriggerState trigger, int pos)
+{
+    if (pos < 1 || pos >= s->size()) {
+        return false;
+    }
 
-    Input format:
+    switch (trigger) {
+    case DigitalSignal::DigitalTriggerHighLow:
+        return (s->at(pos-1) == 1 && s->at(pos) == 0);
+    case DigitalSignal::DigitalTriggerLowHigh:
+        return (s->at(pos-1) == 0 && s->at(pos) == 1);
+    default:
+        return false;
+    }
+}
 
-    \dot
-     digraph structs {
-         node [shape=record];
-         start [label="DIO0 | DIO1 | ... | DIOn | DIO0 | ..."];
-     }
-     \enddot
+/*!
+    Searches the list of digital samples \a s for an edge of type \a trigger
+    that is closest to \a estimatedIdx. This is used when the LabTool Hardware
+    could not report the exact trigger position. The index of the edge is
+    returned or if no edge could be found the current trigger index.
+*/
+int LabToolCaptureDevice::locateDigitalTrigger(QVector<int> *s, DigitalSignal::DigitalTriggerState trigger, int estimatedIdx)
+{
+    int bestIdx = (int)mTriggerIndex;
+    int pos = 0;
+    switch (trigger) {
+    // Falling edge
+    case DigitalSignal::DigitalTriggerHighLow:
+        pos = locateFirstLevel(s, 1, estimatedIdx-20);
+        if (pos != -1) {
+            pos = locateFirstLevel(s, 0, pos);
+            if (pos != -1) {
+                // found first possible trigger past the estimatedIdx location
+                bestIdx = pos;
+                //qDebug("Found High->Low at %d, (+%d from %d)", pos, pos - estimatedIdx, estimatedIdx);
+            }
+        }
+        pos = locatePreviousLevel(s, 0, estimatedIdx+20);
+        if (pos != -1) {
+            pos = locatePreviousLevel(s, 1, pos);
+            if (pos != -1) {
+                pos++;
+                //qDebug("Found High->Low at %d, (%d from %d)", pos, pos - estimatedIdx, estimatedIdx);
 
-    Each box is a 32-bit value containing 32 digital samples for that channel.
-    the \a n value is the highest enabled channel number. If only DIO4 is
-    enabled then the positions for DIO0, DIO1, DIO2 and DIO3 will still be
-    present but with invalid data.
+                // found last trigger before the estimatedIdx location
+                if (abs(pos-estimatedIdx) < abs(bestIdx-estimatedIdx)) {
+                    // this trigger is the closest one to the estimatedIdx location
+                    bestIdx = pos;
+                }
+            }
+        }
+        break;
 
-    The \a pData parameter is a pointer to the data, \a size is the number of
-    bytes of data.
+        // Rising edge
+    case DigitalSignal::DigitalTriggerLowHigh:
+        pos = locateFirstLevel(s, 0, estimatedIdx-20);
+        if (pos != -1) {
+            pos = locateFirstLevel(s, 1, pos);
+            if (pos != -1) {
+                // found first possible trigger past the estimatedIdx location
+                bestIdx = pos;
+                //qDebug("Found Low->High at %d, (+%d from %d)", pos, pos - estimatedIdx, estimatedIdx);
+            }
+        }
+        pos = locatePreviousLevel(s, 1, estimatedIdx+20);
+        if (pos != -1) {
+            pos = locatePreviousLevel(s, 0, pos);
+            if (pos != -1) {
+                pos++;
+                //qDebug("Found Low->High at %d, (%d from %d)", pos, pos - estimatedIdx, estimatedIdx);
 
-    The \a activeChannels parameter has two parts: The 16 MSB holds
+                // found last trigger before the estimatedIdx location
+                if (abs(pos-estimatedIdx) < abs(bestIdx-estimatedIdx)) {
+                    // this trigger is the closest one to the estimatedIdx location
+                    bestIdx = pos;
+                }
+            }
+        }
+        break;
+
+        // High level
+#if 0 // disabling high level and low level as trigger levels
+    case DigitalSignal::DigitalTriggerHigh:
+        pos = locateFirstLevel(s, 1, estimatedIdx-20);
+        if (pos != -1) {
+            // found first possible trigger past the estimatedIdx location
+            bestIdx = pos;
+        }
+        pos = locatePreviousLevel(s, 1, estimatedIdx+20);
+        if (pos != -1) {
+            // found last trigger before the estimatedIdx location
+            if (abs(pos-estimatedIdx) < abs(bestIdx-estimatedIdx)) {
+                // this trigger is the closest one to the estimatedIdx location
+                bestIdx = pos;
+            }
+        }
+        break;
+
+        // Low level
+    case DigitalSignal::DigitalTriggerLow:
+        pos = locateFirstLevel(s, 0, estimatedIdx-20);
+        if (pos != -1) {
+            // found first possible trigger past the estimatedIdx location
+            bestIdx = pos;
+        }
+        pos = locatePreviousLevel(s, 0, estimatedIdx+20);
+        if (pos != -1) {
+            // found last trigger before the estimatedIdx location
+            if (abs(pos-estimatedIdx) < abs(bestIdx-estimatedIdx)) {
+                // this trigger is the closest one to the estimatedIdx location
+                bestIdx = pos;
+            }
+        }
+        break;
+#endif
+        // Not a trigger
+    default:
+        break;
+    }
+
+    return bestIdx;
+}
+
+/*!
+    Fills in the \a stages of the pattern trigger configured in the
+    \ref UiLabToolTriggerConfig dialog, encoded as in \a cap_sgpio_cfg_t.
+    Unused stages are 0.
+*/
+void LabToolCaptureDevice::patternTriggerConfig(quint32 *stages)
+{
+    for (int i = 0; i < CAPTURE_PATTERN_MAX_STAGES; i++) {
+        quint32 care;
+        quint32 value;
+
+        stages[i] = 0;
+        if (mTriggerConfig->patternTriggerStage(i, &care, &value)) {
+            stages[i] = CAPTURE_PATTERN_STAGE(care, value);
+        }
+    }
+}
+
+/*!
+    Searches \a count samples of the digital signals, starting with sample
+    \a from, for the trigger in \a pattern. The search is done with the
+    same reference implementation that the LabTool Hardware's search is
+    checked against. Returns the index of the trigger sample or -1 if not
+    found.
+*/
+int LabToolCaptureDevice::locatePatternStart(const capture_pattern_t* pattern, int from, int count)
+{
+    int size = (int)(mEndSampleIdx + 1);
+    for (int id = 0; id < MaxDigitalSignals; id++) {
+        if (mDigitalSignals[id] != NULL) {
+            size = qMin(size, mDigitalSignals[id]->size());
+        }
+    }
+
+    from = qMax(0, from);
+    count = qMin(count, size - from);
+    if (count <= 0) {
+        return -1;
+    }
+
+    // one word per sample with the levels of all signals
+    QVector<quint32> levels(count, 0);
+    for (int id = 0; id < MaxDigitalSignals; id++) {
+        QVector<int>* s = mDigitalSignals[id];
+        if (s == NULL) continue;
+
+        for (int i = 0; i < count; i++) {
+            if (s->at(from + i) != 0) {
+                levels[i] |= (1<<id);
+            }
+        }
+    }
+
+    quint32 pos = capture_pattern_Reference(pattern, levels.constData(), count);
+    if (pos == CAPTURE_PATTERN_NOT_FOUND) {
+        return -1;
+    }
+    return from + (int)pos;
+}
+
+/*!
+    Locates the sample where the pattern (or the last pattern of a sequence)
+    configured in \ref UiLabToolTriggerConfig starts. The exact \a trigSample
+    reported by the LabTool Hardware is used if it can be verified, otherwise
+    the samples from \a estimatedIdx and on are searched. Returns the
+    index of the trigger or the current trigger index if not found.
+*/
+int LabToolCaptureDevice::locatePatternTrigger(quint32 trigSample, int estimatedIdx)
+{
+    capture_pattern_t pattern;
+    quint32 stages[CAPTURE_PATTERN_MAX_STAGES];
+    quint32 enabledSignals = 0;
+
+    for (int id = 0; id < MaxDigitalSignals; id++) {
+        if (mDigitalSignals[id] != NULL) {
+            enabledSignals |= (1<<id);
+        }
+    }
+
+    patternTriggerConfig(stages);
+    if (capture_pattern_Init(&pattern, stages, enabledSignals) != 0) {
+        return (int)mTriggerIndex;
+    }
+
+    // The earlier stages of a sequence have already been found by the
+    // hardware and may be far from the trigger so only the last one is
+    // searched for.
+    int last = pattern.numStages - 1;
+    pattern.care[0] = pattern.care[last];
+    pattern.value[0] = pattern.value[last];
+    pattern.numStages = 1;
+
+    if (trigSample != TRIG_SAMPLE_UNKNOWN) {
+        // The pattern must not match on the sample before the trigger
+        int pos = (int)trigSample - analogHardwareDelay();
+        if (pos > 0 && locatePatternStart(&pattern, pos-1, 2) == pos) {
+            return pos;
+        }
+    }
+
+    int pos = locatePatternStart(&pattern, estimatedIdx-20, (int)(mEndSampleIdx + 1));
+    return (pos == -1) ? (int)mTriggerIndex : pos;
+}
+
+/*!
+    Converts the signal data received for digital signals from the LabTool Hardware
+    into the format used by this application.
+
+    The \a samples have already been unpacked into one list of values per
+    channel by the \ref LabToolSampleUnpacker while they were received.
+
+    The \a samples.activeDigital value has two parts: The 16 MSB holds
     the number of channels with values in the data, the 16 LSB holds a bitmask
-    where each channel with valid data has a bit set. In the previous example
-    with only DIO4 enabled \a activeChannels would have the value \a 0x00050020.
+    where each channel with valid data has a bit set. With only DIO4 enabled
+    it would have the value \a 0x00050020.
 
-    The \a trig parameter holds the id of the channel that caused the trigger.
+    The \a samples.trigger value holds the id of the channel that caused the trigger.
 
-    The \a digitalTrigSample parameter holds the current sample index at the
-    time of triggering. The \a signalTrim parameter is used to discard a number
+    The \a samples.digitalTrigSample value holds the current sample index at the
+    time of triggering. The \a samples.signalTrim value is used to discard a number
     of samples from the start (signalTrim < 0) or end of the data to compensate
     for the fact that the analog and digital samplings are stopped at slightly
     different times.
+
+    The \a samples.trigSample value is the exact trigger sample as found by the
+    LabTool Hardware or \ref TRIG_SAMPLE_UNKNOWN. When it is known the
+    trigger is placed there directly, otherwise the samples around
+    \a samples.digitalTrigSample are searched. With a pattern trigger
+    that is done by \ref locatePatternTrigger once all signals have been
+    converted.
 */
-void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size, quint32 activeChannels, quint32 trig, int digitalTrigSample, int signalTrim)
+void LabToolCaptureDevice::convertDigitalInput(const LabToolUnpackedSamples &samples)
 {
-    quint32* samples = (quint32*)pData;
-    int signalsInInput = activeChannels >> 16;
+    quint32 activeChannels = samples.activeDigital;
+    quint32 trig = samples.trigger;
+    int digitalTrigSample = samples.digitalTrigSample;
+    int signalTrim = samples.signalTrim;
+    quint32 trigSample = samples.trigSample;
+    bool patternTrigger = (mTriggerConfig->patternTriggerStages() > 0);
 
     foreach(DigitalSignal* signal, mDigitalSignalList) {
         int id = signal->id();
@@ -729,20 +1062,10 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
         int slice = id;//GetSliceForId(id, activeChannels);
         if ((activeChannels & (1<<slice)) == 0) continue; // got no data for this channel from target
 
-        int sampleGroups = (size/(signalsInInput*4));
-
         // Deallocation:
         //   QVector will be deallocated either by this function or the destructor
         //   as a part of deallocating mDigitalSignals
-        QVector<int> *s = new QVector<int>();
-
-        for(int j = 0; j < sampleGroups; ++j) {
-            quint32 val = samples[j*signalsInInput + slice];
-            for (int k = 0; k < 32; k++) {
-                s->append(val & 1);
-                val = val >> 1;
-            }
-        }
+        QVector<int> *s = new QVector<int>(samples.digital.at(slice));
 
         // Compensate for the delay in the analog hardware so that the analog and digital signals line up.
         compensateForAnalogHardware(s, false);
@@ -756,107 +1079,23 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
         }
 
 
-        if (((int)trig) == id)
+        if (!patternTrigger && ((int)trig) == id)
         {
             // this signal was the trigger
             DigitalSignal::DigitalTriggerState trigger = signal->triggerState();
 
-            int pos = 0;
-            switch (trigger) {
-            // Falling edge
-            case DigitalSignal::DigitalTriggerHighLow:
-                pos = locateFirstLevel(s, 1, digitalTrigSample-20);
-                if (pos != -1) {
-                    pos = locateFirstLevel(s, 0, pos);
-                    if (pos != -1) {
-                        // found first possible trigger past the digitalTrigSample location
-                        mTriggerIndex = pos;
-                        //qDebug("Found High->Low at %d, (+%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
-                    }
-                }
-                pos = locatePreviousLevel(s, 0, digitalTrigSample+20);
-                if (pos != -1) {
-                    pos = locatePreviousLevel(s, 1, pos);
-                    if (pos != -1) {
-                        pos++;
-                        //qDebug("Found High->Low at %d, (%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
-
-                        // found last trigger before the digitalTrigSample location
-                        if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
-                            // this trigger is the closest one to the digitalTrigSample location
-                            mTriggerIndex = pos;
-                        }
-                    }
-                }
-                break;
-
-                // Rising edge
-            case DigitalSignal::DigitalTriggerLowHigh:
-                pos = locateFirstLevel(s, 0, digitalTrigSample-20);
-                if (pos != -1) {
-                    pos = locateFirstLevel(s, 1, pos);
-                    if (pos != -1) {
-                        // found first possible trigger past the digitalTrigSample location
-                        mTriggerIndex = pos;
-                        //qDebug("Found Low->High at %d, (+%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
-                    }
-                }
-                pos = locatePreviousLevel(s, 1, digitalTrigSample+20);
-                if (pos != -1) {
-                    pos = locatePreviousLevel(s, 0, pos);
-                    if (pos != -1) {
-                        pos++;
-                        //qDebug("Found Low->High at %d, (%d from %d)", pos, pos - digitalTrigSample, digitalTrigSample);
-
-                        // found last trigger before the digitalTrigSample location
-                        if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
-                            // this trigger is the closest one to the digitalTrigSample location
-                            mTriggerIndex = pos;
-                        }
-                    }
-                }
-                break;
-
-                // High level
-#if 0 // disabling high level and low level as trigger levels
-            case DigitalSignal::DigitalTriggerHigh:
-                pos = locateFirstLevel(s, 1, digitalTrigSample-20);
-                if (pos != -1) {
-                    // found first possible trigger past the digitalTrigSample location
-                    mTriggerIndex = pos;
-                }
-                pos = locatePreviousLevel(s, 1, digitalTrigSample+20);
-                if (pos != -1) {
-                    // found last trigger before the digitalTrigSample location
-                    if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
-                        // this trigger is the closest one to the digitalTrigSample location
-                        mTriggerIndex = pos;
-                    }
-                }
-                break;
-
-                // Low level
-            case DigitalSignal::DigitalTriggerLow:
-                pos = locateFirstLevel(s, 0, digitalTrigSample-20);
-                if (pos != -1) {
-                    // found first possible trigger past the digitalTrigSample location
-                    mTriggerIndex = pos;
-                }
-                pos = locatePreviousLevel(s, 0, digitalTrigSample+20);
-                if (pos != -1) {
-                    // found last trigger before the digitalTrigSample location
-                    if (abs(pos-digitalTrigSample) < abs(mTriggerIndex-digitalTrigSample)) {
-                        // this trigger is the closest one to the digitalTrigSample location
-                        mTriggerIndex = pos;
-                    }
-                }
-                break;
-#endif
-                // Not a trigger
-            default:
-                break;
+            // The hardware reports the exact trigger sample (before
+            // compensating for the analog hardware) so only verify it and
+            // fall back to searching if it is missing or not an edge.
+            int pos = -1;
+            if (trigSample != TRIG_SAMPLE_UNKNOWN) {
+                pos = (int)trigSample - analogHardwareDelay();
+            }
+            if (isDigitalTrigger(s, trigger, pos)) {
+                mTriggerIndex = pos;
+            } else {
+                mTriggerIndex = locateDigitalTrigger(s, trigger, digitalTrigSample);
             }
-
         }
 
         if (mDigitalSignals[id] != NULL) {
@@ -867,58 +1106,24 @@ void LabToolCaptureDevice::convertDigitalInput(const quint8 *pData, quint32 size
         mEndSampleIdx = s->size()-1;
         //qDebug("D%d: %d samples", id, s->size());
     }
+
+    if (patternTrigger) {
+        // the trigger is a combination of all signals
+        mTriggerIndex = locatePatternTrigger(trigSample, digitalTrigSample);
+    }
 }
 
 /*!
-    Converts the signal data received for analog signals from the LabTool Hardware
-    into two lists of integer values, one for each channel.
-
-    Input format:
-
-    \dot
-     digraph structs {
-         node [shape=record];
-         start [label="A0 | A1 | A0 | ..."];
-     }
-     \enddot
-
-    Each box is a 16-bit value containing one analog samples for that channel.
-    If only one channel is enabled then only that channel's data will be present.
-    Each 16-bit value is also marked with information about which channel
-    the data is for.
-
-    The \a pData parameter is a pointer to the data, \a size is the number of
-    bytes of data.
-
-    The \a activeChannels parameter has two parts: The 16 MSB holds
-    the number of channels with values in the data, the 16 LSB holds a bitmask
-    where each channel with valid data has a bit set.
-
-    \todo Remove the \a activeChannels part of the protocol for analog signals?
-
-    At high sample rates the analog signal data can get corrupted. This is only
-    visible in the data when both analog channels are enabled and it will look
-    like this:
-
-    \dot
-     digraph structs {
-         node [shape=record];
-         start [label="A0 | A1 | A0 | A0 | A1 | ..."];
-     }
-     \enddot
-
-     This function detects the double values and inserts a value for the
-     missing channel. In the example above channel A1 would get an extra value
-     inserted. The reason for inserting extra value(s) is to at least keep the
-     signals identical in length.
+    Takes the analog signal data that the \ref LabToolSampleUnpacker has
+    unpacked into two lists of integer values, one for each channel, from
+    \a samples and prepares it for the conversion.
 
-     One problem is that the double A0 could hide either one missing A1 value
-     or one A1 and any number of A0+A1 samples. It is impossible to know.
+    When both channels have been sampled they are made the same length
+    and at high sample rates the crosstalk between the channels is
+    compensated for.
 */
-void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels)
+void LabToolCaptureDevice::unpackAnalogInput(const LabToolUnpackedSamples &samples)
 {
-    quint16* samples = (quint16*)pData;//PACKED
-
     for (int i = 0; i < MaxAnalogSignals; i++) {
         if (mAnalogSignalData[i] != NULL) {
             delete mAnalogSignalData[i];
@@ -926,75 +1131,15 @@ void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size,
         mAnalogSignalData[i] = NULL;
     }
 
-#define A0_CH_ID  (0)  // Mapping of A0 to the VADC channel number in fw
-#define A1_CH_ID  (1)  // Mapping of A1 to the VADC channel number in fw
-
-    // This is adjusted unpacking of the data. If an EMPTY marker is found, it is not treated
-    // as data and is instead discarded. If two channels are sampled and two consecutive
-    // samples for the same channel is found then an additional sample is inserted in the other
-    // channel to make up for the missing one. The id bits of each sample is also read to make
-    // sure that the samples end up on the correct signal's vector (prevents signal swapping).
-
     // Deallocation:
     //   QVector will be deallocated either by this function or by deleteSignals,
     //   unpackAnalogInput or the destructor as a part of deallocating mAnalogSignalData
-    QVector<quint16> *s0 = new QVector<quint16>();
+    QVector<quint16> *s0 = new QVector<quint16>(samples.analog.at(0));
     // Deallocation:
     //   QVector will be deallocated either by this function or by deleteSignals,
     //   unpackAnalogInput or the destructor as a part of deallocating mAnalogSignalData
-    QVector<quint16> *s1 = new QVector<quint16>();
+    QVector<quint16> *s1 = new QVector<quint16>(samples.analog.at(1));
     int numChannels = mAnalogSignalList.size();
-    int lastId = -1;
-    int numSamples = size/2;
-    (void)activeChannels; // To avoid warning
-
-    // Sometimes the absolute first sample is invalid (channel id 0). If that is the
-    // case then discard that sample
-//    if (((*samples & 0x7000)>>12) == 0) {
-//        numSamples--;
-//        samples++;
-//    }
-
-    for (int i = 0; i < numSamples; i++)
-    {
-        int id = (*samples & 0x7000)>>12;
-        int empty = (*samples & 0x8000)>>15;
-        if (empty)
-        {
-            qDebug("Empty marker for i=%d", i);
-        }
-        else
-        {
-            if (id == lastId && numChannels>1)
-            {
-                // found a skip i.e. two consecutive samples for the same channel, add an extra sample for the other channel
-                if (id == A1_CH_ID)
-                {
-                    s0->append(s0->isEmpty() ? 0 : s0->last());
-                }
-                else
-                {
-                    s1->append(s1->isEmpty() ? 0 : s1->last());
-                }
-                qDebug("Skip at i=%d", i);
-            }
-
-            if (id == A1_CH_ID)
-            {
-                quint16 val = *samples;//PACKED
-                val = val & 0xfff;
-                s1->append(val);
-            }
-            else
-            {
-                quint16 val = *samples;//PACKED
-                val = val & 0xfff;
-                s0->append(val);
-            }
-            lastId = id;
-        }
-        samples++;
-    }
 
     // Make sure that the same amount of samples have been received for both channels.
     // This difference can only happen when two channels have been sampled and the
@@ -1056,34 +1201,33 @@ void LabToolCaptureDevice::unpackAnalogInput(const quint8 *pData, quint32 size,
     data contains no falling edge then false is returned.
 
     The conversion is done in three steps:
-    -# Use \ref unpackAnalogInput to creates one list of integer values per channel.
+    -# Use \ref unpackAnalogInput to get one list of integer values per channel
+       from the \a samples.
     -# Convert the integer values in to double values used by this application
     -# Scale the values according to each channel's Volts/div setting
 
-    The \a pData parameter is a pointer to the data, \a size is the number of
-    bytes of data.
-
-    The \a activeChannels parameter has two parts: The 16 MSB holds
-    the number of channels with values in the data, the 16 LSB holds a bitmask
-    where each channel with valid data has a bit set. In the previous example
-    with only DIO4 enabled \a activeChannels would have the value \a 0x00050020.
-
-    The \a trig parameter holds the id of the channel that caused the trigger.
-
-    The \a analogTrigSample parameter holds the current sample index at the
-    time of triggering. The \a signalTrim parameter is used to discard a number
+    The \a samples.analogTrigSample value holds the current sample index at the
+    time of triggering. The \a samples.signalTrim value is used to discard a number
     of samples from the start (signalTrim < 0) or end of the data to compensate
     for the fact that the analog and digital samplings are stopped at slightly
     different times.
+
+    The \a samples.trigSample value is the exact trigger sample as found by the
+    LabTool Hardware or \ref TRIG_SAMPLE_UNKNOWN. When it is known the
+    trigger is placed there directly, otherwise the samples around
+    \a samples.analogTrigSample are searched.
 */
-void LabToolCaptureDevice::convertAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels, quint32 trig, int analogTrigSample, int signalTrim)
+void LabToolCaptureDevice::convertAnalogInput(const LabToolUnpackedSamples &samples)
 {
-    (void)trig; // To avoid warning
+    int analogTrigSample = samples.analogTrigSample;
+    int signalTrim = samples.signalTrim;
+    quint32 trigSample = samples.trigSample;
+
     if (mAnalogSignalList.isEmpty()) {
         // nothing to do
         return;
     }
-    unpackAnalogInput(pData, size, activeChannels);
+    unpackAnalogInput(samples);
 
     LabToolCalibrationData* calib = mDeviceComm->storedCalibrationData();
 
@@ -1132,17 +1276,25 @@ void LabToolCaptureDevice::convertAnalogInput(const quint8 *pData, quint32 size,
                 highLevel = trigLevel + qAbs(b * mTriggerConfig->noiseFilter12BitLevel());
             }
 
-            if (signalTrim < 0) {
-                // Have removed abs(signalTrim) samples from the start of the data so the
-                // trigger point must be moved as well
+            // The hardware reports the exact trigger sample so only verify
+            // that the level is crossed there.
+            int pos = (trigSample != TRIG_SAMPLE_UNKNOWN) ? (int)trigSample : -1;
+            if (pos > 0 && pos < s->size() &&
+                    isAnalogTrigger(s->at(pos-1), s->at(pos), signal->triggerState(), trigLevel, qAbs(b))) {
+                mTriggerIndex = pos;
+            } else {
+                if (signalTrim < 0) {
+                    // Have removed abs(signalTrim) samples from the start of the data so the
+                    // trigger point must be moved as well
 
-                qDebug("analogTrigSample = %u, moved to %u", analogTrigSample, analogTrigSample-abs(signalTrim));
-                analogTrigSample -= abs(signalTrim);
-            }
+                    qDebug("analogTrigSample = %u, moved to %u", analogTrigSample, analogTrigSample-abs(signalTrim));
+                    analogTrigSample -= abs(signalTrim);
+                }
 
-            int pos = locateTransition(s, signal->triggerState(), lowLevel, trigLevel, highLevel, analogTrigSample);
-            if (pos != -1) {
-                mTriggerIndex = pos;
+                pos = locateTransition(s, signal->triggerState(), lowLevel, trigLevel, highLevel, analogTrigSample);
+                if (pos != -1) {
+                    mTriggerIndex = pos;
+                }
             }
         }
 
@@ -1181,13 +1333,24 @@ void LabToolCaptureDevice::start(int sampleRate)
     qDebug() << "LabToolCaptureDevice::start";
 
     mRunningCapture = true;
+    if (mTriggerConfig->isI2CMonitorEnabled()) {
+        startI2CMonitor();
+        return;
+    }
+    mMonitoring = false;
+
+    // The configuration (if changed) and the start of the capture is sent
+    // in one request, the samples are sent as the response
     if (hasConfigChanged()) {
         qDebug("Configuration has changed and will be pushed to target");
         saveConfig();
-        mDeviceComm->configureCapture(configSize(), configData());
+        mDepthMustBeUpdated = true;
+        mAnalogUpdatesSent = 0;
+        mAnalogUpdatesApplied = 0;
+        mDeviceComm->armCapture(configSize(), configData());
     } else {
         //qDebug("Configuration same as last time");
-        mDeviceComm->runCapture();
+        mDeviceComm->armCapture();
     }
 }
 
@@ -1196,14 +1359,33 @@ void LabToolCaptureDevice::stop()
     qDebug() << "LabToolCaptureDevice::stop";
     mReconfigurationRequested = false;
     mRunningCapture = false;
-    mDeviceComm->stopCapture();
+    if (mMonitoring) {
+        mDeviceComm->stopI2CMonitor();
+    } else {
+        mDeviceComm->stopCapture();
+    }
 }
 
-int LabToolCaptureDevice::lastSampleIndex()
+SampleIndex LabToolCaptureDevice::lastSampleIndex()
 {
     return mEndSampleIdx;
 }
 
+/*!
+    Returns the number of samples per signal that the LabTool Hardware
+    can hold with the current capture configuration. If both digital and
+    analog signals are enabled the smallest of the two is returned.
+    Returns 0 if the depth is not known (e.g. no configuration has been
+    applied yet).
+*/
+int LabToolCaptureDevice::captureDepth() const
+{
+    if (mDigitalDepth == 0 || mAnalogDepth == 0) {
+        return (int)qMax(mDigitalDepth, mAnalogDepth);
+    }
+    return (int)qMin(mDigitalDepth, mAnalogDepth);
+}
+
 QVector<int>* LabToolCaptureDevice::digitalData(int signalId)
 {
     QVector<int>* data = NULL;
@@ -1223,6 +1405,11 @@ void LabToolCaptureDevice::setDigitalData(int signalId, QVector<int> data)
             delete mDigitalSignals[signalId];
             mDigitalSignals[signalId] = NULL;
         }
+        if (mDigitalSignalTransitions[signalId] != NULL) {
+            delete mDigitalSignalTransitions[signalId];
+            mDigitalSignalTransitions[signalId] = NULL;
+        }
+        invalidateDigitalEdgeIndex();
 
         if (data.size() > 0) {
             mEndSampleIdx = data.size()-1;
@@ -1272,39 +1459,61 @@ void LabToolCaptureDevice::clearSignalData()
     deleteSignals();
 }
 
-int LabToolCaptureDevice::digitalTriggerIndex()
+SampleIndex LabToolCaptureDevice::digitalTriggerIndex()
 {
     return mTriggerIndex;
 }
 
-void LabToolCaptureDevice::setDigitalTriggerIndex(int idx)
+void LabToolCaptureDevice::setDigitalTriggerIndex(SampleIndex idx)
 {
     mTriggerIndex = idx;
 }
 
-void LabToolCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+const DigitalTransitions* LabToolCaptureDevice::digitalTransitions(int signalId)
 {
-    if (signalId >= MaxDigitalSignals) return;
-    if (mDigitalSignals[signalId] == NULL) return;
+    if (signalId >= MaxDigitalSignals) return NULL;
+    if (mDigitalSignals[signalId] == NULL) return NULL;
 
     // Not in cache. Create the list
     if (mDigitalSignalTransitions[signalId] == NULL) {
         // Deallocation:
-        //   QList will be deallocated by the destructor
+        //   DigitalTransitions will be deallocated by the destructor
         //   as a part of deallocating mDigitalSignalTransitions
-        QList<int>* l = new QList<int>();
-        CaptureDevice::digitalTransitions(signalId, *l);
-        mDigitalSignalTransitions[signalId] = l;
+        mDigitalSignalTransitions[signalId] = new DigitalTransitions(*mDigitalSignals[signalId]);
     }
 
-    list = *mDigitalSignalTransitions[signalId];
+    return mDigitalSignalTransitions[signalId];
+}
+
+/*!
+    Returns the I2C communication captured by the I2C monitor or NULL if
+    the latest capture sampled signals instead.
+*/
+QVector<I2CItem>* LabToolCaptureDevice::monitoredI2CItems()
+{
+    if (mMonitoring) {
+        return mI2CMonitor.items();
+    }
+    return NULL;
 }
 
 void LabToolCaptureDevice::reconfigure(int sampleRate)
 {
     // Ignore if there is no ongoing capture as the reconfiguration
-    // will take place the next time a capture is started
-    if (!mRunningCapture) {
+    // will take place the next time a capture is started. The I2C
+    // monitor does not depend on the signal configuration.
+    if (!mRunningCapture || mMonitoring) {
+        return;
+    }
+
+    if (sampleRate != -1) {
+        mRequestedSampleRate = sampleRate;
+    }
+
+    // Changes to only the analog trigger levels, V/div and couplings are
+    // sent right away, without any delay, and the hardware arms a capture
+    // that is waiting for its trigger again to apply them
+    if (!mReconfigurationRequested && updateAnalogConfig()) {
         return;
     }
 
@@ -1316,10 +1525,6 @@ void LabToolCaptureDevice::reconfigure(int sampleRate)
         QObject::connect(mReconfigTimer, SIGNAL(timeout()), this, SLOT(handleReconfigurationTimer()));
     }
 
-    if (sampleRate != -1) {
-        mRequestedSampleRate = sampleRate;
-    }
-
     // Start (or restart if already running) the timer to gather consecutive
     // changes (e.g. a slider will create events continuously as long as the
     // user moves it). This way we at least get only one event every 200ms
@@ -1341,9 +1546,41 @@ void LabToolCaptureDevice::setDeviceComm(LabToolDeviceComm* comm)
         mConfigMustBeUpdated = true;
         mRunningCapture = false;
     }
+    else
+    {
+        // the samples go to the unpacker, it reports back with handleReceivedSamples
+        connect(comm, SIGNAL(captureReceivedHeader(unsigned int, unsigned int, unsigned int, unsigned int)),
+                mUnpacker, SLOT(handleHeader(unsigned int, unsigned int, unsigned int, unsigned int)));
+        connect(comm, SIGNAL(captureReceivedChunk(QVector<quint8>)),
+                mUnpacker, SLOT(handleChunk(QVector<quint8>)));
+        connect(comm, SIGNAL(captureReceivedSamples(unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, int, unsigned int)),
+                mUnpacker, SLOT(handleEnd(unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, int, unsigned int)));
+    }
     mDeviceComm = comm;
 }
 
+/*!
+    Starts monitoring the I2C bus instead of sampling signals. Previously
+    captured signals are discarded.
+*/
+void LabToolCaptureDevice::startI2CMonitor()
+{
+    qDebug("Starting I2C monitor");
+    deleteSignals();
+
+    mMonitoring = true;
+    mI2CMonitor.reset(mTriggerConfig->i2cMonitorClockRate());
+    mUsedSampleRate = LabToolI2CMonitor::SampleRate;
+    mEndSampleIdx = 0;
+    mTriggerIndex = 0;
+
+    // The LabTool Hardware leaves the capture state when monitoring so the
+    // capture configuration must be sent again for the next capture
+    mConfigMustBeUpdated = true;
+
+    mDeviceComm->configureI2CMonitor(mTriggerConfig->i2cMonitorClockRate());
+}
+
 /*!
     Deletes all analog and digital signals and related data such as
     lists of transitions.
@@ -1361,6 +1598,7 @@ void LabToolCaptureDevice::deleteSignals()
             mDigitalSignalTransitions[i] = NULL;
         }
     }
+    invalidateDigitalEdgeIndex();
 
     for (int i = 0; i < MaxAnalogSignals; i++) {
         if (mAnalogSignals[i] != NULL) {
@@ -1409,11 +1647,34 @@ void LabToolCaptureDevice::handleConfigurationDone()
     } else {
         // configuration only done immediately before running, so run now
         //qDebug("Configuration done, time to run");
+        mDepthMustBeUpdated = true;
+        updateCaptureDepth();
         mDeviceComm->runCapture();
         mRunningCapture = true;
     }
 }
 
+/*!
+    Asks the LabTool Hardware for the capture depth, see \ref captureDepth,
+    if the configuration has changed since it was last asked. The depth is
+    only known once the LabTool Hardware has applied the configuration which,
+    when the configuration is sent with the start of the capture, is when
+    the samples arrive.
+*/
+void LabToolCaptureDevice::updateCaptureDepth()
+{
+    if (!mDepthMustBeUpdated) {
+        return;
+    }
+    mDepthMustBeUpdated = false;
+
+    if (mDeviceComm->captureDepth(&mDigitalDepth, &mAnalogDepth) != 0) {
+        mDigitalDepth = 0;
+        mAnalogDepth = 0;
+    }
+    qDebug("Capture depth: %u digital, %u analog samples", mDigitalDepth, mAnalogDepth);
+}
+
 /*!
     A report that the LabTool Hardware has failed to complete the requested
     configuration update. A \ref captureFinished signal will be sent to
@@ -1428,46 +1689,219 @@ void LabToolCaptureDevice::handleConfigurationFailure(const char *msg)
 
 /*!
     A report that the LabTool Hardware has successfully captured the requested
-    signal data.
+    signal data and that the \ref LabToolSampleUnpacker has unpacked the
+    \a samples.
     The previously collected signals will be discarded and the new data will
-    be unpacked. Finally a \ref captureFinished signal will be sent to
+    be converted. Finally a \ref captureFinished signal will be sent to
     indicate the successful end of the capturing.
 */
-void LabToolCaptureDevice::handleReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int digitalChannelInfo, unsigned int analogChannelInfo, int signalTrim)
+void LabToolCaptureDevice::handleReceivedSamples(LabToolUnpackedSamples samples)
 {
+    updateCaptureDepth();
+
     if (mReconfigurationRequested && hasConfigChanged()) {
         // will restart capture with the new data so discard this set
         qDebug("Discarding captured data as reconfiguration is in the pipe");
+    } else if (mAnalogUpdatesApplied != mAnalogUpdatesSent) {
+        // the capture had triggered before the last analog settings arrived
+        // so it has the old ones, the new ones are applied by the hardware
+        // when it is armed again
+        qDebug("Discarding captured data as the analog settings have changed");
+        mDeviceComm->armCapture();
     } else {
-        int analogOffset = transfer->analogDataOffset();
-        int analogSize = transfer->analogDataSize();
         deleteSignals();
 
         mUsedSampleRate = mRequestedSampleRate;
         mTriggerIndex = 0;
 
-        convertDigitalInput(transfer->data(), size-analogSize, digitalChannelInfo, trigger, digitalTrigSample, signalTrim);
-        convertAnalogInput(transfer->data()+analogOffset, analogSize, analogChannelInfo, trigger, analogTrigSample, signalTrim);
-        qDebug() << "Got " << size << "bytes with samples";
-        //qDebug() << "Digital trigger at " << digitalTrigSample << ", analog at " << analogTrigSample;
+        convertDigitalInput(samples);
+        convertAnalogInput(samples);
+        qDebug() << "Got " << samples.size << "bytes with samples";
+        //qDebug() << "Digital trigger at " << samples.digitalTrigSample << ", analog at " << samples.analogTrigSample;
 
         mRunningCapture = false;
         emit captureFinished(true, "");
     }
-    delete transfer;
+}
+
+/*!
+    A report that the \a size bytes of samples for the capture that is about
+    to be reported took \a msecs to receive. Shown in the diagnostics.
+*/
+void LabToolCaptureDevice::handleReceivedTransferTime(unsigned int size, double msecs)
+{
+    mDiagnostics->setTransferTime(size, msecs);
+}
+
+/*!
+    A report with the \a telemetry that the LabTool Hardware collected
+    for the capture that is about to be reported with \ref handleReceivedSamples.
+    The number of analog settings updates that the capture was armed with
+    is kept to tell if its samples are out-of-date, see \ref updateAnalogConfig.
+*/
+void LabToolCaptureDevice::handleReceivedTelemetry(capture_telemetry_t telemetry)
+{
+    mAnalogUpdatesApplied = telemetry.analogUpdates;
+    mDiagnostics->setTelemetry(telemetry);
+}
+
+/*!
+    A report with a preview of the armed capture that is waiting for its
+    trigger, see \ref LabToolDeviceComm::peekCapture. Only every \a step
+    sample is in the \a data which has \a digitalSize bytes of digital
+    samples followed by the analog samples. The \a activeDigital and
+    \a activeAnalog parameters tell what the data contains.
+
+    The preview is small so it is unpacked directly and replaces the
+    shown signals until the real samples arrive.
+*/
+void LabToolCaptureDevice::handleReceivedPreview(unsigned int step, unsigned int digitalSize, unsigned int activeDigital, unsigned int activeAnalog, QVector<quint8> data)
+{
+    if (!mRunningCapture || mMonitoring || step == 0) {
+        return;
+    }
+
+    mPreviewStep = step;
+    mPreviewUnpacker->handleHeader(digitalSize, data.size() - digitalSize, activeDigital, activeAnalog);
+    mPreviewUnpacker->handleChunk(data);
+    mPreviewUnpacker->handleEnd(data.size(), 0, 0, 0, activeDigital, activeAnalog, 0, TRIG_SAMPLE_UNKNOWN);
+}
+
+/*!
+    Shows the unpacked preview \a samples as the current signals and sends
+    a \ref captureUpdated signal. The sample rate is lowered to match the
+    decimation so that the preview covers the right amount of time and the
+    trigger is placed at the end as that is where the capture is now.
+
+    The preview is only meant to show what the signals look like so the
+    analog values are scaled with the calibration data but none of the
+    other corrections done for a completed capture are applied.
+*/
+void LabToolCaptureDevice::handleUnpackedPreview(LabToolUnpackedSamples samples)
+{
+    if (!mRunningCapture || mMonitoring) {
+        return;
+    }
+
+    deleteSignals();
+    mUsedSampleRate = qMax(1, mRequestedSampleRate / (int)mPreviewStep);
+    mEndSampleIdx = 0;
+
+    foreach(DigitalSignal* signal, mDigitalSignalList) {
+        int id = signal->id();
+        if (id >= MaxDigitalSignals || samples.digital.at(id).isEmpty()) continue;
+
+        // Deallocation:
+        //   QVector will be deallocated by deleteSignals or the destructor
+        //   as a part of deallocating mDigitalSignals
+        mDigitalSignals[id] = new QVector<int>(samples.digital.at(id));
+        mEndSampleIdx = mDigitalSignals[id]->size()-1;
+    }
+
+    LabToolCalibrationData* calib = mDeviceComm->storedCalibrationData();
+    foreach(AnalogSignal* signal, mAnalogSignalList) {
+        int id = signal->id();
+        if (id >= MaxAnalogSignals || samples.analog.at(id).isEmpty() || calib == NULL) continue;
+
+        int voltsPerDivIndex = supportedVPerDiv().indexOf(signal->vPerDiv());
+        double a = calib->analogFactorA(id, voltsPerDivIndex);
+        double b = calib->analogFactorB(id, voltsPerDivIndex);
+
+        // Deallocation:
+        //   QVector will be deallocated by deleteSignals or the destructor
+        //   as a part of deallocating mAnalogSignals
+        QVector<double> *s = new QVector<double>();
+        s->reserve(samples.analog.at(id).size());
+        foreach(quint16 val, samples.analog.at(id)) {
+            s->append(a + b * val);
+        }
+        mAnalogSignals[id] = s;
+        mEndSampleIdx = s->size()-1;
+    }
+
+    // nothing has triggered yet, the preview ends at the current sample
+    mTriggerIndex = mEndSampleIdx;
+
+    emit captureUpdated();
 }
 
 /*!
     A report that the LabTool Hardware has failed to capture signal data
     as requested. A \ref captureFinished signal will be sent to
     indicate the failure with an explanation in \a msg.
+
+    The configuration is sent in the same request that starts the capture
+    so the failure may be caused by it and it will be sent again for the
+    next capture.
 */
 void LabToolCaptureDevice::handleFailedCapture(const char *msg)
 {
     mRunningCapture = false;
+    mConfigMustBeUpdated = true;
     emit captureFinished(false, msg);
 }
 
+/*!
+    A report that the LabTool Hardware has configured the I2C monitor
+    and that it can be started.
+*/
+void LabToolCaptureDevice::handleI2CMonitorConfigurationDone()
+{
+    if (mRunningCapture && mMonitoring) {
+        mDeviceComm->runI2CMonitor();
+    }
+}
+
+/*!
+    A report that the LabTool Hardware has sent more events from the I2C
+    monitor. The \a records (timestamp, status and data for each event) are
+    converted into I2C items and a \ref captureUpdated signal is sent, at
+    most every 100ms to limit the work done by the analyzers. The \a lost
+    parameter is the total number of events dropped by the hardware and
+    \a last is true when the monitor has stopped by itself, in which case a
+    \ref captureFinished signal is sent instead.
+*/
+void LabToolCaptureDevice::handleI2CMonitorData(QVector<quint32> records, unsigned int lost, bool last)
+{
+    if (!mMonitoring) {
+        return;
+    }
+
+    mI2CMonitor.addRecords(records, lost);
+    mEndSampleIdx = mI2CMonitor.lastSampleIndex();
+
+    if (last) {
+        if (mMonitorUpdateTimer != NULL) {
+            mMonitorUpdateTimer->stop();
+        }
+        mRunningCapture = false;
+        emit captureFinished(true, "");
+        return;
+    }
+
+    if (mMonitorUpdateTimer == NULL) {
+        // Deallocation: Destructor is responsible
+        mMonitorUpdateTimer = new QTimer();
+        mMonitorUpdateTimer->setInterval(100);
+        mMonitorUpdateTimer->setSingleShot(true);
+        QObject::connect(mMonitorUpdateTimer, SIGNAL(timeout()), this, SLOT(handleI2CMonitorUpdateTimer()));
+    }
+    if (!mMonitorUpdateTimer->isActive()) {
+        mMonitorUpdateTimer->start();
+    }
+}
+
+/*!
+    Called by the I2C monitor update timer to let the analyzers show
+    the events received so far.
+*/
+void LabToolCaptureDevice::handleI2CMonitorUpdateTimer()
+{
+    if (mRunningCapture && mMonitoring) {
+        emit captureUpdated();
+    }
+}
+
 /*!
     Called by the reconfiguration timer. If a capture is still
     running and the configuration has changed then the capture
@@ -1557,6 +1991,63 @@ bool LabToolCaptureDevice::hasConfigChanged()
     return true;
 }
 
+/*!
+    Sends the changed analog settings to the LabTool Hardware without
+    stopping the ongoing capture, see \ref LabToolDeviceComm::updateAnalogConfig.
+    This is only possible if nothing but the analog signals' trigger levels,
+    trigger edges, V/div and couplings have changed. The hardware applies
+    the changes when it arms the capture, which it does again right away if
+    the capture is still waiting for its trigger. The number of changes
+    applied to a capture comes with its telemetry and the samples of a
+    capture that had already triggered are discarded when they arrive.
+
+    Returns true if there was nothing to change or if the changes have been
+    sent. Returns false if a new configuration is needed.
+*/
+bool LabToolCaptureDevice::updateAnalogConfig()
+{
+    if (!hasConfigChanged()) {
+        return true;
+    }
+
+    if (mConfigMustBeUpdated) return false;
+    if (mLastUsedSampleRate != mRequestedSampleRate) return false;
+    if (mLastUsedDigtalSignals.size() != mDigitalSignalList.size()) return false;
+    if (mLastUsedAnalogSignals.size() != mAnalogSignalList.size()) return false;
+
+    foreach(DigitalSignal* signal, mDigitalSignalList) {
+        if (!mLastUsedDigtalSignals.contains(*signal)) {
+            return false;
+        }
+    }
+
+    // The same channels must be enabled and the same channels must trigger
+    foreach(AnalogSignal* signal, mAnalogSignalList) {
+        bool found = false;
+        for (int i = 0; i < mLastUsedAnalogSignals.size(); i++) {
+            const AnalogSignal &last = mLastUsedAnalogSignals.at(i);
+            if (last.id() == signal->id()) {
+                found = ((last.triggerState() == AnalogSignal::AnalogTriggerNone) ==
+                         (signal->triggerState() == AnalogSignal::AnalogTriggerNone));
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    capture_cfg_t* cfg = (capture_cfg_t*)configData();
+    if (mDeviceComm->updateAnalogConfig(sizeof(cap_vadc_cfg_t), (quint8*)&cfg->vadc) != 0) {
+        qDebug("Analog settings rejected, doing a reconfiguration");
+        return false;
+    }
+
+    saveConfig();
+    mAnalogUpdatesSent++;
+    return true;
+}
+
 /*!
     Saves a copy of the current configuration. The copy is used by
     \ref hasConfigChanged to determine when the LabTool Hardware's
@@ -1631,6 +2122,10 @@ void LabToolCaptureDevice::updateDigitalConfigData()
     capture_cfg_t* common_header = (capture_cfg_t*)mData;
     cap_sgpio_cfg_t* header = &common_header->sgpio;
 
+    // A pattern trigger replaces the edge triggers on the signals
+    patternTriggerConfig(header->triggerPattern);
+    bool patternTrigger = (header->triggerPattern[0] & CAPTURE_PATTERN_ENABLED) != 0;
+
     // Add signal information: which are enabled, which can trigger, type of trigger
     foreach(DigitalSignal* signal, mDigitalSignalList) {
         int id = signal->id();
@@ -1643,7 +2138,7 @@ void LabToolCaptureDevice::updateDigitalConfigData()
         header->enabledChannels |= (1<<id);
 
         // Add any trigger information
-        switch (signal->triggerState())
+        switch (patternTrigger ? DigitalSignal::DigitalTriggerNone : signal->triggerState())
         {
         // Falling edge
         case DigitalSignal::DigitalTriggerHighLow:
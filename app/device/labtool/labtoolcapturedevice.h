@@ -18,10 +18,15 @@
 
 #include <QObject>
 #include <QList>
+#include <QThread>
 
 #include "device/capturedevice.h"
 #include "labtooldevicecomm.h"
 #include "uilabtooltriggerconfig.h"
+#include "uilabtooldiagnostics.h"
+#include "labtooli2cmonitor.h"
+#include "labtoolsampleunpacker.h"
+#include "capture_pattern.h"
 
 class LabToolCaptureDevice : public CaptureDevice
 {
@@ -38,10 +43,12 @@ public:
 
     void configureTrigger(QWidget* parent);
     void calibrate(QWidget* parent);
+    void showDiagnostics(QWidget* parent);
     void start(int sampleRate);
     void stop();
 
-    int lastSampleIndex();
+    SampleIndex lastSampleIndex();
+    int captureDepth() const;
     QVector<int>* digitalData(int signalId);
     void setDigitalData(int signalId, QVector<int> data);
     QVector<double>* analogData(int signalId);
@@ -49,9 +56,11 @@ public:
 
     void clearSignalData();
 
-    int digitalTriggerIndex();
-    void setDigitalTriggerIndex(int idx);
-    void digitalTransitions(int signalId, QList<int> &list);
+    SampleIndex digitalTriggerIndex();
+    void setDigitalTriggerIndex(SampleIndex idx);
+    const DigitalTransitions* digitalTransitions(int signalId);
+
+    QVector<I2CItem>* monitoredI2CItems();
 
     void reconfigure(int sampleRate = -1);
 
@@ -63,9 +72,16 @@ private slots:
     void handleStopped();
     void handleConfigurationDone();
     void handleConfigurationFailure(const char* msg);
-    void handleReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int digitalChannelInfo, unsigned int analogChannelInfo, int signalTrim);
+    void handleReceivedSamples(LabToolUnpackedSamples samples);
+    void handleReceivedTransferTime(unsigned int size, double msecs);
+    void handleReceivedTelemetry(capture_telemetry_t telemetry);
+    void handleReceivedPreview(unsigned int step, unsigned int digitalSize, unsigned int activeDigital, unsigned int activeAnalog, QVector<quint8> data);
+    void handleUnpackedPreview(LabToolUnpackedSamples samples);
     void handleFailedCapture(const char* msg);
     void handleReconfigurationTimer();
+    void handleI2CMonitorConfigurationDone();
+    void handleI2CMonitorData(QVector<quint32> records, unsigned int lost, bool last);
+    void handleI2CMonitorUpdateTimer();
 
 private:
 
@@ -75,14 +91,24 @@ private:
     };
 
     UiLabToolTriggerConfig* mTriggerConfig;
+    UiLabToolDiagnostics* mDiagnostics;
+    LabToolSampleUnpacker* mUnpacker;
+    QThread* mUnpackThread;
+    LabToolSampleUnpacker* mPreviewUnpacker;
+    unsigned int mPreviewStep;
     LabToolDeviceComm*  mDeviceComm;
 
-    int mEndSampleIdx;
-    int mTriggerIndex;
+    SampleIndex mEndSampleIdx;
+    SampleIndex mTriggerIndex;
+    quint32 mDigitalDepth;
+    quint32 mAnalogDepth;
+    bool mDepthMustBeUpdated;
     int mRequestedSampleRate;
     bool mConfigMustBeUpdated;
     bool mRunningCapture;
     bool mReconfigurationRequested;
+    quint32 mAnalogUpdatesSent;
+    quint32 mAnalogUpdatesApplied;
     bool mWarnUncalibrated;
     quint8* mData;
     QList<DigitalSignal> mLastUsedDigtalSignals;
@@ -92,37 +118,52 @@ private:
     QVector<int>* mDigitalSignals[MaxDigitalSignals];
     QVector<double>* mAnalogSignals[MaxAnalogSignals];
     QVector<quint16>* mAnalogSignalData[MaxAnalogSignals];
-    QList<int>* mDigitalSignalTransitions[MaxDigitalSignals];
+    DigitalTransitions* mDigitalSignalTransitions[MaxDigitalSignals];
 
     QList<double> mSupportedVPerDiv;
 
     QTimer* mReconfigTimer;
 
+    LabToolI2CMonitor mI2CMonitor;
+    bool mMonitoring;
+    QTimer* mMonitorUpdateTimer;
+
+    void startI2CMonitor();
+
     template <typename T>
     void trimSignalData(QVector<T> *s, int numToRemove, bool removeFromStart) const;
 
     template <typename T>
     void compensateForAnalogHardware(QVector<T> *s, bool isAnalogSignal) const;
+    int analogHardwareDelay() const;
 
     int locateFirstLevel(QVector<int> *s, int level, int offset);
     int locatePreviousLevel(QVector<int> *s, int level, int offset);
+    bool isDigitalTrigger(QVector<int> *s, DigitalSignal::DigitalTriggerState trigger, int pos);
+    int locateDigitalTrigger(QVector<int> *s, DigitalSignal::DigitalTriggerState trigger, int estimatedIdx);
+    void patternTriggerConfig(quint32* stages);
+    int locatePatternStart(const capture_pattern_t* pattern, int from, int count);
+    int locatePatternTrigger(quint32 trigSample, int estimatedIdx);
 
     int locateAnalogHighLowTransition(QVector<double> *s, double lowLevel, double highLevel, int offset);
     int locateAnalogLowHighTransition(QVector<double> *s, double lowLevel, double highLevel, int offset);
     int locateTransition(QVector<double> *s, AnalogSignal::AnalogTriggerState trigState, double lowLevel, double trigLevel, double highLevel, int estimatedIdx);
+    bool isAnalogTrigger(double prev, double cur, AnalogSignal::AnalogTriggerState trigState, double trigLevel, double tolerance);
 
     bool detectAnalogSignalFrequency(int id, quint16 trigLevel, bool fallingEdge);
-    void convertDigitalInput(const quint8* pData, quint32 size, quint32 activeChannels, quint32 trig, int digitalTrigSample, int signalTrim);
-    void unpackAnalogInput(const quint8 *pData, quint32 size, quint32 activeChannels);
+    void convertDigitalInput(const LabToolUnpackedSamples &samples);
+    void unpackAnalogInput(const LabToolUnpackedSamples &samples);
     void convertHiddenAnalogInput(const quint8 *pData, quint32 size);
-    void convertAnalogInput(const quint8* pData, quint32 size, quint32 activeChannels, quint32 trig, int analogTrigSample, int signalTrim);
+    void convertAnalogInput(const LabToolUnpackedSamples &samples);
     void saveData(const quint8* pData, quint32 size);
     void deleteSignals();
 
     qint16 analog12BitTriggerLevel(const AnalogSignal *signal);
 
     bool hasConfigChanged();
+    bool updateAnalogConfig();
     void saveConfig();
+    void updateCaptureDepth();
 
     unsigned int configSize();
     quint8 *configData();
@@ -87,8 +87,14 @@ void LabToolDevice::handleNewConnection(LabToolDeviceComm *newComm)
     QObject::connect(mDeviceComm, SIGNAL(captureStopped()),
             mCaptureDevice, SLOT(handleStopped()));
 
-    QObject::connect(mDeviceComm, SIGNAL(captureReceivedSamples(LabToolDeviceTransfer*, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, int)),
-            mCaptureDevice, SLOT(handleReceivedSamples(LabToolDeviceTransfer*, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, unsigned int, int)));
+    QObject::connect(mDeviceComm, SIGNAL(captureReceivedTransferTime(unsigned int, double)),
+            mCaptureDevice, SLOT(handleReceivedTransferTime(unsigned int, double)));
+
+    QObject::connect(mDeviceComm, SIGNAL(captureReceivedTelemetry(capture_telemetry_t)),
+            mCaptureDevice, SLOT(handleReceivedTelemetry(capture_telemetry_t)));
+
+    QObject::connect(mDeviceComm, SIGNAL(captureReceivedPreview(unsigned int, unsigned int, unsigned int, unsigned int, QVector<quint8>)),
+            mCaptureDevice, SLOT(handleReceivedPreview(unsigned int, unsigned int, unsigned int, unsigned int, QVector<quint8>)));
 
     QObject::connect(mDeviceComm, SIGNAL(captureConfigurationDone()),
             mCaptureDevice, SLOT(handleConfigurationDone()));
@@ -99,6 +105,12 @@ void LabToolDevice::handleNewConnection(LabToolDeviceComm *newComm)
     QObject::connect(mDeviceComm, SIGNAL(captureConfigurationFailed(const char*)),
             mCaptureDevice, SLOT(handleConfigurationFailure(const char*)));
 
+    QObject::connect(mDeviceComm, SIGNAL(i2cMonitorConfigurationDone()),
+            mCaptureDevice, SLOT(handleI2CMonitorConfigurationDone()));
+
+    QObject::connect(mDeviceComm, SIGNAL(i2cMonitorReceivedData(QVector<quint32>, unsigned int, bool)),
+            mCaptureDevice, SLOT(handleI2CMonitorData(QVector<quint32>, unsigned int, bool)));
+
 
     /* Handle signals related to generator */
 
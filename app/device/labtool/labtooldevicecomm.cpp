@@ -14,6 +14,8 @@
  *  limitations under the License.
  */
 #include "labtooldevicecomm.h"
+#include "capture_buffers.h"
+#include "capture_peek.h"
 
 
 /*!
@@ -34,6 +36,53 @@
 */
 #define INTERFACENUM             0
 
+/*!
+    Number of transfers with streamed digital signal data to keep queued.
+    More transfers makes the stream less sensitive to scheduling delays.
+*/
+#define STREAM_TRANSFERS         4
+
+/*!
+    Number of bytes in each transfer with streamed digital signal data.
+    Must be a multiple of the USB packet size (512 bytes).
+*/
+#define STREAM_TRANSFER_SIZE     (16*1024)
+
+/*!
+    Number of reads to keep queued while the I2C monitor is running.
+    The LabTool Hardware sends one message at a time so a few queued reads
+    are enough to keep it from waiting for the host.
+*/
+#define MONITOR_TRANSFERS        4
+
+/*!
+    Number of bytes in each message with captured I2C events. Must match
+    the message size used by the LabTool Hardware (one USB packet).
+*/
+#define MONITOR_TRANSFER_SIZE    512
+
+/*!
+    Number of bytes in each read of captured samples. The samples are
+    received in chunks of this size, with all reads posted at once, so that
+    each chunk can be unpacked while the rest are received. Must be a
+    multiple of the USB packet size (512 bytes).
+*/
+#define SAMPLE_TRANSFER_SIZE     (16*1024)
+
+/*!
+    Number of bytes in the reads of the samples that are posted when arming
+    a capture with \ref LabToolDeviceComm::armCapture. It must be larger than
+    the largest capture so that the LabTool Hardware always ends the samples
+    with a short or zero length packet.
+*/
+#define ARMED_TRANSFER_SIZE      (CAPTURE_BUFFERS_MEMORY_SIZE + 512)
+
+/*!
+    Number of 32-bit words before the first event in each message with
+    captured I2C events.
+*/
+#define MONITOR_HEADER_WORDS     4
+
 /*!
     Commands sent as USB Control Requests
     \private
@@ -44,14 +93,18 @@ typedef enum
   REQ_Ping               = 2, /*!< Ping to indicate active line */
   REQ_StopCapture        = 3, /*!< Request to stop ongoing signal capture */
   REQ_StopGenerator      = 4, /*!< Request to stop ongoing signal generation */
-  REQ_GetStoredCalibData = 5  /*!< Request for the ongoing calibration's data */
+  REQ_GetStoredCalibData = 5, /*!< Request for the ongoing calibration's data */
+  REQ_GetGenStatus       = 6, /*!< Request for the status of a streamed signal generation */
+  REQ_GetCaptureDepth    = 7, /*!< Request for the number of samples the capture configuration holds */
+  REQ_PeekCapture        = 8, /*!< Request for a preview of the ongoing capture */
+  REQ_UpdateAnalogConfig = 9  /*!< Request to change the analog trigger and input settings at the next arming */
 } control_requests_t;
 
 
 /*! @brief The response sent from the LabTool Hardware as a response to the CMD_CAP_SAMPLES.
  * This is the header for the data containing the captured samples.
  *
- * This information will be saved until after the response to CMD_CAP_DATA_ONLY has been
+ * This information will be saved until after the last CMD_CAP_DATA_ONLY chunk has been
  * received at which time it will be used to fill the \ref captureReceivedSamples signal.
  *
  * \private
@@ -67,8 +120,13 @@ typedef struct
   uint32_t digitalChannelInfo;  /*!< Information about content of the digital data */
   uint32_t analogChannelInfo;   /*!< Information about content of the analog data */
   int32_t  signalTrim;          /*!< Samples to remove from start (<0) or end (>0) of the data */
+  uint32_t trigSample;          /*!< Exact trigger sample after trimming or 0xffffffff if not found */
+  capture_telemetry_t telemetry; /*!< Statistics about the capture */
 } logic_samples_header;
 
+/*! This is to keep information while retrieving the samples */
+static logic_samples_header sampleHeader;
+
 
 /*!
     A callback used for the asynchronous transfers to the LabTool Hardware.
@@ -99,27 +157,20 @@ void LIBUSB_CALL CallbackForResponse(struct libusb_transfer* transfer)
 }
 
 /*!
-    A callback used for the asynchronous transfers to the LabTool Hardware.
-    This callback is only used for the \a CMD_CAP_DATA_ONLY command as the
-    response to that command only contains data and no header. The header
-    has been received earlier using the \a CMD_CAP_SAMPLES command.
-
-    The \a transfer parameter is checked and acts according to the result:
-    - Calls \ref transferSuccess if the transfer was completed (i.e. all data received)
-    - Calls \ref transferFailed if the transfer failed (e.g. was cancelled)
+    A callback used for the reads of the captured samples from the
+    LabTool Hardware (the \a CMD_CAP_DATA_ONLY transfers). The samples
+    contain only data and no header. The header has been received earlier
+    using the \a CMD_CAP_SAMPLES command. All the work is done in
+    \ref sampleTransferDone.
 
     This function cannot be a part of the LabToolDeviceComm class as the
     libusbx requires function pointer and that cannot (simply at least)
     be created from class instances.
 */
-void LIBUSB_CALL CallbackForData(struct libusb_transfer* transfer)
+void LIBUSB_CALL CallbackForSamples(struct libusb_transfer* transfer)
 {
     LabToolDeviceTransfer* ddt = ((LabToolDeviceTransfer*)transfer->user_data);
-    if ((transfer->status == LIBUSB_TRANSFER_COMPLETED) && ddt->validSequenceNumber()) {
-        ddt->deviceComm()->transferSuccess(ddt);
-    } else {
-        ddt->deviceComm()->transferFailed(ddt);
-    }
+    ddt->deviceComm()->sampleTransferDone(ddt);
 }
 
 /*!
@@ -155,6 +206,67 @@ void LIBUSB_CALL CallbackForSend(struct libusb_transfer* transfer)
     }
 }
 
+/*!
+    A callback used for the asynchronous transfers to the LabTool Hardware.
+    This callback is only used for the \a CMD_CAP_ARM command which has no
+    response of its own. The reads for the sample header and the samples
+    have already been posted by \ref LabToolDeviceComm::armCapture.
+
+    The \a transfer parameter is checked and acts according to the result:
+    - Submitts a transfer of the command's payload if it has any
+    - Deletes the transfer when it has no (more) payload
+    - Calls \ref transferFailed if the transfer failed (e.g. was cancelled)
+
+    This function cannot be a part of the LabToolDeviceComm class as the
+    libusbx requires function pointer and that cannot (simply at least)
+    be created from class instances.
+*/
+void LIBUSB_CALL CallbackForArm(struct libusb_transfer* transfer)
+{
+    LabToolDeviceTransfer* ddt = ((LabToolDeviceTransfer*)transfer->user_data);
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED && ddt->validSequenceNumber()) {
+        if (ddt->hasPayload()) {
+            ddt->setupForSendingPayload(CallbackForArm, 2000);
+            int ret = libusb_submit_transfer(ddt->transfer());
+            if (ret != LIBUSB_SUCCESS) {
+                ddt->deviceComm()->transferFailed(ddt, ret);
+            }
+        } else {
+            delete ddt;
+        }
+    } else {
+        ddt->deviceComm()->transferFailed(ddt);
+    }
+}
+
+/*!
+    A callback used for the transfers of streamed digital signal data to
+    the LabTool Hardware. All the work is done in \ref streamTransferDone.
+
+    This function cannot be a part of the LabToolDeviceComm class as the
+    libusbx requires function pointer and that cannot (simply at least)
+    be created from class instances.
+*/
+void LIBUSB_CALL CallbackForStream(struct libusb_transfer* transfer)
+{
+    LabToolDeviceTransfer* ddt = ((LabToolDeviceTransfer*)transfer->user_data);
+    ddt->deviceComm()->streamTransferDone(ddt);
+}
+
+/*!
+    A callback used for the transfers of captured I2C events from
+    the LabTool Hardware. All the work is done in \ref monitorTransferDone.
+
+    This function cannot be a part of the LabToolDeviceComm class as the
+    libusbx requires function pointer and that cannot (simply at least)
+    be created from class instances.
+*/
+void LIBUSB_CALL CallbackForMonitor(struct libusb_transfer* transfer)
+{
+    LabToolDeviceTransfer* ddt = ((LabToolDeviceTransfer*)transfer->user_data);
+    ddt->deviceComm()->monitorTransferDone(ddt);
+}
+
 
 /*!
     \class LabToolDeviceComm
@@ -176,15 +288,25 @@ void LIBUSB_CALL CallbackForSend(struct libusb_transfer* transfer)
     Command           | Type            | Description
     :---------------: | :-------------: | -----------
     CMD_GEN_CONFIGURE | Async Transfer  | Configuration of Generator
+    CMD_GEN_PATTERN   | Async Transfer  | Encoded digital pattern for the Generator
+    CMD_GEN_ANALOG_LUT| Async Transfer  | Arbitrary analog waveforms for the Generator
     CMD_GEN_RUN       | Async Transfer  | Start signal generation
     CMD_CAP_CONFIGURE | Async Transfer  | Configuration of Capture
     CMD_CAP_RUN       | Async Transfer  | Start signal capturing
     CMD_CAP_SAMPLES   | Async Transfer  | Request for sample header
     CMD_CAP_DATA_ONLY | Async Transfer  | Request for samples
+    CMD_CAP_ARM       | Async Transfer  | Configuration (optional) and start of Capture, answered with the samples
+    CMD_MON_I2C_CFG   | Async Transfer  | Configuration of the I2C monitor
+    CMD_MON_I2C_RUN   | Async Transfer  | Start I2C monitoring
+    CMD_MON_I2C_DATA  | Async Transfer  | Captured I2C events, several reads kept queued
     REQ_GetPll1Speed  | Control Request | Example of Control Request
     REQ_Ping          | Control Request | See if the hardware is alive
-    REQ_StopCapture   | Control Request | Abort signal generation
+    REQ_StopCapture   | Control Request | Abort signal capture or I2C monitoring
     REQ_StopGenerator | Control Request | Stop signal generation
+    REQ_GetGenStatus  | Control Request | Progress of streamed signal generation
+    REQ_GetCaptureDepth | Control Request | Samples per signal for the capture configuration
+    REQ_PeekCapture   | Control Request | Preview of an armed capture that waits for the trigger
+    REQ_UpdateAnalogConfig | Control Request | Analog trigger level/edge, V/div and coupling for the next arming
 
     The Async Transfer type is as the name suggests an asynchronous request
     meaning that it can be aborted. The reason for using the asynchronous
@@ -208,8 +330,17 @@ LabToolDeviceComm::LabToolDeviceComm(QObject *parent) :
     this->mContext = NULL;
     this->mDeviceHandle = NULL;
     this->mRunningTransfer = NULL;
+    this->mSampleTransfersNeeded = 0;
+    this->mSampleBytesLeft = 0;
     this->mConnected = false;
     this->mActiveCalibrationData = NULL;
+    this->mStream = NULL;
+    this->mStreamStopping = false;
+    this->mMonitorStopping = false;
+
+    qRegisterMetaType<QVector<quint32> >("QVector<quint32>");
+    qRegisterMetaType<QVector<quint8> >("QVector<quint8>");
+    qRegisterMetaType<capture_telemetry_t>("capture_telemetry_t");
 }
 
 /*!
@@ -291,6 +422,9 @@ void LabToolDeviceComm::disconnectFromDevice()
     {
         return;
     }
+    stopGeneratorStream();
+    cancelMonitorTransfers();
+    cancelSampleTransfers();
     mConnected = false;
     if (mDeviceHandle != NULL)
     {
@@ -663,15 +797,61 @@ LabToolCalibrationData *LabToolDeviceComm::storedCalibrationData(bool forceReloa
 */
 
 /*!
-    \fn void LabToolDeviceComm::captureReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int activeDigital, unsigned int activeAnalog)
+    \fn void LabToolDeviceComm::captureReceivedHeader(unsigned int digitalSize, unsigned int analogSize, unsigned int activeDigital, unsigned int activeAnalog)
+
+    Sent when the header for the captured signal data has been received and
+    before the first \ref captureReceivedChunk. The data will be \a digitalSize
+    bytes of digital samples followed by \a analogSize bytes of analog samples.
+    The \a activeDigital and \a activeAnalog parameters tell what the digital
+    and analog signal data contains.
+*/
+
+/*!
+    \fn void LabToolDeviceComm::captureReceivedChunk(QVector<quint8> chunk)
+
+    Sent for each received \a chunk of the captured signal data, in order.
+    The chunks are a multiple of 4 bytes except possibly the last one.
+*/
+
+/*!
+    \fn void LabToolDeviceComm::captureReceivedSamples(unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int activeDigital, unsigned int activeAnalog, int signalTrim, unsigned int trigSample)
 
-    Sent to notify that captured signal data has been received.
-    The \a transfer parameter holds the data, \a size is the size of the data (in bytes),
+    Sent to notify that all of the captured signal data has been received with
+    \ref captureReceivedChunk.
+    The \a size is the size of the data (in bytes),
     \a trigger is information about what caused the trigger, \a digitalTrigSample is the
     digital sample at the time of the trigger, \a analogTrigSample is the analog sample
     at the time of the trigger, \a activeDigital is
     information about what the digital signal data contains, \a activeAnalog is
-    information about what the analog signal data contains.
+    information about what the analog signal data contains, \a signalTrim is the number
+    of samples to remove from the start (<0) or end (>0) and \a trigSample is the
+    sample where the triggering edge was found by the hardware or 0xffffffff if it
+    was not found.
+*/
+
+/*!
+    \fn void LabToolDeviceComm::captureReceivedTransferTime(unsigned int size, double msecs)
+
+    Sent right before \ref captureReceivedTelemetry with the time in \a msecs that it
+    took to receive the \a size bytes of samples, or 0 if it was not measured.
+*/
+
+/*!
+    \fn void LabToolDeviceComm::captureReceivedTelemetry(capture_telemetry_t telemetry)
+
+    Sent right before \ref captureReceivedSamples with the \a telemetry that the
+    LabTool Hardware collected about the capture, e.g. skipped analog samples and
+    how far from the reported trigger sample the exact one was.
+*/
+
+/*!
+    \fn void LabToolDeviceComm::captureReceivedPreview(unsigned int step, unsigned int digitalSize, unsigned int activeDigital, unsigned int activeAnalog, QVector<quint8> data)
+
+    Sent with a preview of an armed capture, see \ref peekCapture. The \a data
+    has \a digitalSize bytes of digital samples followed by the analog samples,
+    in the same format as \ref captureReceivedChunk, but only every \a step
+    captured sample is included. The \a activeDigital and \a activeAnalog
+    parameters tell what the digital and analog signal data contains.
 */
 
 /*!
@@ -902,7 +1082,8 @@ void LabToolDeviceComm::probe()
     Sends a request to stop/abort the ongoing signal capture to the LabTool Hardware.
 
     The request is a Control Transfer and is synchronous. Any ongoing USB transfers
-    (typically the CMD_CAP_SAMPLES if a capture is ongoing) are cancelled.
+    (typically the CMD_CAP_SAMPLES and, if armed with \ref armCapture, the read
+    of the samples) are cancelled.
 
     A \ref captureStopped signal will be sent to indicate that the capture has stopped.
 */
@@ -931,6 +1112,7 @@ int LabToolDeviceComm::stopCapture()
             mRunningTransfer = NULL;
         }
     }
+    cancelSampleTransfers();
 
 
 //    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
@@ -953,11 +1135,12 @@ int LabToolDeviceComm::stopCapture()
     Completed Command  | Description
     :----------------: | ------------
     CMD_GEN_CONFIGURE  | Done, success reported with generatorConfigurationDone signal
+    CMD_GEN_PATTERN    | Pattern stored, send the pending lookup tables or configuration
+    CMD_GEN_ANALOG_LUT | Lookup tables stored, send CMD_GEN_CONFIGURE with the pending configuration
     CMD_GEN_RUN        | Done, success reported with generatorRunning signal
     CMD_CAP_CONFIGURE  | Done, success reported with captureConfigurationDone signal
     CMD_CAP_RUN        | Now running, send CMD_CAP_SAMPLES to wait for captured data header
-    CMD_CAP_SAMPLES    | Got header, send CMD_CAP_DATA_ONLY to get for captured data
-    CMD_CAP_DATA_ONLY  | Done, success reported with captureReceivedSamples signal
+    CMD_CAP_SAMPLES    | Got header, send CMD_CAP_DATA_ONLY reads for the captured data (or use the ones posted when arming)
     CMD_CAL_INIT       | Done, success reported with calibrationSuccess signal
     CMD_CAL_ANALOG_OUT | Done, success reported with calibrationSuccess signal
     CMD_CAL_ANALOG_IN  | Calibration running, send CMD_CAL_RESULT to get result
@@ -965,12 +1148,11 @@ int LabToolDeviceComm::stopCapture()
     CMD_CAL_STORE      | Done, success reported with calibrationSuccess signal
     CMD_CAL_ERASE      | Done, success reported with calibrationSuccess signal
     CMD_CAL_END        | Done, success reported with calibrationSuccess signal
+    CMD_MON_I2C_CFG    | Done, success reported with i2cMonitorConfigurationDone signal
+    CMD_MON_I2C_RUN    | Monitor running, queue reads for CMD_MON_I2C_DATA
 */
 void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
 {
-    // This is to keep information while retrieving the samples
-    static logic_samples_header sampleHeader;
-
     int ret;
 
 //    qDebug("%s: Success", transfer->CommandString());
@@ -979,6 +1161,12 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
         emit generatorConfigurationDone();
         break;
 
+    case LabToolDeviceTransfer::CMD_GEN_PATTERN:
+    case LabToolDeviceTransfer::CMD_GEN_ANALOG_LUT:
+        // target has stored the data, now send the rest of the configuration
+        sendPendingGeneratorData();
+        break;
+
     case LabToolDeviceTransfer::CMD_GEN_RUN:
         emit generatorRunning();
         break;
@@ -987,6 +1175,24 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
         emit captureConfigurationDone();
         break;
 
+    case LabToolDeviceTransfer::CMD_MON_I2C_CFG:
+        emit i2cMonitorConfigurationDone();
+        break;
+
+    case LabToolDeviceTransfer::CMD_MON_I2C_RUN:
+        // target is now monitoring, keep reads queued for the events
+        if (mRunningTransfer == transfer)
+        {
+            mRunningTransfer = NULL;
+        }
+        delete transfer;
+        ret = startMonitorTransfers();
+        if (ret != LIBUSB_SUCCESS) {
+            qDebug("Failed to queue I2C monitor transfers, error %d: %s", ret, libusb_error_name(ret));
+            emit captureFailed("Failed to receive data from the I2C monitor.");
+        }
+        return;
+
     case LabToolDeviceTransfer::CMD_CAP_RUN:
         // target is now running, time to wait for samples
         transfer->setupForIncomingCommand(LabToolDeviceTransfer::CMD_CAP_SAMPLES, mEndpointIn, mDeviceHandle, CallbackForResponse, 0xffffffff, sizeof(logic_samples_header));
@@ -1002,26 +1208,15 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
         // target has sent the header for the samples, investigate and get actual samples
         memcpy(&sampleHeader, transfer->data(), sizeof(logic_samples_header));
 //        qDebug("Got samples. Headers: %#x, %#x, %#x, %#x", sampleHeader.cmd, sampleHeader.bufferSize, sampleHeader.triggerInfo, sampleHeader.channelInfo);
-        transfer->setupForIncomingData(mEndpointIn, mDeviceHandle, CallbackForData, 2000, sampleHeader.digitalBufferSize, sampleHeader.analogBufferSize);
-        ret = libusb_submit_transfer(transfer->transfer());
-        if (ret == LIBUSB_SUCCESS) {
-            // must return to avoid the deletion of this transfer
+        emit captureReceivedHeader(sampleHeader.digitalBufferSize, sampleHeader.analogBufferSize, sampleHeader.digitalChannelInfo, sampleHeader.analogChannelInfo);
+        mSampleTransferTimer.start();
+        ret = receiveSamples(sampleHeader.digitalBufferSize + sampleHeader.analogBufferSize);
+        if (ret != LIBUSB_SUCCESS) {
+            transferFailed(transfer, ret);
             return;
         }
-        transferFailed(transfer, ret);
         break;
 
-    case LabToolDeviceTransfer::CMD_CAP_DATA_ONLY:
-        // actual sample data
-        // give sampleHeader and transfer) to LabToolDevice to forward to UI
-        emit captureReceivedSamples(transfer, sampleHeader.digitalBufferSize + sampleHeader.analogBufferSize, sampleHeader.triggerInfo, sampleHeader.digitalTrigSample, sampleHeader.analogTrigSample, sampleHeader.digitalChannelInfo, sampleHeader.analogChannelInfo, sampleHeader.signalTrim);
-        if (mRunningTransfer == transfer)
-        {
-            mRunningTransfer = NULL;
-        }
-        // must return to avoid the deletion of this transfer
-        return;
-
     case LabToolDeviceTransfer::CMD_CAL_INIT:
         emit calibrationSuccess(NULL);
         break;
@@ -1070,11 +1265,14 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
     Completed Command  | Description
     :----------------: | ------------
     CMD_GEN_CONFIGURE  | Report failure with generatorConfigurationFailed signal
+    CMD_GEN_PATTERN    | Report failure with generatorConfigurationFailed signal
+    CMD_GEN_ANALOG_LUT | Report failure with generatorConfigurationFailed signal
     CMD_GEN_RUN        | Report failure with generatorRunFailed signal
     CMD_CAP_CONFIGURE  | Report failure with captureConfigurationFailed signal
     CMD_CAP_RUN        | Report failure with captureFailed signal
     CMD_CAP_SAMPLES    | Report failure with captureFailed signal
     CMD_CAP_DATA_ONLY  | Report failure with captureFailed signal
+    CMD_CAP_ARM        | Report failure with captureFailed signal
     CMD_CAL_INIT       | Report failure with calibrationFailed signal
     CMD_CAL_ANALOG_OUT | Report failure with calibrationFailed signal
     CMD_CAL_ANALOG_IN  | Report failure with calibrationFailed signal
@@ -1082,12 +1280,16 @@ void LabToolDeviceComm::transferSuccess(LabToolDeviceTransfer *transfer)
     CMD_CAL_STORE      | Report failure with calibrationFailed signal
     CMD_CAL_ERASE      | Report failure with calibrationFailed signal
     CMD_CAL_END        | Report failure with calibrationFailed signal
+    CMD_MON_I2C_CFG    | Report failure with captureConfigurationFailed signal
+    CMD_MON_I2C_RUN    | Report failure with captureFailed signal
 */
 void LabToolDeviceComm::transferSuccessErrorResponse(LabToolDeviceTransfer *transfer)
 {
     qDebug("%s: Got error status (%s) from target", transfer->commandString(), transfer->statusErrorString());
     switch (transfer->command()) {
     case LabToolDeviceTransfer::CMD_GEN_CONFIGURE:
+    case LabToolDeviceTransfer::CMD_GEN_PATTERN:
+    case LabToolDeviceTransfer::CMD_GEN_ANALOG_LUT:
         emit generatorConfigurationFailed(transfer->statusErrorString());
         break;
 
@@ -1096,12 +1298,16 @@ void LabToolDeviceComm::transferSuccessErrorResponse(LabToolDeviceTransfer *tran
         break;
 
     case LabToolDeviceTransfer::CMD_CAP_CONFIGURE:
+    case LabToolDeviceTransfer::CMD_MON_I2C_CFG:
         emit captureConfigurationFailed(transfer->statusErrorString());
         break;
 
     case LabToolDeviceTransfer::CMD_CAP_RUN:
     case LabToolDeviceTransfer::CMD_CAP_SAMPLES:
     case LabToolDeviceTransfer::CMD_CAP_DATA_ONLY:
+    case LabToolDeviceTransfer::CMD_CAP_ARM:
+    case LabToolDeviceTransfer::CMD_MON_I2C_RUN:
+    case LabToolDeviceTransfer::CMD_MON_I2C_DATA:
         emit captureFailed(transfer->statusErrorString());
         break;
 
@@ -1116,6 +1322,12 @@ void LabToolDeviceComm::transferSuccessErrorResponse(LabToolDeviceTransfer *tran
         break;
     }
 
+    if (transfer->command() == LabToolDeviceTransfer::CMD_CAP_SAMPLES)
+    {
+        // the capture failed so there are no samples for the reads posted when arming
+        cancelSampleTransfers();
+    }
+
     if (mRunningTransfer == transfer)
     {
         mRunningTransfer = NULL;
@@ -1157,6 +1369,7 @@ void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libu
 
             switch (transfer->command()) {
             case LabToolDeviceTransfer::CMD_GEN_CONFIGURE:
+            case LabToolDeviceTransfer::CMD_GEN_PATTERN:
                 emit generatorConfigurationFailed(transfer->transferErrorString());
                 break;
 
@@ -1165,12 +1378,16 @@ void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libu
                 break;
 
             case LabToolDeviceTransfer::CMD_CAP_CONFIGURE:
+            case LabToolDeviceTransfer::CMD_MON_I2C_CFG:
                 emit captureConfigurationFailed(transfer->transferErrorString());
                 break;
 
             case LabToolDeviceTransfer::CMD_CAP_RUN:
             case LabToolDeviceTransfer::CMD_CAP_SAMPLES:
             case LabToolDeviceTransfer::CMD_CAP_DATA_ONLY:
+            case LabToolDeviceTransfer::CMD_CAP_ARM:
+            case LabToolDeviceTransfer::CMD_MON_I2C_RUN:
+            case LabToolDeviceTransfer::CMD_MON_I2C_DATA:
                 emit captureFailed(transfer->transferErrorString());
                 break;
 
@@ -1196,6 +1413,7 @@ void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libu
 
         switch (transfer->command()) {
         case LabToolDeviceTransfer::CMD_GEN_CONFIGURE:
+        case LabToolDeviceTransfer::CMD_GEN_PATTERN:
             emit generatorConfigurationFailed(errMsg);
             break;
 
@@ -1204,12 +1422,16 @@ void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libu
             break;
 
         case LabToolDeviceTransfer::CMD_CAP_CONFIGURE:
+        case LabToolDeviceTransfer::CMD_MON_I2C_CFG:
             emit captureConfigurationFailed(errMsg);
             break;
 
         case LabToolDeviceTransfer::CMD_CAP_RUN:
         case LabToolDeviceTransfer::CMD_CAP_SAMPLES:
         case LabToolDeviceTransfer::CMD_CAP_DATA_ONLY:
+        case LabToolDeviceTransfer::CMD_CAP_ARM:
+        case LabToolDeviceTransfer::CMD_MON_I2C_RUN:
+        case LabToolDeviceTransfer::CMD_MON_I2C_DATA:
             emit captureFailed(errMsg);
             break;
 
@@ -1225,6 +1447,21 @@ void LabToolDeviceComm::transferFailed(LabToolDeviceTransfer *transfer, int libu
         }
     }
 
+    // The samples will not arrive, so remove the reads posted when arming
+    if (transfer->command() == LabToolDeviceTransfer::CMD_CAP_ARM && mRunningTransfer != NULL)
+    {
+        if (libusb_cancel_transfer(mRunningTransfer->transfer()) != LIBUSB_SUCCESS)
+        {
+            // a successful transfer cancellation will always get a callback which will delete it
+            mRunningTransfer = NULL;
+        }
+    }
+    if (transfer->command() == LabToolDeviceTransfer::CMD_CAP_ARM ||
+        transfer->command() == LabToolDeviceTransfer::CMD_CAP_SAMPLES)
+    {
+        cancelSampleTransfers();
+    }
+
     if (mRunningTransfer == transfer)
     {
         mRunningTransfer = NULL;
@@ -1312,9 +1549,10 @@ int LabToolDeviceComm::configureCapture(int cfgSize, quint8 * cfgData)
         usb -> comm [ label="5. CallbackForResponse()" ];
         comm -> usb [ label="6. libusb_submit_transfer(CMD_CAP_SAMPLES)" ];
         usb -> comm [ label="7. CallbackForResponse()" ];
-        comm -> usb [ label="8. libusb_submit_transfer(CMD_CAP_DATA_ONLY)" ];
-        usb -> comm [ label="9. CallbackForData()" ];
-        comm -> dev [ label="10. emit captureReceivedSamples()" ];
+        comm -> usb [ label="8. libusb_submit_transfer(CMD_CAP_DATA_ONLY) x N" ];
+        usb -> comm [ label="9. CallbackForSamples() x N" ];
+        comm -> dev [ label="10. emit captureReceivedChunk() x N" ];
+        comm -> dev [ label="11. emit captureReceivedSamples()" ];
     }
     \enddot
 */
@@ -1338,33 +1576,18 @@ int LabToolDeviceComm::runCapture()
 }
 
 /*!
-    Sends a request to the LabTool Hardware to stop/abort the ongoing signal generation.
-
-    The request is a Control Transfer and is synchronous.
-
-    A \ref generatorStopped signal will be sent to indicate that the generation has stopped.
-*/
-int LabToolDeviceComm::stopGenerator()
-{
-    if (!mConnected)
-    {
-        return -1;
-    }
-
-    // Synchronous request
-    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
-            REQ_StopGenerator, 0, INTERFACENUM, NULL, 0, 1000);
-
-    emit generatorStopped();
-
-    return ret;
-}
-
-/*!
-    Sends a request to the LabTool Hardware to configure the signal generation functionality.
-
-    The request is an asynchronous transfer. See \ref LabToolDeviceTransfer for the
-    actual format of the command.
+    Configures (optional) and starts the signal capturing on the LabTool Hardware
+    in one request. The \a cfgSize bytes in \a cfgData are sent as the
+    configuration or, if \a cfgSize is 0, the previous configuration is used.
+
+    Unlike \ref configureCapture followed by \ref runCapture there is no
+    response to wait for between the steps. The reads for the sample header
+    and for the samples are posted before the command is sent and the LabTool
+    Hardware sends the header and the samples back-to-back when the capture
+    is done. The reads for the samples are sized for the largest possible capture
+    and the LabTool Hardware ends the samples with a short or zero length packet.
+    The reads that are not needed are cancelled when the header has arrived.
+    A failure to configure or to start the capture is reported in the header.
 
     This function will trigger this sequence of events:
 
@@ -1376,34 +1599,48 @@ int LabToolDeviceComm::stopGenerator()
         dev [ label="LabToolDevice" ];
         comm [ label="LabToolDeviceComm" ];
         usb [ label="libUSBx" ];
-        dev -> comm [ label="1. configureGenerator()" ];
-        comm -> usb [ label="2. libusb_submit_transfer(CMD_GEN_CONFIG)" ];
-        usb -> comm [ label="3. CallbackForSend()" ];
-        comm -> usb [ label="4. libusb_submit_transfer(configuration data)" ];
-        usb -> comm [ label="5. CallbackForSend()" ];
-        comm -> usb [ label="6. libusb_submit_transfer(get response)" ];
+        dev -> comm [ label="1. armCapture()" ];
+        comm -> usb [ label="2. libusb_submit_transfer(CMD_CAP_SAMPLES)" ];
+        comm -> usb [ label="3. libusb_submit_transfer(CMD_CAP_DATA_ONLY) x N" ];
+        comm -> usb [ label="4. libusb_submit_transfer(CMD_CAP_ARM)" ];
+        usb -> comm [ label="5. CallbackForArm()" ];
+        comm -> usb [ label="6. libusb_submit_transfer(configuration data)" ];
         usb -> comm [ label="7. CallbackForResponse()" ];
-        comm -> dev [ label="8. emit generatorConfigurationDone()" ];
+        usb -> comm [ label="8. CallbackForSamples() x N" ];
+        comm -> dev [ label="9. emit captureReceivedChunk() x N" ];
+        comm -> dev [ label="10. emit captureReceivedSamples()" ];
     }
     \enddot
 */
-int LabToolDeviceComm::configureGenerator(int cfgSize, quint8* cfgData)
+int LabToolDeviceComm::armCapture(int cfgSize, quint8 *cfgData)
 {
     if (!mConnected)
     {
         return -1;
     }
 
-    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
-    ddt->setupForCommand(LabToolDeviceTransfer::CMD_GEN_CONFIGURE,
-                         mEndpointOut,
-                         mDeviceHandle,
-                         CallbackForSend,
-                         2000,
-                         cfgSize,
-                         cfgData);
+    LabToolDeviceTransfer* header = new LabToolDeviceTransfer(this);
+    header->setupForIncomingCommand(LabToolDeviceTransfer::CMD_CAP_SAMPLES, mEndpointIn, mDeviceHandle, CallbackForResponse, 0xffffffff, sizeof(logic_samples_header));
+    int ret = libusb_submit_transfer(header->transfer());
+    if (ret != LIBUSB_SUCCESS) {
+        transferFailed(header, ret);
+        return ret;
+    }
+    mRunningTransfer = header;
 
-    int ret = libusb_submit_transfer(ddt->transfer());
+    ret = startSampleTransfers(ARMED_TRANSFER_SIZE, true);
+    if (ret != LIBUSB_SUCCESS) {
+        qDebug("Failed to queue sample transfers, error %d: %s", ret, libusb_error_name(ret));
+        if (libusb_cancel_transfer(header->transfer()) != LIBUSB_SUCCESS) {
+            mRunningTransfer = NULL;
+        }
+        emit captureFailed("Failed to receive the captured samples.");
+        return ret;
+    }
+
+    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+    ddt->setupForCommand(LabToolDeviceTransfer::CMD_CAP_ARM, mEndpointOut, mDeviceHandle, CallbackForArm, 2000, cfgSize, cfgData);
+    ret = libusb_submit_transfer(ddt->transfer());
     if (ret != LIBUSB_SUCCESS) {
         transferFailed(ddt, ret);
     }
@@ -1412,50 +1649,913 @@ int LabToolDeviceComm::configureGenerator(int cfgSize, quint8* cfgData)
 }
 
 /*!
-    Sends a request to the LabTool Hardware to start the signal generation functionality.
+    Posts reads for \a size bytes of captured samples, in chunks of
+    \ref SAMPLE_TRANSFER_SIZE bytes. When \a armed is true the reads are
+    posted before the header has arrived and the number of reads that will
+    be needed is decided by \ref receiveSamples, otherwise all of them are
+    needed.
+*/
+int LabToolDeviceComm::startSampleTransfers(quint32 size, bool armed)
+{
+    QMutexLocker locker(&mSampleMutex);
 
-    The request is an asynchronous transfer. See \ref LabToolDeviceTransfer for the
-    actual format of the command.
+    // reads left from a previous capture are deleted in sampleTransferDone
+    // when the cancellation completes
+    foreach(LabToolDeviceTransfer* ddt, mSampleTransfers) {
+        libusb_cancel_transfer(ddt->transfer());
+    }
+    mSampleTransfers.clear();
+    mSampleTransfersNeeded = armed ? -1 : 0;
 
-    This function will trigger this sequence of events:
+    int ret = LIBUSB_SUCCESS;
+    quint32 offset = 0;
+    while (offset < size)
+    {
+        quint32 chunkSize = qMin(size - offset, (quint32)SAMPLE_TRANSFER_SIZE);
 
-    \dot
-    digraph example {
-        rankdir=LR
-        node [shape=box, fontname=Helvetica, fontsize=10];
-        edge [arrowhead="open", style="solid", fontname=Helvetica, fontsize=10];
-        dev [ label="LabToolDevice" ];
-        comm [ label="LabToolDeviceComm" ];
-        usb [ label="libUSBx" ];
-        dev -> comm [ label="1. runGenerator()" ];
-        comm -> usb [ label="2. libusb_submit_transfer(CMD_GEN_RUN)" ];
-        usb -> comm [ label="3. CallbackForSend()" ];
-        comm -> usb [ label="4. libusb_submit_transfer(get response)" ];
-        usb -> comm [ label="5. CallbackForResponse()" ];
-        comm -> dev [ label="6. emit generatorRunning()" ];
+        // Deallocation: in sampleTransferDone()
+        LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+        ddt->setupForIncomingData(mEndpointIn, mDeviceHandle, CallbackForSamples, armed ? 0 : 2000, chunkSize, 0);
+
+        ret = libusb_submit_transfer(ddt->transfer());
+        if (ret != LIBUSB_SUCCESS)
+        {
+            delete ddt;
+            break;
+        }
+        mSampleTransfers.append(ddt);
+        offset += chunkSize;
     }
-    \enddot
+
+    if (ret != LIBUSB_SUCCESS)
+    {
+        mSampleTransfersNeeded = 0;
+        foreach(LabToolDeviceTransfer* ddt, mSampleTransfers) {
+            libusb_cancel_transfer(ddt->transfer());
+        }
+        mSampleTransfers.clear();
+    }
+    else if (!armed)
+    {
+        mSampleTransfersNeeded = mSampleTransfers.size();
+    }
+
+    return ret;
+}
+
+/*!
+    Called when the header for \a size bytes of captured samples has been
+    received. If the capture was armed with \ref armCapture the reads are
+    already posted and the ones that are not needed are cancelled, otherwise
+    the reads are posted now.
 */
-int LabToolDeviceComm::runGenerator()
+int LabToolDeviceComm::receiveSamples(quint32 size)
 {
-    if (!mConnected)
     {
-        return -1;
+        QMutexLocker locker(&mSampleMutex);
+
+        mSampleBytesLeft = size;
+        if (mSampleTransfersNeeded < 0)
+        {
+            // The samples end with a short or zero length packet so the read
+            // that gets it is the last one needed
+            mSampleTransfersNeeded = 0;
+            if (size > 0)
+            {
+                mSampleTransfersNeeded = qMin((int)(size / SAMPLE_TRANSFER_SIZE) + 1, mSampleTransfers.size());
+            }
+            while (mSampleTransfers.size() > mSampleTransfersNeeded)
+            {
+                // a successful transfer cancellation will always get a callback which will delete it
+                libusb_cancel_transfer(mSampleTransfers.takeLast()->transfer());
+            }
+            if (mSampleTransfersNeeded == 0)
+            {
+                samplesReceived();
+            }
+            return LIBUSB_SUCCESS;
+        }
+
+        if (size == 0)
+        {
+            samplesReceived();
+            return LIBUSB_SUCCESS;
+        }
     }
 
-    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
-    ddt->setupForCommand(LabToolDeviceTransfer::CMD_GEN_RUN,
-                         mEndpointOut,
-                         mDeviceHandle,
-                         CallbackForSend,
-                         2000);
+    return startSampleTransfers(size, false);
+}
 
-    int ret = libusb_submit_transfer(ddt->transfer());
-    if (ret != LIBUSB_SUCCESS) {
-        transferFailed(ddt, ret);
+/*!
+    Cancels all posted reads of captured samples. The transfers are
+    deallocated as their cancellation completes.
+*/
+void LabToolDeviceComm::cancelSampleTransfers()
+{
+    QMutexLocker locker(&mSampleMutex);
+
+    mSampleTransfersNeeded = 0;
+    foreach(LabToolDeviceTransfer* ddt, mSampleTransfers) {
+        libusb_cancel_transfer(ddt->transfer());
     }
+    mSampleTransfers.clear();
+}
 
-    return ret;
+/*!
+    Called from \a CallbackForSamples when a read of captured samples has
+    completed. The received chunk is sent with the \ref captureReceivedChunk
+    signal and when the last chunk has been received the \ref captureReceivedSamples
+    signal is sent.
+
+    Sends a \ref captureFailed signal if the transfer failed for any
+    other reason than being cancelled or if not all samples were received.
+*/
+void LabToolDeviceComm::sampleTransferDone(LabToolDeviceTransfer *transfer)
+{
+    QMutexLocker locker(&mSampleMutex);
+
+    struct libusb_transfer* t = transfer->transfer();
+    bool expected = (mSampleTransfersNeeded > 0 && mSampleTransfers.first() == transfer);
+
+    if (!mSampleTransfers.removeOne(transfer) || !transfer->validSequenceNumber())
+    {
+        // cancelled or from an old capture
+        delete transfer;
+        return;
+    }
+
+    if (t->status == LIBUSB_TRANSFER_COMPLETED && expected)
+    {
+        quint32 received = qMin((quint32)t->actual_length, mSampleBytesLeft);
+        if (received > 0)
+        {
+            QVector<quint8> chunk(received);
+            memcpy(chunk.data(), transfer->data(), received);
+            emit captureReceivedChunk(chunk);
+            mSampleBytesLeft -= received;
+        }
+        mSampleTransfersNeeded--;
+
+        if (mSampleTransfersNeeded == 0 && mSampleBytesLeft == 0)
+        {
+            samplesReceived();
+        }
+        else if (mSampleTransfersNeeded == 0 || t->actual_length < t->length)
+        {
+            qDebug("Missing %u bytes of samples", mSampleBytesLeft);
+            mSampleTransfersNeeded = 0;
+            foreach(LabToolDeviceTransfer* ddt, mSampleTransfers) {
+                libusb_cancel_transfer(ddt->transfer());
+            }
+            mSampleTransfers.clear();
+            mSampleTransferTimer.invalidate();
+            emit captureFailed("Did not receive all of the captured samples.");
+        }
+    }
+    else if (t->status != LIBUSB_TRANSFER_CANCELLED)
+    {
+        // the transfer failed or data arrived before the header
+        qDebug("%s: Got transfer error: %s", transfer->commandString(), transfer->transferErrorString());
+        mSampleTransfersNeeded = 0;
+        foreach(LabToolDeviceTransfer* ddt, mSampleTransfers) {
+            libusb_cancel_transfer(ddt->transfer());
+        }
+        mSampleTransfers.clear();
+        mSampleTransferTimer.invalidate();
+        emit captureFailed(transfer->transferErrorString());
+        if (t->status != LIBUSB_TRANSFER_COMPLETED) {
+            emit connectionStatus(false);
+        }
+    }
+
+    delete transfer;
+}
+
+/*!
+    Reports that all captured samples have been received with the
+    \ref captureReceivedTransferTime, \ref captureReceivedTelemetry and
+    \ref captureReceivedSamples signals. Must be called with the sample
+    mutex locked.
+*/
+void LabToolDeviceComm::samplesReceived()
+{
+    quint32 bytes = sampleHeader.digitalBufferSize + sampleHeader.analogBufferSize;
+    double msecs = 0;
+
+    if (mSampleTransferTimer.isValid()) {
+        // The samples are sent by the USB DMA in the hardware as fast as they
+        // are read so this gives the throughput of the USB link
+        msecs = mSampleTransferTimer.nsecsElapsed() / 1000000.0;
+        mSampleTransferTimer.invalidate();
+    }
+
+    emit captureReceivedTransferTime(bytes, msecs);
+    emit captureReceivedTelemetry(sampleHeader.telemetry);
+    emit captureReceivedSamples(bytes, sampleHeader.triggerInfo, sampleHeader.digitalTrigSample, sampleHeader.analogTrigSample, sampleHeader.digitalChannelInfo, sampleHeader.analogChannelInfo, sampleHeader.signalTrim, sampleHeader.trigSample);
+}
+
+/*!
+    Sends a request to the LabTool Hardware to stop/abort the ongoing signal generation.
+
+    The request is a Control Transfer and is synchronous.
+
+    A streamed generation is stopped first and the request is not sent until
+    all of its transfers have completed. The LabTool Hardware discards the
+    streamed data it has already received when it gets the request, so the
+    next command cannot be mistaken for streamed data.
+
+    A \ref generatorStopped signal will be sent to indicate that the generation has stopped.
+*/
+int LabToolDeviceComm::stopGenerator()
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    stopGeneratorStream();
+    {
+        QMutexLocker locker(&mStreamMutex);
+        while (mStream != NULL)
+        {
+            if (!mStreamDone.wait(&mStreamMutex, 1000))
+            {
+                qDebug("Timeout waiting for the stream transfers to be cancelled");
+                break;
+            }
+        }
+    }
+
+    // Synchronous request
+    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+            REQ_StopGenerator, 0, INTERFACENUM, NULL, 0, 1000);
+
+    emit generatorStopped();
+
+    return ret;
+}
+
+/*!
+    Sends a request to the LabTool Hardware to configure the signal generation functionality.
+
+    The request is an asynchronous transfer. See \ref LabToolDeviceTransfer for the
+    actual format of the command.
+
+    This function will trigger this sequence of events:
+
+    \dot
+    digraph example {
+        rankdir=LR
+        node [shape=box, fontname=Helvetica, fontsize=10];
+        edge [arrowhead="open", style="solid", fontname=Helvetica, fontsize=10];
+        dev [ label="LabToolDevice" ];
+        comm [ label="LabToolDeviceComm" ];
+        usb [ label="libUSBx" ];
+        dev -> comm [ label="1. configureGenerator()" ];
+        comm -> usb [ label="2. libusb_submit_transfer(CMD_GEN_CONFIG)" ];
+        usb -> comm [ label="3. CallbackForSend()" ];
+        comm -> usb [ label="4. libusb_submit_transfer(configuration data)" ];
+        usb -> comm [ label="5. CallbackForSend()" ];
+        comm -> usb [ label="6. libusb_submit_transfer(get response)" ];
+        usb -> comm [ label="7. CallbackForResponse()" ];
+        comm -> dev [ label="8. emit generatorConfigurationDone()" ];
+    }
+    \enddot
+
+    If \a patternSize is larger than zero then the encoded digital pattern in
+    \a patternData is first sent with a CMD_GEN_PATTERN command. If \a lutSize
+    is larger than zero then the analog lookup tables in \a lutData are sent
+    next with a CMD_GEN_ANALOG_LUT command. The configuration is kept and sent
+    when the LabTool Hardware has stored the pattern and lookup tables.
+*/
+int LabToolDeviceComm::configureGenerator(int cfgSize, quint8* cfgData, int patternSize, const quint8* patternData, int lutSize, const quint8* lutData)
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    mPendingGeneratorConfig.resize(cfgSize);
+    memcpy(mPendingGeneratorConfig.data(), cfgData, cfgSize);
+
+    mPendingGeneratorLut.resize(lutSize);
+    if (lutSize > 0) {
+        memcpy(mPendingGeneratorLut.data(), lutData, lutSize);
+    }
+
+    if (patternSize > 0)
+    {
+        return sendGeneratorCommand(LabToolDeviceTransfer::CMD_GEN_PATTERN, patternSize, patternData);
+    }
+
+    return sendPendingGeneratorData();
+}
+
+/*!
+    Sends the next part of the generator configuration that
+    \ref configureGenerator has kept, i.e. either the analog lookup
+    tables or the configuration itself.
+*/
+int LabToolDeviceComm::sendPendingGeneratorData()
+{
+    if (!mPendingGeneratorLut.isEmpty())
+    {
+        QVector<quint8> lut = mPendingGeneratorLut;
+        mPendingGeneratorLut.clear();
+        return sendGeneratorCommand(LabToolDeviceTransfer::CMD_GEN_ANALOG_LUT, lut.size(), lut.constData());
+    }
+
+    QVector<quint8> cfg = mPendingGeneratorConfig;
+    mPendingGeneratorConfig.clear();
+    return sendGeneratorCommand(LabToolDeviceTransfer::CMD_GEN_CONFIGURE, cfg.size(), cfg.constData());
+}
+
+/*!
+    Sends the generator command \a cmd with \a size bytes of \a data
+    as payload.
+*/
+int LabToolDeviceComm::sendGeneratorCommand(LabToolDeviceTransfer::Commands cmd, int size, const quint8 *data)
+{
+    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+    ddt->setupForCommand(cmd,
+                         mEndpointOut,
+                         mDeviceHandle,
+                         CallbackForSend,
+                         2000,
+                         size,
+                         data);
+
+    int ret = libusb_submit_transfer(ddt->transfer());
+    if (ret != LIBUSB_SUCCESS) {
+        transferFailed(ddt, ret);
+    }
+
+    return ret;
+}
+
+/*!
+    Sends a request to the LabTool Hardware to start the signal generation functionality.
+
+    The request is an asynchronous transfer. See \ref LabToolDeviceTransfer for the
+    actual format of the command.
+
+    This function will trigger this sequence of events:
+
+    \dot
+    digraph example {
+        rankdir=LR
+        node [shape=box, fontname=Helvetica, fontsize=10];
+        edge [arrowhead="open", style="solid", fontname=Helvetica, fontsize=10];
+        dev [ label="LabToolDevice" ];
+        comm [ label="LabToolDeviceComm" ];
+        usb [ label="libUSBx" ];
+        dev -> comm [ label="1. runGenerator()" ];
+        comm -> usb [ label="2. libusb_submit_transfer(CMD_GEN_RUN)" ];
+        usb -> comm [ label="3. CallbackForSend()" ];
+        comm -> usb [ label="4. libusb_submit_transfer(get response)" ];
+        usb -> comm [ label="5. CallbackForResponse()" ];
+        comm -> dev [ label="6. emit generatorRunning()" ];
+    }
+    \enddot
+*/
+int LabToolDeviceComm::runGenerator()
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+    ddt->setupForCommand(LabToolDeviceTransfer::CMD_GEN_RUN,
+                         mEndpointOut,
+                         mDeviceHandle,
+                         CallbackForSend,
+                         2000);
+
+    int ret = libusb_submit_transfer(ddt->transfer());
+    if (ret != LIBUSB_SUCCESS) {
+        transferFailed(ddt, ret);
+    }
+
+    return ret;
+}
+
+/*!
+    Starts streaming digital signal data from \a stream to the LabTool
+    Hardware. Must be called after \ref generatorRunning has been received
+    for a configuration with streamed digital signals.
+
+    A number of transfers are queued and each one is refilled from the
+    \a stream and resubmitted as soon as the LabTool Hardware has accepted
+    it. The stream continues until \ref stopGeneratorStream or
+    \ref stopGenerator is called or a transfer fails, in which case a
+    \ref generatorRunFailed signal is sent.
+
+    This instance takes ownership of the \a stream.
+*/
+int LabToolDeviceComm::startGeneratorStream(LabToolGeneratorStream *stream)
+{
+    if (!mConnected)
+    {
+        delete stream;
+        return -1;
+    }
+
+    stopGeneratorStream();
+
+    QMutexLocker locker(&mStreamMutex);
+
+    if (mStream != NULL)
+    {
+        // the transfers of the previous stream have not completed yet
+        delete stream;
+        return LIBUSB_ERROR_BUSY;
+    }
+
+    // Deallocation: in streamTransferDone() when the last transfer has completed
+    mStream = stream;
+    mStreamStopping = false;
+
+    int ret = LIBUSB_SUCCESS;
+    for (int i = 0; i < STREAM_TRANSFERS; i++)
+    {
+        // Deallocation: in streamTransferDone()
+        LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+        ddt->setupForOutgoingStream(mEndpointOut, mDeviceHandle, CallbackForStream, STREAM_TRANSFER_SIZE);
+        mStream->read(ddt->transfer()->buffer, ddt->transfer()->length);
+
+        ret = libusb_submit_transfer(ddt->transfer());
+        if (ret != LIBUSB_SUCCESS)
+        {
+            delete ddt;
+            break;
+        }
+        mStreamTransfers.append(ddt);
+    }
+
+    if (ret != LIBUSB_SUCCESS)
+    {
+        mStreamStopping = true;
+        foreach(LabToolDeviceTransfer* ddt, mStreamTransfers) {
+            libusb_cancel_transfer(ddt->transfer());
+        }
+        if (mStreamTransfers.isEmpty())
+        {
+            delete mStream;
+            mStream = NULL;
+        }
+    }
+
+    return ret;
+}
+
+/*!
+    Cancels all queued transfers of streamed digital signal data. The
+    stream is deallocated when the last transfer has been cancelled.
+*/
+void LabToolDeviceComm::stopGeneratorStream()
+{
+    QMutexLocker locker(&mStreamMutex);
+
+    if (mStream != NULL && !mStreamStopping)
+    {
+        mStreamStopping = true;
+        foreach(LabToolDeviceTransfer* ddt, mStreamTransfers) {
+            libusb_cancel_transfer(ddt->transfer());
+        }
+    }
+}
+
+/*!
+    Called from \a CallbackForStream when one of the transfers with streamed
+    digital signal data has completed. The \a transfer is refilled and
+    resubmitted until the stream is stopped.
+
+    Sends a \ref generatorRunFailed signal if the transfer failed for any
+    other reason than being cancelled.
+*/
+void LabToolDeviceComm::streamTransferDone(LabToolDeviceTransfer *transfer)
+{
+    QMutexLocker locker(&mStreamMutex);
+
+    struct libusb_transfer* t = transfer->transfer();
+    if (!mStreamStopping && t->status == LIBUSB_TRANSFER_COMPLETED)
+    {
+        mStream->read(t->buffer, t->length);
+        int ret = libusb_submit_transfer(t);
+        if (ret == LIBUSB_SUCCESS) {
+            return;
+        }
+        qDebug("Failed to resubmit stream transfer, error %d: %s", ret, libusb_error_name(ret));
+    }
+
+    if (!mStreamStopping)
+    {
+        // the stream is broken, stop the rest of the transfers
+        mStreamStopping = true;
+        foreach(LabToolDeviceTransfer* ddt, mStreamTransfers) {
+            if (ddt != transfer) {
+                libusb_cancel_transfer(ddt->transfer());
+            }
+        }
+        if (t->status == LIBUSB_TRANSFER_COMPLETED) {
+            emit generatorRunFailed("Failed to stream the digital signals to the LabTool Hardware.");
+        } else {
+            emit generatorRunFailed(transfer->transferErrorString());
+        }
+    }
+
+    mStreamTransfers.removeOne(transfer);
+    delete transfer;
+
+    if (mStreamTransfers.isEmpty())
+    {
+        delete mStream;
+        mStream = NULL;
+        mStreamDone.wakeAll();
+    }
+}
+
+/*!
+    Retrieves the progress of a streamed signal generation. The number of
+    blocks (32 states each) that have been generated is stored in \a blocks
+    and the number of times that the LabTool Hardware has run out of data
+    is stored in \a underruns.
+
+    The request is a Control Transfer and is synchronous.
+
+    Returns 0 on success.
+*/
+int LabToolDeviceComm::generatorStreamStatus(quint32 *blocks, quint32 *underruns)
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    quint32 buff[2];
+    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+            REQ_GetGenStatus, 0, INTERFACENUM, (unsigned char*)buff, sizeof(buff), 100);
+    if (ret != (int)sizeof(buff))
+    {
+        return (ret < 0) ? ret : LIBUSB_ERROR_IO;
+    }
+
+    *blocks = buff[0];
+    *underruns = buff[1];
+    return 0;
+}
+
+/*!
+    Retrieves the number of samples per signal that the LabTool Hardware
+    can hold with the last applied capture configuration. The sample memory
+    is split between digital and analog signals depending on which signals
+    are enabled. The depth for digital signals is stored in \a digital and
+    the depth for analog signals in \a analog (0 if none are enabled).
+
+    The request is a Control Transfer and is synchronous.
+
+    Returns 0 on success.
+*/
+int LabToolDeviceComm::captureDepth(quint32 *digital, quint32 *analog)
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    quint32 buff[2];
+    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+            REQ_GetCaptureDepth, 0, INTERFACENUM, (unsigned char*)buff, sizeof(buff), 100);
+    if (ret != (int)sizeof(buff))
+    {
+        return (ret < 0) ? ret : LIBUSB_ERROR_IO;
+    }
+
+    *digital = buff[0];
+    *analog = buff[1];
+    return 0;
+}
+
+/*!
+    Asks the LabTool Hardware for a preview of an armed capture that is
+    waiting for its trigger. The preview is a decimated copy of the most
+    recently captured samples and it is sent with the
+    \ref captureReceivedPreview signal.
+
+    The bulk endpoint is reserved for the samples of the armed capture so
+    the preview is a Control Transfer. It is synchronous and does not
+    disturb the ongoing capture.
+
+    Returns 1 if a preview was sent, 0 if there was nothing to preview and
+    a negative value on error.
+*/
+int LabToolDeviceComm::peekCapture()
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    {
+        // only while armed and waiting for the samples
+        QMutexLocker locker(&mSampleMutex);
+        if (mSampleTransfersNeeded >= 0)
+        {
+            return 0;
+        }
+    }
+
+    quint8 buff[CAPTURE_PEEK_MAX_SIZE];
+    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_IN|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+            REQ_PeekCapture, 0, INTERFACENUM, buff, sizeof(buff), 100);
+    if (ret < 0)
+    {
+        return ret;
+    }
+    if (ret < (int)sizeof(capture_peek_header_t))
+    {
+        return LIBUSB_ERROR_IO;
+    }
+
+    capture_peek_header_t header;
+    memcpy(&header, buff, sizeof(header));
+    quint32 dataSize = ret - sizeof(header);
+    if (header.step == 0 || header.digitalSize > dataSize || header.analogSize > dataSize - header.digitalSize)
+    {
+        return 0;
+    }
+
+    QVector<quint8> data(header.digitalSize + header.analogSize);
+    memcpy(data.data(), buff + sizeof(header), data.size());
+
+    emit captureReceivedPreview(header.step, header.digitalSize, header.digitalChannelInfo, header.analogChannelInfo, data);
+    return 1;
+}
+
+/*!
+    Sends changed analog settings to the LabTool Hardware without stopping
+    the capture. The \a data must be the analog part of the last applied
+    capture configuration (cap_vadc_cfg_t) with only the trigger levels and
+    edges, the V/div and the couplings changed. The firmware applies the
+    changes together the next time it arms the capture and arms a capture
+    that is waiting for its trigger again right away. A capture that has
+    already triggered completes with the old settings.
+
+    The request is a Control Transfer and is synchronous.
+
+    Returns 0 on success and a negative value if the hardware rejected the
+    changes, in which case a new configuration is needed.
+*/
+int LabToolDeviceComm::updateAnalogConfig(int size, quint8* data)
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    int ret = libusb_control_transfer(this->mDeviceHandle, LIBUSB_ENDPOINT_OUT|LIBUSB_REQUEST_TYPE_VENDOR|LIBUSB_RECIPIENT_INTERFACE,
+            REQ_UpdateAnalogConfig, 0, INTERFACENUM, data, size, 100);
+    if (ret != size)
+    {
+        return (ret < 0) ? ret : LIBUSB_ERROR_IO;
+    }
+    return 0;
+}
+
+/*!
+    Sends a request to the LabTool Hardware to configure the I2C monitor.
+    The I2C bus on the I2C connector is monitored at \a clockRate Hz (max
+    400KHz). The monitor stops after \a bytesToCapture events, or when
+    \ref stopI2CMonitor is called if \a bytesToCapture is 0.
+
+    Configuring the I2C monitor stops any ongoing signal capture or
+    generation on the LabTool Hardware.
+
+    The request is an asynchronous transfer and an
+    \ref i2cMonitorConfigurationDone signal is sent when it has completed.
+*/
+int LabToolDeviceComm::configureI2CMonitor(quint32 clockRate, quint32 bytesToCapture)
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    // Must match monitor_i2c_cfg_t in the firmware
+    quint32 cfg[2];
+    cfg[0] = clockRate;
+    cfg[1] = bytesToCapture;
+
+    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+    ddt->setupForCommand(LabToolDeviceTransfer::CMD_MON_I2C_CFG,
+                         mEndpointOut,
+                         mDeviceHandle,
+                         CallbackForSend,
+                         2000,
+                         sizeof(cfg),
+                         (const unsigned char*)cfg);
+
+    int ret = libusb_submit_transfer(ddt->transfer());
+    if (ret != LIBUSB_SUCCESS) {
+        transferFailed(ddt, ret);
+    }
+
+    return ret;
+}
+
+/*!
+    Sends a request to the LabTool Hardware to start the I2C monitor.
+    Must be called after \ref i2cMonitorConfigurationDone has been received.
+
+    This function will trigger this sequence of events:
+
+    \dot
+    digraph example {
+        rankdir=LR
+        node [shape=box, fontname=Helvetica, fontsize=10];
+        edge [arrowhead="open", style="solid", fontname=Helvetica, fontsize=10];
+        dev [ label="LabToolDevice" ];
+        comm [ label="LabToolDeviceComm" ];
+        usb [ label="libUSBx" ];
+        dev -> comm [ label="1. runI2CMonitor()" ];
+        comm -> usb [ label="2. libusb_submit_transfer(CMD_MON_I2C_RUN)" ];
+        usb -> comm [ label="3. CallbackForSend()" ];
+        comm -> usb [ label="4. libusb_submit_transfer(get response)" ];
+        usb -> comm [ label="5. CallbackForResponse()" ];
+        comm -> usb [ label="6. libusb_submit_transfer(CMD_MON_I2C_DATA) x N" ];
+        usb -> comm [ label="7. CallbackForMonitor()" ];
+        comm -> dev [ label="8. emit i2cMonitorReceivedData()" ];
+    }
+    \enddot
+
+    Steps 6 to 8 are repeated until the LabTool Hardware reports that the
+    monitor has stopped or \ref stopI2CMonitor is called.
+*/
+int LabToolDeviceComm::runI2CMonitor()
+{
+    if (!mConnected)
+    {
+        return -1;
+    }
+
+    LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+    ddt->setupForCommand(LabToolDeviceTransfer::CMD_MON_I2C_RUN, mEndpointOut, mDeviceHandle, CallbackForSend, 2000);
+    mRunningTransfer = ddt;
+
+    int ret = libusb_submit_transfer(ddt->transfer());
+    if (ret != LIBUSB_SUCCESS) {
+        transferFailed(ddt, ret);
+    }
+
+    return ret;
+}
+
+/*!
+    Sends a request to stop the I2C monitor to the LabTool Hardware and
+    cancels the queued reads.
+
+    The request is a Control Transfer and is synchronous.
+
+    A \ref captureStopped signal will be sent to indicate that the
+    monitor has stopped.
+*/
+int LabToolDeviceComm::stopI2CMonitor()
+{
+    cancelMonitorTransfers();
+    return stopCapture();
+}
+
+/*!
+    Queues the reads for the messages with captured I2C events.
+*/
+int LabToolDeviceComm::startMonitorTransfers()
+{
+    QMutexLocker locker(&mMonitorMutex);
+
+    if (!mMonitorTransfers.isEmpty())
+    {
+        // the transfers of the previous run have not completed yet
+        return LIBUSB_ERROR_BUSY;
+    }
+
+    mMonitorStopping = false;
+
+    int ret = LIBUSB_SUCCESS;
+    for (int i = 0; i < MONITOR_TRANSFERS; i++)
+    {
+        // Deallocation: in monitorTransferDone()
+        LabToolDeviceTransfer* ddt = new LabToolDeviceTransfer(this);
+        ddt->setupForIncomingCommand(LabToolDeviceTransfer::CMD_MON_I2C_DATA, mEndpointIn, mDeviceHandle, CallbackForMonitor, 0, MONITOR_TRANSFER_SIZE);
+
+        ret = libusb_submit_transfer(ddt->transfer());
+        if (ret != LIBUSB_SUCCESS)
+        {
+            delete ddt;
+            break;
+        }
+        mMonitorTransfers.append(ddt);
+    }
+
+    if (ret != LIBUSB_SUCCESS)
+    {
+        mMonitorStopping = true;
+        foreach(LabToolDeviceTransfer* ddt, mMonitorTransfers) {
+            libusb_cancel_transfer(ddt->transfer());
+        }
+    }
+
+    return ret;
+}
+
+/*!
+    Cancels all queued reads for captured I2C events. The transfers are
+    deallocated as their cancellation completes.
+*/
+void LabToolDeviceComm::cancelMonitorTransfers()
+{
+    QMutexLocker locker(&mMonitorMutex);
+
+    if (!mMonitorStopping)
+    {
+        mMonitorStopping = true;
+        foreach(LabToolDeviceTransfer* ddt, mMonitorTransfers) {
+            libusb_cancel_transfer(ddt->transfer());
+        }
+    }
+}
+
+/*!
+    Called from \a CallbackForMonitor when a message with captured I2C events
+    has been received. The events are sent with the \ref i2cMonitorReceivedData
+    signal and the \a transfer is resubmitted until the last message has been
+    received.
+
+    The received data is formatted like this:
+
+    \dot
+     digraph structs {
+         node [shape=record];
+         message [label="START | Num Events | Lost Events | Flags | {Event 0|{Timestamp|Status|Data}} | ... | Padding"];
+     }
+    \enddot
+
+    Where each part is 32 bits. Bit 0 of \a Flags is set in the last message.
+
+    Sends a \ref captureFailed signal if the transfer failed for any
+    other reason than being cancelled.
+*/
+void LabToolDeviceComm::monitorTransferDone(LabToolDeviceTransfer *transfer)
+{
+    QMutexLocker locker(&mMonitorMutex);
+
+    struct libusb_transfer* t = transfer->transfer();
+    if (!mMonitorStopping && t->status == LIBUSB_TRANSFER_COMPLETED && transfer->isValidResponse())
+    {
+        const quint32* words = (const quint32*)transfer->data();
+        quint32 numRecords = qMin(words[1], (quint32)((MONITOR_TRANSFER_SIZE/4 - MONITOR_HEADER_WORDS) / 3));
+        bool last = (words[3] & 1) != 0;
+
+        QVector<quint32> records(numRecords * 3);
+        memcpy(records.data(), words + MONITOR_HEADER_WORDS, numRecords * 3 * sizeof(quint32));
+        emit i2cMonitorReceivedData(records, words[2], last);
+
+        if (!last)
+        {
+            int ret = libusb_submit_transfer(t);
+            if (ret == LIBUSB_SUCCESS) {
+                return;
+            }
+            qDebug("Failed to resubmit I2C monitor transfer, error %d: %s", ret, libusb_error_name(ret));
+            emit captureFailed("Failed to receive data from the I2C monitor.");
+        }
+
+        // no more messages will come, the rest of the reads are not needed
+        mMonitorStopping = true;
+        foreach(LabToolDeviceTransfer* ddt, mMonitorTransfers) {
+            if (ddt != transfer) {
+                libusb_cancel_transfer(ddt->transfer());
+            }
+        }
+    }
+    else if (!mMonitorStopping)
+    {
+        // the monitor is broken, stop the rest of the transfers
+        mMonitorStopping = true;
+        foreach(LabToolDeviceTransfer* ddt, mMonitorTransfers) {
+            if (ddt != transfer) {
+                libusb_cancel_transfer(ddt->transfer());
+            }
+        }
+        if (t->status == LIBUSB_TRANSFER_COMPLETED) {
+            emit captureFailed(transfer->statusErrorString());
+        } else {
+            emit captureFailed(transfer->transferErrorString());
+        }
+    }
+
+    mMonitorTransfers.removeOne(transfer);
+    delete transfer;
 }
 
 /*!
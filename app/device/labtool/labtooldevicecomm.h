@@ -17,9 +17,14 @@
 #define LABTOOLDEVICECOMM_H
 
 #include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QElapsedTimer>
 #include "labtooldevicecommthread.h"
 #include "labtooldevicetransfer.h"
 #include "labtoolcalibrationdata.h"
+#include "labtoolgeneratorstream.h"
+#include "capture_telemetry.h"
 
 #include "libusbx/include/libusbx-1.0/libusb.h"
 
@@ -36,6 +41,21 @@ private:
     quint8                   mEndpointIn;
     quint8                   mEndpointOut;
     LabToolCalibrationData* mActiveCalibrationData;
+    QVector<quint8>          mPendingGeneratorConfig;
+    QVector<quint8>          mPendingGeneratorLut;
+    LabToolGeneratorStream*  mStream;
+    QList<LabToolDeviceTransfer*> mStreamTransfers;
+    bool                     mStreamStopping;
+    QMutex                   mStreamMutex;
+    QWaitCondition           mStreamDone;
+    QList<LabToolDeviceTransfer*> mMonitorTransfers;
+    bool                     mMonitorStopping;
+    QMutex                   mMonitorMutex;
+    QElapsedTimer            mSampleTransferTimer;
+    QList<LabToolDeviceTransfer*> mSampleTransfers;
+    int                      mSampleTransfersNeeded;
+    quint32                  mSampleBytesLeft;
+    QMutex                   mSampleMutex;
 
 public:
     explicit LabToolDeviceComm(QObject *parent = 0);
@@ -46,16 +66,30 @@ public:
     int stopCapture();
     int configureCapture(int cfgSize, quint8 * cfgData);
     int runCapture();
+    int armCapture(int cfgSize = 0, quint8* cfgData = NULL);
 
     int stopGenerator();
-    int configureGenerator(int cfgSize, quint8* cfgData);
+    int configureGenerator(int cfgSize, quint8* cfgData, int patternSize=0, const quint8* patternData=NULL, int lutSize=0, const quint8* lutData=NULL);
     int runGenerator();
+    int startGeneratorStream(LabToolGeneratorStream* stream);
+    void stopGeneratorStream();
+    int generatorStreamStatus(quint32* blocks, quint32* underruns);
+    int captureDepth(quint32* digital, quint32* analog);
+    int peekCapture();
+    int updateAnalogConfig(int size, quint8* data);
+
+    int configureI2CMonitor(quint32 clockRate, quint32 bytesToCapture=0);
+    int runI2CMonitor();
+    int stopI2CMonitor();
 
     int ping();
 
     void transferSuccess(LabToolDeviceTransfer* transfer);
     void transferSuccessErrorResponse(LabToolDeviceTransfer* transfer);
     void transferFailed(LabToolDeviceTransfer* transfer, int libusb_error=LIBUSB_SUCCESS);
+    void streamTransferDone(LabToolDeviceTransfer* transfer);
+    void monitorTransferDone(LabToolDeviceTransfer* transfer);
+    void sampleTransferDone(LabToolDeviceTransfer* transfer);
 
     bool connectToDevice(bool quiet=true);
     void disconnectFromDevice();
@@ -72,15 +106,33 @@ public:
     void calibrationEnd();
     LabToolCalibrationData* storedCalibrationData(bool forceReload=false);
 
+private:
+    int sendPendingGeneratorData();
+    int sendGeneratorCommand(LabToolDeviceTransfer::Commands cmd, int size, const quint8* data);
+    int startMonitorTransfers();
+    void cancelMonitorTransfers();
+    int startSampleTransfers(quint32 size, bool armed);
+    int receiveSamples(quint32 size);
+    void cancelSampleTransfers();
+    void samplesReceived();
+
 signals:
     void connectionStatus(bool connected);
 
     void captureStopped();
     void captureConfigurationDone();
-    void captureReceivedSamples(LabToolDeviceTransfer* transfer, unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int activeDigital, unsigned int activeAnalog, int signalTrim);
+    void captureReceivedHeader(unsigned int digitalSize, unsigned int analogSize, unsigned int activeDigital, unsigned int activeAnalog);
+    void captureReceivedChunk(QVector<quint8> chunk);
+    void captureReceivedSamples(unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int activeDigital, unsigned int activeAnalog, int signalTrim, unsigned int trigSample);
+    void captureReceivedTelemetry(capture_telemetry_t telemetry);
+    void captureReceivedTransferTime(unsigned int size, double msecs);
+    void captureReceivedPreview(unsigned int step, unsigned int digitalSize, unsigned int activeDigital, unsigned int activeAnalog, QVector<quint8> data);
     void captureFailed(const char* msg);
     void captureConfigurationFailed(const char* msg);
 
+    void i2cMonitorConfigurationDone();
+    void i2cMonitorReceivedData(QVector<quint32> records, unsigned int lost, bool last);
+
     void generatorStopped();
     void generatorConfigurationDone();
     void generatorConfigurationFailed(const char* msg);
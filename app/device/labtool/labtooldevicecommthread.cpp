@@ -21,6 +21,9 @@
 #include <QCoreApplication>
 #include <QDebug>
 
+/*! Milliseconds between the previews of an armed capture, see \ref LabToolDeviceComm::peekCapture */
+#define PREVIEW_INTERVAL  (250)
+
 /*!
     \class LabToolDeviceCommThread
     \brief Drives the libusbx USB stack and looks for LabTool Hardware to connect to
@@ -63,10 +66,12 @@ void LabToolDeviceCommThread::run()
 {
     int err;
     timeval tv;
-    tv.tv_sec = 1;
-    tv.tv_usec = 0;
+    tv.tv_sec = 0;
+    tv.tv_usec = 100000; // short enough to keep the preview interval
     QTime time;
     time.start();
+    QTime previewTime;
+    previewTime.start();
 
     // Deallocation:
     //   By connecting finished to deleteLater, this object should be deleted
@@ -98,6 +103,11 @@ void LabToolDeviceCommThread::run()
                 mDeviceComm->ping();
                 time.restart();
             }
+
+            if (previewTime.elapsed() >= PREVIEW_INTERVAL) {
+                mDeviceComm->peekCapture();
+                previewTime.restart();
+            }
         }
     }
 
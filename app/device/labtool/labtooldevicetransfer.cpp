@@ -128,6 +128,40 @@ LabToolDeviceTransfer::~LabToolDeviceTransfer()
     \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_CAL_END
     Sent to end the calibration sequence
 */
+/*!
+    \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_GEN_PATTERN
+    Sent before CMD_GEN_CONFIGURE with an encoded digital pattern that is
+    too long to fit in the configuration
+*/
+/*!
+    \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_GEN_STREAM
+    Internal command, never sent to the LabTool Hardware, but
+    used to mark the transfers with streamed digital signal data
+*/
+/*!
+    \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_GEN_ANALOG_LUT
+    Sent before CMD_GEN_CONFIGURE with the precalculated lookup tables for
+    arbitrary analog waveforms
+*/
+/*!
+    \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_MON_I2C_CFG
+    Sent to configure the I2C monitor
+*/
+/*!
+    \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_MON_I2C_RUN
+    Sent to start the I2C monitor
+*/
+/*!
+    \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_MON_I2C_DATA
+    Received from the LabTool Hardware with captured I2C events while
+    the I2C monitor is running
+*/
+/*!
+    \var LabToolDeviceTransfer::Commands LabToolDeviceTransfer::CMD_CAP_ARM
+    Sent with an optional configuration to arm the signal capturing. There
+    is no response, the LabTool Hardware sends the sample header and the
+    samples when the capture is done
+*/
 
 
 /*!
@@ -138,9 +172,14 @@ LabToolDeviceTransfer::~LabToolDeviceTransfer()
     Command           | Endpoint | Callback            | Payload
     ----------------- | :------: | ------------------- | :-----:
     CMD_GEN_CONFIGURE |   OUT    | CallbackForSend     |   Yes
+    CMD_GEN_PATTERN   |   OUT    | CallbackForSend     |   Yes
+    CMD_GEN_ANALOG_LUT|   OUT    | CallbackForSend     |   Yes
     CMD_GEN_RUN       |   OUT    | CallbackForResponse |   No
     CMD_CAP_CONFIGURE |   OUT    | CallbackForSend     |   Yes
     CMD_CAP_RUN       |   OUT    | CallbackForSend     |   No
+    CMD_MON_I2C_CFG   |   OUT    | CallbackForSend     |   Yes
+    CMD_MON_I2C_RUN   |   OUT    | CallbackForSend     |   No
+    CMD_CAP_ARM       |   OUT    | CallbackForArm      | Optional
 
     The \a deviceHandle parameter is needed by libusbx, \a timeout specifies in milliseconds
     when a transfer should be aborted.
@@ -267,6 +306,7 @@ void LabToolDeviceTransfer::setupForResponse(unsigned char endpoint, libusb_tran
     Command           | Endpoint | Callback            | Payload
     ----------------- | :------: | ------------------- | :-----:
     CMD_CAP_SAMPLES   |   IN     | CallbackForResponse |   Yes
+    CMD_MON_I2C_DATA  |   IN     | CallbackForMonitor  |   Yes
 
     The \a deviceHandle parameter is needed by libusbx, \a timeout specifies in milliseconds
     when a transfer should be aborted.
@@ -317,7 +357,7 @@ void LabToolDeviceTransfer::setupForIncomingCommand(Commands cmd, unsigned char
     The \a deviceHandle parameter is needed by libusbx, \a timeout specifies in milliseconds
     when a transfer should be aborted.
 
-    The \a callback parameter should always be the CallbackForData function.
+    The \a callback parameter should always be the CallbackForSamples function.
 
     The \a digitalPayloadSize parameter specifies how many bytes of digital samples to receive.
     The \a analogPayloadSize parameter specifies how many bytes of analog samples to receive.
@@ -351,6 +391,30 @@ void LabToolDeviceTransfer::setupForIncomingData(unsigned char endpoint, libusb_
                               timeout * TIMEOUT_MULTIPLIER);
 }
 
+/*!
+    Prepares a transfer of \a payloadSize bytes of streamed digital signal data
+    to the LabTool Hardware. The transfer has no header and no response and it
+    never times out as the LabTool Hardware only accepts the data when there is
+    room for it. The data must be written into the transfer's buffer before it
+    is submitted.
+*/
+void LabToolDeviceTransfer::setupForOutgoingStream(unsigned char endpoint, libusb_device_handle *deviceHandle, libusb_transfer_cb_fn callback, int payloadSize)
+{
+    mData.clear();
+    mData.resize(payloadSize);
+
+    mCmd = CMD_GEN_STREAM;
+
+    libusb_fill_bulk_transfer(mTransfer,
+                              deviceHandle,
+                              endpoint,
+                              mData.data(),
+                              mData.size(),
+                              callback,
+                              this,
+                              0);
+}
+
 /*!
     Verifies that the first received byte is 0xEA and that the Command byte corresponds
     to the Command that this transfer is configured for.
@@ -446,6 +510,11 @@ const char *LabToolDeviceTransfer::statusErrorString()
                     " * Max 80MHz sample rate when capturing D0 to D3.\n" \
                     " * Max 40MHz sample rate when capturing D0 to D7.\n" \
                     " * Max 20MHz sample rate when capturing D0 to D10.";
+        case 13: return "Invalid pattern trigger! The signals in the pattern must all be\n" \
+                    "added and the pattern cannot be combined with edge triggers.";
+        case 14: return "Digital samples were lost during the capture!\n\n" \
+                    "The sample rate is too high for the DMA to keep up. Lower the\n" \
+                    "sample rate or capture fewer signals.";
 
         /* Related to Signal Generation */
         case 25: return "CMD_STATUS_ERR_NOTHING_TO_GENERATE";
@@ -454,11 +523,13 @@ const char *LabToolDeviceTransfer::statusErrorString()
         case 28: return "CMD_STATUS_ERR_GEN_INVALID_RUN_COUNTER";
         case 29: return "CMD_STATUS_ERR_GEN_INVALID_NUMBER_OF_STATES";
         case 30: return "CMD_STATUS_ERR_GEN_INVALID_AMPLITUDE";
+        case 31: return "CMD_STATUS_ERR_GEN_INVALID_PATTERN";
 
         /* Related to I2C monitoring */
         case 40: return "CMD_STATUS_ERR_MON_I2C_PCA95555_FAILED";
         case 41: return "CMD_STATUS_ERR_MON_I2C_INVALID_RATE";
         case 42: return "CMD_STATUS_ERR_MON_I2C_NOT_CONFIGURED";
+        case 43: return "CMD_STATUS_ERR_MON_I2C_INVALID_CONFIG";
 
         /* Related to calibration of analog signals */
         case 50: return "CMD_STATUS_ERR_CAL_AOUT_INVALID_PARAMS";
@@ -481,10 +552,17 @@ const char *LabToolDeviceTransfer::commandString()
     {
     case CMD_GEN_CONFIGURE: return "CMD_GEN_CONFIGURE";
     case CMD_GEN_RUN:       return "CMD_GEN_RUN";
+    case CMD_GEN_PATTERN:   return "CMD_GEN_PATTERN";
+    case CMD_GEN_ANALOG_LUT: return "CMD_GEN_ANALOG_LUT";
     case CMD_CAP_CONFIGURE: return "CMD_CAP_CONFIGURE";
     case CMD_CAP_RUN:       return "CMD_CAP_RUN";
     case CMD_CAP_SAMPLES:   return "CMD_CAP_SAMPLES";
     case CMD_CAP_DATA_ONLY: return "CMD_CAP_DATA_ONLY";
+    case CMD_CAP_ARM:       return "CMD_CAP_ARM";
+    case CMD_GEN_STREAM:    return "CMD_GEN_STREAM";
+    case CMD_MON_I2C_CFG:   return "CMD_MON_I2C_CFG";
+    case CMD_MON_I2C_RUN:   return "CMD_MON_I2C_RUN";
+    case CMD_MON_I2C_DATA:  return "CMD_MON_I2C_DATA";
     default:                return "Unknown command";
     }
 }
@@ -43,7 +43,17 @@ public:
         CMD_CAL_RESULT     = 10,
         CMD_CAL_STORE      = 11,
         CMD_CAL_ERASE      = 12,
-        CMD_CAL_END        = 13
+        CMD_CAL_END        = 13,
+
+        CMD_GEN_PATTERN    = 14,
+        CMD_GEN_STREAM     = 15,
+        CMD_GEN_ANALOG_LUT = 16,
+
+        CMD_MON_I2C_CFG    = 17,
+        CMD_MON_I2C_RUN    = 18,
+        CMD_MON_I2C_DATA   = 19,
+
+        CMD_CAP_ARM        = 20
     };
 
     void setupForCommand(Commands cmd,
@@ -73,6 +83,10 @@ public:
                               unsigned int timeout,
                               int digitalPayloadSize,
                               int analogPayloadSize);
+    void setupForOutgoingStream(unsigned char endpoint,
+                                libusb_device_handle* deviceHandle,
+                                libusb_transfer_cb_fn callback,
+                                int payloadSize);
 
     bool isValidResponse();
     bool successful();
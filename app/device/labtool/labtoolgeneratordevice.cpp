@@ -17,6 +17,50 @@
 
 #include <QDebug>
 
+#include "gen_pattern.h"
+
+/*!
+    Largest number of states that can be sent in the \a patterns member
+    of \a gen_sgpio_cfg_t. Longer patterns are encoded and sent separately.
+*/
+#define MAX_RAW_STATES  256
+
+/*!
+    Largest encoded pattern (in bytes) that the LabTool Hardware can store.
+*/
+#define MAX_ENCODED_SIZE  0xfffc
+
+/*!
+    Highest data rate (in bytes per second) that digital signals will be
+    streamed to the LabTool Hardware with. Signals that cannot be encoded
+    and would require a higher rate are rejected.
+*/
+#define MAX_STREAM_RATE  (8*1024*1024)
+
+/*!
+    Interval in milliseconds between the checks for underruns when the
+    digital signals are streamed.
+*/
+#define STREAM_POLL_INTERVAL  250
+
+/*!
+    Waveform value used by the LabTool Hardware for arbitrary waveforms.
+    The other waveforms have the same value as AnalogSignal::AnalogWaveform.
+*/
+#define GEN_DAC_CFG_WAVE_ARBITRARY  6
+
+/*!
+    Number of entries in the LabTool Hardware's lookup table for each analog
+    output.
+*/
+#define MAX_LUT_SIZE  2000
+
+/*!
+    Highest rate (in Hz) that the LabTool Hardware updates the DAC with. The
+    rate is shared between the enabled analog outputs.
+*/
+#define MAX_DAC_FREQ  300000
+
 /*!
     @brief Configuration of the digital signal(s) to generate.
 
@@ -27,7 +71,8 @@ typedef struct
 {
   uint32_t enabledChannels; /*!< using bits 0-10, a 1 means enabled */
   uint32_t frequency;       /*!< Frequency of generated signal */
-  uint32_t numStates;       /*!< Bits per channel 1..256 */
+  uint32_t numStates;       /*!< Bits per channel 1..256, or total number of states if encoded */
+  uint32_t encodedSize;     /*!< 0 to use \a patterns, otherwise size in bytes of the encoded pattern */
   uint32_t patterns[8][11];  /*!< Up to 8*32 states for up to 11 channels */
 } gen_sgpio_cfg_t;
 
@@ -48,11 +93,13 @@ typedef struct
    *   3   | Sawtooth
    *   4   | Reverse (or inverse) Sawtooth
    *   5   | Level (outputs DC offset, ignores amplitude)
+   *   6   | Arbitrary (lookup table sent with CMD_GEN_ANALOG_LUT)
    */
   uint32_t waveform;
   uint32_t frequency; /*!< Frequency in Hz */
   uint32_t amplitude; /*!< Amplitude in mV, 0..5000 */
   int32_t  dcOffset;  /*!< DC offset in mV, -5000..5000 */
+  uint32_t lutSize;   /*!< Entries in the uploaded lookup table, only for arbitrary waveform */
 } gen_dac_one_ch_cfg_t;
 
 /*!
@@ -77,7 +124,7 @@ typedef struct
 typedef struct
 {
   uint32_t         available;  /*!< Bitmask, bit0=SGPIO, bit1=DAC */
-  uint32_t         runCounter; /*!< 0=countinuous run, 1=run only once, >1 currently invalid */
+  uint32_t         runCounter; /*!< 0=countinuous run, 1=run only once, 2=digital signal streamed, >2 invalid */
   gen_sgpio_cfg_t  sgpio;      /*!< Configuration of digital signals */
   gen_dac_cfg_t    dac;        /*!< Configuration of analog signals */
 } generator_cfg_t;
@@ -91,6 +138,17 @@ typedef struct
     The LabToolGeneratorDevice class provides the interface to the Generator
     functionality of the LabTool Hardware. Generator functionality means
     being able to generate digital and/or analog output signals.
+
+    Digital signals that are too long or too irregular to be stored in the
+    LabTool Hardware are streamed to it while generating, see
+    \ref LabToolGeneratorStream. That only works for continuous generation
+    and at rates low enough for the USB connection to keep up. Signals with
+    a UART stream are always streamed, with the UART data created while
+    streaming (see LabToolUartStream).
+
+    Arbitrary analog waveforms are resampled, calibrated and converted into
+    DAC values here and then sent to the LabTool Hardware as ready to use
+    lookup tables.
 */
 
 /*!
@@ -103,6 +161,11 @@ LabToolGeneratorDevice::LabToolGeneratorDevice(QObject *parent) :
     mData = NULL;
     mContinuousRun = false;
     mDigitalRate = 1;
+    mDigitalBlockSize = 0;
+    mStreamed = false;
+
+    mStreamTimer.setInterval(STREAM_POLL_INTERVAL);
+    connect(&mStreamTimer, SIGNAL(timeout()), this, SLOT(handleStreamTimer()));
 
     mConfigMustBeUpdated = true;
     mLastUsedDigitalRate = 1;
@@ -129,8 +192,18 @@ void LabToolGeneratorDevice::start(int digitalRate, bool loop)
 
     if (hasConfigChanged())
     {
+        quint8* data = configData(digitalRate);
+        if (data == NULL)
+        {
+            emit generateFinished(false, mConfigError);
+            return;
+        }
         mDeviceComm->configureGenerator(configSize(),
-                                        configData(digitalRate));
+                                        data,
+                                        mPatternData.size()*sizeof(quint32),
+                                        (const quint8*)mPatternData.constData(),
+                                        mAnalogLut.size()*sizeof(quint16),
+                                        (const quint8*)mAnalogLut.constData());
     }
     else
     {
@@ -140,10 +213,20 @@ void LabToolGeneratorDevice::start(int digitalRate, bool loop)
 
 void LabToolGeneratorDevice::stop()
 {
+    mStreamTimer.stop();
     mDeviceComm->stopGenerator();
     emit generateFinished(true, "");
 }
 
+/*!
+    Returns the analog waveforms that the LabTool Hardware can generate.
+*/
+QList<AnalogSignal::AnalogWaveform> LabToolGeneratorDevice::supportedAnalogWaveforms()
+{
+    return GeneratorDevice::supportedAnalogWaveforms()
+            << AnalogSignal::WaveformArbitrary;
+}
+
 /*!
     Sets the communication interface to the LabTool Hardware. Should
     be called with \a comm as NULL when the connection to the LabTool Hardware
@@ -168,6 +251,7 @@ void LabToolGeneratorDevice::setDeviceComm(LabToolDeviceComm *comm)
 void LabToolGeneratorDevice::handleStopped()
 {
     qDebug("Generator stopped");
+    mStreamTimer.stop();
     emit generateFinished(true, "");
 }
 
@@ -203,6 +287,8 @@ void LabToolGeneratorDevice::handleConfigurationFailure(const char *msg)
     If \a loop was false then a \ref generateFinished signal will be sent to
     indicate that the one-shot generation was successfully completed.
 
+    If the digital signals are streamed then the streaming starts now.
+
     This is a bit tricky when only generating analog signals as they don't
     have any one-shot mode. Regardless if the analog signal generation was
     started with \a loop true or false, it will continue until \ref stop
@@ -210,6 +296,12 @@ void LabToolGeneratorDevice::handleConfigurationFailure(const char *msg)
 */
 void LabToolGeneratorDevice::handleRunning()
 {
+    if (mStreamed) {
+        // Deallocation: The device comm takes ownership of the stream
+        mDeviceComm->startGeneratorStream(createStream());
+        mStreamTimer.start();
+    }
+
     if (mLastUsedContinuousRun) {
         qDebug("Generator running...");
     } else {
@@ -224,9 +316,33 @@ void LabToolGeneratorDevice::handleRunning()
 */
 void LabToolGeneratorDevice::handleRunningFailure(const char *msg)
 {
+    mStreamTimer.stop();
     emit generateFinished(false, msg);
 }
 
+/*!
+    Periodically checks that the LabTool Hardware gets the streamed digital
+    signals in time. If it has run out of data then the generated signals
+    are incorrect, so the generation is stopped and a \ref generateFinished
+    signal is sent to report the failure.
+*/
+void LabToolGeneratorDevice::handleStreamTimer()
+{
+    quint32 blocks = 0;
+    quint32 underruns = 0;
+
+    if (mDeviceComm == NULL || mDeviceComm->generatorStreamStatus(&blocks, &underruns) != 0) {
+        return;
+    }
+
+    if (underruns > 0)
+    {
+        qDebug("Generator stream underrun after %u blocks (%u underruns)", blocks, underruns);
+        mStreamTimer.stop();
+        mDeviceComm->stopGenerator();
+        emit generateFinished(false, "The digital signals could not be streamed to the LabTool Hardware fast enough. Lower the rate or use fewer channels.");
+    }
+}
 
 /*!
     Number of bytes in the configuration data to send to the LabTool Hardware.
@@ -245,6 +361,9 @@ unsigned int LabToolGeneratorDevice::configSize()
     structure. The signal independant information is filled in here and then
     \ref updateDigitalConfigData and \ref updateAnalogConfigData are called
     to fill in the signal specific parts.
+
+    Returns NULL if the digital signals could not be encoded or the analog
+    lookup tables could not be created. The reason is in \a mConfigError.
 */
 quint8* LabToolGeneratorDevice::configData(int digitalRate)
 {
@@ -253,6 +372,10 @@ quint8* LabToolGeneratorDevice::configData(int digitalRate)
     }
 
     memset(mData, 0, sizeof(generator_cfg_t));
+    mPatternData.clear();
+    mDigitalBlocks.clear();
+    mAnalogLut.clear();
+    mStreamed = false;
 
     // Configure common parts
     generator_cfg_t* common_header = (generator_cfg_t*)mData;
@@ -263,12 +386,16 @@ quint8* LabToolGeneratorDevice::configData(int digitalRate)
     if (isDigitalGeneratorEnabled() && !digitalSignals().empty())
     {
         common_header->available |= (1<<0);
-        updateDigitalConfigData(digitalRate);
+        if (!updateDigitalConfigData(digitalRate)) {
+            return NULL;
+        }
     }
     if (isAnalogGeneratorEnabled() && !analogSignals().empty())
     {
         common_header->available |= (1<<1);
-        updateAnalogConfigData();
+        if (!updateAnalogConfigData()) {
+            return NULL;
+        }
     }
 
     return mData;
@@ -277,8 +404,15 @@ quint8* LabToolGeneratorDevice::configData(int digitalRate)
 /*!
     Fills in the configuration of the digital signals in the \a gen_sgpio_cfg_t
     part of the \a generator_cfg_t to send to the LabTool Hardware.
+
+    Signals with more than 256 states are encoded with \ref encodeDigitalPatterns
+    instead. If that fails for a continuous generation then the signals are
+    streamed during the generation, provided that the USB connection can keep
+    up with the \a digitalRate. Signals with an enabled UART stream (see
+    DigitalSignal::uartStream) are always streamed. Returns false (with the
+    reason in \a mConfigError) if the signals cannot be generated.
 */
-void LabToolGeneratorDevice::updateDigitalConfigData(int digitalRate)
+bool LabToolGeneratorDevice::updateDigitalConfigData(int digitalRate)
 {
     generator_cfg_t* common_header = (generator_cfg_t*)mData;
     gen_sgpio_cfg_t* digital_header = &common_header->sgpio;
@@ -286,52 +420,170 @@ void LabToolGeneratorDevice::updateDigitalConfigData(int digitalRate)
     digital_header->frequency = digitalRate;
 
     QList<DigitalSignal*> signalList = digitalSignals();
+    int numStates = 0;
+    bool uartStreams = false;
+    foreach(DigitalSignal* s, signalList)
+    {
+        digital_header->enabledChannels |= (1 << s->id());
+        numStates = s->numStates();
+        if (s->uartStream().isEnabled()) {
+            uartStreams = true;
+        }
+    }
+    digital_header->numStates = numStates;
+
+    if (numStates > MAX_RAW_STATES || uartStreams)
+    {
+        createDigitalBlocks(numStates);
+        if (!uartStreams && encodeDigitalPatterns()) {
+            digital_header->encodedSize = mPatternData.size()*sizeof(quint32);
+            return true;
+        }
+
+        if (!mContinuousRun) {
+            if (uartStreams) {
+                mConfigError = "UART streams can only be generated continuously.";
+            } else {
+                mConfigError = "The digital signals are too long or too irregular to fit in the LabTool Hardware's memory. Use continuous generation to stream them instead.";
+            }
+            return false;
+        }
+
+        qint64 bytesPerSecond = ((qint64)digitalRate * mDigitalBlockSize * sizeof(quint32)) / GEN_PATTERN_STATES_PER_BLOCK;
+        if (bytesPerSecond > MAX_STREAM_RATE) {
+            mConfigError = "The digital signals cannot be streamed to the LabTool Hardware at this rate. Lower the rate or use fewer channels.";
+            return false;
+        }
+
+        common_header->runCounter = 2;
+        mStreamed = true;
+        return true;
+    }
+
+    // the signal data is already packed in the same way as the
+    // LabTool Hardware wants it
     foreach(DigitalSignal* s, signalList)
     {
         int ch = s->id();
-        digital_header->enabledChannels |= (1 << ch);
-        QVector<bool> data = s->data();
-        int numStates = s->numStates();
-        quint32 tmp = 0;
-        int pos = 0;
-        int i;
-        for (i = 0; i < numStates; i++)
+        for (int pos = 0; pos*32 < numStates; pos++)
         {
-            tmp = (tmp >> 1);
-            if (data.at(i)) {
-                tmp |= 0x80000000;
-            }
-            if ((i % 32) == 31)
-            {
-                digital_header->patterns[pos][ch] = tmp;
-                pos++;
-                tmp = 0;
+            digital_header->patterns[pos][ch] = s->stateWord(pos*32);
+        }
+    }
+
+    return true;
+}
+
+/*!
+    Divides the digital signals with \a numStates states into \a mDigitalBlocks
+    of 32 states with one word for each enabled channel, in channel order.
+    For continuous generation the signals are repeated until they end on a
+    block boundary so that the blocks can be looped. For one shot generation
+    the last block is padded with zeros.
+*/
+void LabToolGeneratorDevice::createDigitalBlocks(int numStates)
+{
+    QList<DigitalSignal*> ordered;
+    for (int ch = 0; ch < maxNumDigitalSignals(); ch++) {
+        foreach(DigitalSignal* s, digitalSignals()) {
+            if (s->id() == ch) {
+                ordered.append(s);
             }
         }
-        if (tmp > 0)
-        {
-            // As data is added MSB first it has to be shifted down.
-            // This only happens when the number of states isn't a
-            // multiple of 32.
-            for (int k = (i % 32); k < 32; k++) {
-                tmp = (tmp >> 1);
+    }
+
+    int totalStates = numStates;
+    if (mContinuousRun) {
+        while ((totalStates % GEN_PATTERN_STATES_PER_BLOCK) != 0) {
+            totalStates += numStates;
+        }
+    }
+
+    int blockSize = ordered.size();
+    int numBlocks = (totalStates + GEN_PATTERN_STATES_PER_BLOCK - 1) / GEN_PATTERN_STATES_PER_BLOCK;
+    mDigitalBlocks.fill(0, numBlocks * blockSize);
+    mDigitalBlockSize = blockSize;
+
+    for (int c = 0; c < blockSize; c++) {
+        DigitalSignal s = *ordered.at(c);
+        if (totalStates != numStates) {
+            s.setNumStates(totalStates);
+            s.repeatStates(0, numStates, totalStates);
+        }
+
+        for (int b = 0; b < numBlocks; b++) {
+            mDigitalBlocks[b*blockSize + c] = s.stateWord(b*GEN_PATTERN_STATES_PER_BLOCK);
+        }
+    }
+}
+
+/*!
+    Creates the stream for the \a mDigitalBlocks. Channels with an enabled
+    UART stream get their output from it instead of from the blocks.
+*/
+LabToolGeneratorStream* LabToolGeneratorDevice::createStream()
+{
+    // Deallocation: Caller takes ownership of the stream
+    LabToolUartStream* stream = new LabToolUartStream(mDigitalBlocks, mDigitalBlockSize);
+
+    // the words in a block are in channel order, see createDigitalBlocks
+    int word = 0;
+    for (int ch = 0; ch < maxNumDigitalSignals(); ch++) {
+        foreach(DigitalSignal* s, digitalSignals()) {
+            if (s->id() == ch) {
+                if (s->uartStream().isEnabled()) {
+                    stream->addChannel(word, s->uartStream(), mDigitalRate);
+                }
+                word++;
             }
-            digital_header->patterns[pos][ch] = tmp;
         }
-        digital_header->numStates = numStates;
     }
+
+    return stream;
+}
+
+/*!
+    Encodes the \a mDigitalBlocks (see gen_pattern.h) into \a mPatternData
+    which is sent to the LabTool Hardware ahead of the configuration.
+
+    Returns false if the encoded pattern is too large.
+*/
+bool LabToolGeneratorDevice::encodeDigitalPatterns()
+{
+    int numBlocks = mDigitalBlocks.size() / mDigitalBlockSize;
+
+    mPatternData.resize(MAX_ENCODED_SIZE / sizeof(quint32));
+    quint32 used = gen_pattern_Encode(mDigitalBlocks.constData(), numBlocks, mDigitalBlockSize,
+                                      mPatternData.data(), mPatternData.size());
+    mPatternData.resize(used);
+
+    return (used > 0);
 }
 
 /*!
     Fills in the configuration of the analog signals in the \a gen_dac_cfg_t
     part of the \a generator_cfg_t to send to the LabTool Hardware.
+
+    Arbitrary waveforms get their lookup tables created in \a mAnalogLut
+    which is sent to the LabTool Hardware ahead of the configuration. The
+    size of each lookup table is as large as the DAC update rate allows for
+    the signal's frequency. Returns false (with the reason in \a mConfigError)
+    if the lookup tables could not be created.
 */
-void LabToolGeneratorDevice::updateAnalogConfigData()
+bool LabToolGeneratorDevice::updateAnalogConfigData()
 {
     generator_cfg_t* common_header = (generator_cfg_t*)mData;
     gen_dac_cfg_t* analog_header = &common_header->dac;
 
     QList<AnalogSignal*> signalList = analogSignals();
+    int numChannels = 0;
+    foreach(AnalogSignal* s, signalList)
+    {
+        if (s->id() < maxNumAnalogSignals()) {
+            numChannels++;
+        }
+    }
+
     foreach(AnalogSignal* s, signalList)
     {
         int id = s->id();
@@ -342,8 +594,81 @@ void LabToolGeneratorDevice::updateAnalogConfigData()
             analog_header->ch[id].frequency = s->frequency();
             analog_header->ch[id].waveform = s->waveform();
             analog_header->ch[id].dcOffset = 0; /*! \todo Add DC Offset to GUI */
+
+            if (s->waveform() == AnalogSignal::WaveformArbitrary)
+            {
+                QVector<double> data = s->arbitraryData();
+                if (data.isEmpty()) {
+                    mConfigError = QString("No waveform has been loaded for %1.").arg(s->name());
+                    return false;
+                }
+
+                LabToolCalibrationData* calib = mDeviceComm->storedCalibrationData();
+                if (calib == NULL) {
+                    mConfigError = "Failed to read the calibration data from the LabTool Hardware.";
+                    return false;
+                }
+
+                // keep a small margin as the LabTool Hardware can only
+                // approximate the DAC update rate
+                int lutSize = qMin(MAX_LUT_SIZE, (int)((MAX_DAC_FREQ * 0.99 / numChannels) / s->frequency()));
+                if (lutSize < 2) {
+                    mConfigError = QString("The frequency of %1 is too high for an arbitrary waveform.").arg(s->name());
+                    return false;
+                }
+
+                if (mAnalogLut.size() < (id + 1)*MAX_LUT_SIZE) {
+                    mAnalogLut.resize((id + 1)*MAX_LUT_SIZE);
+                }
+                createAnalogLut(id, data, s->amplitude(), lutSize, calib);
+
+                analog_header->ch[id].waveform = GEN_DAC_CFG_WAVE_ARBITRARY;
+                analog_header->ch[id].lutSize = lutSize;
+            }
         }
     }
+
+    return true;
+}
+
+/*!
+    Fills the part of \a mAnalogLut for analog output \a ch with \a lutSize
+    ready to use DAC values. One period of the waveform in \a data (values
+    -1..1) is resampled with linear interpolation, scaled with \a amplitude
+    and then converted into DAC values using the calibration data in \a calib.
+
+    The conversion is done in a separate pass without any dependencies between
+    the entries so that the compiler can vectorize it.
+*/
+void LabToolGeneratorDevice::createAnalogLut(int ch, const QVector<double> &data, double amplitude, int lutSize, LabToolCalibrationData* calib)
+{
+    const int n = data.size();
+    const double* src = data.constData();
+
+    // resample one period to the size of the lookup table
+    QVector<double> resampled(lutSize);
+    double* dst = resampled.data();
+    for (int i = 0; i < lutSize; i++) {
+        double pos = ((double)i * n) / lutSize;
+        int i0 = (int)pos;
+        int i1 = (i0 + 1) % n;
+        dst[i] = src[i0] + (src[i1] - src[i0]) * (pos - i0);
+    }
+
+    // Convert into DAC values in the same way as the LabTool Hardware:
+    //
+    //   val = (Vout - A)/B
+    //
+    // with the 10 value bits moved into the upper 10 bits of a 12-bit value
+    // and the control bits (see SPI_DAC_VALUE in spi_dac.h) added.
+    const double scale = amplitude / calib->analogOutFactorB(ch);
+    const double offset = -calib->analogOutFactorA(ch) / calib->analogOutFactorB(ch);
+    const quint16 ctrl = (quint16)((ch << 14) | (1 << 12));
+    quint16* lut = mAnalogLut.data() + ch*MAX_LUT_SIZE;
+    for (int i = 0; i < lutSize; i++) {
+        int val = ((int)(dst[i] * scale + offset)) << 2;
+        lut[i] = ctrl | (quint16)(qBound(0, val, 4095) & 0xffc);
+    }
 }
 
 /*!
@@ -17,6 +17,7 @@
 #define LABTOOLGENERATORDEVICE_H
 
 #include <QObject>
+#include <QTimer>
 #include "device/generatordevice.h"
 #include "labtooldevicecomm.h"
 
@@ -31,11 +32,15 @@ public:
     int maxNumAnalogSignals() const {return 2;}
 
     // maximum number of digital states per supported signal
-    int maxNumDigitalStates() const {return 256;}
+    int maxNumDigitalStates() const {return 262144;}
 
     int maxDigitalRate() const {return 100000000;} // limit to 100MHz for now
     int minDigitalRate() const {return 20;}
 
+    bool supportsUartStreams() const {return true;}
+
+    QList<AnalogSignal::AnalogWaveform> supportedAnalogWaveforms();
+
     void start(int digitalRate, bool loop);
     void stop();
 
@@ -51,14 +56,19 @@ private slots:
     void handleConfigurationFailure(const char *msg);
     void handleRunning();
     void handleRunningFailure(const char *msg);
+    void handleStreamTimer();
 
 private:
 
 
     unsigned int configSize();
     quint8* configData(int digitalRate);
-    void updateDigitalConfigData(int digitalRate);
-    void updateAnalogConfigData();
+    bool updateDigitalConfigData(int digitalRate);
+    void createDigitalBlocks(int numStates);
+    LabToolGeneratorStream* createStream();
+    bool encodeDigitalPatterns();
+    bool updateAnalogConfigData();
+    void createAnalogLut(int ch, const QVector<double> &data, double amplitude, int lutSize, LabToolCalibrationData* calib);
 
     bool hasConfigChanged();
     void saveConfig();
@@ -66,6 +76,13 @@ private:
 
     LabToolDeviceComm*  mDeviceComm;
     quint8* mData;
+    QVector<quint32> mPatternData;
+    QVector<quint16> mAnalogLut;
+    QString mConfigError;
+    QVector<quint32> mDigitalBlocks;
+    int mDigitalBlockSize;
+    bool mStreamed;
+    QTimer mStreamTimer;
     bool mContinuousRun;
     int mDigitalRate;
 
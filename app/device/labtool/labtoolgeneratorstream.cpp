@@ -0,0 +1,167 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtoolgeneratorstream.h"
+#include <string.h>
+
+/*!
+    \class LabToolGeneratorStream
+    \brief Produces the digital signal data streamed to the LabTool Hardware.
+
+    \ingroup Device
+
+    When the digital signals are too long to be stored in the LabTool
+    Hardware they are streamed from this application while being generated.
+    The data is a sequence of blocks with 32 states for each enabled channel,
+    one 32-bit word per channel in ascending channel order and with the
+    first state in the least significant bit.
+
+    Subclasses produce one block at a time in \ref nextBlock so that signals
+    can be created lazily (see LabToolUartStream) instead of being prepared
+    in full before the generation starts. The blocks are sliced
+    into USB transfers by \ref read which does not require a transfer to
+    end on a block boundary.
+
+    The \ref read function is called from the USB event thread so a subclass
+    must not access any state that the UI thread modifies.
+*/
+
+/*!
+    Constructs a stream with \a blockSize words (i.e. enabled channels) in
+    each block.
+*/
+LabToolGeneratorStream::LabToolGeneratorStream(int blockSize) :
+    mBlockSize(blockSize),
+    mBlock(blockSize, 0),
+    mBlockOffset(blockSize*sizeof(quint32))
+{
+}
+
+/*!
+    Frees up resources.
+*/
+LabToolGeneratorStream::~LabToolGeneratorStream()
+{
+}
+
+/*!
+    Fills \a buffer with the next \a size bytes of the stream.
+*/
+void LabToolGeneratorStream::read(quint8 *buffer, int size)
+{
+    const int bytes = blockBytes();
+    while (size > 0)
+    {
+        if (mBlockOffset == bytes)
+        {
+            nextBlock(mBlock.data());
+            mBlockOffset = 0;
+        }
+
+        int n = qMin(size, bytes - mBlockOffset);
+        memcpy(buffer, ((const quint8*)mBlock.constData()) + mBlockOffset, n);
+        mBlockOffset += n;
+        buffer += n;
+        size -= n;
+    }
+}
+
+/*!
+    \fn void LabToolGeneratorStream::nextBlock(quint32* block)
+
+    Implemented by subclasses to write the next block of states to \a block
+    which has room for \ref blockSize words.
+*/
+
+
+/*!
+    \class LabToolRepeatingStream
+    \brief A stream that repeats a fixed sequence of blocks forever.
+
+    \ingroup Device
+
+    Used for continuous generation of digital signals that cannot be
+    encoded to fit in the LabTool Hardware's memory.
+*/
+
+/*!
+    Constructs a stream that loops over the \a blocks, each with
+    \a blockSize words. The blocks are copied.
+*/
+LabToolRepeatingStream::LabToolRepeatingStream(const QVector<quint32> &blocks, int blockSize) :
+    LabToolGeneratorStream(blockSize),
+    mBlocks(blocks),
+    mNumBlocks(blocks.size() / blockSize),
+    mPos(0)
+{
+}
+
+/*!
+    Copies the next block to \a block, starting over when all
+    blocks have been used.
+*/
+void LabToolRepeatingStream::nextBlock(quint32 *block)
+{
+    memcpy(block, mBlocks.constData() + mPos*blockSize(), blockBytes());
+    mPos = (mPos + 1) % mNumBlocks;
+}
+
+
+/*!
+    \class LabToolUartStream
+    \brief A stream where some channels output UART data that is created
+    while streaming.
+
+    \ingroup Device
+
+    The channels without a UART stream repeat their states in the same way
+    as in LabToolRepeatingStream. For the channels added with
+    \ref addChannel the repeated words are replaced by the output of
+    their UartStream, which is created one block at a time and never ends.
+*/
+
+/*!
+    Constructs a stream that loops over the \a blocks, each with
+    \a blockSize words, for the channels that have no UART stream.
+*/
+LabToolUartStream::LabToolUartStream(const QVector<quint32> &blocks, int blockSize) :
+    LabToolRepeatingStream(blocks, blockSize)
+{
+}
+
+/*!
+    Replaces word \a word of each block with the output of \a stream when
+    generating \a stateRate states per second. The stream is copied and
+    started from the beginning.
+*/
+void LabToolUartStream::addChannel(int word, const UartStream &stream, int stateRate)
+{
+    UartStream s = stream;
+    s.start(stateRate);
+    mWords.append(word);
+    mStreams.append(s);
+}
+
+/*!
+    Copies the next block of the repeated channels to \a block and
+    fills in the next 32 states of each UART stream.
+*/
+void LabToolUartStream::nextBlock(quint32 *block)
+{
+    LabToolRepeatingStream::nextBlock(block);
+    for (int i = 0; i < mWords.size(); i++) {
+        block[mWords.at(i)] = mStreams[i].nextWord();
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLGENERATORSTREAM_H
+#define LABTOOLGENERATORSTREAM_H
+
+#include <qglobal.h>
+#include <QVector>
+
+#include "generator/uartstream.h"
+
+class LabToolGeneratorStream
+{
+public:
+    explicit LabToolGeneratorStream(int blockSize);
+    virtual ~LabToolGeneratorStream();
+
+    int blockSize() const {return mBlockSize;}
+    int blockBytes() const {return mBlockSize*sizeof(quint32);}
+
+    void read(quint8* buffer, int size);
+
+protected:
+    virtual void nextBlock(quint32* block) = 0;
+
+private:
+    int mBlockSize;
+    QVector<quint32> mBlock;
+    int mBlockOffset;
+};
+
+class LabToolRepeatingStream : public LabToolGeneratorStream
+{
+public:
+    LabToolRepeatingStream(const QVector<quint32> &blocks, int blockSize);
+
+protected:
+    void nextBlock(quint32* block);
+
+private:
+    QVector<quint32> mBlocks;
+    int mNumBlocks;
+    int mPos;
+};
+
+class LabToolUartStream : public LabToolRepeatingStream
+{
+public:
+    LabToolUartStream(const QVector<quint32> &blocks, int blockSize);
+
+    void addChannel(int word, const UartStream &stream, int stateRate);
+
+protected:
+    void nextBlock(quint32* block);
+
+private:
+    QVector<int> mWords;
+    QVector<UartStream> mStreams;
+};
+
+#endif // LABTOOLGENERATORSTREAM_H
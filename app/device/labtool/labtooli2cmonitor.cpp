@@ -0,0 +1,174 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtooli2cmonitor.h"
+
+
+/*!
+    \class LabToolI2CMonitor
+    \brief Converts the events from the LabTool Hardware's I2C monitor into I2C items.
+
+    \ingroup Device
+
+    The I2C monitor in the LabTool Hardware reports one event for each byte
+    on the bus and for each stop condition. An event has a timestamp in
+    micro seconds, the value of the I2C status register and the byte that
+    was on the bus. The events are converted into the same kind of items
+    as the ones that the UiI2CAnalyzer creates when decoding sampled SCL
+    and SDA signals so that they can be shown by the analyzer.
+
+    The 32-bit timestamps wrap after about 71 minutes and are extended to
+    64 bits, the same as the items' sample indices, so a monitoring session
+    can be shown in full however long it runs.
+
+    The LabTool Hardware timestamps an event when the acknowledge bit has
+    been clocked in, so the start of a byte is estimated using the clock
+    rate of the bus.
+*/
+
+/*!
+    Constructs an empty monitor session.
+*/
+LabToolI2CMonitor::LabToolI2CMonitor()
+{
+    reset(100000);
+}
+
+/*!
+    Removes all items and prepares for a new monitoring session of a bus
+    running at \a clockRate Hz.
+*/
+void LabToolI2CMonitor::reset(int clockRate)
+{
+    mItems.clear();
+    mBitTime = qMax(1, SampleRate / qMax(1, clockRate));
+    mLastTimestamp = 0;
+    mTimeOffset = 0;
+    mLastIdx = 0;
+    mLost = 0;
+}
+
+/*!
+    Adds the \a records (three words per event: timestamp, status and data)
+    received from the LabTool Hardware. The \a lost parameter is the total
+    number of events that the LabTool Hardware has dropped since the start.
+    An error item is inserted where events have been dropped.
+*/
+void LabToolI2CMonitor::addRecords(const QVector<quint32> &records, quint32 lost)
+{
+    if (lost != mLost) {
+        mItems.append(I2CItem(I2CItem::I2C_ERROR, -1, mLastIdx, -1));
+        mLost = lost;
+    }
+
+    for (int i = 0; i+2 < records.size(); i += 3) {
+        addRecord(records.at(i), records.at(i+1), records.at(i+2));
+    }
+}
+
+/*!
+    \fn QVector<I2CItem>* LabToolI2CMonitor::items()
+
+    Returns the items for all events received so far.
+*/
+
+/*!
+    \fn SampleIndex LabToolI2CMonitor::lastSampleIndex() const
+
+    Returns the sample index of the latest event.
+*/
+
+/*!
+    \fn quint32 LabToolI2CMonitor::lostEvents() const
+
+    Returns the number of events that the LabTool Hardware has dropped
+    because they were not read fast enough.
+*/
+
+/*!
+    Converts one event with the given \a timestamp, I2C \a status register
+    value and \a data byte into items.
+*/
+void LabToolI2CMonitor::addRecord(quint32 timestamp, quint32 status, quint32 data)
+{
+    if (timestamp < mLastTimestamp) {
+        // the 32-bit micro second timer has wrapped
+        mTimeOffset += Q_INT64_C(0x100000000);
+    }
+    mLastTimestamp = timestamp;
+
+    SampleIndex idx = mTimeOffset + timestamp;
+    mLastIdx = idx;
+
+    data &= 0xff;
+
+    switch (status & 0xf8) {
+
+    // own SLA+W received (always a match in monitor mode) or general call
+    case 0x60:
+    case 0x68:
+    case 0x70:
+    case 0x78:
+        addByte(I2CItem::I2C_7_ADDRESS_WRITE, (data >> 1), idx, true);
+        break;
+
+    // own SLA+R received
+    case 0xA8:
+    case 0xB0:
+        addByte(I2CItem::I2C_7_ADDRESS_READ, (data >> 1), idx, true);
+        break;
+
+    // data received (master writing) or transmitted (master reading)
+    case 0x80:
+    case 0x90:
+    case 0xB8:
+    case 0xC8:
+        addByte(I2CItem::I2C_DATA, data, idx, true);
+        break;
+
+    case 0x88:
+    case 0x98:
+    case 0xC0:
+        addByte(I2CItem::I2C_DATA, data, idx, false);
+        break;
+
+    // STOP or repeated START, a repeated START is followed by an address
+    case 0xA0:
+        mItems.append(I2CItem(I2CItem::I2C_STOP, -1, idx, -1));
+        break;
+
+    default:
+        mItems.append(I2CItem(I2CItem::I2C_ERROR, -1, idx, -1));
+        break;
+    }
+}
+
+/*!
+    Adds the items for one byte of \a type and \a value followed by an
+    acknowledge (\a ack true) or not acknowledge bit. The acknowledge bit
+    ends at \a endIdx. Addresses are preceded by a start condition.
+*/
+void LabToolI2CMonitor::addByte(I2CItem::I2CType type, int value, SampleIndex endIdx, bool ack)
+{
+    SampleIndex ackIdx = qMax(Q_INT64_C(0), endIdx - mBitTime);
+    SampleIndex startIdx = qMax(Q_INT64_C(0), ackIdx - 8*mBitTime);
+
+    if (type != I2CItem::I2C_DATA) {
+        mItems.append(I2CItem(I2CItem::I2C_START, -1, qMax(Q_INT64_C(0), startIdx - mBitTime/2), -1));
+    }
+
+    mItems.append(I2CItem(type, value, startIdx, ackIdx));
+    mItems.append(I2CItem(ack ? I2CItem::I2C_ACK : I2CItem::I2C_NACK, -1, ackIdx, -1));
+}
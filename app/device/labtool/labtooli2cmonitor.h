@@ -0,0 +1,56 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLI2CMONITOR_H
+#define LABTOOLI2CMONITOR_H
+
+#include <qglobal.h>
+#include <QVector>
+
+#include "analyzer/i2c/i2citem.h"
+
+class LabToolI2CMonitor
+{
+public:
+    explicit LabToolI2CMonitor();
+
+    void reset(int clockRate);
+    void addRecords(const QVector<quint32> &records, quint32 lost);
+
+    QVector<I2CItem>* items() {return &mItems;}
+    SampleIndex lastSampleIndex() const {return mLastIdx;}
+    quint32 lostEvents() const {return mLost;}
+
+    /*!
+        The timestamps in the events are in micro seconds so the
+        item indices are sample indices at 1MHz.
+    */
+    enum Constants {
+        SampleRate = 1000000
+    };
+
+private:
+    QVector<I2CItem> mItems;
+    int mBitTime;
+    quint32 mLastTimestamp;
+    qint64 mTimeOffset;
+    SampleIndex mLastIdx;
+    quint32 mLost;
+
+    void addRecord(quint32 timestamp, quint32 status, quint32 data);
+    void addByte(I2CItem::I2CType type, int value, SampleIndex endIdx, bool ack);
+};
+
+#endif // LABTOOLI2CMONITOR_H
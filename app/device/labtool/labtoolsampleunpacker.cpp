@@ -0,0 +1,266 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "labtoolsampleunpacker.h"
+
+#include <QDebug>
+
+#define A0_CH_ID  (0)  // Mapping of A0 to the VADC channel number in fw
+#define A1_CH_ID  (1)  // Mapping of A1 to the VADC channel number in fw
+
+/*!
+    \class LabToolSampleUnpacker
+    \brief Unpacks the samples from the LabTool Hardware while they are received.
+
+    \ingroup Device
+
+    The samples are received from the LabTool Hardware in chunks, see
+    \ref LabToolDeviceComm::captureReceivedChunk. The unpacker lives in its
+    own thread and unpacks each chunk as soon as it arrives so that the
+    unpacking is done while the rest of the samples are being received.
+    When the last chunk has been unpacked the result is sent with the
+    \ref samplesUnpacked signal.
+
+    The received data is the digital samples followed by the analog samples:
+
+    \dot
+     digraph structs {
+         node [shape=record];
+         start [label="DIO0 | DIO1 | ... | DIOn | DIO0 | ... | A0 | A1 | A0 | ..."];
+     }
+     \enddot
+
+    Each DIO box is a 32-bit value containing 32 digital samples for that
+    channel. The \a n value is the highest enabled channel number. If only
+    DIO4 is enabled then the positions for DIO0, DIO1, DIO2 and DIO3 will
+    still be present but with invalid data.
+
+    Each A box is a 16-bit value containing one analog sample. If only one
+    channel is enabled then only that channel's data will be present. Each
+    16-bit value is also marked with information about which channel the
+    data is for.
+
+    At high sample rates the analog signal data can get corrupted. This is only
+    visible in the data when both analog channels are enabled and it will look
+    like this:
+
+    \dot
+     digraph structs {
+         node [shape=record];
+         start [label="A0 | A1 | A0 | A0 | A1 | ..."];
+     }
+     \enddot
+
+    The double values are detected and a value for the missing channel is
+    inserted. In the example above channel A1 would get an extra value
+    inserted. The reason for inserting extra value(s) is to at least keep the
+    signals identical in length.
+
+    One problem is that the double A0 could hide either one missing A1 value
+    or one A1 and any number of A0+A1 samples. It is impossible to know.
+
+    The chunks are always a multiple of 4 bytes and the digital samples are
+    a whole number of 32-bit values so no sample is split between two chunks.
+*/
+
+/*!
+    Constructs a new unpacker with the given \a parent.
+*/
+LabToolSampleUnpacker::LabToolSampleUnpacker(QObject *parent) :
+    QObject(parent)
+{
+    mDigitalSize = 0;
+    mOffset = 0;
+    mActiveDigital = 0;
+    mSignalsInInput = 0;
+    mWordIndex = 0;
+    mNumAnalogChannels = 0;
+    mLastAnalogId = -1;
+}
+
+/*!
+    \fn void LabToolSampleUnpacker::samplesUnpacked(LabToolUnpackedSamples samples)
+
+    Sent when all chunks of a capture have been unpacked.
+*/
+
+/*!
+    A report that the LabTool Hardware has sent the header for a new capture
+    with \a digitalSize bytes of digital samples and \a analogSize bytes of
+    analog samples. The \a activeDigital and \a activeAnalog parameters
+    tell which channels the samples are for.
+
+    Anything left from a previous capture is discarded.
+*/
+void LabToolSampleUnpacker::handleHeader(unsigned int digitalSize, unsigned int analogSize, unsigned int activeDigital, unsigned int activeAnalog)
+{
+    mSamples = LabToolUnpackedSamples();
+    mDigitalSize = digitalSize;
+    mOffset = 0;
+    mActiveDigital = activeDigital;
+    mSignalsInInput = activeDigital >> 16;
+    mWordIndex = 0;
+    mLastAnalogId = -1;
+
+    mNumAnalogChannels = 0;
+    for (int i = 0; i < LabToolUnpackedSamples::MaxAnalogSignals; i++) {
+        if ((activeAnalog & (1<<i)) != 0) {
+            mNumAnalogChannels++;
+        }
+    }
+
+    if (mSignalsInInput > 0) {
+        int samplesPerSignal = (digitalSize / (mSignalsInInput*4)) * 32;
+        for (int i = 0; i < LabToolUnpackedSamples::MaxDigitalSignals; i++) {
+            if ((activeDigital & (1<<i)) != 0) {
+                mSamples.digital[i].reserve(samplesPerSignal);
+            }
+        }
+    }
+    for (int i = 0; i < LabToolUnpackedSamples::MaxAnalogSignals; i++) {
+        if ((activeAnalog & (1<<i)) != 0) {
+            mSamples.analog[i].reserve(analogSize / (2 * mNumAnalogChannels));
+        }
+    }
+}
+
+/*!
+    Unpacks the next \a chunk of samples.
+*/
+void LabToolSampleUnpacker::handleChunk(QVector<quint8> chunk)
+{
+    const quint8* pData = chunk.constData();
+    quint32 size = chunk.size();
+
+    if (mOffset < mDigitalSize) {
+        quint32 digitalBytes = qMin(size, mDigitalSize - mOffset);
+        unpackDigital(pData, digitalBytes);
+        pData += digitalBytes;
+        size -= digitalBytes;
+        mOffset += digitalBytes;
+    }
+
+    unpackAnalog(pData, size);
+    mOffset += size;
+}
+
+/*!
+    A report that the last chunk of samples has been received. The parameters
+    are the rest of the sample header, see \ref LabToolDeviceComm::captureReceivedSamples.
+    Sends the \ref samplesUnpacked signal.
+*/
+void LabToolSampleUnpacker::handleEnd(unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int activeDigital, unsigned int activeAnalog, int signalTrim, unsigned int trigSample)
+{
+    mSamples.size = size;
+    mSamples.trigger = trigger;
+    mSamples.digitalTrigSample = digitalTrigSample;
+    mSamples.analogTrigSample = analogTrigSample;
+    mSamples.activeDigital = activeDigital;
+    mSamples.activeAnalog = activeAnalog;
+    mSamples.signalTrim = signalTrim;
+    mSamples.trigSample = trigSample;
+
+    emit samplesUnpacked(mSamples);
+
+    // release the memory, the receiver has its own (shared) copy
+    mSamples = LabToolUnpackedSamples();
+}
+
+/*!
+    Unpacks \a size bytes of digital samples from \a pData into one list
+    of values per channel.
+*/
+void LabToolSampleUnpacker::unpackDigital(const quint8 *pData, quint32 size)
+{
+    const quint32* samples = (const quint32*)pData;
+    int numWords = size / 4;
+
+    if (mSignalsInInput == 0) {
+        return;
+    }
+
+    for (int j = 0; j < numWords; j++) {
+        int slice = mWordIndex % mSignalsInInput;
+        mWordIndex++;
+
+        if (slice >= LabToolUnpackedSamples::MaxDigitalSignals) continue;
+        if ((mActiveDigital & (1<<slice)) == 0) continue; // got no data for this channel from target
+
+        QVector<int> &s = mSamples.digital[slice];
+        quint32 val = samples[j];
+        for (int k = 0; k < 32; k++) {
+            s.append(val & 1);
+            val = val >> 1;
+        }
+    }
+}
+
+/*!
+    Unpacks \a size bytes of analog samples from \a pData into one list of
+    values per channel.
+
+    If an EMPTY marker is found, it is not treated as data and is instead
+    discarded. If two channels are sampled and two consecutive samples for
+    the same channel is found then an additional sample is inserted in the
+    other channel to make up for the missing one. The id bits of each sample
+    is also read to make sure that the samples end up on the correct signal's
+    list (prevents signal swapping).
+*/
+void LabToolSampleUnpacker::unpackAnalog(const quint8 *pData, quint32 size)
+{
+    const quint16* samples = (const quint16*)pData;//PACKED
+    QVector<quint16> &s0 = mSamples.analog[0];
+    QVector<quint16> &s1 = mSamples.analog[1];
+    int numSamples = size/2;
+
+    for (int i = 0; i < numSamples; i++)
+    {
+        int id = (*samples & 0x7000)>>12;
+        int empty = (*samples & 0x8000)>>15;
+        if (empty)
+        {
+            qDebug("Empty marker for i=%d", i);
+        }
+        else
+        {
+            if (id == mLastAnalogId && mNumAnalogChannels>1)
+            {
+                // found a skip i.e. two consecutive samples for the same channel, add an extra sample for the other channel
+                if (id == A1_CH_ID)
+                {
+                    s0.append(s0.isEmpty() ? 0 : s0.last());
+                }
+                else
+                {
+                    s1.append(s1.isEmpty() ? 0 : s1.last());
+                }
+                qDebug("Skip at i=%d", i);
+            }
+
+            quint16 val = *samples;//PACKED
+            val = val & 0xfff;
+            if (id == A1_CH_ID)
+            {
+                s1.append(val);
+            }
+            else
+            {
+                s0.append(val);
+            }
+            mLastAnalogId = id;
+        }
+        samples++;
+    }
+}
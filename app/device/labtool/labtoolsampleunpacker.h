@@ -0,0 +1,110 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef LABTOOLSAMPLEUNPACKER_H
+#define LABTOOLSAMPLEUNPACKER_H
+
+#include <QObject>
+#include <QVector>
+#include <QMetaType>
+
+/*!
+    \class LabToolUnpackedSamples
+    \brief Container class for the samples of one capture after unpacking.
+
+    \ingroup Device
+
+    \internal
+
+*/
+class LabToolUnpackedSamples {
+public:
+
+    enum Constants {
+        MaxDigitalSignals = 11,
+        MaxAnalogSignals = 2
+    };
+
+    /*!
+        Default constructor
+    */
+    LabToolUnpackedSamples() {
+        digital.resize(MaxDigitalSignals);
+        analog.resize(MaxAnalogSignals);
+        size = 0;
+        trigger = 0;
+        digitalTrigSample = 0;
+        analogTrigSample = 0;
+        activeDigital = 0;
+        activeAnalog = 0;
+        signalTrim = 0;
+        trigSample = 0;
+    }
+
+    /*! One value (0 or 1) per sample for each digital channel, empty if the channel has no data */
+    QVector<QVector<int> > digital;
+    /*! The 12-bit values for each analog channel, empty if the channel has no data */
+    QVector<QVector<quint16> > analog;
+
+    /*! Number of bytes of samples received */
+    unsigned int size;
+    /*! The id of the channel that caused the trigger */
+    unsigned int trigger;
+    /*! Approximate trigger sample in the digital data */
+    unsigned int digitalTrigSample;
+    /*! Approximate trigger sample in the analog data */
+    unsigned int analogTrigSample;
+    /*! Number of digital channels in the data (16 MSB) and the channels with data (16 LSB) */
+    unsigned int activeDigital;
+    /*! The analog channels with data */
+    unsigned int activeAnalog;
+    /*! Samples to remove from start (<0) or end (>0) of the data */
+    int signalTrim;
+    /*! Exact trigger sample after trimming or 0xffffffff if not found */
+    unsigned int trigSample;
+};
+
+Q_DECLARE_METATYPE(LabToolUnpackedSamples)
+
+class LabToolSampleUnpacker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LabToolSampleUnpacker(QObject *parent = 0);
+
+signals:
+    void samplesUnpacked(LabToolUnpackedSamples samples);
+
+public slots:
+    void handleHeader(unsigned int digitalSize, unsigned int analogSize, unsigned int activeDigital, unsigned int activeAnalog);
+    void handleChunk(QVector<quint8> chunk);
+    void handleEnd(unsigned int size, unsigned int trigger, unsigned int digitalTrigSample, unsigned int analogTrigSample, unsigned int activeDigital, unsigned int activeAnalog, int signalTrim, unsigned int trigSample);
+
+private:
+    LabToolUnpackedSamples mSamples;
+
+    quint32 mDigitalSize;
+    quint32 mOffset;
+    quint32 mActiveDigital;
+    int mSignalsInInput;
+    int mWordIndex;
+    int mNumAnalogChannels;
+    int mLastAnalogId;
+
+    void unpackDigital(const quint8* pData, quint32 size);
+    void unpackAnalog(const quint8* pData, quint32 size);
+};
+
+#endif // LABTOOLSAMPLEUNPACKER_H
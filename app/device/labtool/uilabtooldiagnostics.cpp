@@ -0,0 +1,222 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uilabtooldiagnostics.h"
+
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QFont>
+
+/*!
+    \class UiLabToolDiagnostics
+    \brief A dialog with information about the latest capture made by the LabTool Hardware.
+
+    \ingroup Device
+
+    The LabTool Hardware collects telemetry for each capture and sends it
+    together with the samples, see \ref capture_telemetry_t. The dialog
+    shows:
+
+    - Skipped Samples
+
+        When both analog channels are sampled the samples alternate between
+        the channels. Two samples in a row from the same channel means that
+        samples were lost.
+    - Empty Samples
+
+        Analog samples that were never filled in by the VADC.
+    - Trigger Latency
+
+        How many samples from the sample reported by the trigger interrupt
+        that the triggering edge was found.
+    - Readout Time
+
+        The time it took to send the previous capture to the PC.
+    - Transfer Rate
+
+        How fast the samples of the latest capture were received, as
+        measured by this application.
+    - Analog Statistics
+
+        Min/max/average of the raw 12-bit values and a coarse histogram for
+        each analog channel.
+
+    The dialog is not modal so it can be left open while capturing.
+*/
+
+/*!
+    Constructs a new diagnostics dialog with the given \a parent.
+*/
+UiLabToolDiagnostics::UiLabToolDiagnostics(QWidget *parent) :
+    QDialog(parent)
+{
+    setWindowTitle(tr("Diagnostics"));
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    mNumCaptures = 0;
+    mTotalSkipped = 0;
+
+    QFormLayout* formLayout = new QFormLayout;
+
+    mCaptures = new QLabel("0", this);
+    formLayout->addRow(tr("Captures: "), mCaptures);
+
+    mSkipped = new QLabel("-", this);
+    mSkipped->setToolTip(tr("Lost analog samples in the latest capture (and in total)"));
+    formLayout->addRow(tr("Skipped samples: "), mSkipped);
+
+    mEmpty = new QLabel("-", this);
+    mEmpty->setToolTip(tr("Analog samples without a value in the latest capture"));
+    formLayout->addRow(tr("Empty samples: "), mEmpty);
+
+    mDigitalLatency = new QLabel("-", this);
+    mDigitalLatency->setToolTip(tr("Samples between the reported and the exact digital trigger"));
+    formLayout->addRow(tr("Digital trigger latency: "), mDigitalLatency);
+
+    mAnalogLatency = new QLabel("-", this);
+    mAnalogLatency->setToolTip(tr("Samples between the reported and the exact analog trigger"));
+    formLayout->addRow(tr("Analog trigger latency: "), mAnalogLatency);
+
+    mReadoutTime = new QLabel("-", this);
+    mReadoutTime->setToolTip(tr("Time it took to send the previous capture to the PC"));
+    formLayout->addRow(tr("Readout time: "), mReadoutTime);
+
+    mTransferRate = new QLabel("-", this);
+    mTransferRate->setToolTip(tr("Throughput of the USB connection when receiving the latest capture"));
+    formLayout->addRow(tr("Transfer rate: "), mTransferRate);
+
+    QFont histFont("Courier");
+    histFont.setStyleHint(QFont::TypeWriter);
+
+    for (int i = 0; i < CAPTURE_TELEMETRY_CHANNELS; i++) {
+        mChannelStats[i] = new QLabel("-", this);
+        formLayout->addRow(tr("A%1: ").arg(i), mChannelStats[i]);
+
+        mChannelHistogram[i] = new QLabel("-", this);
+        mChannelHistogram[i]->setFont(histFont);
+        mChannelHistogram[i]->setToolTip(tr("Distribution of the 12-bit values, lowest to the left"));
+        formLayout->addRow(tr("A%1 histogram: ").arg(i), mChannelHistogram[i]);
+    }
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(
+                QDialogButtonBox::Close,
+                Qt::Horizontal,
+                this);
+    connect(buttonBox, SIGNAL(rejected()), this, SLOT(reject()));
+
+    QVBoxLayout* verticalLayout = new QVBoxLayout();
+    verticalLayout->addLayout(formLayout);
+    verticalLayout->addWidget(buttonBox);
+
+    setLayout(verticalLayout);
+}
+
+/*!
+    Updates the dialog with the \a telemetry from the latest capture.
+*/
+void UiLabToolDiagnostics::setTelemetry(const capture_telemetry_t &telemetry)
+{
+    mNumCaptures++;
+    mTotalSkipped += telemetry.skippedSamples;
+
+    mCaptures->setText(QString::number(mNumCaptures));
+    mSkipped->setText(QString("%1 (%2)").arg(telemetry.skippedSamples).arg(mTotalSkipped));
+    mEmpty->setText(QString::number(telemetry.emptySamples));
+    mDigitalLatency->setText(latencyText(telemetry.digitalTrigLatency));
+    mAnalogLatency->setText(latencyText(telemetry.analogTrigLatency));
+
+    if (telemetry.readoutTime == 0) {
+        mReadoutTime->setText("-");
+    }
+    else {
+        mReadoutTime->setText(QString("%1 ms").arg(telemetry.readoutTime / 1000.0, 0, 'f', 2));
+    }
+
+    for (int i = 0; i < CAPTURE_TELEMETRY_CHANNELS; i++) {
+        const capture_telemetry_channel_t &ch = telemetry.ch[i];
+
+        if (ch.numSamples == 0) {
+            mChannelStats[i]->setText("-");
+            mChannelHistogram[i]->setText("-");
+            continue;
+        }
+
+        mChannelStats[i]->setText(QString("%1 samples, min %2, max %3, avg %4")
+                                  .arg(ch.numSamples)
+                                  .arg(ch.min)
+                                  .arg(ch.max)
+                                  .arg((double)ch.sum / ch.numSamples, 0, 'f', 1));
+        mChannelHistogram[i]->setText(histogramText(ch));
+    }
+}
+
+/*!
+    Updates the dialog with the time in \a msecs it took to receive the
+    \a size bytes of the latest capture. A time of 0 means that it was
+    not measured.
+*/
+void UiLabToolDiagnostics::setTransferTime(unsigned int size, double msecs)
+{
+    if (msecs <= 0) {
+        mTransferRate->setText("-");
+    }
+    else {
+        mTransferRate->setText(QString("%1 MB/s (%2 bytes in %3 ms)")
+                               .arg(size / (msecs * 1000.0), 0, 'f', 2)
+                               .arg(size)
+                               .arg(msecs, 0, 'f', 2));
+    }
+}
+
+/*!
+    Returns the \a latency as text.
+*/
+QString UiLabToolDiagnostics::latencyText(qint32 latency)
+{
+    if (latency == CAPTURE_TELEMETRY_NO_LATENCY) {
+        return "-";
+    }
+    return tr("%1 samples").arg(latency);
+}
+
+/*!
+    Returns the histogram for \a ch as one bar character per bin with the
+    height of the bar relative to the largest bin.
+*/
+QString UiLabToolDiagnostics::histogramText(const capture_telemetry_channel_t &ch)
+{
+    // U+2581 .. U+2588 are bars of increasing height
+    const ushort firstBar = 0x2581;
+    const int numBars = 8;
+
+    quint32 largest = 0;
+    for (int i = 0; i < CAPTURE_TELEMETRY_HIST_BINS; i++) {
+        largest = qMax(largest, ch.hist[i]);
+    }
+
+    QString text;
+    for (int i = 0; i < CAPTURE_TELEMETRY_HIST_BINS; i++) {
+        if (ch.hist[i] == 0) {
+            text.append(' ');
+        }
+        else {
+            int height = (int)(((quint64)ch.hist[i] * (numBars - 1)) / largest);
+            text.append(QChar(firstBar + height));
+        }
+    }
+
+    return text;
+}
@@ -0,0 +1,57 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UILABTOOLDIAGNOSTICS_H
+#define UILABTOOLDIAGNOSTICS_H
+
+#include <QWidget>
+#include <QDialog>
+#include <QLabel>
+
+#include "capture_telemetry.h"
+
+class UiLabToolDiagnostics : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit UiLabToolDiagnostics(QWidget *parent = 0);
+
+    void setTelemetry(const capture_telemetry_t &telemetry);
+    void setTransferTime(unsigned int size, double msecs);
+
+signals:
+
+public slots:
+
+private:
+    int mNumCaptures;
+    quint64 mTotalSkipped;
+
+    QLabel* mCaptures;
+    QLabel* mSkipped;
+    QLabel* mEmpty;
+    QLabel* mDigitalLatency;
+    QLabel* mAnalogLatency;
+    QLabel* mReadoutTime;
+    QLabel* mTransferRate;
+    QLabel* mChannelStats[CAPTURE_TELEMETRY_CHANNELS];
+    QLabel* mChannelHistogram[CAPTURE_TELEMETRY_CHANNELS];
+
+    QString latencyText(qint32 latency);
+    QString histogramText(const capture_telemetry_channel_t &ch);
+
+};
+
+#endif // UILABTOOLDIAGNOSTICS_H
@@ -20,6 +20,7 @@
 #include <QDialogButtonBox>
 #include <QHBoxLayout>
 #include <QIntValidator>
+#include <QRegExpValidator>
 #include <QLabel>
 
 // Noise reduction is disabled for now as it causes problems and is only
@@ -54,6 +55,16 @@
         Enable the noise reduction filter to reduce the risk of finding incorrect trigger points.
         The filter level will dictate how much is filtered out. Setting the level too high or too low can result in
         missed trigger points.
+    - Pattern Trigger
+
+        Instead of an edge on one signal the trigger is when the digital signals get a
+        wanted combination of levels. Each signal (D0 first) is 0, 1 or X (don't care).
+        A sequence trigger has two patterns where the second one must come after the first one.
+    - I2C Monitor
+
+        Instead of sampling signals the I2C bus on the I2C connector is monitored by the LabTool Hardware
+        and each byte is timestamped. The monitoring continues until it is stopped and the communication
+        is shown by the I2C analyzers.
 */
 
 /*!
@@ -142,6 +153,54 @@ UiLabToolTriggerConfig::UiLabToolTriggerConfig(QWidget *parent) :
     formLayout->addRow(tr("Noise Filter: "), pfhLayout2);
 #endif
 
+    QLabel* infoLbl5 = new QLabel(tr("Instead of an edge on one signal the trigger can be when the digital signals "
+                                  "get a wanted combination of levels. Enter 0, 1 or X (don't care) for each signal, "
+                                  "starting with D0. A sequence trigger waits for the first pattern and then for the second one. "
+                                  "Edge triggers on the signals are ignored when a pattern is used."), this);
+    infoLbl5->setWordWrap(true);
+    formLayout->addRow(infoLbl5);
+
+    // pattern and sequence trigger
+    mPatternMode = new QComboBox(this);
+    mPatternMode->addItem(tr("Off"), 0);
+    mPatternMode->addItem(tr("Pattern"), 1);
+    mPatternMode->addItem(tr("Sequence"), 2);
+    connect(mPatternMode, SIGNAL(currentIndexChanged(int)), this, SLOT(patternModeChanged(int)));
+    formLayout->addRow(tr("Pattern Trigger: "), mPatternMode);
+
+    for (int i = 0; i < 2; i++) {
+        mPatternStage[i] = new QLineEdit(this);
+        mPatternStage[i]->setToolTip(tr("Level of D0, D1, ... (0, 1 or X)"));
+        mPatternStage[i]->setValidator(new QRegExpValidator(QRegExp("[01xX]{0,11}"), this));
+        mPatternStage[i]->setText("XXXXXXXXXXX");
+        mPatternStage[i]->setEnabled(false);
+    }
+    formLayout->addRow(tr("First pattern: "), mPatternStage[0]);
+    formLayout->addRow(tr("Second pattern: "), mPatternStage[1]);
+
+    QLabel* infoLbl4 = new QLabel(tr("Instead of sampling signals the I2C bus on the I2C connector can be monitored. "
+                                  "Each byte is timestamped by the hardware and the monitoring continues until it is stopped. "
+                                  "The communication is shown by the I2C analyzers."), this);
+    infoLbl4->setWordWrap(true);
+    formLayout->addRow(infoLbl4);
+
+    // I2C monitor
+    mI2CMonitorEnabled = new QCheckBox(this);
+    mI2CMonitorEnabled->setTristate(false);
+    mI2CMonitorEnabled->setCheckState(Qt::Unchecked);
+    mI2CMonitorRate = new QComboBox(this);
+    mI2CMonitorRate->setToolTip(tr("Clock rate of the monitored I2C bus"));
+    mI2CMonitorRate->addItem(tr("100 kHz"), 100000);
+    mI2CMonitorRate->addItem(tr("400 kHz"), 400000);
+    mI2CMonitorRate->setEnabled(false);
+    QHBoxLayout* monLayout = new QHBoxLayout();
+    monLayout->addWidget(mI2CMonitorEnabled);
+    monLayout->addWidget(mI2CMonitorRate);
+
+    connect(mI2CMonitorEnabled, SIGNAL(stateChanged(int)), this, SLOT(i2cMonitorStateChanged(int)));
+
+    formLayout->addRow(tr("I2C Monitor: "), monLayout);
+
 
 
 
@@ -267,3 +326,85 @@ void UiLabToolTriggerConfig::noiseFilterStateChanged(int state)
     (void)state;
 #endif
 }
+
+/*!
+    Sets up the I2C monitor. The \a clockRate parameter is in Hz.
+*/
+void UiLabToolTriggerConfig::setI2CMonitor(bool enabled, int clockRate)
+{
+    mI2CMonitorEnabled->setCheckState(enabled ? Qt::Checked : Qt::Unchecked);
+    int idx = mI2CMonitorRate->findData(clockRate);
+    if (idx != -1) {
+        mI2CMonitorRate->setCurrentIndex(idx);
+    }
+}
+
+/*!
+    Returns true if the I2C bus should be monitored instead of sampling signals.
+*/
+bool UiLabToolTriggerConfig::isI2CMonitorEnabled()
+{
+    return (mI2CMonitorEnabled->checkState() == Qt::Checked);
+}
+
+/*!
+    Returns the clock rate (in Hz) of the monitored I2C bus.
+*/
+int UiLabToolTriggerConfig::i2cMonitorClockRate()
+{
+    return mI2CMonitorRate->itemData(mI2CMonitorRate->currentIndex()).toInt();
+}
+
+/*!
+    Acts on the enabling/disabling of the I2C monitor and
+    enables/disables the clock rate selection accordingly.
+*/
+void UiLabToolTriggerConfig::i2cMonitorStateChanged(int state)
+{
+    mI2CMonitorRate->setEnabled(state == Qt::Checked);
+}
+
+/*!
+    Returns the number of patterns in the pattern trigger, 1 for a pattern
+    trigger, 2 for a sequence trigger or 0 if it is not used.
+*/
+int UiLabToolTriggerConfig::patternTriggerStages()
+{
+    return mPatternMode->itemData(mPatternMode->currentIndex()).toInt();
+}
+
+/*!
+    Gets the signals that must match (\a care) and their levels (\a value)
+    in pattern \a stage of the pattern trigger. Bit 0 is for D0.
+    Returns false if the stage is not used.
+*/
+bool UiLabToolTriggerConfig::patternTriggerStage(int stage, quint32 *care, quint32 *value)
+{
+    *care = 0;
+    *value = 0;
+    if (stage < 0 || stage >= patternTriggerStages()) {
+        return false;
+    }
+
+    QString pattern = mPatternStage[stage]->text();
+    for (int i = 0; i < pattern.size(); i++) {
+        if (pattern.at(i) == '0') {
+            *care |= (1<<i);
+        } else if (pattern.at(i) == '1') {
+            *care |= (1<<i);
+            *value |= (1<<i);
+        }
+    }
+    return true;
+}
+
+/*!
+    Acts on a change of the pattern trigger mode and enables/disables
+    the patterns accordingly.
+*/
+void UiLabToolTriggerConfig::patternModeChanged(int index)
+{
+    int stages = mPatternMode->itemData(index).toInt();
+    mPatternStage[0]->setEnabled(stages >= 1);
+    mPatternStage[1]->setEnabled(stages >= 2);
+}
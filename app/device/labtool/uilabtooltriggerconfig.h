@@ -21,6 +21,7 @@
 #include <QSlider>
 #include <QLineEdit>
 #include <QCheckBox>
+#include <QComboBox>
 
 class UiLabToolTriggerConfig : public QDialog
 {
@@ -38,6 +39,13 @@ public:
 
     qint16 noiseFilter12BitLevel() { return (1<<noiseFilterLevel()); }
 
+    void setI2CMonitor(bool enabled, int clockRate);
+    bool isI2CMonitorEnabled();
+    int i2cMonitorClockRate();
+
+    int patternTriggerStages();
+    bool patternTriggerStage(int stage, quint32* care, quint32* value);
+
 signals:
 
 public slots:
@@ -45,12 +53,18 @@ public slots:
 private slots:
 
     void noiseFilterStateChanged(int state);
+    void i2cMonitorStateChanged(int state);
+    void patternModeChanged(int index);
 
 private:
     QSlider* mPostFillPercent;
     QLineEdit * mPostFillTimeLimit;
     QSlider* mNoiseLevel;
     QCheckBox* mNoiseFilterEnabled;
+    QCheckBox* mI2CMonitorEnabled;
+    QComboBox* mI2CMonitorRate;
+    QComboBox* mPatternMode;
+    QLineEdit* mPatternStage[2];
 
 };
 
@@ -179,7 +179,7 @@ void SimulatorCaptureDevice::stop()
     emit captureFinished(true, "");
 }
 
-int SimulatorCaptureDevice::lastSampleIndex()
+SampleIndex SimulatorCaptureDevice::lastSampleIndex()
 {
     return mEndSampleIdx;
 }
@@ -203,6 +203,11 @@ void SimulatorCaptureDevice::setDigitalData(int signalId, QVector<int> data)
             delete mDigitalSignals[signalId];
             mDigitalSignals[signalId] = NULL;
         }
+        if (mDigitalSignalTransitions[signalId] != NULL) {
+            delete mDigitalSignalTransitions[signalId];
+            mDigitalSignalTransitions[signalId] = NULL;
+        }
+        invalidateDigitalEdgeIndex();
 
         if (data.size() > 0) {
             mEndSampleIdx = data.size();
@@ -253,21 +258,21 @@ void SimulatorCaptureDevice::clearSignalData()
     deleteSignalData();
 }
 
-int SimulatorCaptureDevice::digitalTriggerIndex()
+SampleIndex SimulatorCaptureDevice::digitalTriggerIndex()
 {
     return mTriggerIdx;
 }
 
-void SimulatorCaptureDevice::setDigitalTriggerIndex(int idx)
+void SimulatorCaptureDevice::setDigitalTriggerIndex(SampleIndex idx)
 {
     mTriggerIdx = idx;
 }
 
-void SimulatorCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
+const DigitalTransitions* SimulatorCaptureDevice::digitalTransitions(int signalId)
 {
 
-    if (signalId >= MaxDigitalSignals) return;
-    if (mDigitalSignals[signalId] == NULL) return;
+    if (signalId >= MaxDigitalSignals) return NULL;
+    if (mDigitalSignals[signalId] == NULL) return NULL;
 
     // Not in cache. Create the list
     if (mDigitalSignalTransitions[signalId] == NULL) {
@@ -275,13 +280,10 @@ void SimulatorCaptureDevice::digitalTransitions(int signalId, QList<int> &list)
         // Deallocation:
         //    Deleted by deleteSignalData() which is called by destructor
         //    or clearSignalData()
-        QList<int>* l = new QList<int>();
-
-        CaptureDevice::digitalTransitions(signalId, *l);
-        mDigitalSignalTransitions[signalId] = l;
+        mDigitalSignalTransitions[signalId] = new DigitalTransitions(*mDigitalSignals[signalId]);
     }
 
-    list = *mDigitalSignalTransitions[signalId];
+    return mDigitalSignalTransitions[signalId];
 }
 
 void SimulatorCaptureDevice::reconfigure(int sampleRate)
@@ -359,6 +361,7 @@ void SimulatorCaptureDevice::generateRandomDigitalSignals()
             delete mDigitalSignalTransitions[id];
             mDigitalSignalTransitions[id] = NULL;
         }
+        invalidateDigitalEdgeIndex();
 
         mDigitalSignals[id] = s;
 
@@ -637,6 +640,7 @@ void SimulatorCaptureDevice::deleteSignalData()
             mDigitalSignalTransitions[i] = NULL;
         }
     }
+    invalidateDigitalEdgeIndex();
 
     for (int i = 0; i < MaxAnalogSignals; i++) {
         if (mAnalogSignals[i] != NULL) {
@@ -658,5 +662,6 @@ void SimulatorCaptureDevice::setDigitalSignalData(int id, QVector<int>* data)
         delete mDigitalSignalTransitions[id];
         mDigitalSignalTransitions[id] = NULL;
     }
+    invalidateDigitalEdgeIndex();
     mDigitalSignals[id] = data;
 }
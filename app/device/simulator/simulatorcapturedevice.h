@@ -37,7 +37,7 @@ public:
     void start(int sampleRate);
     void stop();
 
-    int lastSampleIndex();
+    SampleIndex lastSampleIndex();
     QVector<int>* digitalData(int signalId);
     void setDigitalData(int signalId, QVector<int> data);
 
@@ -46,9 +46,9 @@ public:
 
     void clearSignalData();
 
-    int digitalTriggerIndex();
-    void setDigitalTriggerIndex(int idx);
-    void digitalTransitions(int signalId, QList<int> &list);
+    SampleIndex digitalTriggerIndex();
+    void setDigitalTriggerIndex(SampleIndex idx);
+    const DigitalTransitions* digitalTransitions(int signalId);
 
     void reconfigure(int sampleRate = -1);
 
@@ -66,14 +66,14 @@ private:
 
     UiSimulatorConfigDialog* mConfigDialog;
 
-    int mEndSampleIdx;
+    SampleIndex mEndSampleIdx;
     QVector<int>* mDigitalSignals[MaxDigitalSignals];
     QVector<double>* mAnalogSignals[MaxAnalogSignals];
-    QList<int>* mDigitalSignalTransitions[MaxDigitalSignals];
+    DigitalTransitions* mDigitalSignalTransitions[MaxDigitalSignals];
 
     QList<double> mSupportedVPerDiv;
 
-    int mTriggerIdx;
+    SampleIndex mTriggerIdx;
 
 
     int numberOfSamples();
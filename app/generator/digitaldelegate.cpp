@@ -22,8 +22,10 @@
 
 #include <QMessageBox>
 #include <QSpinBox>
+#include <QAbstractItemView>
 
 #include "uieditdigital.h"
+#include "digitalsignals.h"
 
 #include "common/configuration.h"
 #include "device/digitalsignal.h"
@@ -39,8 +41,18 @@
     Digital signals are visualized in a table as rows and columns. This
     delegate is responsible for displaying the signal data and making
     it possible to modify signal states.
+
+    Each state is drawn as a part of a continuous waveform. The level is
+    only written out at the start of a run of equal states (and then every
+    \a LABEL_INTERVAL states) which keeps long patterns readable and cheap
+    to paint.
 */
 
+/*!
+    Interval, in states, between level labels within a run of equal states.
+*/
+#define LABEL_INTERVAL (16)
+
 /*!
     Constructs an DigitalDelegate with the given \a parent.
 */
@@ -97,11 +109,9 @@ void DigitalDelegate::paint(QPainter *painter,
         }
 
         else {
-            bool high = signal->data().at(index.column()-1);
-            str = "1";
-            if (!high) {
-                str = "0";
-            }
+            int state = index.data(DigitalSignals::StateRole).toInt();
+            bool high = signal->state(state);
+            bool runStart = (state == 0 || signal->state(state-1) != high);
 
             QRect txtRect = option.rect;
 
@@ -122,10 +132,22 @@ void DigitalDelegate::paint(QPainter *painter,
                 txtRect.adjust(0, 0, 0, -2);
             }
 
+            // transition from the previous state
+            if (runStart && state > 0) {
+                painter->drawLine(option.rect.left(), option.rect.top()+2,
+                                  option.rect.left(), option.rect.bottom()-2);
+            }
 
-            pen.setColor(Qt::gray);
-            painter->setPen(pen);
-            painter->drawText(txtRect, Qt::AlignCenter, str);
+            if (runStart || (state % LABEL_INTERVAL) == 0) {
+                str = "1";
+                if (!high) {
+                    str = "0";
+                }
+
+                pen.setColor(Qt::gray);
+                painter->setPen(pen);
+                painter->drawText(txtRect, Qt::AlignCenter, str);
+            }
         }
 
         painter->restore();
@@ -205,7 +227,16 @@ bool DigitalDelegate::editorEvent(QEvent *event,
         if (index.column() > 0) {
 
             if (event->type() == QEvent::MouseButtonRelease) {
-                signal->toogleState(index.column()-1);
+                signal->toogleState(
+                            index.data(DigitalSignals::StateRole).toInt());
+
+                // the neighbouring states are painted differently when
+                // a run starts or ends
+                const QAbstractItemView* view =
+                        qobject_cast<const QAbstractItemView*>(option.widget);
+                if (view != NULL) {
+                    view->viewport()->update();
+                }
             }
 
             return true;
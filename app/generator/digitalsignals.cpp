@@ -30,6 +30,10 @@
     Digital signals are typically visualized in a table as rows and columns.
     This class provides the table model which the table view is using to get
     access to the digital signal data.
+
+    Only a window of the states is visible in the view at the same time
+    (see setFirstState()) so that long patterns don't result in a view with
+    an unmanageable number of columns.
 */
 
 /*!
@@ -39,6 +43,7 @@ DigitalSignals::DigitalSignals(QObject *parent) :
     QAbstractTableModel(parent)
 {
     mNumStates = 32;
+    mFirstState = 0;
 }
 
 /*!
@@ -47,6 +52,24 @@ DigitalSignals::DigitalSignals(QObject *parent) :
     Returns the number of states set for digital signals.
 */
 
+/*!
+    \enum DigitalSignals::Constants
+
+    This enum defines constants associated with DigitalSignals
+
+    \var DigitalSignals::Constants DigitalSignals::MaxVisibleStates
+    Maximum number of states (columns) given to the view at the same time
+*/
+
+/*!
+    \enum DigitalSignals::Roles
+
+    This enum defines the custom item data roles
+
+    \var DigitalSignals::Roles DigitalSignals::StateRole
+    The index of the state shown in a column
+*/
+
 
 /*!
     Sets the number of valid states for all signals to \a numStates.
@@ -57,35 +80,85 @@ void DigitalSignals::setNumStates(int numStates)
             ->generatorDevice();
 
     if (numStates > 0 && numStates != mNumStates && device != NULL) {
-        bool add = true;
-        if (numStates < mNumStates) {
-            add = false;
-        }
-
-        // the first column contains the signal name which means that number of
-        // columns are number of states + 1
 
-        if (add) {
-            beginInsertColumns(QModelIndex(), mNumStates+1, numStates);
+        foreach(DigitalSignal* s, device->digitalSignals()) {
+            s->setNumStates(numStates);
         }
-        else {
-            beginRemoveColumns(QModelIndex(), numStates+1, mNumStates);
+
+        int first = mFirstState;
+        if (first + MaxVisibleStates > numStates) {
+            first = qMax(0, numStates - MaxVisibleStates);
         }
 
+        updateVisibleStates(numStates, first);
+    }
+}
 
-        mNumStates = numStates;
+/*!
+    \fn int DigitalSignals::firstState() const
 
-        foreach(DigitalSignal* s, device->digitalSignals()) {
-            s->setNumStates(numStates);
-        }
+    Returns the first state that is visible in the view.
+*/
 
+/*!
+    Makes \a first the first state visible in the view. At most
+    \a MaxVisibleStates states are visible at the same time.
+*/
+void DigitalSignals::setFirstState(int first)
+{
+    first = qBound(0, first, qMax(0, mNumStates - MaxVisibleStates));
+    if (first == mFirstState) return;
 
-        if (add) {
-            endInsertColumns();
-        }
-        else {
-            endRemoveColumns();
-        }
+    updateVisibleStates(mNumStates, first);
+}
+
+/*!
+    Returns the number of states that are visible in the view.
+*/
+int DigitalSignals::numVisibleStates() const
+{
+    return qMin((int)MaxVisibleStates, mNumStates - mFirstState);
+}
+
+/*!
+    Changes the number of states to \a numStates and the first visible state
+    to \a firstState and notifies the view about the columns that have been
+    added, removed or changed.
+
+    The view is only given a window of the states (see \a MaxVisibleStates)
+    which means that the size of the view doesn't depend on the total number
+    of states.
+*/
+void DigitalSignals::updateVisibleStates(int numStates, int firstState)
+{
+    int oldVisible = numVisibleStates();
+    int newVisible = qMin((int)MaxVisibleStates, numStates - firstState);
+
+    // the first column contains the signal name which means that number of
+    // columns are number of visible states + 1
+
+    if (newVisible > oldVisible) {
+        beginInsertColumns(QModelIndex(), oldVisible+1, newVisible);
+    }
+    else if (newVisible < oldVisible) {
+        beginRemoveColumns(QModelIndex(), newVisible+1, oldVisible);
+    }
+
+    mNumStates = numStates;
+    mFirstState = firstState;
+
+    if (newVisible > oldVisible) {
+        endInsertColumns();
+    }
+    else if (newVisible < oldVisible) {
+        endRemoveColumns();
+    }
+
+    // the states in the columns that were already visible may have changed
+    int changed = qMin(oldVisible, newVisible);
+    if (changed > 0) {
+        emit headerDataChanged(Qt::Horizontal, 1, changed);
+        emit dataChanged(index(0, 1), index(rowCount(QModelIndex())-1, changed));
     }
 }
 
@@ -202,17 +275,25 @@ QVariant DigitalSignals::data(const QModelIndex &index, int role) const
 
     QList<DigitalSignal*> list = device->digitalSignals();
 
-    if (index.row() >= list.size() || index.column() >= (mNumStates+1)) {
+    if (index.row() >= list.size() || index.column() > numVisibleStates()) {
         return QVariant();
     }
 
-    if (role == Qt::DisplayRole) {
+    if (role == StateRole && index.column() > 0) {
+        return mFirstState + index.column() - 1;
+    }
+    else if (role == Qt::DisplayRole) {
         DigitalSignal* s = list.at(index.row());
 
 
         return qVariantFromValue<DigitalSignal*>(s);
     }
     else if (role == Qt::ToolTipRole && index.column() == 0) {
+        const UartStream &stream = list.at(index.row())->uartStream();
+        if (stream.isEnabled()) {
+            return tr("Outputs a UART stream at %1 baud instead of the states. "
+                      "Double-click to configure").arg(stream.baudRate());
+        }
         return tr("Double-click to configure");
     }
 
@@ -236,9 +317,9 @@ QVariant DigitalSignals::headerData(int section, Qt::Orientation orientation,
                 // The spaces below are needed to get an initial column width
                 return tr("Signal              ");
             }
-            else if (section <= mNumStates) {
+            else if (section <= numVisibleStates()) {
                 // return state number
-                return QString("%1").arg(section-1);
+                return QString("%1").arg(mFirstState+section-1);
             }
             break;
         case Qt::Vertical:
@@ -282,7 +363,7 @@ int DigitalSignals::columnCount(const QModelIndex &parent) const
 {
     (void)parent;
 
-    // the first column contains the signal name, the rest are the signal
-    // states
-    return numStates() + 1;
+    // the first column contains the signal name, the rest are the visible
+    // signal states
+    return numVisibleStates() + 1;
 }
@@ -28,9 +28,21 @@ class DigitalSignals : public QAbstractTableModel
 public:
     explicit DigitalSignals(QObject *parent = 0);
 
+    enum Constants {
+        MaxVisibleStates = 1024
+    };
+
+    enum Roles {
+        StateRole = Qt::UserRole
+    };
+
     int numStates() const {return mNumStates;}
     void setNumStates(int numStates);
 
+    int firstState() const {return mFirstState;}
+    void setFirstState(int first);
+    int numVisibleStates() const;
+
     DigitalSignal* addSignal(int id);
     void syncSignalsWithDevice();
     void removeSignal(DigitalSignal *s);
@@ -56,6 +68,9 @@ public slots:
 
 private:
     int mNumStates;
+    int mFirstState;
+
+    void updateVisibleStates(int numStates, int firstState);
 
 };
 
@@ -25,13 +25,16 @@
 
     \ingroup Generator
 
+    The states are written directly to a PackedPattern (see \ref pattern)
+    with SCL as channel 0 and SDA as channel 1.
 */
 
 /*!
     Constructs the I2CGenerator with the given \a parent.
 */
 I2CGenerator::I2CGenerator(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    mPattern(2)
 {
     mAddressType = Types::I2CAddress_7bit;
     mI2CRate = 100000; // 100 KHz
@@ -88,8 +91,7 @@ bool I2CGenerator::generateFromString(QString s)
     bool success = true;
 
     // reset data
-    mSclData.clear();
-    mSdaData.clear();
+    mPattern.clear();
 
     mTransfer = false;
 
@@ -137,7 +139,7 @@ bool I2CGenerator::generateFromString(QString s)
 */
 QVector<int> I2CGenerator::sclData()
 {
-    return mSclData;
+    return mPattern.states(SclChannel);
 }
 
 /*!
@@ -145,9 +147,30 @@ QVector<int> I2CGenerator::sclData()
 */
 QVector<int> I2CGenerator::sdaData()
 {
-    return mSdaData;
+    return mPattern.states(SdaChannel);
 }
 
+/*!
+    \fn const PackedPattern &I2CGenerator::pattern() const
+
+    Returns the generated SCL and SDA states packed into 32-bit words.
+*/
+
+/*!
+    \enum I2CGenerator::PatternChannel
+
+    The channels in \ref pattern.
+
+    \var I2CGenerator::PatternChannel I2CGenerator::SclChannel
+    The SCL (clock) signal
+
+    \var I2CGenerator::PatternChannel I2CGenerator::SdaChannel
+    The SDA (data) signal
+*/
+
+#define SCL  (1 << I2CGenerator::SclChannel)
+#define SDA  (1 << I2CGenerator::SdaChannel)
+
 /*!
     Add a start condition
 */
@@ -156,25 +179,18 @@ bool I2CGenerator::addStart()
     // start condition: SDA high-low transition while SCL is high
 
     // SDA is low, must set it to high so a transition can take place
-    if (mSdaData.size() > 1 && mSdaData.at(mSdaData.size()-1) == 0) {
-
-
-        if (mSclData.at(mSclData.size()-1) == 1) {
-            mSclData.append(0);
-            mSdaData.append(1);
+    if (mPattern.numStates() > 1 && (mPattern.lastLevels() & SDA) == 0) {
 
-            mSclData.append(1);
-            mSdaData.append(1);
+        if ((mPattern.lastLevels() & SCL) != 0) {
+            mPattern.append(SDA);
+            mPattern.append(SCL | SDA);
         }
         else {
-            mSclData.append(1);
-            mSdaData.append(1);
+            mPattern.append(SCL | SDA);
         }
     }
 
-
-    mSdaData.append(0);
-    mSclData.append(1);
+    mPattern.append(SCL);
 
     return true;
 }
@@ -187,30 +203,23 @@ bool I2CGenerator::addStop()
     // stop condition: an SDA low-high transition while SCL is high
 
     // SDA is high, must set it low so a transition can take place
-    if (mSdaData.size() > 1 && mSdaData.at(mSdaData.size()-1) == 1) {
+    if (mPattern.numStates() > 1 && (mPattern.lastLevels() & SDA) != 0) {
 
         // the transition must take place when SCL is high (not during SCL
         // transition)
 
-
-        if (mSclData.at(mSclData.size()-1) == 1) {
+        if ((mPattern.lastLevels() & SCL) != 0) {
 
             // add one clock cycle where SDA is LOW
-
-            mSclData.append(0);
-            mSdaData.append(0);
-
-            mSclData.append(1);
-            mSdaData.append(0);
+            mPattern.append(0);
+            mPattern.append(SCL);
         }
         else {
-            mSclData.append(1);
-            mSdaData.append(0);
+            mPattern.append(SCL);
         }
     }
 
-    mSdaData.append(1);
-    mSclData.append(1);
+    mPattern.append(SCL | SDA);
 
     return true;
 }
@@ -221,11 +230,8 @@ bool I2CGenerator::addStop()
 bool I2CGenerator::addAck()
 {
     // ACK: keep SDA low during a clock cycle
-    mSclData.append(0);
-    mSclData.append(1);
-
-    mSdaData.append(0);
-    mSdaData.append(0);
+    mPattern.append(0);
+    mPattern.append(SCL);
 
     return true;
 }
@@ -235,13 +241,9 @@ bool I2CGenerator::addAck()
 */
 bool I2CGenerator::addNack()
 {
-
-    // ACK: keep SDA high during a clock cycle
-    mSclData.append(0);
-    mSclData.append(1);
-
-    mSdaData.append(1);
-    mSdaData.append(1);
+    // NACK: keep SDA high during a clock cycle
+    mPattern.append(SDA);
+    mPattern.append(SCL | SDA);
 
     return true;
 }
@@ -360,17 +362,12 @@ bool I2CGenerator::addDelay(QString value)
 
         if (!success) break;
 
-        for (int i = 0; i < samples; i++) {
-
-            // SCL is high when there isn't any active transfer; otherwise 0
-            if (mTransfer) {
-                mSclData.append(0);
-            } else {
-                mSclData.append(1);
-            }
-
-            // always keep SDA high
-            mSdaData.append(1);
+        // SCL is high when there isn't any active transfer; otherwise 0.
+        // SDA is always kept high.
+        if (mTransfer) {
+            mPattern.append(SDA, samples);
+        } else {
+            mPattern.append(SCL | SDA, samples);
         }
     } while(0);
 
@@ -382,23 +379,12 @@ bool I2CGenerator::addDelay(QString value)
 */
 bool I2CGenerator::add8Bits(int value)
 {
-    int level;
-    int mask = 0x80;
-    for (int i = 0; i < 8; i++) {
-
-        level = 0;
-        if ((value & mask) != 0) {
-            level = 1;
-        }
+    for (int i = 7; i >= 0; i--) {
+        quint32 level = ((value >> i) & 1) ? SDA : 0;
 
         // clock cycle
-        mSclData.append(0);
-        mSclData.append(1);
-
-        mSdaData.append(level);
-        mSdaData.append(level);
-
-        mask >>= 1;
+        mPattern.append(level);
+        mPattern.append(SCL | level);
     }
 
     return true;
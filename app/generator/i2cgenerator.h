@@ -20,6 +20,7 @@
 #include <QVector>
 
 #include "common/types.h"
+#include "packedpattern.h"
 
 class I2CGenerator : public QObject
 {
@@ -34,6 +35,12 @@ public:
     bool generateFromString(QString s);
     QVector<int> sclData();
     QVector<int> sdaData();
+    const PackedPattern &pattern() const {return mPattern;}
+
+    enum PatternChannel {
+        SclChannel = 0,
+        SdaChannel = 1
+    };
 
     
 signals:
@@ -43,8 +50,7 @@ public slots:
 private:
     Types::I2CAddress mAddressType;
     int mI2CRate;
-    QVector<int> mSclData;
-    QVector<int> mSdaData;
+    PackedPattern mPattern;
     bool mTransfer;
 
     bool addStart();
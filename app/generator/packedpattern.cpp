@@ -0,0 +1,198 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "packedpattern.h"
+
+#include "gen_pattern.h"
+
+/*!
+    \class PackedPattern
+    \brief Holds the states of a number of digital channels packed into
+    32-bit words.
+
+    \ingroup Generator
+
+    The protocol generators (I2CGenerator, SpiGenerator and UartGenerator)
+    append their states directly into a PackedPattern instead of building
+    one integer per state and channel. Each state is given as a bit mask
+    where bit \e n is the level of channel \e n.
+
+    Each channel is stored as words of 32 states with the first state in the
+    least significant bit, which is the same format as the LabTool Hardware
+    uses. The pattern can therefore be handed over as blocks (see
+    \ref blocks) or in the compressed format of gen_pattern.h (see
+    \ref encode) without any further conversion.
+*/
+
+/*!
+    Constructs an empty pattern with \a numChannels channels. At most
+    32 channels are supported.
+*/
+PackedPattern::PackedPattern(int numChannels)
+{
+    mNumChannels = qBound(1, numChannels, 32);
+    mWords.resize(mNumChannels);
+    mNumStates = 0;
+    mLastLevels = 0;
+}
+
+/*!
+    Removes all states.
+*/
+void PackedPattern::clear()
+{
+    for (int ch = 0; ch < mNumChannels; ch++) {
+        mWords[ch].clear();
+    }
+    mNumStates = 0;
+    mLastLevels = 0;
+}
+
+/*!
+    \fn int PackedPattern::numChannels() const
+
+    Returns the number of channels in the pattern.
+*/
+
+/*!
+    \fn int PackedPattern::numStates() const
+
+    Returns the number of states in the pattern.
+*/
+
+/*!
+    \fn quint32 PackedPattern::lastLevels() const
+
+    Returns the levels of the last state in the pattern (bit \e n for
+    channel \e n) or 0 if the pattern is empty.
+*/
+
+/*!
+    \fn const QVector<quint32> &PackedPattern::words(int channel) const
+
+    Returns the packed states of \a channel, 32 states per word with the
+    first state in the least significant bit. Unused bits in the last word
+    are 0.
+*/
+
+/*!
+    Appends one state with the channel levels in \a levels.
+*/
+void PackedPattern::append(quint32 levels)
+{
+    int bit = mNumStates % 32;
+    if (bit == 0) {
+        for (int ch = 0; ch < mNumChannels; ch++) {
+            mWords[ch].append(0);
+        }
+    }
+
+    int idx = mNumStates / 32;
+    for (int ch = 0; ch < mNumChannels; ch++) {
+        mWords[ch].data()[idx] |= ((levels >> ch) & 1) << bit;
+    }
+
+    mNumStates++;
+    mLastLevels = levels;
+}
+
+/*!
+    Appends \a count states which all have the channel levels in \a levels.
+    Whole words are filled at once which makes long delays and idle periods
+    cheap.
+*/
+void PackedPattern::append(quint32 levels, int count)
+{
+    // fill up the current word
+    while (count > 0 && (mNumStates % 32) != 0) {
+        append(levels);
+        count--;
+    }
+
+    int numWords = count / 32;
+    if (numWords > 0) {
+        for (int ch = 0; ch < mNumChannels; ch++) {
+            quint32 fill = ((levels >> ch) & 1) ? 0xffffffff : 0;
+            mWords[ch].insert(mWords[ch].size(), numWords, fill);
+        }
+        mNumStates += numWords * 32;
+        mLastLevels = levels;
+        count -= numWords * 32;
+    }
+
+    while (count > 0) {
+        append(levels);
+        count--;
+    }
+}
+
+/*!
+    Returns the level (0 or 1) of \a channel in \a state.
+*/
+int PackedPattern::level(int channel, int state) const
+{
+    return (mWords.at(channel).at(state / 32) >> (state % 32)) & 1;
+}
+
+/*!
+    Returns the states of \a channel with one integer (0 or 1) per state.
+    This is only meant for code that has to work on one state at a time,
+    like the simulator.
+*/
+QVector<int> PackedPattern::states(int channel) const
+{
+    QVector<int> result(mNumStates);
+    const QVector<quint32> &w = mWords.at(channel);
+    for (int i = 0; i < mNumStates; i++) {
+        result[i] = (w.at(i / 32) >> (i % 32)) & 1;
+    }
+    return result;
+}
+
+/*!
+    Returns the pattern as blocks of 32 states with one word per channel,
+    i.e. the block format of gen_pattern.h where the channels are numbered
+    in the same order as in this pattern. The last block is padded with 0.
+*/
+QVector<quint32> PackedPattern::blocks() const
+{
+    int numBlocks = (mNumStates + 31) / 32;
+    QVector<quint32> result(numBlocks * mNumChannels);
+
+    quint32* p = result.data();
+    for (int b = 0; b < numBlocks; b++) {
+        for (int ch = 0; ch < mNumChannels; ch++) {
+            *p++ = mWords.at(ch).at(b);
+        }
+    }
+
+    return result;
+}
+
+/*!
+    Encodes the pattern into the compressed format of gen_pattern.h.
+    The encoded pattern is written to \a data which has room for \a maxWords
+    words.
+
+    Returns the number of used words or 0 if the encoded pattern does not fit.
+*/
+quint32 PackedPattern::encode(quint32* data, quint32 maxWords) const
+{
+    if (mNumStates == 0) return 0;
+
+    QVector<quint32> b = blocks();
+    return gen_pattern_Encode(b.constData(), b.size() / mNumChannels,
+                              mNumChannels, data, maxWords);
+}
@@ -0,0 +1,48 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef PACKEDPATTERN_H
+#define PACKEDPATTERN_H
+
+#include <QVector>
+
+class PackedPattern
+{
+public:
+    explicit PackedPattern(int numChannels = 1);
+
+    void clear();
+    int numChannels() const {return mNumChannels;}
+    int numStates() const {return mNumStates;}
+    quint32 lastLevels() const {return mLastLevels;}
+
+    void append(quint32 levels);
+    void append(quint32 levels, int count);
+
+    int level(int channel, int state) const;
+    const QVector<quint32> &words(int channel) const {return mWords.at(channel);}
+    QVector<int> states(int channel) const;
+
+    QVector<quint32> blocks() const;
+    quint32 encode(quint32* data, quint32 maxWords) const;
+
+private:
+    int mNumChannels;
+    int mNumStates;
+    quint32 mLastLevels;
+    QVector< QVector<quint32> > mWords;
+};
+
+#endif // PACKEDPATTERN_H
@@ -24,13 +24,16 @@
 
     \ingroup Generator
 
+    The states are written directly to a PackedPattern (see \ref pattern)
+    with SCK, MOSI, MISO and the enable signal as channels 0 to 3.
 */
 
 /*!
     Constructs the SpiGenerator with the given \a parent.
 */
 SpiGenerator::SpiGenerator(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    mPattern(4)
 {
     mRate = 1000000;
     mDataBits = 8;
@@ -90,10 +93,7 @@ bool SpiGenerator::generateFromString(QString s)
     bool success = true;
 
     // reset data
-    mSckData.clear();
-    mMosiData.clear();
-    mMisoData.clear();
-    mCsData.clear();
+    mPattern.clear();
     mEnableOn = false;
 
 
@@ -149,12 +149,63 @@ bool SpiGenerator::generateFromString(QString s)
     Returns the SPI signal data.
 */
 
+/*!
+    \fn const PackedPattern &SpiGenerator::pattern() const
+
+    Returns the generated SPI signals packed into 32-bit words.
+*/
 
 /*!
-    Add enable state with \a value. The parameter \a onlyEnable is
-    set to true of only the enable signal should be affected.
+    \enum SpiGenerator::PatternChannel
+
+    The channels in \ref pattern.
+
+    \var SpiGenerator::PatternChannel SpiGenerator::SckChannel
+    The SCK (clock) signal
+
+    \var SpiGenerator::PatternChannel SpiGenerator::MosiChannel
+    The MOSI signal
+
+    \var SpiGenerator::PatternChannel SpiGenerator::MisoChannel
+    The MISO signal
+
+    \var SpiGenerator::PatternChannel SpiGenerator::CsChannel
+    The enable (chip select) signal
 */
-bool SpiGenerator::addEnable(QString value, bool onlyEnable)
+
+
+#define SCK   (1 << SpiGenerator::SckChannel)
+#define MOSI  (1 << SpiGenerator::MosiChannel)
+#define MISO  (1 << SpiGenerator::MisoChannel)
+#define CS    (1 << SpiGenerator::CsChannel)
+
+/*!
+    Returns the levels when no data is transferred, i.e. SCK at its idle
+    level (CPOL), MOSI and MISO low and the enable signal according to the
+    current enable state.
+*/
+quint32 SpiGenerator::idleLevels()
+{
+    quint32 levels = 0;
+
+    // CPOL == 1
+    if (mMode == Types::SpiMode_2 || mMode == Types::SpiMode_3) {
+        levels |= SCK;
+    }
+
+    // the enable signal is high when it is on and active high or
+    // when it is off and active low
+    if (mEnableOn == (mEnable == Types::SpiEnableHigh)) {
+        levels |= CS;
+    }
+
+    return levels;
+}
+
+/*!
+    Add enable state with \a value.
+*/
+bool SpiGenerator::addEnable(QString value)
 {
     bool success = true;
 
@@ -169,32 +220,7 @@ bool SpiGenerator::addEnable(QString value, bool onlyEnable)
 
         mEnableOn = (e == 1);
 
-        // active low
-        if ((mEnableOn && mEnable == Types::SpiEnableLow)
-                || (!mEnableOn && mEnable == Types::SpiEnableHigh)) {
-            mCsData.append(0);
-        }
-
-        // active high
-        else {
-            mCsData.append(1);
-        }
-
-        if (!onlyEnable) {
-            mMosiData.append(0);
-            mMisoData.append(0);
-
-            if (mMode == Types::SpiMode_0 || mMode == Types::SpiMode_1) {
-                // CPOL == 0
-                mSckData.append(0);
-            }
-            else {
-                // CPOL == 1
-                mSckData.append(1);
-            }
-
-        }
-
+        mPattern.append(idleLevels());
 
     } while(0);
 
@@ -248,28 +274,8 @@ bool SpiGenerator::addDelay(QString value)
 
         if (!success) break;
 
-        for (int i = 0; i < samples; i++) {
-
-
-            if (mMode == Types::SpiMode_0 || mMode == Types::SpiMode_1) {
-                mSckData.append(0);
-            }
-            else {
-                mSckData.append(1);
-            }
-
-
-            mMosiData.append(0);
-            mMisoData.append(0);
-
-            if (mEnableOn) {
-                addEnable("1", true);
-            }
-            else {
-                addEnable("0", true);
-            }
+        mPattern.append(idleLevels(), samples);
 
-        }
     } while(0);
 
     return success;
@@ -280,73 +286,40 @@ bool SpiGenerator::addDelay(QString value)
 */
 void SpiGenerator::addBits(int mosi, int miso)
 {
+    // the enable signal is on while data is transferred
+    mEnableOn = true;
+    quint32 cs = idleLevels() & CS;
+
+    // SCK levels for the two halves of each clock cycle
+    quint32 first = 0;
+    quint32 second = 0;
+    switch(mMode) {
+    case Types::SpiMode_0: // CPOL=0, CPHA=0
+        second = SCK;
+        break;
+    case Types::SpiMode_1: // CPOL=0, CPHA=1
+        first = SCK;
+        break;
+    case Types::SpiMode_2: // CPOL=1, CPHA=0
+        first = SCK;
+        break;
+    case Types::SpiMode_3: // CPOL=1, CPHA=1
+        second = SCK;
+        break;
+    default:
+        break;
+    }
 
-    int mosiLevel;
-    int misoLevel;
-    int mask = (1<<(mDataBits-1));
-
-    for (int i = 0; i < mDataBits; i++) {
-
-        mosiLevel = 0;
-        if ((mosi & mask) != 0) {
-            mosiLevel = 1;
-        }
-        misoLevel = 0;
-        if ((miso & mask) != 0) {
-            misoLevel = 1;
-        }
-#if 0
-        // clock cycle
-        if (mMode == Types::SpiMode_0 || mMode == Types::SpiMode_1) {
-            mSckData.append(1);
-            mSckData.append(0);
-        }
-        else {
-            mSckData.append(0);
-            mSckData.append(1);
+    for (int i = mDataBits-1; i >= 0; i--) {
+        quint32 levels = cs;
+        if (((mosi >> i) & 1) != 0) {
+            levels |= MOSI;
         }
-
-        mMosiData.append(mosiLevel);
-        mMosiData.append(mosiLevel);
-
-        mMisoData.append(misoLevel);
-        mMisoData.append(misoLevel);
-#endif
-
-        switch(mMode) {
-        case Types::SpiMode_0: // CPOL=0, CPHA=0
-            mSckData.append(0);
-            mSckData.append(1);
-            break;
-        case Types::SpiMode_1: // CPOL=0, CPHA=1
-            mSckData.append(1);
-            mSckData.append(0);
-            break;
-        case Types::SpiMode_2: // CPOL=1, CPHA=0
-            mSckData.append(1);
-            mSckData.append(0);
-            break;
-        case Types::SpiMode_3: // CPOL=1, CPHA=1
-            mSckData.append(0);
-            mSckData.append(1);
-            break;
-        default:
-            break;
+        if (((miso >> i) & 1) != 0) {
+            levels |= MISO;
         }
 
-
-        mMosiData.append(mosiLevel);
-        mMosiData.append(mosiLevel);
-
-        mMisoData.append(misoLevel);
-        mMisoData.append(misoLevel);
-
-        // CS enable
-        addEnable("1", true);
-        addEnable("1", true);
-
-        mask >>= 1;
-
-
+        mPattern.append(first | levels);
+        mPattern.append(second | levels);
     }
 }
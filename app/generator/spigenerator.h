@@ -20,6 +20,7 @@
 #include <QVector>
 
 #include "common/types.h"
+#include "packedpattern.h"
 
 class SpiGenerator : public QObject
 {
@@ -35,10 +36,18 @@ public:
     bool generateFromString(QString s);
 
     int sampleRate() {return mRate*2;}
-    QVector<int> sckData() {return mSckData;}
-    QVector<int> mosiData() {return mMosiData;}
-    QVector<int> misoData() {return mMisoData;}
-    QVector<int> enableData() {return mCsData;}
+    QVector<int> sckData() {return mPattern.states(SckChannel);}
+    QVector<int> mosiData() {return mPattern.states(MosiChannel);}
+    QVector<int> misoData() {return mPattern.states(MisoChannel);}
+    QVector<int> enableData() {return mPattern.states(CsChannel);}
+    const PackedPattern &pattern() const {return mPattern;}
+
+    enum PatternChannel {
+        SckChannel = 0,
+        MosiChannel = 1,
+        MisoChannel = 2,
+        CsChannel = 3
+    };
     
 signals:
     
@@ -50,17 +59,15 @@ private:
     Types::SpiMode mMode;
     Types::SpiEnable mEnable;
 
-    QVector<int> mSckData;
-    QVector<int> mMosiData;
-    QVector<int> mMisoData;
-    QVector<int> mCsData;
+    PackedPattern mPattern;
 
     bool mEnableOn;
 
-    bool addEnable(QString value, bool onlyEnable=false);
+    bool addEnable(QString value);
     bool addData(QString value);
     bool addDelay(QString value);
     void addBits(int mosi, int miso);
+    quint32 idleLevels();
     
 };
 
@@ -22,13 +22,16 @@
 
     \ingroup Generator
 
+    The states are written directly to a single channel PackedPattern
+    (see \ref pattern), one complete frame at a time.
 */
 
 /*!
     Constructs the UartGenerator with the given \a parent.
 */
 UartGenerator::UartGenerator(QObject *parent) :
-    QObject(parent)
+    QObject(parent),
+    mPattern(1)
 {
     mBaudRate = 115200;
     mNumDataBits = 8;
@@ -73,33 +76,22 @@ void UartGenerator::setParity(Types::UartParity parity)
 */
 bool UartGenerator::generate(QByteArray &data)
 {
-    int numOnes = 0;
-
-    mUartData.clear();
+    mPattern.clear();
 
     // idle line -> high
-    mUartData.append(1);
+    mPattern.append(1);
 
     for (int i = 0; i < data.size(); i++) {
+        int numBits = 0;
+        quint32 frame = frameBits(data.at(i), &numBits);
 
-        // start bit
-        mUartData.append(0);
-
-        // data
-        numOnes = addData(data.at(i));
-
-        // parity
-        addParity(numOnes);
-
-        // stop bit(s)
-        for (int j = 0; j < mNumStopBits; j++) {
-            mUartData.append(1);
+        for (int j = 0; j < numBits; j++) {
+            mPattern.append((frame >> j) & 1);
         }
-
     }
 
     // idle line -> high
-    mUartData.append(1);
+    mPattern.append(1);
 
     return true;
 }
@@ -109,9 +101,15 @@ bool UartGenerator::generate(QByteArray &data)
 */
 QVector<int> UartGenerator::uartData()
 {
-    return mUartData;
+    return mPattern.states(0);
 }
 
+/*!
+    \fn const PackedPattern &UartGenerator::pattern() const
+
+    Returns the generated UART signal packed into 32-bit words.
+*/
+
 /*!
     Returns sample rate.
 */
@@ -122,56 +120,61 @@ int UartGenerator::sampleRate()
 }
 
 /*!
-    Add parity
+    Returns the frame for \a data with the current settings, see
+    \ref createFrame.
+*/
+quint32 UartGenerator::frameBits(char data, int* numBits)
+{
+    return createFrame(data, mNumDataBits, mParity, mNumStopBits, numBits);
+}
+
+/*!
+    Returns the frame for \a data, i.e. start bit, \a dataBits data bits
+    (LSB first), optional \a parity bit and \a stopBits stop bit(s), with
+    the first bit in the least significant bit. The number of bits in the
+    frame is returned in \a numBits.
 */
-void UartGenerator::addParity(int numOnes)
+quint32 UartGenerator::createFrame(char data, int dataBits, Types::UartParity parity, int stopBits, int* numBits)
 {
+    quint32 dataMask = (1u << dataBits) - 1;
+    quint32 bits = ((quint32)data) & dataMask;
+    int pos = 0;
+
+    // start bit (0) followed by the data, LSB first (do we also need to
+    // support MSB first)
+    quint32 frame = bits << 1;
+    pos = 1 + dataBits;
+
+    int odd = 0;
+    for (quint32 b = bits; b != 0; b &= (b - 1)) {
+        odd ^= 1;
+    }
 
-    switch (mParity) {
+    // parity
+    switch (parity) {
     case Types::ParityNone:
         break;
     case Types::ParityOdd:
-        if ((numOnes % 2) == 0) {
-            mUartData.append(1);
-        } else {
-            mUartData.append(0);
-        }
+        frame |= ((quint32)(odd ^ 1)) << pos++;
         break;
     case Types::ParityEven:
-        if ((numOnes % 2) == 0) {
-            mUartData.append(0);
-        } else {
-            mUartData.append(1);
-        }
+        frame |= ((quint32)odd) << pos++;
         break;
     case Types::ParityMark:
-        mUartData.append(1);
+        frame |= 1u << pos++;
         break;
     case Types::ParitySpace:
-        mUartData.append(0);
+        pos++;
         break;
     default:
         break;
     }
 
-}
-
-/*!
-    Add data.
-*/
-int UartGenerator::addData(char data)
-{
-    int numOnes = 0;
-    // LSB first (do we also need to support MSB first)
-    for (int i = 0; i < mNumDataBits; i++) {
-        if ( (data & (1<<i)) != 0) {
-            mUartData.append(1);
-            numOnes++;
-        }
-        else {
-            mUartData.append(0);
-        }
+    // stop bit(s)
+    for (int j = 0; j < stopBits; j++) {
+        frame |= 1u << pos++;
     }
 
-    return numOnes;
+    *numBits = pos;
+    return frame;
 }
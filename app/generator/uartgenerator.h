@@ -20,6 +20,7 @@
 #include <QVector>
 
 #include "common/types.h"
+#include "packedpattern.h"
 
 class UartGenerator : public QObject
 {
@@ -35,9 +36,11 @@ public:
 
     bool generate(QByteArray &data);
     QVector<int> uartData();
+    const PackedPattern &pattern() const {return mPattern;}
     int sampleRate();
 
-    
+    static quint32 createFrame(char data, int dataBits, Types::UartParity parity, int stopBits, int* numBits);
+
 signals:
     
 public slots:
@@ -48,10 +51,9 @@ private:
     int mNumStopBits;
     Types::UartParity mParity;
 
-    QVector<int> mUartData;
+    PackedPattern mPattern;
 
-    void addParity(int numOnes);
-    int addData(char data);
+    quint32 frameBits(char data, int* numBits);
     
 };
 
@@ -0,0 +1,258 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include "uartstream.h"
+
+#include <QStringList>
+
+#include "uartgenerator.h"
+
+/*!
+    \class UartStream
+    \brief Produces UART output for a digital signal lazily, one word of
+    32 states at a time.
+
+    \ingroup Generator
+
+    A UartStream is attached to a generated DigitalSignal and replaces the
+    signal's states when the generator device streams the digital signals
+    (see LabToolGeneratorStream). The output never ends and is never stored
+    in full. It can repeat a text or send an incrementing counter or pseudo
+    random bytes, which makes it useful for long running tests of a UART
+    receiver.
+
+    Frames are sent back to back. Each bit lasts for \ref statesPerBit
+    states so the generator's rate should be a multiple of the baud rate.
+*/
+
+/*!
+    \enum UartStream::Payload
+
+    This enum describes the data sent by the stream.
+
+    \var UartStream::Payload UartStream::PayloadText
+    The text is repeated over and over again
+
+    \var UartStream::Payload UartStream::PayloadCounter
+    An 8-bit counter starting at 0
+
+    \var UartStream::Payload UartStream::PayloadRandom
+    Pseudo random bytes, the same sequence every time the stream starts
+*/
+
+/*!
+    Constructs a disabled stream with 115200 baud and 8N1 frames.
+*/
+UartStream::UartStream()
+{
+    mEnabled = false;
+    mBaudRate = 115200;
+    mDataBits = 8;
+    mStopBits = 1;
+    mParity = Types::ParityNone;
+    mPayload = PayloadText;
+
+    mStatesPerBit = 1;
+    mFrame = 1;
+    mFrameBits = 1;
+    mBit = 0;
+    mBitStatesLeft = 0;
+    mTextPos = 0;
+    mCounter = 0;
+    mRandom = 0;
+}
+
+/*!
+    Returns true if this stream and \a other have the same settings;
+    otherwise returns false. The output state is not compared.
+*/
+bool UartStream::operator==(const UartStream &other) const
+{
+    return (mEnabled == other.mEnabled &&
+            mBaudRate == other.mBaudRate &&
+            mDataBits == other.mDataBits &&
+            mStopBits == other.mStopBits &&
+            mParity == other.mParity &&
+            mPayload == other.mPayload &&
+            mText == other.mText);
+}
+
+/*!
+    Returns the number of states that each bit lasts for when the states
+    are output with \a stateRate states per second and the UART has
+    \a baudRate baud. The actual baud rate is \a stateRate divided by the
+    returned value.
+*/
+int UartStream::statesPerBit(int stateRate, int baudRate)
+{
+    if (baudRate <= 0) {
+        return 1;
+    }
+    return qMax(1, qRound((double)stateRate / baudRate));
+}
+
+/*!
+    Restarts the output from the beginning of the payload for a generator
+    that outputs \a stateRate states per second.
+*/
+void UartStream::start(int stateRate)
+{
+    mStatesPerBit = statesPerBit(stateRate, mBaudRate);
+    mFrame = 1;
+    mFrameBits = 1;
+    mBit = 1;
+    mBitStatesLeft = 0;
+    mTextPos = 0;
+    mCounter = 0;
+    mRandom = 0x2545f491;
+}
+
+/*!
+    Returns the next 32 states with the first state in the least significant
+    bit, i.e. the same format as DigitalSignal::stateWord.
+*/
+quint32 UartStream::nextWord()
+{
+    quint32 word = 0;
+    int filled = 0;
+
+    while (filled < 32)
+    {
+        if (mBitStatesLeft == 0)
+        {
+            if (mBit >= mFrameBits) {
+                nextFrame();
+            }
+            mBit++;
+            mBitStatesLeft = mStatesPerBit;
+        }
+
+        int n = qMin(32 - filled, mBitStatesLeft);
+        if ((mFrame >> (mBit - 1)) & 1) {
+            quint32 mask = (n == 32) ? 0xffffffff : ((1u << n) - 1);
+            word |= mask << filled;
+        }
+        filled += n;
+        mBitStatesLeft -= n;
+    }
+
+    return word;
+}
+
+/*!
+    Returns the next character of the payload.
+*/
+char UartStream::nextCharacter()
+{
+    switch (mPayload) {
+    case PayloadCounter:
+        return (char)(mCounter++ & 0xff);
+
+    case PayloadRandom:
+        // xorshift32
+        mRandom ^= mRandom << 13;
+        mRandom ^= mRandom >> 17;
+        mRandom ^= mRandom << 5;
+        return (char)(mRandom >> 24);
+
+    case PayloadText:
+    default:
+    {
+        char c = mText.at(mTextPos);
+        mTextPos = (mTextPos + 1) % mText.size();
+        return c;
+    }
+    }
+}
+
+/*!
+    Loads the next frame. An empty text is output as an idle (high) line.
+*/
+void UartStream::nextFrame()
+{
+    mBit = 0;
+    if (mPayload == PayloadText && mText.isEmpty()) {
+        mFrame = 1;
+        mFrameBits = 1;
+        return;
+    }
+
+    mFrame = UartGenerator::createFrame(nextCharacter(), mDataBits, mParity,
+                                        mStopBits, &mFrameBits);
+}
+
+/*!
+    Returns a string representation of the settings, without any ';'
+    characters so that it can be embedded in DigitalSignal's settings.
+
+    \sa fromSettingsString()
+*/
+QString UartStream::toSettingsString() const
+{
+    // uart,enabled,baud,dataBits,stopBits,parity,payload,text(base64 coded)
+
+    QString str("uart,");
+    str.append(QString("%1,").arg(mEnabled ? 1 : 0));
+    str.append(QString("%1,").arg(mBaudRate));
+    str.append(QString("%1,").arg(mDataBits));
+    str.append(QString("%1,").arg(mStopBits));
+    str.append(QString("%1,").arg(mParity));
+    str.append(QString("%1,").arg(mPayload));
+    str.append(mText.toBase64());
+
+    return str;
+}
+
+/*!
+    Creates a stream from the string representation in \a settings. A
+    disabled stream is returned if the parsing fails.
+
+    \sa toSettingsString()
+*/
+UartStream UartStream::fromSettingsString(const QString &settings)
+{
+    UartStream tmp;
+    QStringList list = settings.split(',');
+
+    do {
+        if (list.size() != 8) break;
+        if (list.at(0) != "uart") break;
+
+        bool ok = false;
+        int values[6];
+        for (int i = 0; i < 6; i++) {
+            values[i] = list.at(i + 1).toInt(&ok);
+            if (!ok) break;
+        }
+        if (!ok) break;
+
+        if (values[1] <= 0) break;
+        if (values[2] < 5 || values[2] > 8) break;
+        if (values[3] < 1 || values[3] > 2) break;
+        if (values[4] < 0 || values[4] >= Types::ParityNum) break;
+        if (values[5] < 0 || values[5] >= PayloadNum) break;
+
+        tmp.mEnabled = (values[0] != 0);
+        tmp.mBaudRate = values[1];
+        tmp.mDataBits = values[2];
+        tmp.mStopBits = values[3];
+        tmp.mParity = (Types::UartParity)values[4];
+        tmp.mPayload = (Payload)values[5];
+        tmp.mText = QByteArray::fromBase64(list.at(7).toLatin1());
+
+    } while (false);
+
+    return tmp;
+}
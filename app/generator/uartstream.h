@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#ifndef UARTSTREAM_H
+#define UARTSTREAM_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "common/types.h"
+
+class UartStream
+{
+public:
+
+    enum Payload {
+        PayloadText,
+        PayloadCounter,
+        PayloadRandom,
+        PayloadNum // must be last
+    };
+
+    UartStream();
+    bool operator==(const UartStream &other) const;
+    bool operator!=(const UartStream &other) const
+        {return !(*this == other);}
+
+    bool isEnabled() const {return mEnabled;}
+    void setEnabled(bool enabled) {mEnabled = enabled;}
+
+    int baudRate() const {return mBaudRate;}
+    void setBaudRate(int rate) {mBaudRate = rate;}
+    int dataBits() const {return mDataBits;}
+    void setDataBits(int numBits) {mDataBits = numBits;}
+    int stopBits() const {return mStopBits;}
+    void setStopBits(int numBits) {mStopBits = numBits;}
+    Types::UartParity parity() const {return mParity;}
+    void setParity(Types::UartParity parity) {mParity = parity;}
+
+    Payload payload() const {return mPayload;}
+    void setPayload(Payload payload) {mPayload = payload;}
+    QByteArray text() const {return mText;}
+    void setText(const QByteArray &text) {mText = text;}
+
+    static int statesPerBit(int stateRate, int baudRate);
+
+    void start(int stateRate);
+    quint32 nextWord();
+
+    QString toSettingsString() const;
+    static UartStream fromSettingsString(const QString &settings);
+
+private:
+
+    bool mEnabled;
+    int mBaudRate;
+    int mDataBits;
+    int mStopBits;
+    Types::UartParity mParity;
+    Payload mPayload;
+    QByteArray mText;
+
+    // output state
+    int mStatesPerBit;
+    quint32 mFrame;
+    int mFrameBits;
+    int mBit;
+    int mBitStatesLeft;
+    int mTextPos;
+    quint32 mCounter;
+    quint32 mRandom;
+
+    char nextCharacter();
+    void nextFrame();
+
+};
+
+#endif // UARTSTREAM_H
@@ -51,6 +51,15 @@ void UiAnalogShape::setWaveform(AnalogSignal::AnalogWaveform form)
     update();
 }
 
+/*!
+    Set the \a data to draw when the waveform is AnalogSignal::WaveformArbitrary.
+*/
+void UiAnalogShape::setArbitraryData(const QVector<double> &data)
+{
+    mArbitraryData = data;
+    update();
+}
+
 /*!
     Paint event handler responsible for painting this widget.
 */
@@ -80,6 +89,9 @@ void UiAnalogShape::paintEvent(QPaintEvent *event)
     case AnalogSignal::WaveformTriangle:
         paintTriangle(&painter, w, h);
         break;
+    case AnalogSignal::WaveformArbitrary:
+        paintArbitrary(&painter, w, h);
+        break;
     default:
         break;
     }
@@ -190,3 +202,36 @@ void UiAnalogShape::paintTriangle(QPainter* painter, int w, int h)
 
     painter->restore();
 }
+
+/*!
+    Paint an arbitrary analog waveform.
+*/
+void UiAnalogShape::paintArbitrary(QPainter* painter, int w, int h)
+{
+    if (mArbitraryData.isEmpty()) return;
+
+    int n = mArbitraryData.size();
+
+    QPainterPath path;
+    path.moveTo(0, (h/2) - (h/2)*mArbitraryData.at(0));
+
+    for (int i = 1; i < w; i++) {
+        int idx = (int)(((qint64)i*n)/w);
+
+        double y = (h/2) - (h/2)*mArbitraryData.at(idx);
+        path.lineTo(i, y);
+    }
+
+    painter->save();
+
+    painter->setRenderHint(QPainter::Antialiasing);
+
+    QPen pen = painter->pen();
+    pen.setWidth(2);
+    pen.setColor(Qt::blue);
+    painter->setPen(pen);
+
+    painter->drawPath(path);
+
+    painter->restore();
+}
@@ -30,6 +30,7 @@ public:
 
     AnalogSignal::AnalogWaveform waveform() {return mWaveform;}
     void setWaveform(AnalogSignal::AnalogWaveform form);
+    void setArbitraryData(const QVector<double> &data);
     
 signals:
     
@@ -42,11 +43,13 @@ protected:
 
 private:
     AnalogSignal::AnalogWaveform mWaveform;
+    QVector<double> mArbitraryData;
 
     void paintGrid(QPainter* painter, int w, int h);
     void paintSine(QPainter* painter, int w, int h);
     void paintSquare(QPainter* painter, int w, int h);
     void paintTriangle(QPainter* painter, int w, int h);
+    void paintArbitrary(QPainter* painter, int w, int h);
     
 };
 
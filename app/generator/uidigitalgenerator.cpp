@@ -39,7 +39,10 @@
 
     \ingroup Generator
 
-    Each digital signal will be shown as a row in a table.
+    Each digital signal will be shown as a row in a table. When there are
+    more states than DigitalSignals::MaxVisibleStates the table only shows
+    a window of the states and a scroll bar below the table is used to move
+    the window.
 */
 
 /*!
@@ -55,7 +58,7 @@ UiDigitalGenerator::UiDigitalGenerator(DigitalSignals* digitalSignals,
     GeneratorDevice* device = DeviceManager::instance().activeDevice()
             ->generatorDevice();
     if (device != NULL) {
-        defaultStates = device->maxNumDigitalStates();
+        defaultStates = qMin(device->maxNumDigitalStates(), 256);
     }
 
     // Deallocation: ownership changed when calling setLayout
@@ -63,8 +66,16 @@ UiDigitalGenerator::UiDigitalGenerator(DigitalSignals* digitalSignals,
 
     mTable = createTable();
 
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mStateScroll = new QScrollBar(Qt::Horizontal, this);
+    mStateScroll->setToolTip(tr("Move to other states"));
+    mStateScroll->setVisible(false);
+    connect(mStateScroll, SIGNAL(valueChanged(int)),
+            this, SLOT(handleStateScrolled(int)));
+
     verticalLayout->addWidget(createToolBar());
     verticalLayout->addWidget(mTable);
+    verticalLayout->addWidget(mStateScroll);
 
     setLayout(verticalLayout);
 
@@ -116,9 +127,21 @@ void UiDigitalGenerator::setNumStates(int states)
         mStatesBox->setValue(states);
     }
 
-    // make sure the columns are resized, but keep the size of column 0
+    // only a window of the states is visible in the table
+    int window = DigitalSignals::MaxVisibleStates;
+    mStateScroll->setRange(0, qMax(0, states - window));
+    mStateScroll->setPageStep(window);
+    mStateScroll->setSingleStep(window / 16);
+    mStateScroll->setValue(mSignals->firstState());
+    mStateScroll->setVisible(states > window);
+
+    // all state columns have the same width which is enough for the
+    // largest state number. The columns don't have to be resized to
+    // their contents which would require the view to visit every cell.
     int c0Width = mTable->columnWidth(0);
-    mTable->resizeColumnsToContents();
+    QFontMetrics fm = mTable->horizontalHeader()->fontMetrics();
+    int width = fm.width(QString::number(states-1)) + 10;
+    mTable->horizontalHeader()->setDefaultSectionSize(width);
     mTable->setColumnWidth(0, c0Width);
 }
 
@@ -139,7 +162,7 @@ void UiDigitalGenerator::handleDeviceChanged()
 
     // ### selected number of states
 
-    int states = device->maxNumDigitalStates();
+    int states = qMin(device->maxNumDigitalStates(), 256);
     if (digitalSignals.size() > 0) {
         // Use num states for the first digital
         // signal as num states. All signals have the same size.
@@ -411,5 +434,10 @@ void UiDigitalGenerator::updateRate()
 
 }
 
-
-
+/*!
+    Called when the state scroll bar has been moved to \a value.
+*/
+void UiDigitalGenerator::handleStateScrolled(int value)
+{
+    mSignals->setFirstState(value);
+}
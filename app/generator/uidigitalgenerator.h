@@ -23,6 +23,7 @@
 #include <QToolBar>
 #include <QLineEdit>
 #include <QAction>
+#include <QScrollBar>
 
 #include "digitalsignals.h"
 
@@ -46,6 +47,7 @@ public slots:
 private:
 
     QTableView *mTable;
+    QScrollBar* mStateScroll;
     DigitalSignals* mSignals;
 
     QLineEdit* mRate;
@@ -67,6 +69,7 @@ private slots:
     void removeSelectedSignals();
     void handleSelectionChanged(QItemSelection selected, QItemSelection deselected);
     void updateRate();
+    void handleStateScrolled(int value);
     
 };
 
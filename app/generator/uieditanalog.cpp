@@ -17,16 +17,29 @@
 
 #include <QHBoxLayout>
 #include <QFormLayout>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QTextStream>
+#include <QDir>
+#include <QRegExp>
 
 #include "common/stringutil.h"
 #include "device/devicemanager.h"
 
+/*!
+    Largest number of values kept for an arbitrary waveform. Longer waveforms
+    are downsampled when loaded.
+*/
+#define MAX_ARBITRARY_VALUES  4096
+
 /*!
     \class UiEditAnalog
     \brief UI widget that is responsible for analog signal generation settings.
 
     \ingroup Generator
 
+    An arbitrary waveform can be loaded from a text file (one value per line,
+    in the first column) or taken from the last captured analog signal.
 */
 
 
@@ -54,6 +67,7 @@ UiEditAnalog::UiEditAnalog(AnalogSignal *signal, QWidget *parent) :
     // Deallocation: "Qt Object trees" (See UiMainWindow)
     mShape = new UiAnalogShape(this);
     mShape->setWaveform(mSignal->waveform());
+    mShape->setArbitraryData(mSignal->arbitraryData());
 
     mWaveBox = createWaveformBox(mSignal->waveform());
     settingsLayout->addRow(tr("Waveform:"), mWaveBox);
@@ -66,6 +80,26 @@ UiEditAnalog::UiEditAnalog(AnalogSignal *signal, QWidget *parent) :
     mAmpBox->setValue(mSignal->amplitude());
     settingsLayout->addRow(tr("Amplitude:"), mAmpBox);
 
+    // Deallocation: Re-parented when calling addRow below
+    QHBoxLayout* dataLayout = new QHBoxLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mFileButton = new QPushButton(tr("File..."), this);
+    connect(mFileButton, SIGNAL(clicked()), this, SLOT(loadFromFile()));
+    dataLayout->addWidget(mFileButton);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    mCaptureButton = new QPushButton(tr("Capture"), this);
+    mCaptureButton->setToolTip(tr("Use the last captured analog signal"));
+    connect(mCaptureButton, SIGNAL(clicked()), this, SLOT(loadFromCapture()));
+    dataLayout->addWidget(mCaptureButton);
+
+    settingsLayout->addRow(tr("Waveform data:"), dataLayout);
+
+    bool arbitrary = (mSignal->waveform() == AnalogSignal::WaveformArbitrary);
+    mFileButton->setEnabled(arbitrary);
+    mCaptureButton->setEnabled(arbitrary);
+
     layout->addLayout(settingsLayout);
     layout->addWidget(mShape);
 
@@ -121,6 +155,10 @@ QComboBox* UiEditAnalog::createWaveformBox(
                 box->addItem("Triangle",
                              QVariant(AnalogSignal::WaveformTriangle));
                 break;
+            case AnalogSignal::WaveformArbitrary:
+                box->addItem("Arbitrary",
+                             QVariant(AnalogSignal::WaveformArbitrary));
+                break;
             default:
                 break;
             }
@@ -247,6 +285,10 @@ void UiEditAnalog::changeWaveform(int selectedIdx)
 
     mShape->setWaveform(static_cast<AnalogSignal::AnalogWaveform>(w));
     mSignal->setWaveform(static_cast<AnalogSignal::AnalogWaveform>(w));
+
+    bool arbitrary = (w == AnalogSignal::WaveformArbitrary);
+    mFileButton->setEnabled(arbitrary);
+    mCaptureButton->setEnabled(arbitrary);
 }
 
 /*!
@@ -256,3 +298,133 @@ void UiEditAnalog::amplitudeChanged(double v)
 {
     mSignal->setAmplitude(v);
 }
+
+/*!
+    Uses \a data (in Volts) as the arbitrary waveform. The waveform is
+    normalized and the amplitude is set to the largest absolute value.
+*/
+void UiEditAnalog::setArbitraryData(QVector<double> data)
+{
+    // downsample by averaging if there are too many values
+    if (data.size() > MAX_ARBITRARY_VALUES) {
+        QVector<double> tmp(MAX_ARBITRARY_VALUES);
+        for (int i = 0; i < MAX_ARBITRARY_VALUES; i++) {
+            int from = (int)(((qint64)i * data.size()) / MAX_ARBITRARY_VALUES);
+            int to = (int)(((qint64)(i + 1) * data.size()) / MAX_ARBITRARY_VALUES);
+            double sum = 0;
+            for (int j = from; j < to; j++) {
+                sum += data.at(j);
+            }
+            tmp[i] = sum / (to - from);
+        }
+        data = tmp;
+    }
+
+    double peak = 0;
+    foreach(double v, data) {
+        peak = qMax(peak, qAbs(v));
+    }
+
+    if (peak > 0) {
+        for (int i = 0; i < data.size(); i++) {
+            data[i] = data.at(i) / peak;
+        }
+    }
+
+    mSignal->setArbitraryData(data);
+    mShape->setArbitraryData(mSignal->arbitraryData());
+
+    if (peak > 0) {
+        mAmpBox->setValue(qMin(peak, mAmpBox->maximum()));
+    }
+}
+
+/*!
+    This function is called when the user wants to load an arbitrary
+    waveform from a file. The file must have one value (in Volts) per line.
+    If there are several columns then the first one is used. Lines that
+    don't start with a number (e.g. headers) are ignored.
+*/
+void UiEditAnalog::loadFromFile()
+{
+    QString name = QFileDialog::getOpenFileName(
+                this,
+                tr("Load Waveform"),
+                QDir::currentPath(),
+                "Waveforms (*.csv *.txt);;All files (*)");
+
+    if (name.isNull() || name.isEmpty()) return;
+
+    QFile file(name);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QMessageBox::warning(this,
+                             tr("Load failed"),
+                             tr("Failed to open %1").arg(name));
+        return;
+    }
+
+    QVector<double> data;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        QString first = line.section(QRegExp("[,;\\s]"), 0, 0);
+
+        bool ok = false;
+        double v = first.toDouble(&ok);
+        if (ok) {
+            data.append(v);
+        }
+    }
+
+    if (data.size() < 2) {
+        QMessageBox::warning(this,
+                             tr("Load failed"),
+                             tr("No waveform found in %1").arg(name));
+        return;
+    }
+
+    setArbitraryData(data);
+}
+
+/*!
+    This function is called when the user wants to use the last captured
+    analog signal as arbitrary waveform. The analog signal with the same ID
+    as this signal is used if it has data, otherwise the first one with data.
+    The whole capture is one period and the frequency is set so that it is
+    replayed in the same time as it was captured.
+*/
+void UiEditAnalog::loadFromCapture()
+{
+    CaptureDevice* device = DeviceManager::instance().activeDevice()
+            ->captureDevice();
+    if (device == NULL) return;
+
+    QVector<double>* data = NULL;
+    foreach(AnalogSignal* s, device->analogSignals()) {
+        QVector<double>* d = device->analogData(s->id());
+        if (d == NULL || d->size() < 2) continue;
+
+        if (data == NULL || s->id() == mSignal->id()) {
+            data = d;
+        }
+    }
+
+    if (data == NULL) {
+        QMessageBox::warning(this,
+                             tr("No data"),
+                             tr("There is no captured analog signal to use"));
+        return;
+    }
+
+    setArbitraryData(*data);
+
+    if (device->usedSampleRate() > 0) {
+        GeneratorDevice* gen = DeviceManager::instance().activeDevice()
+                ->generatorDevice();
+        int freq = qRound((double)device->usedSampleRate() / data->size());
+        freq = qBound(gen->minAnalogRate(), freq, gen->maxAnalogRate());
+
+        mRate->setText(StringUtil::frequencyToString(freq));
+        updateRate();
+    }
+}
@@ -20,6 +20,7 @@
 #include <QComboBox>
 #include <QLineEdit>
 #include <QDoubleSpinBox>
+#include <QPushButton>
 
 #include "device/analogsignal.h"
 
@@ -45,17 +46,22 @@ private:
     QString mLastRateText;
     QComboBox* mWaveBox;
     QDoubleSpinBox* mAmpBox;
+    QPushButton* mFileButton;
+    QPushButton* mCaptureButton;
     UiAnalogShape* mShape;
 
     QComboBox* createWaveformBox(AnalogSignal::AnalogWaveform selected = AnalogSignal::WaveformSine);
     QLineEdit* createFrequencyBox();
     QDoubleSpinBox *createAmplitudeBox();
+    void setArbitraryData(QVector<double> data);
 
 private slots:
     void handleNameEdited();
     void updateRate();
     void changeWaveform(int selectedIdx);
     void amplitudeChanged(double v);
+    void loadFromFile();
+    void loadFromCapture();
     
 };
 
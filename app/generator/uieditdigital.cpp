@@ -22,6 +22,10 @@
 #include <QPushButton>
 #include <QSpinBox>
 #include <QMessageBox>
+#include <QCheckBox>
+
+#include "common/inputhelper.h"
+#include "device/devicemanager.h"
 
 #define TYPE_WIDGET_INDEX (1)
 
@@ -31,6 +35,9 @@
 
     \ingroup Generator
 
+    The outputs are generated directly in the packed signal data with the
+    word-wise operations in DigitalSignal which keeps them fast also for
+    long patterns.
 */
 
 
@@ -106,15 +113,29 @@ UiEditDigital::UiEditDigital(DigitalSignal* signal, QWidget *parent) :
 
 #define TYPE_CONSTANT "Constant"
 #define TYPE_CLOCK    "Clock"
+#define TYPE_INVERT   "Invert"
+#define TYPE_REPEAT   "Repeat"
+#define TYPE_UART     "UART stream"
 
 /*!
-    Returns the generate type.
+    Returns the generate type. The UART stream is only available if the
+    active generator device supports it.
 */
 QStringList UiEditDigital::generateTypes()
 {
-    return QList<QString>()
+    QStringList types = QList<QString>()
             << TYPE_CONSTANT
-            << TYPE_CLOCK;
+            << TYPE_CLOCK
+            << TYPE_INVERT
+            << TYPE_REPEAT;
+
+    GeneratorDevice* device = DeviceManager::instance().activeDevice()
+            ->generatorDevice();
+    if (device != NULL && device->supportsUartStreams()) {
+        types << TYPE_UART;
+    }
+
+    return types;
 }
 
 /*!
@@ -131,27 +152,50 @@ QWidget* UiEditDigital::createType(QString type)
         return createTypeClock();
     }
 
+    if (TYPE_INVERT == type) {
+        return createTypeInvert();
+    }
+
+    if (TYPE_REPEAT == type) {
+        return createTypeRepeat();
+    }
+
+    if (TYPE_UART == type) {
+        return createTypeUart();
+    }
+
     return NULL;
 }
 
 /*!
     Generate signal data based on \a type. Settings are retrieved from the
-    widget \a w and signal data is stored in the vector \a data. If a problem
+    widget \a w and the signal data is modified in place. If a problem
     occurs a warning message is given in the out parameter \a warnMsg.
 
     The function returns true if signal data was generated; otherwise it
     returns false
 */
-bool UiEditDigital::generateOutput(QString type, QWidget *w,
-                                   QVector<bool> &data, QString &warnMsg)
+bool UiEditDigital::generateOutput(QString type, QWidget *w, QString &warnMsg)
 {
 
     if (TYPE_CONSTANT == type) {
-        return generateConstantOutput(w, data, warnMsg);
+        return generateConstantOutput(w, warnMsg);
     }
 
     if (TYPE_CLOCK == type) {
-        return generateClockOutput(w, data, warnMsg);
+        return generateClockOutput(w, warnMsg);
+    }
+
+    if (TYPE_INVERT == type) {
+        return generateInvertOutput(w, warnMsg);
+    }
+
+    if (TYPE_REPEAT == type) {
+        return generateRepeatOutput(w, warnMsg);
+    }
+
+    if (TYPE_UART == type) {
+        return generateUartOutput(w, warnMsg);
     }
 
     return false;
@@ -199,14 +243,13 @@ QWidget* UiEditDigital::createTypeConstant()
 
 /*!
     Generate signal data for constant output. Settings are retrieved from the
-    widget \a w and signal data is stored in the vector \a data. If a problem
-    occurs a warning message is given in the out parameter \a warnMsg.
+    widget \a w. If a problem occurs a warning message is given in the out
+    parameter \a warnMsg.
 
     The function returns true if signal data was generated; otherwise it
     returns false
 */
-bool UiEditDigital::generateConstantOutput(QWidget* w, QVector<bool> &data,
-                                           QString &warnMsg)
+bool UiEditDigital::generateConstantOutput(QWidget* w, QString &warnMsg)
 {
 
     do {
@@ -228,7 +271,7 @@ bool UiEditDigital::generateConstantOutput(QWidget* w, QVector<bool> &data,
         }
         if (from < 0 || to >= mSignal->numStates()) break;
 
-        setStates(data, (lvl == 1), from, to);
+        mSignal->setStates(from, to+1, (lvl == 1));
 
 
         return true;
@@ -278,14 +321,13 @@ QWidget* UiEditDigital::createTypeClock()
 
 /*!
     Generate signal data for clock output. Settings are retrieved from the
-    widget \a w and signal data is stored in the vector \a data. If a problem
-    occurs a warning message is given in the out parameter \a warnMsg.
+    widget \a w. If a problem occurs a warning message is given in the out
+    parameter \a warnMsg.
 
     The function returns true if signal data was generated; otherwise it
     returns false
 */
-bool UiEditDigital::generateClockOutput(QWidget *w, QVector<bool> &data,
-                                        QString &warnMsg)
+bool UiEditDigital::generateClockOutput(QWidget *w, QString &warnMsg)
 {
     do {
         QComboBox* lvlBox = w->findChild<QComboBox*>("clockStartLevel");
@@ -300,7 +342,7 @@ bool UiEditDigital::generateClockOutput(QWidget *w, QVector<bool> &data,
         if (fromBox == NULL) break;
         int from = fromBox->value();
 
-        if (from < 0 || from >= data.size()) break;
+        if (from < 0 || from >= mSignal->numStates()) break;
 
         // greatest common factor
         int factor = dutyCycle;
@@ -323,43 +365,269 @@ bool UiEditDigital::generateClockOutput(QWidget *w, QVector<bool> &data,
         }
 
 
-        bool genHighOutput = (startLevel == 1);
-        while (from < mSignal->numStates()) {
-            if (genHighOutput) {
-                setStates(data, true, from, from+numHigh);
-                from += numHigh;
-            }
-            else {
-                setStates(data, false, from, from+numLow);
-                from += numLow;
-            }
+        mSignal->generateClock(from, mSignal->numStates(), numHigh, numLow,
+                               (startLevel == 1));
 
-            genHighOutput = !genHighOutput;
-        }
 
 
+        return true;
+
+    } while(false);
+
+    return false;
+}
+
+/*!
+    Create a widget for inverting a range of states.
+*/
+QWidget* UiEditDigital::createTypeInvert()
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QFrame* w = new QFrame(this);
+    w->setFrameShape(QFrame::StyledPanel);
+
+    // Deallocation: Ownership changed when calling setLayout
+    QFormLayout* l = new QFormLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QSpinBox* fromBox = new QSpinBox(w);
+    fromBox->setObjectName("invertFrom");
+    fromBox->setMinimum(0);
+    fromBox->setMaximum(mSignal->numStates()-1);
+    l->addRow(tr("From:"), fromBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QSpinBox* toBox = new QSpinBox(w);
+    toBox->setObjectName("invertTo");
+    toBox->setMinimum(0);
+    toBox->setMaximum(mSignal->numStates()-1);
+    toBox->setValue(mSignal->numStates()-1);
+    l->addRow(tr("To:"), toBox);
+
+    w->setLayout(l);
+
+    return w;
+}
+
+/*!
+    Invert a range of states. Settings are retrieved from the widget \a w.
+    If a problem occurs a warning message is given in the out parameter
+    \a warnMsg.
+
+    The function returns true if signal data was generated; otherwise it
+    returns false
+*/
+bool UiEditDigital::generateInvertOutput(QWidget *w, QString &warnMsg)
+{
+    do {
+        QSpinBox* fromBox = w->findChild<QSpinBox*>("invertFrom");
+        if (fromBox == NULL) break;
+        int from = fromBox->value();
+
+        QSpinBox* toBox = w->findChild<QSpinBox*>("invertTo");
+        if (toBox == NULL) break;
+        int to = toBox->value();
+
+        if (to < from) {
+            warnMsg = "'From' state larger than 'to' state";
+            break;
+        }
+        if (from < 0 || to >= mSignal->numStates()) break;
+
+        mSignal->invertStates(from, to+1);
 
         return true;
+    } while(false);
+
+    return false;
+}
 
+/*!
+    Create a widget for repeating a sequence of states until the end
+    of the signal.
+*/
+QWidget* UiEditDigital::createTypeRepeat()
+{
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QFrame* w = new QFrame(this);
+    w->setFrameShape(QFrame::StyledPanel);
+
+    // Deallocation: Ownership changed when calling setLayout
+    QFormLayout* l = new QFormLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QSpinBox* fromBox = new QSpinBox(w);
+    fromBox->setObjectName("repeatFrom");
+    fromBox->setMinimum(0);
+    fromBox->setMaximum(mSignal->numStates()-1);
+    l->addRow(tr("From:"), fromBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QSpinBox* lengthBox = new QSpinBox(w);
+    lengthBox->setObjectName("repeatLength");
+    lengthBox->setMinimum(1);
+    lengthBox->setMaximum(mSignal->numStates());
+    lengthBox->setValue(qMin(8, mSignal->numStates()));
+    lengthBox->setToolTip(tr("Number of states to repeat until the end of the signal"));
+    l->addRow(tr("Length:"), lengthBox);
+
+    w->setLayout(l);
+
+    return w;
+}
+
+/*!
+    Repeat a sequence of states until the end of the signal. Settings are
+    retrieved from the widget \a w. If a problem occurs a warning message
+    is given in the out parameter \a warnMsg.
+
+    The function returns true if signal data was generated; otherwise it
+    returns false
+*/
+bool UiEditDigital::generateRepeatOutput(QWidget *w, QString &warnMsg)
+{
+    do {
+        QSpinBox* fromBox = w->findChild<QSpinBox*>("repeatFrom");
+        if (fromBox == NULL) break;
+        int from = fromBox->value();
+
+        QSpinBox* lengthBox = w->findChild<QSpinBox*>("repeatLength");
+        if (lengthBox == NULL) break;
+        int length = lengthBox->value();
+
+        if (from < 0 || length <= 0) break;
+        if (from + length > mSignal->numStates()) {
+            warnMsg = "The sequence to repeat ends after the last state";
+            break;
+        }
+
+        mSignal->repeatStates(from, length, mSignal->numStates());
+
+        return true;
     } while(false);
 
     return false;
 }
 
 /*!
-    Set all states in \a data to \a high between indexes \a from and \a to.
+    Create a widget for a UART stream, i.e. UART output that is created
+    while the signal is generated instead of being stored in the states.
 */
-void UiEditDigital::setStates(QVector<bool> &data, bool high, int from,
-                              int to) const
+QWidget* UiEditDigital::createTypeUart()
 {
-    if (from > to) return;
-    if (to >= data.size()) {
-        to = data.size()-1;
-    }
+    const UartStream &stream = mSignal->uartStream();
 
-    for (int i = from; i <= to; i++) {
-        data[i] = high;
-    }
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QFrame* w = new QFrame(this);
+    w->setFrameShape(QFrame::StyledPanel);
+
+    // Deallocation: Ownership changed when calling setLayout
+    QFormLayout* l = new QFormLayout();
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QCheckBox* enableBox = new QCheckBox(tr("Stream UART output"), w);
+    enableBox->setObjectName("uartEnabled");
+    enableBox->setChecked(true);
+    enableBox->setToolTip(tr("Output UART data instead of the states. "
+                             "Requires continuous generation."));
+    l->addRow(enableBox);
+
+    QLineEdit* baudBox = InputHelper::createUartBaudRateBox(w, stream.baudRate());
+    baudBox->setObjectName("uartBaudRate");
+    baudBox->setToolTip(tr("The rate should be a multiple of the baud rate"));
+    l->addRow(tr("Baud rate:"), baudBox);
+
+    // the payload is sent as bytes
+    QComboBox* dataBitsBox = InputHelper::createUartDataBitsBox(w, stream.dataBits());
+    dataBitsBox->setObjectName("uartDataBits");
+    dataBitsBox->removeItem(dataBitsBox->findData(QVariant(9)));
+    l->addRow(tr("Data bits:"), dataBitsBox);
+
+    QComboBox* parityBox = InputHelper::createUartParityBox(w, stream.parity());
+    parityBox->setObjectName("uartParity");
+    l->addRow(tr("Parity:"), parityBox);
+
+    QComboBox* stopBitsBox = InputHelper::createUartStopBitsBox(w, stream.stopBits());
+    stopBitsBox->setObjectName("uartStopBits");
+    l->addRow(tr("Stop bits:"), stopBitsBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QComboBox* payloadBox = new QComboBox(w);
+    payloadBox->setObjectName("uartPayload");
+    payloadBox->addItem(tr("Repeated text"), UartStream::PayloadText);
+    payloadBox->addItem(tr("Counter"), UartStream::PayloadCounter);
+    payloadBox->addItem(tr("Pseudo random"), UartStream::PayloadRandom);
+    InputHelper::setInt(payloadBox, stream.payload());
+    l->addRow(tr("Data:"), payloadBox);
+
+    // Deallocation: "Qt Object trees" (See UiMainWindow)
+    QLineEdit* textBox = new QLineEdit(QString::fromLatin1(stream.text()), w);
+    textBox->setObjectName("uartText");
+    l->addRow(tr("Text:"), textBox);
+
+    w->setLayout(l);
+
+    return w;
+}
+
+/*!
+    Sets up the UART stream of the signal. Settings are retrieved from the
+    widget \a w. If a problem occurs a warning message is given in the out
+    parameter \a warnMsg.
+
+    The function returns true if the stream was set up; otherwise it
+    returns false
+*/
+bool UiEditDigital::generateUartOutput(QWidget *w, QString &warnMsg)
+{
+    do {
+        QCheckBox* enableBox = w->findChild<QCheckBox*>("uartEnabled");
+        if (enableBox == NULL) break;
+
+        QLineEdit* baudBox = w->findChild<QLineEdit*>("uartBaudRate");
+        if (baudBox == NULL) break;
+        int baudRate = InputHelper::intValue(baudBox);
+
+        QComboBox* dataBitsBox = w->findChild<QComboBox*>("uartDataBits");
+        if (dataBitsBox == NULL) break;
+
+        QComboBox* parityBox = w->findChild<QComboBox*>("uartParity");
+        if (parityBox == NULL) break;
+
+        QComboBox* stopBitsBox = w->findChild<QComboBox*>("uartStopBits");
+        if (stopBitsBox == NULL) break;
+
+        QComboBox* payloadBox = w->findChild<QComboBox*>("uartPayload");
+        if (payloadBox == NULL) break;
+        UartStream::Payload payload = (UartStream::Payload)InputHelper::intValue(payloadBox);
+
+        QLineEdit* textBox = w->findChild<QLineEdit*>("uartText");
+        if (textBox == NULL) break;
+        QByteArray text = textBox->text().toLatin1();
+
+        if (baudRate <= 0) {
+            warnMsg = "Invalid baud rate";
+            break;
+        }
+        if (enableBox->isChecked() && payload == UartStream::PayloadText && text.isEmpty()) {
+            warnMsg = "Enter the text to send";
+            break;
+        }
+
+        UartStream stream;
+        stream.setEnabled(enableBox->isChecked());
+        stream.setBaudRate(baudRate);
+        stream.setDataBits(InputHelper::intValue(dataBitsBox));
+        stream.setParity((Types::UartParity)InputHelper::intValue(parityBox));
+        stream.setStopBits(InputHelper::intValue(stopBitsBox));
+        stream.setPayload(payload);
+        stream.setText(text);
+        mSignal->setUartStream(stream);
+
+        return true;
+    } while(false);
+
+    return false;
 }
 
 /*
@@ -408,13 +676,15 @@ void UiEditDigital::handleTypeChanged(QString type)
 void UiEditDigital::generateOutput()
 {
     QString warnMsg;
-    QVector<bool> data = mSignal->data();
     bool ok = generateOutput(
                 mGenTypeBox->currentText(),
                 mTypeWidget,
-                data, warnMsg);
+                warnMsg);
+    if (ok && mGenTypeBox->currentText() != TYPE_UART) {
+        // the states are used again
+        mSignal->setUartStream(UartStream());
+    }
     if (ok) {
-        mSignal->setData(data);
         if (parentWidget()) {
             parentWidget()->update();
         }
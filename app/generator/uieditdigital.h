@@ -42,15 +42,19 @@ private:
 
     QStringList generateTypes();
     QWidget* createType(QString type);
-    bool generateOutput(QString type, QWidget *w, QVector<bool> &data, QString &warnMsg);
+    bool generateOutput(QString type, QWidget *w, QString &warnMsg);
 
 
     QWidget* createTypeConstant();
-    bool generateConstantOutput(QWidget *w, QVector<bool> &data, QString &warnMsg);
+    bool generateConstantOutput(QWidget *w, QString &warnMsg);
     QWidget* createTypeClock();
-    bool generateClockOutput(QWidget *w, QVector<bool> &data, QString &warnMsg);
-
-    void setStates(QVector<bool> &data, bool high, int from, int to) const;
+    bool generateClockOutput(QWidget *w, QString &warnMsg);
+    QWidget* createTypeInvert();
+    bool generateInvertOutput(QWidget *w, QString &warnMsg);
+    QWidget* createTypeRepeat();
+    bool generateRepeatOutput(QWidget *w, QString &warnMsg);
+    QWidget* createTypeUart();
+    bool generateUartOutput(QWidget *w, QString &warnMsg);
 
 private slots:
     void handleNameEdited();
@@ -0,0 +1,34 @@
+# Round-trip tests of the protocol generators against the decoders.
+# Build and run with: qmake && make && ./tst_protocolroundtrip
+
+QT += testlib
+QT -= gui
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_protocolroundtrip
+TEMPLATE = app
+
+APP = ../..
+
+SOURCES += \
+    tst_protocolroundtrip.cpp \
+    $$APP/generator/uartgenerator.cpp \
+    $$APP/generator/spigenerator.cpp \
+    $$APP/generator/i2cgenerator.cpp \
+    $$APP/generator/packedpattern.cpp \
+    $$APP/analyzer/decoder/decodersession.cpp \
+    $$APP/analyzer/decoder/uartdecoder.cpp \
+    $$APP/analyzer/decoder/spidecoder.cpp \
+    $$APP/analyzer/decoder/i2cdecoder.cpp \
+    $$APP/device/digitaltransitions.cpp \
+    $$APP/../fw/program/source/gen_pattern.c
+
+HEADERS += \
+    $$APP/generator/uartgenerator.h \
+    $$APP/generator/spigenerator.h \
+    $$APP/generator/i2cgenerator.h \
+    $$APP/generator/packedpattern.h
+
+INCLUDEPATH += $$APP
+INCLUDEPATH += $$APP/../fw/program/include
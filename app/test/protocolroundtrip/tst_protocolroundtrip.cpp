@@ -0,0 +1,302 @@
+/*
+ *  Copyright 2013 Embedded Artists AB
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <QtTest>
+
+#include "generator/uartgenerator.h"
+#include "generator/spigenerator.h"
+#include "generator/i2cgenerator.h"
+#include "generator/packedpattern.h"
+#include "analyzer/decoder/decodersession.h"
+#include "analyzer/decoder/uartdecoder.h"
+#include "analyzer/decoder/spidecoder.h"
+#include "analyzer/decoder/i2cdecoder.h"
+#include "device/digitaltransitions.h"
+#include "gen_pattern.h"
+
+/*!
+    \class TestProtocolRoundTrip
+    \brief Generates UART, SPI and I2C signals with the protocol generators
+    and checks that the decoders give back the same data.
+
+    \ingroup Generator
+    \internal
+
+    The generated states are oversampled, as a capture would be, before
+    they are decoded.
+*/
+class TestProtocolRoundTrip : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void uart();
+    void spi();
+    void i2c();
+    void packedPattern();
+
+private:
+    static QVector<int> oversample(const QVector<int> &states, int factor);
+    static QVector<DecoderItem> decode(DecoderInterface* decoder,
+                                       const QList< QVector<int> > &channels,
+                                       int sampleRate);
+    static QString hex(int value, int digits);
+};
+
+/*!
+    Returns \a states with each state repeated \a factor times.
+*/
+QVector<int> TestProtocolRoundTrip::oversample(const QVector<int> &states, int factor)
+{
+    QVector<int> out;
+    out.reserve(states.size() * factor);
+    for (int i = 0; i < states.size(); i++) {
+        for (int j = 0; j < factor; j++) {
+            out.append(states.at(i));
+        }
+    }
+    return out;
+}
+
+/*!
+    Decodes the \a channels, sampled at \a sampleRate, with \a decoder and
+    returns the items. The decoder is deleted.
+*/
+QVector<DecoderItem> TestProtocolRoundTrip::decode(DecoderInterface* decoder,
+                                                   const QList< QVector<int> > &channels,
+                                                   int sampleRate)
+{
+    QVector<DigitalTransitions> transitions;
+    for (int i = 0; i < channels.size(); i++) {
+        transitions.append(DigitalTransitions(channels.at(i)));
+    }
+
+    QVector<const DigitalTransitions*> ptrs;
+    for (int i = 0; i < transitions.size(); i++) {
+        ptrs.append(&transitions.at(i));
+    }
+
+    DecoderSession session(decoder);
+    session.decodeTransitions(ptrs, sampleRate);
+    return session.items();
+}
+
+QString TestProtocolRoundTrip::hex(int value, int digits)
+{
+    return QString("%1").arg(value, digits, 16, QChar('0')).toUpper();
+}
+
+void TestProtocolRoundTrip::uart()
+{
+    const int samplesPerBit = 8;
+    const char* parities[] = {"None", "Odd", "Even", "Mark", "Space"};
+
+    qsrand(1);
+    for (int dataBits = 5; dataBits <= 8; dataBits++) {
+        for (int parity = 0; parity < Types::ParityNum; parity++) {
+            for (int stopBits = 1; stopBits <= 2; stopBits++) {
+
+                QByteArray data;
+                for (int i = 0; i < 64; i++) {
+                    data.append((char)(qrand() & 0xff));
+                }
+
+                UartGenerator gen;
+                gen.setBaudRate(9600);
+                gen.setDataBits(dataBits);
+                gen.setParity((Types::UartParity)parity);
+                gen.setStopBits(stopBits);
+                QVERIFY(gen.generate(data));
+
+                UartDecoder* decoder = new UartDecoder();
+                QVariantMap settings;
+                settings.insert("Baud rate", 9600);
+                settings.insert("Data bits", dataBits);
+                settings.insert("Parity", parities[parity]);
+                settings.insert("Stop bits", stopBits);
+                decoder->setSettings(settings);
+
+                QList< QVector<int> > channels;
+                channels << oversample(gen.uartData(), samplesPerBit);
+                QVector<DecoderItem> items = decode(decoder, channels,
+                                                    gen.sampleRate() * samplesPerBit);
+
+                QCOMPARE(items.size(), data.size());
+                for (int i = 0; i < data.size(); i++) {
+                    QCOMPARE(items.at(i).type, (int)UartDecoder::TYPE_DATA);
+                    QCOMPARE(items.at(i).value, data.at(i) & ((1 << dataBits) - 1));
+                    QCOMPARE(items.at(i).flags, 0);
+                }
+            }
+        }
+    }
+}
+
+void TestProtocolRoundTrip::spi()
+{
+    qsrand(2);
+    for (int mode = 0; mode < Types::SpiMode_Num; mode++) {
+        for (int enable = 0; enable < Types::SpiEnableNum; enable++) {
+
+            QVector<int> mosi;
+            QVector<int> miso;
+            QString script = "D04,E1,D02";
+            for (int i = 0; i < 32; i++) {
+                mosi.append(qrand() & 0xff);
+                miso.append(qrand() & 0xff);
+                script += QString(",X%1:%2").arg(hex(mosi.last(), 2)).arg(hex(miso.last(), 2));
+                if ((i % 8) == 7) {
+                    // a new transfer every 8 bytes
+                    script += ",D02,E0,D03,E1,D02";
+                }
+            }
+            script += ",D02,E0,D04";
+
+            SpiGenerator gen;
+            gen.setSpiRate(1000000);
+            gen.setDataBits(8);
+            gen.setSpiMode((Types::SpiMode)mode);
+            gen.setEnableMode((Types::SpiEnable)enable);
+            QVERIFY(gen.generateFromString(script));
+
+            SpiDecoder* decoder = new SpiDecoder();
+            QVariantMap settings;
+            settings.insert("Mode", mode);
+            settings.insert("Enable", (enable == Types::SpiEnableLow) ? "Low" : "High");
+            settings.insert("Data bits", 8);
+            decoder->setSettings(settings);
+
+            QList< QVector<int> > channels;
+            channels << oversample(gen.sckData(), 4)
+                     << oversample(gen.mosiData(), 4)
+                     << oversample(gen.misoData(), 4)
+                     << oversample(gen.enableData(), 4);
+            QVector<DecoderItem> items = decode(decoder, channels, gen.sampleRate() * 4);
+
+            QCOMPARE(items.size(), 2 * mosi.size());
+            for (int i = 0; i < mosi.size(); i++) {
+                QCOMPARE(items.at(2*i).type, (int)SpiDecoder::TYPE_MOSI);
+                QCOMPARE(items.at(2*i).value, mosi.at(i));
+                QCOMPARE(items.at(2*i + 1).type, (int)SpiDecoder::TYPE_MISO);
+                QCOMPARE(items.at(2*i + 1).value, miso.at(i));
+            }
+        }
+    }
+}
+
+void TestProtocolRoundTrip::i2c()
+{
+    qsrand(3);
+
+    QVector<int> expectedTypes;
+    QVector<int> expectedValues;
+    QString script = "D04";
+    bool inTransfer = false;
+    for (int t = 0; t < 16; t++) {
+        int address = qrand() & 0x7f;
+        bool read = (qrand() & 1) != 0;
+        script += QString(",S,%1%2,A").arg(read ? "R" : "W").arg(hex(address, 3));
+        expectedTypes << (inTransfer ? I2CDecoder::TYPE_REPEATED_START : I2CDecoder::TYPE_START)
+                      << (read ? I2CDecoder::TYPE_ADDRESS_READ : I2CDecoder::TYPE_ADDRESS_WRITE)
+                      << I2CDecoder::TYPE_ACK;
+        expectedValues << 0 << address << address;
+        inTransfer = true;
+
+        int numBytes = 1 + (qrand() % 4);
+        for (int i = 0; i < numBytes; i++) {
+            int value = qrand() & 0xff;
+            bool last = (i == numBytes - 1);
+            script += QString(",X%1,%2").arg(hex(value, 2)).arg(last ? "N" : "A");
+            expectedTypes << I2CDecoder::TYPE_DATA
+                          << (last ? I2CDecoder::TYPE_NACK : I2CDecoder::TYPE_ACK);
+            expectedValues << value << address;
+        }
+
+        // every other transfer continues with a repeated start
+        if ((t % 2) == 1) {
+            script += ",P,D04";
+            expectedTypes << I2CDecoder::TYPE_STOP;
+            expectedValues << 0;
+            inTransfer = false;
+        }
+    }
+
+    I2CGenerator gen;
+    gen.setAddressType(Types::I2CAddress_7bit);
+    gen.setI2CRate(100000);
+    QVERIFY(gen.generateFromString(script));
+
+    QList< QVector<int> > channels;
+    channels << oversample(gen.sclData(), 4)
+             << oversample(gen.sdaData(), 4);
+    QVector<DecoderItem> items = decode(new I2CDecoder(), channels, gen.sampleRate() * 4);
+
+    QCOMPARE(items.size(), expectedTypes.size());
+    for (int i = 0; i < items.size(); i++) {
+        QCOMPARE(items.at(i).type, expectedTypes.at(i));
+        if (expectedTypes.at(i) != I2CDecoder::TYPE_START
+                && expectedTypes.at(i) != I2CDecoder::TYPE_REPEATED_START
+                && expectedTypes.at(i) != I2CDecoder::TYPE_STOP) {
+            QCOMPARE(items.at(i).value, expectedValues.at(i));
+        }
+    }
+}
+
+/*!
+    The packed words, the blocks and the encoded pattern must all hold the
+    same states as the ones appended.
+*/
+void TestProtocolRoundTrip::packedPattern()
+{
+    qsrand(4);
+
+    PackedPattern pattern(3);
+    QVector<quint32> levels;
+    for (int i = 0; i < 2000; i++) {
+        quint32 l = qrand() & 7;
+        int count = 1 + (qrand() % 70);
+        pattern.append(l, count);
+        for (int j = 0; j < count; j++) {
+            levels.append(l);
+        }
+    }
+
+    QCOMPARE(pattern.numStates(), levels.size());
+    for (int ch = 0; ch < 3; ch++) {
+        QVector<int> states = pattern.states(ch);
+        QCOMPARE(states.size(), levels.size());
+        for (int i = 0; i < levels.size(); i++) {
+            QCOMPARE(states.at(i), (int)((levels.at(i) >> ch) & 1));
+            QCOMPARE(pattern.level(ch, i), states.at(i));
+        }
+    }
+
+    QVector<quint32> blocks = pattern.blocks();
+    QVector<quint32> encoded(blocks.size() + 16);
+    quint32 used = pattern.encode(encoded.data(), encoded.size());
+    QVERIFY(used > 0);
+
+    int numBlocks = blocks.size() / 3;
+    QCOMPARE(gen_pattern_Validate(encoded.constData(), used, 3), (quint32)numBlocks);
+
+    QVector<quint32> expanded(blocks.size());
+    QCOMPARE(gen_pattern_Expand(encoded.constData(), used, 3, expanded.data(), numBlocks),
+             (quint32)numBlocks);
+    QCOMPARE(expanded, blocks);
+}
+
+QTEST_APPLESS_MAIN(TestProtocolRoundTrip)
+
+#include "tst_protocolroundtrip.moc"
@@ -71,18 +71,22 @@ extern volatile uint8_t capture_PrefillComplete__;
 void capture_Init(void);
 
 cmd_status_t capture_Configure(uint8_t* cfg, uint32_t size);
+cmd_status_t capture_UpdateAnalogConfig(const uint8_t* cfg, uint32_t size);
 cmd_status_t capture_Arm(void);
+cmd_status_t capture_Rearm(void);
 cmd_status_t capture_Disarm(void);
 cmd_status_t capture_ConfigureForCalibration(int voltsPerDiv);
 
 uint16_t capture_GetVadcMatchValue(void);
 uint32_t capture_GetFadc(void);
 uint32_t capture_GetSampleRate(void);
+void capture_GetDepth(uint32_t* sgpioDepth, uint32_t* vadcDepth);
+uint32_t capture_Peek(uint8_t* pDest, uint32_t maxSize);
 
-void capture_ReportSGPIODone(circbuff_t* buff, uint32_t trigpoint, uint32_t triggerSample, uint32_t activeChannels);
+void capture_ReportSGPIODone(circbuff_t* buff, uint32_t trigpoint, uint32_t triggerSample, uint32_t exactTrigger, uint32_t activeChannels);
 void capture_ReportSGPIOSamplingFailed(cmd_status_t error);
 
-void capture_ReportVADCDone(circbuff_t* buff, uint32_t trigpoint, uint32_t triggerSample, uint32_t activeChannels);
+void capture_ReportVADCDone(circbuff_t* buff, uint32_t trigpoint, uint32_t triggerSample, uint32_t exactTrigger, uint32_t activeChannels);
 void capture_ReportVADCSamplingFailed(cmd_status_t error);
 
 #endif /* end __CAPTURE_H */
@@ -0,0 +1,80 @@
+/*!
+ * @file
+ * @brief     Partitioning of the sample memory between digital and analog capture
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __CAPTURE_BUFFERS_H
+#define __CAPTURE_BUFFERS_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Size in bytes of the memory shared by the digital and analog buffers */
+#define CAPTURE_BUFFERS_MEMORY_SIZE  0x10000
+
+/*! Number of LLIs that the VADC DMA divides its buffer into */
+#define CAPTURE_BUFFERS_VADC_NUM_LLI  21
+
+/*! Size in bytes of the VADC FIFO as used by the DMA */
+#define CAPTURE_BUFFERS_VADC_FIFO_SIZE  8
+
+/*! An analog buffer that shares the memory with a digital buffer is always
+ *  a multiple of this size so that all of the VADC DMA's LLIs are the same
+ *  size and an even multiple of the FIFO size. */
+#define CAPTURE_BUFFERS_VADC_GRANULE  (CAPTURE_BUFFERS_VADC_NUM_LLI * CAPTURE_BUFFERS_VADC_FIFO_SIZE)
+
+/*! @brief Placement of the capture buffers in the sample memory.
+ *
+ * The digital buffer always starts at the beginning of the memory and the
+ * analog buffer always ends at the end of the memory. Any unused memory is
+ * between the two buffers.
+ */
+typedef struct
+{
+  uint32_t sgpioSize;   /*!< Size in bytes of the digital buffer, 0 if not used */
+  uint32_t vadcOffset;  /*!< Offset from start of memory to the analog buffer */
+  uint32_t vadcSize;    /*!< Size in bytes of the analog buffer, 0 if not used */
+  uint32_t sgpioDepth;  /*!< Number of samples per digital signal */
+  uint32_t vadcDepth;   /*!< Number of samples per analog signal */
+} capture_buffers_t;
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void capture_buffers_SgpioUnit(uint32_t enabledChannels, uint32_t* unitSize, uint32_t* samplesPerUnit);
+uint32_t capture_buffers_Partition(uint32_t enabledSgpioChannels, uint32_t numVADC,
+                                   uint32_t memorySize, capture_buffers_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __CAPTURE_BUFFERS_H */
+
@@ -0,0 +1,94 @@
+/*!
+ * @file
+ * @brief     Pattern and sequence triggers for digital signals
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __CAPTURE_PATTERN_H
+#define __CAPTURE_PATTERN_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+/* This file is shared with the client software so it must only depend on
+   the standard C library. */
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Maximum number of stages in a sequence */
+#define CAPTURE_PATTERN_MAX_STAGES   2
+
+/*! Number of digital signals that a pattern can include */
+#define CAPTURE_PATTERN_MAX_SIGNALS  11
+
+/*! Returned when no trigger could be found */
+#define CAPTURE_PATTERN_NOT_FOUND    0xffffffff
+
+/*! Set in a stage's configuration when the stage is used */
+#define CAPTURE_PATTERN_ENABLED      (1UL << 31)
+
+/*! Creates the configuration for one stage. The signals in \a __care must
+ *  have the levels in \a __value, all other signals are "don't care". */
+#define CAPTURE_PATTERN_STAGE(__care, __value) \
+  (CAPTURE_PATTERN_ENABLED | ((((uint32_t)(__value)) & 0x7ff) << 16) | (((uint32_t)(__care)) & 0x7ff))
+
+/*! Extracts the signals that must match from a stage's configuration */
+#define CAPTURE_PATTERN_CARE(__cfg)   ((__cfg) & 0x7ff)
+
+/*! Extracts the wanted levels from a stage's configuration */
+#define CAPTURE_PATTERN_VALUE(__cfg)  (((__cfg) >> 16) & 0x7ff)
+
+/*! @brief State when searching for a pattern or sequence trigger.
+ *
+ * A stage is found on the sample where its pattern starts to match, i.e.
+ * where the previous sample did not match. A pattern that already matches
+ * when the search starts must go away before it can be found. With two
+ * stages the second one must be found after the first one.
+ */
+typedef struct
+{
+  uint32_t care[CAPTURE_PATTERN_MAX_STAGES];   /*!< Signals that must match, per stage */
+  uint32_t value[CAPTURE_PATTERN_MAX_STAGES];  /*!< Wanted levels, per stage */
+  uint32_t numStages;                          /*!< Number of stages, 0 if not used */
+  uint32_t stage;                              /*!< The stage being searched for */
+  uint32_t last[CAPTURE_PATTERN_MAX_STAGES];   /*!< 1 if the last searched sample matched, per stage */
+} capture_pattern_t;
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+int capture_pattern_Init(capture_pattern_t* pPattern, const uint32_t* stages, uint32_t enabledSignals);
+void capture_pattern_Reset(capture_pattern_t* pPattern);
+uint32_t capture_pattern_Signals(const capture_pattern_t* pPattern);
+int capture_pattern_Step(capture_pattern_t* pPattern, const uint32_t* words);
+uint32_t capture_pattern_Reference(const capture_pattern_t* pPattern,
+                                   const uint32_t* levels, uint32_t numSamples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __CAPTURE_PATTERN_H */
@@ -0,0 +1,87 @@
+/*!
+ * @file
+ * @brief     Decimated preview of an ongoing capture
+ *
+ * The client software uses \ref capture_peek_header_t from this file (and
+ * through it capture_trigger.h), so neither may include the LPC43xx headers.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __CAPTURE_PEEK_H
+#define __CAPTURE_PEEK_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <stdint.h>
+#include "capture_trigger.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Maximum number of samples per signal in a preview, a multiple of 32 */
+#define CAPTURE_PEEK_SAMPLES          64
+
+/*! Largest number of 32-bit words that the SGPIO stores for each 32 samples */
+#define CAPTURE_PEEK_MAX_DIGITAL_WORDS  16
+
+/*! Maximum number of bytes of digital samples in a preview */
+#define CAPTURE_PEEK_MAX_DIGITAL_SIZE ((CAPTURE_PEEK_SAMPLES / 32) * CAPTURE_PEEK_MAX_DIGITAL_WORDS * 4)
+
+/*! Maximum number of bytes of analog samples in a preview (two channels) */
+#define CAPTURE_PEEK_MAX_ANALOG_SIZE  (CAPTURE_PEEK_SAMPLES * 2 * 2)
+
+/*! @brief Header of a preview.
+ *
+ * The header is followed by \a digitalSize bytes of digital samples and
+ * \a analogSize bytes of analog samples, in the same format as the
+ * samples of a completed capture. Only every \a step sample is included
+ * and the last one is the most recently captured.
+ */
+typedef struct
+{
+  uint32_t step;               /*!< Captured samples per preview sample, 0 if there is no ongoing capture */
+  uint32_t digitalChannelInfo; /*!< Number of digital signals in the data (16 MSB) and the signals with data (16 LSB) */
+  uint32_t digitalSize;        /*!< Bytes of digital samples */
+  uint32_t analogChannelInfo;  /*!< Number of analog channels (16 MSB) and the channels with data (16 LSB) */
+  uint32_t analogSize;         /*!< Bytes of analog samples */
+} capture_peek_header_t;
+
+/*! Maximum size of a preview including the header, must fit in a control transfer */
+#define CAPTURE_PEEK_MAX_SIZE  (sizeof(capture_peek_header_t) + CAPTURE_PEEK_MAX_DIGITAL_SIZE + CAPTURE_PEEK_MAX_ANALOG_SIZE)
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+uint32_t capture_peek_Digital(const capture_trigger_buffer_t* buff, uint32_t wordsPerGroup,
+                              uint32_t unitWords, const uint8_t* order,
+                              uint32_t step, uint32_t* pDest, uint32_t maxSize);
+uint32_t capture_peek_Analog(const capture_trigger_buffer_t* buff, uint32_t numChannels,
+                             uint32_t step, uint16_t* pDest, uint32_t maxSize);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __CAPTURE_PEEK_H */
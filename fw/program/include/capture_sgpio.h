@@ -28,6 +28,7 @@
 #include "lpc_types.h"
 #include "circbuff.h"
 #include "capture.h"
+#include "capture_pattern.h"
 
 /******************************************************************************
  * Typedefs and defines
@@ -105,6 +106,24 @@ typedef struct
    *  22-31 | Reserved
    */
   uint32_t triggerSetup;
+
+  /*! @brief Pattern and sequence trigger (see \ref capture_pattern.c).
+   *
+   * One word per stage, each encoded with \ref CAPTURE_PATTERN_STAGE. With
+   * only the first stage enabled it is a pattern trigger and with both it
+   * is a sequence trigger. Cannot be combined with \a enabledTriggers.
+   *
+   * Bit assignment:
+   *
+   *  Bits  | Description
+   *  :---: | -----------
+   *   0-10 | Signals that must match (DIO_0 to DIO_CLK)
+   *  11-15 | Reserved
+   *  16-26 | Wanted level for each signal that must match
+   *  27-30 | Reserved
+   *   31   | 1 = stage is used
+   */
+  uint32_t triggerPattern[CAPTURE_PATTERN_MAX_STAGES];
 } cap_sgpio_cfg_t;
 
 /******************************************************************************
@@ -121,6 +140,8 @@ cmd_status_t cap_sgpio_PrepareToArm(void);
 void cap_sgpio_Arm(void);
 cmd_status_t cap_sgpio_Disarm(void);
 void cap_sgpio_Triggered(void);
+Bool cap_sgpio_IsWaitingForTrigger(void);
+uint32_t cap_sgpio_Peek(uint32_t step, uint32_t* pDest, uint32_t maxSize, uint32_t* pChannelInfo);
 
 #endif /* end __CAPTURE_SGPIO_H */
 
@@ -0,0 +1,75 @@
+/*!
+ * @file
+ * @brief     DMA transfers of captured digital samples
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __CAPTURE_SGPIO_DMA_H
+#define __CAPTURE_SGPIO_DMA_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Number of 32-bit words (one per slice) that the DMA copies for each exchange */
+#define CAPTURE_SGPIO_DMA_UNIT_WORDS  16
+
+/*! Size in bytes of what the DMA copies for each exchange */
+#define CAPTURE_SGPIO_DMA_UNIT_SIZE   (CAPTURE_SGPIO_DMA_UNIT_WORDS * 4)
+
+/*! @brief A linked list item for the GPDMA.
+ *
+ * Same layout as GPDMA_LLI_Type so that it can be handed to the GPDMA.
+ */
+typedef struct
+{
+  uint32_t srcAddr;  /*!< Source address */
+  uint32_t dstAddr;  /*!< Destination address */
+  uint32_t nextLLI;  /*!< Address of the next LLI, 0 for the last one */
+  uint32_t control;  /*!< Value for the channel's control register */
+} capture_sgpio_dma_lli_t;
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+uint32_t capture_sgpio_dma_BuildRing(capture_sgpio_dma_lli_t* lli, uint32_t maxLLIs,
+                                     uint32_t srcAddr, uint32_t dstAddr,
+                                     uint32_t bufferSize, uint32_t control);
+uint32_t capture_sgpio_dma_BuildGather(capture_sgpio_dma_lli_t* lli, uint32_t maxLLIs,
+                                       uint32_t regAddr, const uint8_t* order,
+                                       uint32_t numSlices, uint32_t stagingAddr,
+                                       uint32_t control);
+int capture_sgpio_dma_PostFill(uint32_t sampleLimit, uint32_t postFill, uint32_t* pPostFill);
+uint32_t capture_sgpio_dma_Reorder(uint32_t* data, uint32_t numUnits,
+                                   const uint8_t* order, uint32_t numOut);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __CAPTURE_SGPIO_DMA_H */
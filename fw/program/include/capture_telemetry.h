@@ -0,0 +1,93 @@
+/*!
+ * @file
+ * @brief     Per capture telemetry sent to the client with the samples
+ *
+ * The client software includes this file to parse the block, so it has no
+ * dependencies on the LPC43xx headers.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __CAPTURE_TELEMETRY_H
+#define __CAPTURE_TELEMETRY_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Number of analog channels that statistics are kept for */
+#define CAPTURE_TELEMETRY_CHANNELS   2
+
+/*! Number of histogram bins for each analog channel, each covering 256 of the 4096 possible values */
+#define CAPTURE_TELEMETRY_HIST_BINS  16
+
+/*! Used for the trigger latency when the exact trigger sample was not found */
+#define CAPTURE_TELEMETRY_NO_LATENCY ((int32_t)0x80000000)
+
+/*! @brief Statistics for one analog channel.
+ *
+ * The values are the raw 12-bit values from the VADC.
+ */
+typedef struct
+{
+  uint32_t numSamples;                        /*!< Number of samples */
+  uint32_t min;                               /*!< Lowest value, only valid if numSamples > 0 */
+  uint32_t max;                               /*!< Highest value, only valid if numSamples > 0 */
+  uint32_t sum;                               /*!< Sum of all values */
+  uint32_t hist[CAPTURE_TELEMETRY_HIST_BINS]; /*!< Number of values in each 256 wide range */
+} capture_telemetry_channel_t;
+
+/*! @brief Telemetry for one capture.
+ *
+ * Sent as a block of 32-bit words in the header of the captured samples,
+ * see \ref LabTool_SendSamples.
+ */
+typedef struct
+{
+  uint32_t skippedSamples;     /*!< Number of times two analog samples in a row were from the same channel */
+  uint32_t emptySamples;       /*!< Number of analog samples with the empty marker set */
+  int32_t  digitalTrigLatency; /*!< Exact digital trigger sample minus the reported one */
+  int32_t  analogTrigLatency;  /*!< Exact analog trigger sample minus the reported one */
+  uint32_t readoutTime;        /*!< Microseconds it took to send the previous capture, 0 if unknown */
+  uint32_t analogUpdates;      /*!< Number of analog settings updates applied when the capture was armed */
+  capture_telemetry_channel_t ch[CAPTURE_TELEMETRY_CHANNELS]; /*!< Statistics for each analog channel */
+} capture_telemetry_t;
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void capture_telemetry_Init(capture_telemetry_t* t);
+void capture_telemetry_AddAnalog(capture_telemetry_t* t, uint32_t numChannels,
+                                 const uint16_t* first, uint32_t firstCount,
+                                 const uint16_t* second, uint32_t secondCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __CAPTURE_TELEMETRY_H */
+
@@ -0,0 +1,71 @@
+/*!
+ * @file
+ * @brief     Locating the exact trigger sample in captured data
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __CAPTURE_TRIGGER_H
+#define __CAPTURE_TRIGGER_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Returned when the trigger could not be located */
+#define CAPTURE_TRIGGER_UNKNOWN  0xffffffff
+
+/*! @brief A straightened-out view of a filled circular capture buffer.
+ *
+ * Logical byte \a n of the captured data is found at
+ * data[(first + n) % size] and there are \a used bytes in total.
+ */
+typedef struct
+{
+  const uint8_t* data;  /*!< Start of the circular buffer */
+  uint32_t       size;  /*!< Size of the circular buffer in bytes */
+  uint32_t       first; /*!< Offset to the oldest byte */
+  uint32_t       used;  /*!< Number of captured bytes */
+} capture_trigger_buffer_t;
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+uint32_t capture_trigger_FindDigitalEdge(const capture_trigger_buffer_t* buff,
+                                         uint32_t wordsPerGroup, uint32_t channel, int rising,
+                                         uint32_t estimate, uint32_t before, uint32_t after);
+uint32_t capture_trigger_FindAnalogCrossing(const capture_trigger_buffer_t* buff,
+                                            uint32_t numChannels, uint32_t channel,
+                                            uint32_t level, int rising,
+                                            uint32_t estimate, uint32_t before, uint32_t after);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __CAPTURE_TRIGGER_H */
+
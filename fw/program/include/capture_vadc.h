@@ -127,10 +127,13 @@ typedef struct
 
 void cap_vadc_Init(void);
 cmd_status_t cap_vadc_Configure(circbuff_t* buff, cap_vadc_cfg_t* cfg, uint32_t postFill, Bool forceTrigger);
+cmd_status_t cap_vadc_Update(const cap_vadc_cfg_t* cfg);
 cmd_status_t cap_vadc_PrepareToArm(void);
 void cap_vadc_Arm(void);
 cmd_status_t cap_vadc_Disarm(void);
 void cap_vadc_Triggered(void);
+Bool cap_vadc_IsWaitingForTrigger(void);
+uint32_t cap_vadc_Peek(uint32_t step, uint16_t* pDest, uint32_t maxSize, uint32_t* pChannelInfo);
 
 uint32_t cap_vadc_GetMilliVoltsPerDiv(int ch);
 
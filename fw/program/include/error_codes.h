@@ -50,6 +50,8 @@ typedef enum
   CMD_STATUS_ERR_NOISE_REDUCTION_LEVEL_TOO_HIGH,
   CMD_STATUS_ERR_CFG_NO_CHANNELS_ENABLED,
   CMD_STATUS_ERR_CFG_INVALID_SIGNAL_COMBINATION,
+  CMD_STATUS_ERR_INVALID_TRIGGER_PATTERN,
+  CMD_STATUS_ERR_SAMPLES_LOST,
 
   /* Related to Signal Generation */
   CMD_STATUS_ERR_NOTHING_TO_GENERATE = 25,
@@ -58,11 +60,13 @@ typedef enum
   CMD_STATUS_ERR_GEN_INVALID_RUN_COUNTER,
   CMD_STATUS_ERR_GEN_INVALID_NUMBER_OF_STATES,
   CMD_STATUS_ERR_GEN_INVALID_AMPLITUDE,
+  CMD_STATUS_ERR_GEN_INVALID_PATTERN,
 
   /* Related to I2C monitoring */
   CMD_STATUS_ERR_MON_I2C_PCA95555_FAILED = 40,
   CMD_STATUS_ERR_MON_I2C_INVALID_RATE,
   CMD_STATUS_ERR_MON_I2C_NOT_CONFIGURED,
+  CMD_STATUS_ERR_MON_I2C_INVALID_CONFIG,
 
   /* Related to calibration of analog signals */
   CMD_STATUS_ERR_CAL_AOUT_INVALID_PARAMS = 50,
@@ -0,0 +1,105 @@
+/*!
+ * @file
+ * @brief     Encoding and expansion of compressed digital generator patterns
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __GEN_PATTERN_H
+#define __GEN_PATTERN_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+/* This file is shared with the client software so it must only depend on
+   the standard C library. */
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Maximum number of channels (words) in one block */
+#define GEN_PATTERN_MAX_CHANNELS  11
+
+/*! Number of states in one block, one 32-bit word per channel */
+#define GEN_PATTERN_STATES_PER_BLOCK  32
+
+/*! Record with \a count blocks of data following the record header */
+#define GEN_PATTERN_OP_LITERAL  0x01
+
+/*! Record with one block of data that is output \a count times */
+#define GEN_PATTERN_OP_REPEAT   0x02
+
+/*! Record followed by one word with the number of words in the group and
+ *  then the group itself (literal and repeat records only). The group is
+ *  output \a count times. Groups cannot be nested.
+ */
+#define GEN_PATTERN_OP_GROUP    0x03
+
+/*! Largest \a count that fits in a record header */
+#define GEN_PATTERN_MAX_COUNT   0x00ffffff
+
+/*! Creates a record header */
+#define GEN_PATTERN_RECORD(__op, __count)  ((((uint32_t)(__op)) << 24) | ((__count) & GEN_PATTERN_MAX_COUNT))
+
+/*! Extracts the operation from a record header */
+#define GEN_PATTERN_OP(__hdr)     ((__hdr) >> 24)
+
+/*! Extracts the count from a record header */
+#define GEN_PATTERN_COUNT(__hdr)  ((__hdr) & GEN_PATTERN_MAX_COUNT)
+
+/*! @brief State when expanding an encoded pattern one block at a time.
+ *
+ * A block holds 32 states for each enabled channel, one word per channel
+ * with the first state in the least significant bit. The channels are in
+ * ascending order, i.e. the first word is for the lowest enabled channel.
+ */
+typedef struct
+{
+  const uint32_t* data;       /*!< The encoded pattern */
+  uint32_t        numWords;   /*!< Size of the encoded pattern in words */
+  uint32_t        blockSize;  /*!< Words per block (number of enabled channels) */
+  uint32_t        pos;        /*!< Word index of the next record header */
+  uint32_t        block;      /*!< Word index of the next block to output */
+  uint32_t        left;       /*!< Blocks left to output in the current record */
+  uint32_t        repeat;     /*!< Non-zero if the current record is a repeat record */
+  uint32_t        groupStart; /*!< Word index of the first record in the current group */
+  uint32_t        groupEnd;   /*!< Word index after the current group, 0 if not in a group */
+  uint32_t        groupLeft;  /*!< Number of times left to output the current group */
+} gen_pattern_cursor_t;
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+uint32_t gen_pattern_Validate(const uint32_t* data, uint32_t numWords, uint32_t blockSize);
+void gen_pattern_Start(gen_pattern_cursor_t* cursor, const uint32_t* data, uint32_t numWords, uint32_t blockSize);
+int gen_pattern_NextBlock(gen_pattern_cursor_t* cursor, uint32_t* pBlock);
+uint32_t gen_pattern_Expand(const uint32_t* data, uint32_t numWords, uint32_t blockSize, uint32_t* pBlocks, uint32_t maxBlocks);
+uint32_t gen_pattern_Encode(const uint32_t* pBlocks, uint32_t numBlocks, uint32_t blockSize, uint32_t* data, uint32_t maxWords);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __GEN_PATTERN_H */
+
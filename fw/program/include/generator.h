@@ -42,6 +42,8 @@
 
 void generator_Init(void);
 cmd_status_t generator_Configure(uint8_t* cfg, uint32_t size);
+cmd_status_t generator_PreparePattern(uint32_t size, uint8_t** ppBuff);
+cmd_status_t generator_PrepareAnalogLUT(uint32_t size, uint8_t** ppBuff);
 cmd_status_t generator_Start(void);
 cmd_status_t generator_Stop(void);
 
@@ -41,8 +41,12 @@
 #define GEN_DAC_CFG_WAVE_SAWTOOTH      3
 #define GEN_DAC_CFG_WAVE_INV_SAWTOOTH  4
 #define GEN_DAC_CFG_WAVE_LEVEL         5
+#define GEN_DAC_CFG_WAVE_ARBITRARY     6
 /* \} */
 
+/*! Size of lookup table for waveform data */
+#define GEN_DAC_MAX_LUT_SIZE  2000
+
 /*! @brief Configuration of one analog signal to generate.
  */
 typedef struct
@@ -57,11 +61,13 @@ typedef struct
    *   3   | Sawtooth
    *   4   | Reverse (or inverse) Sawtooth
    *   5   | Level (outputs DC offset, ignores amplitude)
+   *   6   | Arbitrary (lookup table uploaded by client, see \ref gen_dac_LUTBuffer)
    */
   uint32_t waveform;
   uint32_t frequency; /*!< Frequency in Hz */
   uint32_t amplitude; /*!< Amplitude in mV, 0..5000 */
   int32_t  dcOffset;  /*!< DC offset in mV, -5000..5000 */
+  uint32_t lutSize;   /*!< Entries in the uploaded lookup table, only for arbitrary waveform */
 } gen_dac_one_ch_cfg_t;
 
 /*! @brief Configuration of the analog signal(s) to generate.
@@ -84,6 +90,7 @@ void gen_dac_Init(void);
 cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg);
 cmd_status_t gen_dac_Start(void);
 void gen_dac_Stop(void);
+uint8_t* gen_dac_LUTBuffer(uint32_t size);
 
 #endif /* end __GENERATOR_DAC_H */
 
@@ -39,10 +39,16 @@ typedef struct
 {
   uint32_t enabledChannels; /*!< using bits 0-10, a 1 means enabled */
   uint32_t frequency;       /*!< Frequency of generated signal */
-  uint32_t numStates;       /*!< Bits per channel 1..256 */
+  uint32_t numStates;       /*!< Bits per channel 1..256, or total number of states if encoded */
+  uint32_t encodedSize;     /*!< 0 to use \a patterns, otherwise size in bytes of the encoded pattern */
   uint32_t patterns[8][11];  /*!< Up to 8*32 states for up to 11 channels */
 } gen_sgpio_cfg_t;
 
+/*! Maximum size in bytes of an encoded pattern
+ * @see gen_pattern.h
+ */
+#define GEN_SGPIO_MAX_ENCODED_SIZE  0xfffc
+
 /******************************************************************************
  * Global Variables
  *****************************************************************************/
@@ -52,9 +58,15 @@ typedef struct
  *****************************************************************************/
 
 void gen_sgpio_Init(void);
+uint8_t* gen_sgpio_PatternBuffer(uint32_t size);
 cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, uint32_t shiftClockPreset, uint32_t runCounter);
 cmd_status_t gen_sgpio_Start(void);
 void gen_sgpio_Stop(void);
 
+Bool gen_sgpio_IsStreaming(void);
+uint32_t gen_sgpio_StreamSpace(void);
+void gen_sgpio_StreamPut(const uint8_t* pData, uint32_t numWords);
+void gen_sgpio_StreamStatus(uint32_t* pBlocks, uint32_t* pUnderruns);
+
 #endif /* end __GENERATOR_SGPIO_H */
 
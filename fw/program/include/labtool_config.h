@@ -65,25 +65,6 @@
  */
 #define TEST_I2C_MONITOR             OPT_DISABLED
 
-/*! @brief Debug aid.
- * Prints histogram information about the enabled analog channels before
- * sending the data to the client.
- */
-#define PRINT_ANALOG_HISTOGRAM       OPT_DISABLED
-
-/*! @brief Debug aid.
- * Prints min/max/avg statistics for each channel before sending the data
- * to the client.
- */
-#define PRINT_STATISTICS             OPT_DISABLED
-
-/*! @brief Debug aid.
- * When sampling both channels it is expected that the number of samples from
- * each channel is the same. Before data containing samples from both analog
- * channels is sent to the client it is search for "skipped samples".
- */
-#define FIND_SKIPPED_SAMPLES         OPT_DISABLED
-
 /*! @brief Debug aid.
  * As there is no USB uart available for printing, the project uses the Trace 
  * functionallity by remapping the UARTPutChar() function into ITM_SendChar()
@@ -27,7 +27,6 @@
 
 #include "lpc_types.h"
 #include "error_codes.h"
-#include "circbuff.h"
 
 /******************************************************************************
  * Typedefs and defines
@@ -37,9 +36,17 @@
 typedef struct
 {
   uint32_t clockrate;      /*!< 100000, 400000 or 1000000 */
-  uint32_t bytesToCapture; /*!< Each I2C byte is timestamped with 4 bytes */
+  uint32_t bytesToCapture; /*!< Number of I2C events to capture, 0 to capture until stopped */
 } monitor_i2c_cfg_t;
 
+/*! @brief One event captured from the I2C bus. */
+typedef struct
+{
+  uint32_t timestamp; /*!< timestamp in micro seconds */
+  uint32_t status;    /*!< I2C status register */
+  uint32_t data;      /*!< I2C data, only lowest 8 bits are used */
+} monitor_i2c_record_t;
+
 /******************************************************************************
  * Global Variables
  *****************************************************************************/
@@ -49,9 +56,15 @@ typedef struct
  *****************************************************************************/
 
 void monitor_i2c_Init(void);
-cmd_status_t monitor_i2c_Configure(circbuff_t* buff, monitor_i2c_cfg_t* cfg);
+cmd_status_t monitor_i2c_Configure(uint8_t* cfg, uint32_t size);
 cmd_status_t monitor_i2c_Start(void);
 cmd_status_t monitor_i2c_Stop(void);
+Bool monitor_i2c_IsRunning(void);
+uint32_t monitor_i2c_Pending(void);
+uint32_t monitor_i2c_OldestTime(void);
+uint32_t monitor_i2c_Read(monitor_i2c_record_t* pRecords, uint32_t maxRecords);
+uint32_t monitor_i2c_Lost(void);
+uint32_t monitor_i2c_GetTime(void);
 
 #if (TEST_I2C_MONITOR == OPT_ENABLED)
 void monitor_i2c_Test(void);
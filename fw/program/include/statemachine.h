@@ -42,6 +42,7 @@ typedef enum
   STATE_CAPTURING,   /*!< Capturing of analog and/or digital signals ongoing */
   STATE_GENERATING,  /*!< Generation of analog and/or digital signals ongoing */
   STATE_CALIBRATING, /*!< Calibration of analog in/out signals ongoing */
+  STATE_MONITORING,  /*!< Monitoring of I2C communication ongoing */
 } states_t;
 
 /******************************************************************************
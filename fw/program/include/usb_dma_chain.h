@@ -0,0 +1,75 @@
+/*!
+ * @file
+ * @brief     Splitting sample memory into USB DMA transfer descriptors
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __USB_DMA_CHAIN_H
+#define __USB_DMA_CHAIN_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Size of the pages that a transfer descriptor's buffer pointers point to */
+#define USB_DMA_CHAIN_PAGE_SIZE  0x1000
+
+/*! Number of buffer pointers (pages) in one transfer descriptor */
+#define USB_DMA_CHAIN_NUM_PAGES  5
+
+/*! @brief A block of memory to send. */
+typedef struct
+{
+  const uint8_t* data;    /*!< Start of the data */
+  uint32_t       length;  /*!< Number of bytes */
+} usb_dma_chain_segment_t;
+
+/*! @brief What one transfer descriptor in the chain should send.
+ *
+ * All entries except the last one are a whole number of packets so that
+ * the host sees one continuous transfer.
+ */
+typedef struct
+{
+  const uint8_t* data;    /*!< Start of the data, either in a segment or in the bounce buffer */
+  uint32_t       length;  /*!< Number of bytes */
+} usb_dma_chain_entry_t;
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+uint32_t usb_dma_chain_Build(const usb_dma_chain_segment_t* segments, uint32_t numSegments,
+                             uint32_t packetSize, uint8_t* bounce, uint32_t bounceSize,
+                             usb_dma_chain_entry_t* entries, uint32_t maxEntries);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end __USB_DMA_CHAIN_H */
+
@@ -42,10 +42,13 @@ typedef struct
   uint32_t trigpoint;           /*!< Possible trigger information */
   uint32_t sgpioTrigSample;     /*!< SGPIO sample when trigger was found */
   uint32_t vadcTrigSample;      /*!< VADC sample when trigger was found */
+  uint32_t sgpioTrigExact;      /*!< SGPIO sample with the triggering edge, see \ref capture_trigger_FindDigitalEdge */
+  uint32_t vadcTrigExact;       /*!< VADC sample with the trigger crossing, see \ref capture_trigger_FindAnalogCrossing */
   uint32_t sgpioActiveChannels; /*!< Which digital signals were enabled */
   uint32_t vadcActiveChannels;  /*!< Which analog signals were enabled */
   circbuff_t* sgpio_samples;    /*!< Collected digital samples or NULL */
   circbuff_t* vadc_samples;     /*!< Collected analog samples or NULL */
+  uint32_t analogUpdates;       /*!< Analog settings updates applied when the capture was armed */
 } captured_samples_t;
 
 
@@ -41,6 +41,9 @@
 #include "usb_handler.h"
 #include "statemachine.h"
 #include "sgpio_cfg.h"
+#include "capture_buffers.h"
+#include "capture_trigger.h"
+#include "capture_peek.h"
 
 /******************************************************************************
  * Typedefs and defines
@@ -52,6 +55,9 @@
 /*! Offset in the \ref RATECONFIG table to where the SGPIO only value start. */
 #define SGPIO_ONLY_OFFSET  25
 
+/*! Start of the memory used for captured samples */
+#define SAMPLE_MEMORY_START  0x20000000
+
 /*! @brief Configuration for one sample rate. Used in the \ref RATECONFIG table. */
 typedef struct
 {
@@ -86,18 +92,6 @@ typedef struct
   cap_vadc_cfg_t   vadc;   /*!< Configuration of analog signals */
 } capture_cfg_t;
 
-
-#define NUM_BUFFER_CONFIGURATIONS  (sizeof(BUFFERCONFIG)/sizeof(buffer_size_cfg_t))
-
-/*! @brief Configuration for one capture buffer setup. Used in \ref BUFFERCONFIG */
-typedef struct
-{
-  uint8_t  numVADC;         /*!< Number of enabled analog signals */
-  uint8_t  numDIO;          /*!< Number of enabled digital signals */
-  uint32_t buffEndSGPIO;    /*!< End of address space for digital signal */
-  uint32_t buffStartVADC;   /*!< Start of address space for analog signal */
-} buffer_size_cfg_t;
-
 /******************************************************************************
  * Global variables
  *****************************************************************************/
@@ -155,46 +149,6 @@ static const sample_rate_cfg_t RATECONFIG[] =
   {         0,    0,    0,   0,         0,             0 },
 };
 
-/*!
- * The table is based on the fact that the SGPIO capturing needs to copy all DIOx values
- * up to and including the highest enabled DIOx. Concatenation of SGPIO data introduces
- * further limitations.
- *
- * For analog signals only the enabled ones are copied.
- *
- * With only digital signals (or only analog signals) the entire buffer is used. This
- * table only deals with the case where a combination of analog and digital signals
- * is selected.
- */
-static const buffer_size_cfg_t BUFFERCONFIG[] =
-{
-// Analog    Digital     End of digital    Start of analog
-// Channels  Channels    buffer            buffer
-// --------  --------    --------------    ---------------
-  {   1,        1,         0x20001C00,       0x20002000 },
-  {   1,        2,         0x20001C00,       0x20002000 },
-  {   1,        3,         0x20003300,       0x20003400 },
-  {   1,        4,         0x20003300,       0x20003400 },
-  {   1,        5,         0x20005400,       0x20005800 },
-  {   1,        6,         0x20005400,       0x20005800 },
-  {   1,        7,         0x20005400,       0x20005800 },
-  {   1,        8,         0x20005400,       0x20005800 },
-  {   1,        9,         0x20005A00,       0x20006000 },
-  {   1,       10,         0x20006180,       0x20006400 },
-  {   1,       11,         0x200065C0,       0x20006C00 },
-  {   2,        1,         0x20000F00,       0x20001000 },
-  {   2,        2,         0x20000F00,       0x20001000 },
-  {   2,        3,         0x20001C00,       0x20002000 },
-  {   2,        4,         0x20001C00,       0x20002000 },
-  {   2,        5,         0x20003200,       0x20003800 },
-  {   2,        6,         0x20003200,       0x20003800 },
-  {   2,        7,         0x20003200,       0x20003800 },
-  {   2,        8,         0x20003200,       0x20003800 },
-  {   2,        9,         0x20003600,       0x20004000 },
-  {   2,       10,         0x20003C00,       0x20004000 },
-  {   2,       11,         0x20003F40,       0x20004800 },
-};
-
 static circbuff_t sampleBufferSGPIO;
 static circbuff_t sampleBufferVADC;
 static int        enabledSgpioChannels = 0;
@@ -202,8 +156,13 @@ static int        enabledVadcChannels = 0;
 
 static int currentSampleRateIdx = -1;
 
+static capture_buffers_t bufferPartition;
+
 static captured_samples_t capturedSamples;
 
+/*! Number of accepted \ref capture_UpdateAnalogConfig since the configuration */
+static uint32_t analogUpdates = 0;
+
 static capture_cfg_t calibrationSetup;
 
 /******************************************************************************
@@ -343,8 +302,8 @@ static cmd_status_t capture_SetSampleRate(uint32_t wantedRate, int numVADC)
  *
  * When a combination of analog and digital signals is selected then two separate
  * buffers will be created and the size of those buffers are adjusted so that
- * the same number of samples will fit in each buffer. The BUFFERCONFIG
- * table is used for this.
+ * as many samples as possible fit in both of them. The analog buffer is placed
+ * at the end of the address space. See \ref capture_buffers_Partition.
  *
  * @param [in] cap_cfg  Configuration from client
  *
@@ -354,51 +313,28 @@ static cmd_status_t capture_SetSampleRate(uint32_t wantedRate, int numVADC)
  *****************************************************************************/
 static cmd_status_t capture_ConfigureCaptureBuffers(const capture_cfg_t * const cap_cfg)
 {
-  if (cap_cfg->numEnabledVADC == 0)
+  uint32_t depth;
+
+  depth = capture_buffers_Partition((cap_cfg->numEnabledSGPIO > 0) ? cap_cfg->sgpio.enabledChannels : 0,
+                                    cap_cfg->numEnabledVADC,
+                                    CAPTURE_BUFFERS_MEMORY_SIZE,
+                                    &bufferPartition);
+  if (depth == 0)
   {
-    // Only digital capture
-    circbuff_Init(&sampleBufferSGPIO, 0x20000000, 0x10000);
+    return CMD_STATUS_ERR_CFG_INVALID_SIGNAL_COMBINATION;
   }
-  else if (cap_cfg->numEnabledSGPIO == 0)
+
+  if (bufferPartition.sgpioSize > 0)
   {
-    // Only analog capture
-    circbuff_Init(&sampleBufferVADC, 0x20000000, 0x10000);
+    circbuff_Init(&sampleBufferSGPIO, SAMPLE_MEMORY_START, bufferPartition.sgpioSize);
   }
-  else
+  if (bufferPartition.vadcSize > 0)
   {
-    int i;
-    int numDIO = -1;
-
-    // BUFFERCONFIG table is based on how many digital signals are copied and that
-    // is determined by the highest enabled DIOx. E.g. with DIO0 and DIO5 enabled
-    // 6 (DIO0..DIO5) signals will be copied even if only two of them are actually
-    // sampled
-    for (i = MAX_NUM_DIOS; i >= 0; i--)
-    {
-      if (cap_cfg->sgpio.enabledChannels & (1<<i))
-      {
-        // highest enabled is DIOi
-        numDIO = i + 1;
-        break;
-      }
-    }
-    for (i = 0; i < NUM_BUFFER_CONFIGURATIONS; i++)
-    {
-      if ((BUFFERCONFIG[i].numVADC == cap_cfg->numEnabledVADC) &&
-          (BUFFERCONFIG[i].numDIO == numDIO))
-      {
-        // When sampling both SGPIO and VADC at the same rate, VADC will
-        // need sixteen times the memory.
-        // It is important that VADC buffer ends at memory boundary 0x20010000
-        // so a unused zone is added between the buffers.
-        circbuff_Init(&sampleBufferSGPIO, 0x20000000, BUFFERCONFIG[i].buffEndSGPIO - 0x20000000);
-        circbuff_Init(&sampleBufferVADC,  BUFFERCONFIG[i].buffStartVADC, 0x20010000 - BUFFERCONFIG[i].buffStartVADC);
-        return CMD_STATUS_OK;
-      }
-    }
-    return CMD_STATUS_ERR_CFG_INVALID_SIGNAL_COMBINATION;
+    circbuff_Init(&sampleBufferVADC, SAMPLE_MEMORY_START + bufferPartition.vadcOffset, bufferPartition.vadcSize);
   }
 
+  log_i("Capture depth: %u digital, %u analog samples\r\n", bufferPartition.sgpioDepth, bufferPartition.vadcDepth);
+
   return CMD_STATUS_OK;
 }
 
@@ -432,6 +368,11 @@ static cmd_status_t capture_WeightedConfigCheck(const capture_cfg_t * const cap_
       // Only digital capture
 
       uint16_t tmp = cap_cfg->sgpio.enabledChannels & 0x7ff;
+
+      // a pattern trigger is searched for by the exchange interrupt so it
+      // has the same limits as the edge triggers
+      Bool triggers = ((cap_cfg->sgpio.enabledTriggers & 0x7ff) != 0) ||
+                      ((cap_cfg->sgpio.triggerPattern[0] & CAPTURE_PATTERN_ENABLED) != 0);
       if (tmp > 0x0ff)
       {
         if (cap_cfg->sampleRate > 20000000)
@@ -449,7 +390,7 @@ static cmd_status_t capture_WeightedConfigCheck(const capture_cfg_t * const cap_
           result = CMD_STATUS_ERR_CFG_INVALID_SIGNAL_COMBINATION;
           break;
         }
-        if ((cap_cfg->sampleRate > 40000000) && (cap_cfg->sgpio.enabledTriggers & 0x7ff))
+        if ((cap_cfg->sampleRate > 40000000) && triggers)
         {
           // limit the sample rate to 40MHz when sampling DIO0..DIO7 with triggers
           result = CMD_STATUS_ERR_CFG_INVALID_SIGNAL_COMBINATION;
@@ -458,7 +399,7 @@ static cmd_status_t capture_WeightedConfigCheck(const capture_cfg_t * const cap_
       }
       else if (tmp > 0x003)
       {
-        if ((cap_cfg->sampleRate > 80000000) && (cap_cfg->sgpio.enabledTriggers & 0x7ff))
+        if ((cap_cfg->sampleRate > 80000000) && triggers)
         {
           // limit the sample rate to 80MHz when sampling DIO0..DIO3 with triggers
           result = CMD_STATUS_ERR_CFG_INVALID_SIGNAL_COMBINATION;
@@ -522,12 +463,15 @@ void capture_Init(void)
   LED_ARM_OFF();
   LED_TRIG_OFF();
 
-  circbuff_Init(&sampleBufferSGPIO, 0x20000000, 0x10000);
-  circbuff_Init(&sampleBufferVADC, 0x20000000, 0x10000);
+  circbuff_Init(&sampleBufferSGPIO, SAMPLE_MEMORY_START, CAPTURE_BUFFERS_MEMORY_SIZE);
+  circbuff_Init(&sampleBufferVADC, SAMPLE_MEMORY_START, CAPTURE_BUFFERS_MEMORY_SIZE);
+  memset(&bufferPartition, 0, sizeof(capture_buffers_t));
 
   capture_SetInitialSampleRate();
 
   memset(&capturedSamples, 0, sizeof(captured_samples_t));
+  capturedSamples.sgpioTrigExact = CAPTURE_TRIGGER_UNKNOWN;
+  capturedSamples.vadcTrigExact = CAPTURE_TRIGGER_UNKNOWN;
 
   /*! @todo Move the controls for the DIO direction to a central place as it will prevent any signal generation */
   LPC_GPIO_PORT->CLR[1] |= (1UL <<  8);
@@ -571,6 +515,7 @@ cmd_status_t capture_Configure(uint8_t* cfg, uint32_t size)
   // if neither a digital nor a analog signal has been selected as trigger then
   // enter forced trigger mode (i.e. capture as much as the buffer can hold)
   if (((cap_cfg->numEnabledSGPIO > 0) && (cap_cfg->sgpio.enabledTriggers > 0)) ||
+      ((cap_cfg->numEnabledSGPIO > 0) && (cap_cfg->sgpio.triggerPattern[0] & CAPTURE_PATTERN_ENABLED)) ||
       ((cap_cfg->numEnabledVADC > 0) && (cap_cfg->vadc.enabledTriggers > 0)))
   {
     forcedTrigger = FALSE;
@@ -623,12 +568,48 @@ cmd_status_t capture_Configure(uint8_t* cfg, uint32_t size)
 
     enabledSgpioChannels = cap_cfg->numEnabledSGPIO;
     enabledVadcChannels = cap_cfg->numEnabledVADC;
+    analogUpdates = 0;
 
   } while (FALSE);
 
   return result;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Changes the analog trigger and input settings (comes from the client).
+ *
+ * Used to change e.g. the trigger level of a configured capture without
+ * having to stop it and send a new configuration. The changes are applied
+ * the next time the capture is armed, see \ref cap_vadc_Update, and
+ * \ref capture_Rearm arms a capture that is waiting for its trigger again.
+ * The number of accepted changes is sent with the samples so that the
+ * client can tell which settings they were captured with.
+ *
+ * @param [in] cfg   Configuration from client (must be of type cap_vadc_cfg_t)
+ * @param [in] size  Size of configuration from client
+ *
+ * @retval CMD_STATUS_OK      If the changes will be applied at the next arming
+ * @retval CMD_STATUS_ERR_*   When the changes could not be accepted
+ *
+ *****************************************************************************/
+cmd_status_t capture_UpdateAnalogConfig(const uint8_t* cfg, uint32_t size)
+{
+  cmd_status_t result;
+
+  if ((size != sizeof(cap_vadc_cfg_t)) || (enabledVadcChannels == 0))
+  {
+    return CMD_STATUS_ERR;
+  }
+
+  result = cap_vadc_Update((const cap_vadc_cfg_t*)cfg);
+  if (result == CMD_STATUS_OK)
+  {
+    analogUpdates++;
+  }
+  return result;
+}
+
 /**************************************************************************//**
  *
  * @brief  Arms (starts) the signal capturing according to last configuration.
@@ -651,6 +632,9 @@ cmd_status_t capture_Arm(void)
   LED_TRIG_OFF();
 
   memset(&capturedSamples, 0, sizeof(captured_samples_t));
+  capturedSamples.sgpioTrigExact = CAPTURE_TRIGGER_UNKNOWN;
+  capturedSamples.vadcTrigExact = CAPTURE_TRIGGER_UNKNOWN;
+  capturedSamples.analogUpdates = analogUpdates;
 
   CAP_PREFILL_SET_AS_NEEDED();
 
@@ -694,6 +678,44 @@ cmd_status_t capture_Arm(void)
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Arms the capture again if it is still waiting for its trigger.
+ *
+ * Used after \ref capture_UpdateAnalogConfig so that the changed settings
+ * are used right away. A capture that has already triggered is left as it
+ * is and its samples are sent with the old settings.
+ *
+ * @retval CMD_STATUS_OK      If armed again or if there was nothing to arm
+ * @retval CMD_STATUS_ERR_*   If the capture could not be armed again
+ *
+ *****************************************************************************/
+cmd_status_t capture_Rearm(void)
+{
+  Bool waiting;
+
+  if (statemachine_GetState() != STATE_CAPTURING)
+  {
+    return CMD_STATUS_OK;
+  }
+
+  // The trigger must not be found between the test and the disarming
+  __disable_irq();
+  waiting = ((enabledSgpioChannels == 0) || cap_sgpio_IsWaitingForTrigger()) &&
+            ((enabledVadcChannels == 0) || cap_vadc_IsWaitingForTrigger());
+  if (waiting)
+  {
+    capture_Disarm();
+  }
+  __enable_irq();
+
+  if (!waiting)
+  {
+    return CMD_STATUS_OK;
+  }
+  return capture_Arm();
+}
+
 /**************************************************************************//**
  *
  * @brief  Disarms (stops) the signal capturing.
@@ -758,6 +780,73 @@ uint32_t capture_GetSampleRate(void)
   return RATECONFIG[currentSampleRateIdx].sampleRate;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Returns the number of samples per signal that the current
+ *         configuration can hold.
+ *
+ * @param [out] sgpioDepth  Samples per digital signal, 0 if none enabled
+ * @param [out] vadcDepth   Samples per analog signal, 0 if none enabled
+ *
+ *****************************************************************************/
+void capture_GetDepth(uint32_t* sgpioDepth, uint32_t* vadcDepth)
+{
+  *sgpioDepth = bufferPartition.sgpioDepth;
+  *vadcDepth = bufferPartition.vadcDepth;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Makes a preview of the ongoing capture.
+ *
+ * The preview is a \ref capture_peek_header_t followed by the digital and
+ * analog samples. The same step is used for both so that they line up and
+ * it is selected so that the preview covers the entire capture buffer.
+ * The header's step is 0 if there is no ongoing capture, e.g. if it has
+ * already triggered.
+ *
+ * @param [out] pDest    Where to write the preview, must be 32-bit aligned
+ * @param [in]  maxSize  Size of \a pDest, at least \ref CAPTURE_PEEK_MAX_SIZE
+ *
+ * @return The number of bytes written to \a pDest
+ *
+ *****************************************************************************/
+uint32_t capture_Peek(uint8_t* pDest, uint32_t maxSize)
+{
+  capture_peek_header_t* pHeader = (capture_peek_header_t*)pDest;
+  uint8_t* pData = pDest + sizeof(capture_peek_header_t);
+  uint32_t step;
+
+  memset(pHeader, 0, sizeof(capture_peek_header_t));
+  if (maxSize < CAPTURE_PEEK_MAX_SIZE || statemachine_GetState() != STATE_CAPTURING)
+  {
+    return sizeof(capture_peek_header_t);
+  }
+
+  step = MAX((bufferPartition.sgpioDepth + CAPTURE_PEEK_SAMPLES - 1) / CAPTURE_PEEK_SAMPLES,
+             (bufferPartition.vadcDepth + CAPTURE_PEEK_SAMPLES - 1) / CAPTURE_PEEK_SAMPLES);
+  step = MAX(step, 1);
+
+  if (enabledSgpioChannels > 0)
+  {
+    pHeader->digitalSize = cap_sgpio_Peek(step, (uint32_t*)pData, CAPTURE_PEEK_MAX_DIGITAL_SIZE,
+                                          &pHeader->digitalChannelInfo);
+    pData += pHeader->digitalSize;
+  }
+  if (enabledVadcChannels > 0)
+  {
+    pHeader->analogSize = cap_vadc_Peek(step, (uint16_t*)pData, CAPTURE_PEEK_MAX_ANALOG_SIZE,
+                                        &pHeader->analogChannelInfo);
+  }
+
+  if (pHeader->digitalSize > 0 || pHeader->analogSize > 0)
+  {
+    pHeader->step = step;
+  }
+
+  return sizeof(capture_peek_header_t) + pHeader->digitalSize + pHeader->analogSize;
+}
+
 /**************************************************************************//**
  *
  * @brief  Reports that capturing of digital signal(s) is completed.
@@ -766,11 +855,18 @@ uint32_t capture_GetSampleRate(void)
  * captured (or if the analog signal(s) are also done) sends the result to
  * the client.
  *
+ * @param [in] buff            The captured samples
+ * @param [in] trigpoint       The signal that caused the trigger
+ * @param [in] triggerSample   Sample where the trigger was reported
+ * @param [in] exactTrigger    Sample with the triggering edge or CAPTURE_TRIGGER_UNKNOWN
+ * @param [in] activeChannels  Enabled signals and number of copied words
+ *
  *****************************************************************************/
-void capture_ReportSGPIODone(circbuff_t* buff, uint32_t trigpoint, uint32_t triggerSample, uint32_t activeChannels)
+void capture_ReportSGPIODone(circbuff_t* buff, uint32_t trigpoint, uint32_t triggerSample, uint32_t exactTrigger, uint32_t activeChannels)
 {
   capturedSamples.trigpoint |= trigpoint;
   capturedSamples.sgpioTrigSample = triggerSample;
+  capturedSamples.sgpioTrigExact = exactTrigger;
   capturedSamples.sgpioActiveChannels = activeChannels;
   capturedSamples.sgpio_samples = buff;
 
@@ -784,18 +880,19 @@ void capture_ReportSGPIODone(circbuff_t* buff, uint32_t trigpoint, uint32_t trig
  *
  * @brief  Reports that capturing of digital signal(s) failed.
  *
- * The error code is saved and if only digital signals are being captured
- * (or if the analog signal(s) are also done) sends the result to the client.
+ * Any analog capture running in parallel is stopped as its samples cannot
+ * be sent without the digital ones, and the error is sent to the client.
  *
  * @param [in] error  The error code
  *
  *****************************************************************************/
 void capture_ReportSGPIOSamplingFailed(cmd_status_t error)
 {
-  if (enabledVadcChannels == 0)
+  if (enabledVadcChannels != 0)
   {
-    usb_handler_SignalFailedSampling(error);
+    cap_vadc_Disarm();
   }
+  usb_handler_SignalFailedSampling(error);
 }
 
 /**************************************************************************//**
@@ -806,11 +903,18 @@ void capture_ReportSGPIOSamplingFailed(cmd_status_t error)
  * captured (or if the digital signal(s) are also done) sends the result to
  * the client.
  *
+ * @param [in] buff            The captured samples
+ * @param [in] trigpoint       The signal that caused the trigger
+ * @param [in] triggerSample   Sample where the trigger was reported
+ * @param [in] exactTrigger    Sample with the trigger crossing or CAPTURE_TRIGGER_UNKNOWN
+ * @param [in] activeChannels  Enabled signals and number of channels
+ *
  *****************************************************************************/
-void capture_ReportVADCDone(circbuff_t* buff, uint32_t trigpoint, uint32_t triggerSample, uint32_t activeChannels)
+void capture_ReportVADCDone(circbuff_t* buff, uint32_t trigpoint, uint32_t triggerSample, uint32_t exactTrigger, uint32_t activeChannels)
 {
   capturedSamples.trigpoint |= trigpoint<<16;
   capturedSamples.vadcTrigSample = triggerSample;
+  capturedSamples.vadcTrigExact = exactTrigger;
   capturedSamples.vadcActiveChannels = activeChannels;
   capturedSamples.vadc_samples = buff;
 
@@ -0,0 +1,196 @@
+/*!
+ * @file
+ * @brief   Partitioning of the sample memory between digital and analog capture
+ * @ingroup FUNC_CAP
+ *
+ * Digital and analog signals are captured into the same 64KB of memory. When
+ * both kinds of signals are enabled the memory is split so that both buffers
+ * hold as many samples per signal as possible. Both are sampled at the same
+ * rate so the split only depends on how much memory each sample takes:
+ *
+ *  - With concatenation the SGPIO DMA copies one 32-bit word for each of
+ *    the 16 slices at every exchange, for 64, 128 or 256 samples per signal.
+ *    Without concatenation the SGPIO DMA gathers one word (32 samples) per
+ *    DIO up to and including the highest enabled one.
+ *  - The VADC DMA copies two bytes per enabled analog signal and sample. The
+ *    analog buffer is also a multiple of \ref CAPTURE_BUFFERS_VADC_GRANULE so
+ *    that all of the DMA's LLIs are the same size.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_buffers.h"
+#include "capture_sgpio_dma.h"
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Bytes per sample for each enabled analog signal */
+#define VADC_BYTES_PER_SAMPLE  2
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Calculates how the digital samples are stored.
+ *
+ * The SGPIO DMA copies \a unitSize bytes at each exchange and that holds
+ * \a samplesPerUnit samples for each of the enabled signals. This must
+ * match the concatenation selected in sgpio_cfg_SetupInputChannels.
+ *
+ * @param [in]  enabledChannels  Bitmask of enabled digital signals
+ * @param [out] unitSize         Number of bytes copied at each exchange
+ * @param [out] samplesPerUnit   Number of samples per signal in each copy
+ *
+ *****************************************************************************/
+void capture_buffers_SgpioUnit(uint32_t enabledChannels, uint32_t* unitSize, uint32_t* samplesPerUnit)
+{
+  uint32_t numCopied = 0;
+
+  if (enabledChannels == 0)
+  {
+    *unitSize = 0;
+    *samplesPerUnit = 0;
+  }
+  else if (enabledChannels <= 0x003)
+  {
+    // 8-step concatenation of DIO0..DIO1
+    *unitSize = CAPTURE_SGPIO_DMA_UNIT_SIZE;
+    *samplesPerUnit = 256;
+  }
+  else if (enabledChannels <= 0x00f)
+  {
+    // 4-step concatenation of DIO0..DIO3
+    *unitSize = CAPTURE_SGPIO_DMA_UNIT_SIZE;
+    *samplesPerUnit = 128;
+  }
+  else if (enabledChannels <= 0x0ff)
+  {
+    // 2-step concatenation of DIO0..DIO7
+    *unitSize = CAPTURE_SGPIO_DMA_UNIT_SIZE;
+    *samplesPerUnit = 64;
+  }
+  else
+  {
+    // No concatenation, the DMA gathers all DIOs up to the highest enabled
+    while (enabledChannels != 0)
+    {
+      numCopied++;
+      enabledChannels >>= 1;
+    }
+    *unitSize = numCopied * 4;
+    *samplesPerUnit = 32;
+  }
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Splits the sample memory between the digital and analog buffers.
+ *
+ * When only digital or only analog signals are enabled the entire memory is
+ * used (trimmed to a whole number of samples). With both enabled every
+ * possible size of the analog buffer (in steps of
+ * \ref CAPTURE_BUFFERS_VADC_GRANULE) is tried and the one where the smallest
+ * of the two depths is largest is used.
+ *
+ * @param [in]  enabledSgpioChannels  Bitmask of enabled digital signals
+ * @param [in]  numVADC               Number of enabled analog signals (0-2)
+ * @param [in]  memorySize            Size of the sample memory in bytes
+ * @param [out] result                The partitioning
+ *
+ * @return The number of samples per signal that will fit or 0 if the
+ *         combination is not supported
+ *
+ *****************************************************************************/
+uint32_t capture_buffers_Partition(uint32_t enabledSgpioChannels, uint32_t numVADC,
+                                   uint32_t memorySize, capture_buffers_t* result)
+{
+  uint32_t unitSize;
+  uint32_t samplesPerUnit;
+  uint32_t sampleSize = numVADC * VADC_BYTES_PER_SAMPLE;
+  uint32_t vadcSize;
+  uint32_t numUnits;
+  uint32_t sgpioDepth;
+  uint32_t vadcDepth;
+  uint32_t best = 0;
+
+  memset(result, 0, sizeof(capture_buffers_t));
+  result->vadcOffset = memorySize;
+
+  if (numVADC > 2 || (numVADC == 0 && enabledSgpioChannels == 0))
+  {
+    return 0;
+  }
+
+  capture_buffers_SgpioUnit(enabledSgpioChannels, &unitSize, &samplesPerUnit);
+
+  if (numVADC == 0)
+  {
+    // Only digital capture
+    numUnits = memorySize / unitSize;
+    result->sgpioSize = numUnits * unitSize;
+    result->sgpioDepth = numUnits * samplesPerUnit;
+    return result->sgpioDepth;
+  }
+
+  if (enabledSgpioChannels == 0)
+  {
+    // Only analog capture
+    result->vadcSize = (memorySize / sampleSize) * sampleSize;
+    result->vadcOffset = memorySize - result->vadcSize;
+    result->vadcDepth = result->vadcSize / sampleSize;
+    return result->vadcDepth;
+  }
+
+  // Growing the analog buffer increases the analog depth and decreases the
+  // digital depth so the search stops when the analog depth has caught up.
+  for (vadcSize = CAPTURE_BUFFERS_VADC_GRANULE; vadcSize < memorySize; vadcSize += CAPTURE_BUFFERS_VADC_GRANULE)
+  {
+    numUnits = (memorySize - vadcSize) / unitSize;
+    if (numUnits == 0)
+    {
+      break;
+    }
+    sgpioDepth = numUnits * samplesPerUnit;
+    vadcDepth = vadcSize / sampleSize;
+
+    if (((sgpioDepth < vadcDepth) ? sgpioDepth : vadcDepth) > best)
+    {
+      best = (sgpioDepth < vadcDepth) ? sgpioDepth : vadcDepth;
+      result->sgpioSize = numUnits * unitSize;
+      result->sgpioDepth = sgpioDepth;
+      result->vadcSize = vadcSize;
+      result->vadcOffset = memorySize - vadcSize;
+      result->vadcDepth = vadcDepth;
+    }
+    if (vadcDepth >= sgpioDepth)
+    {
+      break;
+    }
+  }
+
+  return best;
+}
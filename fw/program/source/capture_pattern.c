@@ -0,0 +1,305 @@
+/*!
+ * @file
+ * @brief   Pattern and sequence triggers for digital signals
+ * @ingroup FUNC_CAP
+ *
+ * A pattern trigger is a wanted level (0 or 1) for some of the digital
+ * signals, the rest are "don't care". A sequence trigger is two patterns
+ * where the second one must come after the first one.
+ *
+ * The SGPIO can only match patterns over time in one signal so the search
+ * is done in software when the shadow registers are exchanged. All 32
+ * samples of an exchange are compared at once, one bit per sample, which
+ * only takes a couple of instructions per signal in the pattern
+ * (see \ref capture_pattern_Step).
+ *
+ * \ref capture_pattern_Reference does the same search one sample at a
+ * time. It is used by the client software to locate the trigger in the
+ * received samples and to check the bit parallel search.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_pattern.h"
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Compares 32 samples of all signals with a pattern.
+ *
+ * @param [in] care    Signals that must match
+ * @param [in] value   Wanted levels
+ * @param [in] words   32 samples for each signal, oldest in the LSB
+ *
+ * @return A bit for each sample that matches the pattern
+ *
+ *****************************************************************************/
+static uint32_t capture_pattern_Match(uint32_t care, uint32_t value, const uint32_t* words)
+{
+  uint32_t match = 0xffffffff;
+  uint32_t ch;
+
+  for (ch = 0; care != 0; ch++, care >>= 1, value >>= 1)
+  {
+    if (care & 1)
+    {
+      match &= (value & 1) ? words[ch] : ~words[ch];
+    }
+  }
+  return match;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the position of the least significant bit that is set.
+ *
+ * @param [in] mask   A non-zero mask
+ *
+ * @return The bit position (0-31)
+ *
+ *****************************************************************************/
+static int capture_pattern_FirstBit(uint32_t mask)
+{
+  int pos = 0;
+  while ((mask & 1) == 0)
+  {
+    mask >>= 1;
+    pos++;
+  }
+  return pos;
+}
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Decodes and validates the stages in the configuration.
+ *
+ * Each stage is encoded with \ref CAPTURE_PATTERN_STAGE. Without an enabled
+ * first stage there is no pattern trigger and the second stage must not be
+ * enabled either. All signals in a pattern must be in \a enabledSignals.
+ *
+ * @param [out] pPattern        The decoded pattern
+ * @param [in]  stages          \ref CAPTURE_PATTERN_MAX_STAGES stage configurations
+ * @param [in]  enabledSignals  The signals that are captured
+ *
+ * @return 0 on success, -1 if the configuration is invalid
+ *
+ *****************************************************************************/
+int capture_pattern_Init(capture_pattern_t* pPattern, const uint32_t* stages, uint32_t enabledSignals)
+{
+  uint32_t i;
+
+  pPattern->numStages = 0;
+  for (i = 0; i < CAPTURE_PATTERN_MAX_STAGES; i++)
+  {
+    if ((stages[i] & CAPTURE_PATTERN_ENABLED) == 0)
+    {
+      break;
+    }
+
+    pPattern->care[i] = CAPTURE_PATTERN_CARE(stages[i]);
+    pPattern->value[i] = CAPTURE_PATTERN_VALUE(stages[i]) & pPattern->care[i];
+    if (pPattern->care[i] == 0 || (pPattern->care[i] & ~enabledSignals) != 0)
+    {
+      pPattern->numStages = 0;
+      return -1;
+    }
+    pPattern->numStages++;
+  }
+
+  // a stage after a disabled one is not allowed
+  for (; i < CAPTURE_PATTERN_MAX_STAGES; i++)
+  {
+    if (stages[i] & CAPTURE_PATTERN_ENABLED)
+    {
+      pPattern->numStages = 0;
+      return -1;
+    }
+  }
+
+  capture_pattern_Reset(pPattern);
+  return 0;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Starts a new search from the first stage.
+ *
+ * @param [in,out] pPattern   The pattern
+ *
+ *****************************************************************************/
+void capture_pattern_Reset(capture_pattern_t* pPattern)
+{
+  uint32_t i;
+
+  pPattern->stage = 0;
+  for (i = 0; i < CAPTURE_PATTERN_MAX_STAGES; i++)
+  {
+    // as if the pattern was already there so that it must go away first
+    pPattern->last[i] = 1;
+  }
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the signals that are used by any of the stages.
+ *
+ * @param [in] pPattern   The pattern
+ *
+ * @return A bit for each signal (bit 0 is DIO_0)
+ *
+ *****************************************************************************/
+uint32_t capture_pattern_Signals(const capture_pattern_t* pPattern)
+{
+  uint32_t signals = 0;
+  uint32_t i;
+
+  for (i = 0; i < pPattern->numStages; i++)
+  {
+    signals |= pPattern->care[i];
+  }
+  return signals;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Searches the next 32 samples for the trigger.
+ *
+ * The \a words array has one word for each signal (the first one for
+ * DIO_0) with 32 samples, the oldest in the least significant bit. Only
+ * the words for the signals in \ref capture_pattern_Signals are read.
+ *
+ * @param [in,out] pPattern   The pattern
+ * @param [in]     words      The samples
+ *
+ * @return The sample (0-31) where the trigger is or -1 if not found
+ *
+ *****************************************************************************/
+int capture_pattern_Step(capture_pattern_t* pPattern, const uint32_t* words)
+{
+  uint32_t started[CAPTURE_PATTERN_MAX_STAGES];
+  uint32_t i;
+  int pos;
+
+  if (pPattern->numStages == 0)
+  {
+    return -1;
+  }
+
+  for (i = 0; i < pPattern->numStages; i++)
+  {
+    uint32_t match = capture_pattern_Match(pPattern->care[i], pPattern->value[i], words);
+
+    // the samples that match when the previous sample did not
+    started[i] = match & ~((match << 1) | pPattern->last[i]);
+    pPattern->last[i] = match >> 31;
+  }
+
+  if (pPattern->stage == 0)
+  {
+    if (started[0] == 0)
+    {
+      return -1;
+    }
+    pos = capture_pattern_FirstBit(started[0]);
+    if (pPattern->numStages == 1)
+    {
+      return pos;
+    }
+
+    // the second stage must come after the first one
+    pPattern->stage = 1;
+    started[1] &= (pos == 31) ? 0 : (0xffffffff << (pos + 1));
+  }
+
+  if (started[1] == 0)
+  {
+    return -1;
+  }
+  return capture_pattern_FirstBit(started[1]);
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Searches for the trigger one sample at a time.
+ *
+ * Does the same search as repeated calls to \ref capture_pattern_Step
+ * after \ref capture_pattern_Reset, but with the levels of all signals
+ * for one sample in each word of \a levels (bit 0 is DIO_0). The state
+ * in \a pPattern is not changed.
+ *
+ * @param [in] pPattern     The pattern
+ * @param [in] levels       The samples
+ * @param [in] numSamples   Number of samples in \a levels
+ *
+ * @return The sample where the trigger is or CAPTURE_PATTERN_NOT_FOUND
+ *
+ *****************************************************************************/
+uint32_t capture_pattern_Reference(const capture_pattern_t* pPattern,
+                                   const uint32_t* levels, uint32_t numSamples)
+{
+  uint32_t last[CAPTURE_PATTERN_MAX_STAGES] = { 1, 1 };
+  uint32_t stage = 0;
+  uint32_t s;
+  uint32_t i;
+
+  if (pPattern->numStages == 0)
+  {
+    return CAPTURE_PATTERN_NOT_FOUND;
+  }
+
+  for (s = 0; s < numSamples; s++)
+  {
+    uint32_t started = 0;
+
+    for (i = 0; i < pPattern->numStages; i++)
+    {
+      uint32_t match = ((levels[s] & pPattern->care[i]) == pPattern->value[i]) ? 1 : 0;
+      if (match && !last[i])
+      {
+        started |= (1 << i);
+      }
+      last[i] = match;
+    }
+
+    if ((stage == 0) && (started & 1))
+    {
+      if (pPattern->numStages == 1)
+      {
+        return s;
+      }
+      stage = 1;
+    }
+    else if ((stage == 1) && (started & 2))
+    {
+      return s;
+    }
+  }
+
+  return CAPTURE_PATTERN_NOT_FOUND;
+}
@@ -0,0 +1,181 @@
+/*!
+ * @file
+ * @brief   Decimated preview of an ongoing capture
+ * @ingroup FUNC_CAP
+ *
+ * While a capture waits for its trigger the client software can ask for a
+ * preview of what is being captured. The functions here pick every n:th
+ * sample of the most recently captured data and pack them in the same
+ * format as the samples of a completed capture so that the client can
+ * unpack them the same way.
+ *
+ * The capture continues while the preview is made so the oldest part of
+ * it may already have been overwritten with new samples at high sample
+ * rates. It is only a preview.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_peek.h"
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+#define PEEK_MIN(__a, __b)  (((__a) < (__b)) ? (__a) : (__b))
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Makes a preview of the digital samples in a buffer
+ *
+ * The preview is written as groups of \a wordsPerGroup 32-bit words, one
+ * word for each signal and each word with 32 samples with the oldest in
+ * the least significant bit. It always holds a multiple of 32 samples
+ * per signal.
+ *
+ * The samples are stored in units of \a unitWords words, each with one
+ * or more groups. The words of a unit can be in another order, e.g. as
+ * the SGPIO DMA stores them, and then group word i is the unit's word
+ * \a order[i]. With a NULL \a order the units are stored as groups.
+ *
+ * @param [in]  buff           The captured samples
+ * @param [in]  wordsPerGroup  Number of words for each 32 samples
+ * @param [in]  unitWords      Number of words in each stored unit
+ * @param [in]  order          Unit word for each group word or NULL
+ * @param [in]  step           Number of captured samples per preview sample
+ * @param [out] pDest          Where to write the preview
+ * @param [in]  maxSize        Size of \a pDest in bytes
+ *
+ * @return The number of bytes written to \a pDest
+ *
+ *****************************************************************************/
+uint32_t capture_peek_Digital(const capture_trigger_buffer_t* buff, uint32_t wordsPerGroup,
+                              uint32_t unitWords, const uint8_t* order,
+                              uint32_t step, uint32_t* pDest, uint32_t maxSize)
+{
+  uint32_t groupBytes = wordsPerGroup * 4;
+  uint32_t unitBytes = unitWords * 4;
+  uint32_t groupsPerUnit;
+  uint32_t available;
+  uint32_t numOut;
+  uint32_t first;
+  uint32_t i;
+  uint32_t ch;
+
+  if (buff->size == 0 || wordsPerGroup == 0 || unitWords < wordsPerGroup || step == 0)
+  {
+    return 0;
+  }
+
+  groupsPerUnit = unitWords / wordsPerGroup;
+  available = (buff->used / unitBytes) * groupsPerUnit * 32;
+  numOut = PEEK_MIN(available / step, CAPTURE_PEEK_SAMPLES);
+  numOut = PEEK_MIN(numOut, (maxSize / groupBytes) * 32);
+  numOut = (numOut / 32) * 32;
+  if (numOut == 0)
+  {
+    return 0;
+  }
+
+  // the last preview sample is the last captured one
+  first = available - (numOut - 1) * step - 1;
+
+  memset(pDest, 0, (numOut / 32) * groupBytes);
+  for (i = 0; i < numOut; i++)
+  {
+    uint32_t sample = first + i * step;
+    uint32_t group = sample / 32;
+    uint32_t off = buff->first + (group / groupsPerUnit) * unitBytes;
+    uint32_t idx = (group % groupsPerUnit) * wordsPerGroup;
+    uint32_t* pOut = pDest + (i / 32) * wordsPerGroup;
+
+    for (ch = 0; ch < wordsPerGroup; ch++)
+    {
+      uint32_t w = (order != NULL) ? order[idx + ch] : (idx + ch);
+      uint32_t word = *((const uint32_t*)(buff->data + ((off + w * 4) % buff->size)));
+      pOut[ch] |= ((word >> (sample % 32)) & 1) << (i % 32);
+    }
+  }
+
+  return (numOut / 32) * groupBytes;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Makes a preview of the analog samples in a buffer
+ *
+ * The samples are stored as 16-bit values with \a numChannels interleaved
+ * channels. Each value is copied as it is, including the channel id, so
+ * that the preview has the same format as the captured samples.
+ *
+ * @param [in]  buff         The captured samples
+ * @param [in]  numChannels  Number of interleaved channels
+ * @param [in]  step         Number of captured samples per preview sample
+ * @param [out] pDest        Where to write the preview
+ * @param [in]  maxSize      Size of \a pDest in bytes
+ *
+ * @return The number of bytes written to \a pDest
+ *
+ *****************************************************************************/
+uint32_t capture_peek_Analog(const capture_trigger_buffer_t* buff, uint32_t numChannels,
+                             uint32_t step, uint16_t* pDest, uint32_t maxSize)
+{
+  uint32_t sampleBytes = numChannels * 2;
+  uint32_t available;
+  uint32_t numOut;
+  uint32_t first;
+  uint32_t i;
+  uint32_t ch;
+
+  if (buff->size == 0 || numChannels == 0 || step == 0)
+  {
+    return 0;
+  }
+
+  available = buff->used / sampleBytes;
+  numOut = PEEK_MIN(available / step, CAPTURE_PEEK_SAMPLES);
+  numOut = PEEK_MIN(numOut, maxSize / sampleBytes);
+  if (numOut == 0)
+  {
+    return 0;
+  }
+
+  // the last preview sample is the last captured one
+  first = available - (numOut - 1) * step - 1;
+
+  for (i = 0; i < numOut; i++)
+  {
+    uint32_t off = buff->first + (first + i * step) * sampleBytes;
+
+    for (ch = 0; ch < numChannels; ch++)
+    {
+      *pDest++ = *((const uint16_t*)(buff->data + ((off + ch * 2) % buff->size)));
+    }
+  }
+
+  return numOut * sampleBytes;
+}
@@ -39,12 +39,46 @@
 #include "capture_sgpio.h"
 #include "capture_vadc.h"
 #include "sgpio_cfg.h"
+#include "capture_trigger.h"
+#include "capture_peek.h"
+#include "capture_buffers.h"
+#include "capture_sgpio_dma.h"
+#include "capture_pattern.h"
 #include "meas.h"
 
 /******************************************************************************
  * Typedefs and defines
  *****************************************************************************/
 
+/*! The GPDMA channel that copies the captured samples. Channel 0 is used by
+ *  the VADC and channels 2 and 3 by the signal generator. */
+#define SGPIO_DMA_CH         1
+
+/*! The DMA request line used for the copying. The SGPIO has no DMA request
+ *  of its own so the exchange interrupt makes a software burst request on a
+ *  line where the selected peripheral (SPIFI) is not in use. */
+#define SGPIO_DMA_REQ        0
+
+/*! The LLIs are placed in the memory that is otherwise used for signal
+ *  generation data, see generator_sgpio.c. Capturing and generation is
+ *  never done at the same time so the memory is free. */
+#define SGPIO_DMA_LLI_MEM    ((capture_sgpio_dma_lli_t*) 0x10080000)
+
+/*! Number of LLIs needed for the largest buffer, one per exchange */
+#define SGPIO_DMA_MAX_LLIS   (CAPTURE_BUFFERS_MEMORY_SIZE / CAPTURE_SGPIO_DMA_UNIT_SIZE)
+
+/*! Control word for the LLIs, the transfer size is added when building them */
+#define SGPIO_DMA_CONTROL(__burst) \
+  (((__burst) << 12) |  /* Source Burst Size */ \
+   ((__burst) << 15) |  /* Destination Burst Size */ \
+   (0x2 << 18)  |       /* Source width - 32 bits */ \
+   (0x2 << 21)  |       /* Destination width - 32 bits */ \
+   (0x0 << 24)  |       /* Source AHB master 0 */ \
+   (0x1 << 25)  |       /* Dest AHB master 1 */ \
+   (0x1 << 26)  |       /* Source increment */ \
+   (0x1 << 27)  |       /* Destination increment */ \
+   (0x0UL << 31))       /* Terminal count interrupt disabled */
+
 /******************************************************************************
  * Global variables
  *****************************************************************************/
@@ -80,12 +114,62 @@ static uint32_t slicesToEnable = 0;
 
 static Bool forcedTrigger = FALSE;
 
+static uint32_t triggerSetup = 0;
+
 static sgpio_concat_t concatenation = SGPIO_CONCAT_NONE;
 
+/*! The DMA copies the shadow registers in slice order. These are the slices
+ *  in the order the client expects the words: DIO0, DIO1, ..., DIO0, ...
+ *  with the concatenated (oldest) samples first. Without concatenation the
+ *  DMA gathers the slices in this order directly. */
+static const uint8_t sliceOrderNone[] = {
+  SLICE_A, SLICE_O, SLICE_K, SLICE_G, SLICE_E, SLICE_L, SLICE_H, SLICE_M,
+  SLICE_N, SLICE_D, SLICE_B,
+};
+static const uint8_t sliceOrderTwo[CAPTURE_SGPIO_DMA_UNIT_WORDS] = {
+  SLICE_I, SLICE_D, SLICE_C, SLICE_N, SLICE_J, SLICE_F, SLICE_P, SLICE_B,
+  SLICE_A, SLICE_O, SLICE_K, SLICE_G, SLICE_E, SLICE_L, SLICE_H, SLICE_M,
+};
+static const uint8_t sliceOrderFour[CAPTURE_SGPIO_DMA_UNIT_WORDS] = {
+  SLICE_J, SLICE_D, SLICE_C, SLICE_M, SLICE_E, SLICE_P, SLICE_L, SLICE_B,
+  SLICE_I, SLICE_H, SLICE_F, SLICE_N, SLICE_A, SLICE_O, SLICE_K, SLICE_G,
+};
+static const uint8_t sliceOrderEight[CAPTURE_SGPIO_DMA_UNIT_WORDS] = {
+  SLICE_L, SLICE_D, SLICE_F, SLICE_N, SLICE_K, SLICE_G, SLICE_C, SLICE_M,
+  SLICE_J, SLICE_B, SLICE_E, SLICE_P, SLICE_I, SLICE_H, SLICE_A, SLICE_O,
+};
+
+static const uint8_t* sliceOrder = sliceOrderNone;
+
+/*! Number of 32-bit words stored in the circular buffer for each exchange */
+static uint32_t wordsPerExchange = CAPTURE_SGPIO_DMA_UNIT_WORDS;
+
+/*! Where the DMA gathers the slices without concatenation */
+static uint32_t gatherWords[CAPTURE_SGPIO_DMA_UNIT_WORDS];
+
+/*! Number of LLIs in the gather chain, the last one writes to the buffer */
+static uint32_t numGatherLLIs = 0;
+
+/*! Number of groups of 32 samples per signal in each exchange */
+static uint32_t groupsPerExchange = 1;
+
+/*! The pattern or sequence trigger, not used if it has no stages */
+static capture_pattern_t patternTrigger;
+
+/*! The signals used by \ref patternTrigger */
+static uint32_t patternSignals = 0;
+
+/*! Position of the pattern trigger within the exchange where it was found */
+static uint32_t patternTriggerOffset = 0;
+
 /******************************************************************************
  * Forward Declarations of Local Functions
  *****************************************************************************/
 
+static uint32_t cap_sgpio_FindExactTrigger(dio_t dio);
+static void cap_sgpio_StopDMA(void);
+static void cap_sgpio_FindPattern(void);
+
 /******************************************************************************
  * Global Functions
  *****************************************************************************/
@@ -99,19 +183,26 @@ static sgpio_concat_t concatenation = SGPIO_CONCAT_NONE;
  *  -# Input bit match interrupt (STATUS_3)
  *
  * The exchange clock interrupt is fired each time the SGPIO's shadow and
- * data registers have been exchanged and at that time this handler copies from
- * the shadow registers into the circular capture buffer.
- * The data is always copied in the correct order so that the data is DIO0, DIO1
- * DIO2,...,DIO0,DIO1,DIO2,... regardless of SGPIO concatenation.
+ * data registers have been exchanged. With concatenation all 16 shadow
+ * registers hold samples and this handler requests the DMA to copy them into
+ * the circular capture buffer, see capture_sgpio_dma.c. Without concatenation
+ * only one shadow register per DIO is used and this handler instead restarts
+ * the DMA's gather chain with the next position in the buffer. If the DMA has
+ * not finished the previous exchange by then that exchange has been lost and
+ * the capture fails with CMD_STATUS_ERR_SAMPLES_LOST. Either way the data
+ * ends up in the order DIO0, DIO1, DIO2,...,DIO0,DIO1,DIO2,...
+ *
+ * With a pattern or sequence trigger the exchanged samples are also searched
+ * for the trigger, see \ref cap_sgpio_FindPattern.
  *
  * The input bit match interrupt is fired if a triggering condition has been
  * met. At that time the position in the circular buffer is saved and VADC is
  * notified (in case analog sampling is done in parallel). An end point is
  * calculated and then the sampling continues.
  *
- * After having copied the data into the circular buffer a test is made to see
- * if the end condition has been met and if so then the SGPIO is stopped and
- * the result is reported through a call to \ref capture_ReportSGPIODone.
+ * After each exchange a test is made to see if the end condition has been
+ * met and if so then the SGPIO and the DMA are stopped and the result is
+ * reported through a call to \ref capture_ReportSGPIODone.
  *
  *****************************************************************************/
 void SGPIO_IRQHandler(void)
@@ -123,165 +214,39 @@ void SGPIO_IRQHandler(void)
   {
     LPC_SGPIO->CTR_STATUS_1 = CaptureInterruptMask;
 
-    // The shadow register now contains data that can be read
-//  SET_MEAS_PIN_2();
-
-    if (concatenation == SGPIO_CONCAT_NONE)
-    {
-      switch (actualChannelsToCopy)
-      {
-//         case 1:
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-//           break;
-//         case 2:
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-//           break;
-//         case 3:
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-//           break;
-//         case 4:
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-//           break;
-//         case 5:
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO4
-//           break;
-//         case 6:
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO4
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO5
-//           break;
-//         case 7:
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO4
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO5
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_H]; //DIO6    G]; //DIO6
-//           break;
-//         case 8:
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO4
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO5
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_H]; //DIO6    G]; //DIO6
-//           *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_M]; //DIO7
-//           break;
-        case 9:
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO4
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO5
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_H]; //DIO6    G]; //DIO6
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_M]; //DIO7
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_N]; //DIO8
-          break;
-        case 10:
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO4
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO5
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_H]; //DIO6    G]; //DIO6
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_M]; //DIO7
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_N]; //DIO8
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_D]; //DIO9
-          break;
-        case 11:
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO4
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO5
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_H]; //DIO6    G]; //DIO6
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_M]; //DIO7
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_N]; //DIO8
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_D]; //DIO9
-          *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_B]; //CLK
-          break;
-      }
-    }
-    else if (concatenation == SGPIO_CONCAT_TWO)
+    // The shadow registers now contain data that can be read
+    if ((concatenation == SGPIO_CONCAT_NONE) ?
+        (LPC_GPDMA->C1CONFIG & 0x1) :
+        (LPC_GPDMA->SOFTBREQ & (1 << SGPIO_DMA_REQ)))
     {
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_I]; //DIO0, concat
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_D]; //DIO1, concat
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_C]; //DIO2, concat
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_N]; //DIO3, concat
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_J]; //DIO4, concat
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_F]; //DIO5, concat
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_P]; //DIO6, concat
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_B]; //DIO7, concat
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3    H]; //DIO3
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO4
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO5
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_H]; //DIO6    G]; //DIO6
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_M]; //DIO7
+      // The previous exchange has not been copied and its shadow registers
+      // now hold new samples, the captured data would have a gap
+      NVIC_DisableIRQ(SGPIO_IINT_IRQn);
+      LPC_SGPIO->CTRL_ENABLED &= ~0xffff;
+      cap_sgpio_StopDMA();
+      capture_ReportSGPIOSamplingFailed(CMD_STATUS_ERR_SAMPLES_LOST);
+      CLR_MEAS_PIN_1();
+      return;
     }
-    else if (concatenation == SGPIO_CONCAT_FOUR)
+
+    if (concatenation == SGPIO_CONCAT_NONE)
     {
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_J]; //DIO0, concat 3rd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_D]; //DIO1, concat 3rd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_C]; //DIO2, concat 3rd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_M]; //DIO3, concat 3rd
-
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO0, concat 2nd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_P]; //DIO1, concat 2nd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO2, concat 2nd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_B]; //DIO3, concat 2nd
-
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_I]; //DIO0, concat 1st
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_H]; //DIO1, concat 1st
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_F]; //DIO2, concat 1st
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_N]; //DIO3, concat 1st
-
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO2
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO3
+      // Let the DMA gather the used slices to the next position in the
+      // circular buffer, the chain disables the channel when done
+      SGPIO_DMA_LLI_MEM[numGatherLLIs - 1].dstAddr = (uint32_t)circbuff_addr;
+      LPC_GPDMA->C1SRCADDR = SGPIO_DMA_LLI_MEM[0].srcAddr;
+      LPC_GPDMA->C1DESTADDR = SGPIO_DMA_LLI_MEM[0].dstAddr;
+      LPC_GPDMA->C1CONTROL = SGPIO_DMA_LLI_MEM[0].control;
+      LPC_GPDMA->C1LLI     = SGPIO_DMA_LLI_MEM[0].nextLLI;
+      LPC_GPDMA->C1CONFIG  = (0x1) |        // Enable bit
+                             (0x0 << 11);   // Flow control - memory to memory - DMA control
     }
-    else if (concatenation == SGPIO_CONCAT_EIGHT)
+    else
     {
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_L]; //DIO0, concat 7th
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_D]; //DIO1, concat 7th
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_F]; //DIO0, concat 6th
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_N]; //DIO1, concat 6th
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_K]; //DIO0, concat 5th
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_G]; //DIO1, concat 5th
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_C]; //DIO0, concat 4th
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_M]; //DIO1, concat 4th
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_J]; //DIO0, concat 3rd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_B]; //DIO1, concat 3rd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_E]; //DIO0, concat 2nd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_P]; //DIO1, concat 2nd
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_I]; //DIO0, concat 1st
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_H]; //DIO1, concat 1st
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_A]; //DIO0
-      *circbuff_addr++ = LPC_SGPIO->REG_SS[SLICE_O]; //DIO1
+      // Let the DMA copy them to the next position in the circular buffer
+      LPC_GPDMA->SOFTBREQ = (1 << SGPIO_DMA_REQ);
     }
-
-    //  CLR_MEAS_PIN_2();
+    circbuff_addr += wordsPerExchange;
 
     if ((uint32_t)circbuff_addr >= circbuff_last_addr)
     {
@@ -292,6 +257,11 @@ void SGPIO_IRQHandler(void)
       }
     }
 
+    if (patternSignals != 0 && CAP_PREFILL_IS_PREFILL_DONE() && !triggered)
+    {
+      cap_sgpio_FindPattern();
+    }
+
     // If no triggers are selected then use forced triggering, i.e. fill the
     // capture buffer once and return that to the UI
     if (CAP_PREFILL_IS_PREFILL_DONE() && forcedTrigger && !triggered)
@@ -306,6 +276,14 @@ void SGPIO_IRQHandler(void)
       // disable SGPIO
       NVIC_DisableIRQ(SGPIO_IINT_IRQn);
       LPC_SGPIO->CTRL_ENABLED &= ~0xffff;
+      cap_sgpio_StopDMA();
+
+      // Put the words copied by the DMA in the order the client expects
+      if (concatenation != SGPIO_CONCAT_NONE)
+      {
+        capture_sgpio_dma_Reorder((uint32_t*)pSampleBuffer->data, circbuff_sample_limit,
+                                  sliceOrder, virtualChannelsToCopy);
+      }
 
       // update sample buffer with correct positions
       pSampleBuffer->empty = (circbuff_num_samples < circbuff_sample_limit)?TRUE:FALSE;
@@ -323,12 +301,22 @@ void SGPIO_IRQHandler(void)
       triggered_pos = (triggered_pos * 32) / (actualChannelsToCopy * 4);
 
       // time to send to the PC
-      if (forcedTrigger || (PatternInterruptMask == 0 && InputBitInterruptMask == 0))
+      if (patternSignals != 0 && triggered)
+      {
+        capture_ReportSGPIODone(
+          pSampleBuffer,
+          0, // not caused by one signal
+          triggered_pos,
+          triggered_pos + patternTriggerOffset,
+          activeChannels | (actualChannelsToCopy << 16));
+      }
+      else if (forcedTrigger || (PatternInterruptMask == 0 && InputBitInterruptMask == 0))
       {
         capture_ReportSGPIODone(
           pSampleBuffer,
           0, // forced trigger or triggered by VADC
           triggered_pos,
+          CAPTURE_TRIGGER_UNKNOWN,
           activeChannels | (actualChannelsToCopy << 16));
       }
       else
@@ -337,6 +325,7 @@ void SGPIO_IRQHandler(void)
           pSampleBuffer,
           sgpio_cfg_GetDioForSliceInterrupt(triggered),
           triggered_pos,
+          cap_sgpio_FindExactTrigger(sgpio_cfg_GetDioForSliceInterrupt(triggered)),
           activeChannels | (actualChannelsToCopy << 16));
       }
     }
@@ -379,6 +368,94 @@ void SGPIO_IRQHandler(void)
  * Local Functions
  *****************************************************************************/
 
+/**************************************************************************//**
+ *
+ * @brief  Searches the exchanged samples for the pattern trigger.
+ *
+ * Called from \ref SGPIO_IRQHandler when the shadow registers hold the
+ * samples of the latest exchange. Only the slices of the signals in the
+ * pattern are read. The samples are searched in order, oldest group first,
+ * and when the trigger is found its position is saved and the post trigger
+ * sampling is started.
+ *
+ *****************************************************************************/
+static void cap_sgpio_FindPattern(void)
+{
+  uint32_t words[CAPTURE_PATTERN_MAX_SIGNALS];
+  uint32_t group;
+  uint32_t ch;
+  int pos;
+
+  for (group = 0; group < groupsPerExchange; group++)
+  {
+    const uint8_t* order = sliceOrder + group * actualChannelsToCopy;
+
+    for (ch = 0; ch < actualChannelsToCopy; ch++)
+    {
+      if (patternSignals & (1 << ch))
+      {
+        words[ch] = LPC_SGPIO->REG_SS[order[ch]];
+      }
+    }
+
+    pos = capture_pattern_Step(&patternTrigger, words);
+    if (pos >= 0)
+    {
+      triggered = 1;
+      patternTriggerOffset = group * 32 + pos;
+      cap_sgpio_Triggered();
+
+      // In case both VADC and SGPIO are being sampled, notify VADC as well
+      cap_vadc_Triggered();
+      break;
+    }
+  }
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Finds the sample where the triggering edge is.
+ *
+ * The trigger interrupt only tells which group of samples was being shifted
+ * in when the edge was found. This looks through the captured data around
+ * that position for the actual edge. Level triggers have no edge and are
+ * not looked for.
+ *
+ * @param [in] dio   The signal that caused the trigger
+ *
+ * @return The trigger sample in the straightened-out buffer or
+ *         CAPTURE_TRIGGER_UNKNOWN if it could not be found
+ *
+ *****************************************************************************/
+static uint32_t cap_sgpio_FindExactTrigger(dio_t dio)
+{
+  capture_trigger_buffer_t buff;
+  uint32_t setup;
+  uint32_t samplesPerUnit;
+
+  if (dio == DIO_UNAVAIL)
+  {
+    return CAPTURE_TRIGGER_UNKNOWN;
+  }
+
+  setup = (triggerSetup >> (2 * dio)) & 0x3;
+  if (setup != CAP_RISING_EDGE && setup != CAP_FALLING_EDGE)
+  {
+    return CAPTURE_TRIGGER_UNKNOWN;
+  }
+
+  buff.data  = pSampleBuffer->data;
+  buff.size  = pSampleBuffer->size;
+  buff.first = circbuff_GetFirstAddr(pSampleBuffer) - (uint32_t)pSampleBuffer->data;
+  buff.used  = circbuff_GetUsedSize(pSampleBuffer);
+
+  samplesPerUnit = (32 * virtualChannelsToCopy) / actualChannelsToCopy;
+
+  return capture_trigger_FindDigitalEdge(&buff, actualChannelsToCopy, dio,
+                                         (setup == CAP_RISING_EDGE),
+                                         triggered_pos, samplesPerUnit, samplesPerUnit);
+}
+
 /**************************************************************************//**
  *
  * @brief  Prepares SGPIO for a new capture
@@ -489,7 +566,7 @@ static void cap_sgpio_Setup(const sgpio_channel_config_t* const pConfig)
  * Post fill configuration. The lower 8 bits specify the percent of the
  * maximum buffer size that will be used for samples taken AFTER the trigger.
  * The upper 24 bits specifies the maximum number of samples to gather after
- * a trigger has been found.
+ * a trigger has been found. See \ref capture_sgpio_dma_PostFill.
  *
  * The result is stored in \ref circbuff_post_fill.
  *
@@ -501,31 +578,106 @@ static void cap_sgpio_Setup(const sgpio_channel_config_t* const pConfig)
  *****************************************************************************/
 static cmd_status_t cap_sgpio_CalculatePostFill(uint32_t postFill)
 {
-  uint32_t postFillPercent = postFill & 0xff;
-  uint32_t postFillSamples = (postFill >> 8) & 0xffffff;
+  uint32_t result;
 
-  if (postFillPercent > 100)
+  if (capture_sgpio_dma_PostFill(circbuff_sample_limit, postFill, &result) != 0)
   {
     return CMD_STATUS_ERR_INVALID_POSTFILLPERCENT;
   }
 
-  // Apply percent limit
-  circbuff_post_fill = (circbuff_sample_limit * postFillPercent)/100;
+  circbuff_post_fill = result;
+  return CMD_STATUS_OK;
+}
 
-  // Apply time limit
-  circbuff_post_fill = MIN(circbuff_post_fill, postFillSamples);
+/**************************************************************************//**
+ *
+ * @brief  Prepares the DMA that copies the captured samples
+ *
+ * With concatenation the DMA follows a ring of LLIs, one for each exchange
+ * that fits in the circular buffer (see \ref capture_sgpio_dma_BuildRing).
+ * It is started here but only copies when \ref SGPIO_IRQHandler requests it.
+ *
+ * Without concatenation the DMA follows a short chain that gathers the used
+ * slices (see \ref capture_sgpio_dma_BuildGather). It is only built here and
+ * \ref SGPIO_IRQHandler starts it at each exchange.
+ *
+ * @retval CMD_STATUS_OK    If successfully prepared
+ * @retval CMD_STATUS_ERR   If the LLIs could not be built
+ *
+ *****************************************************************************/
+static cmd_status_t cap_sgpio_SetupDMA(void)
+{
+  uint32_t numLLIs;
+
+  LPC_GPDMA->C1CONFIG = 0;
 
-  // Need at least one sample after the trigger is found
-  circbuff_post_fill = MAX(1, circbuff_post_fill);
+  /* clear all interrupts on channel 1 */
+  LPC_GPDMA->INTTCCLEAR = (1 << SGPIO_DMA_CH);
+  LPC_GPDMA->INTERRCLR = (1 << SGPIO_DMA_CH);
 
-  // Need at least five samples before the trigger is found, due to the fact that
-  // the "input bit interrupt" for the trigger seems to occur ca 3 "exchange interrupts"
-  // after the value change
-  circbuff_post_fill = MIN(circbuff_post_fill, circbuff_sample_limit - 5);
+  /* Setup the DMAMUX, the SPIFI is not used so no requests come from it */
+  LPC_CREG->DMAMUX &= ~(0x3<<(SGPIO_DMA_REQ*2));
+
+  LPC_GPDMA->CONFIG = 0x01;  /* Enable DMA channels, little endian */
+  while ( !(LPC_GPDMA->CONFIG & 0x01) );
+
+  if (concatenation == SGPIO_CONCAT_NONE)
+  {
+    numGatherLLIs = capture_sgpio_dma_BuildGather(SGPIO_DMA_LLI_MEM, SGPIO_DMA_MAX_LLIS,
+                                                  (uint32_t) &(LPC_SGPIO->REG_SS[0]),
+                                                  sliceOrderNone, actualChannelsToCopy,
+                                                  (uint32_t) gatherWords,
+                                                  SGPIO_DMA_CONTROL(0x0)); // Burst Size - 1
+    return (numGatherLLIs == 0) ? CMD_STATUS_ERR : CMD_STATUS_OK;
+  }
+
+  numLLIs = capture_sgpio_dma_BuildRing(SGPIO_DMA_LLI_MEM, SGPIO_DMA_MAX_LLIS,
+                                        (uint32_t) &(LPC_SGPIO->REG_SS[0]),
+                                        (uint32_t) pSampleBuffer->data,
+                                        pSampleBuffer->size,
+                                        SGPIO_DMA_CONTROL(0x3)); // Burst Size - 16, one exchange per request
+  if (numLLIs != circbuff_sample_limit)
+  {
+    return CMD_STATUS_ERR;
+  }
+
+  LPC_GPDMA->C1SRCADDR = SGPIO_DMA_LLI_MEM[0].srcAddr;
+  LPC_GPDMA->C1DESTADDR = SGPIO_DMA_LLI_MEM[0].dstAddr;
+  LPC_GPDMA->C1CONTROL = SGPIO_DMA_LLI_MEM[0].control;
+  LPC_GPDMA->C1LLI     = SGPIO_DMA_LLI_MEM[0].nextLLI; // the first LLI is used when initializing
+  LPC_GPDMA->C1CONFIG  =  (0x1)        |          // Enable bit
+                          (SGPIO_DMA_REQ << 1) |  // SRCPERIPHERAL - only software requests
+                          (0x0 << 6)   |          // Destination peripheral - memory - no setting
+                          (0x2 << 11)  |          // Flow control - peripheral to memory - DMA control
+                          (0x0 << 14)  |          // Int error mask
+                          (0x0 << 15);            // ITC - term count error mask
 
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Stops the DMA that copies the captured samples
+ *
+ * Waits for the last requested copy to complete first.
+ *
+ *****************************************************************************/
+static void cap_sgpio_StopDMA(void)
+{
+  if (concatenation == SGPIO_CONCAT_NONE)
+  {
+    // the gather chain disables the channel when it is done
+    while (LPC_GPDMA->C1CONFIG & 0x1) {};
+  }
+  else if (LPC_GPDMA->C1CONFIG & 0x1)
+  {
+    while (LPC_GPDMA->SOFTBREQ & (1 << SGPIO_DMA_REQ)) {};
+    LPC_GPDMA->C1CONFIG |= (1 << 18);         //halt further requests
+    while (LPC_GPDMA->C1CONFIG & (1<<17)) {}; // wait for the current dma transaction to complete
+    LPC_GPDMA->C1CONFIG &= ~(1<<0);           //disable
+  }
+}
+
 /******************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -580,6 +732,8 @@ cmd_status_t cap_sgpio_Configure(circbuff_t* buff,
   cmd_status_t result;
   validConfiguration = FALSE;
   forcedTrigger = forceTrigger;
+  triggerSetup = cfg->triggerSetup;
+  patternSignals = 0;
 
   for (i = 0; i < MAX_NUM_SLICES; i++)
   {
@@ -588,6 +742,13 @@ cmd_status_t cap_sgpio_Configure(circbuff_t* buff,
 
   do
   {
+    if (capture_pattern_Init(&patternTrigger, cfg->triggerPattern, cfg->enabledChannels) != 0 ||
+        (patternTrigger.numStages > 0 && cfg->enabledTriggers != 0))
+    {
+      result = CMD_STATUS_ERR_INVALID_TRIGGER_PATTERN;
+      break;
+    }
+
     result = sgpio_cfg_SetupInputChannels(config, &concatenation, cfg, shiftClockPreset);
     if (result != CMD_STATUS_OK)
     {
@@ -606,40 +767,57 @@ cmd_status_t cap_sgpio_Configure(circbuff_t* buff,
           }
         }
         virtualChannelsToCopy = actualChannelsToCopy;
+        sliceOrder = sliceOrderNone;
         break;
 
       case SGPIO_CONCAT_TWO:
         actualChannelsToCopy = 8;
         virtualChannelsToCopy = 16;
+        sliceOrder = sliceOrderTwo;
         break;
 
       case SGPIO_CONCAT_FOUR:
         actualChannelsToCopy = 4;
         virtualChannelsToCopy = 16;
+        sliceOrder = sliceOrderFour;
         break;
 
       case SGPIO_CONCAT_EIGHT:
         actualChannelsToCopy = 2;
         virtualChannelsToCopy = 16;
+        sliceOrder = sliceOrderEight;
         break;
     }
 
 
-    if (actualChannelsToCopy == 0)
+    if (actualChannelsToCopy == 0 || actualChannelsToCopy > sizeof(sliceOrderNone))
     {
       result = CMD_STATUS_ERR;
       break;
     }
+    groupsPerExchange = virtualChannelsToCopy / actualChannelsToCopy;
+    patternSignals = capture_pattern_Signals(&patternTrigger);
 
-    // Configure the circular buffer data for use by the interrupt handler
+    // Configure the circular buffer data for use by the interrupt handler.
+    // With concatenation the DMA copies all slices at each exchange,
+    // otherwise it gathers one slice per DIO.
     circbuff_addr = (uint32_t*)pSampleBuffer->data;
-    circbuff_sample_limit = pSampleBuffer->maxSize/(virtualChannelsToCopy * 4);// * concatenation);
+    if (concatenation == SGPIO_CONCAT_NONE)
+    {
+      wordsPerExchange = actualChannelsToCopy;
+      circbuff_sample_limit = pSampleBuffer->maxSize/(wordsPerExchange * 4);
+    }
+    else
+    {
+      wordsPerExchange = CAPTURE_SGPIO_DMA_UNIT_WORDS;
+      circbuff_sample_limit = MIN(pSampleBuffer->maxSize/CAPTURE_SGPIO_DMA_UNIT_SIZE, SGPIO_DMA_MAX_LLIS);
+    }
 
     log_i("Actual %2d, Virtual %2d, Sample Limit %4d\r\n", actualChannelsToCopy, virtualChannelsToCopy, circbuff_sample_limit);
 
-    // Trim the size of the circular buffer to be an even multiple of the number
-    // of channels in this capture
-    circbuff_Resize(pSampleBuffer, circbuff_sample_limit * virtualChannelsToCopy * 4);// * concatenation);
+    // Trim the size of the circular buffer to be an even multiple of what
+    // is copied at each exchange
+    circbuff_Resize(pSampleBuffer, circbuff_sample_limit * wordsPerExchange * 4);
 
     circbuff_last_addr = (uint32_t)pSampleBuffer->data + pSampleBuffer->size;
 
@@ -680,6 +858,7 @@ cmd_status_t cap_sgpio_PrepareToArm(void)
   circbuff_num_samples = 0;
   circbuff_last_sample = 0xffffffff;
   triggered_pos = 0xffffffff;
+  capture_pattern_Reset(&patternTrigger);
 
   circbuff_Reset(pSampleBuffer);
 
@@ -687,7 +866,7 @@ cmd_status_t cap_sgpio_PrepareToArm(void)
   //CLR_MEAS_PIN_2();
   //CLR_MEAS_PIN_3();
   cap_sgpio_Setup(config);
-  return CMD_STATUS_OK;
+  return cap_sgpio_SetupDMA();
 }
 
 /**************************************************************************//**
@@ -714,6 +893,7 @@ cmd_status_t cap_sgpio_Disarm(void)
 {
   // Disable all slices
   LPC_SGPIO->CTRL_ENABLED &= ~0xffff;
+  cap_sgpio_StopDMA();
 
   // Disable the capture interrupt for all slices
   LPC_SGPIO->CLR_EN_1 = 0xffff;
@@ -750,3 +930,76 @@ void inline cap_sgpio_Triggered(void)
   circbuff_last_sample = circbuff_num_samples + circbuff_post_fill;
   triggered_pos = circbuff_num_samples;
 }
+
+/**************************************************************************//**
+ *
+ * @brief  Tells if the capture is armed and still waiting for its trigger
+ *
+ * @return TRUE if armed and not yet triggered, FALSE otherwise
+ *
+ *****************************************************************************/
+Bool cap_sgpio_IsWaitingForTrigger(void)
+{
+  if (!validConfiguration || (LPC_SGPIO->CTRL_ENABLED & slicesToEnable) == 0)
+  {
+    return FALSE;
+  }
+  return (circbuff_last_sample == 0xffffffff) ? TRUE : FALSE;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Makes a preview of the ongoing capture
+ *
+ * Takes every \a step sample of the most recently captured data, see
+ * \ref capture_peek_Digital. Nothing is changed so the capture is not
+ * affected.
+ *
+ * @param [in]  step          Number of captured samples per preview sample
+ * @param [out] pDest         Where to write the preview
+ * @param [in]  maxSize       Size of \a pDest in bytes
+ * @param [out] pChannelInfo  The signals in the preview, same format as for the captured samples
+ *
+ * @return The number of bytes written to \a pDest, 0 if there is no ongoing capture
+ *
+ *****************************************************************************/
+uint32_t cap_sgpio_Peek(uint32_t step, uint32_t* pDest, uint32_t maxSize, uint32_t* pChannelInfo)
+{
+  capture_trigger_buffer_t buff;
+  uint32_t pos;
+
+  if (!validConfiguration || (LPC_SGPIO->CTRL_ENABLED & slicesToEnable) == 0)
+  {
+    // not armed or already done
+    return 0;
+  }
+
+  pos = (uint32_t)circbuff_addr - (uint32_t)pSampleBuffer->data;
+
+  buff.data = pSampleBuffer->data;
+  buff.size = pSampleBuffer->size;
+  if (CAP_PREFILL_IS_SGPIO_DONE())
+  {
+    // has wrapped at least once so the oldest data is at the write position
+    buff.first = pos;
+    buff.used  = buff.size;
+  }
+  else
+  {
+    buff.first = 0;
+    buff.used  = pos;
+  }
+
+  *pChannelInfo = activeChannels | (actualChannelsToCopy << 16);
+
+  if (concatenation == SGPIO_CONCAT_NONE)
+  {
+    // the DMA gathers the words in the final order
+    return capture_peek_Digital(&buff, actualChannelsToCopy, wordsPerExchange,
+                                NULL, step, pDest, maxSize);
+  }
+
+  // the words are still in the order that the DMA copies them
+  return capture_peek_Digital(&buff, actualChannelsToCopy, CAPTURE_SGPIO_DMA_UNIT_WORDS,
+                              sliceOrder, step, pDest, maxSize);
+}
@@ -0,0 +1,260 @@
+/*!
+ * @file
+ * @brief   DMA transfers of captured digital samples
+ * @ingroup FUNC_CAP
+ *
+ * At each exchange the SGPIO slices' shadow registers hold the samples
+ * shifted in since the previous exchange. The GPDMA copies all 16 of them,
+ * in slice order, to the next position in the circular capture buffer by
+ * following a ring of linked list items (LLIs), one per position.
+ *
+ * The client expects the samples for one signal after the other (see
+ * \ref capture_sgpio_dma_Reorder) so the words are put in that order when
+ * the capture is done.
+ *
+ * Without concatenation only a few of the shadow registers are used. Then a
+ * short chain gathers just those, in the client's order, and is restarted
+ * at each exchange (see \ref capture_sgpio_dma_BuildGather).
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_sgpio_dma.h"
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Mask for the transfer size in an LLI's control word */
+#define LLI_TRANSFER_SIZE_MASK  0xfff
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Builds the ring of LLIs that fills the capture buffer.
+ *
+ * Each LLI copies \ref CAPTURE_SGPIO_DMA_UNIT_WORDS words from \a srcAddr
+ * (the first shadow register) to the next position in the buffer and the
+ * last LLI is linked to the first one. The \a control word must have all
+ * settings except the transfer size which is added here. The DMA copies
+ * one LLI for each request so the source address starts over at every
+ * exchange.
+ *
+ * The first LLI is normally loaded into the channel's registers and the
+ * channel's LLI register pointed to the second one.
+ *
+ * @param [out] lli         Where to build the LLIs
+ * @param [in]  maxLLIs     Number of LLIs that fit in \a lli
+ * @param [in]  srcAddr     Address to copy from
+ * @param [in]  dstAddr     Start of the capture buffer
+ * @param [in]  bufferSize  Size of the capture buffer in bytes
+ * @param [in]  control     Control word for all LLIs
+ *
+ * @return The number of LLIs in the ring, 0 if they don't fit in \a lli
+ *
+ *****************************************************************************/
+uint32_t capture_sgpio_dma_BuildRing(capture_sgpio_dma_lli_t* lli, uint32_t maxLLIs,
+                                     uint32_t srcAddr, uint32_t dstAddr,
+                                     uint32_t bufferSize, uint32_t control)
+{
+  uint32_t numLLIs = bufferSize / CAPTURE_SGPIO_DMA_UNIT_SIZE;
+  uint32_t i;
+
+  if (numLLIs == 0 || numLLIs > maxLLIs)
+  {
+    return 0;
+  }
+
+  control = (control & ~LLI_TRANSFER_SIZE_MASK) | CAPTURE_SGPIO_DMA_UNIT_WORDS;
+
+  for (i = 0; i < numLLIs; i++)
+  {
+    lli[i].srcAddr = srcAddr;
+    lli[i].dstAddr = dstAddr + i * CAPTURE_SGPIO_DMA_UNIT_SIZE;
+    lli[i].nextLLI = (uint32_t)(uintptr_t)(&lli[(i + 1) % numLLIs]);
+    lli[i].control = control;
+  }
+
+  return numLLIs;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Builds the chain of LLIs that gathers the used slices.
+ *
+ * Without concatenation only one shadow register per signal holds samples
+ * and the used slices are spread out, see sliceOrderNone in capture_sgpio.c.
+ * The first \a numSlices LLIs copy one word each, from the shadow register
+ * of slice \a order[i] to word i of \a stagingAddr. The last LLI copies the
+ * gathered words to the capture buffer in one go and ends the chain. Its
+ * destination is zero here and is set for each exchange as the position in
+ * the buffer moves.
+ *
+ * The \a control word must have all settings except the transfer size which
+ * is added here.
+ *
+ * @param [out] lli          Where to build the LLIs
+ * @param [in]  maxLLIs      Number of LLIs that fit in \a lli
+ * @param [in]  regAddr      Address of the first shadow register
+ * @param [in]  order        The slice to copy for each word
+ * @param [in]  numSlices    Number of slices to copy
+ * @param [in]  stagingAddr  Where to gather the words, \a numSlices long
+ * @param [in]  control      Control word for all LLIs
+ *
+ * @return The number of LLIs in the chain, 0 if they don't fit in \a lli
+ *
+ *****************************************************************************/
+uint32_t capture_sgpio_dma_BuildGather(capture_sgpio_dma_lli_t* lli, uint32_t maxLLIs,
+                                       uint32_t regAddr, const uint8_t* order,
+                                       uint32_t numSlices, uint32_t stagingAddr,
+                                       uint32_t control)
+{
+  uint32_t i;
+
+  if (numSlices == 0 || numSlices > CAPTURE_SGPIO_DMA_UNIT_WORDS || numSlices >= maxLLIs)
+  {
+    return 0;
+  }
+
+  control &= ~LLI_TRANSFER_SIZE_MASK;
+
+  for (i = 0; i < numSlices; i++)
+  {
+    lli[i].srcAddr = regAddr + order[i] * 4;
+    lli[i].dstAddr = stagingAddr + i * 4;
+    lli[i].nextLLI = (uint32_t)(uintptr_t)(&lli[i + 1]);
+    lli[i].control = control | 1;
+  }
+
+  lli[numSlices].srcAddr = stagingAddr;
+  lli[numSlices].dstAddr = 0;
+  lli[numSlices].nextLLI = 0;
+  lli[numSlices].control = control | numSlices;
+
+  return numSlices + 1;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Calculates the number of exchanges to collect after the trigger.
+ *
+ * The lower 8 bits of \a postFill specify the percent of the buffer that
+ * will be used for samples taken AFTER the trigger. The upper 24 bits
+ * specify the maximum number of exchanges to collect after the trigger.
+ *
+ * At least one exchange is collected after the trigger and at least five
+ * are kept before it as the "input bit interrupt" for the trigger seems
+ * to occur ca 3 exchanges after the value change.
+ *
+ * @param [in]  sampleLimit  Number of exchanges that fit in the buffer
+ * @param [in]  postFill     The post fill configuration
+ * @param [out] pPostFill    The number of exchanges to collect
+ *
+ * @return 0 on success, -1 if the percent is invalid
+ *
+ *****************************************************************************/
+int capture_sgpio_dma_PostFill(uint32_t sampleLimit, uint32_t postFill, uint32_t* pPostFill)
+{
+  uint32_t postFillPercent = postFill & 0xff;
+  uint32_t postFillSamples = (postFill >> 8) & 0xffffff;
+  uint32_t result;
+
+  if (postFillPercent > 100)
+  {
+    return -1;
+  }
+
+  // Apply percent limit
+  result = (sampleLimit * postFillPercent) / 100;
+
+  // Apply time limit
+  if (result > postFillSamples)
+  {
+    result = postFillSamples;
+  }
+
+  // Need at least one sample after the trigger is found
+  if (result < 1)
+  {
+    result = 1;
+  }
+
+  // Need at least five samples before the trigger is found
+  if (sampleLimit > 5 && result > sampleLimit - 5)
+  {
+    result = sampleLimit - 5;
+  }
+
+  *pPostFill = result;
+  return 0;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Puts the words copied by the DMA in the order the client expects.
+ *
+ * The buffer holds \a numUnits units of \ref CAPTURE_SGPIO_DMA_UNIT_WORDS
+ * words in slice order. Each unit is replaced by \a numOut words where
+ * word i is the unit's word \a order[i]. When \a numOut is less than a
+ * full unit the buffer shrinks, which is done in place as no unit is
+ * moved to a higher address.
+ *
+ * @param [in,out] data      The captured samples
+ * @param [in]     numUnits  Number of units in \a data
+ * @param [in]     order     Slice to take each output word from
+ * @param [in]     numOut    Number of output words per unit
+ *
+ * @return The size in bytes of the reordered samples
+ *
+ *****************************************************************************/
+uint32_t capture_sgpio_dma_Reorder(uint32_t* data, uint32_t numUnits,
+                                   const uint8_t* order, uint32_t numOut)
+{
+  uint32_t unit[CAPTURE_SGPIO_DMA_UNIT_WORDS];
+  uint32_t u;
+  uint32_t i;
+
+  if (numOut > CAPTURE_SGPIO_DMA_UNIT_WORDS)
+  {
+    return 0;
+  }
+
+  for (u = 0; u < numUnits; u++)
+  {
+    const uint32_t* pIn = data + u * CAPTURE_SGPIO_DMA_UNIT_WORDS;
+    uint32_t* pOut = data + u * numOut;
+
+    for (i = 0; i < CAPTURE_SGPIO_DMA_UNIT_WORDS; i++)
+    {
+      unit[i] = pIn[i];
+    }
+    for (i = 0; i < numOut; i++)
+    {
+      pOut[i] = unit[order[i]];
+    }
+  }
+
+  return numUnits * numOut * 4;
+}
@@ -0,0 +1,165 @@
+/*!
+ * @file
+ * @brief   Per capture telemetry sent to the client with the samples
+ * @ingroup FUNC_CAP
+ *
+ * The captured analog samples are scanned once before they are sent to the
+ * client and a compact summary is built with the number of skipped and empty
+ * samples as well as min/max/sum and a coarse histogram for each channel.
+ * The summary is sent together with the samples so that problems with the
+ * analog sampling can be seen in the client software without a debugger.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "capture_telemetry.h"
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Set in an analog sample that does not hold a value */
+#define VADC_EMPTY_MARKER  0x8000
+
+/*! Extracts the channel from an analog sample */
+#define VADC_CHANNEL(__s)  (((__s) >> 12) & 0x7)
+
+/*! Extracts the value from an analog sample */
+#define VADC_VALUE(__s)    ((__s) & 0xfff)
+
+/*! Used as the previous channel before the first sample has been seen */
+#define NO_CHANNEL         0xff
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Adds a run of consecutive analog samples to the telemetry
+ *
+ * @param [in,out] t             The telemetry to update
+ * @param [in]     numChannels   Number of interleaved channels
+ * @param [in]     samples       The samples
+ * @param [in]     count         Number of samples
+ * @param [in,out] pPrevChannel  Channel of the sample before this run
+ *
+ *****************************************************************************/
+static void capture_telemetry_AddRun(capture_telemetry_t* t, uint32_t numChannels,
+                                     const uint16_t* samples, uint32_t count,
+                                     uint32_t* pPrevChannel)
+{
+  capture_telemetry_channel_t* c;
+  uint32_t prev = *pPrevChannel;
+  uint32_t ch;
+  uint32_t val;
+  uint16_t s;
+  uint32_t i;
+
+  for (i = 0; i < count; i++)
+  {
+    s = samples[i];
+    if (s & VADC_EMPTY_MARKER)
+    {
+      t->emptySamples++;
+      continue;
+    }
+
+    // With two channels the samples alternate between them so two in
+    // a row from the same channel means that samples were skipped.
+    ch = VADC_CHANNEL(s);
+    if (numChannels == 2 && ch == prev)
+    {
+      t->skippedSamples++;
+    }
+    prev = ch;
+
+    if (ch >= CAPTURE_TELEMETRY_CHANNELS)
+    {
+      continue;
+    }
+
+    val = VADC_VALUE(s);
+    c = &t->ch[ch];
+    if (c->numSamples == 0 || val < c->min)
+    {
+      c->min = val;
+    }
+    if (val > c->max)
+    {
+      c->max = val;
+    }
+    c->sum += val;
+    c->numSamples++;
+    c->hist[val >> 8]++;
+  }
+
+  *pPrevChannel = prev;
+}
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Clears the telemetry before a new capture is summarized
+ *
+ * @param [out] t  The telemetry
+ *
+ *****************************************************************************/
+void capture_telemetry_Init(capture_telemetry_t* t)
+{
+  memset(t, 0, sizeof(capture_telemetry_t));
+  t->digitalTrigLatency = CAPTURE_TELEMETRY_NO_LATENCY;
+  t->analogTrigLatency = CAPTURE_TELEMETRY_NO_LATENCY;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Summarizes the captured analog samples.
+ *
+ * The samples are 16 bits each with the value in bits 0-11, the channel
+ * number in bits 12-14 and the empty marker in bit 15. A circular buffer
+ * that has wrapped is passed as two parts, the oldest samples in \a first
+ * and the rest in \a second, so that the skipped samples are counted
+ * correctly across the wrap.
+ *
+ * @param [in,out] t            The telemetry to update
+ * @param [in]     numChannels  Number of interleaved channels (1 or 2)
+ * @param [in]     first        The oldest samples
+ * @param [in]     firstCount   Number of samples in \a first
+ * @param [in]     second       The newest samples, can be NULL if \a secondCount is 0
+ * @param [in]     secondCount  Number of samples in \a second
+ *
+ *****************************************************************************/
+void capture_telemetry_AddAnalog(capture_telemetry_t* t, uint32_t numChannels,
+                                 const uint16_t* first, uint32_t firstCount,
+                                 const uint16_t* second, uint32_t secondCount)
+{
+  uint32_t prev = NO_CHANNEL;
+
+  capture_telemetry_AddRun(t, numChannels, first, firstCount, &prev);
+  capture_telemetry_AddRun(t, numChannels, second, secondCount, &prev);
+}
@@ -0,0 +1,348 @@
+/*!
+ * @file
+ * @brief   Locating the exact trigger sample in captured data
+ * @ingroup FUNC_CAP
+ *
+ * The interrupt that detects a trigger only knows roughly where in the
+ * captured data the trigger is. For digital signals it is somewhere in the
+ * words being shifted in by the SGPIO and for analog signals it is somewhere
+ * in the VADC FIFO that the DMA has not yet copied. Once the capture has
+ * completed the functions here look through the data close to that estimate
+ * and find the sample where the edge actually is, so that the client
+ * software does not have to search for it.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_trigger.h"
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Set in an analog sample that does not hold a value */
+#define VADC_EMPTY_MARKER  0x8000
+
+/*! Extracts the channel from an analog sample */
+#define VADC_CHANNEL(__s)  (((__s) >> 12) & 0x7)
+
+/*! Extracts the value from an analog sample */
+#define VADC_VALUE(__s)    ((__s) & 0xfff)
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Reads one 32-bit word from the straightened-out buffer
+ *
+ * @param [in] buff     The buffer
+ * @param [in] wordIdx  Index of the word
+ *
+ * @return The word
+ *
+ *****************************************************************************/
+static uint32_t capture_trigger_Word(const capture_trigger_buffer_t* buff, uint32_t wordIdx)
+{
+  return *((const uint32_t*)(buff->data + ((buff->first + wordIdx * 4) % buff->size)));
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Reads one analog value from the straightened-out buffer
+ *
+ * @param [in]  buff         The buffer
+ * @param [in]  sample       Index of the sample
+ * @param [in]  numChannels  Number of interleaved channels
+ * @param [in]  channel      The channel to read
+ * @param [out] pValue       The 12-bit value
+ *
+ * @return Non-zero if the value could be read
+ *
+ *****************************************************************************/
+static int capture_trigger_AnalogValue(const capture_trigger_buffer_t* buff, uint32_t sample,
+                                       uint32_t numChannels, uint32_t channel, uint32_t* pValue)
+{
+  uint32_t i;
+  uint16_t s;
+
+  for (i = 0; i < numChannels; i++)
+  {
+    s = *((const uint16_t*)(buff->data + ((buff->first + (sample * numChannels + i) * 2) % buff->size)));
+    if (s & VADC_EMPTY_MARKER)
+    {
+      return 0;
+    }
+    if (VADC_CHANNEL(s) == channel)
+    {
+      *pValue = VADC_VALUE(s);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Finds the first or last digital edge in a range of samples
+ *
+ * Each word holds 32 samples with the oldest in the least significant bit
+ * so the edges in a word are found by comparing it with itself shifted one
+ * step, carrying in the last sample from the previous word.
+ *
+ * @param [in] buff           The buffer
+ * @param [in] wordsPerGroup  Number of words for each 32 samples
+ * @param [in] channel        Which of the words in a group to look in
+ * @param [in] rising         Non-zero for rising edges, zero for falling
+ * @param [in] from           First sample to consider
+ * @param [in] to             Sample after the last one to consider
+ * @param [in] wantLast       Non-zero to return the last edge instead of the first
+ *
+ * @return The sample index of the edge or \ref CAPTURE_TRIGGER_UNKNOWN
+ *
+ *****************************************************************************/
+static uint32_t capture_trigger_DigitalEdgeInRange(const capture_trigger_buffer_t* buff,
+                                                   uint32_t wordsPerGroup, uint32_t channel, int rising,
+                                                   uint32_t from, uint32_t to, int wantLast)
+{
+  uint32_t found = CAPTURE_TRIGGER_UNKNOWN;
+  uint32_t group;
+  uint32_t word;
+  uint32_t prev;
+  uint32_t edges;
+  uint32_t bit;
+
+  if (from >= to)
+  {
+    return found;
+  }
+
+  for (group = from / 32; group <= (to - 1) / 32; group++)
+  {
+    word = capture_trigger_Word(buff, group * wordsPerGroup + channel);
+    if (group == 0)
+    {
+      // no sample before the first one so it cannot be an edge
+      prev = word & 1;
+    }
+    else
+    {
+      prev = capture_trigger_Word(buff, (group - 1) * wordsPerGroup + channel) >> 31;
+    }
+
+    edges = word ^ ((word << 1) | prev);
+    edges &= rising ? word : ~word;
+
+    for (bit = 0; bit < 32; bit++)
+    {
+      uint32_t sample = group * 32 + bit;
+      if ((edges & (1UL << bit)) && (sample >= from) && (sample < to))
+      {
+        found = sample;
+        if (!wantLast)
+        {
+          return found;
+        }
+      }
+    }
+  }
+  return found;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Finds the first or last analog threshold crossing in a range of samples
+ *
+ * @param [in] buff         The buffer
+ * @param [in] numChannels  Number of interleaved channels
+ * @param [in] channel      The channel to look at
+ * @param [in] level        The 12-bit threshold
+ * @param [in] rising       Non-zero for upward crossings, zero for downward
+ * @param [in] from         First sample to consider
+ * @param [in] to           Sample after the last one to consider
+ * @param [in] wantLast     Non-zero to return the last crossing instead of the first
+ *
+ * @return The sample index of the first sample past the threshold or
+ *         \ref CAPTURE_TRIGGER_UNKNOWN if there is no crossing or if the
+ *         samples are not evenly interleaved
+ *
+ *****************************************************************************/
+static uint32_t capture_trigger_AnalogCrossingInRange(const capture_trigger_buffer_t* buff,
+                                                      uint32_t numChannels, uint32_t channel,
+                                                      uint32_t level, int rising,
+                                                      uint32_t from, uint32_t to, int wantLast)
+{
+  uint32_t found = CAPTURE_TRIGGER_UNKNOWN;
+  uint32_t sample;
+  uint32_t prev;
+  uint32_t cur;
+
+  if (from == 0)
+  {
+    from = 1;
+  }
+  if (from >= to || !capture_trigger_AnalogValue(buff, from - 1, numChannels, channel, &prev))
+  {
+    return CAPTURE_TRIGGER_UNKNOWN;
+  }
+
+  for (sample = from; sample < to; sample++)
+  {
+    if (!capture_trigger_AnalogValue(buff, sample, numChannels, channel, &cur))
+    {
+      return CAPTURE_TRIGGER_UNKNOWN;
+    }
+    if (rising ? (prev < level && cur >= level) : (prev > level && cur <= level))
+    {
+      found = sample;
+      if (!wantLast)
+      {
+        return found;
+      }
+    }
+    prev = cur;
+  }
+  return found;
+}
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Finds the digital edge that caused a trigger.
+ *
+ * The data is organized in groups of \a wordsPerGroup words, one word per
+ * copied DIO and 32 samples in each word.
+ *
+ * The trigger is reported while the samples are still being shifted in so
+ * the first edge in the \a after samples starting at \a estimate is used.
+ * If there is no such edge (the samples were copied before the trigger
+ * interrupt was handled) the last edge in the \a before samples preceding
+ * \a estimate is used instead.
+ *
+ * @param [in] buff           The captured data
+ * @param [in] wordsPerGroup  Number of words for each 32 samples
+ * @param [in] channel        Index of the triggering DIO's word in a group
+ * @param [in] rising         Non-zero for a rising edge, zero for falling
+ * @param [in] estimate       The sample where the trigger was reported
+ * @param [in] before         Number of samples before \a estimate to look at
+ * @param [in] after          Number of samples from \a estimate to look at
+ *
+ * @return The index of the first sample after the edge or
+ *         \ref CAPTURE_TRIGGER_UNKNOWN if no edge was found
+ *
+ *****************************************************************************/
+uint32_t capture_trigger_FindDigitalEdge(const capture_trigger_buffer_t* buff,
+                                         uint32_t wordsPerGroup, uint32_t channel, int rising,
+                                         uint32_t estimate, uint32_t before, uint32_t after)
+{
+  uint32_t numSamples;
+  uint32_t found;
+
+  if (buff->size == 0 || wordsPerGroup == 0 || channel >= wordsPerGroup)
+  {
+    return CAPTURE_TRIGGER_UNKNOWN;
+  }
+
+  numSamples = (buff->used / (4 * wordsPerGroup)) * 32;
+  if (estimate >= numSamples)
+  {
+    return CAPTURE_TRIGGER_UNKNOWN;
+  }
+
+  found = capture_trigger_DigitalEdgeInRange(buff, wordsPerGroup, channel, rising,
+                                             estimate,
+                                             (numSamples - estimate > after) ? (estimate + after) : numSamples,
+                                             0);
+  if (found == CAPTURE_TRIGGER_UNKNOWN)
+  {
+    found = capture_trigger_DigitalEdgeInRange(buff, wordsPerGroup, channel, rising,
+                                               (estimate > before) ? (estimate - before) : 0,
+                                               estimate,
+                                               1);
+  }
+  return found;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Finds the analog threshold crossing that caused a trigger.
+ *
+ * The samples are 16 bits each with the channel number in bits 12-14 and
+ * \a numChannels channels interleaved.
+ *
+ * The trigger is reported when the DMA has not yet copied the crossing from
+ * the VADC FIFO so the first crossing in the \a after samples starting at
+ * \a estimate is used. If there is no such crossing the last one in the
+ * \a before samples preceding \a estimate is used instead.
+ *
+ * Note that the VADC values are inverted compared to the input voltage so
+ * a falling edge on the input is an upward crossing of the values.
+ *
+ * @param [in] buff         The captured data
+ * @param [in] numChannels  Number of interleaved channels (1 or 2)
+ * @param [in] channel      The triggering channel
+ * @param [in] level        The 12-bit trigger level
+ * @param [in] rising       Non-zero for upward crossings, zero for downward
+ * @param [in] estimate     The sample where the trigger was reported
+ * @param [in] before       Number of samples before \a estimate to look at
+ * @param [in] after        Number of samples from \a estimate to look at
+ *
+ * @return The index of the first sample past the threshold or
+ *         \ref CAPTURE_TRIGGER_UNKNOWN if no crossing was found
+ *
+ *****************************************************************************/
+uint32_t capture_trigger_FindAnalogCrossing(const capture_trigger_buffer_t* buff,
+                                            uint32_t numChannels, uint32_t channel,
+                                            uint32_t level, int rising,
+                                            uint32_t estimate, uint32_t before, uint32_t after)
+{
+  uint32_t numSamples;
+  uint32_t found;
+
+  if (buff->size == 0 || numChannels == 0)
+  {
+    return CAPTURE_TRIGGER_UNKNOWN;
+  }
+
+  numSamples = buff->used / (2 * numChannels);
+  if (estimate >= numSamples)
+  {
+    return CAPTURE_TRIGGER_UNKNOWN;
+  }
+
+  found = capture_trigger_AnalogCrossingInRange(buff, numChannels, channel, level, rising,
+                                                estimate,
+                                                (numSamples - estimate > after) ? (estimate + after) : numSamples,
+                                                0);
+  if (found == CAPTURE_TRIGGER_UNKNOWN)
+  {
+    found = capture_trigger_AnalogCrossingInRange(buff, numChannels, channel, level, rising,
+                                                  (estimate > before) ? (estimate - before) : 0,
+                                                  estimate,
+                                                  1);
+  }
+  return found;
+}
@@ -39,6 +39,9 @@
 #include "log.h"
 #include "capture_vadc.h"
 #include "capture_sgpio.h"
+#include "capture_buffers.h"
+#include "capture_trigger.h"
+#include "capture_peek.h"
 #include "meas.h"
 #include "spi_control.h"
 
@@ -169,6 +172,10 @@ static circbuff_t* pSampleBuffer = NULL;
 
 static internal_vadc_cfg_t activeCfg;
 
+/*! Changes from \ref cap_vadc_Update, applied at the next arming */
+static cap_vadc_cfg_t pendingCfg;
+static Bool pendingUpdate = FALSE;
+
 /*! The number of LLIs is important as the transfer size for each
     LLI must be an even multiple of the FIFO size. E.g. by using
     21 instead of 20 the "extra" size on the last LLI is reduced:
@@ -182,6 +189,12 @@ static internal_vadc_cfg_t activeCfg;
     must be 3120 + 16 = 3136
 */
 #define DMA_NUM_LLI_TO_USE    21
+
+/* The buffer partitioning in capture_buffers.c relies on the LLI layout */
+#if ((FIFO_SIZE != CAPTURE_BUFFERS_VADC_FIFO_SIZE) || (DMA_NUM_LLI_TO_USE != CAPTURE_BUFFERS_VADC_NUM_LLI))
+  #error "CAPTURE_BUFFERS_VADC_* must match the DMA setup in VADC_SetupDMA"
+#endif
+
 static GPDMA_LLI_Type DMA_Stuff[DMA_NUM_LLI_TO_USE];
 static uint32_t post_fill_llis = 0;
 
@@ -189,6 +202,8 @@ static uint32_t post_fill_llis = 0;
  * Forward Declarations of Local Functions
  *****************************************************************************/
 
+static uint32_t VADC_FindExactTrigger(uint32_t triggerSample);
+
 /******************************************************************************
  * Global Functions
  *****************************************************************************/
@@ -259,6 +274,7 @@ void DMA_IRQHandler (void)
           pSampleBuffer,
           0, // <-- ch that caused trigger, probably useless for VADC?
           triggeredSampleAddr / activeCfg.sample_size, // <-- want sample index, not an address
+          activeCfg.forcedTrigger ? CAPTURE_TRIGGER_UNKNOWN : VADC_FindExactTrigger(triggeredSampleAddr / activeCfg.sample_size),
           activeCfg.from_client.enabledChannels | (activeCfg.numEnabledChannels << 16));
       }
     }
@@ -445,6 +461,59 @@ void VADC_IRQHandler_NoiseReduction(void)
  * Local Functions
  *****************************************************************************/
 
+/**************************************************************************//**
+ *
+ * @brief  Finds the sample where the trigger level was crossed.
+ *
+ * When the trigger interrupt fires the crossing is still in the VADC FIFO
+ * so  triggerSample (the DMA's position at that time) is a bit before the
+ * actual crossing. This looks through the captured data around that position
+ * for the crossing.
+ *
+ * @param [in] triggerSample  Sample index in the straightened-out buffer
+ *                            where the trigger was found
+ *
+ * @return The trigger sample in the straightened-out buffer or
+ *         CAPTURE_TRIGGER_UNKNOWN if it could not be found
+ *
+ *****************************************************************************/
+static uint32_t VADC_FindExactTrigger(uint32_t triggerSample)
+{
+  capture_trigger_buffer_t buff;
+  uint32_t ch;
+  uint32_t level;
+  uint32_t edge;
+
+  if (activeCfg.from_client.enabledTriggers & 1)
+  {
+    ch = LAST_CH_1;
+    level = activeCfg.from_client.triggerSetup & 0xfff;
+    edge = (activeCfg.from_client.triggerSetup >> 14) & 0x3;
+  }
+  else if (activeCfg.from_client.enabledTriggers & 2)
+  {
+    ch = LAST_CH_2;
+    level = (activeCfg.from_client.triggerSetup >> 16) & 0xfff;
+    edge = (activeCfg.from_client.triggerSetup >> 30) & 0x3;
+  }
+  else
+  {
+    // triggered by SGPIO
+    return CAPTURE_TRIGGER_UNKNOWN;
+  }
+
+  buff.data  = pSampleBuffer->data;
+  buff.size  = pSampleBuffer->size;
+  buff.first = circbuff_GetFirstAddr(pSampleBuffer) - (uint32_t)pSampleBuffer->data;
+  buff.used  = circbuff_GetUsedSize(pSampleBuffer);
+
+  // The VADC values are inverted so a falling edge (1) on the input is an
+  // increasing value in the buffer.
+  return capture_trigger_FindAnalogCrossing(&buff, activeCfg.numEnabledChannels, ch, level,
+                                            (edge == 1), triggerSample,
+                                            4 * FIFO_SIZE, 4 * FIFO_SIZE);
+}
+
 /**************************************************************************//**
  *
  * @brief  Reconfigures and enables DMA
@@ -1090,6 +1159,40 @@ static cmd_status_t VADC_ValidateTriggerLevels(cap_vadc_cfg_t* cfg)
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Applies the changes from \ref cap_vadc_Update (if any)
+ *
+ * The new trigger levels and edges are used by \ref VADC_Init. The relays for
+ * V/div and coupling are only switched, and waited for, if they have changed.
+ *
+ *****************************************************************************/
+static void VADC_ApplyUpdate(void)
+{
+  Bool relaysChanged;
+
+  if (!pendingUpdate)
+  {
+    return;
+  }
+  pendingUpdate = FALSE;
+
+  relaysChanged = (pendingCfg.voltPerDiv != activeCfg.from_client.voltPerDiv) ||
+                  (pendingCfg.couplings != activeCfg.from_client.couplings);
+
+  memcpy(&activeCfg.from_client, &pendingCfg, sizeof(cap_vadc_cfg_t));
+
+  if (relaysChanged)
+  {
+    // Already validated by cap_vadc_Update so they cannot fail
+    VADC_SetupVoltsPerDiv(&activeCfg.from_client);
+    VADC_SetupCoupling(&activeCfg.from_client);
+
+    // Same settle time as in cap_vadc_Configure
+    TIM_Waitms(100);
+  }
+}
+
 /******************************************************************************
  * Public Functions
  *****************************************************************************/
@@ -1132,6 +1235,7 @@ cmd_status_t cap_vadc_Configure(circbuff_t* buff, cap_vadc_cfg_t* cfg, uint32_t
   pSampleBuffer = buff;
   activeCfg.valid = FALSE;
   activeCfg.forcedTrigger = forceTrigger;
+  pendingUpdate = FALSE;
 
   memcpy(&activeCfg.from_client, cfg, sizeof(cap_vadc_cfg_t));
 
@@ -1239,6 +1343,59 @@ cmd_status_t cap_vadc_Configure(circbuff_t* buff, cap_vadc_cfg_t* cfg, uint32_t
 }
 
 
+/**************************************************************************//**
+ *
+ * @brief  Changes the trigger and input settings of a configured capture.
+ *
+ * Only the trigger levels and edges, the V/div and the couplings can be
+ * changed. The channels and which of them that trigger must remain the same
+ * as a change there needs a new configuration. The changes are validated
+ * now but are not applied until the next time the capture is armed, so an
+ * ongoing capture is not affected and all changes take effect together.
+ *
+ * @param [in] cfg   Configuration with the new settings
+ *
+ * @retval CMD_STATUS_OK      If the changes will be applied at the next arming
+ * @retval CMD_STATUS_ERR_*   If the changes are invalid
+ *
+ *****************************************************************************/
+cmd_status_t cap_vadc_Update(const cap_vadc_cfg_t* cfg)
+{
+  cap_vadc_cfg_t tmp;
+  cmd_status_t result;
+  int ch;
+
+  if (!activeCfg.valid ||
+      (cfg->enabledChannels != activeCfg.from_client.enabledChannels) ||
+      (cfg->enabledTriggers != activeCfg.from_client.enabledTriggers))
+  {
+    return CMD_STATUS_ERR;
+  }
+
+  memcpy(&tmp, &activeCfg.from_client, sizeof(cap_vadc_cfg_t));
+  tmp.triggerSetup = cfg->triggerSetup;
+  tmp.voltPerDiv = cfg->voltPerDiv;
+  tmp.couplings = cfg->couplings;
+
+  for (ch = 0; ch < 2; ch++)
+  {
+    if ((tmp.enabledChannels & (1<<ch)) && (((tmp.voltPerDiv >> (ch*4)) & 0xf) >= 8))
+    {
+      return CMD_STATUS_ERR_INVALID_VDIV;
+    }
+  }
+
+  result = VADC_ValidateTriggerLevels(&tmp);
+  if (result != CMD_STATUS_OK)
+  {
+    return result;
+  }
+
+  memcpy(&pendingCfg, &tmp, sizeof(cap_vadc_cfg_t));
+  pendingUpdate = TRUE;
+  return CMD_STATUS_OK;
+}
+
 /**************************************************************************//**
  *
  * @brief  Do all time consuming parts of arming.
@@ -1259,6 +1416,8 @@ cmd_status_t cap_vadc_PrepareToArm(void)
     return CMD_STATUS_ERR;
   }
 
+  VADC_ApplyUpdate();
+
   circbuff_addr = (uint32_t*)pSampleBuffer->data;
 
   circbuff_Reset(pSampleBuffer);
@@ -1355,6 +1514,72 @@ void inline cap_vadc_Triggered(void)
   }
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Tells if the capture is armed and still waiting for its trigger
+ *
+ * @return TRUE if armed and not yet triggered, FALSE otherwise
+ *
+ *****************************************************************************/
+Bool cap_vadc_IsWaitingForTrigger(void)
+{
+  return (started && !triggered) ? TRUE : FALSE;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Makes a preview of the ongoing capture
+ *
+ * Takes every \a step sample of the most recently captured data, see
+ * \ref capture_peek_Analog. The position is read from the DMA's current
+ * destination address and nothing is changed so the capture is not
+ * affected.
+ *
+ * @param [in]  step          Number of captured samples per preview sample
+ * @param [out] pDest         Where to write the preview
+ * @param [in]  maxSize       Size of \a pDest in bytes
+ * @param [out] pChannelInfo  The channels in the preview, same format as for the captured samples
+ *
+ * @return The number of bytes written to \a pDest, 0 if there is no ongoing capture
+ *
+ *****************************************************************************/
+uint32_t cap_vadc_Peek(uint32_t step, uint16_t* pDest, uint32_t maxSize, uint32_t* pChannelInfo)
+{
+  capture_trigger_buffer_t buff;
+  uint32_t pos;
+
+  if (!started || !activeCfg.valid || (LPC_GPDMA->C0CONFIG & 1) == 0)
+  {
+    // not armed or already done
+    return 0;
+  }
+
+  pos = LPC_GPDMA->C0DESTADDR - ((uint32_t)circbuff_addr);
+  pos = (pos / activeCfg.sample_size) * activeCfg.sample_size;
+  if (pos >= pSampleBuffer->size)
+  {
+    pos = 0;
+  }
+
+  buff.data = pSampleBuffer->data;
+  buff.size = pSampleBuffer->size;
+  if (!pSampleBuffer->empty)
+  {
+    // has wrapped at least once so the oldest data is at the write position
+    buff.first = pos;
+    buff.used  = buff.size;
+  }
+  else
+  {
+    buff.first = 0;
+    buff.used  = pos;
+  }
+
+  *pChannelInfo = activeCfg.from_client.enabledChannels | (activeCfg.numEnabledChannels << 16);
+
+  return capture_peek_Analog(&buff, activeCfg.numEnabledChannels, step, pDest, maxSize);
+}
+
 /**************************************************************************//**
  *
  * @brief  Returns the used current volts/div setting for a channel
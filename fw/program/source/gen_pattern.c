@@ -0,0 +1,428 @@
+/*!
+ * @file
+ * @brief   Encoding and expansion of compressed digital generator patterns
+ * @ingroup FUNC_GEN
+ *
+ * A pattern is a sequence of blocks where each block holds 32 states for
+ * each of the enabled channels. Long patterns are normally very repetitive
+ * (idle bus levels, clocks, repeated frames) so instead of sending every
+ * block the client software sends a list of records:
+ *
+ *     LITERAL(n)  followed by n blocks
+ *     REPEAT(n)   followed by one block that is output n times
+ *     GROUP(n)    followed by the group size in words and then the records
+ *                 in the group, all of it output n times
+ *
+ * The same code is used by the client software to create the records and by
+ * the firmware to expand them, one block at a time, into the DMA buffers.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "gen_pattern.h"
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+/*! Largest number of blocks that a pattern may expand to */
+#define MAX_TOTAL_BLOCKS  0xffffffffULL
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Encodes blocks as literal and repeat records.
+ *
+ * @param [in]  pBlocks    The blocks to encode
+ * @param [in]  numBlocks  Number of blocks in \a pBlocks
+ * @param [in]  blockSize  Number of words in each block
+ * @param [out] data       Where to put the records
+ * @param [in]  maxWords   Size of \a data in words
+ *
+ * @return The number of words written to \a data or 0 if it did not fit
+ *
+ *****************************************************************************/
+static uint32_t gen_pattern_EncodeRuns(const uint32_t* pBlocks, uint32_t numBlocks, uint32_t blockSize,
+                                       uint32_t* data, uint32_t maxWords)
+{
+  uint32_t used = 0;
+  uint32_t i = 0;
+  uint32_t run;
+  uint32_t literalHdr = 0;
+  uint32_t literalCount = 0;
+  const uint32_t blockBytes = blockSize * sizeof(uint32_t);
+
+  while (i < numBlocks)
+  {
+    const uint32_t* pBlock = &pBlocks[i * blockSize];
+
+    run = 1;
+    while ((i + run) < numBlocks && run < GEN_PATTERN_MAX_COUNT &&
+           memcmp(pBlock, &pBlocks[(i + run) * blockSize], blockBytes) == 0)
+    {
+      run++;
+    }
+
+    if (run > 1)
+    {
+      if ((maxWords - used) < (1 + blockSize))
+      {
+        return 0;
+      }
+      data[used++] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_REPEAT, run);
+      memcpy(&data[used], pBlock, blockBytes);
+      used += blockSize;
+      literalCount = 0;
+      i += run;
+    }
+    else
+    {
+      if (literalCount == 0 || literalCount == GEN_PATTERN_MAX_COUNT)
+      {
+        if (used == maxWords)
+        {
+          return 0;
+        }
+        literalHdr = used++;
+        literalCount = 0;
+      }
+      if ((maxWords - used) < blockSize)
+      {
+        return 0;
+      }
+      memcpy(&data[used], pBlock, blockBytes);
+      used += blockSize;
+      literalCount++;
+      data[literalHdr] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_LITERAL, literalCount);
+      i++;
+    }
+  }
+  return used;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Finds the shortest sequence of blocks that repeated makes up all blocks.
+ *
+ * @param [in]  pBlocks    The blocks to search
+ * @param [in]  numBlocks  Number of blocks in \a pBlocks
+ * @param [in]  blockSize  Number of words in each block
+ *
+ * @return The length of the period in blocks, \a numBlocks if not periodic
+ *
+ *****************************************************************************/
+static uint32_t gen_pattern_FindPeriod(const uint32_t* pBlocks, uint32_t numBlocks, uint32_t blockSize)
+{
+  uint32_t period;
+
+  for (period = 1; period <= (numBlocks / 2); period++)
+  {
+    if ((numBlocks % period) == 0 &&
+        memcmp(pBlocks, &pBlocks[period * blockSize], (numBlocks - period) * blockSize * sizeof(uint32_t)) == 0)
+    {
+      return period;
+    }
+  }
+  return numBlocks;
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Checks that an encoded pattern is well formed.
+ *
+ * All records must be complete, have a non-zero count and a group must
+ * neither be empty nor nested. This must be called before expanding a
+ * pattern that comes from the client as the expansion does no checking.
+ *
+ * @param [in] data       The encoded pattern
+ * @param [in] numWords   Size of \a data in words
+ * @param [in] blockSize  Number of words in each block
+ *
+ * @return The number of blocks the pattern expands to or 0 if invalid
+ *
+ *****************************************************************************/
+uint32_t gen_pattern_Validate(const uint32_t* data, uint32_t numWords, uint32_t blockSize)
+{
+  uint64_t total = 0;
+  uint64_t groupTotal = 0;
+  uint32_t groupEnd = 0;
+  uint32_t groupCount = 0;
+  uint32_t pos = 0;
+  uint32_t hdr, count, words, len;
+
+  if (blockSize == 0 || blockSize > GEN_PATTERN_MAX_CHANNELS)
+  {
+    return 0;
+  }
+
+  for (;;)
+  {
+    if (groupEnd != 0 && pos == groupEnd)
+    {
+      if (groupTotal == 0)
+      {
+        return 0;
+      }
+      total += groupTotal * groupCount;
+      groupEnd = 0;
+    }
+    if (total > MAX_TOTAL_BLOCKS)
+    {
+      return 0;
+    }
+    if (pos >= numWords)
+    {
+      break;
+    }
+
+    hdr = data[pos++];
+    count = GEN_PATTERN_COUNT(hdr);
+    if (count == 0)
+    {
+      return 0;
+    }
+
+    switch (GEN_PATTERN_OP(hdr))
+    {
+      case GEN_PATTERN_OP_LITERAL:
+        words = count * blockSize;
+        break;
+
+      case GEN_PATTERN_OP_REPEAT:
+        words = blockSize;
+        break;
+
+      case GEN_PATTERN_OP_GROUP:
+        if (groupEnd != 0 || pos >= numWords)
+        {
+          return 0;
+        }
+        len = data[pos++];
+        if (len == 0 || len > (numWords - pos))
+        {
+          return 0;
+        }
+        groupEnd = pos + len;
+        groupCount = count;
+        groupTotal = 0;
+        continue;
+
+      default:
+        return 0;
+    }
+
+    if (words > (numWords - pos) || (groupEnd != 0 && (pos + words) > groupEnd))
+    {
+      return 0;
+    }
+    pos += words;
+
+    if (groupEnd != 0)
+    {
+      groupTotal += count;
+    }
+    else
+    {
+      total += count;
+    }
+  }
+
+  return (uint32_t)total;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Prepares for expansion of an encoded pattern.
+ *
+ * @param [out] cursor     The expansion state
+ * @param [in]  data       The encoded pattern, must have been validated
+ * @param [in]  numWords   Size of \a data in words
+ * @param [in]  blockSize  Number of words in each block
+ *
+ *****************************************************************************/
+void gen_pattern_Start(gen_pattern_cursor_t* cursor, const uint32_t* data, uint32_t numWords, uint32_t blockSize)
+{
+  memset(cursor, 0, sizeof(gen_pattern_cursor_t));
+  cursor->data = data;
+  cursor->numWords = numWords;
+  cursor->blockSize = blockSize;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Expands the next block of the pattern.
+ *
+ * This function is fast enough to be called from an interrupt handler as
+ * it only copies \a blockSize words and moves past at most a couple of
+ * record headers.
+ *
+ * @param [in,out] cursor  The expansion state
+ * @param [out]    pBlock  Where to put the \a blockSize words of the block
+ *
+ * @return 1 if a block was expanded, 0 at the end of the pattern
+ *
+ *****************************************************************************/
+int gen_pattern_NextBlock(gen_pattern_cursor_t* cursor, uint32_t* pBlock)
+{
+  uint32_t hdr, i;
+
+  while (cursor->left == 0)
+  {
+    if (cursor->groupEnd != 0 && cursor->pos >= cursor->groupEnd)
+    {
+      if (--cursor->groupLeft > 0)
+      {
+        cursor->pos = cursor->groupStart;
+      }
+      else
+      {
+        cursor->groupEnd = 0;
+      }
+      continue;
+    }
+    if (cursor->pos >= cursor->numWords)
+    {
+      return 0;
+    }
+
+    hdr = cursor->data[cursor->pos++];
+    switch (GEN_PATTERN_OP(hdr))
+    {
+      case GEN_PATTERN_OP_LITERAL:
+        cursor->left = GEN_PATTERN_COUNT(hdr);
+        cursor->repeat = 0;
+        cursor->block = cursor->pos;
+        cursor->pos += cursor->left * cursor->blockSize;
+        break;
+
+      case GEN_PATTERN_OP_REPEAT:
+        cursor->left = GEN_PATTERN_COUNT(hdr);
+        cursor->repeat = 1;
+        cursor->block = cursor->pos;
+        cursor->pos += cursor->blockSize;
+        break;
+
+      case GEN_PATTERN_OP_GROUP:
+        cursor->groupLeft = GEN_PATTERN_COUNT(hdr);
+        cursor->groupStart = cursor->pos + 1;
+        cursor->groupEnd = cursor->groupStart + cursor->data[cursor->pos];
+        cursor->pos = cursor->groupStart;
+        break;
+
+      default:
+        return 0;
+    }
+  }
+
+  for (i = 0; i < cursor->blockSize; i++)
+  {
+    pBlock[i] = cursor->data[cursor->block + i];
+  }
+  if (!cursor->repeat)
+  {
+    cursor->block += cursor->blockSize;
+  }
+  cursor->left--;
+
+  return 1;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Expands an encoded pattern.
+ *
+ * @param [in]  data       The encoded pattern, must have been validated
+ * @param [in]  numWords   Size of \a data in words
+ * @param [in]  blockSize  Number of words in each block
+ * @param [out] pBlocks    Where to put the expanded blocks
+ * @param [in]  maxBlocks  Number of blocks that fit in \a pBlocks
+ *
+ * @return The number of expanded blocks
+ *
+ *****************************************************************************/
+uint32_t gen_pattern_Expand(const uint32_t* data, uint32_t numWords, uint32_t blockSize, uint32_t* pBlocks, uint32_t maxBlocks)
+{
+  gen_pattern_cursor_t cursor;
+  uint32_t n = 0;
+
+  gen_pattern_Start(&cursor, data, numWords, blockSize);
+  while (n < maxBlocks && gen_pattern_NextBlock(&cursor, &pBlocks[n * blockSize]))
+  {
+    n++;
+  }
+  return n;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Encodes a sequence of blocks.
+ *
+ * If the blocks consist of a shorter sequence repeated a number of times
+ * then that sequence is encoded once inside a group. Runs of identical
+ * blocks become repeat records and everything else literal records.
+ *
+ * @param [in]  pBlocks    The blocks to encode
+ * @param [in]  numBlocks  Number of blocks in \a pBlocks
+ * @param [in]  blockSize  Number of words in each block
+ * @param [out] data       Where to put the encoded pattern
+ * @param [in]  maxWords   Size of \a data in words
+ *
+ * @return The number of words in the encoded pattern or 0 if it did not fit
+ *
+ *****************************************************************************/
+uint32_t gen_pattern_Encode(const uint32_t* pBlocks, uint32_t numBlocks, uint32_t blockSize, uint32_t* data, uint32_t maxWords)
+{
+  uint32_t period, used;
+
+  if (numBlocks == 0 || blockSize == 0 || blockSize > GEN_PATTERN_MAX_CHANNELS)
+  {
+    return 0;
+  }
+
+  period = gen_pattern_FindPeriod(pBlocks, numBlocks, blockSize);
+  if (period > 1 && period < numBlocks && (numBlocks / period) <= GEN_PATTERN_MAX_COUNT)
+  {
+    if (maxWords < 2)
+    {
+      return 0;
+    }
+    used = gen_pattern_EncodeRuns(pBlocks, period, blockSize, &data[2], maxWords - 2);
+    if (used == 0)
+    {
+      return 0;
+    }
+    data[0] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_GROUP, numBlocks / period);
+    data[1] = used;
+    return used + 2;
+  }
+
+  return gen_pattern_EncodeRuns(pBlocks, numBlocks, blockSize, data, maxWords);
+}
+
@@ -60,7 +60,7 @@
 typedef struct
 {
   uint32_t         available;  /*!< Bitmask, bit0=SGPIO, bit1=DAC */
-  uint32_t         runCounter; /*!< 0=countinuous run, 1=run only once, >1 currently invalid */
+  uint32_t         runCounter; /*!< 0=countinuous run, 1=run only once, 2=digital signal streamed from client, >2 invalid */
   gen_sgpio_cfg_t  sgpio;      /*!< Configuration of digital signals */
   gen_dac_cfg_t    dac;        /*!< Configuration of analog signals */
 } generator_cfg_t;
@@ -321,6 +321,90 @@ cmd_status_t generator_Stop(void)
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Prepares for reception of an encoded digital pattern.
+ *
+ * The pattern is sent by the client before the configuration that uses it.
+ * Any ongoing generation is stopped as the pattern memory is about to be
+ * overwritten.
+ *
+ * @param [in]  size   Size in bytes of the encoded pattern
+ * @param [out] ppBuff Where to store the received pattern
+ *
+ * @retval CMD_STATUS_OK      If the pattern can be received
+ * @retval CMD_STATUS_ERR_*   If the pattern cannot be received
+ *
+ *****************************************************************************/
+cmd_status_t generator_PreparePattern(uint32_t size, uint8_t** ppBuff)
+{
+  cmd_status_t result;
+
+  do
+  {
+    *ppBuff = NULL;
+    SGPIO_GenerationEnabled = FALSE;
+
+    result = statemachine_RequestState(STATE_GENERATING);
+    if (result != CMD_STATUS_OK)
+    {
+      break;
+    }
+
+    *ppBuff = gen_sgpio_PatternBuffer(size);
+    if (*ppBuff == NULL)
+    {
+      result = CMD_STATUS_ERR_GEN_INVALID_PATTERN;
+      break;
+    }
+  } while (FALSE);
+
+  return result;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Prepares for reception of lookup tables for arbitrary analog waveforms.
+ *
+ * The lookup tables are sent by the client before the configuration that
+ * uses them. Any ongoing analog generation is stopped as the lookup tables
+ * are about to be overwritten.
+ *
+ * @param [in]  size   Size in bytes of the lookup tables
+ * @param [out] ppBuff Where to store the received lookup tables
+ *
+ * @retval CMD_STATUS_OK      If the lookup tables can be received
+ * @retval CMD_STATUS_ERR_*   If the lookup tables cannot be received
+ *
+ *****************************************************************************/
+cmd_status_t generator_PrepareAnalogLUT(uint32_t size, uint8_t** ppBuff)
+{
+  cmd_status_t result;
+
+  do
+  {
+    *ppBuff = NULL;
+    DAC_GenerationEnabled = FALSE;
+
+    result = statemachine_RequestState(STATE_GENERATING);
+    if (result != CMD_STATUS_OK)
+    {
+      break;
+    }
+
+    gen_dac_Stop();
+
+    *ppBuff = gen_dac_LUTBuffer(size);
+    if (*ppBuff == NULL)
+    {
+      result = CMD_STATUS_ERR_GEN_INVALID_WAVEFORM;
+      break;
+    }
+  } while (FALSE);
+
+  return result;
+}
+
 /**************************************************************************//**
  *
  * @brief  Applies the configuration data (comes from the client).
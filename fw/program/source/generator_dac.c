@@ -49,7 +49,7 @@
  *****************************************************************************/
 
 /*! Size of lookup table for waveform data */
-#define MAX_LUT_SIZE  2000
+#define MAX_LUT_SIZE  GEN_DAC_MAX_LUT_SIZE
 
 /*! Smallest allowed LUT size */
 #define MIN_LUT_SIZE (MAX_DAC_FREQ / MAX_FREQ)
@@ -105,8 +105,8 @@ typedef struct
   /*! Timer interrupt that the channel uses for DAC updates */
   IRQn_Type timerIRQ;
 
-  /*! Lookup table for waveform data */
-  uint16_t LUT_BUFFER[MAX_LUT_SIZE];
+  /*! Lookup table for waveform data, one of the \ref lutMemory tables */
+  uint16_t* LUT_BUFFER;
 
   /*! Current number of entries in the lookup table */
   uint16_t numLUTEntries;
@@ -130,25 +130,36 @@ typedef struct
  * Local variables
  *****************************************************************************/
 
+/*! Lookup tables for the supported channels. The tables are kept together
+ *  so that the client can upload all of them at once, see
+ *  \ref gen_dac_LUTBuffer.
+ */
+static uint16_t lutMemory[MAX_SUPPORTED_CHANNELS][MAX_LUT_SIZE];
+
 /*! Configurations for the supported channels */
 static dac_setup_t channels[MAX_SUPPORTED_CHANNELS] = {
   {
     .enabled = FALSE,
     .timer = LPC_TIMER1,
     .timerIRQ = TIMER1_IRQn,
+    .LUT_BUFFER = lutMemory[0],
   },
   {
     .enabled = FALSE,
     .timer = LPC_TIMER3,
     .timerIRQ = TIMER3_IRQn,
+    .LUT_BUFFER = lutMemory[1],
   },
 };
 
+/*! Bitmask with the channels that have an uploaded lookup table (bit0=ch1, bit1=ch2) */
+static uint32_t uploadedLUTs = 0;
+
 /*! TRUE if the generator has been configured and is ready to start */
 static Bool validConfiguration = FALSE;
 
 /*! String representation of the GEN_DAC_CFG_WAVE_* defines in generator_dac.h */
-static const char* const WAVEFORMS[6] = { "Sinus", "Square", "Triangular", "Sawtooth", "Inv Sawtooth", "Level" };
+static const char* const WAVEFORMS[7] = { "Sinus", "Square", "Triangular", "Sawtooth", "Inv Sawtooth", "Level", "Arbitrary" };
 
 /******************************************************************************
  * Forward Declarations of Local Functions
@@ -470,6 +481,51 @@ static cmd_status_t gen_dac_SetupLUT(const gen_dac_one_ch_cfg_t * const cfg, uin
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Uses the lookup table uploaded by the client.
+ *
+ * The client has already resampled the waveform, applied calibration and
+ * converted it into DAC values so only the timer's prescale value has to
+ * be calculated here. The size of the lookup table has been selected by
+ * the client so that the DAC update rate is within limits.
+ *
+ * @param [in]  cfg             Configuration for the waveform (from client)
+ * @param [in]  numChannels     The number of enabled channels
+ * @param [in]  ch              The configuration to update (local)
+ * @param [out] pPrescaleValue  The timer's prescale value
+ *
+ * @retval CMD_STATUS_OK                         If the lookup table can be used
+ * @retval CMD_STATUS_ERR_GEN_INVALID_WAVEFORM   If no lookup table has been uploaded
+ * @retval CMD_STATUS_ERR_GEN_INVALID_FREQUENCY  If the frequency is impossible
+ *
+ *****************************************************************************/
+static cmd_status_t gen_dac_UseUploadedLUT(const gen_dac_one_ch_cfg_t * const cfg,
+                                           uint32_t numChannels,
+                                           int ch,
+                                           uint32_t* pPrescaleValue)
+{
+  uint32_t pclk = CGU_GetPCLKFrequency(CGU_PERIPHERAL_TIMER1);
+  uint32_t pre;
+
+  if (((uploadedLUTs & (1<<ch)) == 0) || (cfg->lutSize == 0) || (cfg->lutSize > MAX_LUT_SIZE))
+  {
+    return CMD_STATUS_ERR_GEN_INVALID_WAVEFORM;
+  }
+
+  pre = pclk/(cfg->lutSize * cfg->frequency);
+  if ((pre == 0) || ((pclk/pre) > (MAX_DAC_FREQ / numChannels)))
+  {
+    return CMD_STATUS_ERR_GEN_INVALID_FREQUENCY;
+  }
+
+  channels[ch].numLUTEntries = cfg->lutSize;
+  *pPrescaleValue = pre;
+
+  log_i("LUT with %u uploaded entries for %dHz, prescale %d\r\n", cfg->lutSize, cfg->frequency, pre);
+  return CMD_STATUS_OK;
+}
+
 /**************************************************************************//**
  *
  * @brief  Configures the timer with the parameters from \ref gen_dac_FindFrequency
@@ -565,6 +621,7 @@ cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg)
       numChannels = 1;
     }
 
+    result = CMD_STATUS_OK;
     for (i = 0; i < MAX_SUPPORTED_CHANNELS; i++)
     {
       if (cfg->available & (1<<i))
@@ -592,6 +649,16 @@ cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg)
             break;
           }
         }
+        else if (cfg->ch[i].waveform == GEN_DAC_CFG_WAVE_ARBITRARY)
+        {
+          result = gen_dac_UseUploadedLUT(&(cfg->ch[i]), numChannels, i, &prescaler);
+          if (result != CMD_STATUS_OK)
+          {
+            break;
+          }
+
+          gen_dac_SetupTimer(prescaler, channels[i].timer);
+        }
         else
         {
           result = gen_dac_FindFrequency(cfg->ch[i].frequency, numChannels, &lutSize, &prescaler);
@@ -612,12 +679,18 @@ cmd_status_t gen_dac_Configure(const gen_dac_cfg_t * const cfg)
         channels[i].enabled = TRUE;
       }
     }
+    if (result != CMD_STATUS_OK)
+    {
+      break;
+    }
 
     validConfiguration = TRUE;
-
-    result = CMD_STATUS_OK;
   } while (FALSE);
 
+  // the uploaded lookup tables are either in use now or have been
+  // overwritten so a new configuration requires a new upload
+  uploadedLUTs = 0;
+
   return result;
 }
 
@@ -678,3 +751,42 @@ void gen_dac_Stop(void)
 
   spi_dac_stop();
 }
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the memory to store uploaded lookup tables in.
+ *
+ * The client uploads the lookup tables for arbitrary waveforms before the
+ * configuration that uses them. The data is \ref GEN_DAC_MAX_LUT_SIZE
+ * 16-bit values (already formatted with SPI_DAC_VALUE) for the first channel
+ * followed by the same for the second channel. The data for the second
+ * channel can be left out if that channel does not need it.
+ *
+ * Any ongoing generation must have been stopped as the lookup tables are
+ * overwritten.
+ *
+ * @param [in] size  Size in bytes of the data to upload
+ *
+ * @return Pointer to the memory or NULL if the size is invalid
+ *
+ *****************************************************************************/
+uint8_t* gen_dac_LUTBuffer(uint32_t size)
+{
+  int ch;
+
+  uploadedLUTs = 0;
+  if ((size == 0) || (size > sizeof(lutMemory)))
+  {
+    return NULL;
+  }
+
+  for (ch = 0; ch < MAX_SUPPORTED_CHANNELS; ch++)
+  {
+    if (size >= (ch + 1) * sizeof(lutMemory[0]))
+    {
+      uploadedLUTs |= (1<<ch);
+    }
+  }
+
+  return (uint8_t*)lutMemory;
+}
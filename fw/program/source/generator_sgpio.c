@@ -39,6 +39,7 @@
 #include "log.h"
 #include "generator_sgpio.h"
 #include "sgpio_cfg.h"
+#include "gen_pattern.h"
 #include "meas.h"
 
 #include <string.h> // for bitwise copy operations
@@ -70,6 +71,28 @@ typedef struct
  */
 #define TMP_SRC_MEM   ((uint32_t*) 0x10089B00)
 
+/*! The encoded pattern (see gen_pattern.h) is stored in the memory that is
+ *  otherwise used for the sample buffers. Capturing and generation is never
+ *  done at the same time so the memory is free.
+ */
+#define ENCODED_MEM   ((uint32_t*) 0x20000000)
+
+/*! Number of DMA buffers used as a ring when expanding an encoded pattern.
+ *  The interrupt handler refills the buffer that was copied two interrupts
+ *  ago so there must be at least three buffers.
+ */
+#define ENCODED_RING_SIZE  8
+
+/*! When streaming, the blocks received from the client are queued in the
+ *  same memory as the encoded pattern. The size must be a power of 2.
+ */
+#define STREAM_FIFO        ENCODED_MEM
+#define STREAM_FIFO_WORDS  0x4000
+#define STREAM_FIFO_MASK   (STREAM_FIFO_WORDS - 1)
+
+/*! Number of words that must be queued before a stream is started */
+#define STREAM_START_WORDS  (STREAM_FIFO_WORDS / 2)
+
 /******************************************************************************
  * Global variables
  *****************************************************************************/
@@ -93,6 +116,25 @@ static uint32_t numLeftToCopy = 0;
 static uint32_t* thisDmaChannel = NULL;
 static uint32_t* nextDmaChannel = NULL;
 
+static Bool encoded = FALSE;
+static uint32_t encodedWords = 0;
+static uint32_t encodedBlocks = 0;
+static gen_pattern_cursor_t encodedCursor;
+
+static Bool streamed = FALSE;
+static Bool streamWaiting = FALSE;
+static volatile uint32_t streamWrite = 0;
+static volatile uint32_t streamRead = 0;
+static volatile uint32_t streamBlocks = 0;
+static volatile uint32_t streamUnderruns = 0;
+static uint32_t streamLast[GEN_PATTERN_MAX_CHANNELS];
+
+/*! Number of words in one block (i.e. the number of enabled channels) */
+static uint32_t blockSize = 0;
+
+/*! Index in a block for each slice, or -1 if the slice is not used */
+static int32_t blockSliceWord[MAX_NUM_SLICES];
+
 /******************************************************************************
  * Forward Declarations of Local Functions
  *****************************************************************************/
@@ -105,6 +147,140 @@ static uint32_t* nextDmaChannel = NULL;
  * Local Functions
  *****************************************************************************/
 
+/**************************************************************************//**
+ *
+ * @brief  Copies one block (one word per enabled channel) to a DMA buffer.
+ *
+ * @param [in] buffer  Index of the DMA buffer to fill
+ * @param [in] block   The block
+ *
+ *****************************************************************************/
+static void gen_sgpio_CopyBlock(uint32_t buffer, const uint32_t* block)
+{
+  int slice;
+
+  for (slice = 0; slice < MAX_NUM_SLICES; slice++)
+  {
+    if (blockSliceWord[slice] >= 0)
+    {
+      DMA_MEM[buffer].REG_SS_data[slice] = block[blockSliceWord[slice]];
+    }
+    else
+    {
+      DMA_MEM[buffer].REG_SS_data[slice] = 0;
+    }
+  }
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Fills one DMA buffer with the next block of the encoded pattern.
+ *
+ * When the end of the pattern has been reached it is either restarted
+ * (continuous mode) or the buffer is filled with end data (one shot mode).
+ *
+ * @param [in] buffer  Index of the DMA buffer to fill
+ *
+ *****************************************************************************/
+static void gen_sgpio_FillEncodedBuffer(uint32_t buffer)
+{
+  uint32_t block[GEN_PATTERN_MAX_CHANNELS];
+
+  if (!gen_pattern_NextBlock(&encodedCursor, block))
+  {
+    if (singleShot)
+    {
+      memset(block, 0, sizeof(block));
+    }
+    else
+    {
+      gen_pattern_Start(&encodedCursor, ENCODED_MEM, encodedWords, blockSize);
+      gen_pattern_NextBlock(&encodedCursor, block);
+    }
+  }
+
+  gen_sgpio_CopyBlock(buffer, block);
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Fills one DMA buffer with the next block streamed from the client.
+ *
+ * If the client has not kept up and there is no complete block queued then
+ * an underrun is counted and all channels are held at their last level
+ * until more data arrives.
+ *
+ * @param [in] buffer  Index of the DMA buffer to fill
+ *
+ *****************************************************************************/
+static void gen_sgpio_FillStreamBuffer(uint32_t buffer)
+{
+  uint32_t i;
+  uint32_t rd = streamRead;
+
+  if ((streamWrite - rd) < blockSize)
+  {
+    streamUnderruns++;
+    for (i = 0; i < blockSize; i++)
+    {
+      streamLast[i] = (streamLast[i] & 0x80000000) ? 0xffffffff : 0;
+    }
+  }
+  else
+  {
+    for (i = 0; i < blockSize; i++)
+    {
+      streamLast[i] = STREAM_FIFO[(rd + i) & STREAM_FIFO_MASK];
+    }
+    streamRead = rd + blockSize;
+    streamBlocks++;
+  }
+
+  gen_sgpio_CopyBlock(buffer, streamLast);
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Finds the position of each slice's channel in a block.
+ *
+ * The blocks used for encoded patterns and streaming only have words for
+ * the enabled channels, in ascending order.
+ *
+ * @param [in] cfg  Configuration to apply
+ *
+ *****************************************************************************/
+static void gen_sgpio_MapBlockWords(gen_sgpio_cfg_t* cfg)
+{
+  int slice, ch;
+  uint32_t word;
+
+  blockSize = 0;
+  for (ch = 0; ch < MAX_NUM_DIOS; ch++)
+  {
+    if (cfg->enabledChannels & (1<<ch))
+    {
+      blockSize++;
+    }
+  }
+
+  for (slice = 0; slice < MAX_NUM_SLICES; slice++)
+  {
+    blockSliceWord[slice] = -1;
+    if (config[slice].enabled && config[slice].dio < MAX_NUM_DIOS)
+    {
+      word = 0;
+      for (ch = 0; ch < config[slice].dio; ch++)
+      {
+        if (cfg->enabledChannels & (1<<ch))
+        {
+          word++;
+        }
+      }
+      blockSliceWord[slice] = word;
+    }
+  }
+}
+
 /**************************************************************************//**
  *
  * @brief  SGPIO IRQ Handler.
@@ -123,6 +299,10 @@ static uint32_t* nextDmaChannel = NULL;
  * to start copying generation data to the SGPIO's REG_SS registers and then
  * the other DMA channel will be prepared for next interrupt.
  *
+ * When generating an encoded or streamed pattern the DMA buffers are used as
+ * a ring and the buffer that is no longer in use is refilled with the next
+ * block.
+ *
  *****************************************************************************/
 static void gen_SGPIO_IRQ_Handler()
 {
@@ -155,6 +335,16 @@ static void gen_SGPIO_IRQ_Handler()
                           (0x1 << 29)  |         // PROT2: bufferable access
                           (0x0UL << 31);         // Terminal count interrupt enabled
 
+  // the buffer before the one that is being copied now is free to reuse
+  if (streamed)
+  {
+    gen_sgpio_FillStreamBuffer((nextDmaBuffer + ENCODED_RING_SIZE - 2) % ENCODED_RING_SIZE);
+  }
+  else if (encoded)
+  {
+    gen_sgpio_FillEncodedBuffer((nextDmaBuffer + ENCODED_RING_SIZE - 2) % ENCODED_RING_SIZE);
+  }
+
   // swap this with next
   swap = nextDmaChannel;
   nextDmaChannel = thisDmaChannel;
@@ -236,7 +426,15 @@ static void gen_sgpio_SetupDMA(void)
 
   if (singleShot)
   {
-    numLeftToCopy = numDmaBuffers;
+    if (encoded)
+    {
+      // all blocks plus the end data
+      numLeftToCopy = encodedBlocks + 1;
+    }
+    else
+    {
+      numLeftToCopy = numDmaBuffers;
+    }
   }
 
   NVIC_DisableIRQ(DMA_IRQn);
@@ -442,6 +640,71 @@ static cmd_status_t gen_sgpio_PrepareContinuousData(gen_sgpio_cfg_t* cfg)
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Validates an encoded pattern and prepares for expanding it.
+ *
+ * The encoded pattern must already be stored in the buffer returned by
+ * \ref gen_sgpio_PatternBuffer. The channels in each block of the pattern
+ * are the enabled channels in ascending order.
+ *
+ * @param [in] cfg  Configuration to apply
+ *
+ * @retval CMD_STATUS_OK                       If the pattern is valid
+ * @retval CMD_STATUS_ERR_GEN_INVALID_PATTERN  If the pattern is malformed
+ *
+ *****************************************************************************/
+static cmd_status_t gen_sgpio_PrepareEncodedData(gen_sgpio_cfg_t* cfg)
+{
+  if (cfg->encodedSize > GEN_SGPIO_MAX_ENCODED_SIZE || (cfg->encodedSize % 4) != 0)
+  {
+    return CMD_STATUS_ERR_GEN_INVALID_PATTERN;
+  }
+
+  gen_sgpio_MapBlockWords(cfg);
+
+  encodedWords = cfg->encodedSize / 4;
+  encodedBlocks = gen_pattern_Validate(ENCODED_MEM, encodedWords, blockSize);
+  if (encodedBlocks == 0)
+  {
+    return CMD_STATUS_ERR_GEN_INVALID_PATTERN;
+  }
+
+  numDmaBuffers = ENCODED_RING_SIZE;
+  return CMD_STATUS_OK;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Prepares for generation of a pattern streamed from the client.
+ *
+ * @param [in] cfg  Configuration to apply
+ *
+ * @retval CMD_STATUS_OK  Always
+ *
+ *****************************************************************************/
+static cmd_status_t gen_sgpio_PrepareStreamedData(gen_sgpio_cfg_t* cfg)
+{
+  gen_sgpio_MapBlockWords(cfg);
+
+  numDmaBuffers = ENCODED_RING_SIZE;
+  return CMD_STATUS_OK;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Sets up the SGPIO block and enables the slices.
+ *
+ *****************************************************************************/
+static void gen_sgpio_Enable(void)
+{
+  gen_sgpio_Setup(config);
+
+  // Enable the slice(s)
+  LPC_SGPIO->CTRL_ENABLED |= slicesToEnable;
+  LPC_SGPIO->CTRL_DISABLED &= ~slicesToEnable;
+}
+
 static cmd_status_t gen_sgpio_PrepareOneShotData(gen_sgpio_cfg_t* cfg)
 {
   int slice, i;
@@ -477,6 +740,32 @@ static cmd_status_t gen_sgpio_PrepareOneShotData(gen_sgpio_cfg_t* cfg)
  * Public Functions
  *****************************************************************************/
 
+/**************************************************************************//**
+ *
+ * @brief  Returns the buffer to store an encoded pattern in.
+ *
+ * The client sends the encoded pattern before sending the configuration
+ * that refers to it with \a encodedSize.
+ *
+ * @param [in] size  Size in bytes of the encoded pattern
+ *
+ * @return The buffer or NULL if the pattern is too large
+ *
+ *****************************************************************************/
+uint8_t* gen_sgpio_PatternBuffer(uint32_t size)
+{
+  if (size > GEN_SGPIO_MAX_ENCODED_SIZE)
+  {
+    return NULL;
+  }
+  if (running)
+  {
+    gen_sgpio_Stop();
+  }
+  validConfiguration = FALSE;
+  return (uint8_t*)ENCODED_MEM;
+}
+
 /**************************************************************************//**
  *
  * @brief  Enables the clock for SGPIO and specifies IRQ handler
@@ -508,7 +797,8 @@ void gen_sgpio_Init(void)
  *
  * @param [in] cfg               Configuration to apply
  * @param [in] shiftClockPreset  Clocking information
- * @param [in] runCounter        0 for continuous signal, 1 for one shot
+ * @param [in] runCounter        0 for continuous signal, 1 for one shot,
+ *                               2 for a signal streamed from the client
  *
  * @retval CMD_STATUS_OK      If successfully configured
  * @retval CMD_STATUS_ERR_*   When the configuration could not be applied
@@ -532,7 +822,7 @@ cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, uint32_t shiftClockPreset
 
   do
   {
-    if (runCounter > 1)
+    if (runCounter > 2)
     {
       result = CMD_STATUS_ERR_GEN_INVALID_RUN_COUNTER;
       break;
@@ -544,7 +834,21 @@ cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, uint32_t shiftClockPreset
       break;
     }
 
-    if (runCounter == 1)
+    encoded = FALSE;
+    streamed = FALSE;
+    if (runCounter == 2)
+    {
+      singleShot = FALSE;
+      result = gen_sgpio_PrepareStreamedData(cfg);
+      streamed = (result == CMD_STATUS_OK);
+    }
+    else if (cfg->encodedSize > 0)
+    {
+      singleShot = (runCounter == 1);
+      result = gen_sgpio_PrepareEncodedData(cfg);
+      encoded = (result == CMD_STATUS_OK);
+    }
+    else if (runCounter == 1)
     {
       singleShot = TRUE;
       result = gen_sgpio_PrepareOneShotData(cfg);
@@ -576,17 +880,38 @@ cmd_status_t gen_sgpio_Configure(gen_sgpio_cfg_t* cfg, uint32_t shiftClockPreset
  *****************************************************************************/
 cmd_status_t gen_sgpio_Start(void)
 {
+  int i;
+
   if (!validConfiguration)
   {
     // no point in arming if the configuration is invalid
     return CMD_STATUS_ERR_NOTHING_TO_GENERATE;
   }
 
-  gen_sgpio_Setup(config);
+  if (streamed)
+  {
+    // nothing to output until the client has sent enough data, see
+    // gen_sgpio_StreamPut
+    streamWrite = streamRead = 0;
+    streamBlocks = streamUnderruns = 0;
+    memset(streamLast, 0, sizeof(streamLast));
+    streamWaiting = TRUE;
+    running = TRUE;
+    return CMD_STATUS_OK;
+  }
 
-  // Enable the slice(s)
-  LPC_SGPIO->CTRL_ENABLED |= slicesToEnable;
-  LPC_SGPIO->CTRL_DISABLED &= ~slicesToEnable;
+  if (encoded)
+  {
+    // the ring is modified while running so it must be filled from the
+    // start of the pattern each time
+    gen_pattern_Start(&encodedCursor, ENCODED_MEM, encodedWords, blockSize);
+    for (i = 0; i < ENCODED_RING_SIZE; i++)
+    {
+      gen_sgpio_FillEncodedBuffer(i);
+    }
+  }
+
+  gen_sgpio_Enable();
 
   running = TRUE;
 
@@ -624,5 +949,83 @@ void gen_sgpio_Stop(void)
   // Set all pins as inputs
   LPC_SGPIO->GPIO_OENREG = 0;
 
+  streamWaiting = FALSE;
   running = FALSE;
 }
+
+/**************************************************************************//**
+ *
+ * @brief  Tells if a streamed signal is being generated.
+ *
+ * While streaming, all data received on the bulk endpoint is signal data
+ * and must be given to \ref gen_sgpio_StreamPut instead of being treated
+ * as commands.
+ *
+ * @retval TRUE   If streaming
+ * @retval FALSE  If not streaming
+ *
+ *****************************************************************************/
+Bool gen_sgpio_IsStreaming(void)
+{
+  return (running && streamed);
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the number of words that can be queued.
+ *
+ * @return Free space in the stream queue, in words
+ *
+ *****************************************************************************/
+uint32_t gen_sgpio_StreamSpace(void)
+{
+  return STREAM_FIFO_WORDS - (streamWrite - streamRead);
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Queues data streamed from the client.
+ *
+ * The data is a sequence of blocks, each with one word per enabled channel,
+ * but the blocks may be split between calls. The first call(s) only fill
+ * the queue and the generation is started once half of it has been filled.
+ *
+ * @param [in] pData     The data, at least \a numWords words
+ * @param [in] numWords  Number of words to queue, max \ref gen_sgpio_StreamSpace
+ *
+ *****************************************************************************/
+void gen_sgpio_StreamPut(const uint8_t* pData, uint32_t numWords)
+{
+  uint32_t i;
+  uint32_t wr = streamWrite;
+
+  for (i = 0; i < numWords; i++)
+  {
+    memcpy((void*)&STREAM_FIFO[(wr + i) & STREAM_FIFO_MASK], &pData[i * 4], 4);
+  }
+  streamWrite = wr + numWords;
+
+  if (streamWaiting && (streamWrite - streamRead) >= STREAM_START_WORDS)
+  {
+    streamWaiting = FALSE;
+    for (i = 0; i < ENCODED_RING_SIZE; i++)
+    {
+      gen_sgpio_FillStreamBuffer(i);
+    }
+    gen_sgpio_Enable();
+  }
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns statistics for the ongoing (or last) streamed generation.
+ *
+ * @param [out] pBlocks     Number of blocks (32 states each) generated
+ * @param [out] pUnderruns  Number of times the queue was empty
+ *
+ *****************************************************************************/
+void gen_sgpio_StreamStatus(uint32_t* pBlocks, uint32_t* pUnderruns)
+{
+  *pBlocks = streamBlocks;
+  *pUnderruns = streamUnderruns;
+}
@@ -39,20 +39,23 @@
 #include "log.h"
 #include "meas.h"
 #include "monitor_i2c.h"
+#include "statemachine.h"
 
 /******************************************************************************
  * Typedefs and defines
  *****************************************************************************/
 
-/*! @brief One sample taken from the I2C bus */
-typedef struct
-{
-  uint32_t timestamp; /*!< timestamp in micro seconds */
-  uint32_t status;    /*!< I2C status register */
-  uint32_t data;      /*!< I2C data, only lowest 8 bits are used */
-} sample_t;
+#define SAMPLE_SIZE   (sizeof(monitor_i2c_record_t))
+
+/*! @brief Start of the memory used to buffer captured events.
+ *
+ * The same memory is used for the capture buffers and for the generator's
+ * stream buffer but as the states are exclusive there is no conflict.
+ */
+#define MON_BUFFER_START  0x20000000
 
-#define SAMPLE_SIZE   (sizeof(sample_t))
+/*! Number of events that fit in the buffer (0x20000000 - 0x20010000) */
+#define MON_NUM_RECORDS   (0x10000 / SAMPLE_SIZE)
 
 /******************************************************************************
  * Global variables
@@ -64,14 +67,21 @@ typedef struct
 
 static TIM_TIMERCFG_Type timerCfg;
 
-static circbuff_t* pSampleBuffer = NULL;
+static monitor_i2c_record_t* const ringBuffer = (monitor_i2c_record_t*)MON_BUFFER_START;
 
 static Bool validConfiguration = FALSE;
 
-static Bool done = FALSE;
-static uint32_t bytesToCapture = 100;
+static volatile Bool running = FALSE;
+static uint32_t bytesToCapture = 0;
+static volatile uint32_t bytesLeft = 0;
 
-static uint32_t* pSampleData = NULL;
+/* Free running counters, the difference is the number of unread events */
+static volatile uint32_t numWritten = 0;
+static volatile uint32_t numRead = 0;
+static volatile uint32_t numLost = 0;
+
+static uint32_t writeIdx = 0;
+static uint32_t readIdx = 0;
 
 /******************************************************************************
  * Forward Declarations of Local Functions
@@ -86,14 +96,32 @@ static uint32_t* pSampleData = NULL;
  * @brief  I2C Interrupt handler, saves all I2C samples
  * @ingroup RES_IRQ
  *
+ * The samples are stored in a ring buffer that is emptied by the USB handler.
+ * If the buffer is full the sample is dropped and counted as lost.
+ *
  *****************************************************************************/
 void I2C0_IRQHandler(void)
 {
+  monitor_i2c_record_t* pSample;
+
   SET_MEAS_PIN_1();
 
-  *pSampleData++ = LPC_TIMER3->TC;
-  *pSampleData++ = LPC_I2C0->STAT;
-  *pSampleData++ = LPC_I2C0->DATA_BUFFER;
+  if ((numWritten - numRead) < MON_NUM_RECORDS)
+  {
+    pSample = &ringBuffer[writeIdx];
+    pSample->timestamp = LPC_TIMER3->TC;
+    pSample->status    = LPC_I2C0->STAT;
+    pSample->data      = LPC_I2C0->DATA_BUFFER;
+    if (++writeIdx == MON_NUM_RECORDS)
+    {
+      writeIdx = 0;
+    }
+    numWritten++;
+  }
+  else
+  {
+    numLost++;
+  }
 
   /* As (soon to be) explained in LPC43xx User Manual Errata:
 
@@ -121,11 +149,12 @@ void I2C0_IRQHandler(void)
   }
   LPC_I2C0->CONCLR = I2C_I2CONCLR_SIC;
 
-  if (--bytesToCapture == 0)
+  // A limit of 0 means capture until stopped
+  if ((bytesToCapture > 0) && (--bytesLeft == 0))
   {
     I2C_MonitorModeCmd(LPC_I2C0, DISABLE);
     I2C_IntCmd(LPC_I2C0, FALSE);
-    done = TRUE;
+    running = FALSE;
   }
   CLR_MEAS_PIN_1();
 }
@@ -149,36 +178,52 @@ void monitor_i2c_Init(void)
   // Initialize timer 3, prescale count time of 1uS
   timerCfg.PrescaleOption = TIM_PRESCALE_USVAL;
   timerCfg.PrescaleValue  = 1;
+
+  validConfiguration = FALSE;
+  running = FALSE;
 }
 
 /**************************************************************************//**
  *
  * @brief  Applies the configuration data (comes from the client).
  *
- * @param [in] buff           Circular buffer to store captured data in
- * @param [in] cfg            Configuration to apply
+ * Changes state to \ref STATE_MONITORING which stops any ongoing signal
+ * capture or generation as they share the sample memory.
+ *
+ * @param [in] cfg            Configuration to apply (a \ref monitor_i2c_cfg_t)
+ * @param [in] size           Size of the configuration data
  *
  * @retval CMD_STATUS_OK      If successfully configured
  * @retval CMD_STATUS_ERR_*   When the configuration could not be applied
  *
  *****************************************************************************/
-cmd_status_t monitor_i2c_Configure(circbuff_t* buff, monitor_i2c_cfg_t* cfg)
+cmd_status_t monitor_i2c_Configure(uint8_t* cfg, uint32_t size)
 {
+  monitor_i2c_cfg_t* mon_cfg = (monitor_i2c_cfg_t*)cfg;
   cmd_status_t result = CMD_STATUS_OK;
 
-  pSampleBuffer = buff;
+  if (size != sizeof(monitor_i2c_cfg_t))
+  {
+    return CMD_STATUS_ERR_MON_I2C_INVALID_CONFIG;
+  }
+
+  result = statemachine_RequestState(STATE_MONITORING);
+  if (result != CMD_STATUS_OK)
+  {
+    return result;
+  }
 
   validConfiguration = FALSE;
 
   do
   {
-    if (cfg->clockrate <= 400000)
+    if (mon_cfg->clockrate <= 400000)
     {
       // Enable use of I2C buffer for max 400KHz
       LPC_GPIO_PORT->DIR[5] |= (1UL << 8);
       LPC_GPIO_PORT->SET[5] |= (1UL << 8);
     }
-//     else if (cfg->clockrate <= 1000000)
+//     else if (mon_cfg->clockrate <= 1000000)
 //     {
 //       // Enable use of I2C buffer for max 1MHz
 //       if (pca9555_rawValues(CTRL_I2C_EN2, CTRL_I2C_EN1 | CTRL_I2C_EN2) != SUCCESS)
@@ -194,7 +239,7 @@ cmd_status_t monitor_i2c_Configure(circbuff_t* buff, monitor_i2c_cfg_t* cfg)
     }
 
     I2C_DeInit(LPC_I2C0);
-    I2C_Init(LPC_I2C0, cfg->clockrate);
+    I2C_Init(LPC_I2C0, mon_cfg->clockrate);
     I2C_Cmd(LPC_I2C0, ENABLE);
     LPC_I2C0->ADR0 = 0xc0;
     LPC_I2C0->ADR1 = 0xc1;
@@ -202,6 +247,7 @@ cmd_status_t monitor_i2c_Configure(circbuff_t* buff, monitor_i2c_cfg_t* cfg)
     /* Match all addresses and control the SCL output */
     I2C_MonitorModeConfig(LPC_I2C0, I2C_MONITOR_CFG_SCL_OUTPUT | I2C_MONITOR_CFG_MATCHALL, ENABLE);
 
+    bytesToCapture = mon_cfg->bytesToCapture;
     validConfiguration = TRUE;
 
   } while (FALSE);
@@ -213,6 +259,9 @@ cmd_status_t monitor_i2c_Configure(circbuff_t* buff, monitor_i2c_cfg_t* cfg)
  *
  * @brief  Starts the I2C monitor
  *
+ * The function returns as soon as the monitor is running. The captured events
+ * are retrieved with \ref monitor_i2c_Read while the monitor is running.
+ *
  * @retval CMD_STATUS_OK      If successfully started
  * @retval CMD_STATUS_ERR_*   If the I2C monitor could not be started
  *
@@ -230,18 +279,16 @@ cmd_status_t monitor_i2c_Start(void)
   TIM_Init(LPC_TIMER3, TIM_TIMER_MODE, &timerCfg);
   TIM_Cmd(LPC_TIMER3, ENABLE);
 
-  circbuff_Reset(pSampleBuffer);
-  bytesToCapture = pSampleBuffer->size / SAMPLE_SIZE;
-  pSampleData = (uint32_t*)pSampleBuffer->data;
-  done = FALSE;
+  numWritten = 0;
+  numRead = 0;
+  numLost = 0;
+  writeIdx = 0;
+  readIdx = 0;
+  bytesLeft = bytesToCapture;
+  running = TRUE;
   I2C_IntCmd(LPC_I2C0, TRUE);
   I2C_MonitorModeCmd(LPC_I2C0, ENABLE);
 
-  while (!done)
-  {
-    TIM_Waitms(10);
-  }
-
   return CMD_STATUS_OK;
 }
 
@@ -249,6 +296,9 @@ cmd_status_t monitor_i2c_Start(void)
  *
  * @brief  Stops the I2C monitor
  *
+ * Events that have been captured but not yet read are still available
+ * with \ref monitor_i2c_Read.
+ *
  * @retval CMD_STATUS_OK      If successfully stopped
  * @retval CMD_STATUS_ERR_*   If the I2C monitor could not be stopped
  *
@@ -256,6 +306,8 @@ cmd_status_t monitor_i2c_Start(void)
 cmd_status_t monitor_i2c_Stop(void)
 {
   I2C_MonitorModeCmd(LPC_I2C0, DISABLE);
+  I2C_IntCmd(LPC_I2C0, FALSE);
+  running = FALSE;
 
   TIM_Cmd(LPC_TIMER3, DISABLE);
   TIM_DeInit(LPC_TIMER3);
@@ -267,23 +319,120 @@ cmd_status_t monitor_i2c_Stop(void)
   return CMD_STATUS_OK;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Tests if the I2C monitor is capturing
+ *
+ * @retval TRUE   If the monitor is running
+ * @retval FALSE  If the monitor has been stopped or has captured all events
+ *
+ *****************************************************************************/
+Bool monitor_i2c_IsRunning(void)
+{
+  return running;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the number of captured events that have not been read yet
+ *
+ * @return The number of events available to \ref monitor_i2c_Read
+ *
+ *****************************************************************************/
+uint32_t monitor_i2c_Pending(void)
+{
+  return numWritten - numRead;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the timestamp of the oldest event that has not been read
+ *
+ * Only valid if \ref monitor_i2c_Pending is not 0.
+ *
+ * @return Timestamp in micro seconds, see \ref monitor_i2c_GetTime
+ *
+ *****************************************************************************/
+uint32_t monitor_i2c_OldestTime(void)
+{
+  return ringBuffer[readIdx].timestamp;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Removes captured events from the buffer
+ *
+ * Copies the oldest events to \a pRecords and frees the space in the buffer
+ * for new events. Safe to call while the monitor is running.
+ *
+ * @param [out] pRecords    Destination for the events
+ * @param [in]  maxRecords  Maximum number of events to copy
+ *
+ * @return The number of copied events
+ *
+ *****************************************************************************/
+uint32_t monitor_i2c_Read(monitor_i2c_record_t* pRecords, uint32_t maxRecords)
+{
+  uint32_t num = MIN(monitor_i2c_Pending(), maxRecords);
+  uint32_t i;
+
+  for (i = 0; i < num; i++)
+  {
+    pRecords[i] = ringBuffer[readIdx];
+    if (++readIdx == MON_NUM_RECORDS)
+    {
+      readIdx = 0;
+    }
+  }
+
+  // Only release the space after the events have been copied
+  numRead += num;
+
+  return num;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the number of events that did not fit in the buffer
+ *
+ * Events are lost when the client does not read them fast enough.
+ *
+ * @return The number of lost events since the monitor was started
+ *
+ *****************************************************************************/
+uint32_t monitor_i2c_Lost(void)
+{
+  return numLost;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Returns the current time in the same unit as the event timestamps
+ *
+ * @return Micro seconds since the monitor was started
+ *
+ *****************************************************************************/
+uint32_t monitor_i2c_GetTime(void)
+{
+  return LPC_TIMER3->TC;
+}
+
 #if (TEST_I2C_MONITOR == OPT_ENABLED)
-circbuff_t testBuffer;
 monitor_i2c_cfg_t testCfg;
+monitor_i2c_record_t testRecords[32];
 void monitor_i2c_Test(void)
 {
   cmd_status_t result;
-  int i;
-  int j;
-  sample_t* pData;
+  uint32_t num;
+  uint32_t i;
+  monitor_i2c_record_t* pData;
 
   monitor_i2c_Init();
 
   testCfg.clockrate = 100000;
   testCfg.bytesToCapture = 1000;
-  circbuff_Init(&testBuffer, 0x20000000, testCfg.bytesToCapture * SAMPLE_SIZE);
 
-  result = monitor_i2c_Configure(&testBuffer, &testCfg);
+  result = monitor_i2c_Configure((uint8_t*)&testCfg, sizeof(testCfg));
   if (result != CMD_STATUS_OK)
   {
     log_i("Failed to configure I2C monitor. Error code %d. Entering infinite loop...\r\n", result);
@@ -291,21 +440,20 @@ void monitor_i2c_Test(void)
   }
 
   log_i("Starting I2C monitor...\r\n");
-  j = 1;
-  while (j--)
+  result = monitor_i2c_Start();
+  if (result != CMD_STATUS_OK)
   {
-    result = monitor_i2c_Start();
-    if (result != CMD_STATUS_OK)
-    {
-      log_i("Failed to configure I2C monitor. Error code %d. Entering infinite loop...\r\n", result);
-      break;
-    }
+    log_i("Failed to start I2C monitor. Error code %d. Entering infinite loop...\r\n", result);
+    while(1);
+  }
 
-    log_i("Got I2C data...\r\n");
-    log_i("Timestamp  Data  Status  Extra\r\n");
-    log_i("---------  ----  ------  -----\r\n");
-    pData = (sample_t*)testBuffer.data;
-    for (i = 0; i < testCfg.bytesToCapture; i++)
+  log_i("Timestamp  Data  Status  Extra\r\n");
+  log_i("---------  ----  ------  -----\r\n");
+  while (monitor_i2c_IsRunning() || (monitor_i2c_Pending() > 0))
+  {
+    num = monitor_i2c_Read(testRecords, 32);
+    pData = testRecords;
+    for (i = 0; i < num; i++)
     {
       switch (pData[i].data)
       {
@@ -325,11 +473,13 @@ void monitor_i2c_Test(void)
       }
       TIM_Waitms(2);// to prevent lost printouts
     }
+    if (num == 0)
+    {
+      TIM_Waitms(10);
+    }
   }
-  if (j==0)
-  {
-    log_i("Done sampling, entering infinite loop...\r\n");
-  }
+  log_i("Done sampling, %u events lost, entering infinite loop...\r\n", monitor_i2c_Lost());
+  monitor_i2c_Stop();
   while(1);
 }
 #endif //if(TEST_I2C_MONITOR == OPT_ENABLED)
@@ -29,6 +29,7 @@
 #include "capture.h"
 #include "generator.h"
 #include "calibrate.h"
+#include "monitor_i2c.h"
 
 /******************************************************************************
  * Typedefs and defines
@@ -89,16 +90,16 @@ void statemachine_Init(void)
  *      cap [ label="Signal Capturing" URL="\ref capture.c"];
  *      cal [ label="Calibration" URL="\ref calibrate.c"];
  *      gen [ label="Signal Generation" URL="\ref generator.c"];
- *      mon [ label="I2C Monitoring" URL="\ref monitor_i2c.c", style="dotted" ];
+ *      mon [ label="I2C Monitoring" URL="\ref monitor_i2c.c"];
  *      init -> idle [ arrowhead="open", style="solid" ];
  *      idle -> cap [ arrowhead="open", arrowtail="open", style="solid", dir="both" ];
  *      idle -> gen [ arrowhead="open", style="solid", dir="both" ];
  *      idle -> mon [ arrowhead="open", style="solid", dir="both" ];
  *      idle -> cal [ arrowhead="open", style="solid", dir="both" ];
  *      cap -> gen [ arrowhead="open", style="solid", dir="both" ];
- *      cap -> mon [ arrowhead="open", style="dotted", dir="both" ];
+ *      cap -> mon [ arrowhead="open", style="solid", dir="both" ];
  *      cap -> cal [ arrowhead="open", style="dotted", dir="both" ];
- *      gen -> mon [ arrowhead="open", style="dotted", dir="both" ];
+ *      gen -> mon [ arrowhead="open", style="solid", dir="both" ];
  *      gen -> cal [ arrowhead="open", style="dotted", dir="both" ];
  *      mon -> cal [ arrowhead="open", style="dotted", dir="both" ];
  *  }
@@ -145,6 +146,10 @@ cmd_status_t statemachine_RequestState(states_t newState)
       result = generator_Stop();
       break;
 
+    case STATE_MONITORING:
+      result = monitor_i2c_Stop();
+      break;
+
     case STATE_CALIBRATING:
       /* only started thing is the capturing for anlog in calibration */
       capture_Disarm();
@@ -172,6 +177,10 @@ cmd_status_t statemachine_RequestState(states_t newState)
         generator_Init();
         break;
 
+      case STATE_MONITORING:
+        monitor_i2c_Init();
+        break;
+
       case STATE_CALIBRATING:
         result = calibrate_Init();
         break;
@@ -0,0 +1,195 @@
+/*!
+ * @file
+ * @brief   Splitting sample memory into USB DMA transfer descriptors
+ * @ingroup FUNC_USB
+ *
+ * The captured samples are sent to the client by letting the USB controller
+ * read them directly from the sample memory using a chain of transfer
+ * descriptors. Each descriptor has five buffer pointers, one per 4KB page,
+ * so one descriptor can send at least 16KB regardless of alignment.
+ *
+ * A descriptor that does not end on a packet boundary makes the controller
+ * send a short packet and that ends the transfer on the client side. The
+ * data to send comes in several segments (the two halves of a wrapped
+ * circular buffer, digital then analog data) and only the last one may end
+ * with a short packet. The few bytes at the end of a segment that do not
+ * fill a packet are therefore copied together with the start of the next
+ * segment into a bounce buffer which is sent as one packet of its own.
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "usb_dma_chain.h"
+#include <string.h>
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Returns how many bytes one descriptor can send starting at \a p
+ *
+ * @param [in] p   Start of the data
+ *
+ * @return Number of bytes until the end of the last page the descriptor can address
+ *
+ *****************************************************************************/
+static uint32_t usb_dma_chain_MaxLength(const uint8_t* p)
+{
+  return (USB_DMA_CHAIN_NUM_PAGES * USB_DMA_CHAIN_PAGE_SIZE)
+         - (uint32_t)(((uintptr_t)p) & (USB_DMA_CHAIN_PAGE_SIZE - 1));
+}
+
+/******************************************************************************
+ * Global Functions
+ *****************************************************************************/
+
+/**************************************************************************//**
+ *
+ * @brief  Splits data into entries for a chain of USB transfer descriptors.
+ *
+ * The \a segments are sent in order as if they were one continuous block of
+ * data. Each entry in \a entries becomes one transfer descriptor. All of the
+ * data is sent from where it is, except for at most one packet at each
+ * boundary between two segments which is copied into \a bounce.
+ *
+ * @param [in]  segments     The data to send
+ * @param [in]  numSegments  Number of segments
+ * @param [in]  packetSize   Maximum packet size of the endpoint
+ * @param [in]  bounce       Buffer for packets spanning two segments
+ * @param [in]  bounceSize   Size of \a bounce, should be \a packetSize for
+ *                           each segment boundary
+ * @param [out] entries      The resulting chain
+ * @param [in]  maxEntries   Number of entries that fit in \a entries
+ *
+ * @return Number of entries used or 0 if there is no data or if the
+ *         data does not fit in \a entries or \a bounce
+ *
+ *****************************************************************************/
+uint32_t usb_dma_chain_Build(const usb_dma_chain_segment_t* segments, uint32_t numSegments,
+                             uint32_t packetSize, uint8_t* bounce, uint32_t bounceSize,
+                             usb_dma_chain_entry_t* entries, uint32_t maxEntries)
+{
+  uint32_t numEntries = 0;
+  uint32_t bounceUsed = 0;   // bytes of bounce buffer taken by completed packets
+  uint32_t carry = 0;        // bytes in the packet being assembled in bounce
+  uint32_t i;
+
+  if (packetSize == 0)
+  {
+    return 0;
+  }
+
+  for (i = 0; i < numSegments; i++)
+  {
+    const uint8_t* p = segments[i].data;
+    uint32_t left = segments[i].length;
+    uint32_t body;
+    uint32_t len;
+
+    if (carry > 0)
+    {
+      // complete the packet started by the previous segment(s)
+      len = packetSize - carry;
+      if (len > left)
+      {
+        len = left;
+      }
+      memcpy(bounce + bounceUsed + carry, p, len);
+      carry += len;
+      p += len;
+      left -= len;
+
+      if (carry == packetSize)
+      {
+        if (numEntries == maxEntries)
+        {
+          return 0;
+        }
+        entries[numEntries].data = bounce + bounceUsed;
+        entries[numEntries].length = packetSize;
+        numEntries++;
+        bounceUsed += packetSize;
+        carry = 0;
+      }
+    }
+
+    if (carry > 0)
+    {
+      // segment was too small to complete the packet
+      continue;
+    }
+
+    // Send whole packets directly from the segment. The last segment can
+    // end with a short packet.
+    body = (i == numSegments - 1) ? left : (left - (left % packetSize));
+    while (body > 0)
+    {
+      len = usb_dma_chain_MaxLength(p);
+      if (len >= body)
+      {
+        len = body;
+      }
+      else
+      {
+        len -= len % packetSize;
+      }
+
+      if (numEntries == maxEntries)
+      {
+        return 0;
+      }
+      entries[numEntries].data = p;
+      entries[numEntries].length = len;
+      numEntries++;
+      p += len;
+      left -= len;
+      body -= len;
+    }
+
+    if (left > 0)
+    {
+      // start a new packet in the bounce buffer with the rest of the segment
+      if (bounceUsed + packetSize > bounceSize)
+      {
+        return 0;
+      }
+      memcpy(bounce + bounceUsed, p, left);
+      carry = left;
+    }
+  }
+
+  if (carry > 0)
+  {
+    // the data ended in the bounce buffer
+    if (numEntries == maxEntries)
+    {
+      return 0;
+    }
+    entries[numEntries].data = bounce + bounceUsed;
+    entries[numEntries].length = carry;
+    numEntries++;
+  }
+
+  return numEntries;
+}
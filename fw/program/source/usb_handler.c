@@ -32,6 +32,15 @@
 #include "lpc43xx_wwdt.h"
 #include "led.h"
 #include "log.h"
+#include "generator.h"
+#include "generator_sgpio.h"
+#include "monitor_i2c.h"
+#include "capture_trigger.h"
+#include "capture_telemetry.h"
+#include "capture_peek.h"
+#include "capture_vadc.h"
+#include "usb_dma_chain.h"
+#include "statemachine.h"
 
 
 /******************************************************************************
@@ -57,6 +66,24 @@
 #define HEADER_IDX_CMD       2
 #define HEADER_IDX_PREFIX    3
 
+/*! Number of I2C events in one \ref CMD_MON_I2C_DATA message */
+#define MON_RECORDS_PER_MSG  ((DATA_MAX_LEN - 16) / sizeof(monitor_i2c_record_t))
+
+/*! Maximum time in micro seconds that a captured I2C event is held back
+ *  while waiting for a full \ref CMD_MON_I2C_DATA message */
+#define MON_FLUSH_INTERVAL   20000
+
+/*! Number of segments the captured samples are sent in, two for each of the
+ *  digital and analog circular buffers */
+#define UPLOAD_MAX_SEGMENTS  4
+
+/*! Number of transfer descriptors used to send the captured samples. Each
+ *  one sends at least 16KB and there is one per bounced packet */
+#define UPLOAD_MAX_TDS       16
+
+/*! Set in the flags of the last \ref CMD_MON_I2C_DATA message */
+#define MON_FLAG_LAST        (1UL << 0)
+
 #define CMD_SIZE(__buff)      (*((uint16_t*)(__buff)))
 #define CMD_IS_VALID(__buff)  (((__buff)[HEADER_IDX_PREFIX])==0xea)
 #define CMD_HAS_DATA(__buff)  (CMD_IS_VALID(__buff) && (CMD_SIZE(__buff) > 0) && (CMD_SIZE(__buff) <= DATA_MAX_LEN))
@@ -89,6 +116,14 @@ typedef struct
   calib_result_t     parameters;
 } calibration_data_t;
 
+/*! Progress of sending the captured samples to the client */
+typedef enum
+{
+  UPLOAD_IDLE,   /*!< Not sending samples */
+  UPLOAD_HEADER, /*!< Waiting for the client to read the header */
+  UPLOAD_DATA,   /*!< The USB DMA is sending the samples */
+} upload_state_t;
+
 /*! Commands sent on the USB Bulk interface */
 typedef enum
 {
@@ -107,17 +142,31 @@ typedef enum
   CMD_CAL_ERASE      = 12, /*!< Erase the calibration data from EEPROM */
   CMD_CAL_END        = 13, /*!< End the calibration sequence */
 
+  CMD_GEN_PATTERN    = 14, /*!< Encoded pattern for signal generation */
+  /* 15 is reserved, used by the client to mark streamed data */
+  CMD_GEN_ANALOG_LUT = 16, /*!< Lookup tables for arbitrary analog waveforms */
+
+  CMD_MON_I2C_CFG    = 17, /*!< Configure I2C monitoring */
+  CMD_MON_I2C_RUN    = 18, /*!< Start I2C monitoring */
+  CMD_MON_I2C_DATA   = 19, /*!< Captured I2C events */
+
+  CMD_CAP_ARM        = 20, /*!< Configure (optional) and arm signal capturing, answered with the samples */
+
   CMD_NUM_COMMANDS
 } protocol_commands_t;
 
 /*! Commands sent as USB Control Requests */
 typedef enum
 {
-  REQ_GetPll1Speed  = 1, /*!< Request for the speed of PLL1 */
-  REQ_Ping          = 2, /*!< Ping to indicate active line */
-  REQ_StopCapture   = 3, /*!< Request to stop ongoing signal capture */
-  REQ_StopGenerator = 4, /*!< Request to stop ongoing signal generation */
-  REQ_GetCalibData  = 5, /*!< Request for the persistent calibration data */
+  REQ_GetPll1Speed    = 1, /*!< Request for the speed of PLL1 */
+  REQ_Ping            = 2, /*!< Ping to indicate active line */
+  REQ_StopCapture     = 3, /*!< Request to stop ongoing signal capture */
+  REQ_StopGenerator   = 4, /*!< Request to stop ongoing signal generation */
+  REQ_GetCalibData    = 5, /*!< Request for the persistent calibration data */
+  REQ_GetGenStatus    = 6, /*!< Request for the status of a streamed signal generation */
+  REQ_GetCaptureDepth = 7, /*!< Request for the number of samples the capture configuration holds */
+  REQ_PeekCapture     = 8, /*!< Request for a preview of the ongoing capture */
+  REQ_UpdateAnalogConfig = 9, /*!< Request to change the analog trigger and input settings at the next arming */
 } control_requests_t;
 
 /******************************************************************************
@@ -139,6 +188,27 @@ static callbacks_t callbacks;
 static sample_data_t samples = {CMD_STATUS_ERR,NULL,0,0};
 static Bool haveSamplesToSend = FALSE;
 
+// Transfer descriptors for letting the USB DMA send the samples directly from
+// the sample memory, see usb_dma_chain.c
+PRAGMA_ALIGN_32
+static DeviceTransferDescriptor uploadTD[UPLOAD_MAX_TDS] ATTR_ALIGNED(32) __DATA(USBRAM_SECTION);
+PRAGMA_ALIGN_4
+static uint8_t uploadBounce[(UPLOAD_MAX_SEGMENTS - 1) * LABTOOL_IO_EPSIZE] ATTR_ALIGNED(4) __DATA(USBRAM_SECTION);
+static upload_state_t uploadState = UPLOAD_IDLE;
+static uint32_t uploadSize = 0;
+static Bool uploadTerminate = FALSE;
+
+// Telemetry sent in the header of the samples
+static capture_telemetry_t telemetry;
+static uint32_t uploadStartCycles = 0;
+static uint32_t lastReadoutTime = 0;
+
+// Preview of an ongoing capture, sent in the data stage of a control request
+static uint32_t peekBuff[(CAPTURE_PEEK_MAX_SIZE + 3) / 4];
+
+// Changed analog settings, received in the data stage of a control request
+static uint32_t updateBuff[(sizeof(cap_vadc_cfg_t) + 3) / 4];
+
 // Calibration result to send back to PC
 static calibration_data_t calibration;
 static Bool haveCalibrationResultToSend = FALSE;
@@ -147,6 +217,11 @@ static volatile Bool usbConnected;
 
 static Bool stopCaptureRequested = FALSE;
 static Bool stopGeneratorRequested = FALSE;
+static Bool rearmCaptureRequested = FALSE;
+
+// Captured I2C events to send back to PC
+static Bool haveMonitorDataToSend = FALSE;
+static monitor_i2c_record_t monitorRecords[MON_RECORDS_PER_MSG];
 
 /******************************************************************************
  * Forward Declarations of Local Functions
@@ -253,6 +328,37 @@ static Bool LabTool_ReadData(uint8_t* pBuff, uint16_t size)
   return FALSE;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Reads a payload that may be larger than 512 bytes
+ *
+ * The payload is read in blocks of 512 bytes using \ref LabTool_ReadData.
+ * If \a pBuff is NULL then the payload is read and discarded so that it
+ * is not mistaken for the next command.
+ *
+ * @param [in,out] pBuff  The buffer to store read data in or NULL
+ * @param [in]     size   The number of bytes to read
+ *
+ * @retval TRUE  If the data was successfully read
+ * @retval FALSE If the data was not read
+ *
+ *****************************************************************************/
+static Bool LabTool_ReadLargeData(uint8_t* pBuff, uint32_t size)
+{
+  uint32_t off;
+  uint16_t chunk;
+
+  for (off = 0; off < size; off += chunk)
+  {
+    chunk = ((size - off) > DATA_MAX_LEN) ? DATA_MAX_LEN : (size - off);
+    if (!LabTool_ReadData((pBuff == NULL) ? data_buff : (pBuff + off), chunk))
+    {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
 /**************************************************************************//**
  *
  * @brief  Sends a response to a command back to the client software
@@ -305,6 +411,12 @@ static void LabTool_SendResponse(uint8_t cmd, cmd_status_t status)
  * action is taken. After the action has completed the result is sent back
  * to the client over USB.
  *
+ * The \a CMD_CAP_ARM command is the exception as it has no response of its
+ * own. The client has already posted the reads for the header and the samples
+ * and they are sent back-to-back when the capture is done. Any error with the
+ * configuration or when arming is reported in the header, see
+ * \ref LabTool_SendSamples.
+ *
  * \see LabTool_ReadCommand
  * \see LabTool_SendResponse
  *
@@ -314,6 +426,7 @@ static void LabTool_ProcessCommand(void)
   cmd_status_t status;
   uint8_t cmd;
   uint16_t size;
+  uint8_t* pBuff;
 
   /* Device must be connected and configured for the task to run */
   if (USB_DeviceState != DEVICE_STATE_Configured)
@@ -350,13 +463,67 @@ static void LabTool_ProcessCommand(void)
         }
         break;
 
+      case CMD_GEN_PATTERN:
+        log_i("Got generator PATTERN command\r\n");
+        stopGeneratorRequested = FALSE;
+        status = generator_PreparePattern(size, &pBuff);
+        if (!LabTool_ReadLargeData(pBuff, size))
+        {
+          log_i("Failed to read generator pattern payload\r\n");
+          status = CMD_STATUS_ERR;
+        }
+        LabTool_SendResponse(CMD_GEN_PATTERN, status);
+        break;
+
+      case CMD_GEN_ANALOG_LUT:
+        log_i("Got generator ANALOG_LUT command\r\n");
+        stopGeneratorRequested = FALSE;
+        status = generator_PrepareAnalogLUT(size, &pBuff);
+        if (!LabTool_ReadLargeData(pBuff, size))
+        {
+          log_i("Failed to read generator lookup table payload\r\n");
+          status = CMD_STATUS_ERR;
+        }
+        LabTool_SendResponse(CMD_GEN_ANALOG_LUT, status);
+        break;
+
       case CMD_CAP_RUN:
         log_i("Got capture RUN command\r\n");
         stopCaptureRequested = FALSE;
+        uploadTerminate = FALSE;
         status = callbacks.capRun();
         LabTool_SendResponse(CMD_CAP_RUN, status);
         break;
 
+      case CMD_CAP_ARM:
+        log_i("Got capture ARM command\r\n");
+        stopCaptureRequested = FALSE;
+        uploadTerminate = TRUE;
+        status = CMD_STATUS_OK;
+        if (size > 0)
+        {
+          if (LabTool_ReadData(data_buff, size))
+          {
+            status = callbacks.capConfigure(data_buff, size);
+          }
+          else
+          {
+            log_i("Failed to read capture config payload\r\n");
+            status = CMD_STATUS_ERR;
+          }
+        }
+        if (status == CMD_STATUS_OK)
+        {
+          status = callbacks.capRun();
+        }
+        if (status != CMD_STATUS_OK)
+        {
+          // There is no response to this command, the client is waiting
+          // for the samples so the error is reported in their header
+          usb_handler_SignalFailedSampling(status);
+        }
+        break;
+
       case CMD_CAP_CFG:
         log_i("Got capture CFG command\r\n");
         stopCaptureRequested = FALSE;
@@ -372,6 +539,40 @@ static void LabTool_ProcessCommand(void)
         }
         break;
 
+      case CMD_MON_I2C_CFG:
+        log_i("Got I2C monitor CFG command\r\n");
+        stopCaptureRequested = FALSE;
+        haveMonitorDataToSend = FALSE;
+        if (LabTool_ReadData(data_buff, size))
+        {
+          status = monitor_i2c_Configure(data_buff, size);
+          LabTool_SendResponse(CMD_MON_I2C_CFG, status);
+        }
+        else
+        {
+          log_i("Failed to read I2C monitor config payload, ignoring command\r\n");
+          LabTool_SendResponse(CMD_MON_I2C_CFG, CMD_STATUS_ERR);
+        }
+        break;
+
+      case CMD_MON_I2C_RUN:
+        log_i("Got I2C monitor RUN command\r\n");
+        stopCaptureRequested = FALSE;
+        if (statemachine_GetState() == STATE_MONITORING)
+        {
+          status = monitor_i2c_Start();
+        }
+        else
+        {
+          status = CMD_STATUS_ERR_MON_I2C_NOT_CONFIGURED;
+        }
+        LabTool_SendResponse(CMD_MON_I2C_RUN, status);
+        if (status == CMD_STATUS_OK)
+        {
+          haveMonitorDataToSend = TRUE;
+        }
+        break;
+
       case CMD_CAL_INIT:
         log_i("Got calibration INIT command\r\n");
         status = calibrate_Init();
@@ -453,6 +654,62 @@ static void LabTool_ProcessCommand(void)
   }
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Queues streamed signal data for the generator
+ *
+ * While a streamed signal is generated all data on the bulk endpoint is
+ * signal data. The client always sends multiples of 512 bytes. A packet is
+ * only read when there is room for it so that the USB flow control makes
+ * the client wait when the generator is behind.
+ *
+ * \see gen_sgpio_StreamPut
+ *
+ *****************************************************************************/
+static void LabTool_ProcessStream(void)
+{
+  /* Device must be connected and configured for the task to run */
+  if (USB_DeviceState != DEVICE_STATE_Configured)
+  {
+    return;
+  }
+
+  /* Select the OUT stream endpoint */
+  Endpoint_SelectEndpoint(LABTOOL_OUT_EPNUM);
+
+  if (Endpoint_IsOUTReceived() && (gen_sgpio_StreamSpace() >= (DATA_MAX_LEN / 4)))
+  {
+    Endpoint_Read_Stream_LE(data_buff, DATA_MAX_LEN, NULL);
+    Endpoint_ClearOUT();
+    gen_sgpio_StreamPut(data_buff, DATA_MAX_LEN / 4);
+  }
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Discards streamed signal data left on the bulk endpoint
+ *
+ * The client cancels its stream transfers before it requests the generator
+ * to stop, but packets that have already been received would be read as
+ * commands once the generation has stopped.
+ *
+ * Called from the control request handler so the control endpoint is
+ * selected again afterwards.
+ *
+ *****************************************************************************/
+static void LabTool_DiscardStream(void)
+{
+  /* Select the OUT stream endpoint */
+  Endpoint_SelectEndpoint(LABTOOL_OUT_EPNUM);
+
+  while (Endpoint_IsOUTReceived())
+  {
+    Endpoint_ClearOUT();
+  }
+
+  Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+}
+
 /**************************************************************************//**
  *
  * @brief  Sends a chunk of data
@@ -529,53 +786,174 @@ static Bool LabTool_SendData(const uint8_t* const pData, uint32_t off, uint32_t
 
 /**************************************************************************//**
  *
- * @brief  Sends the content of the circular buffer over USB
+ * @brief  Adds the content of the circular buffer to the data to send
  *
- * The circular buffer is first straightened out to make it appear as one
- * continuous set of samples.
+ * The circular buffer is straightened out to make it appear as one
+ * continuous set of samples, i.e. if it has wrapped the oldest part is
+ * added first followed by the start of the buffer.
  *
- * @param [in] buff  The data to send
+ * @param [in]  buff      The data to send, can be NULL
+ * @param [out] segments  Where to add the segments
  *
- * @retval TRUE  If the data was successfully sent
- * @retval FALSE If the data was not sent
+ * @return Number of segments added (0 - 2)
  *
  *****************************************************************************/
-static Bool LabTool_SendBuffer(const circbuff_t * const buff)
+static uint32_t LabTool_AddSegments(const circbuff_t * const buff, usb_dma_chain_segment_t* segments)
 {
-  Bool success = FALSE;
+  uint32_t num = 0;
+
   if (buff == NULL)
   {
-    success = TRUE;
+    return 0;
   }
-  else
+
+  if (!buff->empty)
   {
-    if (buff->empty)
-    {
-      if (LabTool_SendData(buff->data, 0, buff->last))
-      {
-        success = TRUE;
-      }
-    }
-    else
+    segments[num].data = (const uint8_t*)circbuff_GetFirstAddr(buff);
+    segments[num].length = buff->size - buff->last;
+    num++;
+  }
+  segments[num].data = buff->data;
+  segments[num].length = buff->last;
+  num++;
+
+  return num;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Starts sending the captured samples using the USB DMA
+ *
+ * The samples are not copied, instead a chain of transfer descriptors
+ * pointing into the sample memory is given to the USB controller and the
+ * samples are sent as fast as the client reads them. Use
+ * \ref LabTool_ContinueUpload to find out when it is done.
+ *
+ * For a capture started with \a CMD_CAP_ARM the client has posted a read
+ * that is larger than the samples. If the samples end on a packet boundary
+ * a zero length packet is added to terminate that read.
+ *
+ * @retval TRUE  If the transfer was started
+ * @retval FALSE If the samples could not be divided into transfer descriptors
+ *
+ *****************************************************************************/
+static Bool LabTool_StartUpload(void)
+{
+  usb_dma_chain_segment_t segments[UPLOAD_MAX_SEGMENTS];
+  usb_dma_chain_entry_t entries[UPLOAD_MAX_TDS];
+  uint32_t numSegments = 0;
+  uint32_t numEntries;
+  uint32_t i;
+  uint32_t addr;
+  uint8_t phyEP;
+
+  numSegments += LabTool_AddSegments(samples.cap.sgpio_samples, &segments[numSegments]);
+  numSegments += LabTool_AddSegments(samples.cap.vadc_samples, &segments[numSegments]);
+
+  // one descriptor is kept for the zero length packet
+  numEntries = usb_dma_chain_Build(segments, numSegments, LABTOOL_IO_EPSIZE,
+                                   uploadBounce, sizeof(uploadBounce),
+                                   entries, UPLOAD_MAX_TDS - 1);
+  if (numEntries == 0)
+  {
+    return FALSE;
+  }
+  if (uploadTerminate && ((uploadSize % LABTOOL_IO_EPSIZE) == 0))
+  {
+    entries[numEntries].data = NULL;
+    entries[numEntries].length = 0;
+    numEntries++;
+  }
+
+  for (i = 0; i < numEntries; i++)
+  {
+    addr = (uint32_t)entries[i].data;
+    memset(&uploadTD[i], 0, sizeof(DeviceTransferDescriptor));
+    uploadTD[i].NextTD = (i == (numEntries - 1)) ? LINK_TERMINATE : (uint32_t)&uploadTD[i + 1];
+    uploadTD[i].TotalBytes = entries[i].length;
+    uploadTD[i].IntOnComplete = (i == (numEntries - 1)) ? 1 : 0;
+    uploadTD[i].Active = 1;
+    uploadTD[i].BufferPage[0] = addr;
+    uploadTD[i].BufferPage[1] = (addr + 0x1000) & 0xfffff000;
+    uploadTD[i].BufferPage[2] = (addr + 0x2000) & 0xfffff000;
+    uploadTD[i].BufferPage[3] = (addr + 0x3000) & 0xfffff000;
+    uploadTD[i].BufferPage[4] = (addr + 0x4000) & 0xfffff000;
+  }
+
+  // Hand the chain to the endpoint's queue head and prime it, the same way
+  // as Endpoint_Streaming does in the USB stack
+  Endpoint_SelectEndpoint(LABTOOL_IN_EPNUM);
+  phyEP = endpointhandle[endpointselected];
+  dQueueHead[phyEP].overlay.Halted = 0;
+  dQueueHead[phyEP].overlay.Active = 0;
+  dQueueHead[phyEP].overlay.NextTD = (uint32_t)&uploadTD[0];
+  dQueueHead[phyEP].TransferCount = uploadSize;
+  USB_REG(USB_PORT_SELECTED)->ENDPTPRIME |= _BIT(EP_Physical2BitPosition(phyEP));
+
+  log_i("Sending %d bytes in %d segments using %d transfer descriptors\r\n", uploadSize, numSegments, numEntries);
+  return TRUE;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Drives the sending of the captured samples
+ *
+ * Called repeatedly after \ref LabTool_SendSamples has sent the header. When
+ * the client has read the header the samples are handed to the USB DMA and
+ * when that is done the samples are marked as sent.
+ *
+ *****************************************************************************/
+static void LabTool_ContinueUpload(void)
+{
+  Endpoint_SelectEndpoint(LABTOOL_IN_EPNUM);
+  if (!Endpoint_IsINReady())
+  {
+    // still busy with the header or the samples
+    return;
+  }
+
+  if (uploadState == UPLOAD_HEADER)
+  {
+    if (LabTool_StartUpload())
     {
-      if (LabTool_SendData((uint8_t*)circbuff_GetFirstAddr(buff), 0, buff->size - buff->last))
-      {
-        if (LabTool_SendData(buff->data, 0, buff->last))
-        {
-          success = TRUE;
-          log_i("Sent %d (0x%x) bytes from 0x%08x followed by %d (0x%x) bytes from 0x%08x\r\n",
-                buff->size - buff->last,
-                buff->size - buff->last,
-                circbuff_GetFirstAddr(buff),
-                buff->last,
-                buff->last,
-                buff->data);
-          log_i("Circbuff {data 0x%08x, size %d (0x%x), last %d (0x%x)}\r\n", (uint32_t)buff->data, buff->size, buff->size, buff->last, buff->last);
-        }
-      }
+      uploadState = UPLOAD_DATA;
+      return;
     }
+    log_e("Failed to send samples to PC\r\n");
+  }
+  else
+  {
+    lastReadoutTime = (DWT->CYCCNT - uploadStartCycles) / (SystemCoreClock / 1000000);
+    log_i("All samples sent successfully in %u us. Trig %d, Active {SGPIO %#x, VADC %#x}\r\n",
+          lastReadoutTime, samples.cap.trigpoint, samples.cap.sgpioActiveChannels, samples.cap.vadcActiveChannels);
+  }
+
+  uploadState = UPLOAD_IDLE;
+  haveSamplesToSend = FALSE;
+  LED_TRIG_OFF();
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Stops an ongoing sending of captured samples
+ *
+ * The USB DMA reads directly from the sample memory so it must be stopped
+ * before a new capture can use the memory.
+ *
+ *****************************************************************************/
+static void LabTool_AbortUpload(void)
+{
+  uint32_t mask;
+
+  if (uploadState != UPLOAD_IDLE)
+  {
+    Endpoint_SelectEndpoint(LABTOOL_IN_EPNUM);
+    mask = _BIT(EP_Physical2BitPosition(endpointhandle[endpointselected]));
+    USB_REG(USB_PORT_SELECTED)->ENDPTFLUSH = mask;
+    while (USB_REG(USB_PORT_SELECTED)->ENDPTFLUSH & mask) {}
+    uploadState = UPLOAD_IDLE;
+    LED_TRIG_OFF();
   }
-  return success;
 }
 
 /**************************************************************************//**
@@ -620,6 +998,12 @@ static int LabTool_AlignSignals(void)
     // Move the position in the analog signal buffer so that it aligns with the digital one
     samples.cap.vadc_samples->last = idxSGPIO * 2 * (samples.cap.vadcActiveChannels >> 16);
 
+    // The exact analog trigger was relative to the old start of the buffer
+    if (samples.cap.vadcTrigExact != CAPTURE_TRIGGER_UNKNOWN)
+    {
+      samples.cap.vadcTrigExact = ((idxVADC + samples.cap.vadcTrigExact) % numSamples + numSamples - idxSGPIO) % numSamples;
+    }
+
     // Determine how many samples to discard based on how much further ahead one
     // circular buffer is compared to the other one.
     if (idxSGPIO > idxVADC) {
@@ -655,18 +1039,120 @@ static int LabTool_AlignSignals(void)
   return signalTrim;
 }
 
+/**************************************************************************//**
+ *
+ * @brief  Selects the exact trigger sample to report to the client software
+ *
+ * The digital trigger is used if found, otherwise the analog one. The sample
+ * index is adjusted for the samples that the client will remove from the
+ * start of the data.
+ *
+ * @param [in] signalTrim  The value returned by \ref LabTool_AlignSignals
+ *
+ * @return The trigger sample or CAPTURE_TRIGGER_UNKNOWN if not known
+ *
+ *****************************************************************************/
+static uint32_t LabTool_ExactTrigger(int signalTrim)
+{
+  uint32_t exact = samples.cap.sgpioTrigExact;
+
+  if (exact == CAPTURE_TRIGGER_UNKNOWN)
+  {
+    exact = samples.cap.vadcTrigExact;
+  }
+  if (exact != CAPTURE_TRIGGER_UNKNOWN && signalTrim < 0)
+  {
+    if (exact < (uint32_t)(-signalTrim))
+    {
+      // the trigger is in the samples that will be removed
+      exact = CAPTURE_TRIGGER_UNKNOWN;
+    }
+    else
+    {
+      exact -= (uint32_t)(-signalTrim);
+    }
+  }
+  return exact;
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Summarizes the captured samples in the telemetry for the client
+ *
+ * The analog samples are scanned once for skipped and empty samples and
+ * for statistics, see \ref capture_telemetry_AddAnalog. The trigger latency
+ * is how far from the reported trigger sample the exact one was found.
+ *
+ * Must be called before \ref LabTool_AlignSignals as that moves the exact
+ * analog trigger sample.
+ *
+ *****************************************************************************/
+static void LabTool_CollectTelemetry(void)
+{
+  usb_dma_chain_segment_t segments[2];
+  uint32_t num;
+
+  capture_telemetry_Init(&telemetry);
+  telemetry.readoutTime = lastReadoutTime;
+  telemetry.analogUpdates = samples.cap.analogUpdates;
+
+  if (samples.status != CMD_STATUS_OK)
+  {
+    return;
+  }
+
+  if (samples.cap.sgpioTrigExact != CAPTURE_TRIGGER_UNKNOWN)
+  {
+    telemetry.digitalTrigLatency = (int32_t)(samples.cap.sgpioTrigExact - samples.cap.sgpioTrigSample);
+  }
+  if (samples.cap.vadcTrigExact != CAPTURE_TRIGGER_UNKNOWN)
+  {
+    telemetry.analogTrigLatency = (int32_t)(samples.cap.vadcTrigExact - samples.cap.vadcTrigSample);
+  }
+
+  num = LabTool_AddSegments(samples.cap.vadc_samples, segments);
+  if (num > 0)
+  {
+    capture_telemetry_AddAnalog(&telemetry, samples.cap.vadcActiveChannels >> 16,
+                                (const uint16_t*)segments[0].data, segments[0].length / 2,
+                                (num > 1) ? (const uint16_t*)segments[1].data : NULL,
+                                (num > 1) ? (segments[1].length / 2) : 0);
+  }
+}
+
+/**************************************************************************//**
+ *
+ * @brief  Writes the telemetry as 32-bit words to the IN endpoint
+ *
+ *****************************************************************************/
+static void LabTool_WriteTelemetry(void)
+{
+  const uint32_t* pWords = (const uint32_t*)&telemetry;
+  uint32_t i;
+
+  for (i = 0; i < (sizeof(capture_telemetry_t) / 4); i++)
+  {
+    Endpoint_Write_32_LE(pWords[i]);
+  }
+}
+
 /**************************************************************************//**
  *
  * @brief  Sends the captured samples to the client software
  *
- * The samples are sent on the bulk endpoint.
+ * The samples are sent on the bulk endpoint. This function only sends the
+ * header, the samples are sent by the USB DMA directly from the sample memory
+ * once the client has read the header, see \ref LabTool_ContinueUpload.
+ *
+ * This is also the answer to a \a CMD_CAP_ARM command, in which case a
+ * failure to configure or arm the capture is reported in \a START.
  *
  * The message is formatted like this:
  *
  * \dot
  *  digraph structs {
  *      node [shape=record];
- *      message [label="START | Digital Size | Analog Size | Trigger | Digital Trig Sample | Analog Trig Sample | Active Digital Channels | Active Analog Channels | Signal Trim | Digital Data | Analog Data"];
+ *      message [label="START | Digital Size | Analog Size | Trigger | Digital Trig Sample | Analog Trig Sample | Active Digital Channels | Active Analog Channels | Signal Trim | Trigger Sample | Telemetry | Digital Data | Analog Data"];
  *  }
  *  \enddot
  * Where each part is 32 bits and \a START is divided into four bytes like this:
@@ -677,40 +1163,51 @@ static int LabTool_AlignSignals(void)
  *  }
  *  \enddot
  *
+ * \a Trigger Sample is the sample (after removing \a Signal Trim samples)
+ * where the triggering edge is or 0xFFFFFFFF if it was not found. The
+ * \a Digital Trig Sample and \a Analog Trig Sample are only approximate.
+ *
+ * \a Telemetry is a \ref capture_telemetry_t sent as 45 words with
+ * statistics about the analog samples, the trigger latency and the time it
+ * took to send the previous capture. It is sent also when the capture failed
+ * but then only the readout time is valid.
+ *
  * Example 1: Sampling of \a DIO_0, \a DIO_2, \a DIO_7 and \a A1 failed with error 12:
  *
  * \dot
  *  digraph structs {
  *      node [shape=record];
- *      message [label="{START|0xEA05000C} | {Digital Size|0x00000000} | {Analog Size|0x00000000} | {Trigger|0x00000000} | {Digital Trig Sample|0x00000000} | {Analog Trig Sample|0x00000000} | {Active Digital Channels|0x00000085} | {Active Analog Channels|0x00000002} | {Signal Trim|0x00000000}"];
+ *      message [label="{START|0xEA05000C} | {Digital Size|0x00000000} | {Analog Size|0x00000000} | {Trigger|0x00000000} | {Digital Trig Sample|0x00000000} | {Analog Trig Sample|0x00000000} | {Active Digital Channels|0x00000085} | {Active Analog Channels|0x00000002} | {Signal Trim|0x00000000} | {Trigger Sample|0xFFFFFFFF} | {Telemetry|45 words}"];
  *  }
  *  \enddot
  * Example 2: Successful sampling of \a DIO_3:
  * \dot
  *  digraph structs {
  *      node [shape=record];
- *      message [label="{START|0xEA050000} | {Digital Size|0x00010000} | {Analog Size|0x00000000} | {Trigger|0x00000000} | {Digital Trig Sample|0x00000100} | {Analog Trig Sample|0x00000000} | {Active Digital Channels|0x00000008} | {Active Analog Channels|0x00000000} | {Signal Trim|0x00000000} | {Digital Data|0x10000 bytes of samples}"];
+ *      message [label="{START|0xEA050000} | {Digital Size|0x00010000} | {Analog Size|0x00000000} | {Trigger|0x00000000} | {Digital Trig Sample|0x00000100} | {Analog Trig Sample|0x00000000} | {Active Digital Channels|0x00000008} | {Active Analog Channels|0x00000000} | {Signal Trim|0x00000000} | {Trigger Sample|0x00000103} | {Telemetry|45 words} | {Digital Data|0x10000 bytes of samples}"];
  *  }
  *  \enddot
  * Example 3: Successful sampling of \a A0 and \a A1:
  * \dot
  *  digraph structs {
  *      node [shape=record];
- *      message [label="{START|0xEA050000} | {Digital Size|0x00000000} | {Analog Size|0x00010000} | {Trigger|0x00000000} | {Digital Trig Sample|0x00000000} | {Analog Trig Sample|0x00001034} | {Active Digital Channels|0x00000000} | {Active Analog Channels|0x00000003} | {Signal Trim|0x00000000} | {Analog Data|0x10000 bytes of samples}"];
+ *      message [label="{START|0xEA050000} | {Digital Size|0x00000000} | {Analog Size|0x00010000} | {Trigger|0x00000000} | {Digital Trig Sample|0x00000000} | {Analog Trig Sample|0x00001034} | {Active Digital Channels|0x00000000} | {Active Analog Channels|0x00000003} | {Signal Trim|0x00000000} | {Trigger Sample|0x00001041} | {Telemetry|45 words} | {Analog Data|0x10000 bytes of samples}"];
  *  }
  *  \enddot
  * Example 4: Successful sampling of \a DIO_0 .. \a DIO_7 and both analog channels:
  * \dot
  *  digraph structs {
  *      node [shape=record];
- *      message [label="{START|0xEA050000} | {Digital Size|0x00003200} | {Analog Size|0x0000C800} | {Trigger|0x00000000} | {Digital Trig Sample|0x000000e4} | {Analog Trig Sample|0x00000102} | {Active Digital Channels|0x000000ff} | {Active Analog Channels|0x00000003} | {Signal Trim|0x00000042} | {Digital Data|0x3200 bytes of samples} | {Analog Data|0xC800 bytes of samples}"];
+ *      message [label="{START|0xEA050000} | {Digital Size|0x00003200} | {Analog Size|0x0000C800} | {Trigger|0x00000000} | {Digital Trig Sample|0x000000e4} | {Analog Trig Sample|0x00000102} | {Active Digital Channels|0x000000ff} | {Active Analog Channels|0x00000003} | {Signal Trim|0x00000042} | {Trigger Sample|0x000000e6} | {Telemetry|45 words} | {Digital Data|0x3200 bytes of samples} | {Analog Data|0xC800 bytes of samples}"];
  *  }
  *  \enddot
  *
  *****************************************************************************/
 static void LabTool_SendSamples(void)
 {
-  Bool success = FALSE;
+  int signalTrim;
+
+  LabTool_CollectTelemetry();
 
   /* Select the IN stream endpoint */
   Endpoint_SelectEndpoint(LABTOOL_IN_EPNUM);
@@ -728,6 +1225,8 @@ static void LabTool_SendSamples(void)
     Endpoint_Write_32_LE(0); //sgpio active channels
     Endpoint_Write_32_LE(0); //vadc active channels
     Endpoint_Write_32_LE(0); //signal trim
+    Endpoint_Write_32_LE(CAPTURE_TRIGGER_UNKNOWN); //trigger sample
+    LabTool_WriteTelemetry();
     Endpoint_ClearIN();
     haveSamplesToSend = FALSE;
     return;
@@ -739,28 +1238,95 @@ static void LabTool_SendSamples(void)
   Endpoint_Write_32_LE(samples.cap.vadcTrigSample);
   Endpoint_Write_32_LE(samples.cap.sgpioActiveChannels);
   Endpoint_Write_32_LE(samples.cap.vadcActiveChannels);
-  Endpoint_Write_32_LE(LabTool_AlignSignals());
+  signalTrim = LabTool_AlignSignals();
+  Endpoint_Write_32_LE(signalTrim);
+  Endpoint_Write_32_LE(LabTool_ExactTrigger(signalTrim));
+  LabTool_WriteTelemetry();
   Endpoint_ClearIN();
 
-  // send data
-  success = LabTool_SendBuffer(samples.cap.sgpio_samples);
-  if (success)
+  // The data is sent by the USB DMA once the client has read the header
+  uploadSize = circbuff_GetUsedSize(samples.cap.sgpio_samples) + circbuff_GetUsedSize(samples.cap.vadc_samples);
+  if (uploadSize > 0)
   {
-    success = LabTool_SendBuffer(samples.cap.vadc_samples);
+    uploadState = UPLOAD_HEADER;
+    uploadStartCycles = DWT->CYCCNT;
   }
+  else
+  {
+    haveSamplesToSend = FALSE;
+  }
+}
 
-  if (success)
+/**************************************************************************//**
+ *
+ * @brief  Sends captured I2C events to the client software
+ *
+ * Called repeatedly while the I2C monitor is active. A message is sent when
+ * a full message worth of events is available, when the oldest event has
+ * waited for \ref MON_FLUSH_INTERVAL or when the monitor has stopped. Each
+ * message is exactly \ref DATA_MAX_LEN bytes so that the client can keep a
+ * number of fixed size reads posted.
+ *
+ * The message is formatted like this:
+ *
+ * \dot
+ *  digraph structs {
+ *      node [shape=record];
+ *      message [label="{START|0xEA130000} | {Num Events|0x00000003} | {Lost Events|0x00000000} | {Flags|0x00000000} | {Event 0|{Timestamp|Status|Data}} | {...} | {Event 39|{Timestamp|Status|Data}} | {Padding|16 bytes}"];
+ *  }
+ *  \enddot
+ *
+ * Where each part is 32 bits. Bit 0 of \a Flags is set in the last message,
+ * i.e. when the monitor has stopped and all events have been sent.
+ *
+ *****************************************************************************/
+static void LabTool_SendMonitorData(void)
+{
+  uint32_t pending = monitor_i2c_Pending();
+  Bool running = monitor_i2c_IsRunning();
+  uint32_t num;
+  uint32_t flags = 0;
+
+  if (running && (pending < MON_RECORDS_PER_MSG))
+  {
+    if ((pending == 0) || ((monitor_i2c_GetTime() - monitor_i2c_OldestTime()) < MON_FLUSH_INTERVAL))
+    {
+      // wait for more events
+      return;
+    }
+  }
+
+  num = monitor_i2c_Read(monitorRecords, MON_RECORDS_PER_MSG);
+  if (!running && (monitor_i2c_Pending() == 0))
+  {
+    flags |= MON_FLAG_LAST;
+  }
+
+  /* Select the IN stream endpoint */
+  Endpoint_SelectEndpoint(LABTOOL_IN_EPNUM);
+
+  Endpoint_Write_32_LE(0xEA000000 | (CMD_MON_I2C_DATA<<16) | (CMD_STATUS_OK&0xff));
+  Endpoint_Write_32_LE(num);
+  Endpoint_Write_32_LE(monitor_i2c_Lost());
+  Endpoint_Write_32_LE(flags);
+  memset(&monitorRecords[num], 0, (MON_RECORDS_PER_MSG - num) * sizeof(monitor_i2c_record_t));
+  if (LabTool_SendData((uint8_t*)monitorRecords, 0, sizeof(monitorRecords)))
   {
+    // pad to a full message
+    memset(data_buff, 0, DATA_MAX_LEN - 16 - sizeof(monitorRecords));
+    LabTool_SendData(data_buff, 0, DATA_MAX_LEN - 16 - sizeof(monitorRecords));
     Endpoint_ClearIN();
-    log_i("All samples sent successfully. Trig %d, Active {SGPIO %#x, VADC %#x}\r\n",
-          samples.cap.trigpoint, samples.cap.sgpioActiveChannels, samples.cap.vadcActiveChannels);
   }
   else
   {
-    log_e("Failed to send samples to PC\r\n");
+    log_e("Failed to send I2C events to PC\r\n");
   }
 
-  haveSamplesToSend = FALSE;
+  if (flags & MON_FLAG_LAST)
+  {
+    log_i("I2C monitor done, %u events lost\r\n", monitor_i2c_Lost());
+    haveMonitorDataToSend = FALSE;
+  }
 }
 
 /**************************************************************************//**
@@ -818,342 +1384,11 @@ static void LabTool_SendCalibrationResult(void)
 static void SetupHardware(void)
 {
   USB_Init();
-}
-
-#if (PRINT_ANALOG_HISTOGRAM == OPT_ENABLED)
-#include "capture_vadc.h"
-#define HIST_CENTER      0x7ff
-#define HIST_SIZE        101
-#define HIST_BUFF_SIZE   (1 + HIST_SIZE + 1) //above,below and histogram data
-#define HIST_LOW_LEVEL   (HIST_CENTER - HIST_SIZE/2)
-#define HIST_HIGH_LEVEL  (HIST_CENTER + HIST_SIZE/2)
-#define HIST_BELOW_IDX   0
-#define HIST_ABOVE_IDX   (HIST_BUFF_SIZE-1)
-static uint32_t histBuff[2][HIST_BUFF_SIZE];
-static char histPrintBuff[HIST_BUFF_SIZE+1];
-static void LabTool_CreateHistogram(void)
-{
-  int i, ch;
-  int numSamples;
-  uint16_t* data;
-  uint16_t val;
-#define HIST_ACCED
-#ifdef HIST_ACCED
-  static int lastNumChannels = -1;
-  static int lastSampleRate = -1;
-  static int lastVdiv1 = -1;
-  static int lastVdiv2 = -1;
-  static int lastNumCollected = 0;
-  if ((lastNumChannels != (samples.cap.vadcActiveChannels >> 16)) ||
-      (lastSampleRate != capture_GetSampleRate()) ||
-      (lastVdiv1 != cap_vadc_GetMilliVoltsPerDiv(0)) ||
-      (lastVdiv2 != cap_vadc_GetMilliVoltsPerDiv(1)))
-  {
-    for (i = 0; i < HIST_BUFF_SIZE; i++)
-    {
-      histBuff[0][i] = 0;
-      histBuff[1][i] = 0;
-    }
-    lastNumCollected = 0;
-    lastNumChannels = (samples.cap.vadcActiveChannels >> 16);
-    lastSampleRate = capture_GetSampleRate();
-    lastVdiv1 = cap_vadc_GetMilliVoltsPerDiv(0);
-    lastVdiv2 = cap_vadc_GetMilliVoltsPerDiv(1);
-  }
-  lastNumCollected++;
-#else
-  for (i = 0; i < HIST_BUFF_SIZE; i++)
-  {
-    histBuff[0][i] = 0;
-    histBuff[1][i] = 0;
-  }
-#endif
-
-  if (samples.cap.vadc_samples != NULL)
-  {
-    data = (uint16_t*)samples.cap.vadc_samples->data;
-
-    // 2 bytes per sample
-    numSamples = circbuff_GetUsedSize(samples.cap.vadc_samples) / 2;
-
-    for (i = 0; i < numSamples; i++)
-    {
-      val = data[i] & 0xfff; // remove channel information
-      ch = ((data[i] >> 12) & 0x7);
-      if (val < HIST_LOW_LEVEL)
-      {
-        histBuff[ch][HIST_BELOW_IDX]++;
-      }
-      else if (val > HIST_HIGH_LEVEL)
-      {
-        histBuff[ch][HIST_ABOVE_IDX]++;
-      }
-      else
-      {
-        histBuff[ch][val - HIST_LOW_LEVEL]++;
-      }
-    }
-
-    // show histogram
-#if 0
-    log_i("HIST[BELOW] = %u\r\n", histBuff[HIST_BELOW_IDX]);
-    for (i = 0; i < HIST_SIZE; i++)
-    {
-      log_i("HIST[0x%03x] = %u%s\r\n", HIST_LOW_LEVEL+i, histBuff[i+1], ((HIST_LOW_LEVEL+i)==HIST_CENTER)?"  <-- CENTER":"");
-    }
-    log_i("HIST[ABOVE] = %u\r\n", histBuff[HIST_ABOVE_IDX]);
-#else
-
-#ifdef HIST_ACCED
-    log_i("HIST: (%d accumulated runs) %umV/div, %dHz Sample Rate\r\n", lastNumCollected, cap_vadc_GetMilliVoltsPerDiv(0), capture_GetSampleRate());
-#else
-    log_i("HIST: %umV/div, %dHz Sample Rate\r\n", cap_vadc_GetMilliVoltsPerDiv(0), capture_GetSampleRate());
-#endif
-    for (ch = 0; ch < 2; ch++)
-    {
-      Bool foundFirst = FALSE;
-      log_i("HIST: CH%d\r\n", ch);
-      for (i = 1000000; i > 0; i/=10)
-      {
-        int j;
-        uint32_t tmp;
-        memset(histPrintBuff, ((i==1)?'0':' '), HIST_BUFF_SIZE);
-        for (j = 0; j < HIST_BUFF_SIZE; j++)
-        {
-          tmp = histBuff[ch][j] / i;
-          if (tmp > 0)
-          {
-            histPrintBuff[j] = '0' + (tmp % 10);
-            foundFirst = TRUE;
-          }
-        }
-        if (foundFirst || i==10000)
-        {
-          log_i("HIST: %s\r\n", histPrintBuff);
-        }
-      }
-      memset(histPrintBuff, '-', HIST_BUFF_SIZE);
-      histPrintBuff[HIST_BELOW_IDX] = 'B';
-      histPrintBuff[HIST_CENTER - HIST_LOW_LEVEL] = 'C';
-      histPrintBuff[HIST_ABOVE_IDX] = 'A';
-      log_i("HIST: %s\r\n", histPrintBuff);
-    }
-    log_i("HIST: B is below %#x, C is %#x, A is above %#x\r\n", HIST_LOW_LEVEL, HIST_CENTER, HIST_HIGH_LEVEL);
-#endif
-  }
-}
-#endif //if(PRINT_ANALOG_HISTOGRAM == OPT_ENABLED)
-
-#if (FIND_SKIPPED_SAMPLES == OPT_ENABLED)
-/**************************************************************************//**
- *
- * @brief  Debugging Aid to help find skipped analog samples
- *
- * When sampling two analog channels at the same time and at a high sample
- * rate occasional "skips" are seen. As all samples have three bits identifying
- * which channel they come from it is possible to detect this by looking for
- * two consecutive samples from the same channel.
- *
- * Sample sequence without skips:
- *
- *     ch1, ch2, ch1, ch2, ch1, ch2, ...
- *
- * Sample sequence with skips:
- *
- *     ch1, ch2, ch1, ch1, ch2, ch1, ...
- *
- * It is not possible to know if only one ch2 sample is skipped above or if
- * it is one ch2 + N*(ch1 and ch2).
- *
- * This function scans the sampled data and prints the findings.
- *
- *****************************************************************************/
-static void LabTool_FindSkippedSamples(void)
-{
-  uint16_t* pSamples;
-  uint16_t  lastChannel;
-  uint16_t  tmp;
-  int       numSkipped = 0;
-  int       numSamples;
-  circbuff_t* buff = samples.cap.vadc_samples;
-
-  if ((samples.status != CMD_STATUS_OK) || (samples.cap.vadc_samples == NULL))
-  {
-    // nothing to do here
-    return;
-  }
-  if (samples.cap.vadcActiveChannels != 0x00020003)
-  {
-    // zero or one active channel, cannot find skipped samples
-    return;
-  }
-
-  // case where the circular buffer hasn't wrapped yet
-  if (buff->empty)
-  {
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    lastChannel = *pSamples & 0x7000;
-    while (--numSamples > 0)
-    {
-      pSamples++;
-      tmp = *pSamples & 0x7000;
-      if (tmp == lastChannel)
-      {
-        log_i("Skipped one or more samples at addr %#x, found 2 for channel %d in a row\r\n", (uint32_t)pSamples, tmp>>12);
-        numSkipped++;
-      }
-      lastChannel = tmp;
-    }
-  }
-  else
-  {
-    numSamples = (buff->size - buff->last)/2; //size is in bytes
-    pSamples = (uint16_t*)circbuff_GetFirstAddr(buff);
-    lastChannel = *pSamples & 0x7000;
-    while (--numSamples > 0)
-    {
-      pSamples++;
-      tmp = *pSamples & 0x7000;
-      if (tmp == lastChannel)
-      {
-        log_i("Skipped one or more samples at addr %#x, found 2 for channel %d in a row\r\n", (uint32_t)pSamples, tmp>>12);
-        numSkipped++;
-      }
-      lastChannel = tmp;
-    }
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    lastChannel = *pSamples & 0x7000;
-    while (--numSamples > 0)
-    {
-      pSamples++;
-      tmp = *pSamples & 0x7000;
-      if (tmp == lastChannel)
-      {
-        log_i("Skipped one or more samples at addr %#x, found 2 for channel %d in a row\r\n", (uint32_t)pSamples, tmp>>12);
-        numSkipped++;
-      }
-      lastChannel = tmp;
-    }
-  }
-
-  log_i("Found a total of %d skipped samples\r\n", numSkipped);
-}
-#endif //if(FIND_SKIPPED_SAMPLES == OPT_ENABLED)
-
-#if (PRINT_STATISTICS == OPT_ENABLED)
-typedef enum
-{
-  STATS_NUM,
-  STATS_MIN,
-  STATS_MAX,
-  STATS_SUM,
-
-  NUMBER_OF_STATS,
-} stats_t;
-static uint32_t stats[2][NUMBER_OF_STATS];
-static void LabTool_Stats(void)
-{
-  uint16_t* pSamples;
-  uint16_t  ch;
-  uint16_t  tmp;
-  int       numSamples;
-  circbuff_t* buff = samples.cap.vadc_samples;
-
-  if ((samples.status != CMD_STATUS_OK) || (samples.cap.vadc_samples == NULL))
-  {
-    // nothing to do here
-    return;
-  }
-  if (samples.cap.vadcActiveChannels != 0x00020003)
-  {
-    // zero or one active channel, cannot find stats (for now)
-    return;
-  }
-
-  memset(stats, 0, sizeof(uint32_t)*2*NUMBER_OF_STATS);
-  stats[0][STATS_MIN] = stats[1][STATS_MIN] = 0xffffff; // way above any valid value
-
-  // case where the circular buffer hasn't wrapped yet
-  if (buff->empty)
-  {
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    while (--numSamples > 0)
-    {
-      ch = (*pSamples & 0x7000)>>12;
-      tmp = *pSamples & 0x0fff;
-
-      stats[ch][STATS_NUM]++;
-      stats[ch][STATS_SUM] += tmp;
-      if (tmp < stats[ch][STATS_MIN])
-      {
-        stats[ch][STATS_MIN] = tmp;
-      }
-      if (tmp > stats[ch][STATS_MAX])
-      {
-        stats[ch][STATS_MAX] = tmp;
-      }
-
-      pSamples++;
-    }
-  }
-  else
-  {
-    numSamples = (buff->size - buff->last)/2; //size is in bytes
-    pSamples = (uint16_t*)circbuff_GetFirstAddr(buff);
-    while (--numSamples > 0)
-    {
-      ch = (*pSamples & 0x7000)>>12;
-      tmp = *pSamples & 0x0fff;
-
-      stats[ch][STATS_NUM]++;
-      stats[ch][STATS_SUM] += tmp;
-      if (tmp < stats[ch][STATS_MIN])
-      {
-        stats[ch][STATS_MIN] = tmp;
-      }
-      if (tmp > stats[ch][STATS_MAX])
-      {
-        stats[ch][STATS_MAX] = tmp;
-      }
-
-      pSamples++;
-    }
-    numSamples = buff->last/2; //last is in bytes
-    pSamples = (uint16_t*)buff->data;
-    while (--numSamples > 0)
-    {
-      ch = (*pSamples & 0x7000)>>12;
-      tmp = *pSamples & 0x0fff;
-
-      stats[ch][STATS_NUM]++;
-      stats[ch][STATS_SUM] += tmp;
-      if (tmp < stats[ch][STATS_MIN])
-      {
-        stats[ch][STATS_MIN] = tmp;
-      }
-      if (tmp > stats[ch][STATS_MAX])
-      {
-        stats[ch][STATS_MAX] = tmp;
-      }
 
-      pSamples++;
-    }
-  }
-
-  for (ch = 0; ch < 2; ch++)
-  {
-    log_i("Stats: CH%d: Num: %5u, Min %4u (0x%03x), Max %4u (0x%03x), Avg: %4u (0x%03x)\r\n",
-          ch, stats[ch][STATS_NUM],
-          stats[ch][STATS_MIN], stats[ch][STATS_MIN],
-          stats[ch][STATS_MAX], stats[ch][STATS_MAX],
-          (stats[ch][STATS_SUM]/stats[ch][STATS_NUM]),
-          (stats[ch][STATS_SUM]/stats[ch][STATS_NUM]));
-  }
+  // The cycle counter is used to measure how long it takes to send samples
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 }
-#endif //if (PRINT_STATISTICS == OPT_ENABLED)
 
 /******************************************************************************
  * Global Functions
@@ -1243,6 +1478,9 @@ void EVENT_USB_Device_ControlRequest(void)
     {
       const calib_result_t* calib;
       const uint32_t* calibdata;
+      uint32_t genBlocks, genUnderruns;
+      uint32_t sgpioDepth, vadcDepth;
+      uint32_t peekSize;
       int i;
 
       switch (USB_ControlRequest.bRequest)
@@ -1270,6 +1508,33 @@ void EVENT_USB_Device_ControlRequest(void)
           Endpoint_ClearIN();
           Endpoint_ClearStatusStage();
           break;
+
+        case REQ_GetGenStatus:
+          gen_sgpio_StreamStatus(&genBlocks, &genUnderruns);
+          Endpoint_ClearSETUP();
+          Endpoint_Write_32_LE(genBlocks);
+          Endpoint_Write_32_LE(genUnderruns);
+          Endpoint_ClearIN();
+          Endpoint_ClearStatusStage();
+          break;
+
+        case REQ_GetCaptureDepth:
+          capture_GetDepth(&sgpioDepth, &vadcDepth);
+          Endpoint_ClearSETUP();
+          Endpoint_Write_32_LE(sgpioDepth);
+          Endpoint_Write_32_LE(vadcDepth);
+          Endpoint_ClearIN();
+          Endpoint_ClearStatusStage();
+          break;
+
+        case REQ_PeekCapture:
+          // Only reads the capture buffers so an armed capture is not
+          // affected, and the bulk endpoint is left for the samples
+          peekSize = capture_Peek((uint8_t*)peekBuff, sizeof(peekBuff));
+          Endpoint_ClearSETUP();
+          Endpoint_Write_Control_Stream_LE(peekBuff, peekSize);
+          Endpoint_ClearStatusStage();
+          break;
       }
     }
     else if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_INTERFACE))
@@ -1292,8 +1557,35 @@ void EVENT_USB_Device_ControlRequest(void)
           log_i("Control Request: Stop Generator\r\n");
           stopGeneratorRequested = TRUE;
           Endpoint_ClearSETUP();
+          if (gen_sgpio_IsStreaming())
+          {
+            // Stop before the next command arrives as it would otherwise be
+            // taken for streamed data
+            callbacks.genStop();
+            LabTool_DiscardStream();
+          }
           Endpoint_ClearStatusStage();
           break;
+        case REQ_UpdateAnalogConfig:
+          // Leaving the request unhandled makes the library stall it
+          if (USB_ControlRequest.wLength != sizeof(cap_vadc_cfg_t))
+          {
+            break;
+          }
+          Endpoint_ClearSETUP();
+          Endpoint_Read_Control_Stream_LE(updateBuff, sizeof(cap_vadc_cfg_t));
+          if (capture_UpdateAnalogConfig((uint8_t*)updateBuff, sizeof(cap_vadc_cfg_t)) == CMD_STATUS_OK)
+          {
+            // A capture waiting for its trigger is armed again with the new settings
+            rearmCaptureRequested = TRUE;
+            Endpoint_ClearStatusStage();
+          }
+          else
+          {
+            // Fails the status stage so that the client can fall back to a new configuration
+            Endpoint_StallTransaction();
+          }
+          break;
       }
     }
   }
@@ -1464,11 +1756,32 @@ void usb_handler_Run(void)
     WWDT_Feed();
     if (stopCaptureRequested)
     {
-      callbacks.capStop();
+      if (statemachine_GetState() == STATE_MONITORING)
+      {
+        monitor_i2c_Stop();
+        haveMonitorDataToSend = FALSE;
+      }
+      else
+      {
+        callbacks.capStop();
+      }
+      LabTool_AbortUpload();
       haveSamplesToSend = FALSE;
       stopCaptureRequested = FALSE;
       log_i("-------> capture stopped\r\n");
     }
+    else if (rearmCaptureRequested)
+    {
+      cmd_status_t status;
+
+      rearmCaptureRequested = FALSE;
+      status = capture_Rearm();
+      if (status != CMD_STATUS_OK)
+      {
+        // The client is waiting for the samples so the error is reported in their header
+        usb_handler_SignalFailedSampling(status);
+      }
+    }
     else if (stopGeneratorRequested)
     {
       callbacks.genStop();
@@ -1496,24 +1809,33 @@ void usb_handler_Run(void)
         calibrate_Feed();
       }
     }
+    else if (haveSamplesToSend && (uploadState != UPLOAD_IDLE))
+    {
+      LabTool_ContinueUpload();
+    }
     else if (haveSamplesToSend)
     {
       LED_TRIG_ON();
       LED_ARM_OFF();
 
-#if (FIND_SKIPPED_SAMPLES == OPT_ENABLED)
-      LabTool_FindSkippedSamples();
-#endif
-#if (PRINT_ANALOG_HISTOGRAM == OPT_ENABLED)
-      LabTool_CreateHistogram();
-#endif
-#if (PRINT_STATISTICS == OPT_ENABLED)
-      LabTool_Stats();
-#endif
       LabTool_SendSamples();
-      LED_TRIG_OFF();
+      if (!haveSamplesToSend)
+      {
+        LED_TRIG_OFF();
+      }
+    }
+    else if (haveMonitorDataToSend)
+    {
+      LabTool_SendMonitorData();
+    }
+    if (gen_sgpio_IsStreaming())
+    {
+      LabTool_ProcessStream();
+    }
+    else
+    {
+      LabTool_ProcessCommand();
     }
-    LabTool_ProcessCommand();
     USB_USBTask();
   }
 }
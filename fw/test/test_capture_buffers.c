@@ -0,0 +1,163 @@
+/*!
+ * @file
+ * @brief     Host unit tests for the partitioning of the capture buffers
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_buffers.h"
+#include "test_util.h"
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+static uint32_t minDepth(uint32_t a, uint32_t b)
+{
+  return (a < b) ? a : b;
+}
+
+/* The best possible smallest depth, found by trying every analog buffer size */
+static uint32_t bruteForce(uint32_t enabledSgpioChannels, uint32_t numVADC, uint32_t memorySize)
+{
+  uint32_t unitSize, samplesPerUnit, vadcSize, depth;
+  uint32_t best = 0;
+
+  capture_buffers_SgpioUnit(enabledSgpioChannels, &unitSize, &samplesPerUnit);
+  for (vadcSize = CAPTURE_BUFFERS_VADC_GRANULE; vadcSize < memorySize; vadcSize += CAPTURE_BUFFERS_VADC_GRANULE)
+  {
+    depth = minDepth(((memorySize - vadcSize) / unitSize) * samplesPerUnit,
+                     vadcSize / (numVADC * 2));
+    if (depth > best)
+    {
+      best = depth;
+    }
+  }
+  return best;
+}
+
+static void checkPartition(uint32_t enabledSgpioChannels, uint32_t numVADC, uint32_t memorySize)
+{
+  capture_buffers_t b;
+  uint32_t unitSize, samplesPerUnit, depth;
+
+  depth = capture_buffers_Partition(enabledSgpioChannels, numVADC, memorySize, &b);
+  capture_buffers_SgpioUnit(enabledSgpioChannels, &unitSize, &samplesPerUnit);
+
+  if (numVADC > 2 || (numVADC == 0 && enabledSgpioChannels == 0))
+  {
+    assert(depth == 0);
+    assert(b.sgpioSize == 0 && b.vadcSize == 0);
+    return;
+  }
+
+  /* the buffers never overlap and the analog buffer ends the memory */
+  assert(b.vadcOffset + b.vadcSize == memorySize);
+  assert(b.sgpioSize <= b.vadcOffset);
+
+  if (enabledSgpioChannels == 0)
+  {
+    assert(b.sgpioSize == 0 && b.sgpioDepth == 0);
+  }
+  else
+  {
+    assert(unitSize > 0 && samplesPerUnit > 0);
+    assert((b.sgpioSize % unitSize) == 0);
+    assert(b.sgpioDepth == (b.sgpioSize / unitSize) * samplesPerUnit);
+  }
+
+  if (numVADC == 0)
+  {
+    assert(b.vadcSize == 0 && b.vadcDepth == 0);
+    assert(depth == b.sgpioDepth);
+    /* less than one unit left unused */
+    assert(memorySize - b.sgpioSize < unitSize);
+    return;
+  }
+
+  assert((b.vadcSize % (numVADC * 2)) == 0);
+  assert(b.vadcDepth == b.vadcSize / (numVADC * 2));
+
+  if (enabledSgpioChannels == 0)
+  {
+    assert(depth == b.vadcDepth);
+    assert(memorySize - b.vadcSize < numVADC * 2);
+    return;
+  }
+
+  /* the VADC DMA needs equally sized LLIs */
+  assert((b.vadcSize % CAPTURE_BUFFERS_VADC_GRANULE) == 0);
+  assert(depth == minDepth(b.sgpioDepth, b.vadcDepth));
+  assert(depth == bruteForce(enabledSgpioChannels, numVADC, memorySize));
+}
+
+/* Every number of digital signals with every number of analog signals */
+static void testAllCombinations(void)
+{
+  uint32_t numSgpio, numVADC;
+
+  for (numSgpio = 0; numSgpio <= 16; numSgpio++)
+  {
+    for (numVADC = 0; numVADC <= 3; numVADC++)
+    {
+      checkPartition((1u << numSgpio) - 1, numVADC, CAPTURE_BUFFERS_MEMORY_SIZE);
+    }
+  }
+}
+
+/* The unit is selected by the highest enabled signal, not the number of signals */
+static void testSparseChannels(void)
+{
+  uint32_t t, mask, numVADC;
+
+  for (t = 0; t < 2000; t++)
+  {
+    mask = test_RandomBelow(0x10000);
+    numVADC = test_RandomBelow(3);
+    checkPartition(mask, numVADC, CAPTURE_BUFFERS_MEMORY_SIZE);
+  }
+}
+
+static void testMemorySizes(void)
+{
+  uint32_t t, memorySize;
+
+  for (t = 0; t < 2000; t++)
+  {
+    memorySize = 1 + test_RandomBelow(2 * CAPTURE_BUFFERS_MEMORY_SIZE);
+    checkPartition(test_RandomBelow(0x10000), test_RandomBelow(4), memorySize);
+  }
+
+  /* too small for both buffers */
+  checkPartition(0x1, 1, CAPTURE_BUFFERS_VADC_GRANULE);
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+int main(void)
+{
+  testAllCombinations();
+  testSparseChannels();
+  testMemorySizes();
+  return test_Done("test_capture_buffers");
+}
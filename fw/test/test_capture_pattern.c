@@ -0,0 +1,225 @@
+/*!
+ * @file
+ * @brief     Host unit tests for the pattern and sequence trigger
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_pattern.h"
+#include "test_util.h"
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+#define MAX_WORDS    64
+#define ALL_SIGNALS  ((1 << CAPTURE_PATTERN_MAX_SIGNALS) - 1)
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+/* 32 samples of each signal per group, as read from the SGPIO */
+static uint32_t words[MAX_WORDS][CAPTURE_PATTERN_MAX_SIGNALS];
+
+/* the same samples with all signals of one sample in each word */
+static uint32_t levels[MAX_WORDS * 32];
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/* A signal that is mostly idle or slowly toggling so that patterns of a
+   few signals match now and then */
+static uint32_t randomSignalWord(void)
+{
+  switch (test_RandomBelow(6))
+  {
+    case 0:  return 0;
+    case 1:  return 0xffffffff;
+    case 2:  return 0xffffffff << test_RandomBelow(32);
+    case 3:  return 0xffffffff >> test_RandomBelow(32);
+    case 4:  return 0x0000ffff << test_RandomBelow(17);
+    default: return test_Random();
+  }
+}
+
+static void makeSamples(uint32_t numWords)
+{
+  uint32_t w, ch, s;
+
+  for (w = 0; w < numWords; w++)
+  {
+    for (ch = 0; ch < CAPTURE_PATTERN_MAX_SIGNALS; ch++)
+    {
+      words[w][ch] = randomSignalWord();
+    }
+    for (s = 0; s < 32; s++)
+    {
+      levels[w * 32 + s] = 0;
+      for (ch = 0; ch < CAPTURE_PATTERN_MAX_SIGNALS; ch++)
+      {
+        levels[w * 32 + s] |= ((words[w][ch] >> s) & 1) << ch;
+      }
+    }
+  }
+}
+
+/* A stage with one to three signals */
+static uint32_t randomStage(void)
+{
+  uint32_t care = 0;
+  uint32_t n = 1 + test_RandomBelow(3);
+
+  while (n-- > 0)
+  {
+    care |= 1 << test_RandomBelow(CAPTURE_PATTERN_MAX_SIGNALS);
+  }
+  return CAPTURE_PATTERN_STAGE(care, test_Random());
+}
+
+/* Runs the 32-sample search and returns the trigger sample */
+static uint32_t stepSearch(capture_pattern_t* pattern, uint32_t numWords)
+{
+  uint32_t w;
+  int pos;
+
+  capture_pattern_Reset(pattern);
+  for (w = 0; w < numWords; w++)
+  {
+    pos = capture_pattern_Step(pattern, words[w]);
+    if (pos >= 0)
+    {
+      assert(pos < 32);
+      return w * 32 + pos;
+    }
+  }
+  return CAPTURE_PATTERN_NOT_FOUND;
+}
+
+static void testAgainstReference(void)
+{
+  capture_pattern_t pattern;
+  uint32_t stages[CAPTURE_PATTERN_MAX_STAGES];
+  uint32_t t, numWords, expected;
+  uint32_t found = 0;
+
+  for (t = 0; t < 50000; t++)
+  {
+    stages[0] = randomStage();
+    stages[1] = (test_RandomBelow(2) == 0) ? 0 : randomStage();
+    assert(capture_pattern_Init(&pattern, stages, ALL_SIGNALS) == 0);
+    assert(pattern.numStages == ((stages[1] != 0) ? 2u : 1u));
+
+    numWords = 1 + test_RandomBelow(MAX_WORDS);
+    makeSamples(numWords);
+
+    expected = capture_pattern_Reference(&pattern, levels, numWords * 32);
+    assert(stepSearch(&pattern, numWords) == expected);
+    if (expected != CAPTURE_PATTERN_NOT_FOUND)
+    {
+      found++;
+    }
+  }
+
+  /* make sure that both outcomes were tested */
+  assert(found > 1000 && found < 49000);
+}
+
+static void testEdges(void)
+{
+  capture_pattern_t pattern;
+  uint32_t stages[CAPTURE_PATTERN_MAX_STAGES];
+
+  /* DIO_0 high, then DIO_1 high */
+  stages[0] = CAPTURE_PATTERN_STAGE(0x1, 0x1);
+  stages[1] = CAPTURE_PATTERN_STAGE(0x2, 0x2);
+  assert(capture_pattern_Init(&pattern, stages, 0x3) == 0);
+  assert(capture_pattern_Signals(&pattern) == 0x3);
+
+  /* already matching when the search starts, must go away first */
+  words[0][0] = 0xffffffff;
+  words[0][1] = 0xffffffff;
+  words[1][0] = 0xfffffffe;
+  words[1][1] = 0xfffffffe;
+  assert(stepSearch(&pattern, 2) == CAPTURE_PATTERN_NOT_FOUND);
+
+  /* both stages on the same sample is not a sequence */
+  words[0][0] = 0xffff0000;
+  words[0][1] = 0xffff0000;
+  words[1][0] = 0xffffffff;
+  words[1][1] = 0xffffffff;
+  assert(stepSearch(&pattern, 2) == CAPTURE_PATTERN_NOT_FOUND);
+
+  /* second stage found in the next word */
+  words[0][1] = 0x00000000;
+  words[1][1] = 0x00000100;
+  assert(stepSearch(&pattern, 2) == 32 + 8);
+
+  /* second stage on the sample after the first one in the same word */
+  words[0][0] = 0x80000000;
+  words[0][1] = 0x00000000;
+  words[1][1] = 0x00000000;
+  assert(stepSearch(&pattern, 2) == CAPTURE_PATTERN_NOT_FOUND);
+  words[0][0] = 0x40000000;
+  words[0][1] = 0x80000000;
+  assert(stepSearch(&pattern, 1) == 31);
+}
+
+static void testInitRejects(void)
+{
+  capture_pattern_t pattern;
+  uint32_t stages[CAPTURE_PATTERN_MAX_STAGES];
+
+  /* no pattern at all is valid but never triggers */
+  stages[0] = 0;
+  stages[1] = 0;
+  assert(capture_pattern_Init(&pattern, stages, ALL_SIGNALS) == 0);
+  assert(pattern.numStages == 0);
+  assert(capture_pattern_Signals(&pattern) == 0);
+  assert(capture_pattern_Step(&pattern, words[0]) == -1);
+
+  /* a stage without signals */
+  stages[0] = CAPTURE_PATTERN_STAGE(0, 0);
+  assert(capture_pattern_Init(&pattern, stages, ALL_SIGNALS) == -1);
+
+  /* a signal that is not captured */
+  stages[0] = CAPTURE_PATTERN_STAGE(0x9, 0x1);
+  assert(capture_pattern_Init(&pattern, stages, 0x1) == -1);
+
+  /* second stage without a first one */
+  stages[0] = 0;
+  stages[1] = CAPTURE_PATTERN_STAGE(0x1, 0x1);
+  assert(capture_pattern_Init(&pattern, stages, ALL_SIGNALS) == -1);
+  assert(pattern.numStages == 0);
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+int main(void)
+{
+  testInitRejects();
+  testEdges();
+  testAgainstReference();
+  return test_Done("test_capture_pattern");
+}
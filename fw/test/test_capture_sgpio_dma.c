@@ -0,0 +1,246 @@
+/*!
+ * @file
+ * @brief     Host unit tests for the SGPIO capture DMA calculations
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "capture_sgpio_dma.h"
+#include "test_util.h"
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+#define MAX_LLIS   1024
+#define MAX_UNITS  64
+
+/* transfer size field of the control word */
+#define TRANSFER_SIZE_MASK  0xfff
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+static capture_sgpio_dma_lli_t llis[MAX_LLIS + 1];
+static uint32_t data[MAX_UNITS * CAPTURE_SGPIO_DMA_UNIT_WORDS];
+static uint32_t original[MAX_UNITS * CAPTURE_SGPIO_DMA_UNIT_WORDS];
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+static void testBuildRing(void)
+{
+  const uint32_t src = 0x40101100;
+  const uint32_t dst = 0x20000000;
+  const uint32_t control = 0x0c4c9fff;
+  uint32_t t, i, size, n;
+
+  for (t = 0; t < 500; t++)
+  {
+    size = test_RandomBelow((MAX_LLIS + 2) * CAPTURE_SGPIO_DMA_UNIT_SIZE);
+    memset(llis, 0xa5, sizeof(llis));
+
+    n = capture_sgpio_dma_BuildRing(llis, MAX_LLIS, src, dst, size, control);
+    if (size < CAPTURE_SGPIO_DMA_UNIT_SIZE || size / CAPTURE_SGPIO_DMA_UNIT_SIZE > MAX_LLIS)
+    {
+      assert(n == 0);
+      continue;
+    }
+
+    /* only whole units, the rest of the buffer is not used */
+    assert(n == size / CAPTURE_SGPIO_DMA_UNIT_SIZE);
+
+    for (i = 0; i < n; i++)
+    {
+      /* every exchange starts over at the first shadow register */
+      assert(llis[i].srcAddr == src);
+      assert(llis[i].dstAddr == dst + i * CAPTURE_SGPIO_DMA_UNIT_SIZE);
+      assert((llis[i].control & ~TRANSFER_SIZE_MASK) == (control & ~TRANSFER_SIZE_MASK));
+      assert((llis[i].control & TRANSFER_SIZE_MASK) == CAPTURE_SGPIO_DMA_UNIT_WORDS);
+
+      /* a ring, the last one links back to the first */
+      assert(llis[i].nextLLI == (uint32_t)(uintptr_t)&llis[(i + 1) % n]);
+    }
+
+    /* nothing written past the ring */
+    assert(llis[n].srcAddr == 0xa5a5a5a5);
+  }
+}
+
+static void testBuildGather(void)
+{
+  const uint32_t regs = 0x40101100;
+  const uint32_t staging = 0x10001000;
+  const uint32_t control = 0x0c4c9fff;
+  uint8_t order[CAPTURE_SGPIO_DMA_UNIT_WORDS];
+  uint32_t t, i, numSlices, n;
+
+  for (t = 0; t < 500; t++)
+  {
+    numSlices = test_RandomBelow(CAPTURE_SGPIO_DMA_UNIT_WORDS + 2);
+    for (i = 0; i < CAPTURE_SGPIO_DMA_UNIT_WORDS; i++)
+    {
+      order[i] = test_RandomBelow(CAPTURE_SGPIO_DMA_UNIT_WORDS);
+    }
+    memset(llis, 0xa5, sizeof(llis));
+
+    n = capture_sgpio_dma_BuildGather(llis, MAX_LLIS, regs, order, numSlices, staging, control);
+    if (numSlices == 0 || numSlices > CAPTURE_SGPIO_DMA_UNIT_WORDS)
+    {
+      assert(n == 0);
+      continue;
+    }
+
+    /* one LLI per slice and one that writes to the buffer */
+    assert(n == numSlices + 1);
+
+    for (i = 0; i < numSlices; i++)
+    {
+      assert(llis[i].srcAddr == regs + order[i] * 4);
+      assert(llis[i].dstAddr == staging + i * 4);
+      assert(llis[i].nextLLI == (uint32_t)(uintptr_t)&llis[i + 1]);
+      assert((llis[i].control & ~TRANSFER_SIZE_MASK) == (control & ~TRANSFER_SIZE_MASK));
+      assert((llis[i].control & TRANSFER_SIZE_MASK) == 1);
+    }
+
+    /* the gathered words in one go, ends the chain */
+    assert(llis[numSlices].srcAddr == staging);
+    assert(llis[numSlices].dstAddr == 0);
+    assert(llis[numSlices].nextLLI == 0);
+    assert((llis[numSlices].control & ~TRANSFER_SIZE_MASK) == (control & ~TRANSFER_SIZE_MASK));
+    assert((llis[numSlices].control & TRANSFER_SIZE_MASK) == numSlices);
+
+    /* nothing written past the chain */
+    assert(llis[n].srcAddr == 0xa5a5a5a5);
+  }
+
+  /* the chain must fit */
+  assert(capture_sgpio_dma_BuildGather(llis, 3, regs, order, 3, staging, control) == 0);
+  assert(capture_sgpio_dma_BuildGather(llis, 4, regs, order, 3, staging, control) == 4);
+}
+
+static void testPostFill(void)
+{
+  uint32_t t, limit, percent, maxSamples, result, expected;
+
+  /* invalid percent */
+  assert(capture_sgpio_dma_PostFill(100, 101, &result) == -1);
+
+  for (t = 0; t < 100000; t++)
+  {
+    limit = test_RandomBelow(2048);
+    percent = test_RandomBelow(101);
+    maxSamples = (test_RandomBelow(4) == 0) ? 0xffffff : test_RandomBelow(4096);
+
+    assert(capture_sgpio_dma_PostFill(limit, (maxSamples << 8) | percent, &result) == 0);
+
+    expected = (limit * percent) / 100;
+    if (expected > maxSamples)
+    {
+      expected = maxSamples;
+    }
+    if (expected < 1)
+    {
+      expected = 1;
+    }
+    if (limit > 5 && expected > limit - 5)
+    {
+      expected = limit - 5;
+    }
+    assert(result == expected);
+
+    /* at least one exchange after the trigger and five before it */
+    assert(result >= 1);
+    if (limit > 5)
+    {
+      assert(result <= limit - 5);
+    }
+  }
+
+  /* a full post fill still leaves room for the trigger delay */
+  assert(capture_sgpio_dma_PostFill(1000, 100 | (0xffffff << 8), &result) == 0);
+  assert(result == 995);
+  assert(capture_sgpio_dma_PostFill(1000, 50 | (20 << 8), &result) == 0);
+  assert(result == 20);
+  assert(capture_sgpio_dma_PostFill(1000, 0, &result) == 0);
+  assert(result == 1);
+}
+
+static void testReorder(void)
+{
+  uint8_t order[CAPTURE_SGPIO_DMA_UNIT_WORDS];
+  uint32_t t, u, i, j, numUnits, numOut, size;
+
+  for (t = 0; t < 2000; t++)
+  {
+    numUnits = 1 + test_RandomBelow(MAX_UNITS);
+    numOut = 1 + test_RandomBelow(CAPTURE_SGPIO_DMA_UNIT_WORDS);
+
+    /* a random selection of distinct slices, as in the order tables */
+    for (i = 0; i < CAPTURE_SGPIO_DMA_UNIT_WORDS; i++)
+    {
+      order[i] = (uint8_t)i;
+    }
+    for (i = CAPTURE_SGPIO_DMA_UNIT_WORDS - 1; i > 0; i--)
+    {
+      uint8_t tmp;
+      j = test_RandomBelow(i + 1);
+      tmp = order[i];
+      order[i] = order[j];
+      order[j] = tmp;
+    }
+
+    for (i = 0; i < numUnits * CAPTURE_SGPIO_DMA_UNIT_WORDS; i++)
+    {
+      original[i] = data[i] = test_Random();
+    }
+
+    size = capture_sgpio_dma_Reorder(data, numUnits, order, numOut);
+    assert(size == numUnits * numOut * 4);
+
+    /* done in place, each unit shrinks to numOut words */
+    for (u = 0; u < numUnits; u++)
+    {
+      for (i = 0; i < numOut; i++)
+      {
+        assert(data[u * numOut + i] == original[u * CAPTURE_SGPIO_DMA_UNIT_WORDS + order[i]]);
+      }
+    }
+  }
+
+  assert(capture_sgpio_dma_Reorder(data, 1, order, CAPTURE_SGPIO_DMA_UNIT_WORDS + 1) == 0);
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+int main(void)
+{
+  testBuildRing();
+  testBuildGather();
+  testPostFill();
+  testReorder();
+  return test_Done("test_capture_sgpio_dma");
+}
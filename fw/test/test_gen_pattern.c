@@ -0,0 +1,239 @@
+/*!
+ * @file
+ * @brief     Host unit tests for the generator pattern encoder and expander
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "gen_pattern.h"
+#include "test_util.h"
+#include <stdlib.h>
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+#define MAX_BLOCKS  256
+#define MAX_WORDS   (4 * MAX_BLOCKS * GEN_PATTERN_MAX_CHANNELS)
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+static uint32_t blocks[MAX_BLOCKS * GEN_PATTERN_MAX_CHANNELS];
+static uint32_t expanded[(MAX_BLOCKS + 1) * GEN_PATTERN_MAX_CHANNELS];
+static uint32_t encoded[MAX_WORDS];
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+/* Mostly idle levels with the occasional random word, like real signals */
+static uint32_t randomWord(void)
+{
+  switch (test_RandomBelow(4))
+  {
+    case 0:  return 0;
+    case 1:  return 0xffffffff;
+    case 2:  return 0x55555555;
+    default: return test_Random();
+  }
+}
+
+/* Fills numBlocks blocks with a period of random blocks, each repeated up
+   to runLen times, and then copies the period to fill the rest. */
+static void makeBlocks(uint32_t numBlocks, uint32_t blockSize, uint32_t period, uint32_t runLen)
+{
+  uint32_t i, k, run;
+
+  for (i = 0; i < period; i += run)
+  {
+    run = 1 + test_RandomBelow(runLen);
+    for (k = 0; k < blockSize; k++)
+    {
+      blocks[i * blockSize + k] = randomWord();
+    }
+    for (k = 1; k < run && (i + k) < period; k++)
+    {
+      memcpy(&blocks[(i + k) * blockSize], &blocks[i * blockSize], blockSize * sizeof(uint32_t));
+    }
+  }
+  for (i = period; i < numBlocks; i++)
+  {
+    memcpy(&blocks[i * blockSize], &blocks[(i % period) * blockSize], blockSize * sizeof(uint32_t));
+  }
+}
+
+static void checkRoundTrip(uint32_t numBlocks, uint32_t blockSize)
+{
+  gen_pattern_cursor_t cursor;
+  uint32_t block[GEN_PATTERN_MAX_CHANNELS];
+  uint32_t words, n, i;
+
+  words = gen_pattern_Encode(blocks, numBlocks, blockSize, encoded, MAX_WORDS);
+  assert(words > 0);
+
+  /* a literal of everything is the worst case, two words of overhead for a group */
+  assert(words <= 3 + numBlocks * (blockSize + 1));
+
+  assert(gen_pattern_Validate(encoded, words, blockSize) == numBlocks);
+
+  /* one more block than needed to catch output past the end */
+  n = gen_pattern_Expand(encoded, words, blockSize, expanded, numBlocks + 1);
+  assert(n == numBlocks);
+  assert(memcmp(expanded, blocks, numBlocks * blockSize * sizeof(uint32_t)) == 0);
+
+  /* the cursor is what the SGPIO interrupt uses */
+  gen_pattern_Start(&cursor, encoded, words, blockSize);
+  for (i = 0; i < numBlocks; i++)
+  {
+    assert(gen_pattern_NextBlock(&cursor, block) == 1);
+    assert(memcmp(block, &blocks[i * blockSize], blockSize * sizeof(uint32_t)) == 0);
+  }
+  assert(gen_pattern_NextBlock(&cursor, block) == 0);
+
+  /* truncating the pattern must never validate as the same length */
+  if (words > 1)
+  {
+    assert(gen_pattern_Validate(encoded, words - 1, blockSize) != numBlocks);
+  }
+}
+
+static void testRandomRoundTrips(void)
+{
+  uint32_t t, blockSize, period, reps, numBlocks;
+
+  for (t = 0; t < 3000; t++)
+  {
+    blockSize = 1 + test_RandomBelow(GEN_PATTERN_MAX_CHANNELS);
+    period = 1 + test_RandomBelow(16);
+    reps = 1 + test_RandomBelow(MAX_BLOCKS / period);
+    numBlocks = period * reps;
+    if (test_RandomBelow(4) == 0 && numBlocks < MAX_BLOCKS)
+    {
+      /* not a whole number of periods */
+      numBlocks++;
+    }
+    makeBlocks(numBlocks, blockSize, period, 1 + test_RandomBelow(8));
+    checkRoundTrip(numBlocks, blockSize);
+  }
+}
+
+static void testCompression(void)
+{
+  uint32_t words;
+
+  /* an idle level is a single repeat record */
+  memset(blocks, 0, sizeof(blocks));
+  words = gen_pattern_Encode(blocks, MAX_BLOCKS, 3, encoded, MAX_WORDS);
+  assert(words == 1 + 3);
+  assert(encoded[0] == GEN_PATTERN_RECORD(GEN_PATTERN_OP_REPEAT, MAX_BLOCKS));
+
+  /* a repeated frame is a group */
+  makeBlocks(MAX_BLOCKS, 2, 4, 1);
+  words = gen_pattern_Encode(blocks, MAX_BLOCKS, 2, encoded, MAX_WORDS);
+  assert(GEN_PATTERN_OP(encoded[0]) == GEN_PATTERN_OP_GROUP);
+  assert(GEN_PATTERN_COUNT(encoded[0]) == MAX_BLOCKS / 4);
+  assert(words <= 2 + 4 * 3);
+}
+
+static void testEncodeLimits(void)
+{
+  makeBlocks(64, 4, 64, 1);
+  assert(gen_pattern_Encode(blocks, 64, 4, encoded, 8) == 0);
+  assert(gen_pattern_Encode(blocks, 0, 4, encoded, MAX_WORDS) == 0);
+  assert(gen_pattern_Encode(blocks, 64, 0, encoded, MAX_WORDS) == 0);
+  assert(gen_pattern_Encode(blocks, 64, GEN_PATTERN_MAX_CHANNELS + 1, encoded, MAX_WORDS) == 0);
+}
+
+static void testValidateRejects(void)
+{
+  uint32_t d[8];
+
+  /* zero count */
+  d[0] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_REPEAT, 0);
+  d[1] = 0;
+  assert(gen_pattern_Validate(d, 2, 1) == 0);
+
+  /* unknown operation */
+  d[0] = GEN_PATTERN_RECORD(0x7f, 1);
+  assert(gen_pattern_Validate(d, 2, 1) == 0);
+
+  /* literal longer than the data */
+  d[0] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_LITERAL, 2);
+  assert(gen_pattern_Validate(d, 2, 1) == 0);
+
+  /* empty group */
+  d[0] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_GROUP, 2);
+  d[1] = 0;
+  assert(gen_pattern_Validate(d, 2, 1) == 0);
+
+  /* group size past the end */
+  d[1] = 3;
+  d[2] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_REPEAT, 1);
+  d[3] = 0;
+  assert(gen_pattern_Validate(d, 4, 1) == 0);
+
+  /* record crossing the end of the group */
+  d[1] = 1;
+  assert(gen_pattern_Validate(d, 4, 1) == 0);
+
+  /* nested group */
+  d[1] = 4;
+  d[2] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_GROUP, 2);
+  d[3] = 2;
+  d[4] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_REPEAT, 1);
+  d[5] = 0;
+  assert(gen_pattern_Validate(d, 6, 1) == 0);
+
+  /* bad block sizes */
+  d[0] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_REPEAT, 1);
+  d[1] = 0;
+  assert(gen_pattern_Validate(d, 2, 1) == 1);
+  assert(gen_pattern_Validate(d, 2, 0) == 0);
+  assert(gen_pattern_Validate(d, 2, GEN_PATTERN_MAX_CHANNELS + 1) == 0);
+
+  /* a valid group: 3 x (2 x repeat + 1 literal) */
+  d[0] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_GROUP, 3);
+  d[1] = 4;
+  d[2] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_REPEAT, 2);
+  d[3] = 0x1;
+  d[4] = GEN_PATTERN_RECORD(GEN_PATTERN_OP_LITERAL, 1);
+  d[5] = 0x2;
+  assert(gen_pattern_Validate(d, 6, 1) == 9);
+  assert(gen_pattern_Expand(d, 6, 1, expanded, 16) == 9);
+  assert(expanded[0] == 1 && expanded[1] == 1 && expanded[2] == 2);
+  assert(expanded[6] == 1 && expanded[7] == 1 && expanded[8] == 2);
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+int main(void)
+{
+  testValidateRejects();
+  testCompression();
+  testEncodeLimits();
+  testRandomRoundTrips();
+  return test_Done("test_gen_pattern");
+}
@@ -0,0 +1,206 @@
+/*!
+ * @file
+ * @brief     Host unit tests for the USB transfer descriptor chain
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include "usb_dma_chain.h"
+#include "test_util.h"
+#include <string.h>
+
+/******************************************************************************
+ * Typedefs and defines
+ *****************************************************************************/
+
+#define POOL_SIZE     (16 * USB_DMA_CHAIN_PAGE_SIZE)
+#define MAX_SEGMENTS  8
+#define MAX_ENTRIES   64
+#define MAX_PACKET    512
+
+/******************************************************************************
+ * Local variables
+ *****************************************************************************/
+
+/* page aligned so that the page offsets of the segments are known */
+static uint8_t pool[POOL_SIZE] __attribute__((aligned(USB_DMA_CHAIN_PAGE_SIZE)));
+static uint8_t bounce[MAX_SEGMENTS * MAX_PACKET];
+static uint8_t expected[MAX_SEGMENTS * POOL_SIZE];
+static uint8_t sent[MAX_SEGMENTS * POOL_SIZE];
+
+static usb_dma_chain_segment_t segments[MAX_SEGMENTS];
+static usb_dma_chain_entry_t entries[MAX_ENTRIES];
+
+/******************************************************************************
+ * Local Functions
+ *****************************************************************************/
+
+static int inBounce(const uint8_t* p, uint32_t length)
+{
+  return (p >= bounce) && (p + length <= bounce + sizeof(bounce));
+}
+
+static int inSegment(const uint8_t* p, uint32_t length, uint32_t numSegments)
+{
+  uint32_t i;
+
+  for (i = 0; i < numSegments; i++)
+  {
+    if (p >= segments[i].data && p + length <= segments[i].data + segments[i].length)
+    {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/* Checks the chain and returns the number of bytes it sends */
+static uint32_t checkChain(uint32_t numEntries, uint32_t numSegments, uint32_t packetSize)
+{
+  uint32_t i, offset, total = 0;
+
+  for (i = 0; i < numEntries; i++)
+  {
+    assert(entries[i].length > 0);
+
+    /* the host sees one transfer as long as only the last packet is short */
+    if (i < numEntries - 1)
+    {
+      assert((entries[i].length % packetSize) == 0);
+    }
+
+    /* a descriptor can only address five pages */
+    offset = (uint32_t)((uintptr_t)entries[i].data & (USB_DMA_CHAIN_PAGE_SIZE - 1));
+    assert(offset + entries[i].length <= USB_DMA_CHAIN_NUM_PAGES * USB_DMA_CHAIN_PAGE_SIZE);
+
+    /* sent in place or, for at most a packet, from the bounce buffer */
+    if (inBounce(entries[i].data, entries[i].length))
+    {
+      assert(entries[i].length <= packetSize);
+    }
+    else
+    {
+      assert(inSegment(entries[i].data, entries[i].length, numSegments));
+    }
+
+    memcpy(&sent[total], entries[i].data, entries[i].length);
+    total += entries[i].length;
+  }
+  return total;
+}
+
+static void testRandomChains(void)
+{
+  static const uint32_t packetSizes[] = { 8, 64, 512 };
+  uint32_t t, i, numSegments, packetSize, numEntries, total, start, length;
+
+  for (i = 0; i < POOL_SIZE; i++)
+  {
+    pool[i] = (uint8_t)test_Random();
+  }
+
+  for (t = 0; t < 20000; t++)
+  {
+    packetSize = packetSizes[test_RandomBelow(3)];
+    numSegments = 1 + test_RandomBelow(MAX_SEGMENTS);
+
+    total = 0;
+    for (i = 0; i < numSegments; i++)
+    {
+      switch (test_RandomBelow(4))
+      {
+        case 0:  length = test_RandomBelow(2 * packetSize); break;
+        case 1:  length = packetSize * test_RandomBelow(8); break;
+        default: length = test_RandomBelow(POOL_SIZE); break;
+      }
+      start = test_RandomBelow(POOL_SIZE - length + 1);
+      if (test_RandomBelow(4) == 0)
+      {
+        /* page aligned, as the capture buffers often are */
+        start &= ~(USB_DMA_CHAIN_PAGE_SIZE - 1);
+      }
+      segments[i].data = &pool[start];
+      segments[i].length = length;
+      memcpy(&expected[total], &pool[start], length);
+      total += length;
+    }
+
+    memset(bounce, 0, sizeof(bounce));
+    numEntries = usb_dma_chain_Build(segments, numSegments, packetSize,
+                                     bounce, numSegments * packetSize,
+                                     entries, MAX_ENTRIES);
+    if (total == 0)
+    {
+      assert(numEntries == 0);
+      continue;
+    }
+    assert(numEntries > 0);
+    assert(checkChain(numEntries, numSegments, packetSize) == total);
+    assert(memcmp(sent, expected, total) == 0);
+
+    /* one entry less than needed must fail instead of dropping data */
+    assert(usb_dma_chain_Build(segments, numSegments, packetSize,
+                               bounce, numSegments * packetSize,
+                               entries, numEntries - 1) == 0);
+  }
+}
+
+static void testLimits(void)
+{
+  /* aligned segment boundaries need no bounce buffer */
+  segments[0].data = &pool[0];
+  segments[0].length = 4 * 64;
+  segments[1].data = &pool[USB_DMA_CHAIN_PAGE_SIZE];
+  segments[1].length = 100;
+  assert(usb_dma_chain_Build(segments, 2, 64, bounce, 0, entries, MAX_ENTRIES) == 2);
+  assert(entries[0].data == &pool[0] && entries[0].length == 4 * 64);
+  assert(entries[1].data == &pool[USB_DMA_CHAIN_PAGE_SIZE] && entries[1].length == 100);
+
+  /* an unaligned boundary does */
+  segments[0].length = 4 * 64 + 1;
+  assert(usb_dma_chain_Build(segments, 2, 64, bounce, 0, entries, MAX_ENTRIES) == 0);
+  assert(usb_dma_chain_Build(segments, 2, 64, bounce, 64, entries, MAX_ENTRIES) == 3);
+  assert(entries[1].data == bounce && entries[1].length == 64);
+  assert(entries[2].data == &pool[USB_DMA_CHAIN_PAGE_SIZE + 63] && entries[2].length == 37);
+
+  /* a full five pages from a page boundary is a single descriptor */
+  segments[0].data = &pool[0];
+  segments[0].length = USB_DMA_CHAIN_NUM_PAGES * USB_DMA_CHAIN_PAGE_SIZE;
+  assert(usb_dma_chain_Build(segments, 1, 512, bounce, 0, entries, MAX_ENTRIES) == 1);
+
+  /* but not from one byte later */
+  segments[0].data = &pool[1];
+  assert(usb_dma_chain_Build(segments, 1, 512, bounce, 0, entries, MAX_ENTRIES) == 2);
+
+  assert(usb_dma_chain_Build(segments, 1, 0, bounce, 0, entries, MAX_ENTRIES) == 0);
+  assert(usb_dma_chain_Build(segments, 0, 512, bounce, 0, entries, MAX_ENTRIES) == 0);
+}
+
+/******************************************************************************
+ * Public Functions
+ *****************************************************************************/
+
+int main(void)
+{
+  testLimits();
+  testRandomChains();
+  return test_Done("test_usb_dma_chain");
+}
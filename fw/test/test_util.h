@@ -0,0 +1,65 @@
+/*!
+ * @file
+ * @brief     Helpers shared by the host unit tests
+ *
+ * @copyright Copyright 2013 Embedded Artists AB
+ *
+ * Permission to use, copy, modify, and distribute this software and its
+ * documentation is hereby granted, without fee, provided that it
+ * is used in conjunction with NXP Semiconductors microcontrollers.  This
+ * copyright, permission, and disclaimer notice must appear in all copies of
+ * this code.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef __TEST_UTIL_H
+#define __TEST_UTIL_H
+
+/******************************************************************************
+ * Includes
+ *****************************************************************************/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef NDEBUG
+#error The tests rely on assert() and must not be built with NDEBUG
+#endif
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+static uint32_t test_seed = 0x2545f491;
+
+/*! Deterministic pseudo random numbers (xorshift32) so that a failure can be
+ *  reproduced on any host regardless of the C library. */
+static inline uint32_t test_Random(void)
+{
+  test_seed ^= test_seed << 13;
+  test_seed ^= test_seed >> 17;
+  test_seed ^= test_seed << 5;
+  return test_seed;
+}
+
+/*! Random number in the range 0..(n-1) */
+static inline uint32_t test_RandomBelow(uint32_t n)
+{
+  return test_Random() % n;
+}
+
+/*! Reports a passed test program */
+static inline int test_Done(const char* name)
+{
+  printf("%s: ok\n", name);
+  return 0;
+}
+
+#endif /* end __TEST_UTIL_H */